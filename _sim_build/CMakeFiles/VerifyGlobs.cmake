@@ -0,0 +1,148 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by CMake Version 3.25
+cmake_policy(SET CMP0009 NEW)
+
+# LIBRARY_SOURCES at CMakeLists.txt:34 (file)
+file(GLOB NEW_GLOB LIST_DIRECTORIES true "/root/repo/lib/*/src/*.cpp")
+set(OLD_GLOB
+  "/root/repo/lib/AB1805_RK/src/AB1805_RK.cpp"
+  "/root/repo/lib/BackgroundPublishRK/src/BackgroundPublishRK.cpp"
+  "/root/repo/lib/DeviceInfoLedger/src/DeviceInfoLedger.cpp"
+  "/root/repo/lib/LocalTimeRK/src/LocalTimeRK.cpp"
+  "/root/repo/lib/PublishQueuePosixRK/src/PublishQueueEventPool.cpp"
+  "/root/repo/lib/PublishQueuePosixRK/src/PublishQueuePayloadDictionary.cpp"
+  "/root/repo/lib/PublishQueuePosixRK/src/PublishQueuePosixRK.cpp"
+  "/root/repo/lib/PublishQueuePosixRK/src/PublishQueueSegmentStore.cpp"
+  "/root/repo/lib/SequentialFileRK/src/SequentialFileRK.cpp"
+  "/root/repo/lib/StorageHelperRK/src/StorageHelperRK.cpp"
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_sim_build/CMakeFiles/cmake.verify_globs")
+endif()
+
+# SIM_SOURCES at CMakeLists.txt:49 (file)
+file(GLOB NEW_GLOB LIST_DIRECTORIES true "/root/repo/sim/src/*.cpp")
+set(OLD_GLOB
+  "/root/repo/sim/src/SimAB1805.cpp"
+  "/root/repo/sim/src/SimCloud.cpp"
+  "/root/repo/sim/src/SimFs.cpp"
+  "/root/repo/sim/src/SimLog.cpp"
+  "/root/repo/sim/src/SimMain.cpp"
+  "/root/repo/sim/src/SimSystem.cpp"
+  "/root/repo/sim/src/SimThreads.cpp"
+  "/root/repo/sim/src/SimTime.cpp"
+  "/root/repo/sim/src/SimWorld.cpp"
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_sim_build/CMakeFiles/cmake.verify_globs")
+endif()
+
+# FIRMWARE_SOURCES at CMakeLists.txt:31 (file)
+file(GLOB NEW_GLOB LIST_DIRECTORIES true "/root/repo/src/*.cpp")
+set(OLD_GLOB
+  "/root/repo/src/AccelPresenceSensor.cpp"
+  "/root/repo/src/AccessProfile.cpp"
+  "/root/repo/src/AnalogBurstSensor.cpp"
+  "/root/repo/src/AppMessages.cpp"
+  "/root/repo/src/AssetStore.cpp"
+  "/root/repo/src/AutoTune.cpp"
+  "/root/repo/src/Benchmark.cpp"
+  "/root/repo/src/BleReadout.cpp"
+  "/root/repo/src/BootProfiler.cpp"
+  "/root/repo/src/BrownoutGuard.cpp"
+  "/root/repo/src/BulkUpload.cpp"
+  "/root/repo/src/BurstClassifier.cpp"
+  "/root/repo/src/ClockDrift.cpp"
+  "/root/repo/src/Cloud.cpp"
+  "/root/repo/src/ConfigSnapshot.cpp"
+  "/root/repo/src/ConnectCache.cpp"
+  "/root/repo/src/ConnectHistory.cpp"
+  "/root/repo/src/ConnectStability.cpp"
+  "/root/repo/src/CounterJournal.cpp"
+  "/root/repo/src/DataUsage.cpp"
+  "/root/repo/src/DiagBudget.cpp"
+  "/root/repo/src/EnergyLedger.cpp"
+  "/root/repo/src/EventFilter.cpp"
+  "/root/repo/src/Experiment.cpp"
+  "/root/repo/src/FaultInject.cpp"
+  "/root/repo/src/FieldBench.cpp"
+  "/root/repo/src/Generalized-Core-Counter.cpp"
+  "/root/repo/src/GroupEstimator.cpp"
+  "/root/repo/src/HeapMonitor.cpp"
+  "/root/repo/src/HistoryCodec.cpp"
+  "/root/repo/src/HistoryRollup.cpp"
+  "/root/repo/src/HourlyHistory.cpp"
+  "/root/repo/src/ISensor.cpp"
+  "/root/repo/src/LedgerLog.cpp"
+  "/root/repo/src/LiveCounts.cpp"
+  "/root/repo/src/LiveMetrics.cpp"
+  "/root/repo/src/LoRaGatewaySensor.cpp"
+  "/root/repo/src/LocalZone.cpp"
+  "/root/repo/src/LoopProfile.cpp"
+  "/root/repo/src/LoopbackTest.cpp"
+  "/root/repo/src/MonoClock.cpp"
+  "/root/repo/src/MyPersistentData.cpp"
+  "/root/repo/src/OccupancyNotify.cpp"
+  "/root/repo/src/OpenMVSensor.cpp"
+  "/root/repo/src/OtaScheduler.cpp"
+  "/root/repo/src/PIRSensor.cpp"
+  "/root/repo/src/Particle_Functions.cpp"
+  "/root/repo/src/PayloadWriter.cpp"
+  "/root/repo/src/PersistentMigration.cpp"
+  "/root/repo/src/PersistentStore.cpp"
+  "/root/repo/src/PhaseMarkers.cpp"
+  "/root/repo/src/PowerDomains.cpp"
+  "/root/repo/src/PowerGovernor.cpp"
+  "/root/repo/src/RainBucketSensor.cpp"
+  "/root/repo/src/RamQueueSizer.cpp"
+  "/root/repo/src/RawArchive.cpp"
+  "/root/repo/src/RecoveryStats.cpp"
+  "/root/repo/src/ReportAck.cpp"
+  "/root/repo/src/ReportCodec.cpp"
+  "/root/repo/src/RtcService.cpp"
+  "/root/repo/src/ScheduledSampler.cpp"
+  "/root/repo/src/SensorManager.cpp"
+  "/root/repo/src/SiteSlot.cpp"
+  "/root/repo/src/SleepEdgeCounter.cpp"
+  "/root/repo/src/SleepPlanner.cpp"
+  "/root/repo/src/SoakTest.cpp"
+  "/root/repo/src/SpectralFeatures.cpp"
+  "/root/repo/src/StackWatch.cpp"
+  "/root/repo/src/StateHandlers.cpp"
+  "/root/repo/src/StateStats.cpp"
+  "/root/repo/src/StayAwake.cpp"
+  "/root/repo/src/SurplusDrain.cpp"
+  "/root/repo/src/TaskScheduler.cpp"
+  "/root/repo/src/TraceLog.cpp"
+  "/root/repo/src/TraceReplay.cpp"
+  "/root/repo/src/TrafficBaseline.cpp"
+  "/root/repo/src/UpdateWindow.cpp"
+  "/root/repo/src/UsbLog.cpp"
+  "/root/repo/src/VehicleMagnetometerSensor.cpp"
+  "/root/repo/src/VehiclePressureSensor.cpp"
+  "/root/repo/src/Version.cpp"
+  "/root/repo/src/WakeAlign.cpp"
+  "/root/repo/src/WakeLedger.cpp"
+  "/root/repo/src/device_pinout.cpp"
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_sim_build/CMakeFiles/cmake.verify_globs")
+endif()
+
+# FIRMWARE_SOURCES at CMakeLists.txt:31 (file)
+file(GLOB NEW_GLOB LIST_DIRECTORIES true "/root/repo/src/state/*.cpp")
+set(OLD_GLOB
+  "/root/repo/src/state/State_Connect.cpp"
+  "/root/repo/src/state/State_Error.cpp"
+  "/root/repo/src/state/State_Idle.cpp"
+  "/root/repo/src/state/State_Modes.cpp"
+  "/root/repo/src/state/State_Report.cpp"
+  "/root/repo/src/state/State_Sleep.cpp"
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_sim_build/CMakeFiles/cmake.verify_globs")
+endif()
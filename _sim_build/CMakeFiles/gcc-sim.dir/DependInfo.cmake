@@ -0,0 +1,135 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/jsmn.c" "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/jsmn.c.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/jsmn.c.o.d"
+  "/root/repo/lib/AB1805_RK/src/AB1805_RK.cpp" "CMakeFiles/gcc-sim.dir/root/repo/lib/AB1805_RK/src/AB1805_RK.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/lib/AB1805_RK/src/AB1805_RK.cpp.o.d"
+  "/root/repo/lib/BackgroundPublishRK/src/BackgroundPublishRK.cpp" "CMakeFiles/gcc-sim.dir/root/repo/lib/BackgroundPublishRK/src/BackgroundPublishRK.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/lib/BackgroundPublishRK/src/BackgroundPublishRK.cpp.o.d"
+  "/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_json.cpp" "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_json.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_json.cpp.o.d"
+  "/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_logging.cpp" "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_logging.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_logging.cpp.o.d"
+  "/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_print.cpp" "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_print.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_print.cpp.o.d"
+  "/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_stream.cpp" "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_stream.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_stream.cpp.o.d"
+  "/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_string.cpp" "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_string.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_string.cpp.o.d"
+  "/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_variant.cpp" "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_variant.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_variant.cpp.o.d"
+  "/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/time_compat.cpp" "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/time_compat.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/time_compat.cpp.o.d"
+  "/root/repo/lib/DeviceInfoLedger/src/DeviceInfoLedger.cpp" "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/src/DeviceInfoLedger.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/src/DeviceInfoLedger.cpp.o.d"
+  "/root/repo/lib/LocalTimeRK/src/LocalTimeRK.cpp" "CMakeFiles/gcc-sim.dir/root/repo/lib/LocalTimeRK/src/LocalTimeRK.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/lib/LocalTimeRK/src/LocalTimeRK.cpp.o.d"
+  "/root/repo/lib/PublishQueuePosixRK/src/PublishQueueEventPool.cpp" "CMakeFiles/gcc-sim.dir/root/repo/lib/PublishQueuePosixRK/src/PublishQueueEventPool.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/lib/PublishQueuePosixRK/src/PublishQueueEventPool.cpp.o.d"
+  "/root/repo/lib/PublishQueuePosixRK/src/PublishQueuePayloadDictionary.cpp" "CMakeFiles/gcc-sim.dir/root/repo/lib/PublishQueuePosixRK/src/PublishQueuePayloadDictionary.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/lib/PublishQueuePosixRK/src/PublishQueuePayloadDictionary.cpp.o.d"
+  "/root/repo/lib/PublishQueuePosixRK/src/PublishQueuePosixRK.cpp" "CMakeFiles/gcc-sim.dir/root/repo/lib/PublishQueuePosixRK/src/PublishQueuePosixRK.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/lib/PublishQueuePosixRK/src/PublishQueuePosixRK.cpp.o.d"
+  "/root/repo/lib/PublishQueuePosixRK/src/PublishQueueSegmentStore.cpp" "CMakeFiles/gcc-sim.dir/root/repo/lib/PublishQueuePosixRK/src/PublishQueueSegmentStore.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/lib/PublishQueuePosixRK/src/PublishQueueSegmentStore.cpp.o.d"
+  "/root/repo/lib/SequentialFileRK/src/SequentialFileRK.cpp" "CMakeFiles/gcc-sim.dir/root/repo/lib/SequentialFileRK/src/SequentialFileRK.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/lib/SequentialFileRK/src/SequentialFileRK.cpp.o.d"
+  "/root/repo/lib/StorageHelperRK/src/StorageHelperRK.cpp" "CMakeFiles/gcc-sim.dir/root/repo/lib/StorageHelperRK/src/StorageHelperRK.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/lib/StorageHelperRK/src/StorageHelperRK.cpp.o.d"
+  "/root/repo/src/AccelPresenceSensor.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/AccelPresenceSensor.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/AccelPresenceSensor.cpp.o.d"
+  "/root/repo/src/AccessProfile.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/AccessProfile.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/AccessProfile.cpp.o.d"
+  "/root/repo/src/AnalogBurstSensor.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/AnalogBurstSensor.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/AnalogBurstSensor.cpp.o.d"
+  "/root/repo/src/AppMessages.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/AppMessages.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/AppMessages.cpp.o.d"
+  "/root/repo/src/AssetStore.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/AssetStore.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/AssetStore.cpp.o.d"
+  "/root/repo/src/AutoTune.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/AutoTune.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/AutoTune.cpp.o.d"
+  "/root/repo/src/Benchmark.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/Benchmark.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/Benchmark.cpp.o.d"
+  "/root/repo/src/BleReadout.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/BleReadout.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/BleReadout.cpp.o.d"
+  "/root/repo/src/BootProfiler.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/BootProfiler.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/BootProfiler.cpp.o.d"
+  "/root/repo/src/BrownoutGuard.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/BrownoutGuard.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/BrownoutGuard.cpp.o.d"
+  "/root/repo/src/BulkUpload.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/BulkUpload.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/BulkUpload.cpp.o.d"
+  "/root/repo/src/BurstClassifier.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/BurstClassifier.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/BurstClassifier.cpp.o.d"
+  "/root/repo/src/ClockDrift.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/ClockDrift.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/ClockDrift.cpp.o.d"
+  "/root/repo/src/Cloud.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/Cloud.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/Cloud.cpp.o.d"
+  "/root/repo/src/ConfigSnapshot.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/ConfigSnapshot.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/ConfigSnapshot.cpp.o.d"
+  "/root/repo/src/ConnectCache.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/ConnectCache.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/ConnectCache.cpp.o.d"
+  "/root/repo/src/ConnectHistory.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/ConnectHistory.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/ConnectHistory.cpp.o.d"
+  "/root/repo/src/ConnectStability.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/ConnectStability.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/ConnectStability.cpp.o.d"
+  "/root/repo/src/CounterJournal.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/CounterJournal.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/CounterJournal.cpp.o.d"
+  "/root/repo/src/DataUsage.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/DataUsage.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/DataUsage.cpp.o.d"
+  "/root/repo/src/DiagBudget.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/DiagBudget.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/DiagBudget.cpp.o.d"
+  "/root/repo/src/EnergyLedger.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/EnergyLedger.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/EnergyLedger.cpp.o.d"
+  "/root/repo/src/EventFilter.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/EventFilter.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/EventFilter.cpp.o.d"
+  "/root/repo/src/Experiment.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/Experiment.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/Experiment.cpp.o.d"
+  "/root/repo/src/FaultInject.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/FaultInject.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/FaultInject.cpp.o.d"
+  "/root/repo/src/FieldBench.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/FieldBench.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/FieldBench.cpp.o.d"
+  "/root/repo/src/Generalized-Core-Counter.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/Generalized-Core-Counter.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/Generalized-Core-Counter.cpp.o.d"
+  "/root/repo/src/GroupEstimator.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/GroupEstimator.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/GroupEstimator.cpp.o.d"
+  "/root/repo/src/HeapMonitor.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/HeapMonitor.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/HeapMonitor.cpp.o.d"
+  "/root/repo/src/HistoryCodec.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/HistoryCodec.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/HistoryCodec.cpp.o.d"
+  "/root/repo/src/HistoryRollup.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/HistoryRollup.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/HistoryRollup.cpp.o.d"
+  "/root/repo/src/HourlyHistory.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/HourlyHistory.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/HourlyHistory.cpp.o.d"
+  "/root/repo/src/ISensor.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/ISensor.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/ISensor.cpp.o.d"
+  "/root/repo/src/LedgerLog.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/LedgerLog.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/LedgerLog.cpp.o.d"
+  "/root/repo/src/LiveCounts.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/LiveCounts.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/LiveCounts.cpp.o.d"
+  "/root/repo/src/LiveMetrics.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/LiveMetrics.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/LiveMetrics.cpp.o.d"
+  "/root/repo/src/LoRaGatewaySensor.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/LoRaGatewaySensor.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/LoRaGatewaySensor.cpp.o.d"
+  "/root/repo/src/LocalZone.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/LocalZone.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/LocalZone.cpp.o.d"
+  "/root/repo/src/LoopProfile.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/LoopProfile.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/LoopProfile.cpp.o.d"
+  "/root/repo/src/LoopbackTest.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/LoopbackTest.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/LoopbackTest.cpp.o.d"
+  "/root/repo/src/MonoClock.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/MonoClock.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/MonoClock.cpp.o.d"
+  "/root/repo/src/MyPersistentData.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/MyPersistentData.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/MyPersistentData.cpp.o.d"
+  "/root/repo/src/OccupancyNotify.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/OccupancyNotify.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/OccupancyNotify.cpp.o.d"
+  "/root/repo/src/OpenMVSensor.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/OpenMVSensor.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/OpenMVSensor.cpp.o.d"
+  "/root/repo/src/OtaScheduler.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/OtaScheduler.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/OtaScheduler.cpp.o.d"
+  "/root/repo/src/PIRSensor.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/PIRSensor.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/PIRSensor.cpp.o.d"
+  "/root/repo/src/Particle_Functions.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/Particle_Functions.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/Particle_Functions.cpp.o.d"
+  "/root/repo/src/PayloadWriter.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/PayloadWriter.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/PayloadWriter.cpp.o.d"
+  "/root/repo/src/PersistentMigration.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/PersistentMigration.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/PersistentMigration.cpp.o.d"
+  "/root/repo/src/PersistentStore.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/PersistentStore.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/PersistentStore.cpp.o.d"
+  "/root/repo/src/PhaseMarkers.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/PhaseMarkers.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/PhaseMarkers.cpp.o.d"
+  "/root/repo/src/PowerDomains.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/PowerDomains.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/PowerDomains.cpp.o.d"
+  "/root/repo/src/PowerGovernor.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/PowerGovernor.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/PowerGovernor.cpp.o.d"
+  "/root/repo/src/RainBucketSensor.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/RainBucketSensor.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/RainBucketSensor.cpp.o.d"
+  "/root/repo/src/RamQueueSizer.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/RamQueueSizer.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/RamQueueSizer.cpp.o.d"
+  "/root/repo/src/RawArchive.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/RawArchive.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/RawArchive.cpp.o.d"
+  "/root/repo/src/RecoveryStats.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/RecoveryStats.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/RecoveryStats.cpp.o.d"
+  "/root/repo/src/ReportAck.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/ReportAck.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/ReportAck.cpp.o.d"
+  "/root/repo/src/ReportCodec.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/ReportCodec.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/ReportCodec.cpp.o.d"
+  "/root/repo/src/RtcService.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/RtcService.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/RtcService.cpp.o.d"
+  "/root/repo/src/ScheduledSampler.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/ScheduledSampler.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/ScheduledSampler.cpp.o.d"
+  "/root/repo/src/SensorManager.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/SensorManager.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/SensorManager.cpp.o.d"
+  "/root/repo/src/SiteSlot.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/SiteSlot.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/SiteSlot.cpp.o.d"
+  "/root/repo/src/SleepEdgeCounter.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/SleepEdgeCounter.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/SleepEdgeCounter.cpp.o.d"
+  "/root/repo/src/SleepPlanner.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/SleepPlanner.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/SleepPlanner.cpp.o.d"
+  "/root/repo/src/SoakTest.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/SoakTest.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/SoakTest.cpp.o.d"
+  "/root/repo/src/SpectralFeatures.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/SpectralFeatures.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/SpectralFeatures.cpp.o.d"
+  "/root/repo/src/StackWatch.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/StackWatch.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/StackWatch.cpp.o.d"
+  "/root/repo/src/StateHandlers.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/StateHandlers.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/StateHandlers.cpp.o.d"
+  "/root/repo/src/StateStats.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/StateStats.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/StateStats.cpp.o.d"
+  "/root/repo/src/StayAwake.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/StayAwake.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/StayAwake.cpp.o.d"
+  "/root/repo/src/SurplusDrain.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/SurplusDrain.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/SurplusDrain.cpp.o.d"
+  "/root/repo/src/TaskScheduler.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/TaskScheduler.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/TaskScheduler.cpp.o.d"
+  "/root/repo/src/TraceLog.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/TraceLog.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/TraceLog.cpp.o.d"
+  "/root/repo/src/TraceReplay.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/TraceReplay.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/TraceReplay.cpp.o.d"
+  "/root/repo/src/TrafficBaseline.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/TrafficBaseline.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/TrafficBaseline.cpp.o.d"
+  "/root/repo/src/UpdateWindow.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/UpdateWindow.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/UpdateWindow.cpp.o.d"
+  "/root/repo/src/UsbLog.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/UsbLog.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/UsbLog.cpp.o.d"
+  "/root/repo/src/VehicleMagnetometerSensor.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/VehicleMagnetometerSensor.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/VehicleMagnetometerSensor.cpp.o.d"
+  "/root/repo/src/VehiclePressureSensor.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/VehiclePressureSensor.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/VehiclePressureSensor.cpp.o.d"
+  "/root/repo/src/Version.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/Version.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/Version.cpp.o.d"
+  "/root/repo/src/WakeAlign.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/WakeAlign.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/WakeAlign.cpp.o.d"
+  "/root/repo/src/WakeLedger.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/WakeLedger.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/WakeLedger.cpp.o.d"
+  "/root/repo/src/device_pinout.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/device_pinout.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/device_pinout.cpp.o.d"
+  "/root/repo/src/state/State_Connect.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/state/State_Connect.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/state/State_Connect.cpp.o.d"
+  "/root/repo/src/state/State_Error.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/state/State_Error.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/state/State_Error.cpp.o.d"
+  "/root/repo/src/state/State_Idle.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/state/State_Idle.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/state/State_Idle.cpp.o.d"
+  "/root/repo/src/state/State_Modes.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/state/State_Modes.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/state/State_Modes.cpp.o.d"
+  "/root/repo/src/state/State_Report.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/state/State_Report.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/state/State_Report.cpp.o.d"
+  "/root/repo/src/state/State_Sleep.cpp" "CMakeFiles/gcc-sim.dir/root/repo/src/state/State_Sleep.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/root/repo/src/state/State_Sleep.cpp.o.d"
+  "/root/repo/sim/src/SimAB1805.cpp" "CMakeFiles/gcc-sim.dir/src/SimAB1805.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/src/SimAB1805.cpp.o.d"
+  "/root/repo/sim/src/SimCloud.cpp" "CMakeFiles/gcc-sim.dir/src/SimCloud.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/src/SimCloud.cpp.o.d"
+  "/root/repo/sim/src/SimFs.cpp" "CMakeFiles/gcc-sim.dir/src/SimFs.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/src/SimFs.cpp.o.d"
+  "/root/repo/sim/src/SimLog.cpp" "CMakeFiles/gcc-sim.dir/src/SimLog.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/src/SimLog.cpp.o.d"
+  "/root/repo/sim/src/SimMain.cpp" "CMakeFiles/gcc-sim.dir/src/SimMain.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/src/SimMain.cpp.o.d"
+  "/root/repo/sim/src/SimSystem.cpp" "CMakeFiles/gcc-sim.dir/src/SimSystem.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/src/SimSystem.cpp.o.d"
+  "/root/repo/sim/src/SimThreads.cpp" "CMakeFiles/gcc-sim.dir/src/SimThreads.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/src/SimThreads.cpp.o.d"
+  "/root/repo/sim/src/SimTime.cpp" "CMakeFiles/gcc-sim.dir/src/SimTime.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/src/SimTime.cpp.o.d"
+  "/root/repo/sim/src/SimWorld.cpp" "CMakeFiles/gcc-sim.dir/src/SimWorld.cpp.o" "gcc" "CMakeFiles/gcc-sim.dir/src/SimWorld.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,243 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/AB1805_RK/src/AB1805_RK.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/AB1805_RK/src/AB1805_RK.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/BackgroundPublishRK/src/BackgroundPublishRK.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/BackgroundPublishRK/src/BackgroundPublishRK.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/jsmn.c.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/jsmn.c.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_json.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_json.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_logging.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_logging.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_print.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_print.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_stream.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_stream.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_string.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_string.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_variant.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/spark_wiring_variant.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/time_compat.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/automated-test/UnitTestLib/time_compat.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/src/DeviceInfoLedger.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/DeviceInfoLedger/src/DeviceInfoLedger.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/LocalTimeRK/src/LocalTimeRK.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/LocalTimeRK/src/LocalTimeRK.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/PublishQueuePosixRK/src/PublishQueueEventPool.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/PublishQueuePosixRK/src/PublishQueueEventPool.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/PublishQueuePosixRK/src/PublishQueuePayloadDictionary.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/PublishQueuePosixRK/src/PublishQueuePayloadDictionary.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/PublishQueuePosixRK/src/PublishQueuePosixRK.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/PublishQueuePosixRK/src/PublishQueuePosixRK.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/PublishQueuePosixRK/src/PublishQueueSegmentStore.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/PublishQueuePosixRK/src/PublishQueueSegmentStore.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/SequentialFileRK/src/SequentialFileRK.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/SequentialFileRK/src/SequentialFileRK.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/StorageHelperRK/src/StorageHelperRK.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/lib/StorageHelperRK/src/StorageHelperRK.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/AccelPresenceSensor.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/AccelPresenceSensor.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/AccessProfile.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/AccessProfile.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/AnalogBurstSensor.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/AnalogBurstSensor.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/AppMessages.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/AppMessages.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/AssetStore.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/AssetStore.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/AutoTune.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/AutoTune.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/Benchmark.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/Benchmark.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/BleReadout.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/BleReadout.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/BootProfiler.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/BootProfiler.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/BrownoutGuard.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/BrownoutGuard.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/BulkUpload.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/BulkUpload.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/BurstClassifier.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/BurstClassifier.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/ClockDrift.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/ClockDrift.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/Cloud.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/Cloud.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/ConfigSnapshot.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/ConfigSnapshot.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/ConnectCache.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/ConnectCache.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/ConnectHistory.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/ConnectHistory.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/ConnectStability.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/ConnectStability.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/CounterJournal.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/CounterJournal.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/DataUsage.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/DataUsage.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/DiagBudget.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/DiagBudget.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/EnergyLedger.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/EnergyLedger.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/EventFilter.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/EventFilter.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/Experiment.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/Experiment.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/FaultInject.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/FaultInject.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/FieldBench.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/FieldBench.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/Generalized-Core-Counter.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/Generalized-Core-Counter.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/GroupEstimator.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/GroupEstimator.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/HeapMonitor.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/HeapMonitor.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/HistoryCodec.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/HistoryCodec.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/HistoryRollup.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/HistoryRollup.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/HourlyHistory.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/HourlyHistory.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/ISensor.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/ISensor.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/LedgerLog.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/LedgerLog.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/LiveCounts.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/LiveCounts.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/LiveMetrics.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/LiveMetrics.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/LoRaGatewaySensor.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/LoRaGatewaySensor.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/LocalZone.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/LocalZone.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/LoopProfile.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/LoopProfile.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/LoopbackTest.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/LoopbackTest.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/MonoClock.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/MonoClock.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/MyPersistentData.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/MyPersistentData.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/OccupancyNotify.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/OccupancyNotify.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/OpenMVSensor.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/OpenMVSensor.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/OtaScheduler.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/OtaScheduler.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/PIRSensor.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/PIRSensor.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/Particle_Functions.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/Particle_Functions.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/PayloadWriter.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/PayloadWriter.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/PersistentMigration.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/PersistentMigration.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/PersistentStore.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/PersistentStore.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/PhaseMarkers.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/PhaseMarkers.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/PowerDomains.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/PowerDomains.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/PowerGovernor.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/PowerGovernor.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/RainBucketSensor.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/RainBucketSensor.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/RamQueueSizer.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/RamQueueSizer.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/RawArchive.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/RawArchive.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/RecoveryStats.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/RecoveryStats.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/ReportAck.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/ReportAck.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/ReportCodec.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/ReportCodec.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/RtcService.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/RtcService.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/ScheduledSampler.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/ScheduledSampler.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/SensorManager.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/SensorManager.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/SiteSlot.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/SiteSlot.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/SleepEdgeCounter.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/SleepEdgeCounter.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/SleepPlanner.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/SleepPlanner.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/SoakTest.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/SoakTest.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/SpectralFeatures.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/SpectralFeatures.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/StackWatch.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/StackWatch.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/StateHandlers.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/StateHandlers.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/StateStats.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/StateStats.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/StayAwake.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/StayAwake.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/SurplusDrain.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/SurplusDrain.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/TaskScheduler.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/TaskScheduler.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/TraceLog.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/TraceLog.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/TraceReplay.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/TraceReplay.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/TrafficBaseline.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/TrafficBaseline.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/UpdateWindow.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/UpdateWindow.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/UsbLog.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/UsbLog.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/VehicleMagnetometerSensor.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/VehicleMagnetometerSensor.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/VehiclePressureSensor.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/VehiclePressureSensor.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/Version.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/Version.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/WakeAlign.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/WakeAlign.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/WakeLedger.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/WakeLedger.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/device_pinout.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/device_pinout.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/state/State_Connect.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/state/State_Connect.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/state/State_Error.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/state/State_Error.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/state/State_Idle.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/state/State_Idle.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/state/State_Modes.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/state/State_Modes.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/state/State_Report.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/state/State_Report.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/state/State_Sleep.cpp.o"
+  "CMakeFiles/gcc-sim.dir/root/repo/src/state/State_Sleep.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/src/SimAB1805.cpp.o"
+  "CMakeFiles/gcc-sim.dir/src/SimAB1805.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/src/SimCloud.cpp.o"
+  "CMakeFiles/gcc-sim.dir/src/SimCloud.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/src/SimFs.cpp.o"
+  "CMakeFiles/gcc-sim.dir/src/SimFs.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/src/SimLog.cpp.o"
+  "CMakeFiles/gcc-sim.dir/src/SimLog.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/src/SimMain.cpp.o"
+  "CMakeFiles/gcc-sim.dir/src/SimMain.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/src/SimSystem.cpp.o"
+  "CMakeFiles/gcc-sim.dir/src/SimSystem.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/src/SimThreads.cpp.o"
+  "CMakeFiles/gcc-sim.dir/src/SimThreads.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/src/SimTime.cpp.o"
+  "CMakeFiles/gcc-sim.dir/src/SimTime.cpp.o.d"
+  "CMakeFiles/gcc-sim.dir/src/SimWorld.cpp.o"
+  "CMakeFiles/gcc-sim.dir/src/SimWorld.cpp.o.d"
+  "gcc-sim"
+  "gcc-sim.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C CXX)
+  include(CMakeFiles/gcc-sim.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,24 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/sim
+# Build directory: /root/repo/_sim_build
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(connected-6h "/root/repo/_sim_build/gcc-sim" "--flash-dir" "/root/repo/_sim_build/scenarios/connected-6h" "--report" "/root/repo/_sim_build/scenarios/connected-6h.json" "--days" "0.25" "--expect" "connects==1" "--expect" "cloud_drops==0" "--expect" "event.Ubidots-Counter-Hook-v1>=6" "--expect" "publish_failed==0" "--expect" "app_watchdog_resets==0" "--expect" "rtc_watchdog_resets==0")
+set_tests_properties(connected-6h PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/sim/CMakeLists.txt;99;add_test;/root/repo/sim/scenarios.cmake;12;add_sim_scenario;/root/repo/sim/scenarios.cmake;0;;/root/repo/sim/CMakeLists.txt;104;include;/root/repo/sim/CMakeLists.txt;0;")
+add_test(low-power-week "/root/repo/_sim_build/gcc-sim" "--flash-dir" "/root/repo/_sim_build/scenarios/low-power-week" "--report" "/root/repo/_sim_build/scenarios/low-power-week.json" "--days" "7" "--ledger" "device-settings=/root/repo/sim/scenarios/low-power.json" "--expect" "connects>=100" "--expect" "event.Ubidots-Counter-Hook-v1>=100" "--expect" "hibernates==7" "--expect" "naps>=2000" "--expect" "pir_missed<=2" "--expect" "energy.mah_per_day<=30" "--expect" "battery.projected_days>=60" "--expect" "app_watchdog_resets==0" "--expect" "rtc_watchdog_resets==0")
+set_tests_properties(low-power-week PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/sim/CMakeLists.txt;99;add_test;/root/repo/sim/scenarios.cmake;19;add_sim_scenario;/root/repo/sim/scenarios.cmake;0;;/root/repo/sim/CMakeLists.txt;104;include;/root/repo/sim/CMakeLists.txt;0;")
+add_test(outages "/root/repo/_sim_build/gcc-sim" "--flash-dir" "/root/repo/_sim_build/scenarios/outages" "--report" "/root/repo/_sim_build/scenarios/outages.json" "--days" "3" "--ledger" "device-settings=/root/repo/sim/scenarios/low-power.json" "--outage" "26,360" "--outage" "50,240" "--expect" "connect_failed>=2" "--expect" "connects>=30" "--expect" "energy.mah_per_day<=45" "--expect" "app_watchdog_resets==0" "--expect" "rtc_watchdog_resets==0")
+set_tests_properties(outages PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/sim/CMakeLists.txt;99;add_test;/root/repo/sim/scenarios.cmake;27;add_sim_scenario;/root/repo/sim/scenarios.cmake;0;;/root/repo/sim/CMakeLists.txt;104;include;/root/repo/sim/CMakeLists.txt;0;")
+add_test(flaky-connect "/root/repo/_sim_build/gcc-sim" "--flash-dir" "/root/repo/_sim_build/scenarios/flaky-connect" "--report" "/root/repo/_sim_build/scenarios/flaky-connect.json" "--days" "2" "--ledger" "device-settings=/root/repo/sim/scenarios/low-power.json" "--connect-fail" "0.5" "--expect" "connects>=28" "--expect" "event.Ubidots-Counter-Hook-v1>=28" "--expect" "energy.mah_per_day<=70" "--expect" "app_watchdog_resets==0")
+set_tests_properties(flaky-connect PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/sim/CMakeLists.txt;99;add_test;/root/repo/sim/scenarios.cmake;33;add_sim_scenario;/root/repo/sim/scenarios.cmake;0;;/root/repo/sim/CMakeLists.txt;104;include;/root/repo/sim/CMakeLists.txt;0;")
+add_test(rtc-unset "/root/repo/_sim_build/gcc-sim" "--flash-dir" "/root/repo/_sim_build/scenarios/rtc-unset" "--report" "/root/repo/_sim_build/scenarios/rtc-unset.json" "--days" "1" "--ledger" "device-settings=/root/repo/sim/scenarios/low-power.json" "--no-rtc" "--expect" "connects>=14" "--expect" "hibernates>=1" "--expect" "app_watchdog_resets==0" "--expect" "rtc_watchdog_resets==0")
+set_tests_properties(rtc-unset PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/sim/CMakeLists.txt;99;add_test;/root/repo/sim/scenarios.cmake;38;add_sim_scenario;/root/repo/sim/scenarios.cmake;0;;/root/repo/sim/CMakeLists.txt;104;include;/root/repo/sim/CMakeLists.txt;0;")
+add_test(usb-power "/root/repo/_sim_build/gcc-sim" "--flash-dir" "/root/repo/_sim_build/scenarios/usb-power" "--report" "/root/repo/_sim_build/scenarios/usb-power.json" "--days" "1" "--ledger" "device-settings=/root/repo/sim/scenarios/low-power.json" "--usb" "--battery-pct" "50" "--expect" "battery.end_pct>=99" "--expect" "battery.depleted==0")
+set_tests_properties(usb-power PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/sim/CMakeLists.txt;99;add_test;/root/repo/sim/scenarios.cmake;43;add_sim_scenario;/root/repo/sim/scenarios.cmake;0;;/root/repo/sim/CMakeLists.txt;104;include;/root/repo/sim/CMakeLists.txt;0;")
+add_test(low-battery "/root/repo/_sim_build/gcc-sim" "--flash-dir" "/root/repo/_sim_build/scenarios/low-battery" "--report" "/root/repo/_sim_build/scenarios/low-battery.json" "--days" "3" "--ledger" "device-settings=/root/repo/sim/scenarios/low-power.json" "--battery-pct" "12" "--expect" "battery.depleted==0" "--expect" "energy.mah_per_day<=30")
+set_tests_properties(low-battery PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/sim/CMakeLists.txt;99;add_test;/root/repo/sim/scenarios.cmake;47;add_sim_scenario;/root/repo/sim/scenarios.cmake;0;;/root/repo/sim/CMakeLists.txt;104;include;/root/repo/sim/CMakeLists.txt;0;")
+add_test(button "/root/repo/_sim_build/gcc-sim" "--flash-dir" "/root/repo/_sim_build/scenarios/button" "--report" "/root/repo/_sim_build/scenarios/button.json" "--days" "0.5" "--ledger" "device-settings=/root/repo/sim/scenarios/low-power.json" "--press" "3600" "--expect" "button_presses==1" "--expect" "app_watchdog_resets==0")
+set_tests_properties(button PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/sim/CMakeLists.txt;99;add_test;/root/repo/sim/scenarios.cmake;51;add_sim_scenario;/root/repo/sim/scenarios.cmake;0;;/root/repo/sim/CMakeLists.txt;104;include;/root/repo/sim/CMakeLists.txt;0;")
+add_test(config-function "/root/repo/_sim_build/gcc-sim" "--flash-dir" "/root/repo/_sim_build/scenarios/config-function" "--report" "/root/repo/_sim_build/scenarios/config-function.json" "--days" "1" "--call" "600:config=operatingMode=1" "--expect" "function_calls==1" "--expect" "naps>=100" "--expect" "energy.mah_per_day<=60")
+set_tests_properties(config-function PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/sim/CMakeLists.txt;99;add_test;/root/repo/sim/scenarios.cmake;55;add_sim_scenario;/root/repo/sim/scenarios.cmake;0;;/root/repo/sim/CMakeLists.txt;104;include;/root/repo/sim/CMakeLists.txt;0;")
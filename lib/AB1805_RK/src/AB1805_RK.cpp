@@ -64,10 +64,9 @@ void AB1805::loop() {
 
     if (watchdogUpdatePeriod) {
         if (millis() - lastWatchdogMillis >= watchdogUpdatePeriod) {
-            lastWatchdogMillis = millis();
-
             // Reset the watchdog timer
             setWDT();
+            watchdogPets++;
 
             // Temporary debug logging so we can see when the watchdog is being pet
             _log.info("petting watchdog at %lu ms", (unsigned long) lastWatchdogMillis);
@@ -217,12 +216,15 @@ bool AB1805::setWDT(int seconds) {
     }
 
     if (seconds == 0) {
-        // Disable WDT
+        // Disable WDT, keeping watchdogSecs for resumeWDT()
+        if (!watchdogRunning) {
+            return true;
+        }
         bResult = writeRegister(REG_WDT, 0x00);
 
         _log.trace("watchdog cleared bResult=%d", bResult);
 
-        watchdogSecs = 0;
+        watchdogRunning = !bResult;
         watchdogUpdatePeriod = 0;
     } 
     else {
@@ -239,8 +241,11 @@ bool AB1805::setWDT(int seconds) {
         _log.trace("watchdog set fourSecs=%d bResult=%d", fourSecs, bResult);
 
         watchdogSecs = seconds;
+        watchdogRunning = true;
 
-        // Update watchdog half way through period
+        // Writing the register restarts the countdown, so this counts as a pet;
+        // update watchdog half way through period
+        lastWatchdogMillis = millis();
         watchdogUpdatePeriod = (fourSecs * 2000);
     }
 
@@ -718,6 +723,7 @@ bool AB1805::readRegisters(uint8_t regAddr, uint8_t *array, size_t num, bool loc
         wire.lock();
     }
 
+    i2cTransactions++;
     wire.beginTransmission(i2cAddr);
     wire.write(regAddr);
     int stat = wire.endTransmission(false);
@@ -769,6 +775,7 @@ bool AB1805::writeRegisters(uint8_t regAddr, const uint8_t *array, size_t num, b
         wire.lock();
     }
 
+    i2cTransactions++;
     wire.beginTransmission(i2cAddr);
     wire.write(regAddr);
     for(size_t ii = 0; ii < num; ii++) {
@@ -134,7 +134,8 @@ public:
      * @brief Stops the watchdog timer. Useful before entering sleep mode.
      * 
      * This is done automatically right before reset (using the reset system event)
-     * so the watchdog won't trigger during a firmware update. 
+     * so the watchdog won't trigger during a firmware update. The period is kept
+     * for resumeWDT(). Does nothing if the watchdog is already stopped.
      */
     bool stopWDT() { return setWDT(0); };
 
@@ -149,6 +150,16 @@ public:
      */
     bool resumeWDT() { return setWDT(-1); };
 
+    /**
+     * @brief Number of I2C transactions (register reads and writes) since boot
+     */
+    uint32_t getI2CTransactions() const { return i2cTransactions; };
+
+    /**
+     * @brief Number of times loop() has serviced the watchdog since boot
+     */
+    uint32_t getWatchdogPets() const { return watchdogPets; };
+
     /**
      * @brief Get the time from the RTC as a time_t
      * 
@@ -981,15 +992,30 @@ protected:
     /**
      * @brief Watchdog period in seconds (1 <= watchdogSecs <= 124) or 0 for disabled.
      * 
-     * This is used so setWDT(-1) can restore the previous value.
+     * This is used so setWDT(-1) can restore the previous value. stopWDT() keeps it.
      */
     int watchdogSecs = 0;
 
     /**
-     * @brief The last millis() value where we called setWDT(-1)
+     * @brief Whether the watchdog register was last written enabled (unknown at boot, so true)
+     */
+    bool watchdogRunning = true;
+
+    /**
+     * @brief The last millis() value where the watchdog was written enabled (set, pet or resumed)
      */
     unsigned long lastWatchdogMillis = 0;
 
+    /**
+     * @brief From getWatchdogPets()
+     */
+    uint32_t watchdogPets = 0;
+
+    /**
+     * @brief From getI2CTransactions()
+     */
+    uint32_t i2cTransactions = 0;
+
     /**
      * @brief How often to call updateWDT(-1) in milliseconds
      */
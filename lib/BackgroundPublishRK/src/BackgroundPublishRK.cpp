@@ -7,6 +7,8 @@
 
 #include "BackgroundPublishRK.h"
 
+#include <vector>
+
 BackgroundPublishRK *BackgroundPublishRK::_instance;
 
 BackgroundPublishRK::BackgroundPublishRK() {
@@ -15,6 +17,7 @@ BackgroundPublishRK::BackgroundPublishRK() {
 BackgroundPublishRK::~BackgroundPublishRK()
 {
     stop();
+    delete[] slots;
 }
 
 BackgroundPublishRK &BackgroundPublishRK::instance() {
@@ -24,18 +27,52 @@ BackgroundPublishRK &BackgroundPublishRK::instance() {
     return *_instance;
 }
 
+BackgroundPublishRK &BackgroundPublishRK::withMaxInFlight(size_t count)
+{
+    if(!thread && !slots)
+    {
+        numSlots = constrain(count, (size_t)1, MAX_IN_FLIGHT);
+    }
+    return *this;
+}
+
+BackgroundPublishRK &BackgroundPublishRK::withStackSize(size_t bytes)
+{
+    if(!thread)
+    {
+        stackSize = bytes;
+    }
+    return *this;
+}
+
+BackgroundPublishRK &BackgroundPublishRK::withThreadStart(void (*fn)(size_t stackBytes))
+{
+    if(!thread)
+    {
+        threadStart = fn;
+    }
+    return *this;
+}
+
 void BackgroundPublishRK::start()
 {
     if(!thread)
     {
         os_mutex_create(&mutex);
 
+        if(!slots)
+        {
+            slots = new Slot[numSlots];
+        }
+        state = BACKGROUND_PUBLISH_IDLE;
+
         // use OS_THREAD_PRIORITY_DEFAULT so that application, system, and
         // background publish thread will all run at the same priority and
         // be able to preempt each other
         thread = new Thread("BackgroundPublishRK",
             [this]() { thread_f(); },
-            OS_THREAD_PRIORITY_DEFAULT);
+            OS_THREAD_PRIORITY_DEFAULT,
+            stackSize);
     }
 }
 
@@ -52,60 +89,101 @@ void BackgroundPublishRK::stop()
 
 void BackgroundPublishRK::thread_f()
 {
-    while(true)
+    if(threadStart)
     {
-        while(state == BACKGROUND_PUBLISH_IDLE)
-        {
-            // yield to rest of system while we wait
-            // a condition variable would be ideal but doesn't look like
-            // std::condition_variable is supported
-            delay(1);
-        }
+        threadStart(stackSize);
+    }
+
+    // Publishes that have been started, and the slot each belongs to
+    std::vector<particle::Future<bool>> futures;
+    std::vector<Slot *> futureSlots;
 
+    futures.reserve(numSlots);
+    futureSlots.reserve(numSlots);
+
+    while(true)
+    {
         if(state == BACKGROUND_PUBLISH_STOP)
         {
             return;
         }
 
-        // temporarily acquire the lock
+        bool busy = false;
+
+        // take the oldest request under the lock
         // this allows a calling thread to block the publish thread if it needs
         // additional synchronization around a publish request and acts as a
         // memory barrier around publish arguments to ensure all updates
         // are complete
-        lock();
-        unlock();
-
-        // kick off the publish
-        // WITH_ACK does not work as expected from a background thread
-        // use the Future<bool> object directly as its default wait
-        // (used by WITH_ACK) short-circuits when not called from the
-        // main application thread
-        auto ok = Particle.publish(event_name, event_data, event_flags);
-
-        // then wait for publish to complete
-        while(!ok.isDone() && state != BACKGROUND_PUBLISH_STOP)
+        Slot *next = NULL;
+        WITH_LOCK(*this)
         {
-            // yield to rest of system while we wait
-            delay(1);
+            for(size_t ii = 0; ii < numSlots; ii++)
+            {
+                Slot *slot = &slots[ii];
+                if(slot->state == BACKGROUND_PUBLISH_REQUESTED &&
+                    (!next || (int32_t)(slot->seq - next->seq) < 0))
+                {
+                    next = slot;
+                }
+            }
+            if(next)
+            {
+                next->state = BACKGROUND_PUBLISH_IN_FLIGHT;
+            }
         }
 
-        if(completed_cb)
+        if(next)
         {
-            completed_cb(ok.isSucceeded(),
-                event_name,
-                event_data,
-                event_context);
+            // kick off the publish
+            // WITH_ACK does not work as expected from a background thread
+            // use the Future<bool> object directly as its default wait
+            // (used by WITH_ACK) short-circuits when not called from the
+            // main application thread
+            futures.push_back(Particle.publish(next->event_name, next->event_data, next->event_flags));
+            futureSlots.push_back(next);
+            busy = true;
         }
 
-        WITH_LOCK(*this)
+        // report publishes that have completed, in any order
+        for(size_t ii = 0; ii < futures.size(); )
         {
-            if(state == BACKGROUND_PUBLISH_STOP)
+            if(!futures[ii].isDone())
+            {
+                ii++;
+                continue;
+            }
+
+            Slot *slot = futureSlots[ii];
+            if(slot->completed_cb)
+            {
+                slot->completed_cb(futures[ii].isSucceeded(),
+                    slot->event_name,
+                    slot->event_data,
+                    slot->event_context);
+            }
+            futures.erase(futures.begin() + ii);
+            futureSlots.erase(futureSlots.begin() + ii);
+
+            WITH_LOCK(*this)
             {
-                return;
+                if(state == BACKGROUND_PUBLISH_STOP)
+                {
+                    return;
+                }
+                slot->event_context = NULL;
+                slot->completed_cb = NULL;
+                slot->state = BACKGROUND_PUBLISH_IDLE;
             }
-            event_context = NULL;
-            completed_cb = NULL;
-            state = BACKGROUND_PUBLISH_IDLE;
+            busy = true;
+        }
+
+        if(!busy)
+        {
+            // yield to rest of system while we wait
+            // a condition variable would be ideal but doesn't look like
+            // std::condition_variable is supported
+            delay(1);
         }
     }
 }
@@ -115,7 +193,7 @@ bool BackgroundPublishRK::publish(const char *name, const char *data, PublishFla
     // protect against separate threads trying to publish at the same time
     WITH_LOCK(*this)
 
-    // check currently in idle state and ready to accept publish request
+    // check thread is running
     if(!thread || state != BACKGROUND_PUBLISH_IDLE)
     {
         return false;
@@ -128,25 +206,41 @@ bool BackgroundPublishRK::publish(const char *name, const char *data, PublishFla
         return false;
     }
 
-    // have the lock and thread is currently idle
+    // find a slot that is ready to accept a publish request
+    Slot *slot = NULL;
+    for(size_t ii = 0; ii < numSlots; ii++)
+    {
+        if(slots[ii].state == BACKGROUND_PUBLISH_IDLE)
+        {
+            slot = &slots[ii];
+            break;
+        }
+    }
+    if(!slot)
+    {
+        return false;
+    }
+
+    // have the lock and the slot is idle
     // safe to prepare publish request
-    strncpy(event_name, name, sizeof(event_name));
-    event_name[sizeof(event_name)-1] = '\0'; // ensure null termination
+    strncpy(slot->event_name, name, sizeof(slot->event_name));
+    slot->event_name[sizeof(slot->event_name)-1] = '\0'; // ensure null termination
 
     if(data)
     {
-        strncpy(event_data, data, sizeof(event_data));
-        event_data[sizeof(event_data)-1] = '\0'; // ensure null termination
+        strncpy(slot->event_data, data, sizeof(slot->event_data));
+        slot->event_data[sizeof(slot->event_data)-1] = '\0'; // ensure null termination
     }
     else
     {
-        event_data[0] = '\0'; // null terminate at start for no event data
+        slot->event_data[0] = '\0'; // null terminate at start for no event data
     }
 
-    completed_cb = cb;
-    event_context = context;
-    event_flags = flags;
-    state = BACKGROUND_PUBLISH_REQUESTED;
+    slot->completed_cb = cb;
+    slot->event_context = context;
+    slot->event_flags = flags;
+    slot->seq = nextSeq++;
+    slot->state = BACKGROUND_PUBLISH_REQUESTED;
 
     return true;
 }
@@ -14,6 +14,7 @@ typedef enum {
     BACKGROUND_PUBLISH_IDLE = 0,	//!< Not currently publishing
     BACKGROUND_PUBLISH_REQUESTED,	//!< Publish started
     BACKGROUND_PUBLISH_STOP,		//!< Thread stopped (need to start again to publish)
+    BACKGROUND_PUBLISH_IN_FLIGHT,	//!< Particle.publish called, waiting for the cloud (slot state only)
 } publish_thread_state_t;
 
 /**
@@ -51,6 +52,41 @@ public:
      */
     static BackgroundPublishRK &instance();
 
+    /**
+     * @brief Number of publishes that can be outstanding at once (default 1)
+     *
+     * @param count 1 to MAX_IN_FLIGHT
+     *
+     * With 1, publish() returns false until the previous publish has completed. With more,
+     * the thread starts each request as soon as it is made and tracks the completions
+     * separately, so the requests share the cloud round trip. Each slot holds a copy of
+     * the event name and data (about 1 KB). The caller is responsible for pacing requests
+     * to the Device OS publish rate limit.
+     *
+     * Must be called before start().
+     */
+    BackgroundPublishRK &withMaxInFlight(size_t count);
+
+    /**
+     * @brief Maximum value for withMaxInFlight()
+     */
+    static const size_t MAX_IN_FLIGHT = 4;
+
+    /**
+     * @brief Stack size for the publish thread (default OS_THREAD_STACK_SIZE_DEFAULT)
+     *
+     * Must be called before start().
+     */
+    BackgroundPublishRK &withStackSize(size_t bytes);
+
+    /**
+     * @brief Function the publish thread calls first, with its stack size
+     *
+     * For stack instrumentation, such as painting the stack to find its high-water
+     * mark. Runs on the publish thread. Must be called before start().
+     */
+    BackgroundPublishRK &withThreadStart(void (*fn)(size_t stackBytes));
+
     /**
      * @brief Start the background publish thread. Required!
      *
@@ -72,6 +108,8 @@ public:
     /**
      * @brief Publish method. Use this instead of Particle.publish().
      *
+     * Returns false if all withMaxInFlight() slots are busy.
+     *
      * @param name Event name to publish (required)
      *
      * @param data Event data (optional). Must be a c-string (null-terminated) if non-NULL.
@@ -130,18 +168,32 @@ private:
     BackgroundPublishRK& operator=(const BackgroundPublishRK&) = delete;
 
 
+    /**
+     * @brief One publish request
+     */
+    struct Slot {
+        volatile publish_thread_state_t state = BACKGROUND_PUBLISH_IDLE; //!< IDLE, REQUESTED or IN_FLIGHT
+        uint32_t seq = 0;	//!< Request order, so requests start in the order publish() was called
+
+        // arguments for Particle.publish
+        char event_name[particle::protocol::MAX_EVENT_NAME_LENGTH+1];	//!< name passed to publish
+        char event_data[particle::protocol::MAX_EVENT_DATA_LENGTH+1];	//!< event data passed to publish (may be empty string)
+        PublishFlags event_flags; 	//!< event flags, typically PRIVATE, PRIVATE | WITH_ACK, or PRIVATE | NO_ACK.
+        // callback when publish completes
+        PublishCompletedCallback completed_cb = NULL; 	//!< Completion callback (optional)
+        const void *event_context = NULL; 		//!< Context passed to completion (optional)
+    };
+
     Thread *thread = NULL;		//!< Thread object pointer. Allocated during start()
     void thread_f();			//!< Thread function, passed to the Thread object
     os_mutex_t mutex;	//!< Mutex to protect access to class members from multiple threads
-    volatile publish_thread_state_t state = BACKGROUND_PUBLISH_IDLE; //!< Current state
-
-    // arguments for Particle.publish
-    char event_name[particle::protocol::MAX_EVENT_NAME_LENGTH+1];	//!< name passed to publish
-    char event_data[particle::protocol::MAX_EVENT_DATA_LENGTH+1];	//!< event data passed to publish (may be empty string)
-    PublishFlags event_flags; 	//!< event flags, typically PRIVATE, PRIVATE | WITH_ACK, or PRIVATE | NO_ACK.
-    // callback when publish completes
-    PublishCompletedCallback completed_cb = NULL; 	//!< Completion callback (optional)
-    const void *event_context = NULL; 		//!< Context passed to completion (optional)
+    volatile publish_thread_state_t state = BACKGROUND_PUBLISH_IDLE; //!< IDLE while the thread runs, or STOP
+
+    Slot *slots = NULL;		//!< numSlots requests, allocated during start()
+    size_t numSlots = 1;	//!< From withMaxInFlight()
+    size_t stackSize = OS_THREAD_STACK_SIZE_DEFAULT;	//!< From withStackSize()
+    void (*threadStart)(size_t) = NULL;	//!< From withThreadStart()
+    uint32_t nextSeq = 0;	//!< Next Slot::seq
 
     static BackgroundPublishRK *_instance; //!< Singleton instance of this class
 };
@@ -0,0 +1,103 @@
+#include "PublishQueuePosixRK.h"
+
+PublishQueueEventPool *PublishQueueEventPool::_instance;
+
+static Logger _log("app.pubq");
+
+PublishQueueEventPool &PublishQueueEventPool::instance() {
+    if (!_instance) {
+        _instance = new PublishQueueEventPool();
+    }
+    return *_instance;
+}
+
+PublishQueueEventPool::PublishQueueEventPool() {
+    os_mutex_create(&mutex);
+}
+
+PublishQueueEventPool::~PublishQueueEventPool() {
+}
+
+void PublishQueueEventPool::begin(size_t smallCount, size_t largeCount) {
+    WITH_LOCK(*this) {
+        if (small.arena || large.arena) {
+            _log.error("event pool already allocated");
+            return;
+        }
+        small.begin(smallCount, SMALL_DATA_SIZE);
+        large.begin(largeCount, particle::protocol::MAX_EVENT_DATA_LENGTH);
+    }
+    _log.info("event pool small=%u x %u large=%u x %u", small.count, small.blockSize, large.count, large.blockSize);
+}
+
+PublishQueueEvent *PublishQueueEventPool::alloc(size_t dataLen) {
+    void *block = NULL;
+
+    WITH_LOCK(*this) {
+        if (dataLen <= SMALL_DATA_SIZE) {
+            block = small.pop();
+        }
+        if (!block && dataLen <= particle::protocol::MAX_EVENT_DATA_LENGTH) {
+            block = large.pop();
+        }
+        if (block) {
+            if (++inUse > highWater) {
+                highWater = inUse;
+            }
+        }
+        else if (small.arena || large.arena) {
+            heapFallbacks++;
+        }
+    }
+    if (!block) {
+        block = new char[sizeof(PublishQueueEvent) + dataLen];
+    }
+    return (PublishQueueEvent *)block;
+}
+
+void PublishQueueEventPool::free(PublishQueueEvent *event) {
+    if (!event) {
+        return;
+    }
+    WITH_LOCK(*this) {
+        if (small.contains(event)) {
+            small.push(event);
+            inUse--;
+            return;
+        }
+        if (large.contains(event)) {
+            large.push(event);
+            inUse--;
+            return;
+        }
+    }
+    delete[] (char *)event;
+}
+
+void PublishQueueEventPool::SizeClass::begin(size_t count, size_t dataSize) {
+    if (count == 0) {
+        return;
+    }
+    blockSize = (sizeof(PublishQueueEvent) + dataSize + 3) & ~3;
+    arena = new char[count * blockSize];
+    if (!arena) {
+        return;
+    }
+    this->count = count;
+    for(size_t ii = 0; ii < count; ii++) {
+        push(&arena[ii * blockSize]);
+    }
+}
+
+void *PublishQueueEventPool::SizeClass::pop() {
+    void *p = freeList;
+    if (p) {
+        freeList = *(void **)p;
+    }
+    return p;
+}
+
+void PublishQueueEventPool::SizeClass::push(void *p) {
+    *(void **)p = freeList;
+    freeList = p;
+}
@@ -0,0 +1,132 @@
+#ifndef __PUBLISHQUEUEEVENTPOOL_H
+#define __PUBLISHQUEUEEVENTPOOL_H
+
+// Github: https://github.com/rickkas7/PublishQueuePosixRK
+// License: MIT
+
+#include "Particle.h"
+
+struct PublishQueueEvent;
+
+/**
+ * @brief Fixed blocks for PublishQueueEvent structures, allocated once
+ *
+ * Every event the queue holds in RAM (queued, being published, read back from flash,
+ * or merged by coalescing) comes from here. There are two size classes: small blocks
+ * for event data up to SMALL_DATA_SIZE bytes, which covers typical telemetry, and
+ * large blocks for the maximum event size. A request that does not fit a free block
+ * of its class, or of the large class, falls back to the heap and is counted, so the
+ * pool can be sized from getHeapFallbacks() and getHighWater().
+ *
+ * Until begin() is called (with non-zero counts) every allocation uses the heap, which
+ * is the original behavior.
+ *
+ * This class is a singleton; you do not create one as a global, on the stack, or with new.
+ * PublishQueuePosix::withEventPool() configures it.
+ */
+class PublishQueueEventPool {
+public:
+    /**
+     * @brief Gets the singleton instance of this class, allocating it if necessary
+     */
+    static PublishQueueEventPool &instance();
+
+    /**
+     * @brief Allocate the blocks. Can only be done once.
+     *
+     * @param smallCount Number of blocks for data up to SMALL_DATA_SIZE bytes
+     * @param largeCount Number of blocks for data up to MAX_EVENT_DATA_LENGTH bytes
+     */
+    void begin(size_t smallCount, size_t largeCount);
+
+    /**
+     * @brief Allocate an event with room for dataLen bytes of data plus a null terminator
+     *
+     * @return The event, or NULL if both the pool and the heap are exhausted. Release it with free().
+     */
+    PublishQueueEvent *alloc(size_t dataLen);
+
+    /**
+     * @brief Release an event from alloc(). NULL is ignored.
+     */
+    void free(PublishQueueEvent *event);
+
+    /**
+     * @brief Number of blocks in use now
+     */
+    size_t getInUse() const { return inUse; };
+
+    /**
+     * @brief Largest number of blocks in use at once since boot
+     */
+    size_t getHighWater() const { return highWater; };
+
+    /**
+     * @brief Number of allocations since boot that did not fit in the pool
+     */
+    uint32_t getHeapFallbacks() const { return heapFallbacks; };
+
+    /**
+     * @brief Largest event data that fits in a small block
+     */
+    static const size_t SMALL_DATA_SIZE = 320;
+
+    /**
+     * @brief Lock the mutex; allocations can happen from the system event handler
+     */
+    void lock() { os_mutex_lock(mutex); };
+
+    /**
+     * @brief Unlock the mutex
+     */
+    void unlock() { os_mutex_unlock(mutex); };
+
+protected:
+    /**
+     * @brief Constructor. Use instance() instead.
+     */
+    PublishQueueEventPool();
+
+    /**
+     * @brief This class is never deleted
+     */
+    virtual ~PublishQueueEventPool();
+
+    /**
+     * @brief This class is not copyable
+     */
+    PublishQueueEventPool(const PublishQueueEventPool&) = delete;
+
+    /**
+     * @brief This class is not copyable
+     */
+    PublishQueueEventPool& operator=(const PublishQueueEventPool&) = delete;
+
+    /**
+     * @brief One size class: a contiguous arena of equal blocks and a free list threaded through them
+     */
+    struct SizeClass {
+        char *arena = 0;        //!< count * blockSize bytes
+        size_t blockSize = 0;   //!< Bytes per block, multiple of 4
+        size_t count = 0;       //!< Number of blocks
+        void *freeList = 0;     //!< First free block; each free block holds the next pointer
+
+        void begin(size_t count, size_t dataSize);
+        bool contains(const void *p) const { return arena && p >= arena && p < arena + count * blockSize; };
+        void *pop();
+        void push(void *p);
+    };
+
+    SizeClass small; //!< Blocks for data up to SMALL_DATA_SIZE
+    SizeClass large; //!< Blocks for data up to MAX_EVENT_DATA_LENGTH
+
+    size_t inUse = 0; //!< Blocks handed out now
+    size_t highWater = 0; //!< Maximum of inUse
+    uint32_t heapFallbacks = 0; //!< Allocations that used the heap after begin()
+
+    os_mutex_t mutex = 0; //!< Protects the free lists and counters
+
+    static PublishQueueEventPool *_instance; //!< singleton instance of this class
+};
+
+#endif /* __PUBLISHQUEUEEVENTPOOL_H */
@@ -0,0 +1,125 @@
+#include "PublishQueuePayloadCodec.h"
+
+PublishQueuePayloadCodec *PublishQueuePayloadCodec::_instance;
+
+static Logger _log("app.pubq");
+
+PublishQueuePayloadCodec &PublishQueuePayloadCodec::instance() {
+    if (!_instance) {
+        _instance = new PublishQueuePayloadCodec();
+    }
+    return *_instance;
+}
+
+void PublishQueuePayloadCodec::setDictionary(const char *const *entries, size_t count) {
+    if (count > MAX_ENTRIES) {
+        _log.error("payload dictionary has %u entries, using %u", count, MAX_ENTRIES);
+        count = MAX_ENTRIES;
+    }
+    for(size_t ii = 0; ii < count; ii++) {
+        size_t len = strlen(entries[ii]);
+        if (len < 2 || len > 255) {
+            _log.error("payload dictionary entry %u is %u characters, packing off", ii, len);
+            count = 0;
+            break;
+        }
+        lengths[ii] = (uint8_t)len;
+    }
+    this->entries = entries;
+    this->count = count;
+}
+
+size_t PublishQueuePayloadCodec::pack(const char *data, char *out, size_t outSize) const {
+    size_t len = strlen(data);
+    if (!count || len < 2 || outSize < len + 1) {
+        return 0;
+    }
+
+    // Stop as soon as the output is no shorter than the input
+    size_t used = 0;
+    out[used++] = (char)count;
+    for(size_t ii = 0; ii < len; ) {
+        // Longest matching entry
+        size_t best = 0;
+        size_t bestLen = 0;
+        for(size_t entry = 0; entry < count; entry++) {
+            size_t entryLen = lengths[entry];
+            if (entryLen > bestLen && entryLen <= len - ii && memcmp(&data[ii], entries[entry], entryLen) == 0) {
+                best = entry;
+                bestLen = entryLen;
+            }
+        }
+        if (bestLen) {
+            if (used + 1 >= len) {
+                return 0;
+            }
+            out[used++] = (char)(TOKEN_BASE + best);
+            ii += bestLen;
+            continue;
+        }
+
+        uint8_t c = (uint8_t)data[ii++];
+        if (c >= TOKEN_BASE) {
+            if (used + 2 >= len) {
+                return 0;
+            }
+            out[used++] = (char)ESCAPE;
+        }
+        else if (used + 1 >= len) {
+            return 0;
+        }
+        out[used++] = (char)c;
+    }
+    out[used] = 0;
+    return used;
+}
+
+size_t PublishQueuePayloadCodec::unpackedLen(const char *packed) const {
+    const uint8_t *p = (const uint8_t *)packed;
+    if (p[0] == 0 || p[0] > count) {
+        return 0;
+    }
+    size_t len = 0;
+    for(p++; *p; p++) {
+        if (*p == ESCAPE) {
+            if (!*++p) {
+                return 0;
+            }
+            len++;
+        }
+        else if (*p >= TOKEN_BASE) {
+            if ((size_t)(*p - TOKEN_BASE) >= count) {
+                return 0;
+            }
+            len += lengths[*p - TOKEN_BASE];
+        }
+        else {
+            len++;
+        }
+    }
+    return len;
+}
+
+bool PublishQueuePayloadCodec::unpack(const char *packed, char *out, size_t outSize) const {
+    size_t len = unpackedLen(packed);
+    if (len == 0 || outSize < len + 1) {
+        return false;
+    }
+    const uint8_t *p = (const uint8_t *)packed + 1;
+    size_t used = 0;
+    for(; *p; p++) {
+        if (*p == ESCAPE) {
+            out[used++] = (char)*++p;
+        }
+        else if (*p >= TOKEN_BASE) {
+            size_t entry = *p - TOKEN_BASE;
+            memcpy(&out[used], entries[entry], lengths[entry]);
+            used += lengths[entry];
+        }
+        else {
+            out[used++] = (char)*p;
+        }
+    }
+    out[used] = 0;
+    return true;
+}
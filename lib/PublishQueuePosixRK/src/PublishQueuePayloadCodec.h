@@ -0,0 +1,114 @@
+#ifndef __PUBLISHQUEUEPAYLOADCODEC_H
+#define __PUBLISHQUEUEPAYLOADCODEC_H
+
+// Github: https://github.com/rickkas7/PublishQueuePosixRK
+// License: MIT
+
+#include "Particle.h"
+
+/**
+ * @brief Dictionary packing of event data while it waits on flash
+ *
+ * Queued events are mostly the same JSON keys with different numbers. With a dictionary
+ * of those strings (PublishQueuePosix::withPayloadDictionary()), each occurrence is
+ * stored as one byte. Events are unpacked when they are read back, so what is published
+ * does not change.
+ *
+ * Packed data is:
+ * - one byte, the number of dictionary entries when it was packed (1 - 127);
+ * - then bytes 0x80 + n for dictionary entry n, 0xff followed by a literal byte of
+ *   0x80 or above, and any other byte as itself.
+ *
+ * Event data never contains 0, and neither does packed data, so packed data is still
+ * a c-string. Data is only packed when that makes it shorter.
+ *
+ * The dictionary must only ever be appended to: events packed by older firmware use
+ * entries by position, and the leading count says how many they could use. An event
+ * packed with more entries than this firmware has cannot be unpacked and is dropped.
+ *
+ * This class is a singleton; you do not create one as a global, on the stack, or with new.
+ */
+class PublishQueuePayloadCodec {
+public:
+    /**
+     * @brief Gets the singleton instance of this class, allocating it if necessary
+     */
+    static PublishQueuePayloadCodec &instance();
+
+    /**
+     * @brief Set the dictionary. Entries are kept by pointer and must stay valid.
+     *
+     * @param entries Strings of 2 to 255 characters
+     * @param count Number of entries, at most MAX_ENTRIES. 0 turns packing off.
+     */
+    void setDictionary(const char *const *entries, size_t count);
+
+    /**
+     * @brief true if a dictionary is set
+     */
+    bool isEnabled() const { return count != 0; };
+
+    /**
+     * @brief Pack data into out
+     *
+     * @param data Event data (c-string)
+     * @param out Buffer for the packed c-string
+     * @param outSize Size of out; strlen(data) + 1 is always enough
+     *
+     * @return Length of the packed data, or 0 if it would not be shorter (out is then unspecified)
+     */
+    size_t pack(const char *data, char *out, size_t outSize) const;
+
+    /**
+     * @brief Length of the unpacked data, without the null terminator
+     *
+     * @return 0 if packed is not valid packed data for this dictionary
+     */
+    size_t unpackedLen(const char *packed) const;
+
+    /**
+     * @brief Unpack packed into out
+     *
+     * @param outSize Size of out, at least unpackedLen(packed) + 1
+     *
+     * @return false if packed is not valid or out is too small
+     */
+    bool unpack(const char *packed, char *out, size_t outSize) const;
+
+    /**
+     * @brief Maximum number of dictionary entries
+     */
+    static const size_t MAX_ENTRIES = 127;
+
+protected:
+    /**
+     * @brief Constructor. Use instance() instead.
+     */
+    PublishQueuePayloadCodec() {};
+
+    /**
+     * @brief This class is never deleted
+     */
+    virtual ~PublishQueuePayloadCodec() {};
+
+    /**
+     * @brief This class is not copyable
+     */
+    PublishQueuePayloadCodec(const PublishQueuePayloadCodec&) = delete;
+
+    /**
+     * @brief This class is not copyable
+     */
+    PublishQueuePayloadCodec& operator=(const PublishQueuePayloadCodec&) = delete;
+
+    static const uint8_t TOKEN_BASE = 0x80; //!< First dictionary token
+    static const uint8_t ESCAPE = 0xff; //!< Next byte is a literal of 0x80 or above
+
+    const char *const *entries = 0; //!< From setDictionary()
+    uint8_t lengths[MAX_ENTRIES] = {}; //!< strlen() of each entry
+    size_t count = 0; //!< Number of entries
+
+    static PublishQueuePayloadCodec *_instance; //!< singleton instance of this class
+};
+
+#endif /* __PUBLISHQUEUEPAYLOADCODEC_H */
@@ -8,6 +8,10 @@
 
 PublishQueuePosix *PublishQueuePosix::_instance;
 
+const uint32_t PublishQueueMetrics::ENQUEUE_LIMITS_US[PublishQueueTiming::NUM_BUCKETS - 1] = { 100, 1000, 10000, 100000 };
+const uint32_t PublishQueueMetrics::WRITE_FILES_LIMITS_US[PublishQueueTiming::NUM_BUCKETS - 1] = { 1000, 5000, 20000, 100000 };
+const uint32_t PublishQueueMetrics::ROUND_TRIP_LIMITS_MS[PublishQueueTiming::NUM_BUCKETS - 1] = { 1000, 2000, 5000, 10000 };
+
 static Logger _log("app.pubq");
 
 
@@ -29,8 +33,32 @@ PublishQueuePosix &PublishQueuePosix::withRamQueueSize(size_t size) {
 }
 
 
+PublishQueuePosix &PublishQueuePosix::withAdaptiveRamQueue(size_t maxSize, size_t minFreeMemory) {
+    adaptiveMax = maxSize;
+    adaptiveMinFree = minFreeMemory;
+    adaptiveSize = ramQueueSize;
+    return *this;
+}
+
+size_t PublishQueuePosix::getRamQueueLimit() const {
+    if (!adaptiveMax) {
+        return ramQueueSize;
+    }
+    if (!Particle.connected()) {
+        return 0;
+    }
+    size_t limit = std::max(adaptiveSize, ramQueueSize);
+    if (limit > ramQueueSize && System.freeMemory() < adaptiveMinFree) {
+        // Over the memory budget; only the configured size
+        limit = ramQueueSize;
+    }
+    return limit;
+}
+
+
 PublishQueuePosix &PublishQueuePosix::withFileQueueSize(size_t size) {
     fileQueueSize = size; 
+    lanes[defaultLane].capacity = size;
 
     if (stateHandler) {
         _log.trace("withFileQueueSize(%u)", fileQueueSize);
@@ -39,6 +67,99 @@ PublishQueuePosix &PublishQueuePosix::withFileQueueSize(size_t size) {
     return *this; 
 }
 
+PublishQueuePosix &PublishQueuePosix::withCoalescedEvent(const char *eventName, const char *batchEventName, const char *arrayKey) {
+    CoalesceRule rule;
+    rule.eventName = eventName;
+    rule.batchEventName = batchEventName;
+    rule.arrayKey = arrayKey ? arrayKey : "";
+    coalesceRules.push_back(rule);
+    return *this;
+}
+
+PublishQueuePosix &PublishQueuePosix::withSegmentStore(const char *dirPath, uint8_t numSegments, size_t segmentSize) {
+    if (stateHandler) {
+        _log.error("withSegmentStore must be called before setup");
+        return *this;
+    }
+    if (fileStore != &dirStore) {
+        delete fileStore;
+    }
+    fileStore = new PublishQueueSegmentStore(dirPath, numSegments, segmentSize);
+    segmentDirPath = dirPath;
+    return *this;
+}
+
+PublishQueuePosix &PublishQueuePosix::withEventPool(size_t smallCount, size_t largeCount) {
+    poolSmallCount = smallCount;
+    poolLargeCount = largeCount;
+    return *this;
+}
+
+PublishQueuePosix &PublishQueuePosix::withPayloadDictionary(const char *const *entries, size_t count) {
+    if (stateHandler) {
+        _log.error("withPayloadDictionary must be called before setup");
+        return *this;
+    }
+    PublishQueuePayloadCodec::instance().setDictionary(entries, count);
+    return *this;
+}
+
+PublishQueuePosix &PublishQueuePosix::withInFlightWindow(size_t count) {
+    if (stateHandler) {
+        _log.error("withInFlightWindow must be called before setup");
+        return *this;
+    }
+    inFlightWindow = constrain(count, (size_t)1, MAX_IN_FLIGHT);
+    return *this;
+}
+
+PublishQueuePosix &PublishQueuePosix::withCompaction(PublishQueueCompactor *compactor, size_t highWater, uint8_t summaryLane) {
+    if (stateHandler || summaryLane >= MAX_LANES) {
+        _log.error("withCompaction must be called before setup with lane < %u", MAX_LANES);
+        return *this;
+    }
+    this->compactor = compactor;
+    compactHighWater = highWater;
+    compactSummaryLane = summaryLane;
+    return *this;
+}
+
+PublishQueuePosix &PublishQueuePosix::withLane(uint8_t lane, size_t capacity, LaneEviction eviction) {
+    if (stateHandler || lane >= MAX_LANES) {
+        _log.error("withLane(%u) must be called before setup with lane < %u", lane, MAX_LANES);
+        return *this;
+    }
+    lanes[lane].enabled = true;
+    lanes[lane].capacity = capacity;
+    lanes[lane].eviction = eviction;
+    return *this;
+}
+
+PublishQueuePosix &PublishQueuePosix::withDefaultLane(uint8_t lane) {
+    if (stateHandler || lane >= MAX_LANES) {
+        _log.error("withDefaultLane(%u) must be called before setup with lane < %u", lane, MAX_LANES);
+        return *this;
+    }
+    defaultLane = lane;
+    return *this;
+}
+
+PublishQueuePosix &PublishQueuePosix::withStorageBudget(size_t maxEvents, uint32_t maxMs) {
+    storageBudgetEvents = maxEvents;
+    storageBudgetMs = maxMs;
+    return *this;
+}
+
+PublishQueuePosix &PublishQueuePosix::withRetainedQueue(void *buf, size_t size) {
+    if (stateHandler) {
+        _log.error("withRetainedQueue must be called before setup");
+        return *this;
+    }
+    retainedBuf = buf;
+    retainedSize = size;
+    return *this;
+}
+
 void PublishQueuePosix::setup() {
     if (system_thread_get_state(nullptr) != spark::feature::ENABLED) {
         _log.error("SYSTEM_THREAD(ENABLED) is required");
@@ -51,44 +172,147 @@ void PublishQueuePosix::setup() {
     System.on(reset | cloud_status, systemEventHandler);
 
     // Start the background publish thread
-    BackgroundPublishRK::instance().start();
+    BackgroundPublishRK::instance().withMaxInFlight(inFlightWindow).start();
+
+    if (poolSmallCount || poolLargeCount) {
+        PublishQueueEventPool::instance().begin(poolSmallCount, poolLargeCount);
+    }
+    if (retainedBuf) {
+        retainedQueue.begin(retainedBuf, retainedSize);
+    }
+
+    Lane &mainLane = lanes[defaultLane];
+    mainLane.enabled = true;
+    mainLane.capacity = fileQueueSize;
+
+    // Lanes have no store until the scan is done; publish() keeps events in RAM meanwhile
+    scanDone = false;
+    scanThread = new Thread("PublishQueueScan", [this]() { scanStores(); }, OS_THREAD_PRIORITY_DEFAULT, 3072);
+
+    stateHandler = &PublishQueuePosix::stateScanWait;
+}
+
+void PublishQueuePosix::scanStores() {
+    unsigned long startMs = millis();
+    PublishQueueStore *stores[MAX_LANES] = {};
+
+    fileStore->scan();
+
+    if (fileStore != &dirStore) {
+        // Move any events left in the one-file-per-event queue into the segments
+        dirStore.scan();
+        while(dirStore.size() > 0) {
+            PublishQueueEvent *event = dirStore.read(0);
+            if (event) {
+                fileStore->append(event);
+                PublishQueueEventPool::instance().free(event);
+            }
+            dirStore.removeFront(1);
+        }
+    }
+    stores[defaultLane] = fileStore;
+
+    for(uint8_t ii = 0; ii < MAX_LANES; ii++) {
+        const Lane &lane = lanes[ii];
+        if (!lane.enabled || stores[ii]) {
+            continue;
+        }
+        if (fileStore == &dirStore) {
+            stores[ii] = new PublishQueueDirStore(String::format("%s-%u", fileQueue.getDirPath(), ii).c_str());
+        }
+        else {
+            PublishQueueSegmentStore *segmentStore = new PublishQueueSegmentStore(String::format("%s-%u", segmentDirPath.c_str(), ii).c_str(), 2, (lane.capacity / 2 + 1) * 256);
+            if (lane.eviction == LaneEviction::DISCARD_NEWEST) {
+                segmentStore->withDiscardNewest();
+            }
+            stores[ii] = segmentStore;
+        }
+        stores[ii]->scan();
+        _log.trace("lane %u capacity=%u queued=%u", ii, lane.capacity, stores[ii]->size());
+    }
+
+    WITH_LOCK(*this) {
+        for(uint8_t ii = 0; ii < MAX_LANES; ii++) {
+            lanes[ii].store = stores[ii];
+        }
+        updateNumEvents();
+    }
+    _log.info("scanned flash queue in %lu ms", millis() - startMs);
+    scanDone = true;
+}
 
-    fileQueue.scanDir();
+void PublishQueuePosix::stateScanWait() {
+    canSleep = false;
 
+    if (!scanDone) {
+        return;
+    }
+    delete scanThread;      // Joins the finished thread
+    scanThread = 0;
+
+    // Events published during the scan go after the ones found on flash
+    holdQueue();
     checkQueueLimits();
 
     stateHandler = &PublishQueuePosix::stateConnectWait;
 }
 
 void PublishQueuePosix::loop() {
+    if (storagePending && scanDone) {
+        // Resume a spill or limit check that ran out of budget
+        storagePending = false;
+        if (getRamQueueLen() && (getFileQueueLen() || getRamQueueLen() > getRamQueueLimit() || !Particle.connected())) {
+            holdQueue();
+        }
+        checkQueueLimits();
+    }
     if (stateHandler) {
         stateHandler(*this);
     }
 }
 
 bool PublishQueuePosix::publishCommon(const char *eventName, const char *eventData, int ttl, PublishFlags flags1, PublishFlags flags2) {
+    return publishLane(defaultLane, eventName, eventData, flags1 | flags2);
+}
 
-    PublishQueueEvent *event = newRamEvent(eventName, eventData, flags1 | flags2);
+bool PublishQueuePosix::publishToLane(uint8_t lane, const char *eventName, const char *eventData, PublishFlags flags1, PublishFlags flags2) {
+    return publishLane(lane, eventName, eventData, flags1 | flags2);
+}
+
+bool PublishQueuePosix::publishLane(uint8_t lane, const char *eventName, const char *eventData, PublishFlags flags) {
+    if (lane >= MAX_LANES || !lanes[lane].enabled) {
+        lane = defaultLane;
+    }
+
+    unsigned long startUs = micros();
+
+    PublishQueueEvent *event = newRamEvent(eventName, eventData, flags);
     if (!event) {
         return false;
     }
-    _log.trace("publishCommon eventName=%s eventData=%s", eventName, eventData ? eventData : "");
+    _log.trace("publishCommon eventName=%s eventData=%s lane=%u", eventName, eventData ? eventData : "", lane);
 
     WITH_LOCK(*this) {
-        ramQueue.push_back(event);
+        lanes[lane].ramQueue.push_back(event);
 
-        _log.trace("fileQueueLen=%u ramQueueLen=%u connected=%d", fileQueue.getQueueLen(), ramQueue.size(), Particle.connected());
+        _log.trace("fileQueueLen=%u ramQueueLen=%u connected=%d", getFileQueueLen(), getRamQueueLen(), Particle.connected());
 
-        if (fileQueue.getQueueLen() == 0 && (ramQueue.size() <= ramQueueSize) && Particle.connected()) {
+        if (getFileQueueLen() == 0 && (getRamQueueLen() <= getRamQueueLimit()) && Particle.connected()) {
             // No files in the disk-based queue, RAM-based queue is not full, and we are cloud connected
             // Leave the event in the RAM queue and return true
             _log.trace("queued to ramQueue");
         }
         else {
-            // We need to move the queue to the file system
-            writeQueueToFiles();
+            // We need to move the queue to the retained queue or the file system
+            holdQueue();
         }
         checkQueueLimits();
+
+        uint32_t depth = getRamQueueLen() + retainedQueue.size() + getFileQueueLen();
+        if (depth > metrics.peakDepth) {
+            metrics.peakDepth = depth;
+        }
+        metrics.enqueueUs.add(micros() - startUs);
     }
 
 
@@ -109,7 +333,7 @@ PublishQueueEvent *PublishQueuePosix::newRamEvent(const char *eventName, const c
 
     PublishQueueEvent *event;
 
-    event = (PublishQueueEvent *) new char[sizeof(PublishQueueEvent) + strlen(eventData)];
+    event = PublishQueueEventPool::instance().alloc(strlen(eventData));
     if (event) {
         event->flags = flags;
         strcpy(event->eventName, eventName);
@@ -119,92 +343,252 @@ PublishQueueEvent *PublishQueuePosix::newRamEvent(const char *eventName, const c
 }
 
 void PublishQueuePosix::writeQueueToFiles() {
+    spillToFiles(false);
+}
 
-    WITH_LOCK(*this) {
-        while(!ramQueue.empty()) {
-            PublishQueueEvent *event = ramQueue.front();
-            ramQueue.pop_front();
-
-            int fileNum = fileQueue.reserveFile();
-
-            int fd = open(fileQueue.getPathForFileNum(fileNum), O_RDWR | O_CREAT);
-            if (fd) {
-                PublishQueueFileHeader hdr;
-                hdr.magic = FILE_MAGIC;
-                hdr.version = FILE_VERSION;
-                hdr.headerSize = sizeof(PublishQueueFileHeader);
-                hdr.nameLen = sizeof(PublishQueueEvent::eventName);
-                write(fd, &hdr, sizeof(hdr));
-
-                write(fd, event, sizeof(PublishQueueEvent) + strlen(event->eventData));
-                close(fd);
-
-                // This message is monitored by the automated test tool. If you edit this, change that too.
-                _log.trace("writeQueueToFiles fileNum=%d", fileNum);
-            }
-            fileQueue.addFileToQueue(fileNum);
-
-            delete event;
-        }
+void PublishQueuePosix::appendToLane(uint8_t lane, const PublishQueueEvent *event) {
+    PublishQueueStore *store = lanes[lane].store;
+    if (lanes[lane].eviction != LaneEviction::DISCARD_NEWEST) {
+        store->append(event);
+    }
+    else if (store->size() >= lanes[lane].capacity || !store->append(event)) {
+        // A lane's segment ring can also run out of bytes before it holds capacity events
+        _log.info("lane %u full, dropped %s", lane, event->eventName);
+        metrics.discarded++;
     }
 }
 
+bool PublishQueuePosix::storageBudgetLeft(size_t done, unsigned long startMs) const {
+    return (!storageBudgetEvents || done < storageBudgetEvents) &&
+           (!storageBudgetMs || millis() - startMs < storageBudgetMs);
+}
+
+void PublishQueuePosix::noteStorageWork(unsigned long startUs, bool finished) {
+    uint32_t elapsedUs = micros() - startUs;
+    if (elapsedUs > metrics.storageWorstUs) {
+        metrics.storageWorstUs = elapsedUs;
+    }
+    if (!finished) {
+        storagePending = true;
+        metrics.storageDeferred++;
+    }
+}
 
-PublishQueueEvent *PublishQueuePosix::readQueueFile(int fileNum) {
-    PublishQueueEvent *result = NULL;
+void PublishQueuePosix::spillToFiles(bool budgeted) {
 
-    int fd = open(fileQueue.getPathForFileNum(fileNum), O_RDONLY);
-    if (fd) {
-        struct stat sb;
-        fstat(fd, &sb);
+    WITH_LOCK(*this) {
+        unsigned long startUs = micros();
+        unsigned long startMs = millis();
+        size_t moved = 0;
+        bool finished = true;
+
+        // Retained events are older than the RAM queue of their lane. Once the budget
+        // is spent everything stays where it is, so no lane is written out of order.
+        retainedQueue.drain([&](uint8_t ii, PublishQueueEvent *event) {
+            if (ii >= MAX_LANES || !lanes[ii].enabled) {
+                ii = defaultLane;
+            }
+            Lane &lane = lanes[ii];
+            if (!lane.store) {
+                return false;
+            }
+            if (budgeted && !storageBudgetLeft(moved, startMs)) {
+                finished = false;
+                return false;
+            }
+            appendToLane(ii, event);
+            PublishQueueEventPool::instance().free(event);
+            moved++;
+            return true;
+        });
+
+        for(uint8_t ii = 0; ii < MAX_LANES; ii++) {
+            Lane &lane = lanes[ii];
+            if (!lane.store) {
+                // Not set up yet; leave the events in RAM
+                continue;
+            }
+            while(!lane.ramQueue.empty()) {
+                if (budgeted && (!finished || !storageBudgetLeft(moved, startMs))) {
+                    finished = false;
+                    break;
+                }
+                PublishQueueEvent *event = lane.ramQueue.front();
+                lane.ramQueue.pop_front();
 
-        _log.trace("fileNum=%d size=%ld", fileNum, sb.st_size);
+                appendToLane(ii, event);
 
-        PublishQueueFileHeader hdr;
-        
-        lseek(fd, 0, SEEK_SET);
-        read(fd, &hdr, sizeof(PublishQueueFileHeader));
-        if (sb.st_size >= (off_t)(sizeof(PublishQueueFileHeader) + sizeof(PublishQueueEvent)) &&
-            hdr.magic == FILE_MAGIC && 
-            hdr.version == FILE_VERSION &&
-            hdr.headerSize == sizeof(PublishQueueFileHeader) &&
-            hdr.nameLen == sizeof(PublishQueueEvent::eventName)) {
+                PublishQueueEventPool::instance().free(event);
+                moved++;
+            }
+        }
 
-            size_t eventSize = sb.st_size - sizeof(PublishQueueFileHeader);
+        if (moved) {
+            metrics.writeFilesUs.add(micros() - startUs);
+            metrics.spilled += moved;
+        }
+        if (budgeted) {
+            noteStorageWork(startUs, finished);
+        }
+        updateNumEvents();
+    }
+}
 
-            result = (PublishQueueEvent *)new char[eventSize];
-            if (result) {
-                read(fd, result, eventSize);
+void PublishQueuePosix::holdQueue() {
+    if (!retainedQueue.enabled()) {
+        spillToFiles(true);
+        return;
+    }
 
-                if (((char *)result)[eventSize - 1] == 0 && strlen(result->eventName) < (sizeof(PublishQueueEvent::eventName) - 1)) {
-                    _log.trace("readQueueFile %d event=%s data=%s", fileNum, result->eventName, result->eventData);
-                }
-                else {
-                    _log.trace("readQueueFile %d corrupted event name or data", fileNum);
-                    delete result;
-                    result = NULL;
+    WITH_LOCK(*this) {
+        for(uint8_t ii = 0; ii < MAX_LANES; ii++) {
+            Lane &lane = lanes[ii];
+            while(!lane.ramQueue.empty()) {
+                PublishQueueEvent *event = lane.ramQueue.front();
+                if (!retainedQueue.append(ii, event)) {
+                    // Full; everything goes to flash, retained events first
+                    _log.trace("retained queue full");
+                    spillToFiles(true);
+                    return;
                 }
+                lane.ramQueue.pop_front();
+                PublishQueueEventPool::instance().free(event);
+                metrics.retainedHeld++;
+            }
+        }
+        updateNumEvents();
+    }
+}
 
+void PublishQueuePosix::restoreRetained() {
+    WITH_LOCK(*this) {
+        size_t restored[MAX_LANES] = {};
+        retainedQueue.drain([&](uint8_t ii, PublishQueueEvent *event) {
+            if (ii >= MAX_LANES || !lanes[ii].enabled) {
+                ii = defaultLane;
             }
-        } else {
-            _log.trace("readQueueFile %d bad magic=%08lx version=%u headerSize=%u nameLen=%u", fileNum, hdr.magic, hdr.version, hdr.headerSize, hdr.nameLen);
+            std::deque<PublishQueueEvent*> &ramQueue = lanes[ii].ramQueue;
+            ramQueue.insert(ramQueue.begin() + requeued[ii] + restored[ii]++, event);
+            return true;
+        });
+        updateNumEvents();
+    }
+}
+
+size_t PublishQueuePosix::getRamQueueLen() const {
+    size_t result = 0;
+    for(uint8_t ii = 0; ii < MAX_LANES; ii++) {
+        result += lanes[ii].ramQueue.size();
+    }
+    return result;
+}
+
+size_t PublishQueuePosix::getFileQueueLen() const {
+    size_t result = 0;
+    for(uint8_t ii = 0; ii < MAX_LANES; ii++) {
+        if (lanes[ii].store) {
+            result += lanes[ii].store->size();
+        }
+    }
+    return result;
+}
+
+PublishQueueEvent *PublishQueuePosix::coalesceFileEvents(PublishQueueEvent *first, uint8_t lane, size_t index, int &batchCount) {
+    batchCount = 1;
+
+    const CoalesceRule *rule = NULL;
+    for (const CoalesceRule &r : coalesceRules) {
+        if (r.eventName.equals(first->eventName)) {
+            rule = &r;
+            break;
         }
+    }
+    if (!rule || rule->batchEventName.length() > particle::protocol::MAX_EVENT_NAME_LENGTH) {
+        return first;
+    }
 
-        close(fd);
+    // Build "[d1,d2,...]" (or {"key":[d1,d2,...]}) in a scratch buffer of the maximum publish size
+    const size_t maxLen = particle::protocol::MAX_EVENT_DATA_LENGTH;
+    if (!coalesceBuf) {
+        // Allocated once and kept, so coalescing does not churn the heap
+        coalesceBuf = new char[maxLen + 1];
+        if (!coalesceBuf) {
+            return first;
+        }
+    }
+    char *buf = coalesceBuf;
+    size_t len = 0;
+    size_t closeLen = 1;
+    if (rule->arrayKey.length()) {
+        len = snprintf(buf, maxLen + 1, "{\"%s\":", rule->arrayKey.c_str());
+        closeLen = 2;
+    }
+    buf[len++] = '[';
+    size_t firstLen = strlen(first->eventData);
+    if (len + firstLen + closeLen > maxLen) {
+        return first;
+    }
+    memcpy(&buf[len], first->eventData, firstLen);
+    len += firstLen;
+
+    int count = 1;
+    while(true) {
+        PublishQueueEvent *next = lanes[lane].store->read(index + count);
+        if (!next) {
+            break;
+        }
+        bool same = (strcmp(next->eventName, first->eventName) == 0) && (next->flags.value() == first->flags.value());
+        size_t nextLen = strlen(next->eventData);
+        bool fits = (len + 1 + nextLen + closeLen) <= maxLen;
+        if (same && fits) {
+            buf[len++] = ',';
+            memcpy(&buf[len], next->eventData, nextLen);
+            len += nextLen;
+            count++;
+        }
+        PublishQueueEventPool::instance().free(next);
+        if (!same || !fits) {
+            break;
+        }
+    }
+    buf[len++] = ']';
+    if (closeLen == 2) {
+        buf[len++] = '}';
+    }
+    buf[len] = 0;
+
+    PublishQueueEvent *result = first;
+    if (count > 1) {
+        result = newRamEvent(rule->batchEventName, buf, first->flags);
+        if (result) {
+            PublishQueueEventPool::instance().free(first);
+            batchCount = count;
+            _log.trace("coalesced %d events into %s (%u bytes)", count, result->eventName, len);
+        }
+        else {
+            result = first;
+        }
     }
     return result;
 }
 
 void PublishQueuePosix::clearQueues() {
     WITH_LOCK(*this) {
-        while(!ramQueue.empty()) {
-            PublishQueueEvent *event = ramQueue.front();
-            ramQueue.pop_front();
+        for(uint8_t ii = 0; ii < MAX_LANES; ii++) {
+            Lane &lane = lanes[ii];
+            while(!lane.ramQueue.empty()) {
+                PublishQueueEvent *event = lane.ramQueue.front();
+                lane.ramQueue.pop_front();
 
-            delete event;
-        }
+                PublishQueueEventPool::instance().free(event);
+            }
 
-        fileQueue.removeAll(true);
+            if (lane.store) {
+                lane.store->clear();
+            }
+        }
+        retainedQueue.clear();
+        updateNumEvents();
     }
 
     _log.trace("clearQueues");
@@ -225,56 +609,293 @@ void PublishQueuePosix::setPausePublishing(bool value) {
 
 void PublishQueuePosix::checkQueueLimits() {
     WITH_LOCK(*this) {
-        if (ramQueue.size() > ramQueueSize) {
-            // RAM queue is too large, move all to files
-            writeQueueToFiles();
+        if (getRamQueueLen() > getRamQueueLimit()) {
+            // RAM queue is too large, move all to the retained queue or files
+            holdQueue();
         }
 
-        while(fileQueue.getQueueLen() > (int)fileQueueSize) {
-            int fileNum = fileQueue.getFileFromQueue(true);
-            if (fileNum) {
-                fileQueue.removeFileNum(fileNum, false);
-                _log.info("discarded event %d", fileNum);
+        // Compactions and discards count against the storage budget; the rest waits for loop()
+        unsigned long startUs = micros();
+        unsigned long startMs = millis();
+        size_t done = 0;
+        bool finished = true;
+        for(uint8_t ii = 0; ii < MAX_LANES && finished; ii++) {
+            Lane &lane = lanes[ii];
+            if (!lane.store) {
+                continue;
+            }
+            if (compactor && ii != compactSummaryLane) {
+                while(lane.store->size() > compactHighWater) {
+                    if (!storageBudgetLeft(done, startMs)) {
+                        finished = false;
+                        break;
+                    }
+                    if (!compactFront(ii)) {
+                        break;
+                    }
+                    done++;
+                }
+            }
+            while(finished && lane.store->size() > lane.capacity) {
+                if (!storageBudgetLeft(done, startMs)) {
+                    finished = false;
+                    break;
+                }
+                _log.info("discarded event %d lane %u", lane.store->frontId(), ii);
+                lane.store->removeFront(1);
+                metrics.discarded++;
+                done++;
             }
         }
+        noteStorageWork(startUs, finished);
+        updateNumEvents();
     }
 }
 
-size_t PublishQueuePosix::getNumEvents() {
+void PublishQueuePosix::updateNumEvents() {
     size_t result = 0;
 
     WITH_LOCK(*this) {
-        result = ramQueue.size();
+        result = getRamQueueLen() + retainedQueue.size();
         if (result == 0) {
-            result = fileQueue.getQueueLen();
-
-            if (curEvent && curFileNum == 0) {
-                // This happens when we are sending an event from the RAM queue
-                // It's not in the RAM queue, but we want to count it, because
-                // otherwise getNumEvents would return 1 for the event sent from
-                // a file (because the file is not deleted until sent) and
-                // this makes the behavior consistent.
-                result++;
+            result = getFileQueueLen();
+
+            for(size_t ii = 0; ii < inFlightCount; ii++) {
+                const InFlight &entry = inFlight[(inFlightHead + ii) % MAX_IN_FLIGHT];
+                if (entry.fileNum == 0) {
+                    // This happens when we are sending an event from the RAM queue
+                    // It's not in the RAM queue, but we want to count it, because
+                    // otherwise getNumEvents would return 1 for the event sent from
+                    // a file (because the file is not deleted until sent) and
+                    // this makes the behavior consistent.
+                    result++;
+                }
+            }
+        }
+        numEvents.store(result, std::memory_order_relaxed);
+    }
+}
+
+PublishQueueMetrics PublishQueuePosix::getMetrics() {
+    PublishQueueMetrics result;
+
+    WITH_LOCK(*this) {
+        result = metrics;
+    }
+    return result;
+}
+
+void PublishQueuePosix::resetMetrics() {
+    WITH_LOCK(*this) {
+        metrics = PublishQueueMetrics();
+    }
+}
+
+uint32_t PublishQueuePosix::getEstimatedDrainMs() {
+    size_t numEvents = getNumEvents();
+
+    uint32_t perEventMs = avgMsPerEvent;
+    if (!perEventMs) {
+        // Not measured yet: one round trip per window, but no faster than the pacing
+        uint32_t roundTripMs = avgPublishMs ? avgPublishMs : DEFAULT_PUBLISH_MS;
+        perEventMs = std::max((uint32_t)waitBetweenPublish, roundTripMs / (uint32_t)inFlightWindow);
+    }
+    return (uint32_t)numEvents * perEventMs;
+}
+
+size_t PublishQueuePosix::getNumEventsInLane(uint8_t lane) {
+    size_t result = 0;
+
+    if (lane < MAX_LANES) {
+        WITH_LOCK(*this) {
+            result = lanes[lane].ramQueue.size() + retainedQueue.sizeInLane(lane);
+            if (lanes[lane].store) {
+                result += lanes[lane].store->size();
+            }
+            for(size_t ii = 0; ii < inFlightCount; ii++) {
+                const InFlight &entry = inFlight[(inFlightHead + ii) % MAX_IN_FLIGHT];
+                if (entry.fileNum == 0 && entry.lane == lane) {
+                    result++;
+                }
             }
         }
     }
     return result;
 }
 
-void PublishQueuePosix::publishCompleteCallback(bool succeeded, const char *eventName, const char *eventData) {
-    publishComplete = true;
-    publishSuccess = succeeded;
+bool PublishQueuePosix::compactFront(uint8_t laneNum) {
+    Lane &lane = lanes[laneNum];
+    Lane &dest = lanes[compactSummaryLane];
+    if (!dest.store || getFilesInFlight(laneNum)) {
+        // Never fold an event that is being published
+        return false;
+    }
+
+    PublishQueueEvent *event = lane.store->read(0);
+    if (!event) {
+        return false;
+    }
+    PublishFlags flags = event->flags;
+    uint32_t group = compactor->groupOf(event);
+    uint32_t nextGroup = 0;
+    size_t count = 0;
+    if (group) {
+        compactor->begin();
+        while(true) {
+            compactor->add(event);
+            PublishQueueEventPool::instance().free(event);
+            count++;
+
+            event = lane.store->read(count);
+            if (!event) {
+                nextGroup = group;
+                break;
+            }
+            nextGroup = compactor->groupOf(event);
+            if (nextGroup != group) {
+                break;
+            }
+        }
+    }
+    PublishQueueEventPool::instance().free(event);
+
+    // The run is only complete once a later group is queued behind it
+    if (!group || !nextGroup || nextGroup == group) {
+        return false;
+    }
+
+    char eventName[particle::protocol::MAX_EVENT_NAME_LENGTH + 1];
+    if (!compactBuf) {
+        // Allocated once and kept, like coalesceBuf
+        compactBuf = new char[particle::protocol::MAX_EVENT_DATA_LENGTH + 1];
+        if (!compactBuf) {
+            return false;
+        }
+    }
+    char *eventData = compactBuf;
+    eventName[0] = eventData[0] = 0;
+
+    bool result = false;
+    if (compactor->finish(eventName, eventData)) {
+        PublishQueueEvent *summary = newRamEvent(eventName, eventData, flags);
+        if (summary) {
+            dest.store->append(summary);
+            PublishQueueEventPool::instance().free(summary);
+
+            lane.store->removeFront(count);
+            metrics.compacted += count;
+            _log.info("compacted %u events in lane %u into %s", count, laneNum, eventName);
+            result = true;
+        }
+    }
+    return result;
+}
+
+size_t PublishQueuePosix::getFilesInFlight(uint8_t lane) const {
+    size_t result = 0;
+    for(size_t ii = 0; ii < inFlightCount; ii++) {
+        const InFlight &entry = inFlight[(inFlightHead + ii) % MAX_IN_FLIGHT];
+        if (entry.fileNum && entry.lane == lane) {
+            result += entry.batchCount;
+        }
+    }
+    return result;
+}
+
+void PublishQueuePosix::publishCompleteCallback(InFlight *entry, bool succeeded, const char *eventName, const char *eventData) {
+    entry->success = succeeded;
+    if (!succeeded) {
+        publishFailed = true;
+    }
+    entry->complete = true;
 
     if (publishCompleteUserCallback) {
         publishCompleteUserCallback(succeeded, eventName, eventData);
     }
 }
 
+bool PublishQueuePosix::retireCompleted() {
+    bool retired = false;
+
+    while(inFlightCount > 0) {
+        InFlight &entry = inFlight[inFlightHead];
+        if (!entry.complete) {
+            break;
+        }
+
+        if (entry.success) {
+            // Remove from the queue
+            _log.trace("publish success %d", entry.fileNum);
+
+            // Averages over about the last four events, for getEstimatedDrainMs()
+            unsigned long now = millis();
+            uint32_t roundTripMs = now - entry.startMs;
+            avgPublishMs = avgPublishMs ? (avgPublishMs * 3 + roundTripMs) / 4 : roundTripMs;
+            metrics.roundTripMs.add(roundTripMs);
+            metrics.published++;
+            if (adaptiveSize < adaptiveMax) {
+                adaptiveSize++;
+            }
+            if (lastRetireMs) {
+                uint32_t perEventMs = (now - lastRetireMs) / (entry.fileNum ? entry.batchCount : 1);
+                avgMsPerEvent = avgMsPerEvent ? (avgMsPerEvent * 3 + perEventMs) / 4 : perEventMs;
+                drainSamples++;
+            }
+
+            if (entry.fileNum) {
+                // Was from the file-based queue. It is only the front if every event
+                // started before it in this lane has been removed.
+                if (lanes[entry.lane].store->frontId() == entry.fileNum) {
+                    // A coalesced publish covers this event and the ones after it
+                    lanes[entry.lane].store->removeFront(entry.batchCount);
+                }
+            }
+            PublishQueueEventPool::instance().free(entry.event);
+            updateNumEvents();
+
+            // Only time the gap to the next success if there is a backlog behind this one
+            lastRetireMs = (getNumEvents() > 0) ? now : 0;
+        }
+        else {
+            // This message is monitored by the automated test tool. If you edit this, change that too.
+            _log.trace("publish failed %d", entry.fileNum);
+            metrics.failures++;
+            adaptiveSize = ramQueueSize;
+
+            if (entry.fileNum) {
+                // Was from the file-based queue, still there
+                PublishQueueEventPool::instance().free(entry.event);
+            }
+            else {
+                // Was in the RAM-based queue, put back in the order it was taken
+                WITH_LOCK(*this) {
+                    std::deque<PublishQueueEvent*> &ramQueue = lanes[entry.lane].ramQueue;
+                    ramQueue.insert(ramQueue.begin() + requeued[entry.lane]++, entry.event);
+                }
+            }
+        }
+
+        entry.event = NULL;
+        inFlightHead = (inFlightHead + 1) % MAX_IN_FLIGHT;
+        inFlightCount--;
+        retired = true;
+    }
+    if (retired) {
+        updateNumEvents();
+    }
+    return retired;
+}
+
 
 void PublishQueuePosix::stateConnectWait() {
     canSleep = (pausePublishing || getNumEvents() == 0);
 
     if (Particle.connected()) {
+        // Drain rate is measured again for each connection, and the RAM queue grows again from its configured size
+        lastRetireMs = 0;
+        drainSamples = 0;
+        adaptiveSize = ramQueueSize;
+
         stateTime = millis();
         durationMs = waitAfterConnect;
         stateHandler = &PublishQueuePosix::stateWait;
@@ -283,13 +904,22 @@ void PublishQueuePosix::stateConnectWait() {
 
 
 void PublishQueuePosix::stateWait() {
+    retireCompleted();
+
+    if (publishFailed) {
+        stateHandler = &PublishQueuePosix::statePublishWait;
+        return;
+    }
+
     if (!Particle.connected()) {
-        stateHandler = &PublishQueuePosix::stateConnectWait;
+        if (inFlightCount == 0) {
+            stateHandler = &PublishQueuePosix::stateConnectWait;
+        }
         return;
     }
 
     if (pausePublishing) {
-        canSleep = true;
+        canSleep = (inFlightCount == 0);
         return;
     }
 
@@ -298,93 +928,121 @@ void PublishQueuePosix::stateWait() {
         return;
     }
     
-    curFileNum = fileQueue.getFileFromQueue(false);
-    if (curFileNum) {
-        curEvent = readQueueFile(curFileNum);
-        if (!curEvent) {
-            // Probably a corrupted file, discard
-            _log.info("discarding corrupted file %d", curFileNum);
-            fileQueue.getFileFromQueue(true);
-            fileQueue.removeFileNum(curFileNum, false);
-        }
+    // Retained events go back in front of the RAM queue of their lane now they can be sent
+    if (retainedQueue.size()) {
+        restoreRetained();
     }
-    else {
-        if (!ramQueue.empty()) {
-            curEvent = ramQueue.front();
-            ramQueue.pop_front();
+
+    // Lanes in priority order; within a lane, events on flash are older than those in RAM.
+    // Skip the flash events already being published.
+    PublishQueueEvent *event = NULL;
+    uint8_t lane = 0;
+    int fileNum = 0;
+    int batchCount = 0;
+    for(uint8_t ii = 0; ii < MAX_LANES; ii++) {
+        Lane &l = lanes[ii];
+        if (!l.store) {
+            continue;
         }
-        else {
-            curEvent = NULL;
+        size_t index = getFilesInFlight(ii);
+        if (l.store->size() > index) {
+            lane = ii;
+            fileNum = l.store->idAt(index);
+            event = l.store->read(index);
+            batchCount = 1;
+            if (event && !coalesceRules.empty()) {
+                event = coalesceFileEvents(event, ii, index, batchCount);
+            }
+            if (!event) {
+                if (index == 0) {
+                    // Probably a corrupted file, discard
+                    _log.info("discarding corrupted file %d", fileNum);
+                    l.store->removeFront(1);
+                    metrics.discarded++;
+                    updateNumEvents();
+                }
+                // Otherwise it is discarded when it reaches the front
+                fileNum = 0;
+            }
+            break;
+        }
+        if (!l.ramQueue.empty()) {
+            lane = ii;
+            event = l.ramQueue.front();
+            l.ramQueue.pop_front();
+            break;
         }
     }
 
-    if (curEvent) {
+    if (event) {
+        InFlight &entry = inFlight[(inFlightHead + inFlightCount) % MAX_IN_FLIGHT];
+        entry.event = event;
+        entry.lane = lane;
+        entry.fileNum = fileNum;
+        entry.batchCount = (fileNum ? batchCount : 0);
+        entry.startMs = millis();
+        entry.complete = false;
+        entry.success = false;
+        inFlightCount++;
+        updateNumEvents();
+
         stateTime = millis();
-        stateHandler = &PublishQueuePosix::statePublishWait;
-        publishComplete = false;
-        publishSuccess = false;
+        durationMs = waitBetweenPublish;
+        if (inFlightCount >= inFlightWindow) {
+            stateHandler = &PublishQueuePosix::statePublishWait;
+        }
         canSleep = false;
 
         // This message is monitored by the automated test tool. If you edit this, change that too.
-        _log.trace("publishing %s event=%s data=%s", (curFileNum ? "file" : "ram"), curEvent->eventName, curEvent->eventData);
+        _log.trace("publishing %s event=%s data=%s", (fileNum ? "file" : "ram"), event->eventName, event->eventData);
 
-        if (BackgroundPublishRK::instance().publish(curEvent->eventName, curEvent->eventData, curEvent->flags, 
+        if (BackgroundPublishRK::instance().publish(event->eventName, event->eventData, event->flags, 
             [this](bool succeeded, const char *eventName, const char *eventData, const void *context) {
-                publishCompleteCallback(succeeded, eventName, eventData);
-            })) {
+                publishCompleteCallback((InFlight *)context, succeeded, eventName, eventData);
+            }, &entry)) {
             // Successfully started publish
         }
+        else {
+            // No free slot in the background publisher; treat as a failed publish
+            publishCompleteCallback(&entry, false, event->eventName, event->eventData);
+        }
     }
     else {
-        // No events, can sleep
-        canSleep = true;
+        // No events to start, can sleep once the window is empty
+        canSleep = (inFlightCount == 0);
     }
 }
-void PublishQueuePosix::statePublishWait() {
-    if (!publishComplete) {
-        return;
-    }
 
-    if (publishSuccess) {
-        // Remove from the queue
-        _log.trace("publish success %d", curFileNum);
+void PublishQueuePosix::statePublishWait() {
+    bool retired = retireCompleted();
 
-        if (curFileNum) {
-            // Was from the file-based queue
-            int fileNum = fileQueue.getFileFromQueue(false);
-            if (fileNum == curFileNum) {
-                fileQueue.getFileFromQueue(true);
-                fileQueue.removeFileNum(fileNum, false);
-                _log.trace("removed file %d", fileNum);
-            }
-            curFileNum = 0;
+    if (publishFailed) {
+        if (inFlightCount > 0) {
+            // Let the rest of the window finish before retrying
+            return;
         }
+        publishFailed = false;
 
-        delete curEvent;
-        curEvent = NULL;
-        durationMs = waitBetweenPublish;
-    }
-    else {
         // Wait and retry
-        // This message is monitored by the automated test tool. If you edit this, change that too.
-        _log.trace("publish failed %d", curFileNum);
         durationMs = waitAfterFailure;
 
-        if (curFileNum) {
-            // Was from the file-based queue
-            delete curEvent;
-            curEvent = NULL;
+        bool anyRequeued = false;
+        for(uint8_t ii = 0; ii < MAX_LANES; ii++) {
+            anyRequeued |= (requeued[ii] != 0);
+            requeued[ii] = 0;
         }
-        else {
-            // Was in the RAM-based queue, put back
-            WITH_LOCK(*this) {
-                ramQueue.push_front(curEvent);
-            }
-            // Then write the entire queue to files
-            _log.trace("writing to files after publish failure");
-            writeQueueToFiles();
+        if (anyRequeued) {
+            // Then move the entire queue out of RAM
+            _log.trace("holding queue after publish failure");
+            holdQueue();
         }
     }
+    else if (retired && inFlightCount < inFlightWindow) {
+        durationMs = waitBetweenPublish;
+    }
+    else {
+        return;
+    }
 
     stateHandler = &PublishQueuePosix::stateWait;
     stateTime = millis();
@@ -392,17 +1050,30 @@ void PublishQueuePosix::statePublishWait() {
 
 
 PublishQueuePosix::PublishQueuePosix() {
-    fileQueue.withDirPath("/usr/pubqueue");
+    fileQueue.withDirPath("/usr/pubqueue").withIndex();
 }
 
 PublishQueuePosix::~PublishQueuePosix() {
+    for(uint8_t ii = 0; ii < MAX_LANES; ii++) {
+        if (lanes[ii].store != fileStore) {
+            delete lanes[ii].store;
+        }
+    }
+    if (fileStore != &dirStore) {
+        delete fileStore;
+    }
 
 }
 
 void PublishQueuePosix::systemEventHandler(system_event_t event, int param) {
-    if ((event == reset) || ((event == cloud_status) && (param == cloud_status_disconnecting))) {
-        _log.trace("reset or disconnect event, save files to queue");
+    if (event == reset) {
+        _log.trace("reset event, save files to queue");
         PublishQueuePosix::instance().writeQueueToFiles();
     }
+    else if ((event == cloud_status) && (param == cloud_status_disconnecting)) {
+        // Retained RAM survives the nap that usually follows; flash only without it
+        _log.trace("disconnect event, hold queue");
+        PublishQueuePosix::instance().holdQueue();
+    }
 }
 
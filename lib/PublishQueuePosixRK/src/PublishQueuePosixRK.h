@@ -6,8 +6,13 @@
 
 #include "Particle.h"
 #include "SequentialFileRK.h"
+#include "PublishQueueStore.h"
+#include "PublishQueueEventPool.h"
+#include "PublishQueueRetained.h"
 
+#include <atomic>
 #include <deque>
+#include <vector>
 
 /**
  * @brief Structure stored before the event data in files on the flash file system
@@ -18,7 +23,7 @@
  */
 struct PublishQueueFileHeader {
     uint32_t magic;         //!< PublishQueuePosix::FILE_MAGIC = 0x31b67663
-    uint8_t version;        //!< PublishQueuePosix::FILE_VERSION = 1
+    uint8_t version;        //!< PublishQueuePosix::FILE_VERSION = 1, or FILE_VERSION_PACKED = 2
     uint8_t headerSize;     //!< sizeof(PublishQueueFileHeader) = 8
     uint16_t nameLen;       //!< sizeof(PublishQueueEvent::eventName) = 64
 };
@@ -40,6 +45,116 @@ struct PublishQueueEvent {
     char eventData[1]; //!< Variable size event data
 };
 
+/**
+ * @brief Folds a run of old queued events into one summary event, for PublishQueuePosix::withCompaction()
+ * 
+ * The queue reads events from the front of a lane, oldest first. Consecutive events with the
+ * same non-zero groupOf() form a run; the run is only folded once an event of a different,
+ * non-zero group is queued behind it, so a group that may still grow (today, for example) is
+ * left alone. All methods are called with the queue mutex held.
+ */
+class PublishQueueCompactor {
+public:
+    virtual ~PublishQueueCompactor() {};
+
+    /**
+     * @brief Group of a queued event, or 0 if the event cannot be folded
+     */
+    virtual uint32_t groupOf(const PublishQueueEvent *event) = 0;
+
+    /**
+     * @brief Start a new summary
+     */
+    virtual void begin() = 0;
+
+    /**
+     * @brief Add the next event of the run, oldest first
+     */
+    virtual void add(const PublishQueueEvent *event) = 0;
+
+    /**
+     * @brief Write the summary of the events added since begin()
+     * 
+     * @param eventName Receives the event name, MAX_EVENT_NAME_LENGTH + 1 bytes
+     * @param eventData Receives the event data, MAX_EVENT_DATA_LENGTH + 1 bytes
+     * 
+     * @return false to leave the events queued as they are
+     */
+    virtual bool finish(char *eventName, char *eventData) = 0;
+};
+
+/**
+ * @brief Count, maximum, average and histogram of one kind of duration, for PublishQueueMetrics
+ */
+class PublishQueueTiming {
+public:
+    static const size_t NUM_BUCKETS = 5; //!< Histogram buckets, split at limits
+
+    /**
+     * @brief Constructor
+     * 
+     * @param limits NUM_BUCKETS - 1 ascending bucket boundaries (static storage)
+     */
+    explicit PublishQueueTiming(const uint32_t *limits) : limits(limits) {};
+
+    uint32_t count = 0;     //!< Number of samples
+    uint32_t max = 0;       //!< Largest sample
+    uint64_t total = 0;     //!< Sum of samples, for the average
+    uint32_t histogram[NUM_BUCKETS] = {}; //!< Samples per bucket
+    const uint32_t *limits; //!< Bucket n holds samples < limits[n]; the last holds the rest
+
+    /**
+     * @brief Average sample (0 if none)
+     */
+    uint32_t avg() const { return count ? (uint32_t)(total / count) : 0; };
+
+    /**
+     * @brief Record one sample
+     */
+    void add(uint32_t value) {
+        size_t bucket = 0;
+        while (bucket < NUM_BUCKETS - 1 && value >= limits[bucket]) {
+            bucket++;
+        }
+        histogram[bucket]++;
+        count++;
+        total += value;
+        if (value > max) {
+            max = value;
+        }
+    };
+};
+
+/**
+ * @brief Publish queue instrumentation, collected since boot
+ */
+struct PublishQueueMetrics {
+    static const uint32_t ENQUEUE_LIMITS_US[PublishQueueTiming::NUM_BUCKETS - 1];     //!< 100 us, 1 ms, 10 ms, 100 ms
+    static const uint32_t WRITE_FILES_LIMITS_US[PublishQueueTiming::NUM_BUCKETS - 1]; //!< 1 ms, 5 ms, 20 ms, 100 ms
+    static const uint32_t ROUND_TRIP_LIMITS_MS[PublishQueueTiming::NUM_BUCKETS - 1];  //!< 1 s, 2 s, 5 s, 10 s
+
+    PublishQueueTiming enqueueUs{ENQUEUE_LIMITS_US}; //!< publish() call duration, including any move to flash
+    PublishQueueTiming writeFilesUs{WRITE_FILES_LIMITS_US}; //!< writeQueueToFiles() duration, when it moved events
+    PublishQueueTiming roundTripMs{ROUND_TRIP_LIMITS_MS}; //!< Start of a publish to its acknowledgement
+    uint32_t published = 0; //!< Successful publishes (a coalesced batch counts once)
+    uint32_t failures = 0;  //!< Failed publishes; each event is retried after waitAfterFailure
+    uint32_t discarded = 0; //!< Events dropped: lane full, checkQueueLimits(), or corrupted on flash
+    uint32_t compacted = 0; //!< Events folded into summaries by withCompaction()
+    uint32_t peakDepth = 0; //!< Largest getNumEvents() seen after queueing an event
+    uint32_t retainedHeld = 0; //!< Events kept in the retained queue instead of being written to flash
+    uint32_t spilled = 0; //!< Events written to flash from the RAM or retained queue
+    uint32_t storageWorstUs = 0; //!< Longest budgeted spill or checkQueueLimits() call, see withStorageBudget()
+    uint32_t storageDeferred = 0; //!< Budgeted calls that ran out of budget and left work for loop()
+};
+
+/**
+ * @brief What a priority lane does when it holds its capacity of events
+ */
+enum class LaneEviction {
+    DISCARD_OLDEST, //!< Remove the oldest event in the lane to make room (default)
+    DISCARD_NEWEST  //!< Drop the incoming event and keep what is already queued
+};
+
 /**
  * @brief Class for asynchronous publishing of events
  * 
@@ -75,6 +190,27 @@ public:
      */
     size_t getRamQueueSize() const { return ramQueueSize; };
 
+    /**
+     * @brief Let the RAM queue grow while the queue is connected and publishing
+     * 
+     * @param maxSize Largest RAM queue size
+     * @param minFreeMemory Free heap, in bytes, below which the RAM queue does not grow past withRamQueueSize()
+     * 
+     * The RAM queue starts at withRamQueueSize() on each connect and grows by one event
+     * for each successful publish, up to maxSize, so a burst while the queue is draining
+     * stays in RAM instead of being written to flash. A failed publish puts it back to
+     * withRamQueueSize(), and while not connected it is 0, so nothing is left in RAM
+     * across a disconnect or sleep. Size the event pool (withEventPool()) for maxSize.
+     * 
+     * Off (maxSize 0) by default; the RAM queue is then always withRamQueueSize().
+     */
+    PublishQueuePosix &withAdaptiveRamQueue(size_t maxSize, size_t minFreeMemory);
+
+    /**
+     * @brief Gets the RAM queue size in effect now
+     */
+    size_t getRamQueueLimit() const;
+
     /**
      * @brief Sets the file-based queue size (default is 100)
      * 
@@ -112,6 +248,181 @@ public:
      */
     const char *getDirPath() const { return fileQueue.getDirPath(); };
 
+    /**
+     * @brief Store the file-based queue in a ring of fixed-size segment files instead of one file per event
+     * 
+     * @param dirPath Directory for the segment files. Use a different directory than withDirPath().
+     * @param numSegments Number of segment files (2 - 16)
+     * @param segmentSize Size of each segment file in bytes
+     * 
+     * Events are appended to the current segment and removed by advancing an offset in
+     * its header, so queueing and sending do not create or delete files and setup() reads
+     * a few headers instead of the whole queue directory. See PublishQueueSegmentStore.
+     * 
+     * The total space (numSegments * segmentSize) also limits the queue: when the ring is
+     * full, the oldest segment is reused and its events are discarded. withFileQueueSize()
+     * still applies as well.
+     * 
+     * Must be called before setup(). Events left in the withDirPath() directory by the
+     * one-file-per-event format are moved into the segments by setup().
+     */
+    PublishQueuePosix &withSegmentStore(const char *dirPath, uint8_t numSegments, size_t segmentSize);
+
+    /**
+     * @brief Add a priority lane with its own capacity and eviction policy
+     * 
+     * @param lane Lane number, 0 to MAX_LANES - 1. Lower numbers are sent first.
+     * @param capacity Maximum number of events queued on flash in this lane
+     * @param eviction What to do when the lane is full
+     * 
+     * Every lane is a separate queue (RAM and flash). After a connection, all of lane 0
+     * is sent, then lane 1, and so on; a new event in a higher-priority lane goes ahead
+     * of anything still queued in lower ones. Events from publishToLane() go to the given
+     * lane; all other publishes go to the default lane (see withDefaultLane()).
+     * 
+     * Lanes other than the default one get their own store next to the main one: a
+     * directory named after withDirPath() plus "-<lane>", or two segments named after
+     * withSegmentStore() plus "-<lane>" sized for capacity events of about 256 bytes.
+     * 
+     * Must be called before setup().
+     */
+    PublishQueuePosix &withLane(uint8_t lane, size_t capacity, LaneEviction eviction = LaneEviction::DISCARD_OLDEST);
+
+    /**
+     * @brief Fold old events into summaries when a lane's flash queue gets long, before any are discarded
+     * 
+     * @param compactor Decides which events fold together and writes the summary (not owned)
+     * @param highWater Compact a lane while it holds more than this many events on flash
+     * @param summaryLane Lane that receives the summary events
+     * 
+     * checkQueueLimits() runs this before it discards anything. For each lane other than
+     * summaryLane that is over highWater, it folds the run of events at the front (see
+     * PublishQueueCompactor) into one summary, appends the summary to summaryLane and
+     * removes the run, repeating until the lane is at highWater or the front cannot be
+     * folded. Only if the lane is still over capacity are events discarded.
+     * 
+     * Use a summaryLane of its own: summaries appended to the lane being compacted stop
+     * the next run from being complete until they are sent. Must be called before setup().
+     */
+    PublishQueuePosix &withCompaction(PublishQueueCompactor *compactor, size_t highWater, uint8_t summaryLane);
+
+    /**
+     * @brief Preallocate fixed blocks for events in RAM at setup()
+     * 
+     * @param smallCount Blocks for event data up to PublishQueueEventPool::SMALL_DATA_SIZE bytes
+     * @param largeCount Blocks for event data up to MAX_EVENT_DATA_LENGTH bytes
+     * 
+     * Without this, each event is a separate heap allocation when it is published and
+     * again each time it is read back from flash. With it, events use the blocks and the
+     * heap is only used when they are all taken (see PublishQueueEventPool). Size it for
+     * the RAM queue plus the event being sent plus, with coalescing, two more.
+     * 
+     * Must be called before setup().
+     */
+    PublishQueuePosix &withEventPool(size_t smallCount, size_t largeCount);
+
+    /**
+     * @brief Keep events that would go to flash in a retained RAM buffer instead
+     * 
+     * @param buf A `retained` array, so it survives sleep and reset
+     * @param size Size of buf in bytes
+     * 
+     * When an event cannot stay in the RAM queue (offline, or the RAM queue is full), the
+     * RAM queue moves to this buffer rather than to flash, and moves back when publishing
+     * resumes. Events only go to flash when the buffer is full, on reset, or when
+     * writeQueueToFiles() is called, which the application must do before a sleep that
+     * does not keep retained RAM (HIBERNATE). Within a lane, events on flash are sent
+     * first, then the retained ones, then the RAM queue. Records are CRC checked at
+     * setup(), so events left by an unexpected reset are still sent.
+     * 
+     * Must be called before setup().
+     */
+    PublishQueuePosix &withRetainedQueue(void *buf, size_t size);
+
+    /**
+     * @brief Number of events in the retained queue
+     */
+    size_t getRetainedQueueLen() const { return retainedQueue.size(); };
+
+    /**
+     * @brief Store queued event data packed with a dictionary of common strings
+     * 
+     * @param entries Strings of 2 to 255 characters, kept by pointer
+     * @param count Number of entries, at most PublishQueuePayloadCodec::MAX_ENTRIES
+     * 
+     * Each occurrence of an entry in event data written to flash is stored as one byte, and
+     * events are unpacked when read back, so published data is unchanged. Only append to
+     * the dictionary: events already on flash refer to entries by position (see
+     * PublishQueuePayloadCodec). Must be called before setup().
+     */
+    PublishQueuePosix &withPayloadDictionary(const char *const *entries, size_t count);
+
+    /**
+     * @brief Number of publishes that may wait for the cloud at the same time (default 1)
+     * 
+     * @param count 1 to MAX_IN_FLIGHT
+     * 
+     * With 1, each event is published only after the previous one has been acknowledged,
+     * so a backlog costs a full cloud round trip per event. With more, the next event is
+     * started waitBetweenPublish (1 second) after the previous one was started, which
+     * keeps to the Device OS publish rate limit, until count are outstanding. Events are
+     * still started in queue order and removed from flash in queue order as each one is
+     * acknowledged.
+     * 
+     * After a failure no more events are started; the ones outstanding are allowed to
+     * finish, then the queue waits waitAfterFailure as before. An event acknowledged
+     * behind a failed one stays queued and is sent again, so the cloud may see it twice.
+     * 
+     * Must be called before setup().
+     */
+    PublishQueuePosix &withInFlightWindow(size_t count);
+
+    /**
+     * @brief Limit the flash work done by one publish, holdQueue() or checkQueueLimits() call
+     * 
+     * @param maxEvents Events written, discarded or compacted per call (0 = no limit)
+     * 
+     * @param maxMs Milliseconds per call (0 = no limit)
+     * 
+     * A full flash queue can otherwise make one publish() write out the whole RAM queue and
+     * discard dozens of files. Whatever is left is resumed by the next loop(), in queue order.
+     * One event write or file delete is never split, so a call can overrun maxMs by one
+     * operation; getMetrics().storageWorstUs has the longest call. writeQueueToFiles(), which
+     * the application calls before a sleep that loses RAM, and the reset handler always
+     * finish. The default is no limit.
+     */
+    PublishQueuePosix &withStorageBudget(size_t maxEvents, uint32_t maxMs);
+
+    /**
+     * @brief Gets the in-flight window from withInFlightWindow()
+     */
+    size_t getInFlightWindow() const { return inFlightWindow; };
+
+    /**
+     * @brief Sets the lane used by publish() (default is 0)
+     * 
+     * @param lane Lane number, 0 to MAX_LANES - 1
+     * 
+     * The default lane uses the main store (withDirPath() or withSegmentStore()) and its
+     * capacity is withFileQueueSize(). Must be called before setup().
+     */
+    PublishQueuePosix &withDefaultLane(uint8_t lane);
+
+    /**
+     * @brief Gets a copy of the instrumentation collected since boot (or resetMetrics())
+     */
+    PublishQueueMetrics getMetrics();
+
+    /**
+     * @brief Clear the instrumentation
+     */
+    void resetMetrics();
+
+    /**
+     * @brief Gets the number of events queued in one lane, RAM and flash
+     */
+    size_t getNumEventsInLane(uint8_t lane);
+
     /**
      * @brief Adds a callback function to call with publish is complete
      * 
@@ -134,11 +445,46 @@ public:
     PublishQueuePosix &withPublishCompleteUserCallback(std::function<void(bool succeeded, const char *eventName, const char *eventData)> cb) { publishCompleteUserCallback = cb; return *this; };
 
 
+    /**
+     * @brief Merge a backlog of one event into fewer, larger publishes
+     * 
+     * @param eventName The event to coalesce (for example, the hourly webhook event)
+     * 
+     * @param batchEventName The event name used for a merged publish
+     * 
+     * @param arrayKey (optional) If set, the array is wrapped in an object under this key,
+     * {"key":[...]}, which is easier to address from a webhook template
+     * 
+     * When the next event to send comes from the file queue and is eventName, the
+     * following queued events are read too, for as long as they are also eventName and
+     * the merged data fits in MAX_EVENT_DATA_LENGTH. They are sent as one batchEventName
+     * publish whose data is a JSON array of the original payloads:
+     * 
+     *     [{...},{...},{...}]
+     * 
+     * Every original payload must therefore be a JSON value. Queue order is kept; the
+     * run stops at the first other event. A run of one is sent unchanged as eventName.
+     * All the files in the run are removed only after the merged publish succeeds.
+     * 
+     * Can be called more than once to coalesce several events.
+     */
+    PublishQueuePosix &withCoalescedEvent(const char *eventName, const char *batchEventName, const char *arrayKey = NULL);
+
     /**
      * @brief You must call this from setup() to initialize this library
+     * 
+     * The flash queues are scanned in a background thread, so setup() does not wait
+     * for hundreds of queued files after an outage. Until the scan is done, publish()
+     * keeps events in RAM and nothing is sent; then they are appended after the
+     * events found on flash, and draining starts. See isScanned().
      */
     void setup();
 
+    /**
+     * @brief true once the background scan from setup() has finished
+     */
+    bool isScanned() const { return scanDone; };
+
     /**
      * @brief You must call the loop method from the global loop() function!
      */
@@ -206,6 +552,23 @@ public:
 		return publishCommon(eventName, data, ttl, flags1, flags2);
 	}
 
+	/**
+	 * @brief Publish an event in a priority lane
+	 *
+	 * @param lane A lane added with withLane(). An unknown lane is treated as the default lane.
+	 *
+	 * @param eventName The name of the event (63 character maximum).
+	 *
+	 * @param data The event data.
+	 *
+	 * @param flags1 Normally PRIVATE.
+	 *
+	 * @param flags2 (optional) You can use NO_ACK or WITH_ACK if desired.
+	 *
+	 * @return true if the event was queued or false if it was not.
+	 */
+	bool publishToLane(uint8_t lane, const char *eventName, const char *data, PublishFlags flags1, PublishFlags flags2 = PublishFlags());
+
 	/**
 	 * @brief Common publish function. All other overloads lead here. This is a pure virtual function, implemented in subclasses.
 	 *
@@ -229,7 +592,7 @@ public:
 	virtual bool publishCommon(const char *eventName, const char *data, int ttl, PublishFlags flags1, PublishFlags flags2 = PublishFlags());
 
     /**
-     * @brief If there are events in the RAM queue, write them to files in the flash file system
+     * @brief If there are events in the RAM or retained queue, write them to files in the flash file system
      */
     void writeQueueToFiles();
 
@@ -263,8 +626,10 @@ public:
      * 
      * If pausePublishing is true, then return true if either the current publish has
      * completed, or not cloud connected.
+     *
+     * Lock-free; safe from any thread.
      */
-    bool getCanSleep() const { return canSleep; };
+    bool getCanSleep() const { return canSleep.load(std::memory_order_relaxed); };
 
     /**
      * @brief Gets the total number of events queued
@@ -274,8 +639,36 @@ public:
      * so this command does not need to access the file system.
      * 
      * If an event is currently being sent, the result includes this event.
+     *
+     * Lock-free: the count is kept in an atomic, recounted under the queue
+     * mutex whenever an event is queued, moved, sent or discarded, so polling
+     * it never waits on the publish thread or the flash stores.
+     */
+    size_t getNumEvents() const { return numEvents.load(std::memory_order_relaxed); };
+
+    /**
+     * @brief Estimated time to send everything queued now, in milliseconds
+     * 
+     * getNumEvents() times the average time it has recently taken to remove one event
+     * from the queue while a backlog was draining. That measurement includes the round
+     * trip, pacing, the in-flight window, coalescing and retries, so it reflects the
+     * current link. Until there is a measurement, one publish round trip (or
+     * waitBetweenPublish, if longer) per in-flight window is assumed.
+     */
+    uint32_t getEstimatedDrainMs();
+
+    /**
+     * @brief Number of drain rate measurements since the current cloud connection was made
+     * 
+     * getEstimatedDrainMs() uses older measurements until there are some from this
+     * connection; use this to decide how much to trust it.
      */
-    size_t getNumEvents();
+    size_t getDrainSamples() const { return drainSamples; };
+
+    /**
+     * @brief Average time from starting a publish to its acknowledgement, in milliseconds (0 if none yet)
+     */
+    uint32_t getAvgPublishMs() const { return avgPublishMs; };
 
     /**
      * @brief Check the queue limit, discarding events as necessary
@@ -312,6 +705,26 @@ public:
      */
     static const uint8_t FILE_VERSION = 1;
 
+    /**
+     * @brief Version of the file header for events whose data is packed (PublishQueuePayloadCodec)
+     */
+    static const uint8_t FILE_VERSION_PACKED = 2;
+
+    /**
+     * @brief Number of priority lanes
+     */
+    static const uint8_t MAX_LANES = 5;
+
+    /**
+     * @brief Maximum value for withInFlightWindow()
+     */
+    static const size_t MAX_IN_FLIGHT = 4;
+
+    /**
+     * @brief Publish round trip assumed by getEstimatedDrainMs() before one has been measured
+     */
+    static const uint32_t DEFAULT_PUBLISH_MS = 3000;
+
 protected:
     /**
      * @brief Constructor 
@@ -346,25 +759,96 @@ protected:
      * 
      * May return NULL if eventName or eventData are invalid (too long) or out of memory.
      * 
-     * You must delete the result from this method when you are done using it. 
+     * Release the result with PublishQueueEventPool::instance().free() when you are done using it. 
      */
     PublishQueueEvent *newRamEvent(const char *eventName, const char *eventData, PublishFlags flags);
 
     /**
-     * @brief Read an event from a sequentially numbered file 
+     * @brief Queue an event in a lane. publishCommon() and publishToLane() lead here.
+     */
+    bool publishLane(uint8_t lane, const char *eventName, const char *eventData, PublishFlags flags);
+
+    /**
+     * @brief Number of events in the RAM queues of all lanes
+     */
+    size_t getRamQueueLen() const;
+
+    /**
+     * @brief Number of events in the flash stores of all lanes
+     */
+    size_t getFileQueueLen() const;
+
+    /**
+     * @brief Recount the queue into numEvents after a change; takes the queue mutex
+     */
+    void updateNumEvents();
+
+    /**
+     * @brief Merge the file-queue events that follow first into one event, if a coalescing rule applies
      * 
-     * @param fileNum The file number to read 
+     * @param first Event read from position index of the lane's file queue
+     * @param lane Lane the event was read from
+     * @param index Position of first in the lane's file queue
+     * @param batchCount Set to the number of file queue events the returned event covers
      * 
-     * May return NULL if file does not exist, or out of memory.
+     * @return first if no rule applies or there is nothing to merge, otherwise a new event (first is
+     * deleted).
+     */
+    PublishQueueEvent *coalesceFileEvents(PublishQueueEvent *first, uint8_t lane, size_t index, int &batchCount);
+
+    /**
+     * @brief One publish that has been started and not yet retired
+     */
+    struct InFlight {
+        PublishQueueEvent *event = 0; //!< Event being published
+        uint8_t lane = 0; //!< Lane of event
+        int fileNum = 0; //!< store->idAt() of the event when started (0 if from RAM queue)
+        int batchCount = 0; //!< Number of file queue events covered by event (more than 1 when coalesced)
+        unsigned long startMs = 0; //!< millis() when the publish was started
+        volatile bool complete = false; //!< true if the publish has completed (successfully or not)
+        volatile bool success = false; //!< true if the publish succeeded
+    };
+
+    /**
+     * @brief Fold the run of events at the front of a lane into one summary (withCompaction())
      * 
-     * You must delete the result from this method when you are done using it. 
+     * @return true if the lane got shorter
      */
-    PublishQueueEvent *readQueueFile(int fileNum);
+    bool compactFront(uint8_t lane);
 
     /**
      * @brief Callback for BackgroundPublishRK library
      */
-    void publishCompleteCallback(bool succeeded, const char *eventName, const char *eventData);
+    void publishCompleteCallback(InFlight *entry, bool succeeded, const char *eventName, const char *eventData);
+
+    /**
+     * @brief Number of file queue events in a lane that are covered by in-flight publishes
+     */
+    size_t getFilesInFlight(uint8_t lane) const;
+
+    /**
+     * @brief Handle completed publishes at the front of the window, in the order they were started
+     * 
+     * A successful event is removed from its lane; a failed RAM event goes back to the front of
+     * its RAM queue. Returns true if any were retired.
+     */
+    bool retireCompleted();
+
+    /**
+     * @brief Body of the scan thread started by setup()
+     * 
+     * Scans each lane's flash store and moves any one-file-per-event queue into the
+     * segments, without the queue lock; the stores are attached to the lanes under
+     * the lock at the end.
+     */
+    void scanStores();
+
+    /**
+     * @brief State handler for waiting for the scan thread
+     * 
+     * Next state: stateConnectWait
+     */
+    void stateScanWait();
 
     /**
      * @brief State handler for waiting to connect to the Particle cloud
@@ -377,7 +861,8 @@ protected:
      * @brief State handler for waiting to publish
      * 
      * stateTime and durationMs determine whether to stay in this state waiting, or whether
-     * to publish and go into statePublishWait.
+     * to publish. After starting a publish, stays here if the in-flight window has room, otherwise
+     * goes into statePublishWait.
      * 
      * Next state: statePublishWait or stateConnectWait
      */
@@ -386,6 +871,9 @@ protected:
     /**
      * @brief State handler for waiting for publish to complete
      * 
+     * Entered when the in-flight window is full or a publish failed. After a failure, waits for
+     * every outstanding publish to complete.
+     * 
      * Next state: stateWait
      */
     void statePublishWait();
@@ -395,21 +883,53 @@ protected:
      */
     SequentialFile fileQueue;
 
+    /**
+     * @brief Default file-based queue store, one file per event in the fileQueue directory
+     */
+    PublishQueueDirStore dirStore{fileQueue};
+
+    /**
+     * @brief The file-based queue in use: &dirStore, or a PublishQueueSegmentStore from withSegmentStore()
+     */
+    PublishQueueStore *fileStore = &dirStore;
+
+    /**
+     * @brief One priority lane
+     */
+    struct Lane {
+        bool enabled = false; //!< Set by withLane() or withDefaultLane()
+        size_t capacity = 0; //!< Maximum events on flash (fileQueueSize for the default lane)
+        LaneEviction eviction = LaneEviction::DISCARD_OLDEST; //!< Policy when full
+        PublishQueueStore *store = 0; //!< Flash queue for this lane (fileStore for the default lane)
+        std::deque<PublishQueueEvent*> ramQueue; //!< Queue in RAM for this lane
+    };
+    Lane lanes[MAX_LANES]; //!< Lanes, index is the lane number (0 is sent first)
+    uint8_t defaultLane = 0; //!< Lane used by publish()
+    String segmentDirPath; //!< From withSegmentStore(), used to name the other lanes' stores
 
-    size_t ramQueueSize = 2; //!< size of the queue in RAM
+    size_t ramQueueSize = 2; //!< size of the queue in RAM (all lanes together)
+    size_t adaptiveMax = 0; //!< From withAdaptiveRamQueue(), 0 when off
+    size_t adaptiveMinFree = 0; //!< From withAdaptiveRamQueue()
+    size_t adaptiveSize = 0; //!< RAM queue size while connected, between ramQueueSize and adaptiveMax
     size_t fileQueueSize = 100; //!< size of the queue on the flash file system
 
     os_mutex_recursive_t mutex; //!< mutex for protecting the queue
-    std::deque<PublishQueueEvent*> ramQueue; //!< Queue in RAM
 
-    PublishQueueEvent *curEvent = 0; //!< Current event being published
-    int curFileNum = 0; //!< Current file number being published (0 if from RAM queue)
+    InFlight inFlight[MAX_IN_FLIGHT]; //!< Ring of started publishes, oldest at inFlightHead
+    size_t inFlightHead = 0; //!< Index of the oldest entry in inFlight
+    size_t inFlightCount = 0; //!< Number of entries in inFlight
+    size_t inFlightWindow = 1; //!< From withInFlightWindow()
+    volatile bool publishFailed = false; //!< A publish in the window failed; start no more until it drains
+    size_t requeued[MAX_LANES] = {}; //!< Failed RAM events put back at the front of each lane since the last drain
+    unsigned long lastRetireMs = 0; //!< millis() of the last successful publish, 0 if the queue was empty after it
+    uint32_t avgMsPerEvent = 0; //!< Average time to remove one queued event while draining (0 until measured)
+    uint32_t avgPublishMs = 0; //!< Average publish round trip (0 until measured)
+    size_t drainSamples = 0; //!< Measurements of avgMsPerEvent since connecting
     unsigned long stateTime = 0; //!< millis() value when entering the state, used for stateWait
     unsigned long durationMs = 0; //!< how long to wait before publishing in milliseconds, used in stateWait
-    bool publishComplete = false; //!< true if the publish has completed (successfully or not)
-    bool publishSuccess = false; //!< true if the publish succeeded
     bool pausePublishing = false; //!< flag to pause publishing (used from automated test)
-    bool canSleep = false; //!< returns true if this is a good time to go to sleep
+    std::atomic<bool> canSleep{false}; //!< returns true if this is a good time to go to sleep
+    std::atomic<size_t> numEvents{0}; //!< getNumEvents(), kept by updateNumEvents()
 
     unsigned long waitAfterConnect = 2000; //!< time to wait after Particle.connected() before publishing
     unsigned long waitBetweenPublish = 1000; //!< how long to wait in milliseconds between publishes
@@ -417,6 +937,74 @@ protected:
 
     std::function<void(bool succeeded, const char *eventName, const char *eventData)> publishCompleteUserCallback = 0; //!< User callback for publish complete
 
+    /**
+     * @brief One withCoalescedEvent() rule
+     */
+    struct CoalesceRule {
+        String eventName; //!< Queued event that may be merged
+        String batchEventName; //!< Event name for the merged publish
+        String arrayKey; //!< Wrap the array in {"arrayKey":[...]} when not empty
+    };
+    std::vector<CoalesceRule> coalesceRules; //!< Rules from withCoalescedEvent()
+    char *coalesceBuf = 0; //!< Scratch buffer for merged event data, allocated on first use
+    char *compactBuf = 0; //!< Scratch buffer for compactLane() summary data, allocated on first use
+
+    PublishQueueMetrics metrics; //!< Instrumentation, see getMetrics()
+
+    /**
+     * @brief Move the RAM queue to the retained queue, or to flash if there is none or it is full
+     *
+     * The move to flash is budgeted (withStorageBudget()).
+     */
+    void holdQueue();
+
+    /**
+     * @brief Write the retained and RAM queues to flash, oldest first
+     *
+     * @param budgeted Stop when the withStorageBudget() budget is spent and let loop() resume
+     */
+    void spillToFiles(bool budgeted);
+
+    /**
+     * @brief Append an event to a lane's store, or drop it if the lane is DISCARD_NEWEST and full
+     *
+     * The caller still owns event.
+     */
+    void appendToLane(uint8_t lane, const PublishQueueEvent *event);
+
+    /**
+     * @brief true if less than the storage budget has been used since startMs
+     */
+    bool storageBudgetLeft(size_t done, unsigned long startMs) const;
+
+    /**
+     * @brief Record a budgeted call's duration, and whether loop() has to resume it
+     */
+    void noteStorageWork(unsigned long startUs, bool finished);
+
+    size_t storageBudgetEvents = 0; //!< From withStorageBudget()
+    uint32_t storageBudgetMs = 0; //!< From withStorageBudget()
+    std::atomic<bool> storagePending{false}; //!< A budgeted call left work for loop()
+
+    /**
+     * @brief Put the retained queue back at the front of the RAM queue, for publishing
+     */
+    void restoreRetained();
+
+    PublishQueueRetained retainedQueue; //!< From withRetainedQueue()
+    void *retainedBuf = 0; //!< From withRetainedQueue()
+    size_t retainedSize = 0; //!< From withRetainedQueue()
+
+    PublishQueueCompactor *compactor = 0; //!< From withCompaction()
+    size_t compactHighWater = 0; //!< From withCompaction()
+    uint8_t compactSummaryLane = 0; //!< From withCompaction()
+
+    size_t poolSmallCount = 0; //!< From withEventPool()
+    size_t poolLargeCount = 0; //!< From withEventPool()
+
+    Thread *scanThread = 0; //!< Scans the flash stores after setup(); deleted when done
+    volatile bool scanDone = false; //!< Set by the scan thread when the lanes have their stores
+
     std::function<void(PublishQueuePosix&)> stateHandler = 0; //!< state handler (stateConnectWait, stateWait, etc).
 
     static void systemEventHandler(system_event_t event, int param); //!< system event handler, used to detect reset events
@@ -0,0 +1,146 @@
+#include "PublishQueuePosixRK.h"
+
+static Logger _log("app.pubq");
+
+void PublishQueueRetained::begin(void *buf, size_t size) {
+    if (!buf || size <= sizeof(Header) + sizeof(RecordHeader)) {
+        return;
+    }
+    header = (Header *)buf;
+    records = (uint8_t *)buf + sizeof(Header);
+    capacity = std::min(size - sizeof(Header), (size_t)0xffff);
+
+    if (header->magic != MAGIC || header->used > capacity) {
+        clear();
+        return;
+    }
+
+    // Keep the records up to the first that does not check out
+    size_t offset = 0;
+    uint16_t count = 0;
+    while(count < header->count && offset + sizeof(RecordHeader) <= header->used) {
+        RecordHeader rec;
+        memcpy(&rec, &records[offset], sizeof(rec));
+        size_t recLen = sizeof(RecordHeader) + rec.nameLen + rec.dataLen;
+        if (offset + recLen > header->used || recordCrc(rec, &records[offset + sizeof(RecordHeader)]) != rec.crc) {
+            break;
+        }
+        offset += recLen;
+        count++;
+    }
+    if (count != header->count || offset != header->used) {
+        _log.info("retained queue: kept %u of %u events", count, header->count);
+        header->count = count;
+        header->used = (uint16_t)offset;
+    }
+    else if (count) {
+        _log.info("retained queue: %u events survived", count);
+    }
+}
+
+bool PublishQueueRetained::append(uint8_t lane, const PublishQueueEvent *event) {
+    if (!header) {
+        return false;
+    }
+    size_t nameLen = strlen(event->eventName);
+    size_t dataLen = strlen(event->eventData);
+    size_t recLen = sizeof(RecordHeader) + nameLen + dataLen;
+    if (header->used + recLen > capacity || header->count == 0xffff) {
+        return false;
+    }
+
+    RecordHeader rec;
+    rec.lane = lane;
+    rec.flags = (uint8_t)event->flags.value();
+    rec.nameLen = (uint8_t)nameLen;
+    rec.reserved = 0;
+    rec.dataLen = (uint16_t)dataLen;
+
+    uint8_t *dest = &records[header->used];
+    memcpy(dest + sizeof(RecordHeader), event->eventName, nameLen);
+    memcpy(dest + sizeof(RecordHeader) + nameLen, event->eventData, dataLen);
+    rec.crc = recordCrc(rec, dest + sizeof(RecordHeader));
+    memcpy(dest, &rec, sizeof(rec));
+
+    header->used += (uint16_t)recLen;
+    header->count++;
+    return true;
+}
+
+void PublishQueueRetained::drain(std::function<bool(uint8_t lane, PublishQueueEvent *event)> fn) {
+    if (!header || header->count == 0) {
+        return;
+    }
+    size_t readOffset = 0;
+    size_t writeOffset = 0;
+    uint16_t kept = 0;
+    for(uint16_t ii = 0; ii < header->count; ii++) {
+        RecordHeader rec;
+        memcpy(&rec, &records[readOffset], sizeof(rec));
+        size_t recLen = sizeof(RecordHeader) + rec.nameLen + rec.dataLen;
+        const uint8_t *payload = &records[readOffset + sizeof(RecordHeader)];
+
+        bool taken = false;
+        PublishQueueEvent *event = PublishQueueEventPool::instance().alloc(rec.dataLen);
+        if (event) {
+            event->flags = PublishFlags::fromValue(rec.flags);
+            memcpy(event->eventName, payload, rec.nameLen);
+            event->eventName[rec.nameLen] = 0;
+            memcpy(event->eventData, payload + rec.nameLen, rec.dataLen);
+            event->eventData[rec.dataLen] = 0;
+            taken = fn(rec.lane, event);
+            if (!taken) {
+                PublishQueueEventPool::instance().free(event);
+            }
+        }
+        if (!taken) {
+            if (writeOffset != readOffset) {
+                memmove(&records[writeOffset], &records[readOffset], recLen);
+            }
+            writeOffset += recLen;
+            kept++;
+        }
+        readOffset += recLen;
+    }
+    header->count = kept;
+    header->used = (uint16_t)writeOffset;
+}
+
+void PublishQueueRetained::clear() {
+    if (header) {
+        header->magic = MAGIC;
+        header->count = 0;
+        header->used = 0;
+    }
+}
+
+size_t PublishQueueRetained::sizeInLane(uint8_t lane) const {
+    size_t result = 0;
+    size_t offset = 0;
+    for(uint16_t ii = 0; header && ii < header->count; ii++) {
+        RecordHeader rec;
+        memcpy(&rec, &records[offset], sizeof(rec));
+        if (rec.lane == lane) {
+            result++;
+        }
+        offset += sizeof(RecordHeader) + rec.nameLen + rec.dataLen;
+    }
+    return result;
+}
+
+// static
+uint16_t PublishQueueRetained::recordCrc(const RecordHeader &rec, const uint8_t *payload) {
+    uint16_t crc = 0xffff;
+    auto add = [&crc](const void *data, size_t len) {
+        const uint8_t *p = (const uint8_t *)data;
+        while(len-- > 0) {
+            crc ^= (uint16_t)(*p++) << 8;
+            for(int ii = 0; ii < 8; ii++) {
+                crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+            }
+        }
+    };
+    add(&rec.lane, sizeof(RecordHeader) - sizeof(rec.crc));
+    add(payload, rec.nameLen + rec.dataLen);
+    return crc;
+}
@@ -0,0 +1,106 @@
+#ifndef __PUBLISHQUEUERETAINED_H
+#define __PUBLISHQUEUERETAINED_H
+
+// Github: https://github.com/rickkas7/PublishQueuePosixRK
+// License: MIT
+
+#include "Particle.h"
+
+#include <functional>
+
+struct PublishQueueEvent;
+
+/**
+ * @brief Queued events in a retained RAM buffer, between the RAM queue and flash
+ *
+ * Retained RAM survives ULTRA_LOW_POWER and STOP sleep and a reset, so events kept
+ * here while offline cost no flash write before a nap. The buffer is supplied by the
+ * application (a `retained` array) through PublishQueuePosix::withRetainedQueue(). It
+ * holds a header and then records packed back to back, oldest first, each with its
+ * lane and a CRC-16 of its contents. begin() keeps the records that check out and
+ * drops the rest, so a buffer that was never written, or was corrupted in a power
+ * loss, starts empty.
+ *
+ * Not thread safe; PublishQueuePosix calls it with its mutex held.
+ */
+class PublishQueueRetained {
+public:
+    /**
+     * @brief Use buf (size bytes, retained) and keep the valid records already in it
+     */
+    void begin(void *buf, size_t size);
+
+    /**
+     * @brief Whether begin() was given a buffer
+     */
+    bool enabled() const { return header != NULL; };
+
+    /**
+     * @brief Add an event at the end
+     *
+     * @return false if it does not fit; nothing is added
+     */
+    bool append(uint8_t lane, const PublishQueueEvent *event);
+
+    /**
+     * @brief Pass each record, oldest first, to fn as a new event
+     *
+     * fn returns true to take the record (and the event, which it must free with
+     * PublishQueueEventPool), or false to leave the record where it is; the event
+     * is then freed here. Records that were taken are removed.
+     */
+    void drain(std::function<bool(uint8_t lane, PublishQueueEvent *event)> fn);
+
+    /**
+     * @brief Remove all records
+     */
+    void clear();
+
+    /**
+     * @brief Number of events held
+     */
+    size_t size() const { return header ? header->count : 0; };
+
+    /**
+     * @brief Number of events held for one lane
+     */
+    size_t sizeInLane(uint8_t lane) const;
+
+    /**
+     * @brief Bytes of records held, and the most there is room for
+     */
+    size_t getUsed() const { return header ? header->used : 0; };
+    size_t getCapacity() const { return capacity; };
+
+    static const uint32_t MAGIC = 0x50515274; //!< "PQRt"
+
+protected:
+    /**
+     * @brief At the start of the buffer
+     */
+    struct Header {
+        uint32_t magic;     //!< MAGIC
+        uint16_t count;     //!< Records held
+        uint16_t used;      //!< Bytes of records after the header
+    };
+
+    /**
+     * @brief Start of each record (8 bytes), followed by nameLen + dataLen bytes
+     */
+    struct RecordHeader {
+        uint16_t crc;       //!< CRC-16/CCITT of the rest of the header, name and data
+        uint8_t lane;       //!< Lane the event was published to
+        uint8_t flags;      //!< PublishFlags value
+        uint8_t nameLen;    //!< Event name length
+        uint8_t reserved;   //!< 0
+        uint16_t dataLen;   //!< Event data length
+    };
+
+    static uint16_t recordCrc(const RecordHeader &rec, const uint8_t *payload);
+
+    Header *header = NULL;          //!< Start of the buffer from begin()
+    uint8_t *records = NULL;        //!< First byte after the header
+    size_t capacity = 0;            //!< Bytes available for records
+};
+
+#endif /* __PUBLISHQUEUERETAINED_H */
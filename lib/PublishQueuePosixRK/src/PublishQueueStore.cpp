@@ -0,0 +1,531 @@
+#include "PublishQueuePosixRK.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+static Logger _log("app.pubq");
+
+bool PublishQueueDirStore::scan() {
+    return fileQueue.scanDir();
+}
+
+bool PublishQueueDirStore::append(const PublishQueueEvent *event) {
+    int fileNum = fileQueue.reserveFile();
+
+    // With a payload dictionary, write a packed copy of the event when it is shorter
+    uint8_t version = PublishQueuePosix::FILE_VERSION;
+    if (PublishQueuePayloadCodec::instance().isEnabled()) {
+        if (!packBuf) {
+            packBuf = new char[sizeof(PublishQueueEvent) + particle::protocol::MAX_EVENT_DATA_LENGTH];
+        }
+        PublishQueueEvent *packed = (PublishQueueEvent *)packBuf;
+        if (packed && PublishQueuePayloadCodec::instance().pack(event->eventData, packed->eventData, particle::protocol::MAX_EVENT_DATA_LENGTH + 1)) {
+            memcpy(packed, event, offsetof(PublishQueueEvent, eventData));
+            event = packed;
+            version = PublishQueuePosix::FILE_VERSION_PACKED;
+        }
+    }
+
+    int fd = open(fileQueue.getPathForFileNum(fileNum), O_RDWR | O_CREAT);
+    if (fd) {
+        PublishQueueFileHeader hdr;
+        hdr.magic = PublishQueuePosix::FILE_MAGIC;
+        hdr.version = version;
+        hdr.headerSize = sizeof(PublishQueueFileHeader);
+        hdr.nameLen = sizeof(PublishQueueEvent::eventName);
+        write(fd, &hdr, sizeof(hdr));
+
+        write(fd, event, sizeof(PublishQueueEvent) + strlen(event->eventData));
+        close(fd);
+
+        // This message is monitored by the automated test tool. If you edit this, change that too.
+        _log.trace("writeQueueToFiles fileNum=%d", fileNum);
+    }
+    fileQueue.addFileToQueue(fileNum);
+
+    return true;
+}
+
+PublishQueueEvent *PublishQueueDirStore::read(size_t index) {
+    int fileNum = fileQueue.peekFileFromQueue(index);
+    if (!fileNum) {
+        return NULL;
+    }
+    return readQueueFile(fileNum);
+}
+
+void PublishQueueDirStore::removeFront(size_t count) {
+    for(size_t ii = 0; ii < count; ii++) {
+        int fileNum = fileQueue.getFileFromQueue(true);
+        if (!fileNum) {
+            break;
+        }
+        fileQueue.removeFileNum(fileNum, false);
+        _log.trace("removed file %d", fileNum);
+    }
+}
+
+PublishQueueEvent *PublishQueueDirStore::readQueueFile(int fileNum) {
+    PublishQueueEvent *result = NULL;
+
+    int fd = open(fileQueue.getPathForFileNum(fileNum), O_RDONLY);
+    if (fd) {
+        struct stat sb;
+        fstat(fd, &sb);
+
+        _log.trace("fileNum=%d size=%ld", fileNum, sb.st_size);
+
+        PublishQueueFileHeader hdr;
+
+        lseek(fd, 0, SEEK_SET);
+        ::read(fd, &hdr, sizeof(PublishQueueFileHeader));
+        bool packed = (hdr.version == PublishQueuePosix::FILE_VERSION_PACKED);
+        if (sb.st_size >= (off_t)(sizeof(PublishQueueFileHeader) + sizeof(PublishQueueEvent)) &&
+            sb.st_size <= (off_t)(sizeof(PublishQueueFileHeader) + sizeof(PublishQueueEvent) + particle::protocol::MAX_EVENT_DATA_LENGTH) &&
+            hdr.magic == PublishQueuePosix::FILE_MAGIC &&
+            (hdr.version == PublishQueuePosix::FILE_VERSION || packed) &&
+            hdr.headerSize == sizeof(PublishQueueFileHeader) &&
+            hdr.nameLen == sizeof(PublishQueueEvent::eventName)) {
+
+            size_t eventSize = sb.st_size - sizeof(PublishQueueFileHeader);
+
+            if (packed) {
+                result = readPacked(fd, eventSize);
+                eventSize = result ? sizeof(PublishQueueEvent) + strlen(result->eventData) : 0;
+            }
+            else {
+                result = PublishQueueEventPool::instance().alloc(eventSize - sizeof(PublishQueueEvent));
+                if (result) {
+                    ::read(fd, result, eventSize);
+                }
+            }
+            if (result) {
+
+                if (((char *)result)[eventSize - 1] == 0 && strlen(result->eventName) < (sizeof(PublishQueueEvent::eventName) - 1)) {
+                    _log.trace("readQueueFile %d event=%s data=%s", fileNum, result->eventName, result->eventData);
+                }
+                else {
+                    _log.trace("readQueueFile %d corrupted event name or data", fileNum);
+                    PublishQueueEventPool::instance().free(result);
+                    result = NULL;
+                }
+
+            }
+        } else {
+            _log.trace("readQueueFile %d bad magic=%08lx version=%u headerSize=%u nameLen=%u", fileNum, hdr.magic, hdr.version, hdr.headerSize, hdr.nameLen);
+        }
+
+        close(fd);
+    }
+    return result;
+}
+
+
+PublishQueueEvent *PublishQueueDirStore::readPacked(int fd, size_t eventSize) {
+    if (!packBuf) {
+        packBuf = new char[sizeof(PublishQueueEvent) + particle::protocol::MAX_EVENT_DATA_LENGTH];
+        if (!packBuf) {
+            return NULL;
+        }
+    }
+    PublishQueueEvent *packed = (PublishQueueEvent *)packBuf;
+    if (::read(fd, packed, eventSize) != (int)eventSize || packBuf[eventSize - 1] != 0) {
+        return NULL;
+    }
+
+    size_t dataLen = PublishQueuePayloadCodec::instance().unpackedLen(packed->eventData);
+    if (dataLen == 0 || dataLen > particle::protocol::MAX_EVENT_DATA_LENGTH) {
+        _log.info("cannot unpack queued event %s", packed->eventName);
+        return NULL;
+    }
+    PublishQueueEvent *result = PublishQueueEventPool::instance().alloc(dataLen);
+    if (result) {
+        memcpy(result, packed, offsetof(PublishQueueEvent, eventData));
+        PublishQueuePayloadCodec::instance().unpack(packed->eventData, result->eventData, dataLen + 1);
+    }
+    return result;
+}
+
+PublishQueueSegmentStore::PublishQueueSegmentStore(const char *dirPath, uint8_t numSegments, size_t segmentSize) : dirPath(dirPath) {
+    if (this->dirPath.endsWith("/")) {
+        this->dirPath = this->dirPath.substring(0, this->dirPath.length() - 1);
+    }
+    if (numSegments < 2) {
+        numSegments = 2;
+    }
+    if (numSegments > sizeof(segments) / sizeof(segments[0])) {
+        numSegments = sizeof(segments) / sizeof(segments[0]);
+    }
+    this->numSegments = numSegments;
+
+    // Offsets are packed into 24 bits in the index; a segment must hold at least one maximum-size record
+    const size_t minSize = sizeof(SegmentHeader) + sizeof(RecordHeader) + particle::protocol::MAX_EVENT_NAME_LENGTH + particle::protocol::MAX_EVENT_DATA_LENGTH;
+    if (segmentSize < minSize) {
+        segmentSize = minSize;
+    }
+    if (segmentSize > 0xffffff) {
+        segmentSize = 0xffffff;
+    }
+    this->segmentSize = segmentSize;
+
+    for(uint8_t seg = 0; seg < numSegments; seg++) {
+        segments[seg].generation = 0;
+        segments[seg].readOffset = segments[seg].writeOffset = sizeof(SegmentHeader);
+    }
+
+    recordBuf = new char[sizeof(RecordHeader) + particle::protocol::MAX_EVENT_NAME_LENGTH + particle::protocol::MAX_EVENT_DATA_LENGTH + 2];
+}
+
+PublishQueueSegmentStore::~PublishQueueSegmentStore() {
+    delete[] recordBuf;
+}
+
+bool PublishQueueSegmentStore::scan() {
+    mkdir(dirPath.c_str(), 0777);
+
+    index.clear();
+
+    // Per-segment list of live records, merged in generation order below
+    std::deque<uint32_t> live[sizeof(segments) / sizeof(segments[0])];
+    uint32_t maxGeneration = 0;
+    bool anyValid = false;
+
+    // Read cursors; a segment without a matching one starts at its header's readOffset
+    Cursor cursors[sizeof(segments) / sizeof(segments[0])];
+    memset(cursors, 0, sizeof(cursors));
+    int cursorFd = open(pathForCursors().c_str(), O_RDONLY);
+    if (cursorFd >= 0) {
+        ::read(cursorFd, cursors, numSegments * sizeof(Cursor));
+        close(cursorFd);
+    }
+
+    for(uint8_t seg = 0; seg < numSegments; seg++) {
+        Segment &s = segments[seg];
+
+        int fd = open(pathForSegment(seg).c_str(), O_RDONLY);
+        if (fd < 0) {
+            resetSegment(seg, 0);
+            continue;
+        }
+        struct stat sb;
+        fstat(fd, &sb);
+
+        SegmentHeader hdr;
+        if (::read(fd, &hdr, sizeof(hdr)) != sizeof(hdr) ||
+            hdr.magic != SEGMENT_MAGIC ||
+            hdr.version != SEGMENT_VERSION ||
+            hdr.readOffset < sizeof(SegmentHeader) ||
+            hdr.readOffset > segmentSize) {
+            close(fd);
+            _log.info("segment %u invalid header, reset", seg);
+            resetSegment(seg, 0);
+            continue;
+        }
+        s.generation = hdr.generation;
+        s.readOffset = hdr.readOffset;
+        anyValid = true;
+        if (hdr.generation > maxGeneration) {
+            maxGeneration = hdr.generation;
+        }
+
+        // Walk the record headers only; the CRC is checked when the record is read
+        uint32_t offset = s.readOffset;
+        while(offset + sizeof(RecordHeader) <= (uint32_t)sb.st_size) {
+            RecordHeader rec;
+            lseek(fd, offset, SEEK_SET);
+            if (::read(fd, &rec, sizeof(rec)) != sizeof(rec) ||
+                (rec.magic != RECORD_MAGIC && rec.magic != RECORD_MAGIC_PACKED) ||
+                rec.nameLen == 0 ||
+                rec.nameLen > particle::protocol::MAX_EVENT_NAME_LENGTH ||
+                rec.dataLen > particle::protocol::MAX_EVENT_DATA_LENGTH) {
+                break;
+            }
+            uint32_t next = offset + sizeof(RecordHeader) + rec.nameLen + rec.dataLen;
+            if (next > (uint32_t)sb.st_size || next > segmentSize) {
+                // Torn write at the end of the segment
+                break;
+            }
+            live[seg].push_back(makeEntry(seg, offset));
+            offset = next;
+        }
+        s.writeOffset = offset;
+        if (offset < (uint32_t)sb.st_size) {
+            _log.info("segment %u trailing data at %lu ignored", seg, offset);
+        }
+        close(fd);
+
+        // Drop the records already removed, if the cursor is at one of the record boundaries
+        const Cursor &cursor = cursors[seg];
+        if (cursor.generation == s.generation && cursor.readOffset > s.readOffset) {
+            size_t removed = 0;
+            while(removed < live[seg].size() && entryOffset(live[seg][removed]) < cursor.readOffset) {
+                removed++;
+            }
+            uint32_t boundary = (removed < live[seg].size()) ? entryOffset(live[seg][removed]) : s.writeOffset;
+            if (boundary == cursor.readOffset) {
+                live[seg].erase(live[seg].begin(), live[seg].begin() + removed);
+                s.readOffset = cursor.readOffset;
+            }
+            else {
+                _log.info("segment %u cursor %lu not at a record, ignored", seg, cursor.readOffset);
+            }
+        }
+    }
+
+    if (!anyValid) {
+        // Fresh store: segment 0 is written first; untouched segments stay at generation 0
+        resetSegment(0, 1);
+        writeSegment = 0;
+        return true;
+    }
+
+    // The segment with the highest generation is the one being written. The
+    // ring order is the one following it, wrapping around back to it.
+    for(uint8_t seg = 0; seg < numSegments; seg++) {
+        if (segments[seg].generation == maxGeneration) {
+            writeSegment = seg;
+        }
+    }
+    for(uint8_t ii = 1; ii <= numSegments; ii++) {
+        uint8_t seg = (writeSegment + ii) % numSegments;
+        for(uint32_t entry : live[seg]) {
+            index.push_back(entry);
+        }
+    }
+
+    _log.info("segment store %u events in %u segments, writing segment %u", index.size(), numSegments, writeSegment);
+    return true;
+}
+
+bool PublishQueueSegmentStore::append(const PublishQueueEvent *event) {
+    // Build the record in one buffer so it is a single write
+    char *buf = recordBuf;
+    if (!buf) {
+        return false;
+    }
+
+    RecordHeader rec;
+    rec.magic = RECORD_MAGIC;
+    rec.flags = (uint8_t)event->flags.value();
+    rec.nameLen = (uint8_t)strlen(event->eventName);
+
+    // With a payload dictionary, store the data packed when that is shorter
+    char *data = &buf[sizeof(RecordHeader) + rec.nameLen];
+    size_t dataLen = PublishQueuePayloadCodec::instance().pack(event->eventData, data, particle::protocol::MAX_EVENT_DATA_LENGTH + 1);
+    if (dataLen) {
+        rec.magic = RECORD_MAGIC_PACKED;
+    }
+    else {
+        dataLen = strlen(event->eventData);
+        memcpy(data, event->eventData, dataLen);
+    }
+    rec.dataLen = (uint16_t)dataLen;
+    memcpy(&buf[sizeof(RecordHeader)], event->eventName, rec.nameLen);
+
+    rec.crc = crc16(0xffff, &rec.flags, 4);
+    rec.crc = crc16(rec.crc, &buf[sizeof(RecordHeader)], rec.nameLen + rec.dataLen);
+    memcpy(buf, &rec, sizeof(RecordHeader));
+
+    size_t recSize = sizeof(RecordHeader) + rec.nameLen + rec.dataLen;
+
+    if (segments[writeSegment].writeOffset + recSize > segmentSize) {
+        // Move to the next segment. Anything still in it is the oldest data in the ring.
+        uint8_t next = (writeSegment + 1) % numSegments;
+        if (discardNewest && !index.empty() && entrySegment(index.front()) == next) {
+            _log.info("segment store full, event not stored");
+            return false;
+        }
+        size_t discarded = 0;
+        while(!index.empty() && entrySegment(index.front()) == next) {
+            index.pop_front();
+            removedCount++;
+            discarded++;
+        }
+        if (discarded) {
+            _log.info("segment store full, discarded %u events", discarded);
+        }
+        if (!resetSegment(next, segments[writeSegment].generation + 1)) {
+            return false;
+        }
+        writeSegment = next;
+    }
+
+    Segment &s = segments[writeSegment];
+
+    bool result = false;
+    int fd = open(pathForSegment(writeSegment).c_str(), O_RDWR);
+    if (fd >= 0) {
+        lseek(fd, s.writeOffset, SEEK_SET);
+        result = (write(fd, buf, recSize) == (int)recSize);
+        close(fd);
+    }
+    if (result) {
+        _log.trace("writeQueueToFiles segment=%u offset=%lu", writeSegment, s.writeOffset);
+
+        index.push_back(makeEntry(writeSegment, s.writeOffset));
+        s.writeOffset += recSize;
+    }
+    else {
+        _log.error("segment %u write failed at %lu", writeSegment, s.writeOffset);
+    }
+    return result;
+}
+
+PublishQueueEvent *PublishQueueSegmentStore::read(size_t idx) {
+    if (idx >= index.size()) {
+        return NULL;
+    }
+    uint8_t seg = entrySegment(index[idx]);
+    uint32_t offset = entryOffset(index[idx]);
+
+    int fd = open(pathForSegment(seg).c_str(), O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    PublishQueueEvent *result = NULL;
+
+    RecordHeader rec;
+    lseek(fd, offset, SEEK_SET);
+    if (::read(fd, &rec, sizeof(rec)) == sizeof(rec) &&
+        (rec.magic == RECORD_MAGIC || rec.magic == RECORD_MAGIC_PACKED) &&
+        rec.nameLen <= particle::protocol::MAX_EVENT_NAME_LENGTH &&
+        rec.dataLen <= particle::protocol::MAX_EVENT_DATA_LENGTH) {
+
+        // Name and stored data into the scratch buffer, each terminated
+        char *name = recordBuf;
+        char *data = &recordBuf[rec.nameLen + 1];
+        bool ok = name && ::read(fd, name, rec.nameLen) == rec.nameLen &&
+            ::read(fd, data, rec.dataLen) == rec.dataLen;
+
+        if (ok) {
+            uint16_t crc = crc16(0xffff, &rec.flags, 4);
+            crc = crc16(crc, name, rec.nameLen);
+            crc = crc16(crc, data, rec.dataLen);
+            ok = (crc == rec.crc);
+            name[rec.nameLen] = 0;
+            data[rec.dataLen] = 0;
+        }
+
+        if (!ok) {
+            _log.trace("read segment %u offset %lu bad crc", seg, offset);
+        }
+        else {
+            bool packed = (rec.magic == RECORD_MAGIC_PACKED);
+            size_t dataLen = packed ? PublishQueuePayloadCodec::instance().unpackedLen(data) : rec.dataLen;
+            if (dataLen == 0 && packed) {
+                _log.info("read segment %u offset %lu cannot unpack %s", seg, offset, name);
+            }
+            else if ((result = PublishQueueEventPool::instance().alloc(dataLen)) != NULL) {
+                result->flags = PublishFlags::fromValue(rec.flags);
+                memcpy(result->eventName, name, rec.nameLen + 1);
+                if (packed) {
+                    PublishQueuePayloadCodec::instance().unpack(data, result->eventData, dataLen + 1);
+                }
+                else {
+                    memcpy(result->eventData, data, dataLen + 1);
+                }
+                _log.trace("read segment %u offset %lu event=%s data=%s", seg, offset, result->eventName, result->eventData);
+            }
+        }
+    }
+    else {
+        _log.trace("read segment %u offset %lu bad record header", seg, offset);
+    }
+    close(fd);
+
+    return result;
+}
+
+void PublishQueueSegmentStore::removeFront(size_t count) {
+    while(count-- > 0 && !index.empty()) {
+        uint8_t seg = entrySegment(index.front());
+        index.pop_front();
+        removedCount++;
+
+        if (!index.empty() && entrySegment(index.front()) == seg) {
+            // The cursor moves to the next record in the segment
+            writeCursor(seg, entryOffset(index.front()));
+        }
+        else if (seg != writeSegment) {
+            // Drained and no longer written: give the space back. Generation 0
+            // sorts it ahead of the ring, and the next append past it resets it.
+            resetSegment(seg, 0);
+        }
+        else {
+            writeCursor(seg, segments[seg].writeOffset);
+        }
+    }
+}
+
+void PublishQueueSegmentStore::clear() {
+    // Cleared records count as removed so identifiers are never reused
+    removedCount += index.size();
+    index.clear();
+
+    uint32_t generation = segments[writeSegment].generation + 1;
+    for(uint8_t seg = 0; seg < numSegments; seg++) {
+        resetSegment(seg, (seg == 0) ? generation : 0);
+    }
+    writeSegment = 0;
+    unlink(pathForCursors().c_str());
+}
+
+String PublishQueueSegmentStore::pathForSegment(uint8_t seg) const {
+    return String::format("%s/seg%u.dat", dirPath.c_str(), seg);
+}
+
+String PublishQueueSegmentStore::pathForCursors() const {
+    return String::format("%s/cursor.dat", dirPath.c_str());
+}
+
+bool PublishQueueSegmentStore::resetSegment(uint8_t seg, uint32_t generation) {
+    SegmentHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = SEGMENT_MAGIC;
+    hdr.version = SEGMENT_VERSION;
+    hdr.generation = generation;
+    hdr.readOffset = sizeof(SegmentHeader);
+
+    int fd = open(pathForSegment(seg).c_str(), O_RDWR | O_CREAT | O_TRUNC);
+    if (fd < 0) {
+        _log.error("segment %u create failed", seg);
+        return false;
+    }
+    bool result = (write(fd, &hdr, sizeof(hdr)) == sizeof(hdr));
+    close(fd);
+
+    segments[seg].generation = generation;
+    segments[seg].readOffset = segments[seg].writeOffset = sizeof(SegmentHeader);
+
+    return result;
+}
+
+bool PublishQueueSegmentStore::writeCursor(uint8_t seg, uint32_t readOffset) {
+    segments[seg].readOffset = readOffset;
+
+    int fd = open(pathForCursors().c_str(), O_RDWR | O_CREAT);
+    if (fd < 0) {
+        return false;
+    }
+    Cursor cursor;
+    cursor.generation = segments[seg].generation;
+    cursor.readOffset = readOffset;
+    lseek(fd, seg * sizeof(Cursor), SEEK_SET);
+    bool result = (write(fd, &cursor, sizeof(cursor)) == sizeof(cursor));
+    close(fd);
+
+    return result;
+}
+
+// static
+uint16_t PublishQueueSegmentStore::crc16(uint16_t crc, const void *data, size_t len) {
+    const uint8_t *p = (const uint8_t *)data;
+    while(len-- > 0) {
+        crc ^= (uint16_t)(*p++) << 8;
+        for(int ii = 0; ii < 8; ii++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
@@ -0,0 +1,265 @@
+#ifndef __PUBLISHQUEUESTORE_H
+#define __PUBLISHQUEUESTORE_H
+
+// Github: https://github.com/rickkas7/PublishQueuePosixRK
+// License: MIT
+
+#include "Particle.h"
+#include "SequentialFileRK.h"
+
+#include <deque>
+
+#include "PublishQueuePayloadCodec.h"
+
+struct PublishQueueEvent;
+
+/**
+ * @brief Flash-backed FIFO of events used by PublishQueuePosix
+ *
+ * PublishQueuePosix keeps recent events in RAM and moves them to one of these
+ * when it must (offline, RAM queue full, reset). Events are only ever added at
+ * the back and removed from the front.
+ *
+ * All methods are called with the PublishQueuePosix mutex held.
+ */
+class PublishQueueStore {
+public:
+    virtual ~PublishQueueStore() {};
+
+    /**
+     * @brief Load the queue from flash. Called once from PublishQueuePosix::setup().
+     */
+    virtual bool scan() = 0;
+
+    /**
+     * @brief Add an event at the back of the queue
+     */
+    virtual bool append(const PublishQueueEvent *event) = 0;
+
+    /**
+     * @brief Read the event at position index (0 = front)
+     *
+     * @return A new event (release it with PublishQueueEventPool::free()) or NULL if there is no such entry or it
+     * is corrupted.
+     */
+    virtual PublishQueueEvent *read(size_t index) = 0;
+
+    /**
+     * @brief Remove count events from the front of the queue
+     */
+    virtual void removeFront(size_t count) = 0;
+
+    /**
+     * @brief Identifier of the front entry; 0 if the queue is empty
+     *
+     * Stays the same until the front entry is removed, so a publish started from
+     * the front can check that it is still the front when it completes.
+     */
+    virtual int frontId() = 0;
+
+    /**
+     * @brief Identifier of the entry at position index (0 = front); 0 if there is no such entry
+     *
+     * The entry keeps this identifier as the entries ahead of it are removed, so
+     * idAt(n) taken when a publish starts equals frontId() once that entry reaches
+     * the front. idAt(0) is frontId().
+     */
+    virtual int idAt(size_t index) = 0;
+
+    /**
+     * @brief Number of queued events. Does not access the file system.
+     */
+    virtual size_t size() const = 0;
+
+    /**
+     * @brief Discard every queued event
+     */
+    virtual void clear() = 0;
+};
+
+/**
+ * @brief The original store: one file per event in a directory, managed by SequentialFile
+ *
+ * Each file is a PublishQueueFileHeader followed by the PublishQueueEvent. scan() walks
+ * the directory.
+ */
+class PublishQueueDirStore : public PublishQueueStore {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param fileQueue The SequentialFile that owns the queue directory (not owned)
+     */
+    PublishQueueDirStore(SequentialFile &fileQueue) : fileQueue(fileQueue) {};
+
+    /**
+     * @brief Constructor for a store with its own queue directory
+     *
+     * @param dirPath Queue directory (created if necessary)
+     */
+    PublishQueueDirStore(const char *dirPath) : ownedQueue(new SequentialFile()), fileQueue(*ownedQueue) { fileQueue.withDirPath(dirPath).withIndex(); };
+
+    virtual ~PublishQueueDirStore() { delete ownedQueue; delete[] packBuf; };
+
+    virtual bool scan();
+    virtual bool append(const PublishQueueEvent *event);
+    virtual PublishQueueEvent *read(size_t index);
+    virtual void removeFront(size_t count);
+    virtual int frontId() { return fileQueue.peekFileFromQueue(0); };
+    virtual int idAt(size_t index) { return fileQueue.peekFileFromQueue(index); };
+    virtual size_t size() const { return (size_t)fileQueue.getQueueLen(); };
+    virtual void clear() { fileQueue.removeAll(true); };
+
+    /**
+     * @brief Read an event from a sequentially numbered file
+     */
+    PublishQueueEvent *readQueueFile(int fileNum);
+
+protected:
+    /**
+     * @brief Read a FILE_VERSION_PACKED event of eventSize bytes from fd and unpack it
+     */
+    PublishQueueEvent *readPacked(int fd, size_t eventSize);
+
+    char *packBuf = NULL; //!< Scratch space for one packed event, allocated on first use
+    SequentialFile *ownedQueue = NULL; //!< Set when this store created its own SequentialFile
+    SequentialFile &fileQueue; //!< Queue directory and in-RAM list of file numbers
+};
+
+/**
+ * @brief Events appended to a small, fixed set of segment files used as a ring
+ *
+ * Each segment file starts with a SegmentHeader and is followed by records, each a
+ * RecordHeader plus the event name and data (no terminators). A record carries a CRC
+ * of its contents, checked when it is read. With a payload dictionary, data that packs
+ * shorter is stored packed (RECORD_MAGIC_PACKED) and unpacked by read().
+ *
+ * - Enqueue appends one record to the current segment: one write, no new file.
+ * - Dequeue writes the segment's read cursor (generation and offset, 8 bytes) to a small
+ *   cursor file beside the segments. The segment file itself is not rewritten: on
+ *   LittleFS a write into it copies the whole file. A segment other than the one being
+ *   written is truncated to its header once it is drained.
+ * - When the current segment is full, writing moves to the next one. If that segment
+ *   still holds events (the ring is full), they are the oldest and are discarded, or,
+ *   with withDiscardNewest(), the append fails and they are kept.
+ * - scan() reads each segment header, then walks the record headers from its readOffset.
+ *   A bad header ends the segment; the torn record is overwritten by the next append.
+ *   Records before the segment's cursor are dropped. A cursor for another generation,
+ *   or one that is not at a record boundary, is ignored, so a lost cursor resends
+ *   events rather than losing them.
+ */
+class PublishQueueSegmentStore : public PublishQueueStore {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param dirPath Directory for the segment files (created if necessary)
+     * @param numSegments Number of segment files (2 - 16)
+     * @param segmentSize Size of each segment file in bytes
+     */
+    PublishQueueSegmentStore(const char *dirPath, uint8_t numSegments, size_t segmentSize);
+
+    virtual ~PublishQueueSegmentStore();
+
+    /**
+     * @brief When the ring is full, fail the append instead of discarding the oldest segment
+     *
+     * For a LaneEviction::DISCARD_NEWEST lane, whose events can fill the ring's bytes
+     * before the lane's event capacity is reached.
+     */
+    PublishQueueSegmentStore &withDiscardNewest() { discardNewest = true; return *this; };
+
+    virtual bool scan();
+    virtual bool append(const PublishQueueEvent *event);
+    virtual PublishQueueEvent *read(size_t index);
+    virtual void removeFront(size_t count);
+    virtual int frontId() { return idAt(0); };
+    virtual int idAt(size_t index) { return (index < this->index.size()) ? (int)(removedCount + 1 + index) : 0; };
+    virtual size_t size() const { return index.size(); };
+    virtual void clear();
+
+    /**
+     * @brief Magic bytes at the start of each segment file
+     */
+    static const uint32_t SEGMENT_MAGIC = 0x51534547;
+
+    /**
+     * @brief Version of the segment format
+     */
+    static const uint8_t SEGMENT_VERSION = 1;
+
+    /**
+     * @brief Magic value at the start of each record
+     */
+    static const uint16_t RECORD_MAGIC = 0x7051;
+
+    /**
+     * @brief Magic value at the start of a record whose data is packed (PublishQueuePayloadCodec)
+     */
+    static const uint16_t RECORD_MAGIC_PACKED = 0x7052;
+
+protected:
+    /**
+     * @brief Start of each segment file (16 bytes)
+     */
+    struct SegmentHeader {
+        uint32_t magic;         //!< SEGMENT_MAGIC
+        uint8_t version;        //!< SEGMENT_VERSION
+        uint8_t reserved[3];    //!< 0
+        uint32_t generation;    //!< Bumped each time the segment is reused; orders segments at boot
+        uint32_t readOffset;    //!< Offset of the first record not yet removed
+    };
+
+    /**
+     * @brief Start of each record (8 bytes), followed by nameLen + dataLen bytes
+     */
+    struct RecordHeader {
+        uint16_t magic;         //!< RECORD_MAGIC, or RECORD_MAGIC_PACKED
+        uint16_t crc;           //!< CRC-16/CCITT of flags, lengths, name and data
+        uint8_t flags;          //!< PublishFlags value
+        uint8_t nameLen;        //!< Event name length
+        uint16_t dataLen;       //!< Event data length as stored
+    };
+
+    /**
+     * @brief Read cursor of one segment, at seg * sizeof(Cursor) in the cursor file
+     */
+    struct Cursor {
+        uint32_t generation;    //!< Generation of the segment the cursor belongs to
+        uint32_t readOffset;    //!< Offset of the first record not yet removed
+    };
+
+    /**
+     * @brief In-RAM state of one segment
+     */
+    struct Segment {
+        uint32_t generation;    //!< From the header
+        uint32_t readOffset;    //!< From the cursor file, else the header
+        uint32_t writeOffset;   //!< End of the last valid record
+    };
+
+    /**
+     * @brief Pack a segment number and offset into an index entry
+     */
+    static uint32_t makeEntry(uint8_t seg, uint32_t offset) { return ((uint32_t)seg << 24) | offset; };
+    static uint8_t entrySegment(uint32_t entry) { return (uint8_t)(entry >> 24); };
+    static uint32_t entryOffset(uint32_t entry) { return entry & 0xffffff; };
+
+    String pathForSegment(uint8_t seg) const;
+    String pathForCursors() const;
+    bool resetSegment(uint8_t seg, uint32_t generation);
+    bool writeCursor(uint8_t seg, uint32_t readOffset);
+    static uint16_t crc16(uint16_t crc, const void *data, size_t len);
+
+    String dirPath;             //!< Directory holding the segment files
+    uint8_t numSegments;        //!< Number of segment files
+    uint32_t segmentSize;       //!< Size of each segment file
+    uint8_t writeSegment = 0;   //!< Segment that receives appends
+    Segment segments[16];       //!< Per-segment state
+    std::deque<uint32_t> index; //!< Queued records, front first (makeEntry values)
+    uint32_t removedCount = 0;  //!< Records removed since boot, for frontId() and idAt()
+    char *recordBuf = 0;        //!< Scratch space for one maximum-size record, used by append() and read()
+    bool discardNewest = false; //!< From withDiscardNewest()
+};
+
+#endif /* __PUBLISHQUEUESTORE_H */
@@ -1,5 +1,6 @@
 #include "SequentialFileRK.h"
 
+#include <algorithm>
 #include <dirent.h>
 #include <fcntl.h>
 #include <sys/stat.h>
@@ -7,6 +8,22 @@
 
 static Logger _log("app.seqfile");
 
+// Index file in the queue directory. The name does not match the file number pattern.
+static const char *indexName = ".index";
+static const uint32_t INDEX_MAGIC = 0x51444958;    // "QIDX"
+static const uint16_t INDEX_VERSION = 1;
+
+// Front and back of the queue; a set bit (file number % INDEX_SPAN) is a number in between
+// that is not in the queue
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t span;
+    int32_t headFileNum;
+    int32_t tailFileNum;
+    uint8_t gaps[SequentialFile::INDEX_SPAN / 8];
+} SequentialFileIndex;
+
 
 SequentialFile::SequentialFile() {
 
@@ -36,6 +53,11 @@ bool SequentialFile::scanDir(void) {
         return false;
     }
 
+    if (useIndex && readIndex()) {
+        scanDirCompleted = true;
+        return true;
+    }
+
     _log.trace("scanning %s with pattern %s", dirPath.c_str(), pattern.c_str());
 
     DIR *dir = opendir(dirPath);
@@ -74,11 +96,112 @@ bool SequentialFile::scanDir(void) {
         }
     }
     closedir(dir);
+
+    if (useIndex) {
+        queueMutexLock();
+        std::sort(queue.begin(), queue.end());
+        writeIndex();
+        queueMutexUnlock();
+    }
     
     scanDirCompleted = true;
     return true;
 }
 
+bool SequentialFile::readIndex() {
+    SequentialFileIndex index;
+    String indexPath = dirPath + String("/") + indexName;
+
+    int fd = open(indexPath, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    int count = read(fd, &index, sizeof(index));
+    close(fd);
+
+    if (count != (int)sizeof(index) || index.magic != INDEX_MAGIC || index.version != INDEX_VERSION ||
+        index.span != INDEX_SPAN || index.headFileNum <= 0 || index.tailFileNum < index.headFileNum - 1 ||
+        index.tailFileNum - index.headFileNum >= INDEX_SPAN) {
+        _log.info("index in %s not usable, scanning", dirPath.c_str());
+        return false;
+    }
+
+    // The front file must still be there; if not, the queue changed without the index
+    struct stat sb;
+    if (index.tailFileNum >= index.headFileNum && stat(getPathForFileNum(index.headFileNum), &sb) != 0) {
+        _log.info("index in %s out of date, scanning", dirPath.c_str());
+        return false;
+    }
+
+    queueMutexLock();
+    queue.clear();
+    for(int fileNum = index.headFileNum; fileNum <= index.tailFileNum; fileNum++) {
+        int bit = fileNum % INDEX_SPAN;
+        if ((index.gaps[bit / 8] & (1 << (bit % 8))) == 0) {
+            queue.push_back(fileNum);
+        }
+    }
+    lastFileNum = index.tailFileNum;
+
+    // Files written after the last index update (a reset between writing the file and
+    // addFileToQueue(), or firmware without the index)
+    bool added = false;
+    while(stat(getPathForFileNum(lastFileNum + 1), &sb) == 0) {
+        queue.push_back(++lastFileNum);
+        added = true;
+    }
+    if (added) {
+        writeIndex();
+    }
+    queueMutexUnlock();
+
+    _log.trace("index %s: %d to %d, %u queued", dirPath.c_str(), index.headFileNum, index.tailFileNum, (unsigned)queue.size());
+    return true;
+}
+
+void SequentialFile::writeIndex() {
+    String indexPath = dirPath + String("/") + indexName;
+
+    // lastFileNum can be ahead of the queue (reserved, not yet added); the back is the
+    // last queued file, or the front of an empty queue is after lastFileNum
+    SequentialFileIndex index;
+    memset(&index, 0, sizeof(index));
+    index.magic = INDEX_MAGIC;
+    index.version = INDEX_VERSION;
+    index.span = INDEX_SPAN;
+    index.headFileNum = queue.empty() ? lastFileNum + 1 : queue.front();
+    index.tailFileNum = queue.empty() ? lastFileNum : queue.back();
+
+    bool ok = (index.tailFileNum - index.headFileNum < INDEX_SPAN);
+    int expected = index.headFileNum;
+    for(size_t ii = 0; ok && ii < queue.size(); ii++) {
+        int fileNum = queue[ii];
+        if (fileNum < expected) {
+            // Not in file number order; only a scan can rebuild it
+            ok = false;
+            break;
+        }
+        for(; expected < fileNum; expected++) {
+            int bit = expected % INDEX_SPAN;
+            index.gaps[bit / 8] |= (1 << (bit % 8));
+        }
+        expected = fileNum + 1;
+    }
+
+    if (!ok) {
+        unlink(indexPath);
+        return;
+    }
+
+    int fd = open(indexPath, O_RDWR | O_CREAT | O_TRUNC);
+    if (fd < 0) {
+        _log.error("could not write index %s errno=%d", indexPath.c_str(), errno);
+        return;
+    }
+    write(fd, &index, sizeof(index));
+    close(fd);
+}
+
 int SequentialFile::reserveFile(void) {
     if (!scanDirCompleted) {
         scanDir();
@@ -97,6 +220,9 @@ void SequentialFile::addFileToQueue(int fileNum) {
 
     queueMutexLock();
     queue.push_back(fileNum); 
+    if (useIndex) {
+        writeIndex();
+    }
     queueMutexUnlock();
 }
  
@@ -112,6 +238,9 @@ int SequentialFile::getFileFromQueue(bool remove) {
         fileNum = queue.front();
         if (remove) {
             queue.pop_front();
+            if (useIndex) {
+                writeIndex();
+            }
         }
     }
     queueMutexUnlock();
@@ -123,6 +252,22 @@ int SequentialFile::getFileFromQueue(bool remove) {
     return fileNum;
 }
 
+int SequentialFile::peekFileFromQueue(size_t index) {
+    int fileNum = 0;
+
+    if (!scanDirCompleted) {
+        scanDir();
+    }
+
+    queueMutexLock();
+    if (index < queue.size()) {
+        fileNum = queue[index];
+    }
+    queueMutexUnlock();
+
+    return fileNum;
+}
+
 
 String SequentialFile::getNameForFileNum(int fileNum, const char *overrideExt) {
     String name = String::format(pattern.c_str(), fileNum);
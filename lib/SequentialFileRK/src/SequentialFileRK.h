@@ -28,6 +28,11 @@
  * Once you have fully written the file, call addFileToQueue().
  * 
  * The code that processes files in the queue calls getFileFromQueue(). 
+ * 
+ * With withIndex(), the queue is also kept in a small index file in the queue directory:
+ * the first and last file numbers, and a bitmap of the numbers in between that are not
+ * in the queue. scanDir() then reads that one file instead of listing the directory,
+ * and each addFileToQueue() and getFileFromQueue() rewrites it (under 150 bytes).
  */
 class SequentialFile {
 public:
@@ -102,6 +107,25 @@ public:
      */
     const char *getFilenameExtension() const { return filenameExtension; };
 
+    /**
+     * @brief Keep a persisted index of the queue so scanDir() does not list the directory
+     * 
+     * @param enable true to use the index (default false)
+     * 
+     * The index covers at most INDEX_SPAN file numbers from the front of the queue to the
+     * back. A queue that spans more, an index that is missing or does not match the files
+     * (for example after running firmware without the index), or a queue that was not
+     * added to in file number order falls back to a directory scan, which rewrites the
+     * index when it can. Files written after the last index update are picked up by
+     * checking for the next file numbers.
+     */
+    SequentialFile &withIndex(bool enable = true) { this->useIndex = enable; return *this; };
+
+    /**
+     * @brief Maximum number of file numbers from the front to the back of an indexed queue
+     */
+    static const int INDEX_SPAN = 1024;
+
     /**
      * @brief Scans the queue directory for files. Typically called during setup().
      */
@@ -147,6 +171,17 @@ public:
      */
     int getFileFromQueue(bool remove = true);
 
+    /**
+     * @brief Gets a file number from anywhere in the queue without removing it
+     * 
+     * @param index Position in the queue; 0 is the front, the same file as getFileFromQueue(false).
+     * 
+     * @return 0 if the queue has index entries or fewer, otherwise the fileNum at that position.
+     * 
+     * Like getFileFromQueue(), this does not access the file system.
+     */
+    int peekFileFromQueue(size_t index);
+
     /**
      * @brief Uses pattern to create a filename given a fileNum
      * 
@@ -242,6 +277,20 @@ protected:
      */
     virtual bool preScanAddHook(const char *name) { return true; };
 
+    /**
+     * @brief Rebuild the queue from the index file
+     * 
+     * @return false if there is no usable index; the directory must be scanned
+     */
+    bool readIndex();
+
+    /**
+     * @brief Rewrite the index file from the queue, or remove it if the queue cannot be indexed
+     * 
+     * Called with the queue mutex held.
+     */
+    void writeIndex();
+
     /**
      * @brief Lock the mutex used to protect the queue
      */
@@ -273,6 +322,11 @@ protected:
      */
     bool scanDirCompleted = false;
 
+    /**
+     * @brief Keep the index file up to date (withIndex())
+     */
+    bool useIndex = false;
+
     /**
      * @brief Last file number used.
      * 
@@ -56,6 +56,30 @@ bool StorageHelperRK::PersistentDataBase::getValueString(size_t offset, size_t s
     return result;
 }
 
+bool StorageHelperRK::PersistentDataBase::getValueString(size_t offset, size_t size, char *buf, size_t bufSize) const {
+    bool result = false;
+
+    if (bufSize == 0) {
+        return false;
+    }
+    buf[0] = 0;
+
+    WITH_LOCK(*this) {
+        if (offset <= (savedDataSize - (size - 1))) {
+            const char *p = (const char *)savedDataHeader;
+            p += offset;
+            size_t len = strnlen(p, size);
+            if (len >= bufSize) {
+                len = bufSize - 1;
+            }
+            memcpy(buf, p, len);
+            buf[len] = 0;
+            result = true;
+        }
+    }
+    return result;
+}
+
 bool StorageHelperRK::PersistentDataBase::setValueString(size_t offset, size_t size, const char *value) {
     bool result = false;
 
@@ -99,7 +123,31 @@ uint32_t StorageHelperRK::PersistentDataBase::getHash() const {
     return hash;
 }
 
+void StorageHelperRK::PersistentDataBase::beginUpdate() {
+    lock();
+    updateDepth++;
+}
+
+void StorageHelperRK::PersistentDataBase::endUpdate() {
+    if (updateDepth > 0 && --updateDepth == 0 && updatePending) {
+        updatePending = false;
+        updateHash();
+    }
+    unlock();
+}
+
 void StorageHelperRK::PersistentDataBase::updateHash() {
+    if (updateDepth) {
+        // Inside beginUpdate()/endUpdate(); hash once at the end
+        updatePending = true;
+        return;
+    }
+    if (deferHash) {
+        // Hashed in save()
+        hashStale = true;
+        saveOrDefer();
+        return;
+    }
     savedDataHeader->hash = getHash();
 #ifdef LOG_HASH
         Log.trace("updateHash size=%u hash=%08lx", (int)savedDataHeader->size, savedDataHeader->hash);
@@ -127,6 +175,7 @@ bool StorageHelperRK::PersistentDataBase::validate(size_t dataSize) {
         hash = getHash();
 
         if (savedDataHeader->hash == hash) {                
+            size_t oldSize = savedDataHeader->size;
             if ((size_t)dataSize < savedDataSize) {
                 // Current structure is larger than what's in the file; pad with zero bytes
                 uint8_t *p = (uint8_t *)savedDataHeader;
@@ -134,11 +183,17 @@ bool StorageHelperRK::PersistentDataBase::validate(size_t dataSize) {
                     p[ii] = 0;
                 }
             }
+            if (oldSize < savedDataSize) {
+                initializeAppended(oldSize);
+            }
             savedDataHeader->size = (uint16_t) savedDataSize;
             savedDataHeader->hash = getHash();
             isValid = true;
         }
     }   
+    if (!isValid && migrate(dataSize)) {
+        isValid = true;
+    }
     if (!isValid && dataSize != 0 && savedDataHeader->magic != 0) {
         // Only log if the data is not empty and was not zeroed out, to avoid logging when doing a load operation on
         // blank data (empty file or zeroed retained memory)
@@ -148,6 +203,61 @@ bool StorageHelperRK::PersistentDataBase::validate(size_t dataSize) {
     return isValid;
 }
 
+bool StorageHelperRK::PersistentDataBase::migrate(size_t dataSize) {
+    if (numMigrationSteps == 0 || dataSize < sizeof(SavedDataHeader) ||
+        savedDataHeader->magic != savedDataMagic || savedDataHeader->version >= savedDataVersion ||
+        savedDataHeader->size > dataSize || savedDataHeader->size > savedDataSize ||
+        savedDataHeader->hash != getHash()) {
+        return false;
+    }
+
+    uint16_t fromVersion = savedDataHeader->version;
+    uint8_t *from = new uint8_t[savedDataSize];
+    if (!from) {
+        return false;
+    }
+    uint8_t *to = (uint8_t *)savedDataHeader;
+    bool upgraded = true;
+    while(upgraded && savedDataHeader->version < savedDataVersion) {
+        upgraded = false;
+        for(size_t ii = 0; ii < numMigrationSteps; ii++) {
+            const MigrationStep &step = migrationSteps[ii];
+            uint16_t minSize = step.minFromSize ? step.minFromSize : step.fromSize;
+            uint16_t size = savedDataHeader->size;
+            if (step.fromVersion == savedDataHeader->version && size >= minSize && size <= step.fromSize &&
+                step.fromSize <= savedDataSize) {
+                memcpy(from, to, size);
+                memset(from + size, 0, step.fromSize - size);
+                memset(to + sizeof(SavedDataHeader), 0, savedDataSize - sizeof(SavedDataHeader));
+                step.upgrade(from, to);
+                savedDataHeader->version++;
+
+                // The next step says how large this version was; the last one is the current structure
+                savedDataHeader->size = (uint16_t) savedDataSize;
+                for(size_t jj = 0; jj < numMigrationSteps; jj++) {
+                    if (migrationSteps[jj].fromVersion == savedDataHeader->version) {
+                        savedDataHeader->size = migrationSteps[jj].fromSize;
+                    }
+                }
+                upgraded = true;
+                break;
+            }
+        }
+    }
+    delete[] from;
+
+    if (savedDataHeader->version != savedDataVersion) {
+        // No step for a version on the way; the caller reinitializes
+        return false;
+    }
+    savedDataHeader->size = (uint16_t) savedDataSize;
+    savedDataHeader->hash = getHash();
+    hashStale = false;
+    lastUpdate = millis() | 1;      // Written back at the next flush()
+    Log.info("upgraded saved data from version %u to %u", fromVersion, savedDataVersion);
+    return true;
+}
+
 void StorageHelperRK::PersistentDataBase::initialize() {
     memset(savedDataHeader, 0, savedDataSize);
     savedDataHeader->magic = savedDataMagic;
@@ -158,6 +268,7 @@ void StorageHelperRK::PersistentDataBase::initialize() {
 
 void StorageHelperRK::PersistentDataBase::save() {
     savedDataHeader->hash = getHash();
+    hashStale = false;
     if (logData) {
         Log.info("saving data size=%d", (int)savedDataHeader->size);
         Log.dump((const uint8_t *)savedDataHeader, savedDataHeader->size);
@@ -231,8 +342,7 @@ bool StorageHelperRK::PersistentDataFileSystem::load() {
 
         int dataSize = 0;
 
-        int fd = fs->open(filename, O_RDONLY);
-        if (fd != -1) {
+        if (fs->open(filename, O_RDONLY)) {
             dataSize = fs->read((uint8_t *)savedDataHeader, savedDataSize);
 
             // Log.info("request to read %d, got %d bytes", (int)savedDataSize, (int) dataSize);
@@ -250,24 +360,40 @@ bool StorageHelperRK::PersistentDataFileSystem::load() {
         if (!loaded) {
             initialize();
         }
+
+        // The bytes in RAM are now the file's (or fresh defaults), hashed by validate() or initialize()
+        hashStale = false;
     }
 
     return true;
 }
 
+uint32_t StorageHelperRK::PersistentDataFileSystem::writeDelayMs = 0;
+
+void (*StorageHelperRK::PersistentDataBase::accessHook)(const PersistentDataBase *data, size_t offset, bool write, uint32_t ticks) = nullptr;
+
 void StorageHelperRK::PersistentDataFileSystem::save() {
     WITH_LOCK(*this) {
-        int fd = fs->open(filename, O_RDWR | O_CREAT | O_TRUNC);
-        if (fd != -1) {            
-            /* size_t count = */fs->write((const uint8_t *)savedDataHeader, savedDataSize);
+        uint32_t start = micros();
+        if (writeDelayMs) {
+            delay(writeDelayMs);
+        }
+
+        // Hash first so the file is written with a hash that matches its contents
+        PersistentDataBase::save();
+
+        size_t count = 0;
+        if (fs->open(filename, O_RDWR | O_CREAT | O_TRUNC)) {
+            count = fs->write((const uint8_t *)savedDataHeader, savedDataSize);
 
             // Log.info("request to write %d, wrote %d bytes", (int)savedDataSize, (int) count);
             // Log.dump((const uint8_t *)savedDataHeader, savedDataSize);
 
             fs->close();
         }
+
+        saveStats.add(micros() - start, count, count == savedDataSize);
     }
-    PersistentDataBase::save();
 }
 
 
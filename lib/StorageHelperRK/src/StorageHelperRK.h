@@ -571,6 +571,30 @@ public:
             uint32_t reserved1;             //!< reserved for future use
             // You cannot change the size of this structure without changing the version number!
         };
+
+        /**
+         * @brief One step of an in-place layout upgrade; see withMigrations()
+         */
+        struct MigrationStep {
+            uint16_t fromVersion;           //!< Version of the data this step reads
+            uint16_t fromSize;              //!< Size of the whole structure at that version, including the header
+            /**
+             * @brief Write the fromVersion + 1 fields of to from the fromVersion image in from
+             * 
+             * Both point at the header. from is fromSize bytes, zero past the size that was saved;
+             * to is zeroed after its header and is as large as the current structure. The header
+             * itself is updated by the caller.
+             */
+            void (*upgrade)(const uint8_t *from, uint8_t *to);
+            /**
+             * @brief Smallest saved size this step accepts, or 0 for fromSize only
+             * 
+             * A version that had fields appended (see initializeAppended()) was saved at every
+             * size from the first layout of that version up to fromSize. Fields past the saved
+             * size read as 0, as validate() leaves appended fields before initializeAppended().
+             */
+            uint16_t minFromSize;
+        };
         
         /**
          * @brief Base class for persistent data saved in file or RAM
@@ -617,6 +641,27 @@ public:
             return *this;
         }
 
+        /**
+         * @brief Upgrade data saved by older firmware in place instead of reinitializing it
+         * 
+         * @param steps One step per older version, each converting version N to N + 1. Kept by pointer.
+         * @param numSteps Number of steps
+         * @return PersistentDataBase& 
+         * 
+         * When the header has the right magic but an older version, and the data is hash-valid for
+         * that version and size, validate() runs the steps from that version up to the current one
+         * and accepts the result. The upgraded data is saved at the next flush(). Data of a version
+         * without a step is still reinitialized.
+         * 
+         * Fields appended at the end of the structure need no version change or step; see
+         * initializeAppended().
+         */
+        PersistentDataBase &withMigrations(const MigrationStep *steps, size_t numSteps) {
+            migrationSteps = steps;
+            numMigrationSteps = numSteps;
+            return *this;
+        }
+
 
         
 
@@ -671,6 +716,7 @@ public:
         template<class T>
         T getValue(size_t offset) const {
             T result = 0;
+            uint32_t startTicks = accessHook ? System.ticks() : 0;
 
             WITH_LOCK(*this) {
                 if (offset <= (savedDataSize - sizeof(T))) {
@@ -679,6 +725,9 @@ public:
                     result = *(const T *)p;
                 }
             }
+            if (accessHook) {
+                accessHook(this, offset, false, System.ticks() - startTicks);
+            }
             return result;
         }
 
@@ -691,6 +740,7 @@ public:
          */
         template<class T>
         void setValue(size_t offset, T value)  {
+            uint32_t startTicks = accessHook ? System.ticks() : 0;
             WITH_LOCK(*this) {
                 if (offset <= (savedDataSize - sizeof(T))) {
                     uint8_t *p = (uint8_t *)savedDataHeader;
@@ -703,8 +753,19 @@ public:
                     }
                 }
             }
+            if (accessHook) {
+                accessHook(this, offset, true, System.ticks() - startTicks);
+            }
         }
 
+        /**
+         * @brief Called after every getValue() and setValue() with the field offset and the
+         * System.ticks() the access took, lock included, to profile field use. NULL (the
+         * default) costs one test per access. May be called from any thread that uses the
+         * object; it must not use the object itself.
+         */
+        static void (*accessHook)(const PersistentDataBase *data, size_t offset, bool write, uint32_t ticks);
+
         /**
          * @brief Get the value of a string
          * 
@@ -718,6 +779,20 @@ public:
          */
         bool getValueString(size_t offset, size_t size, String &value) const;
 
+        /**
+         * @brief Get the value of a string into a caller buffer, without allocating
+         * 
+         * @param offset 
+         * @param size 
+         * @param buf Buffer to copy into; always null terminated
+         * @param bufSize Size of buf in bytes
+         * @return true 
+         * @return false 
+         * 
+         * The value is truncated if it does not fit in bufSize - 1 bytes.
+         */
+        bool getValueString(size_t offset, size_t size, char *buf, size_t bufSize) const;
+
         /**
          * @brief Set the value of a string
          * 
@@ -740,9 +815,117 @@ public:
         /**
          * @brief Update the hash
          * 
+         * For file-backed data the hash is only marked stale here and is recomputed once in save(),
+         * just before the file is written; a change followed by a save costs one full hash no matter
+         * how many set calls preceded it. validate() never rehashes: load() checks the bytes as read.
+         * 
          */
         void updateHash();
 
+        /**
+         * @brief Begin a batch of updates
+         * 
+         * Takes the lock and defers hashing and save scheduling until the matching endUpdate().
+         * Every setValue() made in between only writes the field; endUpdate() hashes the
+         * structure once and schedules one save if anything changed. Batches may be nested;
+         * only the outermost endUpdate() hashes. Normally you use the UpdateBatch class 
+         * instead of calling this directly so the lock is always released.
+         */
+        void beginUpdate();
+
+        /**
+         * @brief End a batch of updates started with beginUpdate()
+         */
+        void endUpdate();
+
+        /**
+         * @brief Scoped batch of updates
+         * 
+         * Construct one of these on the stack, make any number of set calls on the
+         * object, and the hash and save are done once when it goes out of scope
+         * (or when commit() is called, if earlier).
+         */
+        class UpdateBatch {
+        public:
+            /**
+             * @brief Start a batch of updates on data
+             */
+            explicit UpdateBatch(PersistentDataBase &data) : data(&data) {
+                data.beginUpdate();
+            }
+
+            /**
+             * @brief Commits the batch if it has not been committed already
+             */
+            ~UpdateBatch() {
+                commit();
+            }
+
+            /**
+             * @brief Hash and schedule the save now and release the lock. Safe to call more than once.
+             */
+            void commit() {
+                if (data) {
+                    data->endUpdate();
+                    data = nullptr;
+                }
+            }
+
+            UpdateBatch(const UpdateBatch&) = delete;
+            UpdateBatch& operator=(const UpdateBatch&) = delete;
+
+        protected:
+            PersistentDataBase *data; //!< Object being updated, nullptr once committed
+        };
+
+        /**
+         * @brief Save instrumentation, collected since boot by storage classes that write to flash
+         */
+        class SaveStats {
+        public:
+            static const size_t NUM_BUCKETS = 5; //!< Histogram buckets: < 1 ms, < 5 ms, < 20 ms, < 100 ms, >= 100 ms
+
+            uint32_t saves = 0;             //!< Number of save() calls that wrote data
+            uint32_t failures = 0;          //!< Saves where the file could not be opened or fully written
+            uint32_t bytesWritten = 0;      //!< Total bytes written
+            uint32_t maxUs = 0;             //!< Worst-case save() duration in microseconds
+            uint32_t lastUs = 0;            //!< Most recent save() duration in microseconds
+            uint64_t totalUs = 0;           //!< Sum of save() durations, for the average
+            uint32_t histogram[NUM_BUCKETS] = {}; //!< Count of saves per duration bucket
+
+            /**
+             * @brief Average save() duration in microseconds (0 if no saves)
+             */
+            uint32_t avgUs() const { return saves ? (uint32_t)(totalUs / saves) : 0; }
+
+            /**
+             * @brief Record one save of bytes that took durationUs
+             */
+            void add(uint32_t durationUs, size_t bytes, bool ok) {
+                static const uint32_t limits[NUM_BUCKETS - 1] = { 1000, 5000, 20000, 100000 };
+                size_t bucket = 0;
+                while (bucket < NUM_BUCKETS - 1 && durationUs >= limits[bucket]) {
+                    bucket++;
+                }
+                histogram[bucket]++;
+                saves++;
+                if (!ok) {
+                    failures++;
+                }
+                bytesWritten += bytes;
+                totalUs += durationUs;
+                lastUs = durationUs;
+                if (durationUs > maxUs) {
+                    maxUs = durationUs;
+                }
+            }
+        };
+
+        /**
+         * @brief Get save instrumentation for this object
+         */
+        const SaveStats &getSaveStats() const { return saveStats; }
+
         static const uint32_t HASH_SEED = 0x851c2a3f; //!< Murmur32 hash seed value (randomly generated)
 
     protected:
@@ -771,6 +954,24 @@ public:
          */
         virtual bool validate(size_t dataSize);
 
+        /**
+         * @brief Set defaults for fields added at the end since the data was saved
+         * 
+         * @param oldSize Size of the saved structure; fields at this offset and beyond read as zero
+         * 
+         * Called from validate(), under the lock and before the hash is recomputed, when valid data
+         * is shorter than the current structure. Write the fields directly, not with setValue().
+         * The base class does nothing.
+         */
+        virtual void initializeAppended(size_t oldSize) {};
+
+        /**
+         * @brief Run the withMigrations() steps on data of an older version. Used internally by validate().
+         * 
+         * @return true if the data is now the current version
+         */
+        bool migrate(size_t dataSize);
+
         /**
          * @brief Used to allow subclasses to initialize the saved data structure. Called internally by load(). 
          * 
@@ -790,6 +991,17 @@ public:
         uint32_t saveDelayMs = 1000; //!< How long to wait to save before writing file to disk. Set to 0 to write immediately.
 
         bool logData = false; //!< Log data when read and saved
+
+        uint8_t updateDepth = 0; //!< Nesting depth of beginUpdate() calls
+        bool updatePending = false; //!< A field changed during the current batch
+
+        SaveStats saveStats; //!< Save instrumentation
+
+        bool deferHash = false; //!< Compute the hash only in save() instead of on every change
+        bool hashStale = false; //!< Data changed since the hash in the header was computed
+
+        const MigrationStep *migrationSteps = nullptr; //!< From withMigrations()
+        size_t numMigrationSteps = 0; //!< Number of migrationSteps
     };
 
     /**
@@ -935,6 +1147,7 @@ public:
          */
         PersistentDataFileSystem(FileSystemBase *fs, const char *filename, SavedDataHeader *savedDataHeader, size_t savedDataSize, uint32_t savedDataMagic, uint16_t savedDataVersion) : 
             PersistentDataBase(savedDataHeader, savedDataSize, savedDataMagic, savedDataVersion), fs(fs), filename(filename) {
+            deferHash = true;
         };
 
         virtual ~PersistentDataFileSystem() {
@@ -965,7 +1178,12 @@ public:
          */
         virtual void save();
 
- 
+        /**
+         * @brief Extra time, in milliseconds, every save() spends before writing, to stand in
+         * for a slow flash on the bench (fault injection). Included in getSaveStats(). 0 (the
+         * default) adds nothing.
+         */
+        static uint32_t writeDelayMs;
 
     protected:
         FileSystemBase *fs; //!< The file system object the persistent data will be stored on
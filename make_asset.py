@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+"""Package a classifier model or PIR group table as an asset OTA blob.
+
+AssetStore (src/AssetStore.h) installs a blob from the firmware bundle's
+assets/ directory only if it has a valid header: magic "GCCA", kind,
+format, version, payload length and the payload's CRC-32. This script
+writes that header in front of the payload.
+
+Usage:
+  ./make_asset.py classifier model.json --version 3 -o assets/classifier.bin
+  ./make_asset.py pir groups.csv --version 1 -o assets/pirgroup.bin
+
+Notes:
+- model.json: {"slot": 0, "inputScale": [...], "layers": [{"inputs", "outputs",
+  "weights": [outputs x inputs, row-major], "bias": [...], "multiplier",
+  "shift", "relu"}, ...]}, the same numbers as a TinyClassifier::Model in a
+  CLASSIFIER_MODELS_HEADER. The slot is 0 accel, 1 vibration, 2 OpenMV.
+- groups.csv: one "highMs,people" row per step, highMs rising; a group
+  high for at least highMs is that many people.
+- Set assetOtaDir=assets in project.properties to ship the directory.
+- Raise --version for each release; a device reinstalls only when the
+  version or CRC differs.
+"""
+
+import argparse
+import csv
+import json
+import struct
+import sys
+import zlib
+
+MAGIC = 0x41434347
+FORMAT = 1
+KIND_CLASSIFIER = 1
+KIND_PIR_GROUP = 2
+
+
+def pad4(data):
+    return data + b"\0" * (-len(data) % 4)
+
+
+def classifier_payload(path):
+    with open(path) as f:
+        model = json.load(f)
+    layers = model["layers"]
+    scale = model["inputScale"]
+    out = struct.pack("<BBH", model["slot"], len(layers), len(scale))
+    out += struct.pack("<%df" % len(scale), *scale)
+    for layer in layers:
+        n_in, n_out = layer["inputs"], layer["outputs"]
+        if len(layer["bias"]) != n_out or len(layer["weights"]) != n_in * n_out:
+            sys.exit("layer with %d inputs, %d outputs has the wrong number of weights or biases" % (n_in, n_out))
+        out += struct.pack("<HHibBH", n_in, n_out, layer["multiplier"], layer["shift"],
+                           1 if layer.get("relu") else 0, 0)
+        out += struct.pack("<%di" % n_out, *layer["bias"])
+        out += pad4(struct.pack("<%db" % len(layer["weights"]), *layer["weights"]))
+    return out
+
+
+def pir_payload(path):
+    steps = []
+    with open(path, newline="") as f:
+        for row in csv.reader(f):
+            if not row or row[0].strip().startswith("#"):
+                continue
+            steps.append((int(row[0]), int(row[1])))
+    if any(b[0] <= a[0] for a, b in zip(steps, steps[1:])):
+        sys.exit("highMs must rise from row to row")
+    return b"".join(struct.pack("<HH", high, people) for high, people in steps)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("kind", choices=["classifier", "pir"])
+    parser.add_argument("source")
+    parser.add_argument("--version", type=int, required=True)
+    parser.add_argument("-o", "--output", required=True)
+    args = parser.parse_args()
+
+    if args.kind == "classifier":
+        kind, payload = KIND_CLASSIFIER, classifier_payload(args.source)
+    else:
+        kind, payload = KIND_PIR_GROUP, pir_payload(args.source)
+    header = struct.pack("<IBBHII", MAGIC, kind, FORMAT, args.version, len(payload),
+                         zlib.crc32(payload) & 0xFFFFFFFF)
+    with open(args.output, "wb") as f:
+        f.write(header + payload)
+    print("%s: kind %d v%d, %d bytes" % (args.output, kind, args.version, len(payload)))
+
+
+if __name__ == "__main__":
+    main()
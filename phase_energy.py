@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+"""Time, charge and energy per firmware phase from a power-analyzer capture.
+
+A PHASE_MARKERS build shows what the device is doing as a 3-bit code on
+phaseMarkerPins (src/PhaseMarker.h). Record those three pins on the
+analyzer's digital inputs along with the current, export the capture as one
+CSV, and this script splits it by phase.
+
+Usage:
+  ./phase_energy.py capture.csv --time <col> --current <col> --bits <b0>,<b1>,<b2>
+                    [--voltage <col> | --volts 3.7] [--current-scale 1]
+                    [--threshold 0.5] [--intervals]
+
+Notes:
+- Column names are as in the CSV header; --bits lists the inputs wired to
+  phaseMarkerPins[0], [1] and [2], in that order.
+- Joulescope: File > Export with the GPI inputs, columns such as
+  "current", "voltage", "in0".."in2". Otii: export the range with all
+  channels at one sample rate, e.g. "Main current", "Main voltage", "GPI1"...
+- --current-scale converts the current column to amperes (1e-3 for mA,
+  1e-6 for uA). Without a voltage column, --volts is the supply voltage
+  for energy; charge does not need it.
+- A marker input counts as 1 above --threshold (0.5 suits 0/1 and volts).
+- Each sample is credited to the phase it was taken in, for the time to the
+  next sample. --intervals also lists every stretch of one phase.
+"""
+
+import argparse
+import csv
+import sys
+
+# PhaseMarker::Phase; keep in step with src/PhaseMarker.h
+PHASES = {
+    0: "sleeping",
+    1: "booting",
+    2: "sensing",
+    3: "connecting",
+    4: "connected",
+    5: "disconnecting",
+}
+
+
+def phase_name(code):
+    return PHASES.get(code, "code%d" % code)
+
+
+def read_capture(args):
+    bits = args.bits.split(",")
+    if len(bits) != 3:
+        sys.exit("--bits needs three column names")
+    with open(args.capture, newline="") as f:
+        reader = csv.DictReader(f)
+        wanted = [args.time, args.current] + bits + ([args.voltage] if args.voltage else [])
+        missing = [c for c in wanted if c not in (reader.fieldnames or [])]
+        if missing:
+            sys.exit("Columns not in %s: %s (have %s)" % (args.capture, ", ".join(missing),
+                                                          ", ".join(reader.fieldnames or [])))
+        for row in reader:
+            try:
+                t = float(row[args.time])
+                amps = float(row[args.current]) * args.current_scale
+                volts = float(row[args.voltage]) if args.voltage else args.volts
+                code = sum((1 << ii) for ii, b in enumerate(bits) if float(row[b]) > args.threshold)
+            except (TypeError, ValueError):
+                continue    # Blank or partial row
+            yield t, amps, volts, code
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Energy per PhaseMarker phase from an analyzer CSV")
+    parser.add_argument("capture")
+    parser.add_argument("--time", required=True, help="time column, seconds")
+    parser.add_argument("--current", required=True, help="current column")
+    parser.add_argument("--bits", required=True, help="marker columns for bits 0,1,2")
+    parser.add_argument("--voltage", help="voltage column")
+    parser.add_argument("--volts", type=float, default=3.7, help="supply voltage without --voltage")
+    parser.add_argument("--current-scale", type=float, default=1.0, help="current column to amperes")
+    parser.add_argument("--threshold", type=float, default=0.5, help="marker input level for a 1")
+    parser.add_argument("--intervals", action="store_true", help="list every stretch of one phase")
+    args = parser.parse_args()
+
+    totals = {}         # code -> [seconds, coulombs, joules, stretches]
+    stretches = []      # (code, start, seconds, coulombs)
+    previous = None
+    for sample in read_capture(args):
+        if previous is not None:
+            t0, amps, volts, code = previous
+            dt = sample[0] - t0
+            if dt > 0:
+                total = totals.setdefault(code, [0.0, 0.0, 0.0, 0])
+                total[0] += dt
+                total[1] += amps * dt
+                total[2] += amps * volts * dt
+                if not stretches or stretches[-1][0] != code:
+                    total[3] += 1
+                    stretches.append([code, t0, 0.0, 0.0])
+                stretches[-1][2] += dt
+                stretches[-1][3] += amps * dt
+        previous = sample
+
+    if not totals:
+        sys.exit("No samples in %s" % args.capture)
+
+    seconds = sum(v[0] for v in totals.values())
+    coulombs = sum(v[1] for v in totals.values())
+    print("%-14s %6s %10s %8s %10s %10s %10s" % ("phase", "times", "seconds", "time%", "mean mA", "mAh", "mJ"))
+    for code in sorted(totals):
+        sec, c, j, n = totals[code]
+        print("%-14s %6d %10.3f %7.1f%% %10.3f %10.5f %10.1f" % (
+            phase_name(code), n, sec, 100.0 * sec / seconds, 1000.0 * c / sec if sec else 0.0,
+            c / 3.6, 1000.0 * j))
+    print("%-14s %6s %10.3f %8s %10.3f %10.5f %10.1f" % (
+        "total", "", seconds, "", 1000.0 * coulombs / seconds, coulombs / 3.6,
+        1000.0 * sum(v[2] for v in totals.values())))
+
+    if args.intervals:
+        print()
+        print("%-14s %12s %10s %10s" % ("phase", "start s", "seconds", "mAh"))
+        for code, start, sec, c in stretches:
+            print("%-14s %12.3f %10.3f %10.5f" % (phase_name(code), start, sec, c / 3.6))
+
+
+if __name__ == "__main__":
+    main()
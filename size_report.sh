@@ -0,0 +1,148 @@
+#!/usr/bin/env bash
+
+# Flash and RAM footprint per source file and per library, from the linker
+# map of a firmware build, with the change against a previous release.
+#
+# Usage:
+#   ./size_report.sh <firmware.map> [previous.csv]
+#
+# Notes:
+# - Particle local builds leave the map next to the .bin (target/<platform>/...).
+# - Writes <firmware.map>.csv (group,text,data,bss); keep it with the release
+#   and pass it as previous.csv next time to get the delta column.
+# - text = code + read-only data, data = initialized RAM (also stored in
+#   flash), bss = zeroed RAM. Flash = text + data, RAM = data + bss.
+# - Groups: each src/ file (src/state/* kept separate), each lib/<Name>, and
+#   each other archive (Device OS, libc) by name.
+
+set -euo pipefail
+
+if [ "$#" -lt 1 ]; then
+  echo "Usage: $0 <firmware.map> [previous.csv]"
+  exit 1
+fi
+
+MAP="$1"
+PREVIOUS="${2:-}"
+CSV="${MAP}.csv"
+
+if [ ! -f "$MAP" ]; then
+  echo "Error: $MAP not found"
+  exit 1
+fi
+
+if command -v c++filt >/dev/null 2>&1; then
+  DEMANGLE="c++filt"
+else
+  DEMANGLE="cat"
+fi
+
+# Per input section: kind (text/data/bss), size, object. Long section names
+# put the address and size on the next line, so keep the name until then.
+# Also emit the largest RAM input sections as "sym" lines.
+awk '
+function hex(s,   n, i, c) {
+  n = 0
+  s = tolower(substr(s, 3))
+  for (i = 1; i <= length(s); i++) {
+    c = index("0123456789abcdef", substr(s, i, 1))
+    n = n * 16 + c - 1
+  }
+  return n
+}
+function kind(out) {
+  if (out ~ /^\.(bss|noinit|psram_bss)/) return "bss"
+  if (out ~ /^\.(data|psram_data|sram)/) return "data"
+  if (out ~ /^\.(text|rodata|ARM|dynalib|psram_text|init_array|fini_array|preinit_array)/) return "text"
+  return ""
+}
+function group(obj,   n, parts) {
+  if (match(obj, /\/lib\/[^\/]+\//)) return substr(obj, RSTART + 1, RLENGTH - 2)
+  if (match(obj, /\/src\/state\/[^\/]+\.o/)) return substr(obj, RSTART + 1, RLENGTH - 3)
+  if (match(obj, /\/src\/[^\/]+\.o/)) return substr(obj, RSTART + 1, RLENGTH - 3)
+  if (match(obj, /[^\/]+\.a\(/)) return substr(obj, RSTART, RLENGTH - 1)
+  n = split(obj, parts, "/")
+  return parts[n]
+}
+function add(section, size, obj,   k, g, name) {
+  k = kind(out)
+  if (k == "" || size == 0) return
+  g = group(obj)
+  total[g, k] += size
+  groups[g] = 1
+  if (k != "text" && size >= 64) {
+    name = section
+    sub(/^\.(bss|data|psram_bss|psram_data)\./, "", name)
+    printf "sym\t%d\t%s\t%s\t%s\n", size, k, g, name
+  }
+}
+/^Linker script and memory map/ { inMap = 1; next }
+!inMap { next }
+/^\.[A-Za-z_]/ { out = $1; pending = ""; next }
+/^ \.[A-Za-z_]/ {
+  if (NF >= 4 && $2 ~ /^0x/ && $3 ~ /^0x/) {
+    add($1, hex($3), $4)
+    pending = ""
+  } else if (NF == 1) {
+    pending = $1
+  }
+  next
+}
+pending != "" && /^ +0x/ {
+  if (NF >= 3 && $2 ~ /^0x/) add(pending, hex($2), $3)
+  pending = ""
+  next
+}
+END {
+  for (g in groups) printf "grp\t%s\t%d\t%d\t%d\n", g, total[g, "text"], total[g, "data"], total[g, "bss"]
+}
+' "$MAP" > "${CSV}.tmp"
+
+{
+  echo "group,text,data,bss"
+  awk -F'\t' '$1 == "grp" { printf "%s,%d,%d,%d\n", $2, $3, $4, $5 }' "${CSV}.tmp" | sort
+} > "$CSV"
+
+echo "Footprint of $MAP (bytes)"
+echo
+awk -F, -v previous="$PREVIOUS" '
+BEGIN {
+  if (previous != "") {
+    while ((getline line < previous) > 0) {
+      split(line, f, ",")
+      if (f[1] != "group") prevFlash[f[1]] = f[2] + f[3]
+    }
+  }
+}
+NR > 1 {
+  flash = $2 + $3
+  ram = $3 + $4
+  totalFlash += flash
+  totalRam += ram
+  delta = (previous == "") ? "" : sprintf("%+d", flash - prevFlash[$1])
+  seen[$1] = 1
+  printf "%10d\t%8d\t%8s\t%s\n", flash, ram, delta, $1
+}
+END {
+  for (g in prevFlash) {
+    if (!(g in seen)) printf "%10d\t%8d\t%8s\t%s (removed)\n", 0, 0, sprintf("%+d", -prevFlash[g]), g
+  }
+  printf "TOTAL\t%d\t%d\n", totalFlash, totalRam > "/dev/stderr"
+}
+' "$CSV" 2> "${CSV}.total" | sort -t$'\t' -k1,1nr | awk -F'\t' -v totals="${CSV}.total" '
+BEGIN { printf "%10s %8s %8s  %s\n", "flash", "ram", "delta", "group" }
+{ printf "%10s %8s %8s  %s\n", $1, $2, $3, $4 }
+END {
+  getline line < totals
+  split(line, t, "\t")
+  printf "%10s %8s %8s  %s\n", t[2], t[3], "", "TOTAL"
+}'
+
+echo
+echo "Largest static RAM users (data/bss sections of 64 bytes or more)"
+echo
+awk -F'\t' '$1 == "sym" { printf "%8d  %-4s  %-28s  %s\n", $2, $3, $4, $5 }' "${CSV}.tmp" | sort -nr | head -25 | $DEMANGLE
+
+rm -f "${CSV}.tmp" "${CSV}.total"
+echo
+echo "Wrote $CSV"
@@ -0,0 +1,49 @@
+// src/AccelPresenceSensor.cpp
+#include "AccelPresenceSensor.h"
+#include "TinyClassifier.h"
+
+static_assert(ACCEL_ODR_HZ == 10 || ACCEL_ODR_HZ == 25 || ACCEL_ODR_HZ == 50 || ACCEL_ODR_HZ == 100,
+              "ACCEL_ODR_HZ must be 10, 25, 50 or 100");
+static_assert(ACCEL_WAKE_THRESHOLD_MG / 16 >= 1 && ACCEL_WAKE_THRESHOLD_MG / 16 <= 127,
+              "ACCEL_WAKE_THRESHOLD_MG must be 16..2032 mg");
+
+bool AccelPresenceSensor::classify(const uint8_t* burst, size_t samples) {
+    uint16_t peakMg = 0;
+    uint32_t sumMg = 0;
+    uint16_t active = 0;
+    for (size_t ii = 0; ii < samples; ii++) {
+        // Largest axis of the sample
+        uint16_t mg = 0;
+        for (int axis = 0; axis < 3; axis++) {
+            int16_t value = sampleMg(&burst[ii * SAMPLE_SIZE], axis);
+            uint16_t magnitude = (uint16_t)(value < 0 ? -value : value);
+            if (magnitude > mg) {
+                mg = magnitude;
+            }
+        }
+        sumMg += mg;
+        if (mg > peakMg) {
+            peakMg = mg;
+        }
+        if (mg >= ACCEL_WAKE_THRESHOLD_MG) {
+            active++;
+        }
+    }
+
+    if (active < ACCEL_PRESENCE_MIN_SAMPLES || peakMg > ACCEL_IMPACT_MG) {
+        return false;
+    }
+    _data.classBits = 0;
+#if CLASSIFIER_ENABLED
+    const float features[] = {(float)peakMg, (float)sumMg / (float)samples, (float)active, (float)samples};
+    if (!TinyClassifier::screen(SensorType::ACCEL_PRESENCE, features, 4, _data.classBits)) {
+        return false;
+    }
+#endif
+    _data.primary = peakMg;
+    _data.secondary = (uint16_t)(sumMg / samples);
+    _data.aux1 = (uint16_t)samples;
+    _data.aux2 = active;
+    _data.flag1 = true;
+    return true;
+}
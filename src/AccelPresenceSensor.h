@@ -0,0 +1,49 @@
+// src/AccelPresenceSensor.h
+#ifndef ACCELPRESENCESENSOR_H
+#define ACCELPRESENCESENSOR_H
+
+#include "Lis3dhSensor.h"
+
+/**
+ * @brief Presence from an LIS3DH accelerometer on I2C, woken by its
+ *        motion interrupt.
+ *
+ * Mounted on a bench, gate or boardwalk, the accelerometer watches for
+ * motion while the MCU naps (see Lis3dhSensor). Each burst read after an
+ * interrupt is classified on device: presence when at least
+ * ACCEL_PRESENCE_MIN_SAMPLES samples are above ACCEL_WAKE_THRESHOLD_MG
+ * and none is above ACCEL_IMPACT_MG. One short spike (rain, a branch) or
+ * a hard knock is rejected and not counted. With CLASSIFIER_ENABLED, a
+ * burst that passes is labelled by TinyClassifier from peak, mean,
+ * samples above the threshold and samples read; noise is rejected too.
+ *
+ * Output per presence (SensorData / SensorEvent):
+ * - primary:   peak |a| in mg over the burst (largest axis)
+ * - secondary: mean |a| in mg over the burst
+ * - aux1:      samples read
+ * - aux2:      samples above the threshold
+ * - flag1:     presence (always set on a returned event)
+ * - classBits: classifier label (CLASSIFIER_ENABLED with a model)
+ */
+class AccelPresenceSensor : public Lis3dhSensor {
+public:
+    /**
+     * @brief Get singleton instance
+     */
+    static AccelPresenceSensor& instance() {
+        static AccelPresenceSensor _instance;
+        return _instance;
+    }
+
+    const char* getSensorType() const override { return "AccelPresence"; }
+
+protected:
+    bool classify(const uint8_t* burst, size_t samples) override;
+
+private:
+    AccelPresenceSensor()
+        : Lis3dhSensor(SensorType::ACCEL_PRESENCE, ACCEL_ODR_HZ, ACCEL_WAKE_THRESHOLD_MG, ACCEL_WAKE_DURATION) {}
+    ~AccelPresenceSensor() {}
+};
+
+#endif /* ACCELPRESENCESENSOR_H */
@@ -0,0 +1,130 @@
+// src/AnalogBurstSensor.cpp
+#include "AnalogBurstSensor.h"
+#include "MyPersistentData.h"  // for sysStatus (verboseMode)
+#include "PowerDomains.h"
+
+uint16_t AnalogBurstSensor::_samples[AnalogBurstSensor::MAX_SAMPLES];
+
+// A burst whose kept samples spread wider than this (12-bit counts) is
+// treated as a floating or noisy input.
+static const uint16_t MAX_BURST_SPREAD = 400;
+
+AnalogBurstSensor::AnalogBurstSensor(const Config& config, SensorType type)
+    : _config(config), _type(type) {
+    if (_config.samples < 1) {
+        _config.samples = 1;
+    } else if (_config.samples > MAX_SAMPLES) {
+        _config.samples = MAX_SAMPLES;
+    }
+    if (_config.trim * 2 >= _config.samples) {
+        _config.trim = (_config.samples - 1) / 2;  // Keep at least the median
+    }
+    _data.type = _type;
+}
+
+bool AnalogBurstSensor::setup() {
+    pinMode(_config.sensePin, INPUT);
+    powerOff();  // Only powered during bursts
+    reset();
+    _isReady = true;
+    return true;
+}
+
+void AnalogBurstSensor::reset() {
+    _data = SensorData();
+    _data.type = _type;
+    _lastErrorCode = 0;
+    _lastRaw = 0;
+}
+
+void AnalogBurstSensor::powerOn() {
+    if (_config.switchedPower) {
+        PowerDomains::acquire(_config.supply, this);
+    }
+}
+
+void AnalogBurstSensor::powerOff() {
+    if (_config.switchedPower) {
+        PowerDomains::release(_config.supply, this);
+    }
+}
+
+uint16_t AnalogBurstSensor::sampleBurst(uint16_t& spread) {
+    const uint8_t n = _config.samples;
+
+    powerOn();
+    if (_config.settleMs) {
+        delay(_config.settleMs);
+    }
+    for (uint8_t i = 0; i < n; i++) {
+        _samples[i] = (uint16_t)analogRead(_config.sensePin);
+    }
+    powerOff();
+
+    // Insertion sort: n <= 32 and usually nearly sorted.
+    for (uint8_t i = 1; i < n; i++) {
+        uint16_t v = _samples[i];
+        int8_t j = (int8_t)i - 1;
+        while (j >= 0 && _samples[j] > v) {
+            _samples[j + 1] = _samples[j];
+            j--;
+        }
+        _samples[j + 1] = v;
+    }
+
+    const uint8_t first = _config.trim;
+    const uint8_t last = n - 1 - _config.trim;
+    spread = _samples[last] - _samples[first];
+
+    uint32_t sum = 0;
+    for (uint8_t i = first; i <= last; i++) {
+        sum += _samples[i];
+    }
+    uint8_t kept = last - first + 1;
+    return (uint16_t)((sum + kept / 2) / kept);
+}
+
+bool AnalogBurstSensor::loop() {
+    if (!_isReady) {
+        return false;
+    }
+
+    uint16_t spread = 0;
+    uint16_t raw = sampleBurst(spread);
+    _lastRaw = raw;
+
+    if (spread > MAX_BURST_SPREAD) {
+        _lastErrorCode = ERROR_NOISY;
+        Log.warn("%s: burst spread %u counts - reading discarded", getSensorType(), spread);
+        return false;
+    }
+
+    SensorData next = _data;
+    if (!convert(raw, next)) {
+        _lastErrorCode = ERROR_RANGE;
+        Log.warn("%s: raw %u out of range", getSensorType(), raw);
+        return false;
+    }
+
+    _lastErrorCode = 0;
+    _data = next;
+    _data.type = _type;
+    _data.timestamp = Time.now();
+    _data.hasNewData = true;
+
+    if (sysStatus.get_verboseMode()) {
+        Log.info("%s: raw=%u spread=%u primary=%u", getSensorType(), raw, spread, _data.primary);
+    }
+    return true;
+}
+
+void AnalogBurstSensor::onSleep() {
+    powerOff();
+    _isReady = false;
+}
+
+bool AnalogBurstSensor::onWake() {
+    powerOff();
+    _isReady = true;
+    return true;
+}
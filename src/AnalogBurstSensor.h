@@ -0,0 +1,100 @@
+// src/AnalogBurstSensor.h
+#ifndef ANALOGBURSTSENSOR_H
+#define ANALOGBURSTSENSOR_H
+
+#include "ISensor.h"
+#include "Particle.h"
+#include "PowerDomains.h"
+
+/**
+ * @brief Base class for power-gated analog sensors read in short bursts.
+ *
+ * Each loop() call powers the sensor, waits the settle time, takes
+ * @ref Config::samples ADC readings back to back, powers the sensor
+ * off again and reduces the burst to one robust value (median or
+ * trimmed mean). The sensor is powered only for the duration of a
+ * burst, so one reading per polling interval costs only a few ms
+ * on-time.
+ *
+ * Device OS does not expose ADC DMA on these platforms, so bursts use a
+ * tight analogRead() loop; at ~10 us per conversion a 16-sample burst
+ * is well under 1 ms.
+ *
+ * Derived classes supply convert() to turn the reduced ADC count into
+ * SensorData fields. These sensors are polled (usesInterrupt() ==
+ * false) and are meant for SCHEDULED mode or as SensorManager
+ * auxiliary sensors.
+ */
+class AnalogBurstSensor : public ISensor {
+public:
+    /** @brief Largest supported burst. */
+    static constexpr uint8_t MAX_SAMPLES = 32;
+
+    /** @brief Burst and power-gating parameters. */
+    struct Config {
+        pin_t    sensePin;        ///< ADC input
+        bool     switchedPower;   ///< Powered through a PowerDomains domain (false if always on)
+        uint16_t settleMs;        ///< Wait after power-on before sampling
+        uint8_t  samples;         ///< Samples per burst (1..MAX_SAMPLES)
+        uint8_t  trim;            ///< Samples dropped from each end before averaging
+        PowerDomains::Domain supply = PowerDomains::SENSOR;   ///< The domain, with switchedPower
+    };
+
+    bool setup() override;
+    bool loop() override;
+
+    const SensorData& getData() const override { return _data; }
+    bool isReady() const override { return _isReady; }
+    void reset() override;
+
+    void onSleep() override;
+    bool onWake() override;
+
+    bool isHealthy() const override { return _lastErrorCode == 0; }
+    int lastErrorCode() const override { return _lastErrorCode; }
+
+    /**
+     * @brief Reduced value of the most recent burst (raw ADC counts).
+     */
+    uint16_t lastRaw() const { return _lastRaw; }
+
+protected:
+    AnalogBurstSensor(const Config& config, SensorType type);
+    virtual ~AnalogBurstSensor() {}
+
+    /**
+     * @brief Fill @p data from a reduced burst value.
+     * @return false if the value is out of the sensor's valid range
+     */
+    virtual bool convert(uint16_t raw, SensorData& data) = 0;
+
+    /** @brief Error code: burst spread too wide (noisy or disconnected input). */
+    static constexpr int ERROR_NOISY = 1;
+    /** @brief Error code: convert() rejected the value. */
+    static constexpr int ERROR_RANGE = 2;
+
+private:
+    AnalogBurstSensor(const AnalogBurstSensor&) = delete;
+    AnalogBurstSensor& operator=(const AnalogBurstSensor&) = delete;
+
+    void powerOn();
+    void powerOff();
+
+    /**
+     * @brief Take one burst and reduce it.
+     * @param[out] spread max - min of the kept samples
+     */
+    uint16_t sampleBurst(uint16_t& spread);
+
+    Config _config;
+    SensorType _type;
+    bool _isReady = false;
+    int _lastErrorCode = 0;
+    uint16_t _lastRaw = 0;
+    SensorData _data;
+
+    // Shared scratch buffer; bursts are never concurrent.
+    static uint16_t _samples[MAX_SAMPLES];
+};
+
+#endif /* ANALOGBURSTSENSOR_H */
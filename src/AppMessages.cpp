@@ -0,0 +1,40 @@
+#include "AppMessages.h"
+#include "Cloud.h"
+#include "MessageQueue.h"
+#include "ReportTracker.h"
+#include "StateMachine.h"
+
+namespace AppMessages {
+
+static MessageQueue<Message, 16> queue;
+
+bool post(Type type, int32_t value) {
+    return queue.push(Message{type, value});
+}
+
+bool loop() {
+    Message msg;
+    while (queue.pop(msg)) {
+        switch (msg.type) {
+        case LEDGER_SYNCED:
+            Cloud::instance().noteLedgerSynced();
+            break;
+        case HOOK_RESPONSE:
+            handleHookResponse(msg.value);
+            break;
+        case HOOK_CONFIRM:
+            ReportTracker::confirm((uint32_t)msg.value);
+            break;
+        case OUT_OF_MEMORY:
+            outOfMemory = msg.value;    // loop() takes the device to ERROR_STATE
+            break;
+        }
+    }
+    return true;
+}
+
+uint32_t overflows() {
+    return queue.overflows();
+}
+
+} // namespace AppMessages
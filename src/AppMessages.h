@@ -0,0 +1,61 @@
+/**
+ * @file AppMessages.h
+ * @brief Typed messages from system-thread callbacks to the application loop.
+ *
+ * @details Ledger sync callbacks, the webhook response subscription and the
+ *          out-of-memory system event run outside the application thread.
+ *          Instead of setting plain flags or writing sysStatus and current
+ *          there (and taking their mutexes on the system thread), they
+ *          post() a small message and return at once. loop() runs early in
+ *          each application pass and does the work the callback used to.
+ *
+ *          The queue is a lock-free MessageQueue, so post() never blocks
+ *          and is safe from any thread or an ISR. If it fills, messages
+ *          are dropped and counted in overflows(); everything posted here
+ *          either repeats (ledger syncs, webhook responses) or is sticky
+ *          (out of memory raises alert 14 and the device resets).
+ */
+
+#ifndef __APPMESSAGES_H
+#define __APPMESSAGES_H
+
+#include "Particle.h"
+
+namespace AppMessages {
+
+/** @brief What happened. */
+enum Type : uint8_t {
+    LEDGER_SYNCED,      ///< default-settings or device-settings synced; apply from the config task
+    HOOK_RESPONSE,      ///< Webhook response; value is the HTTP status, or -1 with no data
+    HOOK_CONFIRM,       ///< 2xx webhook response for report seq value (0 = the oldest); see ReportTracker
+    OUT_OF_MEMORY,      ///< out_of_memory system event; value is its param
+};
+
+/** @brief One message; copied through the queue. */
+struct Message {
+    Type type;
+    int32_t value;
+};
+
+/**
+ * @brief Queue a message for the application thread; safe from any thread
+ *
+ * @return false if the queue was full and the message was dropped
+ */
+bool post(Type type, int32_t value = 0);
+
+/**
+ * @brief Handle the queued messages; call once per loop() pass
+ *
+ * @return true (TaskScheduler convention)
+ */
+bool loop();
+
+/**
+ * @brief Messages dropped because the queue was full
+ */
+uint32_t overflows();
+
+} // namespace AppMessages
+
+#endif /* __APPMESSAGES_H */
@@ -0,0 +1,122 @@
+#include "AssetStore.h"
+#include "Config.h"
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace AssetStore {
+
+static const char *assetDir = "/usr/assets";
+
+static void pathFor(Kind kind, char *path, size_t size, bool temp) {
+    snprintf(path, size, "%s/%u.%s", assetDir, (unsigned)kind, temp ? "tmp" : "bin");
+}
+
+static uint32_t crc32(uint32_t crc, const uint8_t *data, size_t len) {
+    crc = ~crc;
+    while (len--) {
+        crc ^= *data++;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static bool validHeader(const Header &hdr) {
+    return hdr.magic == MAGIC && hdr.kind > 0 && hdr.kind < NUM_KINDS && hdr.format == FORMAT &&
+           hdr.length > 0 && hdr.length <= ASSET_MAX_BYTES;
+}
+
+// Header of the installed blob of @p kind; false if there is none
+static bool installedHeader(Kind kind, Header &hdr) {
+    char path[32];
+    pathFor(kind, path, sizeof(path), false);
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = read(fd, &hdr, sizeof(hdr)) == (int)sizeof(hdr) && validHeader(hdr);
+    close(fd);
+    return ok;
+}
+
+// Copy @p asset to the temp file, checking it as it goes, then swap it in
+static bool install(ApplicationAsset &asset, const Header &hdr) {
+    char tempPath[32], path[32];
+    pathFor((Kind)hdr.kind, tempPath, sizeof(tempPath), true);
+    pathFor((Kind)hdr.kind, path, sizeof(path), false);
+
+    int fd = open(tempPath, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0) {
+        Log.warn("Asset: open failed (%d)", errno);
+        return false;
+    }
+    bool ok = write(fd, &hdr, sizeof(hdr)) == (int)sizeof(hdr);
+    uint32_t crc = 0;
+    uint32_t remaining = hdr.length;
+    uint8_t chunk[256];
+    while (ok && remaining > 0) {
+        int len = asset.read((char *)chunk, std::min((uint32_t)sizeof(chunk), remaining));
+        if (len <= 0) {
+            ok = false;
+            break;
+        }
+        crc = crc32(crc, chunk, len);
+        ok = write(fd, chunk, len) == len;
+        remaining -= len;
+    }
+    close(fd);
+
+    if (!ok || crc != hdr.crc || rename(tempPath, path) != 0) {
+        Log.warn("Asset: %s not installed (%s)", asset.name().c_str(), ok ? "CRC mismatch or rename failed" : "short read or write");
+        unlink(tempPath);
+        return false;
+    }
+    return true;
+}
+
+void setup() {
+    mkdir(assetDir, 0777);
+    for (ApplicationAsset &asset : System.assetsAvailable()) {
+        Header hdr;
+        asset.reset();
+        if (asset.read((char *)&hdr, sizeof(hdr)) != (int)sizeof(hdr) || !validHeader(hdr) ||
+            hdr.length != asset.size() - sizeof(hdr)) {
+            Log.warn("Asset: %s is not a blob; skipped", asset.name().c_str());
+            continue;
+        }
+        Header old;
+        if (installedHeader((Kind)hdr.kind, old) && old.version == hdr.version && old.crc == hdr.crc) {
+            continue;
+        }
+        if (install(asset, hdr)) {
+            Log.info("Asset: %s installed as kind %u v%u (%lu bytes)", asset.name().c_str(),
+                     (unsigned)hdr.kind, (unsigned)hdr.version, (unsigned long)hdr.length);
+        }
+    }
+    System.assetsHandled(true);
+}
+
+size_t load(Kind kind, void *buffer, size_t bufferSize, uint16_t &version) {
+    char path[32];
+    pathFor(kind, path, sizeof(path), false);
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    Header hdr;
+    bool ok = read(fd, &hdr, sizeof(hdr)) == (int)sizeof(hdr) && validHeader(hdr) && hdr.kind == kind &&
+              hdr.length <= bufferSize && read(fd, buffer, hdr.length) == (int)hdr.length;
+    close(fd);
+    if (!ok || crc32(0, (const uint8_t *)buffer, hdr.length) != hdr.crc) {
+        Log.warn("Asset: kind %u blob unusable; keeping the built-in default", (unsigned)kind);
+        return 0;
+    }
+    version = hdr.version;
+    return hdr.length;
+}
+
+} // namespace AssetStore
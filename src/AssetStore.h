@@ -0,0 +1,75 @@
+/**
+ * @file AssetStore.h
+ * @brief Versioned data blobs (classifier models, calibration tables)
+ *        delivered by Device OS asset OTA instead of in the firmware.
+ *
+ * @details Files in assets/ (assetOtaDir in project.properties) go out in
+ *          the firmware bundle, but a device downloads only the ones that
+ *          changed. A new model or table is then a small transfer that can
+ *          be released on its own schedule.
+ *
+ *          Every blob starts with a Header: magic, kind, version, payload
+ *          length and a CRC-32 of the payload (make_asset.py writes it).
+ *          At boot setup() installs each available asset that has a valid
+ *          header and a different version or CRC from the installed copy.
+ *          The asset is copied to a temp file and checked as it goes, and
+ *          only a complete, matching copy is renamed over
+ *          /usr/assets/<kind>.bin. A torn or corrupt download leaves the
+ *          old blob in place. Then Device OS is told the assets were
+ *          handled.
+ *
+ *          A consumer load()s its kind once at boot into its own static
+ *          buffer, checked again, and keeps pointers into it. The Gen 3 and
+ *          P2 file system cannot be mapped into the address space, so this
+ *          stands in for mapping. Without an installed blob the consumer
+ *          keeps its compiled-in default.
+ *
+ *          Application thread only.
+ */
+
+#ifndef __ASSETSTORE_H
+#define __ASSETSTORE_H
+
+#include "Particle.h"
+
+namespace AssetStore {
+
+/** @brief What a blob holds; one installed blob per kind. */
+enum Kind : uint8_t {
+    CLASSIFIER_MODEL = 1,       ///< TinyClassifier model for one sensor slot
+    PIR_GROUP_TABLE = 2,        ///< PIRSensor group high time to people
+    NUM_KINDS
+};
+
+/** @brief Blob header, little-endian. */
+struct Header {
+    uint32_t magic;             ///< MAGIC
+    uint8_t kind;               ///< Kind
+    uint8_t format;             ///< Payload layout of the kind; FORMAT
+    uint16_t version;           ///< Blob release, reported at boot
+    uint32_t length;            ///< Payload bytes after the header
+    uint32_t crc;               ///< CRC-32 (IEEE) of the payload
+};
+static_assert(sizeof(Header) == 16, "AssetStore::Header must stay 16 bytes");
+
+static constexpr uint32_t MAGIC = 0x41434347;   ///< "GCCA"
+static constexpr uint8_t FORMAT = 1;
+
+/**
+ * @brief Install new assets and tell Device OS they were handled; call
+ *        once in setup() before any consumer loads
+ */
+void setup();
+
+/**
+ * @brief Read the installed blob of @p kind into @p buffer, checked
+ *
+ * @param version Set to the blob's version
+ * @return Payload length, or 0 if none is installed, it does not fit or it
+ *         fails its check
+ */
+size_t load(Kind kind, void *buffer, size_t bufferSize, uint16_t &version);
+
+} // namespace AssetStore
+
+#endif /* __ASSETSTORE_H */
@@ -0,0 +1,206 @@
+#include "AutoTune.h"
+#include "Config.h"
+#include "MyPersistentData.h"
+#include "Payload.h"
+#include "SensorManager.h"
+
+extern bool publishDiagnosticSafe(const char* eventName, const char* data, PublishFlags flags);
+
+namespace AutoTune {
+
+static const char *const verdictNames[] = {"-", "usual", "above", "below"};
+
+// Filter and range finder counts at the last noteHour(); their deltas are the hour
+static bool haveMark = false;
+static uint32_t markAccepted = 0;
+static uint32_t markRetriggers = 0;
+static uint32_t markChatter = 0;
+static uint32_t markFusionChecked = 0;
+static uint32_t markFusionRejected = 0;
+
+struct Hour {
+    uint32_t events;
+    uint16_t retriggerPct;
+    uint16_t chatterPct;
+    int16_t fusionPct;              // -1 when no event was range-checked
+    TrafficBaseline::Verdict verdict;
+};
+
+uint16_t tuned(uint16_t configured, int16_t offset, uint16_t lo, uint16_t hi) {
+    lo = lo < configured ? lo : configured;
+    hi = hi > configured ? hi : configured;
+    int32_t value = (int32_t)configured + offset;
+    return (uint16_t)(value < lo ? lo : value > hi ? hi : value);
+}
+
+static uint16_t percent(uint32_t part, uint32_t whole) {
+    return whole ? (uint16_t)((uint64_t)part * 100 / whole) : 0;
+}
+
+static void report(const char *param, uint16_t from, uint16_t to, const char *why, const Hour &hour) {
+    Log.info("AutoTune: %s %u -> %u ms (%s; %lu events, %u%% retrigger, %u%% chatter, baseline %s)", param,
+             (unsigned)from, (unsigned)to, why, (unsigned long)hour.events, (unsigned)hour.retriggerPct,
+             (unsigned)hour.chatterPct, verdictNames[hour.verdict]);
+
+    char data[160];
+    Payload::Writer writer(data, sizeof(data));
+    writer.beginObject()
+          .add("p", param)
+          .add("from", (unsigned long)from)
+          .add("to", (unsigned long)to)
+          .add("why", why)
+          .add("n", (unsigned long)hour.events)
+          .add("rt", (unsigned long)hour.retriggerPct)
+          .add("ch", (unsigned long)hour.chatterPct);
+    if (hour.fusionPct >= 0) {
+        writer.add("fr", (unsigned long)hour.fusionPct);
+    }
+    writer.add("base", verdictNames[hour.verdict]).endObject();
+    if (writer.ok()) {
+        publishDiagnosticSafe("autoTune", data, PRIVATE);
+    }
+}
+
+// Moves one setting by delta, no lower than floor; false at a bound
+static bool step(const char *param, uint16_t configured, int16_t offset, int32_t delta, int32_t floor,
+                 uint16_t lo, uint16_t hi, void (*setOffset)(int16_t), const char *why, const Hour &hour) {
+    uint16_t from = tuned(configured, offset, lo, hi);
+    int32_t target = (int32_t)from + delta;
+    if (delta < 0 && target < floor) {
+        target = floor;
+    }
+    uint16_t to = tuned(configured, (int16_t)constrain(target - (int32_t)configured, -32768, 32767), lo, hi);
+    if (to == from) {
+        return false;
+    }
+    setOffset((int16_t)((int32_t)to - configured));
+    sysStatus.set_tuneSteps(sysStatus.get_tuneSteps() < UINT16_MAX ? sysStatus.get_tuneSteps() + 1 : UINT16_MAX);
+    report(param, from, to, why, hour);
+    return true;
+}
+
+static void setRefractoryOffset(int16_t value) {
+    sysStatus.set_tuneRefractoryMs(value);
+}
+
+static void setDebounceOffset(int16_t value) {
+    sysStatus.set_tuneDebounceMs(value);
+}
+
+void noteHour(TrafficBaseline::Verdict verdict) {
+#if AUTO_TUNE_ENABLED
+    const EventFilter &filter = SensorManager::instance().filter();
+    uint32_t accepted = filter.acceptedCount();
+    uint32_t retriggers = filter.retriggerCount();
+    uint32_t chatter = filter.chatterCount();
+    uint32_t fusionChecked = 0;
+    uint32_t fusionRejected = 0;
+#if FUSION_RANGE_CM > 0
+    const SensorManager::FusionStats &fusion = SensorManager::instance().fusionStats();
+    fusionChecked = fusion.confirmed + fusion.rejected;
+    fusionRejected = fusion.rejected;
+#endif
+
+    Hour hour;
+    hour.events = accepted - markAccepted;
+    hour.retriggerPct = percent(retriggers - markRetriggers, hour.events);
+    hour.chatterPct = percent(chatter - markChatter, hour.events);
+    uint32_t checked = fusionChecked - markFusionChecked;
+    hour.fusionPct = checked >= AUTO_TUNE_MIN_EVENTS ? (int16_t)percent(fusionRejected - markFusionRejected, checked)
+                                                     : -1;
+    hour.verdict = verdict;
+    bool judged = haveMark;
+
+    haveMark = true;
+    markAccepted = accepted;
+    markRetriggers = retriggers;
+    markChatter = chatter;
+    markFusionChecked = fusionChecked;
+    markFusionRejected = fusionRejected;
+
+    if (!sensorConfig.get_autoTune()) {
+        if (sysStatus.get_tuneRefractoryMs() != 0 || sysStatus.get_tuneDebounceMs() != 0) {
+            Log.info("AutoTune: switched off; back to the site's filter settings");
+            sysStatus.set_tuneRefractoryMs(0);
+            sysStatus.set_tuneDebounceMs(0);
+        }
+        sysStatus.set_tuneStreak(0);
+        return;
+    }
+    if (!judged || hour.events < AUTO_TUNE_MIN_EVENTS) {
+        return;     // Counts since boot, or too few events to say anything
+    }
+
+    bool retriggering = hour.retriggerPct >= AUTO_TUNE_RETRIGGER_HIGH_PCT;
+    bool chattering = hour.chatterPct >= AUTO_TUNE_CHATTER_HIGH_PCT;
+    bool rangeRejecting = hour.fusionPct >= AUTO_TUNE_FUSION_REJECT_PCT;
+    bool clean = hour.retriggerPct <= AUTO_TUNE_RETRIGGER_LOW_PCT && !chattering &&
+                 hour.fusionPct < AUTO_TUNE_FUSION_REJECT_PCT / 3;
+
+    int16_t refractoryOffset = sysStatus.get_tuneRefractoryMs();
+    int16_t debounceOffset = sysStatus.get_tuneDebounceMs();
+    int8_t vote = 0;
+    if ((retriggering || chattering || rangeRejecting) && verdict != TrafficBaseline::BELOW) {
+        vote = 1;
+    } else if (clean && (refractoryOffset > 0 || debounceOffset > 0 || verdict == TrafficBaseline::BELOW)) {
+        vote = -1;
+    }
+
+    int8_t streak = sysStatus.get_tuneStreak();
+    streak = (vote == 0 || (streak > 0) != (vote > 0)) ? vote : (int8_t)(streak + vote);
+    if (streak > -AUTO_TUNE_HOURS && streak < AUTO_TUNE_HOURS) {
+        sysStatus.set_tuneStreak(streak);
+        return;
+    }
+    sysStatus.set_tuneStreak(0);
+
+    uint16_t refractoryMs = sensorConfig.get_refractoryMs();
+    uint16_t debounceMs = sensorConfig.get_debounceMs();
+    uint16_t minRefractoryMs = sensorConfig.get_tuneMinRefractoryMs();
+    uint16_t maxRefractoryMs = sensorConfig.get_tuneMaxRefractoryMs();
+    uint16_t maxDebounceMs = sensorConfig.get_tuneMaxDebounceMs();
+    bool moved = false;
+    if (vote > 0) {
+        if (chattering) {
+            moved |= step("debounceMs", debounceMs, debounceOffset, AUTO_TUNE_DEBOUNCE_STEP_MS, 0, 0, maxDebounceMs,
+                          setDebounceOffset, "chatter", hour);
+        }
+        if (retriggering || rangeRejecting) {
+            moved |= step("refractoryMs", refractoryMs, refractoryOffset, AUTO_TUNE_REFRACTORY_STEP_MS, 0,
+                          minRefractoryMs, maxRefractoryMs, setRefractoryOffset,
+                          retriggering ? "retrigger" : "range", hour);
+        }
+    } else {
+        // Back towards the site's own values; past them only on a count under the baseline
+        bool under = verdict == TrafficBaseline::BELOW;
+        moved = step("refractoryMs", refractoryMs, refractoryOffset, -AUTO_TUNE_REFRACTORY_STEP_MS,
+                     under ? 0 : refractoryMs, minRefractoryMs, maxRefractoryMs, setRefractoryOffset,
+                     under ? "under" : "clean", hour) ||
+                step("debounceMs", debounceMs, debounceOffset, -AUTO_TUNE_DEBOUNCE_STEP_MS, under ? 0 : debounceMs,
+                     0, maxDebounceMs, setDebounceOffset, under ? "under" : "clean", hour);
+    }
+    if (!moved) {
+        Log.info("AutoTune: %s wanted, but the filter is at its tune bound", vote > 0 ? "tightening" : "loosening");
+    }
+#endif
+}
+
+void writeStatus(JSONWriter &writer) {
+#if AUTO_TUNE_ENABLED
+    if (!sensorConfig.get_autoTune()) {
+        return;
+    }
+    uint16_t refractoryMs = tuned(sensorConfig.get_refractoryMs(), sysStatus.get_tuneRefractoryMs(),
+                                  sensorConfig.get_tuneMinRefractoryMs(), sensorConfig.get_tuneMaxRefractoryMs());
+    uint16_t debounceMs = tuned(sensorConfig.get_debounceMs(), sysStatus.get_tuneDebounceMs(), 0,
+                                sensorConfig.get_tuneMaxDebounceMs());
+    writer.name("tune").beginObject();
+    writer.name("refrMs").value((unsigned long)refractoryMs);
+    writer.name("debMs").value((unsigned long)debounceMs);
+    writer.name("streak").value((int)sysStatus.get_tuneStreak());
+    writer.name("steps").value((unsigned long)sysStatus.get_tuneSteps());
+    writer.endObject();
+#endif
+}
+
+} // namespace AutoTune
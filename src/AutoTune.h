@@ -0,0 +1,73 @@
+/**
+ * @file AutoTune.h
+ * @brief Moves the event filter's refractory and debounce times a step at
+ *        a time, within ledger bounds, from what each counted hour shows.
+ *
+ * @details Off unless the ledger sets sensor.autoTune. A site's filter
+ *          settings are its sensor.refractoryMs and sensor.debounceMs;
+ *          AutoTune keeps an offset to each in sysStatus, and ConfigSnapshot
+ *          hands the event filter the sum, clamped to the ledger's
+ *          sensor.tuneMinRefractoryMs..tuneMaxRefractoryMs and
+ *          0..tuneMaxDebounceMs (widened to take in the site's own value).
+ *          A ledger change to the settings or bounds applies at once; the
+ *          offsets are cleared when autoTune is switched off.
+ *
+ *          noteHour() judges each full counted hour, from the hour's share
+ *          of accepted events that were:
+ *
+ *          - retriggers (EventFilter::retriggerCount()): at least
+ *            AUTO_TUNE_RETRIGGER_HIGH_PCT votes for a longer refractory;
+ *          - chatter (EventFilter::chatterCount()): at least
+ *            AUTO_TUNE_CHATTER_HIGH_PCT votes for a longer debounce;
+ *          - rejected by the range finder (FUSION_RANGE_CM builds): at
+ *            least AUTO_TUNE_FUSION_REJECT_PCT votes for a longer refractory;
+ *
+ *          and from the TrafficBaseline verdict. An hour under its slot
+ *          never tightens. A clean hour (few retriggers, little chatter,
+ *          few range rejections) loosens back towards the site's values,
+ *          and below them only when the count was also under its slot.
+ *          AUTO_TUNE_HOURS votes in a row take one step; hours with fewer
+ *          than AUTO_TUNE_MIN_EVENTS events are skipped without breaking
+ *          the run. Each step is logged and queued as an "autoTune" event:
+ *
+ *              {"p":"refractoryMs","from":500,"to":750,"why":"retrigger",
+ *               "n":212,"rt":57,"ch":2,"base":"above"}
+ *
+ *          ("fr", the range finder's rejection percent, is added in
+ *          FUSION_RANGE_CM builds.) The first hour after a boot is not
+ *          judged: the filter's counts start at boot.
+ *
+ *          Application thread only. The filter's counts are single words
+ *          written by whichever thread filters, and are read as deltas.
+ */
+
+#ifndef __AUTOTUNE_H
+#define __AUTOTUNE_H
+
+#include "Particle.h"
+#include "TrafficBaseline.h"
+
+namespace AutoTune {
+
+/**
+ * @brief A site's setting plus its offset, clamped to [lo, hi] widened to
+ *        include the setting
+ */
+uint16_t tuned(uint16_t configured, int16_t offset, uint16_t lo, uint16_t hi);
+
+/**
+ * @brief Judge the full hour just counted, and step if the run is long enough
+ *
+ * @param verdict The hour against its TrafficBaseline slot
+ */
+void noteHour(TrafficBaseline::Verdict verdict);
+
+/**
+ * @brief Write {"refrMs":n,"debMs":n,"streak":n,"steps":n} to an open JSON
+ *        object as "tune", when sensor.autoTune is on
+ */
+void writeStatus(JSONWriter &writer);
+
+} // namespace AutoTune
+
+#endif /* __AUTOTUNE_H */
@@ -0,0 +1,183 @@
+#include "BleReadout.h"
+#include "Config.h"
+#include "Cloud.h"
+#include "HourlyHistory.h"
+#include "MyPersistentData.h"
+#include "Particle_Functions.h"
+#include <algorithm>
+#include <atomic>
+
+namespace BleReadout {
+
+#if BLE_READOUT_ENABLED && HAL_PLATFORM_BLE
+
+static constexpr size_t CHUNK = 20;             // Fits the default ATT MTU
+static constexpr size_t MAX_COMMAND = 128;
+
+static const BleUuid serviceUuid("6e400001-b5a3-f393-e0a9-e50e24dcca9e");
+static const BleUuid rxUuid("6e400002-b5a3-f393-e0a9-e50e24dcca9e");
+static const BleUuid txUuid("6e400003-b5a3-f393-e0a9-e50e24dcca9e");
+
+static void onCommand(const uint8_t *data, size_t len, const BlePeerDevice &peer, void *context);
+
+static BleCharacteristic txCharacteristic("tx", BleCharacteristicProperty::NOTIFY, txUuid, serviceUuid);
+static BleCharacteristic rxCharacteristic("rx", BleCharacteristicProperty::WRITE_WO_RSP | BleCharacteristicProperty::WRITE,
+                                          rxUuid, serviceUuid, onCommand, nullptr);
+
+// Written on the BLE thread, read here once ready is set
+static char command[MAX_COMMAND + 1];
+static std::atomic<bool> commandReady(false);
+
+static bool windowOpen = false;
+static unsigned long lastActivityMs = 0;
+static char reply[768];
+static size_t replyLen = 0;
+static size_t replySent = 0;
+
+static void onCommand(const uint8_t *data, size_t len, const BlePeerDevice &peer, void *context) {
+    if (commandReady.load(std::memory_order_acquire)) {
+        return;     // The last one is still being answered
+    }
+    len = std::min(len, MAX_COMMAND);
+    memcpy(command, data, len);
+    while (len > 0 && (command[len - 1] == '\n' || command[len - 1] == '\r')) {
+        len--;
+    }
+    command[len] = '\0';
+    commandReady.store(true, std::memory_order_release);
+}
+
+static void openWindow() {
+    BleAdvertisingData advData;
+    advData.appendServiceUUID(serviceUuid);
+    BLE.on();
+    BLE.setAdvertisingInterval(BLE_READOUT_ADVERTISE_MS * 8 / 5);   // 0.625 ms units
+    BLE.advertise(&advData);
+    commandReady.store(false, std::memory_order_release);
+    windowOpen = true;
+    lastActivityMs = millis();
+    Log.info("BLE readout: open for %u s", (unsigned)BLE_READOUT_WINDOW_SEC);
+}
+
+static void closeWindow() {
+    if (BLE.connected()) {
+        BLE.disconnect();
+    }
+    BLE.stopAdvertising();
+    BLE.off();
+    windowOpen = false;
+    replyLen = replySent = 0;
+    Log.info("BLE readout: closed");
+}
+
+static size_t formatHistory(char *buffer, size_t bufferSize) {
+    JSONBufferWriter writer(buffer, bufferSize - 1);
+    writer.beginObject();
+    writer.name("h").beginArray();
+    if (Time.isValid()) {
+        time_t hour = Time.now() - Time.now() % 3600;
+        for (int ii = BLE_READOUT_HISTORY_HOURS - 1; ii >= 0; ii--) {
+            HourlyHistory::Record rec;
+            if (!HourlyHistory::instance().read(hour - (time_t)ii * 3600, rec)) {
+                continue;
+            }
+            writer.beginArray();
+            writer.value((unsigned long)rec.hourEpoch);
+            writer.value((unsigned)rec.count);
+            writer.value((unsigned)rec.occupiedSec);
+            writer.value((int)rec.alert);
+            writer.endArray();
+        }
+    }
+    writer.endArray();
+    writer.endObject();
+    if (writer.dataSize() >= bufferSize - 1) {
+        buffer[0] = 0;
+        return 0;
+    }
+    buffer[writer.dataSize()] = 0;
+    return writer.dataSize();
+}
+
+static void runCommand(const char *cmd) {
+    size_t room = sizeof(reply) - 1;    // For the '\n'
+    replySent = 0;
+    if (strcmp(cmd, "metrics") == 0) {
+        replyLen = Particle_Functions::formatMetrics(reply, room);
+    } else if (strcmp(cmd, "history") == 0) {
+        replyLen = formatHistory(reply, room);
+    } else if (strcmp(cmd, "alerts") == 0) {
+        replyLen = snprintf(reply, room, "{\"active\":\"%llx\",\"code\":%d}",
+                            (unsigned long long)current.get_activeAlerts(), (int)current.get_alertCode());
+    } else if (strncmp(cmd, "config:", 7) == 0) {
+        replyLen = snprintf(reply, room, "{\"config\":%d}", Cloud::instance().applyCommand(cmd + 7));
+    } else if (strcmp(cmd, "bye") == 0) {
+        closeWindow();
+        return;
+    } else {
+        replyLen = snprintf(reply, room, "{\"error\":\"unknown\"}");
+    }
+    replyLen = std::min(replyLen, room);
+    reply[replyLen++] = '\n';
+    Log.info("BLE readout: \"%s\" (%u bytes)", cmd, (unsigned)replyLen);
+}
+
+void setup() {
+    BLE.addCharacteristic(txCharacteristic);
+    BLE.addCharacteristic(rxCharacteristic);
+    BLE.off();
+}
+
+bool loop() {
+    if (!windowOpen) {
+        return true;
+    }
+    if (commandReady.load(std::memory_order_acquire)) {
+        lastActivityMs = millis();
+        runCommand(command);
+        commandReady.store(false, std::memory_order_release);
+    }
+    // One notification a pass, so a long reply never holds up the loop
+    if (windowOpen && replySent < replyLen && BLE.connected()) {
+        size_t len = std::min(CHUNK, replyLen - replySent);
+        txCharacteristic.setValue((const uint8_t *)reply + replySent, len);
+        replySent += len;
+    }
+    if (windowOpen && millis() - lastActivityMs >= BLE_READOUT_WINDOW_SEC * 1000UL) {
+        closeWindow();
+    }
+    return true;
+}
+
+bool takeButton() {
+    if (windowOpen) {
+        return false;
+    }
+    openWindow();
+    return true;
+}
+
+bool active() {
+    return windowOpen;
+}
+
+#else
+
+void setup() {
+}
+
+bool loop() {
+    return true;
+}
+
+bool takeButton() {
+    return false;
+}
+
+bool active() {
+    return false;
+}
+
+#endif /* BLE_READOUT_ENABLED && HAL_PLATFORM_BLE */
+
+} // namespace BleReadout
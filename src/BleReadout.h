@@ -0,0 +1,68 @@
+/**
+ * @file BleReadout.h
+ * @brief Local status readout and configuration over BLE for a site visit,
+ *        opened by the front-panel button, with no cellular session.
+ *
+ * @details A button press used to force CONNECTING_STATE just so a
+ *          technician could see the device's status in the console. With
+ *          BLE_READOUT_ENABLED the press opens a BLE window instead: the
+ *          device advertises every BLE_READOUT_ADVERTISE_MS and stays
+ *          awake, and it closes once BLE_READOUT_WINDOW_SEC pass with no
+ *          command. A second press while the window is open connects to
+ *          drain the queue as before.
+ *
+ *          One GATT service, UART style: the phone writes a command to
+ *          the rx characteristic and the reply comes back as tx
+ *          notifications of at most 20 bytes (any MTU), ending in '\n':
+ *
+ *          - "metrics": the metrics variable's JSON
+ *            (Particle_Functions::formatMetrics()).
+ *          - "history": the last BLE_READOUT_HISTORY_HOURS hourly records,
+ *            {"h":[[hourEpoch,count,occupiedSec,alert],...]}.
+ *          - "alerts": {"active":"<activeAlerts, hex>","code":n}.
+ *          - "config:<key=value;...>": the "config" function's batch
+ *            command (Cloud::applyCommand()), {"config":n}.
+ *          - "bye": close the window now.
+ *
+ *          Anyone in range can write while the window is open; it opens
+ *          only for someone at the device.
+ *
+ *          Application thread only, apart from the BLE write callback,
+ *          which only copies the command for loop().
+ */
+
+#ifndef __BLEREADOUT_H
+#define __BLEREADOUT_H
+
+#include "Particle.h"
+
+namespace BleReadout {
+
+/**
+ * @brief Add the GATT service; BLE stays off until a button press
+ */
+void setup();
+
+/**
+ * @brief TaskScheduler task: run a received command, send the reply, close an idle window
+ *
+ * @return true (TaskScheduler task)
+ */
+bool loop();
+
+/**
+ * @brief The button was pressed: open the window if it is closed
+ *
+ * @return true if the press opened the window; false if it was already
+ *         open, or BLE readout is not built in, so the press should connect
+ */
+bool takeButton();
+
+/**
+ * @brief true while the window is open; the device does not sleep
+ */
+bool active();
+
+} // namespace BleReadout
+
+#endif /* __BLEREADOUT_H */
@@ -0,0 +1,108 @@
+#include "BootProfile.h"
+#include "ProjectConfig.h"
+#include "PublishQueuePosixRK.h"
+
+BootProfile *BootProfile::_instance;
+
+// System.ticks() is a 32-bit cycle counter; it wraps after ~21 s on a
+// 200 MHz P2. Phases longer than this are timed with millis() instead.
+static const uint32_t maxTickPhaseMs = 10000;
+
+// [static]
+BootProfile &BootProfile::instance() {
+    if (!_instance) {
+        _instance = new BootProfile();
+    }
+    return *_instance;
+}
+
+BootProfile::BootProfile() {}
+
+BootProfile::~BootProfile() {}
+
+void BootProfile::begin() {
+    _count = 0;
+    _readyMs = 0;
+    _countReadyMs = 0;
+    _published = false;
+    _lastTicks = System.ticks();
+    _lastMarkMs = millis();
+}
+
+void BootProfile::mark(const char *name) {
+    uint32_t nowTicks = System.ticks();
+    uint32_t nowMs = millis();
+
+    if (_count < MAX_PHASES) {
+        uint32_t elapsedMs = nowMs - _lastMarkMs;
+        uint32_t us;
+        if (elapsedMs > maxTickPhaseMs) {
+            us = elapsedMs * 1000UL;
+        } else {
+            us = (nowTicks - _lastTicks) / System.ticksPerMicrosecond();
+        }
+        _phases[_count].name = name;
+        _phases[_count].us = us;
+        _count++;
+    }
+
+    _lastTicks = nowTicks;
+    _lastMarkMs = nowMs;
+}
+
+void BootProfile::countReady() {
+    if (!_countReadyMs) {
+        _countReadyMs = millis();
+    }
+}
+
+void BootProfile::end() {
+    _readyMs = millis();
+
+    size_t slowest = 0;
+    for (size_t i = 1; i < _count; i++) {
+        if (_phases[i].us > _phases[slowest].us) {
+            slowest = i;
+        }
+    }
+    if (_count) {
+        Log.info("Boot profile: counting at %lu ms, ready at %lu ms, slowest phase %s (%lu us)",
+                 (unsigned long)_countReadyMs, (unsigned long)_readyMs, _phases[slowest].name,
+                 (unsigned long)_phases[slowest].us);
+    }
+    for (size_t i = 0; i < _count; i++) {
+        Log.trace("Boot phase %-8s %8lu us", _phases[i].name, (unsigned long)_phases[i].us);
+    }
+}
+
+bool BootProfile::publish() {
+    if (_published || !_readyMs) {
+        return false;
+    }
+
+    char data[256];
+    JSONBufferWriter writer(data, sizeof(data) - 1);
+    writer.beginObject();
+    writer.name("readyMs").value((unsigned long)_readyMs);
+    if (_countReadyMs) {
+        writer.name("countReadyMs").value((unsigned long)_countReadyMs);
+    }
+    writer.name("reset").value((int)System.resetReason());
+    writer.name("us").beginObject();
+    for (size_t i = 0; i < _count; i++) {
+        writer.name(_phases[i].name).value((unsigned long)_phases[i].us);
+    }
+    writer.endObject();
+    writer.endObject();
+
+    _published = true;
+    if (writer.dataSize() >= sizeof(data)) {
+        Log.warn("Boot profile too large to publish");
+        return false;
+    }
+    data[writer.dataSize()] = '\0';
+
+    PublishQueuePosix::instance().publishToLane(ProjectConfig::LANE_STATUS, "bootProfile", data, PRIVATE | WITH_ACK);
+    Log.info("Boot profile: %s", data);
+    return true;
+}
@@ -0,0 +1,113 @@
+/**
+ * @file BootProfile.h
+ * @brief Phase timing for setup(), published after the next connection.
+ *
+ * @details setup() runs on every cold boot and every HIBERNATE wake, so its
+ *          length is part of the cost of each night and each wake. Each stage
+ *          of setup() calls mark() when it finishes; the time since the
+ *          previous mark is measured with System.ticks() and kept in RAM.
+ *          After the next cloud connection the phases are sent once as a
+ *          "bootProfile" event:
+ *
+ *              {"readyMs":2140,"countReadyMs":310,"reset":70,"us":{"console":...}}
+ *
+ *          readyMs is millis() at the end of setup(), so it includes Device OS
+ *          start-up before setup() began. countReadyMs is millis() when the
+ *          sensor was initialized and counting (absent if it was not, e.g.
+ *          outside open hours); setup() brings the sensor up before the
+ *          slower stages, so this is the window a wake can miss a count in.
+ *          "us" holds each phase in microseconds, in setup() order.
+ */
+
+#ifndef __BOOTPROFILE_H
+#define __BOOTPROFILE_H
+
+#include "Particle.h"
+
+/**
+ * This class is a singleton; you do not create one as a global, on the stack, or with new.
+ *
+ * At the top of global application setup you must call:
+ * BootProfile::instance().begin();
+ *
+ * After each stage of setup() call:
+ * BootProfile::instance().mark("stage");
+ *
+ * At the end of global application setup you must call:
+ * BootProfile::instance().end();
+ */
+class BootProfile {
+public:
+    /** @brief Maximum number of phases recorded; later marks are ignored. */
+    static constexpr size_t MAX_PHASES = 12;
+
+    /** @brief One timed stage of setup(). */
+    struct Phase {
+        const char *name;    ///< String literal passed to mark()
+        uint32_t us;         ///< Duration since the previous mark
+    };
+
+    /**
+     * @brief Gets the singleton instance of this class, allocating it if necessary
+     */
+    static BootProfile &instance();
+
+    /**
+     * @brief Start timing; call first thing in setup()
+     */
+    void begin();
+
+    /**
+     * @brief Close the current phase and start the next one
+     *
+     * @param name Phase name; must be a string literal (the pointer is kept)
+     */
+    void mark(const char *name);
+
+    /**
+     * @brief Record countReadyMs; call once the sensor is counting
+     */
+    void countReady();
+
+    /**
+     * @brief Record readyMs and log the profile; call at the end of setup()
+     */
+    void end();
+
+    /**
+     * @brief Queue the "bootProfile" event once per boot; call after a connection
+     *
+     * @return true if the event was queued on this call
+     */
+    bool publish();
+
+    /** @brief Phases recorded so far. */
+    size_t phaseCount() const { return _count; }
+
+    /** @brief Phase @p index (0 .. phaseCount()-1). */
+    const Phase &phase(size_t index) const { return _phases[index]; }
+
+    /** @brief millis() at the end of setup(), or 0 if end() has not run. */
+    uint32_t readyMs() const { return _readyMs; }
+
+    /** @brief millis() when the sensor was counting, or 0 if it was not. */
+    uint32_t countReadyMs() const { return _countReadyMs; }
+
+protected:
+    BootProfile();
+    virtual ~BootProfile();
+    BootProfile(const BootProfile&) = delete;
+    BootProfile& operator=(const BootProfile&) = delete;
+
+    Phase _phases[MAX_PHASES];
+    size_t _count = 0;
+    uint32_t _lastTicks = 0;          // System.ticks() at the previous mark
+    uint32_t _lastMarkMs = 0;         // millis() at the previous mark
+    uint32_t _readyMs = 0;
+    uint32_t _countReadyMs = 0;
+    bool _published = false;
+
+    static BootProfile *_instance;
+};
+
+#endif /* __BOOTPROFILE_H */
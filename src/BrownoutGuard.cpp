@@ -0,0 +1,94 @@
+#include "BrownoutGuard.h"
+#include "Config.h"
+#include "MonoClock.h"
+#include "MyPersistentData.h"
+#include "Payload.h"
+#include <atomic>
+
+namespace BrownoutGuard {
+
+static std::atomic<bool> lowBatteryEvent(false);   // Set on the system thread
+static bool held = false;
+static bool radioOffPending = false;
+static uint64_t heldSinceMs = 0;                   // MonoClock, so naps count
+
+static void lowBatteryHandler(system_event_t event, int param) {
+    lowBatteryEvent.store(true, std::memory_order_relaxed);
+}
+
+static void checkpoint() {
+    current.checkpoint();
+    MonoClock::checkpoint();
+    sysStatus.flush(true);
+}
+
+static bool charging() {
+    uint8_t battState = current.get_batteryState();
+    return battState == BATTERY_STATE_CHARGING || battState == BATTERY_STATE_CHARGED;
+}
+
+// Cached SoC and state only; 0 SoC or an unknown state is no battery reading
+static bool batteryLow() {
+    uint8_t battState = current.get_batteryState();
+    uint16_t socTenths = current.get_socTenths();
+    return socTenths > 0 && socTenths < BROWNOUT_HOLD_SOC * 10 &&
+           battState != BATTERY_STATE_UNKNOWN && battState != BATTERY_STATE_DISCONNECTED && !charging();
+}
+
+static void startHold(const char *why) {
+    checkpoint();
+    if (held) {
+        return;
+    }
+    held = true;
+    radioOffPending = true;
+    heldSinceMs = MonoClock::nowMs();
+    Log.warn("Brownout guard: %s (SoC %s%%) - counters saved, radio held off",
+             why, Payload::Scaled(current.get_socTenths(), 1).c_str());
+}
+
+void setup() {
+#if BROWNOUT_GUARD_ENABLED
+    System.on(low_battery, lowBatteryHandler);
+#endif
+}
+
+bool loop() {
+#if BROWNOUT_GUARD_ENABLED
+    if (lowBatteryEvent.exchange(false, std::memory_order_relaxed)) {
+        startHold("low battery event");
+    } else if (!held && batteryLow()) {
+        startHold("battery low");
+    } else if (held) {
+        uint16_t socTenths = current.get_socTenths();
+        uint64_t heldMs = MonoClock::nowMs() - heldSinceMs;
+        if (charging() || socTenths >= BROWNOUT_RELEASE_SOC * 10 ||
+            heldMs >= (uint64_t)BROWNOUT_HOLD_MAX_HOURS * 3600000ULL) {
+            Log.info("Brownout guard: radio released after %lu min (SoC %s%%, %s)",
+                     (unsigned long)(heldMs / 60000), Payload::Scaled(socTenths, 1).c_str(),
+                     charging() ? "charging" : "not charging");
+            held = false;
+            radioOffPending = false;
+        }
+    }
+#endif
+    return true;
+}
+
+void beforeRadio() {
+#if BROWNOUT_GUARD_ENABLED
+    checkpoint();
+#endif
+}
+
+bool radioHeld() {
+    return held;
+}
+
+bool takeRadioOff() {
+    bool pending = radioOffPending;
+    radioOffPending = false;
+    return pending;
+}
+
+} // namespace BrownoutGuard
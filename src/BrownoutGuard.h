@@ -0,0 +1,64 @@
+/**
+ * @file BrownoutGuard.h
+ * @brief Checkpoints the counters before radio power-ups and holds the
+ *        radio off while the battery is failing.
+ *
+ * @details A modem transmit burst on a weak or cold LiPo can pull the
+ *          supply under the brownout threshold. The reset loses what the
+ *          retained-RAM counter tier (COUNTER_RETAINED) has not yet
+ *          checkpointed to current.dat. The flash write itself takes
+ *          milliseconds, far too long to start once the voltage is already
+ *          falling, so it happens ahead of the risk instead:
+ *
+ *          - beforeRadio(), called just before every radio power-up,
+ *            checkpoints current, sysStatus and MonoClock.
+ *          - A low_battery system event (the fuel gauge alert), or a
+ *            cached SoC under BROWNOUT_HOLD_SOC while not charging,
+ *            checkpoints at once and starts a hold. radioHeld() is true
+ *            until BROWNOUT_RELEASE_SOC, charging, or
+ *            BROWNOUT_HOLD_MAX_HOURS; takeRadioOff() tells IDLE to drop
+ *            a live connection once.
+ *
+ *          The SoC is the cached power snapshot, so the checks cost no
+ *          I2C. See BROWNOUT_GUARD_ENABLED in Config.h.
+ *
+ *          Application thread only, apart from the system event handler.
+ */
+
+#ifndef __BROWNOUTGUARD_H
+#define __BROWNOUTGUARD_H
+
+#include "Particle.h"
+
+namespace BrownoutGuard {
+
+/**
+ * @brief Register for the low_battery system event
+ */
+void setup();
+
+/**
+ * @brief TaskScheduler task: act on a low_battery event and start or end the hold
+ *
+ * @return true (TaskScheduler task)
+ */
+bool loop();
+
+/**
+ * @brief Checkpoint the counters to flash; call before powering the radio
+ */
+void beforeRadio();
+
+/**
+ * @brief true while radio use other than the button is held off
+ */
+bool radioHeld();
+
+/**
+ * @brief true once when a hold starts, for IDLE to disconnect
+ */
+bool takeRadioOff();
+
+} // namespace BrownoutGuard
+
+#endif /* __BROWNOUTGUARD_H */
@@ -0,0 +1,197 @@
+#include "ClockDrift.h"
+#include "Config.h"
+#include "DataUsage.h"
+#include "AB1805_RK.h"
+#include "MyPersistentData.h"
+#include "StateMachine.h"   // ab1805
+
+namespace ClockDrift {
+
+#if CLOCK_DRIFT_ENABLED
+
+static time_t lastSeenSync = 0;     // Particle.timeSyncedLast() at the last check
+static bool requested = false;      // requestSync() is waiting for its sync
+static time_t requestTime = 0;      // Time.now() and millis() just before it
+static uint32_t requestMs = 0;
+
+// A sync that arrives later than this is not the one we measured for
+static const uint32_t REQUEST_TIMEOUT_MS = 60000;
+
+// ppm x 10 for @p errorMs built up over @p intervalSec
+static int32_t ppm10(int64_t errorMs, time_t intervalSec) {
+    return (int32_t)(errorMs * 10000 / (int64_t)intervalSec);
+}
+
+static int16_t clamp16(int32_t value) {
+    return (int16_t)(value > INT16_MAX ? INT16_MAX : value < -INT16_MAX ? -INT16_MAX : value);
+}
+
+// Average a new measurement into an estimate; the step updates the uncertainty
+static void fold(int32_t measured, int16_t &drift, uint16_t &uncertainty) {
+    if (uncertainty == 0) {
+        drift = clamp16(measured);
+        uncertainty = CLOCK_DRIFT_FIRST_UNCERTAINTY_PPM * 10;
+        return;
+    }
+    int32_t step = measured - drift;
+    int32_t spread = (uncertainty + (step < 0 ? -step : step)) / 2;
+    drift = clamp16((drift + measured) / 2);
+    uncertainty = (uint16_t)(spread < CLOCK_DRIFT_MIN_UNCERTAINTY_PPM * 10 ? CLOCK_DRIFT_MIN_UNCERTAINTY_PPM * 10 :
+                             spread > UINT16_MAX ? UINT16_MAX : spread);
+}
+
+// The AB1805 against fresh cloud time, then set it from Time
+static void syncRtc(time_t now) {
+    time_t rtcSet = sysStatus.get_rtcSetTime();
+    time_t rtcNow = 0;
+    if (rtcSet > 0 && now - rtcSet >= (time_t)CLOCK_DRIFT_MIN_HOURS * 3600 && ab1805.getRtcAsTime(rtcNow)) {
+        int16_t drift = sysStatus.get_rtcDriftPpm10();
+        uint16_t uncertainty = sysStatus.get_rtcUncertaintyPpm10();
+        fold(ppm10((int64_t)(rtcNow - now) * 1000, now - rtcSet), drift, uncertainty);
+        sysStatus.set_rtcDriftPpm10(drift);
+        sysStatus.set_rtcUncertaintyPpm10(uncertainty);
+        Log.info("ClockDrift: AB1805 off by %ld s over %ld h; drift %d.%d ppm",
+                 (long)(rtcNow - now), (long)((now - rtcSet) / 3600), drift / 10, abs(drift % 10));
+    }
+    ab1805.setRtcFromTime(now);
+    sysStatus.set_rtcSetTime(now);
+}
+
+static void onSync(bool measured) {
+    time_t now = Time.now();
+    time_t lastSync = sysStatus.get_lastTimeSync();
+    time_t age = now - lastSync;
+
+    // Only an interval that ran from a sync on the device clock alone measures its drift
+    if (measured && lastSync > 0 && sysStatus.get_clockBaseTime() == lastSync &&
+        age >= (time_t)CLOCK_DRIFT_MIN_HOURS * 3600) {
+        int64_t offsetMs = (int64_t)(now - requestTime) * 1000 - (int64_t)(millis() - requestMs);
+        int64_t errorMs = -offsetMs - (int64_t)sysStatus.get_clockCorrectionSec() * 1000;
+        int16_t drift = sysStatus.get_clockDriftPpm10();
+        uint16_t uncertainty = sysStatus.get_clockUncertaintyPpm10();
+        fold(ppm10(errorMs, age), drift, uncertainty);
+        sysStatus.set_clockDriftPpm10(drift);
+        sysStatus.set_clockUncertaintyPpm10(uncertainty);
+        Log.info("ClockDrift: clock off by %ld ms over %ld h (%d s corrected); drift %d.%d +/- %u.%u ppm",
+                 (long)-offsetMs, (long)(age / 3600), sysStatus.get_clockCorrectionSec(),
+                 drift / 10, abs(drift % 10), uncertainty / 10, uncertainty % 10);
+    } else {
+        Log.info("ClockDrift: time synced (not measured)");
+    }
+
+    syncRtc(now);
+    sysStatus.set_lastTimeSync(now);
+    sysStatus.set_clockBaseTime(now);
+    sysStatus.set_clockBaseErrorMs(0);
+    sysStatus.set_clockCorrectionSec(0);
+}
+
+// Step Time to where the model says the clock should be
+static void applyCorrection() {
+    time_t base = sysStatus.get_clockBaseTime();
+    if (!Time.isValid() || base == 0 || sysStatus.get_clockUncertaintyPpm10() == 0) {
+        return;
+    }
+    time_t now = Time.now();
+    int32_t target = (int32_t)(-(int64_t)sysStatus.get_clockDriftPpm10() * (int64_t)(now - base) / 10000000);
+    int16_t applied = sysStatus.get_clockCorrectionSec();
+    if (target != applied && target >= -INT16_MAX && target <= INT16_MAX) {
+        Time.setTime(now + (target - applied));
+        sysStatus.set_clockCorrectionSec((int16_t)target);
+    }
+}
+
+#endif
+
+void loop() {
+#if CLOCK_DRIFT_ENABLED
+    // timeSyncedLast() can block while the cloud connection is coming up
+    if (Particle.connected()) {
+        time_t synced = Particle.timeSyncedLast();
+        if (synced != 0 && synced != lastSeenSync && Time.isValid()) {
+            lastSeenSync = synced;
+            onSync(requested && millis() - requestMs < REQUEST_TIMEOUT_MS);
+            requested = false;
+            return;
+        }
+    }
+    applyCorrection();
+#endif
+}
+
+bool syncDue() {
+#if CLOCK_DRIFT_ENABLED
+    time_t lastSync = sysStatus.get_lastTimeSync();
+    if (!Time.isValid() || lastSync == 0 || sysStatus.get_clockUncertaintyPpm10() == 0) {
+        return true;
+    }
+    if (Time.now() - lastSync >= (time_t)CLOCK_SYNC_MAX_DAYS * 86400) {
+        return true;
+    }
+    uint32_t errorMs = predictedErrorMs();
+    if (errorMs >= CLOCK_SYNC_MAX_ERROR_MS) {
+        return true;
+    }
+    Log.info("ClockDrift: time sync skipped (predicted error %lu ms)", (unsigned long)errorMs);
+    return false;
+#else
+    return true;
+#endif
+}
+
+void requestSync() {
+    if (!Particle.connected()) {
+        return;
+    }
+#if CLOCK_DRIFT_ENABLED
+    requestTime = Time.now();
+    requestMs = millis();
+    requested = true;
+#else
+    sysStatus.set_lastTimeSync(Time.now());
+#endif
+    Particle.syncTime();
+    DataUsage::note(DataUsage::TIME_SYNC, 4, 2);     // Request, then the time in the response
+}
+
+void restoredFromRtc() {
+#if CLOCK_DRIFT_ENABLED
+    time_t rtcSet = sysStatus.get_rtcSetTime();
+    uint16_t uncertainty = sysStatus.get_rtcUncertaintyPpm10();
+    if (!Time.isValid() || rtcSet == 0) {
+        return;
+    }
+    time_t now = Time.now();
+    time_t age = now > rtcSet ? now - rtcSet : 0;
+    int32_t correction = 0;
+    if (uncertainty != 0) {
+        correction = (int32_t)(-(int64_t)sysStatus.get_rtcDriftPpm10() * (int64_t)age / 10000000);
+        if (correction != 0) {
+            Time.setTime(now + correction);
+            Log.info("ClockDrift: corrected the AB1805 time by %ld s after %ld h", (long)correction, (long)(age / 3600));
+        }
+    }
+    // The device clock runs from here; the AB1805's error is where it starts.
+    // Without an AB1805 estimate, the next syncDue() asks for a sync
+    uint64_t baseErrorMs = uncertainty ? 1000 + (uint64_t)uncertainty * age / 10000 : UINT32_MAX;
+    sysStatus.set_clockBaseTime(Time.now());
+    sysStatus.set_clockBaseErrorMs((uint32_t)(baseErrorMs > UINT32_MAX ? UINT32_MAX : baseErrorMs));
+    sysStatus.set_clockCorrectionSec(0);
+#endif
+}
+
+uint32_t predictedErrorMs() {
+#if CLOCK_DRIFT_ENABLED
+    time_t base = sysStatus.get_clockBaseTime();
+    if (!Time.isValid() || base == 0) {
+        return UINT32_MAX;
+    }
+    uint64_t errorMs = 1000 + (uint64_t)sysStatus.get_clockBaseErrorMs() +
+                       (uint64_t)sysStatus.get_clockUncertaintyPpm10() * (uint64_t)(Time.now() - base) / 10000;
+    return (uint32_t)(errorMs > UINT32_MAX ? UINT32_MAX : errorMs);
+#else
+    return 0;
+#endif
+}
+
+} // namespace ClockDrift
@@ -0,0 +1,69 @@
+/**
+ * @file ClockDrift.h
+ * @brief Drift model for the device clock and the AB1805, so the daily
+ *        cloud time sync can be skipped while the clock is known good.
+ *
+ * @details A sync requested with requestSync() is measured: the clock is
+ *          read just before it, and the jump when the cloud time arrives
+ *          is the error built up since the last sync. Dividing by the time
+ *          between syncs gives the drift in ppm. Drift corrections already
+ *          applied are added back first, and intervals shorter than
+ *          CLOCK_DRIFT_MIN_HOURS are too coarse at 1 s and are not used.
+ *          Each new figure is averaged with the old one, and their
+ *          difference updates the uncertainty of the estimate.
+ *
+ *          Between syncs loop() steps Time by whole seconds as the model
+ *          predicts, so the clock stays right through long offline spells
+ *          too. syncDue() asks for a sync once the predicted error (the
+ *          uncertainty times the age, plus 1 s) reaches
+ *          CLOCK_SYNC_MAX_ERROR_MS, after CLOCK_SYNC_MAX_DAYS, or while
+ *          there is no estimate yet.
+ *
+ *          The AB1805 is set from Time at every sync, and its own drift is
+ *          measured the same way. When it restores Time after a HIBERNATE
+ *          or power-down, restoredFromRtc() corrects for its drift. The
+ *          device clock carries on from there, starting from the AB1805's
+ *          predicted error, but that interval measures nothing: the clock
+ *          did not run on its own oscillator since the last sync.
+ *
+ *          Syncs the model did not request, such as the one in a new cloud
+ *          session, restart the interval without a measurement. State is
+ *          kept in sysStatus.
+ */
+
+#ifndef __CLOCKDRIFT_H
+#define __CLOCKDRIFT_H
+
+#include "Particle.h"
+
+namespace ClockDrift {
+
+/**
+ * @brief From the rtc task, before ab1805.loop(): notice syncs and apply
+ *        the drift correction
+ */
+void loop();
+
+/**
+ * @brief true if the clock should be synced from the cloud now
+ */
+bool syncDue();
+
+/**
+ * @brief Measure the clock and request a cloud time sync (connected only)
+ */
+void requestSync();
+
+/**
+ * @brief setup() after the AB1805 restored Time: correct for its drift
+ */
+void restoredFromRtc();
+
+/**
+ * @brief Predicted error of Time now, in ms (0 with the model off)
+ */
+uint32_t predictedErrorMs();
+
+} // namespace ClockDrift
+
+#endif /* __CLOCKDRIFT_H */
@@ -10,6 +10,31 @@
  */
 
 #include "Cloud.h"
+#include "AppMessages.h"
+#include "AutoTune.h"
+#include "SensorManager.h"
+#include "Config.h"
+#include "ConfigSchema.h"
+#include "ConnectCache.h"
+#include "ConnectHistory.h"
+#include "DataUsage.h"
+#include "FaultInject.h"
+#include "HeapMonitor.h"
+#include "LedgerLogSink.h"
+#include "LocalOffset.h"
+#include "OccupancyStats.h"
+#include "OpenHours.h"
+#include "PersistentStore.h"
+#include "PowerGovernor.h"
+#include "PublishQueuePosixRK.h"
+#include "ReportSlot.h"
+#include "ReportTracker.h"
+#include "StackMonitor.h"
+#include "StateMachine.h"
+#include "TaskScheduler.h"
+#include "TinyClassifier.h"
+#include "UpdateWindow.h"
+#include "WakeAccuracy.h"
 
 // External firmware version string (defined in Version.cpp)
 extern const char* FIRMWARE_VERSION;
@@ -25,9 +50,11 @@ Cloud &Cloud::instance() {
 }
 
 Cloud::Cloud() : ledgersSynced(false), lastApplySuccess(true) {
-    lastPublishedStatus = "";
-    pendingStatusPublish = false;
-    pendingConfigApply = false;
+    configTask = -1;
+    configCheckRequested = false;
+    dirtyLedgers = 0;
+    dirtySinceMs = 0;
+    memset(&pendingData, 0, sizeof(pendingData));
 }
 
 Cloud::~Cloud() {
@@ -46,38 +73,133 @@ void Cloud::setup() {
     
     deviceStatusLedger = Particle.ledger("device-status");
     deviceDataLedger = Particle.ledger("device-data");
+#if LEDGER_LOG_ENABLED
+    deviceLogLedger = Particle.ledger("device-log");
+#endif
+
+    // Deferred work runs from the application loop under the loop budget;
+    // ledger callbacks only signal the config task.
+    configTask = TaskScheduler::instance().addSignaled("config",
+        []() { return Cloud::instance().serviceConfigApply(); }, 50000, 5000);
+    TaskScheduler::instance().add("ledgers",
+        []() { Cloud::instance().serviceLedgers(); return true; }, 1000, 50000, 10000);
     
     Log.info("Ledgers configured:");
     Log.info("  default-settings: Product defaults (Cloud→Device)");
     Log.info("  device-settings: Device overrides (Cloud→Device)");
     Log.info("  device-status: Current config (Device→Cloud)");
     Log.info("  device-data: Sensor readings (Device→Cloud)");
+
+#if CONFIG_APPLY_AT_BOOT
+    // Re-apply the locally cached ledgers so configuration is consistent
+    // from the first state pass; fields that already match are not written.
+    if (defaultSettingsLedger.get().isEmpty() && deviceSettingsLedger.get().isEmpty()) {
+        Log.info("No cached settings ledgers - keeping stored configuration");
+    } else {
+        Log.info("Applying cached settings ledgers");
+        mergeConfiguration(true);
+    }
+#endif
 }
 
 // Static callbacks
 void Cloud::onDefaultSettingsSync(Ledger ledger) {
     Log.info("default-settings synced from cloud");
-    // Do not merge/apply inside async callbacks; keep expensive work
-    // in the main application thread/state machine.
-    Cloud::instance().ledgersSynced = true;
-    Cloud::instance().pendingConfigApply = true;
+    DataUsage::note(DataUsage::LEDGER_SETTINGS, ledger.get().toJSON().length());
+    // Do not merge/apply inside async callbacks, or touch our state from
+    // the system thread; the application thread picks this up.
+    AppMessages::post(AppMessages::LEDGER_SYNCED);
 }
 
 void Cloud::onDeviceSettingsSync(Ledger ledger) {
     Log.info("device-settings synced from cloud");
-    // Do not merge/apply inside async callbacks; keep expensive work
-    // in the main application thread/state machine.
-    Cloud::instance().ledgersSynced = true;
-    Cloud::instance().pendingConfigApply = true;
+    DataUsage::note(DataUsage::LEDGER_SETTINGS, ledger.get().toJSON().length());
+    AppMessages::post(AppMessages::LEDGER_SYNCED);
 }
 
-void Cloud::mergeConfiguration() {
+void Cloud::noteLedgerSynced() {
+    ledgersSynced = true;
+    TaskScheduler::instance().signal(configTask);
+}
+
+// Fold a value into a running hash: its type, then its contents, walking
+// maps and arrays in place so no JSON copy of the ledger is built
+static uint32_t hashVariant(const Variant &value, uint32_t seed);
+
+static uint32_t hashMap(const VariantMap &map, uint32_t seed) {
+    for (const auto &entry : map.entries()) {
+        seed = StorageHelperRK::murmur3_32((const uint8_t *)entry.first.c_str(), entry.first.length(), seed);
+        seed = hashVariant(entry.second, seed);
+    }
+    return seed;
+}
+
+static uint32_t hashVariant(const Variant &value, uint32_t seed) {
+    uint8_t type = (uint8_t)value.type();
+    seed = StorageHelperRK::murmur3_32(&type, sizeof(type), seed);
+    if (value.isMap()) {
+        seed = hashMap(value.value<VariantMap>(), seed);
+    } else if (value.isArray()) {
+        for (const Variant &item : value.value<VariantArray>()) {
+            seed = hashVariant(item, seed);
+        }
+    } else if (value.isString()) {
+        const String &str = value.value<String>();
+        seed = StorageHelperRK::murmur3_32((const uint8_t *)str.c_str(), str.length(), seed);
+    } else if (value.isDouble()) {
+        double num = value.toDouble();
+        seed = StorageHelperRK::murmur3_32((const uint8_t *)&num, sizeof(num), seed);
+    } else if (!value.isNull()) {
+        int64_t num = value.toInt64();      // bool and the integer types
+        seed = StorageHelperRK::murmur3_32((const uint8_t *)&num, sizeof(num), seed);
+    }
+    return seed;
+}
+
+// Hash of one ledger's contents, seeded with the firmware version so that a
+// new release (which may interpret the same keys differently) applies once.
+static uint32_t ledgerContentHash(const LedgerData &data) {
+    uint32_t seed = StorageHelperRK::PersistentDataBase::HASH_SEED;
+    seed = StorageHelperRK::murmur3_32((const uint8_t *)FIRMWARE_VERSION, strlen(FIRMWARE_VERSION), seed);
+    uint32_t hash = hashMap(data.variantMap(), seed);
+    // 0 is reserved for "nothing applied yet"
+    return hash ? hash : 1;
+}
+
+// Hash of one section of the merged configuration, seeded like
+// ledgerContentHash() and with the section name
+static uint32_t sectionContentHash(const LedgerData &config, const char *section) {
+    uint32_t seed = StorageHelperRK::PersistentDataBase::HASH_SEED;
+    seed = StorageHelperRK::murmur3_32((const uint8_t *)FIRMWARE_VERSION, strlen(FIRMWARE_VERSION), seed);
+    seed = StorageHelperRK::murmur3_32((const uint8_t *)section, strlen(section), seed);
+    uint32_t hash = hashVariant(config.has(section) ? config.get(section) : Variant(), seed);
+    return hash ? hash : 1;
+}
+
+void Cloud::mergeConfiguration(bool force) {
     // Get data from both ledgers
     LedgerData defaults = defaultSettingsLedger.get();
     LedgerData device = deviceSettingsLedger.get();
+
+#if CONFIG_APPLY_HASH_SKIP
+    uint32_t hashDefaults = ledgerContentHash(defaults);
+    uint32_t hashDevice = ledgerContentHash(device);
+    if (!force &&
+        hashDefaults == sysStatus.get_configHashDefaults() &&
+        hashDevice == sysStatus.get_configHashDevice()) {
+        Log.info("Configuration unchanged since last apply (%08lx/%08lx)",
+                 (unsigned long)hashDefaults, (unsigned long)hashDevice);
+        lastApplySuccess = true;
+        // writeDeviceStatusToCloud() skips the ledger write if the status is unchanged
+        markLedgerDirty(LEDGER_STATUS);
+        return;
+    }
+#endif
     
-    // Start with defaults as base
-    mergedConfig = defaults;
+    // Start with defaults as base. Built here and dropped after the apply:
+    // the stored values are the configuration, and the hashes say what
+    // they were built from.
+    LedgerData mergedConfig = defaults;
     
     // Manually merge sensor thresholds using a simple, consistent schema.
     //
@@ -134,6 +256,21 @@ void Cloud::mergeConfiguration() {
         mergedSensor["threshold1"] = Variant(threshold1);
         mergedSensor["threshold2"] = Variant(threshold2);
 
+        // Event filter, group estimate and auto-tune keys: device value
+        // wins over default; absent in both means "leave the stored value alone".
+        static const char* const filterKeys[] = {
+            "debounceMs", "refractoryMs", "minPulseMs", "maxEventsPerSec",
+            "groupBaseMs", "groupStepMs", "autoTune", "tuneMinRefractoryMs",
+            "tuneMaxRefractoryMs", "tuneMaxDebounceMs"
+        };
+        for (const char* key : filterKeys) {
+            if (haveDeviceSensor && device.get("sensor").has(key)) {
+                mergedSensor[key] = device.get("sensor").get(key);
+            } else if (haveDefaultSensor && defaults.get("sensor").has(key)) {
+                mergedSensor[key] = defaults.get("sensor").get(key);
+            }
+        }
+
         mergedConfig.set("sensor", Variant(mergedSensor));
     }
     
@@ -142,384 +279,321 @@ void Cloud::mergeConfiguration() {
     if (device.has("power")) mergedConfig.set("power", device.get("power"));
     if (device.has("messaging")) mergedConfig.set("messaging", device.get("messaging"));
     if (device.has("modes")) mergedConfig.set("modes", device.get("modes"));
-    
-    lastApplySuccess = applyConfigurationFromLedger();
+
+    // Release the ledger copies before the apply allocates
+    defaults = LedgerData();
+    device = LedgerData();
+
+    // Only the sections whose merged contents changed are applied
+    uint32_t sectionHashes[ConfigSchema::NUM_SECTIONS];
+    uint8_t sections = 0;
+    for (size_t ii = 0; ii < ConfigSchema::NUM_SECTIONS; ii++) {
+        sectionHashes[ii] = sectionContentHash(mergedConfig, ConfigSchema::SECTIONS[ii]);
+        if (force || !CONFIG_APPLY_HASH_SKIP || sectionHashes[ii] != sysStatus.get_configSectionHash(ii)) {
+            sections |= (uint8_t)(1 << ii);
+        }
+    }
+
+    uint8_t failedSections = 0;
+    if (sections) {
+        for (size_t ii = 0; ii < ConfigSchema::NUM_SECTIONS; ii++) {
+            if (sections & (1 << ii)) {
+                Log.info("Config: applying section %s", ConfigSchema::SECTIONS[ii]);
+            }
+        }
+        uint8_t changedFlags = 0;
+        lastApplySuccess = ConfigSchema::apply(mergedConfig, changedFlags, sections, &failedSections);
+        finishApply(lastApplySuccess, changedFlags);
+    } else {
+        Log.info("Configuration sections unchanged since last apply");
+        lastApplySuccess = true;
+        markLedgerDirty(LEDGER_STATUS);
+    }
 
     if (!lastApplySuccess) {
         Log.warn("Configuration apply failed");
     }
+    // Only remember what applied cleanly; a failed section is retried next time
+    for (size_t ii = 0; ii < ConfigSchema::NUM_SECTIONS; ii++) {
+        if (sections & (1 << ii)) {
+            sysStatus.set_configSectionHash(ii, (failedSections & (1 << ii)) ? 0 : sectionHashes[ii]);
+        }
+    }
+#if CONFIG_APPLY_HASH_SKIP
+    sysStatus.set_configHashDefaults(lastApplySuccess ? hashDefaults : 0);
+    sysStatus.set_configHashDevice(lastApplySuccess ? hashDevice : 0);
+#endif
 }
 
 bool Cloud::loadConfigurationFromCloud() {
     Log.info("Syncing configuration from cloud");
     
     // Trigger merge and apply configuration. mergeConfiguration() will update
-    // lastApplySuccess based on the result of applyConfigurationFromLedger().
-    mergeConfiguration();
+    // lastApplySuccess based on the result of the apply.
+    checkConfiguration();
     return lastApplySuccess;
 }
 
-bool Cloud::applyConfigurationFromLedger() {
-    bool success = true;
-
-    success &= applySensorConfig();
-    success &= applyTimingConfig();
-    success &= applyPowerConfig();
-    success &= applyMessagingConfig();
-    success &= applyModesConfig();
-    
-    if (success) {
-        // Do not force synchronous storage flushes here; they can exceed the
-        // 100 ms loop budget. Persistence is handled by sysStatus.loop() and
-        // sensorConfig.loop() (called from the main loop).
-        sysStatus.validate(sizeof(sysStatus));
-        sensorConfig.validate(sizeof(sensorConfig));
+void Cloud::requestConfigCheck() {
+    configCheckRequested = true;
+    TaskScheduler::instance().signal(configTask);
+}
 
-        // Defer device-status publishing to Cloud::loop() so it doesn't
-        // execute inside CONNECTING_STATE or async callbacks.
-        pendingStatusPublish = true;
-    } else {
-        Log.warn("Some configuration sections failed to apply");
+// Hash of the configVersion fields of both settings ledgers (0 = neither has one)
+static uint32_t configVersionHash(const LedgerData &defaults, const LedgerData &device) {
+    if (!defaults.has("configVersion") && !device.has("configVersion")) {
+        return 0;
     }
-    
-    return success;
+    uint32_t seed = StorageHelperRK::PersistentDataBase::HASH_SEED;
+    seed = hashVariant(defaults.has("configVersion") ? defaults.get("configVersion") : Variant(), seed);
+    seed = hashVariant(device.has("configVersion") ? device.get("configVersion") : Variant(), seed);
+    return seed ? seed : 1;
 }
 
-void Cloud::loop() {
-    // Apply any newly-synced configuration outside callback context.
-    // Do at most one deferred operation per loop() pass.
-    if (pendingConfigApply && Particle.connected()) {
-        pendingConfigApply = false;
-        mergeConfiguration();
-        return;
+bool Cloud::configCheckDue() {
+#if CONFIG_CHECK_DAILY
+    if (PowerGovernor::operatingMode() != LOW_POWER || configCheckRequested) {
+        return true;
     }
-
-    // Publish device-status updates opportunistically when connected.
-    // Do at most one deferred operation per loop() pass.
-    if (pendingStatusPublish && Particle.connected()) {
-        if (writeDeviceStatusToCloud()) {
-            pendingStatusPublish = false;
-        }
+    time_t last = sysStatus.get_configCheckTime();
+    time_t now = Time.now();
+    if (last == 0 || !Time.isValid() || now < last || now - last >= 24 * 3600L) {
+        return true;
     }
-}
-
-bool Cloud::applyMessagingConfig() {
-    if (!mergedConfig.has("messaging")) return true;
-    Variant messaging = mergedConfig.get("messaging");
-    
-    if (!messaging.isMap()) return true;
-
-    bool success = true;
-    bool changed = false;
-
-    if (messaging.has("serial")) {
-        bool serialEnabled = messaging.get("serial").toBool();
-        if (sysStatus.get_serialConnected() != serialEnabled) {
-            sysStatus.set_serialConnected(serialEnabled);
-            Log.info("Config: Serial → %s", serialEnabled ? "ON" : "OFF");
-            changed = true;
+    // First connect of the local day; the UTC day until LocalOffset has a table
+    LocalOffset::Fields lastLocal, nowLocal;
+    if (LocalOffset::split(last, lastLocal) && LocalOffset::split(now, nowLocal)) {
+        if (lastLocal.day != nowLocal.day) {
+            return true;
         }
+    } else if (last / 86400 != now / 86400) {
+        return true;
     }
-
-    if (messaging.has("verboseMode")) {
-        bool verboseMode = messaging.get("verboseMode").toBool();
-        if (sysStatus.get_verboseMode() != verboseMode) {
-            sysStatus.set_verboseMode(verboseMode);
-            Log.info("Config: Verbose → %s", verboseMode ? "ON" : "OFF");
-            changed = true;
-        }
+    uint32_t token = configVersionHash(defaultSettingsLedger.get(), deviceSettingsLedger.get());
+    if (token != sysStatus.get_configVersionHash()) {
+        Log.info("Settings configVersion changed");
+        return true;
     }
-
-    if (changed) Log.info("Messaging config updated");
-    return success;
+    return false;
+#else
+    return true;
+#endif
 }
 
-bool Cloud::applyTimingConfig() {
-    if (!mergedConfig.has("timing")) return true;
-    Variant timing = mergedConfig.get("timing");
-    
-    if (!timing.isMap()) return true;
-
-    bool success = true;
-    bool changed = false;
-
-    if (timing.has("timezone")) {
-        String timezone = timing.get("timezone").toString();
-        if (timezone.length() > 0 && timezone.length() < 39) {
-            if (strcmp(sysStatus.get_timeZoneStr(), timezone.c_str()) != 0) {
-                sysStatus.set_timeZoneStr(timezone.c_str());
-                Log.info("Config: Timezone → %s", timezone.c_str());
-                changed = true;
-            }
-        } else {
-            Log.warn("Invalid timezone length: %d", timezone.length());
-            success = false;
-        }
+void Cloud::checkConfiguration() {
+    if (!configCheckDue()) {
+        Log.info("Settings checked today and configVersion unchanged - ledgers not merged");
+        return;
     }
-
-    if (timing.has("reportingIntervalSec")) {
-        int reportingInterval = timing.get("reportingIntervalSec").toInt();
-        if (validateRange(reportingInterval, 300, 86400, "timing.reportingIntervalSec")) {
-            if (sysStatus.get_reportingInterval() != reportingInterval) {
-                sysStatus.set_reportingInterval(reportingInterval);
-                Log.info("Config: Reporting interval → %ds", reportingInterval);
-                changed = true;
-            }
-        } else {
-            success = false;
-        }
+    mergeConfiguration();
+    if (lastApplySuccess) {
+        // A failed apply leaves these alone, so the next connect merges again
+        configCheckRequested = false;
+        auto update = sysStatus.updateBatch();
+        sysStatus.set_configCheckTime(Time.isValid() ? Time.now() : 0);
+        sysStatus.set_configVersionHash(configVersionHash(defaultSettingsLedger.get(), deviceSettingsLedger.get()));
     }
+}
 
-    if (timing.has("pollingRateSec")) {
-        int pollingRate = timing.get("pollingRateSec").toInt();
-        if (validateRange(pollingRate, 0, 3600, "timing.pollingRateSec")) {
-            if (sensorConfig.get_pollingRate() != pollingRate) {
-                sensorConfig.set_pollingRate(pollingRate);
-                Log.info("Config: Polling rate → %ds", pollingRate);
-                changed = true;
-            }
-        } else {
-            success = false;
+int Cloud::applyCommand(const char *command) {
+    uint8_t changedFlags = 0;
+    int result = ConfigSchema::applyCommand(command, changedFlags);
+    if (result < 0) {
+        Log.warn("Config command refused (%d): %s", result, command ? command : "");
+        return result;
+    }
+    if (changedFlags) {
+        // Set outside the ledgers: the next merge must apply them in full
+        // rather than skip them as unchanged
+        auto update = sysStatus.updateBatch();
+        sysStatus.set_configHashDefaults(0);
+        sysStatus.set_configHashDevice(0);
+        for (size_t ii = 0; ii < ConfigSchema::NUM_SECTIONS; ii++) {
+            sysStatus.set_configSectionHash(ii, 0);
         }
     }
+    finishApply(true, changedFlags);
+    return result;
+}
 
-    if (timing.has("openHour")) {
-        int openHour = timing.get("openHour").toInt();
-        if (validateRange(openHour, 0, 23, "timing.openHour")) {
-            if (sysStatus.get_openTime() != openHour) {
-                sysStatus.set_openTime(openHour);
-                Log.info("Config: Open hour → %d", openHour);
-                changed = true;
-            }
-        } else {
-            success = false;
-        }
+void Cloud::finishApply(bool success, uint8_t changedFlags) {
+    if (changedFlags & ConfigSchema::RELOAD_SCHEDULE) {
+        OpenHours::reloadTimezone();
     }
-
-    if (timing.has("closeHour")) {
-        int closeHour = timing.get("closeHour").toInt();
-        if (validateRange(closeHour, 0, 23, "timing.closeHour")) {
-            if (sysStatus.get_closeTime() != closeHour) {
-                sysStatus.set_closeTime(closeHour);
-                Log.info("Config: Close hour → %d", closeHour);
-                changed = true;
-            }
-        } else {
-            success = false;
-        }
+    if (changedFlags) {
+        Log.info("Configuration updated");
     }
 
-    if (changed) Log.info("Timing config updated");
-    return success;
-}
-
-bool Cloud::applyPowerConfig() {
-    if (!mergedConfig.has("power")) return true;
-    Variant power = mergedConfig.get("power");
-    
-    if (!power.isMap()) return true;
-
-    bool success = true;
-    bool changed = false;
+    if (success && changedFlags) {
+        // Do not force synchronous storage flushes here; they can exceed the
+        // 100 ms loop budget. Persistence is handled by sysStatus.loop() and
+        // sensorConfig.loop() (called from the main loop). ConfigSchema has
+        // range-checked every value it set; validate() is only for data as
+        // read from flash, as the hash in RAM is stale until the next save.
 
-    if (power.has("solarPowerMode")) {
-        bool solarPowerMode = power.get("solarPowerMode").toBool();
-        if (sysStatus.get_solarPowerMode() != solarPowerMode) {
-            sysStatus.set_solarPowerMode(solarPowerMode);
-            Log.info("Config: Solar power → %s", solarPowerMode ? "ON" : "OFF");
-            changed = true;
-        }
+        // Defer device-status publishing to flushLedgers() so it doesn't
+        // execute inside CONNECTING_STATE or async callbacks.
+        markLedgerDirty(LEDGER_STATUS);
+    } else if (success) {
+        markLedgerDirty(LEDGER_STATUS);     // Nothing changed; the write is skipped if the status is too
+    } else {
+        Log.warn("Some configuration sections failed to apply");
     }
-
-    if (changed) Log.info("Power config updated");
-    return success;
 }
 
-// Fix the validateRange function - add template declaration
-template<typename T>
-bool Cloud::validateRange(T value, T min, T max, const String& name) {
-    if (value < min || value > max) {
-        Log.warn("Invalid %s value: %d (must be between %d and %d)", name.c_str(), (int)value, (int)min, (int)max);
+bool Cloud::serviceConfigApply() {
+    // Apply newly-synced configuration outside callback context
+    if (!Particle.connected()) {
         return false;
     }
+    checkConfiguration();
     return true;
 }
 
-bool Cloud::applySensorConfig() {
-    if (!mergedConfig.has("sensor")) return true;
-    
-    Variant sensor = mergedConfig.get("sensor");
-    if (!sensor.isMap()) return true;
-    
-    bool success = true;
-    bool changed = false;
-    
-    // threshold1
-    if (sensor.has("threshold1")) {
-        int threshold1 = sensor.get("threshold1").toInt();
-        if (validateRange(threshold1, 0, 100, "sensor.threshold1")) {
-            if (sensorConfig.get_threshold1() != threshold1) {
-                sensorConfig.set_threshold1(threshold1);
-                Log.info("Config: Threshold1 → %d", threshold1);
-                changed = true;
-            }
-        } else {
-            success = false;
-        }
-    }
-    
-    // threshold2
-    if (sensor.has("threshold2")) {
-        int threshold2 = sensor.get("threshold2").toInt();
-        if (validateRange(threshold2, 0, 100, "sensor.threshold2")) {
-            if (sensorConfig.get_threshold2() != threshold2) {
-                sensorConfig.set_threshold2(threshold2);
-                Log.info("Config: Threshold2 → %d", threshold2);
-                changed = true;
-            }
-        } else {
-            success = false;
+void Cloud::serviceLedgers() {
+    // Write dirty ledgers. With LEDGER_COALESCE_WRITES this is normally left
+    // to SLEEPING_STATE; CONNECTED mode may stay awake for hours, so flush
+    // there once the oldest change has waited LEDGER_FLUSH_DELAY_SEC.
+    if (dirtyLedgers && Particle.connected()) {
+#if LEDGER_COALESCE_WRITES
+        bool flushDue = PowerGovernor::operatingMode() == CONNECTED &&
+                        (millis() - dirtySinceMs) >= (unsigned long)LEDGER_FLUSH_DELAY_SEC * 1000UL;
+#else
+        bool flushDue = true;
+#endif
+        if (flushDue) {
+            flushLedgers();
         }
     }
-    
-    if (changed) Log.info("Sensor config updated");
-    return success;
 }
 
-bool Cloud::applyModesConfig() {
-    if (!mergedConfig.has("modes")) return true;
-    Variant modes = mergedConfig.get("modes");
-    
-    if (!modes.isMap()) {
-        return true;
+void Cloud::markLedgerDirty(uint8_t ledgers) {
+    if (ledgers & LEDGER_DATA) {
+        captureDeviceData(pendingData);
     }
-    
-    bool success = true;
-    bool changed = false;
-
-    // Counting mode: 0=COUNTING, 1=OCCUPANCY, 2=SCHEDULED (time-based)
-    if (modes.has("countingMode")) {
-        int countingMode = modes.get("countingMode").asInt();
-        if (validateRange(countingMode, 0, 2, "countingMode")) {
-            if (sysStatus.get_countingMode() != static_cast<CountingMode>(countingMode)) {
-                sysStatus.set_countingMode(static_cast<CountingMode>(countingMode));
-                const char *modeStr = countingMode == COUNTING ? "COUNTING" :
-                                     countingMode == OCCUPANCY ? "OCCUPANCY" : "SCHEDULED";
-                Log.info("Config: Counting mode → %s", modeStr);
-                changed = true;
-            }
-        } else {
-            success = false;
-        }
+    if (!dirtyLedgers) {
+        dirtySinceMs = millis();
     }
+    dirtyLedgers |= ledgers;
+}
 
-    // Operating mode: 0=CONNECTED, 1=LOW_POWER, 2=DISCONNECTED
-    if (modes.has("operatingMode")) {
-        int operatingMode = modes.get("operatingMode").asInt();
-        if (validateRange(operatingMode, 0, 2, "operatingMode")) {
-            if (sysStatus.get_operatingMode() != static_cast<OperatingMode>(operatingMode)) {
-                sysStatus.set_operatingMode(static_cast<OperatingMode>(operatingMode));
-                const char *modeStr = operatingMode == 0 ? "CONNECTED" :
-                                     operatingMode == 1 ? "LOW_POWER" : "DISCONNECTED";
-                Log.info("Config: Operating mode → %s", modeStr);
-                changed = true;
-            }
-        } else {
-            success = false;
-        }
+bool Cloud::flushLedgers() {
+    // Store-only check-ins only send the queue; the writes wait for recovery
+    if (PowerGovernor::storeOnly()) {
+        return dirtyLedgers == 0;
     }
-
-    // Occupancy debounce time (milliseconds)
-    if (modes.has("occupancyDebounceMs")) {
-        unsigned long occupancyDebounceMs = modes.get("occupancyDebounceMs").asUInt();
-        if (validateRange(occupancyDebounceMs, 0UL, 600000UL, "occupancyDebounceMs")) {
-            if (sysStatus.get_occupancyDebounceMs() != occupancyDebounceMs) {
-                sysStatus.set_occupancyDebounceMs(occupancyDebounceMs);
-                Log.info("Config: Occupancy debounce → %lu ms", occupancyDebounceMs);
-                changed = true;
-            }
+    if (dirtyLedgers & LEDGER_DATA) {
+        if (writeDeviceData(pendingData)) {
+            dirtyLedgers &= ~LEDGER_DATA;
         } else {
-            success = false;
+            // Data ledger publish failure; escalate via alert so the error
+            // supervisor can decide on corrective action.
+            current.raiseAlert(42);
         }
     }
-
-    // Connected mode reporting interval (seconds)
-    if (modes.has("connectedReportingIntervalSec")) {
-        int connectedReportingIntervalSec = modes.get("connectedReportingIntervalSec").asInt();
-        if (validateRange(connectedReportingIntervalSec, 60, 86400, "connectedReportingIntervalSec")) {
-            if (sysStatus.get_connectedReportingIntervalSec() != connectedReportingIntervalSec) {
-                sysStatus.set_connectedReportingIntervalSec(connectedReportingIntervalSec);
-                Log.info("Config: Connected reporting interval → %ds", connectedReportingIntervalSec);
-                changed = true;
-            }
-        } else {
-            success = false;
+    if (dirtyLedgers & LEDGER_STATUS) {
+        if (writeDeviceStatusToCloud()) {
+            dirtyLedgers &= ~LEDGER_STATUS;
         }
     }
+#if LEDGER_LOG_ENABLED
+    // Never dirties a ledger itself; the lines wait for a flush that is happening anyway
+    writeDeviceLog();
+#endif
+    // Anything left is retried after another full delay, not every loop
+    dirtySinceMs = millis();
+    return dirtyLedgers == 0;
+}
 
-    // Low power mode reporting interval (seconds)
-    if (modes.has("lowPowerReportingIntervalSec")) {
-        int lowPowerReportingIntervalSec = modes.get("lowPowerReportingIntervalSec").asInt();
-        if (validateRange(lowPowerReportingIntervalSec, 300, 86400, "lowPowerReportingIntervalSec")) {
-            if (sysStatus.get_lowPowerReportingIntervalSec() != lowPowerReportingIntervalSec) {
-                sysStatus.set_lowPowerReportingIntervalSec(lowPowerReportingIntervalSec);
-                Log.info("Config: Low power reporting interval → %ds", lowPowerReportingIntervalSec);
-                changed = true;
-            }
-        } else {
-            success = false;
-        }
+#if LEDGER_LOG_ENABLED
+bool Cloud::writeDeviceLog() {
+    LedgerData data;
+    uint32_t endSeq;
+    if (!LedgerLogSink::instance().snapshot(data, endSeq)) {
+        return true;
     }
-
-    // Maximum connection-attempt budget per wake (seconds)
-    if (modes.has("connectAttemptBudgetSec")) {
-        int connectAttemptBudgetSec = modes.get("connectAttemptBudgetSec").asInt();
-        if (validateRange(connectAttemptBudgetSec, 30, 900, "connectAttemptBudgetSec")) {
-            if (sysStatus.get_connectAttemptBudgetSec() != connectAttemptBudgetSec) {
-                sysStatus.set_connectAttemptBudgetSec((uint16_t)connectAttemptBudgetSec);
-                Log.info("Config: Connect budget → %ds", connectAttemptBudgetSec);
-                changed = true;
-            }
-        } else {
-            success = false;
-        }
+    int result = deviceLogLedger.set(data);
+    if (result != SYSTEM_ERROR_NONE) {
+        Log.warn("Failed to publish device log: %d", result);
+        return false;
     }
+    LedgerLogSink::instance().consumed(endSeq);
+    DataUsage::note(DataUsage::LEDGER_STATUS, data.toJSON().length());
+    return true;
+}
+#endif
+
+// Summary of one persistent file's save instrumentation for device-status
+static void writeSaveStats(JSONBufferWriter &writer, const char *name, const StorageHelperRK::PersistentDataBase::SaveStats &stats) {
+    writer.name(name).beginObject();
+    writer.name("saves").value((unsigned long)stats.saves);
+    writer.name("failures").value((unsigned long)stats.failures);
+    writer.name("bytes").value((unsigned long)stats.bytesWritten);
+    writer.name("maxUs").value((unsigned long)stats.maxUs);
+    writer.name("avgUs").value((unsigned long)stats.avgUs());
+    writer.name("hist").beginArray();
+    for (size_t i = 0; i < StorageHelperRK::PersistentDataBase::SaveStats::NUM_BUCKETS; i++) {
+        writer.value((unsigned long)stats.histogram[i]);
+    }
+    writer.endArray();
+    writer.endObject();
+}
 
-    // Maximum time to wait for cloud disconnect before treating as an error (seconds)
-    if (modes.has("cloudDisconnectBudgetSec")) {
-        int cloudDisconnectBudgetSec = modes.get("cloudDisconnectBudgetSec").asInt();
-        if (validateRange(cloudDisconnectBudgetSec, 5, 120, "cloudDisconnectBudgetSec")) {
-            if (sysStatus.get_cloudDisconnectBudgetSec() != cloudDisconnectBudgetSec) {
-                sysStatus.set_cloudDisconnectBudgetSec((uint16_t)cloudDisconnectBudgetSec);
-                Log.info("Config: Disconnect budget → %ds", cloudDisconnectBudgetSec);
-                changed = true;
+// Loop pass times against the application watchdog, with the states and
+// housekeeping tasks that took longest in a single pass or run
+static void writeLoopStats(JSONBufferWriter &writer) {
+    static const size_t WORST_COUNT = 3;
+    TaskScheduler &tasks = TaskScheduler::instance();
+    const TaskScheduler::PassStats &pass = tasks.passStats();
+
+    const char *worstName[WORST_COUNT] = {};
+    uint32_t worstUs[WORST_COUNT] = {};
+    auto consider = [&](const char *name, uint32_t maxUs) {
+        for (size_t ii = 0; ii < WORST_COUNT; ii++) {
+            if (!worstName[ii] || maxUs > worstUs[ii]) {
+                for (size_t jj = WORST_COUNT - 1; jj > ii; jj--) {
+                    worstName[jj] = worstName[jj - 1];
+                    worstUs[jj] = worstUs[jj - 1];
+                }
+                worstName[ii] = name;
+                worstUs[ii] = maxUs;
+                return;
             }
-        } else {
-            success = false;
+        }
+    };
+    for (size_t ii = 0; ii < sizeof(stateNames) / sizeof(stateNames[0]); ii++) {
+        if (tasks.passStats(ii).passes) {
+            consider(stateName(ii), tasks.passStats(ii).maxUs);
         }
     }
-
-    // Maximum time to wait for modem power-down before treating as an error (seconds)
-    if (modes.has("modemOffBudgetSec")) {
-        int modemOffBudgetSec = modes.get("modemOffBudgetSec").asInt();
-        if (validateRange(modemOffBudgetSec, 5, 120, "modemOffBudgetSec")) {
-            if (sysStatus.get_modemOffBudgetSec() != modemOffBudgetSec) {
-                sysStatus.set_modemOffBudgetSec((uint16_t)modemOffBudgetSec);
-                Log.info("Config: Modem off budget → %ds", modemOffBudgetSec);
-                changed = true;
-            }
-        } else {
-            success = false;
+    for (size_t ii = 0; ii < tasks.taskCount(); ii++) {
+        if (tasks.taskStats(ii).runs) {
+            consider(tasks.taskName(ii), tasks.taskStats(ii).maxUs);
         }
     }
 
-    if (changed) Log.info("Modes config updated");
-    return success;
+    uint32_t maxMs = pass.maxUs / 1000;
+    writer.name("loop").beginObject();
+    writer.name("maxMs").value((unsigned long)maxMs);
+    writer.name("wdMarginMs").value((int)APP_WATCHDOG_MS - (int)maxMs);
+    writer.name("hist").beginArray();
+    for (size_t ii = 0; ii < TaskScheduler::NUM_HIST_BUCKETS; ii++) {
+        writer.value((unsigned long)pass.hist[ii]);
+    }
+    writer.endArray();
+    writer.name("worst").beginObject();
+    for (size_t ii = 0; ii < WORST_COUNT && worstName[ii]; ii++) {
+        writer.name(worstName[ii]).value((unsigned long)(worstUs[ii] / 1000));
+    }
+    writer.endObject();
+    writer.endObject();
 }
 
 bool Cloud::writeDeviceStatusToCloud() {
     // Build current configuration as JSON
-    char buffer[512];
+    // Worst case (every field at its widest, all storage stats) is about 2.1 KB;
+    // static so it is not on the stack (main thread only, not reentrant)
+    static char buffer[2304];
     JSONBufferWriter writer(buffer, sizeof(buffer));
 
     writer.beginObject();
@@ -527,57 +601,101 @@ bool Cloud::writeDeviceStatusToCloud() {
     // Firmware version
     writer.name("firmwareVersion").value(FIRMWARE_VERSION);
 
-    // Sensor
-    writer.name("sensor").beginObject();
-    writer.name("threshold1").value(sensorConfig.get_threshold1());
-    writer.name("threshold2").value(sensorConfig.get_threshold2());
-    writer.endObject();
+    // Effective configuration, one section per ledger settings section
+    ConfigSchema::writeStatus(writer);
+
+    // Publish if the configuration changed or the diagnostics below are due.
+    // The hash covers everything written so far (firmware version and
+    // configuration) and is kept in sysStatus, so an unchanged status is not
+    // re-sent after every wake. The diagnostics change all the time, so they
+    // are refreshed by time instead (each report marks device-status).
+    size_t statusLen = std::min(writer.dataSize(), sizeof(buffer));
+    uint32_t statusHash = StorageHelperRK::murmur3_32((const uint8_t *)buffer, statusLen, StorageHelperRK::PersistentDataBase::HASH_SEED);
+    if (statusHash == 0) {
+        statusHash = 1;     // 0 is reserved for "never written"
+    }
+    time_t now = Time.now();
+    time_t lastDiag = sysStatus.get_deviceStatusDiagTime();
+    bool diagDue = !Time.isValid() || lastDiag == 0 || now < lastDiag ||
+                   (now - lastDiag) >= DEVICE_STATUS_DIAG_MIN * 60L;
+    if (statusHash == sysStatus.get_deviceStatusHash() && !diagDue) {
+        Log.info("Device status unchanged and diagnostics recent; skipping device-status ledger update");
+        return true; // Not an error; nothing to do
+    }
 
-    // Timing
-    writer.name("timing").beginObject();
-    writer.name("timezone").value(sysStatus.get_timeZoneStr());
-    writer.name("reportingIntervalSec").value(sysStatus.get_reportingInterval());
-    writer.name("openHour").value(sysStatus.get_openTime());
-    writer.name("closeHour").value(sysStatus.get_closeTime());
+    // Persistence I/O since boot (save latency histogram buckets: <1, <5, <20, <100, >=100 ms)
+    writer.name("storage").beginObject();
+    writeSaveStats(writer, "sysStatus", sysStatus.getSaveStats());
+    writeSaveStats(writer, "sensorConfig", sensorConfig.getSaveStats());
+    writeSaveStats(writer, "current", current.getSaveStats());
+#if PERSISTENT_SINGLE_FILE
+    writeSaveStats(writer, "store", PersistentStore::instance().getSaveStats());
+#endif
     writer.endObject();
 
-    // Power
-    writer.name("power").beginObject();
-    writer.name("lowPowerMode").value(sysStatus.get_lowPowerMode());
-    writer.name("solarPowerMode").value(sysStatus.get_solarPowerMode());
-    writer.endObject();
+    // Connect-time histogram and the budget derived from it, and the
+    // phases of the last connect
+    ConnectHistory::writeStatus(writer);
+    ConnectCache::writeStatus(writer);
+
+    // Report sequence and webhook confirmation
+    ReportTracker::writeStatus(writer);
+
+    // Longest loop pass, margin under the application watchdog, worst offenders
+    writeLoopStats(writer);
+
+    // Free heap, largest block, low-water marks and trend
+    HeapMonitor::writeStatus(writer);
+
+    // Stack bytes each painted thread has never used
+    StackMonitor::writeStatus(writer);
 
-    // Modes
-    writer.name("modes").beginObject();
-    writer.name("countingMode").value((int)sysStatus.get_countingMode());
-    writer.name("operatingMode").value((int)sysStatus.get_operatingMode());
-    writer.name("occupancyDebounceMs").value((int)sysStatus.get_occupancyDebounceMs());
-    writer.name("connectedReportingIntervalSec").value((int)sysStatus.get_connectedReportingIntervalSec());
-    writer.name("lowPowerReportingIntervalSec").value((int)sysStatus.get_lowPowerReportingIntervalSec());
-    writer.name("connectAttemptBudgetSec").value((int)sysStatus.get_connectAttemptBudgetSec());
+    // Boundary timer wakes: how many, how many early, the learned margin
+    WakeAccuracy::writeStatus(writer);
 
+    // Events captured while a firmware update was in progress
+    UpdateWindow::writeStatus(writer);
+
+    // Event filter auto-tuning: the tuned filter times and the run towards the next step
+    AutoTune::writeStatus(writer);
+
+    // Site connect slot and how often report connects missed it
+    ReportSlot::writeStatus(writer);
+
+    // AB1805 bus traffic: register reads and writes, and watchdog pets
+    {
+        uint32_t uptimeSec = std::max((uint32_t)System.uptime(), (uint32_t)1);
+        writer.name("rtc").beginObject();
+        writer.name("i2c").value((unsigned long)ab1805.getI2CTransactions());
+        writer.name("i2cHr").value((unsigned long)((uint64_t)ab1805.getI2CTransactions() * 3600 / uptimeSec));
+        writer.name("pets").value((unsigned long)ab1805.getWatchdogPets());
+        writer.endObject();
+    }
+
+#if PUBLISH_EVENT_POOL
+    // Publish queue event blocks: peak in use and allocations that spilled to the heap
+    writer.name("eventPool").beginObject();
+    writer.name("highWater").value((unsigned)PublishQueueEventPool::instance().getHighWater());
+    writer.name("heap").value((unsigned)PublishQueueEventPool::instance().getHeapFallbacks());
     writer.endObject();
+#endif
+
     writer.endObject();
 
-    if (!writer.buffer()) {
+    if (!writer.buffer() || writer.dataSize() >= sizeof(buffer)) {
         Log.warn("Failed to create status JSON");
         return false;
     }
 
     buffer[writer.dataSize()] = '\0';
 
-    // Only publish if the configuration actually changed
-    String currentStatus = String(buffer);
-    if (lastPublishedStatus == currentStatus) {
-        Log.info("Device status unchanged; skipping device-status ledger update");
-        return true; // Not an error; nothing to do
-    }
-
     LedgerData data = LedgerData::fromJSON(buffer);
     int result = deviceStatusLedger.set(data);
 
     if (result == SYSTEM_ERROR_NONE) {
-        lastPublishedStatus = currentStatus;
+        sysStatus.set_deviceStatusHash(statusHash);
+        sysStatus.set_deviceStatusDiagTime(Time.isValid() ? now : 0);
+        DataUsage::note(DataUsage::LEDGER_STATUS, writer.dataSize());
         Log.info("Device status published to cloud");
         return true;
     } else {
@@ -586,69 +704,160 @@ bool Cloud::writeDeviceStatusToCloud() {
     }
 }
 
+// One decimal place, as the report and the former JSON writer used
+static int16_t tenths(int16_t centi) {
+    return (int16_t)((centi + (centi < 0 ? -5 : 5)) / 10);
+}
+
 bool Cloud::publishDataToLedger() {
-    Log.info("Publishing sensor data to device-data ledger");
-    
-    char buffer[512];
-    JSONBufferWriter writer(buffer, sizeof(buffer));
-    
-    writer.beginObject();
-    writer.name("timestamp").value((int)Time.now());
+    DeviceDataFields fields;
+    captureDeviceData(fields);
+    return writeDeviceData(fields);
+}
+
+void Cloud::captureDeviceData(DeviceDataFields &fields) {
+    memset(&fields, 0, sizeof(fields));     // Padding must be zero for the hash
 
     // Boot/wake diagnostics: included here so it is visible in Console even
     // when early USB logs are missed after HIBERNATE/cold boot.
-    writer.name("resetReason").value((int)System.resetReason());
-    writer.name("resetReasonData").value((unsigned long)System.resetReasonData());
-
-    uint8_t countingMode = sysStatus.get_countingMode();
-
-    if (countingMode == COUNTING) {
-        writer.name("mode").value("counting");
-        writer.name("hourlyCount").value(current.get_hourlyCount());
-        writer.name("dailyCount").value(current.get_dailyCount());
-    } else if (countingMode == OCCUPANCY) {
-        writer.name("mode").value("occupancy");
-        writer.name("occupied").value(current.get_occupied());
-        writer.name("totalOccupiedSec").value(current.get_totalOccupiedSeconds());
-    } else { // SCHEDULED or any future modes
-        writer.name("mode").value("scheduled");
+    fields.resetReason = (int32_t)System.resetReason();
+    fields.resetReasonData = (uint32_t)System.resetReasonData();
+
+    fields.countingMode = sysStatus.get_countingMode();
+    if (fields.countingMode == OCCUPANCY) {
+        fields.occupied = current.get_occupied();
+        fields.totalOccupiedSec = current.get_totalOccupiedSeconds();
+        fields.sessionCount = current.get_sessionCount();
+        for (size_t ii = 0; ii < OccupancyStats::NUM_BUCKETS; ii++) {
+            fields.sessionHist[ii] = current.get_sessionHist(ii);
+        }
+        fields.sessionMinSec = current.get_sessionMinSec();
+        fields.sessionMaxSec = current.get_sessionMaxSec();
+        fields.peakHourStart = (uint32_t)OccupancyStats::peakHourStart();
+        fields.peakHourSec = OccupancyStats::peakHourSec();
+    } else {
         // In scheduled mode we still track counts; include them so
         // device-data mirrors the webhook payload for analytics.
-        writer.name("hourlyCount").value(current.get_hourlyCount());
-        writer.name("dailyCount").value(current.get_dailyCount());
+        fields.hourlyCount = current.get_hourlyCount();
+        fields.dailyCount = current.get_dailyCount();
+    }
+    fields.battery10 = (int16_t)current.get_socTenths();
+    fields.temp10 = tenths(current.get_internalTempCenti());
+
+    // Wake-to-count latency for PIR-triggered naps (since boot)
+    const SensorManager::WakeLatencyStats &wake = SensorManager::instance().wakeLatency();
+    if (wake.samples > 0) {
+        fields.wakeSamples = wake.samples;
+        fields.wakeLatencyMaxMs = wake.maxMs;
+        fields.wakeLatencyLastMs = wake.lastMs;
+        fields.wakeInjected = wake.injected;
+    }
+#if FUSION_RANGE_CM > 0
+    const SensorManager::FusionStats &fusion = SensorManager::instance().fusionStats();
+    fields.fusionConfirmed = fusion.confirmed;
+    fields.fusionRejected = fusion.rejected;
+#endif
+#if CLASSIFIER_ENABLED
+    const TinyClassifier::Stats &classifier = TinyClassifier::stats();
+    fields.classifierRuns = classifier.runs;
+    fields.classifierNoise = classifier.labels[TinyClassifier::NOISE];
+    fields.classifierMaxUs = classifier.maxUs;
+    fields.classifierUah = (uint32_t)TinyClassifier::chargeUah();
+#endif
+}
+
+bool Cloud::writeDeviceData(const DeviceDataFields &fields) {
+    // Skip the ledger sync when no reported field changed; "timestamp" is
+    // then the time of the last change. The hash is kept in sysStatus so
+    // this holds across sleep and reset.
+    uint32_t dataHash = StorageHelperRK::murmur3_32((const uint8_t *)&fields, sizeof(fields), StorageHelperRK::PersistentDataBase::HASH_SEED);
+    if (dataHash == 0) {
+        dataHash = 1;       // 0 is reserved for "never written"
     }
-    
-    writer.name("battery").value(current.get_stateOfCharge(), 1);
-    writer.name("temp").value(current.get_internalTempC(), 1);
-    writer.endObject();
-    
-    if (!writer.buffer()) {
-        Log.warn("Failed to create data JSON");
-        return false;
+    if (dataHash == sysStatus.get_deviceDataHash()) {
+        Log.info("Sensor data unchanged; skipping device-data ledger update");
+        return true;
     }
-    
-    buffer[writer.dataSize()] = '\0';
-    
-    LedgerData data = LedgerData::fromJSON(buffer);
+
+    Log.info("Publishing sensor data to device-data ledger");
+
+    LedgerData data;
+    data.set("timestamp", Variant((int)Time.now()));
+    data.set("resetReason", Variant((int)fields.resetReason));
+    data.set("resetReasonData", Variant((unsigned long)fields.resetReasonData));
+
+    if (fields.countingMode == COUNTING) {
+        data.set("mode", Variant("counting"));
+    } else if (fields.countingMode == OCCUPANCY) {
+        data.set("mode", Variant("occupancy"));
+    } else { // SCHEDULED or any future modes
+        data.set("mode", Variant("scheduled"));
+    }
+    if (fields.countingMode == OCCUPANCY) {
+        data.set("occupied", Variant(fields.occupied != 0));
+        data.set("totalOccupiedSec", Variant((unsigned long)fields.totalOccupiedSec));
+        if (fields.sessionCount > 0) {
+            VariantMap sessions;
+            sessions["n"] = Variant((int)fields.sessionCount);
+            sessions["minSec"] = Variant((unsigned long)fields.sessionMinSec);
+            sessions["maxSec"] = Variant((unsigned long)fields.sessionMaxSec);
+            sessions["meanSec"] = Variant((unsigned long)(fields.totalOccupiedSec / fields.sessionCount));
+            VariantArray hist;
+            for (size_t ii = 0; ii < OccupancyStats::NUM_BUCKETS; ii++) {
+                hist.append(Variant((int)fields.sessionHist[ii]));
+            }
+            sessions["hist"] = Variant(hist);
+            sessions["peakHour"] = Variant((unsigned long)fields.peakHourStart);
+            sessions["peakSec"] = Variant((unsigned long)fields.peakHourSec);
+            data.set("sessions", Variant(sessions));
+        }
+    } else {
+        data.set("hourlyCount", Variant((unsigned long)fields.hourlyCount));
+        data.set("dailyCount", Variant((unsigned long)fields.dailyCount));
+    }
+
+    data.set("battery", Variant(fields.battery10 / 10.0));
+    data.set("temp", Variant(fields.temp10 / 10.0));
+
+    if (fields.wakeSamples > 0) {
+        data.set("wakeLatencyMaxMs", Variant((unsigned long)fields.wakeLatencyMaxMs));
+        data.set("wakeLatencyLastMs", Variant((unsigned long)fields.wakeLatencyLastMs));
+        data.set("wakeInjected", Variant((unsigned long)fields.wakeInjected));
+    }
+    if (fields.fusionConfirmed > 0 || fields.fusionRejected > 0) {
+        data.set("fusionConfirmed", Variant((unsigned long)fields.fusionConfirmed));
+        data.set("fusionRejected", Variant((unsigned long)fields.fusionRejected));
+    }
+    if (fields.classifierRuns > 0) {
+        data.set("classifierRuns", Variant((unsigned long)fields.classifierRuns));
+        data.set("classifierNoise", Variant((unsigned long)fields.classifierNoise));
+        data.set("classifierMaxUs", Variant((unsigned long)fields.classifierMaxUs));
+        data.set("classifierUah", Variant((unsigned long)fields.classifierUah));
+    }
+
+#if FAULT_INJECT_ENABLED
+    int result = FaultInject::setLedger(deviceDataLedger, data);
+#else
     int result = deviceDataLedger.set(data);
+#endif
     
     if (result == SYSTEM_ERROR_NONE) {
+        sysStatus.set_deviceDataHash(dataHash);
+        DataUsage::note(DataUsage::LEDGER_DATA, data.toJSON().length());
+
         // Log the key counters and any active alert code so we
         // can correlate what was actually written to device-data.
-        int mode = sysStatus.get_countingMode();
-        if (mode == COUNTING || mode == SCHEDULED) {
-            Log.info("Sensor data published to cloud - mode=%s hourly=%d daily=%d alert=%d",
-                     (mode == COUNTING ? "counting" : "scheduled"),
-                     (int)current.get_hourlyCount(),
-                     (int)current.get_dailyCount(),
-                     (int)current.get_alertCode());
-        } else if (mode == OCCUPANCY) {
+        if (fields.countingMode == OCCUPANCY) {
             Log.info("Sensor data published to cloud - mode=occupancy occupied=%d totalSec=%lu alert=%d",
-                     (int)current.get_occupied(),
-                     (unsigned long)current.get_totalOccupiedSeconds(),
+                     (int)fields.occupied,
+                     (unsigned long)fields.totalOccupiedSec,
                      (int)current.get_alertCode());
         } else {
-            Log.info("Sensor data published to cloud - mode=unknown alert=%d", (int)current.get_alertCode());
+            Log.info("Sensor data published to cloud - mode=%d hourly=%lu daily=%lu alert=%d",
+                     (int)fields.countingMode,
+                     (unsigned long)fields.hourlyCount,
+                     (unsigned long)fields.dailyCount,
+                     (int)current.get_alertCode());
         }
         return true;
     } else {
@@ -658,14 +867,5 @@ bool Cloud::publishDataToLedger() {
 }
 
 bool Cloud::hasNonDefaultConfig() {
-    // Check if any current values differ from hardcoded product defaults
-    // This is a simplified check - expand as needed
-    return (sensorConfig.get_threshold1() != 60 || 
-            sensorConfig.get_threshold2() != 60 ||
-            sysStatus.get_openTime() != 6 ||
-            sysStatus.get_closeTime() != 22);
+    return ConfigSchema::hasNonDefault();
 }
-
-// Explicit template instantiations for validateRange
-template bool Cloud::validateRange<int>(int value, int min, int max, const String& name);
-template bool Cloud::validateRange<unsigned long>(unsigned long value, unsigned long min, unsigned long max, const String& name);
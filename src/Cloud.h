@@ -91,46 +91,97 @@ public:
     bool publishDataToLedger();
 
     /**
-     * @brief Service deferred cloud work; call from main loop.
+     * @brief Device-written ledgers, for markLedgerDirty()
+     */
+    enum : uint8_t {
+        LEDGER_DATA = 0x01,     ///< device-data
+        LEDGER_STATUS = 0x02    ///< device-status
+    };
+
+    /**
+     * @brief Note that device-written ledgers need updating
+     *
+     * LEDGER_DATA takes a snapshot of the reported values now, so a later
+     * flush writes what was true at the time of the report. Nothing is sent
+     * until flushLedgers() (LEDGER_COALESCE_WRITES).
+     */
+    void markLedgerDirty(uint8_t ledgers);
+
+    /**
+     * @brief A settings ledger synced; schedule the merge and apply
      *
-     * Used to keep any ledger/status publishing out of callback context
-     * and to avoid stacking multiple expensive operations in a single
-     * loop() iteration.
+     * Application thread only: the sync callbacks post an
+     * AppMessages::LEDGER_SYNCED that ends up here.
      */
-    void loop();
+    void noteLedgerSynced();
+
+    /**
+     * @brief Apply a "key=value;..." command from the "config" function
+     *
+     * All settings or none, range-checked as the ledger path checks them
+     * (see ConfigSchema::applyCommand()), then reported the same way. The
+     * settings ledgers are not written; the applied-ledger hashes are
+     * cleared instead, so the next merge applies the ledgers in full and
+     * their values override the command. Application thread only.
+     *
+     * @return Number of settings applied, or a negative ConfigSchema::COMMAND_ result
+     */
+    int applyCommand(const char *command);
+
+    /**
+     * @brief Merge the settings ledgers at the next chance, even if they
+     *        were checked today (CONFIG_CHECK_DAILY)
+     *
+     * The "config" function's "check" command. Application thread only.
+     */
+    void requestConfigCheck();
+
+    /**
+     * @brief Write all dirty ledgers in one pass
+     *
+     * Call before the radio goes off. Raises alert 42 if the device-data
+     * write fails; a failed ledger stays dirty for the next flush. New
+     * device-log lines (LEDGER_LOG_ENABLED) go out in the same pass.
+     *
+     * @return true if nothing is left dirty
+     */
+    bool flushLedgers();
+
 
 private:
     /**
-     * @brief Apply configuration from DeviceInfoLedger to persistent storage
-     * 
-     * Reads merged configuration (product defaults + device overrides) from
-     * DeviceConfigLedger and applies to sysStatus and sensorConfig.
-     * 
-     * @return true if successful
+     * @brief Follow-up of an apply: timezone and schedule reload and the
+     *        device-status ledger
      */
-    bool applyConfigurationFromLedger();
+    void finishApply(bool success, uint8_t changedFlags);
 
     /**
-     * @brief Apply sensor configuration section
-     * 
-     * @return true if successful
+     * @brief "config" task: merge and apply after a ledger sync, once connected
+     *
+     * @return true when done; false keeps the task signaled
      */
-    bool applySensorConfig();
+    bool serviceConfigApply();
 
     /**
-     * @brief Apply timing configuration section
-     * 
-     * @return true if successful
+     * @brief true if the settings ledgers should be merged now
+     *
+     * Always outside LOW_POWER mode. In it (CONFIG_CHECK_DAILY), only on the
+     * first check of the local day, after requestConfigCheck(), or when
+     * either ledger's configVersion field changed.
      */
-    bool applyTimingConfig();
+    bool configCheckDue();
 
     /**
-     * @brief Apply power configuration section
-     * 
-     * @return true if successful
+     * @brief mergeConfiguration() if configCheckDue(), noting the check
+     *        in sysStatus once it applies
      */
-    bool applyPowerConfig();
-    
+    void checkConfiguration();
+
+    /**
+     * @brief "ledgers" task: flush dirty ledgers when due (CONNECTED mode)
+     */
+    void serviceLedgers();
+
     /**
      * @brief Callback when default-settings ledger syncs
      */
@@ -142,35 +193,72 @@ private:
     static void onDeviceSettingsSync(Ledger ledger);
     
     /**
-     * @brief Merge default and device settings into mergedConfig
+     * @brief Merge default and device settings and apply the result
+     *
+     * The ledger copies and the merged tree are only held during the call;
+     * the hashes in sysStatus are all that is kept. Each section of the
+     * merged tree is hashed, and only the sections whose hash differs from
+     * the one last applied are applied, so a sync that changed
+     * messaging.verboseMode touches no other setting, reload or save.
+     *
+     * @param force Apply every section, even if the ledgers and sections
+     *              match the last applied hashes
      */
-    void mergeConfiguration();
+    void mergeConfiguration(bool force = false);
 
     /**
-     * @brief Apply messaging configuration section
-     * 
-     * @return true if successful
+     * @brief Values written to device-data, other than the timestamp
+     *
+     * Hashed for change detection and then turned into LedgerData, so the
+     * two cannot disagree about which fields are reported.
      */
-    bool applyMessagingConfig();
+    struct DeviceDataFields {
+        int32_t resetReason;
+        uint32_t resetReasonData;
+        uint8_t countingMode;
+        uint8_t occupied;
+        uint32_t hourlyCount;
+        uint32_t dailyCount;
+        int16_t battery10;              ///< State of charge x 10
+        int16_t temp10;                 ///< Internal temperature C x 10
+        uint32_t totalOccupiedSec;
+        uint32_t wakeSamples;
+        uint32_t wakeLatencyMaxMs;
+        uint32_t wakeLatencyLastMs;
+        uint32_t wakeInjected;
+        uint32_t fusionConfirmed;       ///< FUSION_RANGE_CM events kept / dropped since boot
+        uint32_t fusionRejected;
+        uint32_t classifierRuns;        ///< CLASSIFIER_ENABLED inferences since boot
+        uint32_t classifierNoise;       ///< Of those, events dropped as noise
+        uint32_t classifierMaxUs;       ///< Slowest inference
+        uint32_t classifierUah;         ///< Charge of all inferences, uAh (estimate)
+        uint16_t sessionCount;          ///< Occupancy sessions closed today
+        uint16_t sessionHist[6];        ///< By length, OccupancyStats buckets
+        uint32_t sessionMinSec;
+        uint32_t sessionMaxSec;
+        uint32_t peakHourStart;         ///< UTC hour with the most occupied seconds (0 = none)
+        uint32_t peakHourSec;
+    };
 
     /**
-     * @brief Apply modes configuration section
-     * 
-     * @return true if successful
+     * @brief Fill fields from the current counters and diagnostics
      */
-    bool applyModesConfig();
+    void captureDeviceData(DeviceDataFields &fields);
 
     /**
-     * @brief Validate configuration value is within acceptable range
-     * 
-     * @param value Value to validate
-     * @param min Minimum acceptable value
-     * @param max Maximum acceptable value
-     * @param name Parameter name for logging
-     * @return true if valid
+     * @brief Write fields to device-data unless they match the last write
+     *
+     * @return true if written or unchanged
+     */
+    bool writeDeviceData(const DeviceDataFields &fields);
+
+    /**
+     * @brief Write new LedgerLogSink lines to device-log; counted as device-status
+     *        data usage
+     *
+     * @return true if written or there was nothing new
      */
-    template<typename T>
-    bool validateRange(T value, T min, T max, const String& name);
+    bool writeDeviceLog();
 
     /**
      * @brief Check if device configuration differs from product defaults
@@ -198,11 +286,11 @@ private:
      * @brief Ledger for sensor data reporting (Device → Cloud)
      */
     Ledger deviceDataLedger;
-    
+
     /**
-     * @brief Merged configuration data (defaults + device overrides)
+     * @brief Ledger for warning and error log lines (Device → Cloud)
      */
-    LedgerData mergedConfig;
+    Ledger deviceLogLedger;
     
     /**
      * @brief Flag indicating if ledgers have synced from cloud
@@ -210,21 +298,19 @@ private:
     bool ledgersSynced;
     
     /**
-     * @brief Store last published device status to detect changes
-     */
-    String lastPublishedStatus;
-
-    /**
-     * @brief Tracks success of last applyConfigurationFromLedger() call
+     * @brief Tracks success of the last configuration apply
      * 
      * Used by loadConfigurationFromCloud() to report whether configuration
      * was successfully applied during the most recent merge.
      */
     bool lastApplySuccess;
 
-    // Deferred work flags
-    bool pendingStatusPublish;
-    bool pendingConfigApply;
+    int configTask;                     ///< TaskScheduler id of the "config" task, signaled by onSync
+    bool configCheckRequested;          ///< requestConfigCheck() since the last merge
+
+    uint8_t dirtyLedgers;               ///< LEDGER_* bits waiting for flushLedgers()
+    unsigned long dirtySinceMs;         ///< millis() when the oldest dirty bit was set
+    DeviceDataFields pendingData;       ///< Snapshot taken by markLedgerDirty(LEDGER_DATA)
 
 protected:
     /**
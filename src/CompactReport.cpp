@@ -0,0 +1,104 @@
+#include "CompactReport.h"
+
+namespace {
+
+const char BASE64_CHARS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+void put16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+void put32(uint8_t *p, uint32_t v) {
+    put16(p, (uint16_t)v);
+    put16(p + 2, (uint16_t)(v >> 16));
+}
+
+} // namespace
+
+size_t CompactReport::encode(const Fields &fields, char *out, size_t outSize) {
+    uint8_t rec[RECORD_SIZE_BINS];
+    rec[0] = fields.bins ? VERSION_BINS : VERSION;
+    rec[1] = fields.batteryState;
+    put16(&rec[2], (uint16_t)(fields.hourly > 0xffff ? 0xffff : fields.hourly));
+    put16(&rec[4], (uint16_t)(fields.daily > 0xffff ? 0xffff : fields.daily));
+    put16(&rec[6], (uint16_t)(fields.socTenths > 1000 ? 10000 : fields.socTenths * 10));
+    put16(&rec[8], (uint16_t)fields.tempCenti);
+    rec[10] = (uint8_t)(fields.resets > 255 ? 255 : fields.resets);
+    rec[11] = (uint8_t)fields.alertCode;
+    put16(&rec[12], (uint16_t)(fields.connectSec > 0xffff ? 0xffff : fields.connectSec));
+    put32(&rec[14], fields.timestamp);
+    if (fields.bins) {
+        memcpy(&rec[RECORD_SIZE], fields.bins, NUM_BINS);
+    }
+    return base64(rec, fields.bins ? RECORD_SIZE_BINS : RECORD_SIZE, out, outSize);
+}
+
+size_t CompactReport::encodeSensors(const SensorFields *sensors, size_t count, char *out, size_t outSize) {
+    uint8_t rec[8 * SENSOR_RECORD_SIZE];
+    if (count > sizeof(rec) / SENSOR_RECORD_SIZE) {
+        return 0;
+    }
+    for (size_t ii = 0; ii < count; ii++) {
+        const SensorFields &s = sensors[ii];
+        uint8_t *p = &rec[ii * SENSOR_RECORD_SIZE];
+        uint32_t minutes = s.occupiedSec / 60;
+        p[0] = s.slot;
+        p[1] = s.health;
+        put16(&p[2], (uint16_t)(s.hourly > 0xffff ? 0xffff : s.hourly));
+        put16(&p[4], (uint16_t)(s.daily > 0xffff ? 0xffff : s.daily));
+        put16(&p[6], (uint16_t)(minutes > 0xffff ? 0xffff : minutes));
+    }
+    return base64(rec, count * SENSOR_RECORD_SIZE, out, outSize);
+}
+
+size_t CompactReport::encodeAlerts(uint64_t active, const AlertFields *alerts, size_t count, char *out, size_t outSize) {
+    uint8_t rec[ALERT_BITMAP_SIZE + 8 * ALERT_RECORD_SIZE];
+    if (count > (sizeof(rec) - ALERT_BITMAP_SIZE) / ALERT_RECORD_SIZE) {
+        return 0;
+    }
+    put32(&rec[0], (uint32_t)active);
+    put32(&rec[4], (uint32_t)(active >> 32));
+    for (size_t ii = 0; ii < count; ii++) {
+        const AlertFields &a = alerts[ii];
+        uint8_t *p = &rec[ALERT_BITMAP_SIZE + ii * ALERT_RECORD_SIZE];
+        p[0] = a.code;
+        p[1] = a.count;
+        put32(&p[2], a.firstSeen);
+        put32(&p[6], a.lastSeen);
+    }
+    return base64(rec, ALERT_BITMAP_SIZE + count * ALERT_RECORD_SIZE, out, outSize);
+}
+
+size_t CompactReport::encodeDirections(const DirectionFields &dirs, char *out, size_t outSize) {
+    uint8_t rec[DIRECTION_RECORD_SIZE];
+    put16(&rec[0], (uint16_t)(dirs.hourlyIn > 0xffff ? 0xffff : dirs.hourlyIn));
+    put16(&rec[2], (uint16_t)(dirs.hourlyOut > 0xffff ? 0xffff : dirs.hourlyOut));
+    put16(&rec[4], (uint16_t)(dirs.dailyIn > 0xffff ? 0xffff : dirs.dailyIn));
+    put16(&rec[6], (uint16_t)(dirs.dailyOut > 0xffff ? 0xffff : dirs.dailyOut));
+    return base64(rec, sizeof(rec), out, outSize);
+}
+
+size_t CompactReport::base64(const uint8_t *data, size_t dataLen, char *out, size_t outSize) {
+    if (outSize < textSize(dataLen)) {
+        return 0;
+    }
+
+    size_t len = 0;
+    for (size_t ii = 0; ii < dataLen; ii += 3) {
+        uint32_t chunk = (uint32_t)data[ii] << 16;
+        size_t remaining = dataLen - ii;
+        if (remaining > 1) {
+            chunk |= (uint32_t)data[ii + 1] << 8;
+        }
+        if (remaining > 2) {
+            chunk |= data[ii + 2];
+        }
+        out[len++] = BASE64_CHARS[(chunk >> 18) & 0x3f];
+        out[len++] = BASE64_CHARS[(chunk >> 12) & 0x3f];
+        out[len++] = (remaining > 1) ? BASE64_CHARS[(chunk >> 6) & 0x3f] : '=';
+        out[len++] = (remaining > 2) ? BASE64_CHARS[chunk & 0x3f] : '=';
+    }
+    out[len] = 0;
+    return len;
+}
@@ -0,0 +1,188 @@
+/**
+ * @file CompactReport.h
+ * @brief Fixed binary encoding of the hourly webhook report.
+ *
+ * @details The JSON report is about 200 bytes. The same fields packed into
+ *          an 18-byte little-endian record and base64-encoded are 24
+ *          characters, which is what a cellular device pays for on every
+ *          hourly publish. The record is versioned by its first byte; a
+ *          cloud-side decoder (docs/webhooks/README.md) turns it back into
+ *          the JSON fields Ubidots expects.
+ *
+ *          Version 1 layout (offsets in bytes):
+ *
+ *              0  u8   version (1)
+ *              1  u8   batteryState index (0-6, see publishData())
+ *              2  u16  hourly count (saturates)
+ *              4  u16  daily count (saturates; the JSON report has all 32 bits)
+ *              6  u16  state of charge x 100 (0-10000)
+ *              8  i16  internal temperature C x 100
+ *             10  u8   reset count (saturates at 255)
+ *             11  i8   alert code
+ *             12  u16  last connection duration, seconds (saturates)
+ *             14  u32  timestamp, Unix seconds (last second of the hour)
+ *
+ *          Version 2 is version 1 followed by the intra-hour count bins
+ *          (COUNT_BINS_ENABLED):
+ *
+ *             18  u8[12] events in each 5-minute slot, 00-05 first
+ *
+ *          A device with more than one sensor adds a sensor list: one
+ *          8-byte record per sensor slot, base64-encoded on its own
+ *          (encodeSensors()):
+ *
+ *              0  u8   slot (0 = primary sensor)
+ *              1  u8   health (SensorManager::SensorHealth)
+ *              2  u16  hourly count (saturates)
+ *              4  u16  daily count (saturates)
+ *              6  u16  occupied minutes today (saturates)
+ *
+ *          While any alert is active, an alert list: the 64-bit
+ *          active-alert bitmap (bit n = alert code n) followed by one
+ *          10-byte record per alert with kept times, base64-encoded on its
+ *          own (encodeAlerts()):
+ *
+ *              0  u32  bitmap, codes 0-31
+ *              4  u32  bitmap, codes 32-63
+ *
+ *          and per record:
+ *
+ *              0  u8   alert code
+ *              1  u8   times raised since it became active (saturates)
+ *              2  u32  first raised, Unix seconds
+ *              6  u32  last raised, Unix seconds
+ *
+ *          A directional sensor (DUAL_PIR) adds its in and out counts, one
+ *          8-byte record base64-encoded on its own (encodeDirections()):
+ *
+ *              0  u16  crossings in this hour (saturates)
+ *              2  u16  crossings out this hour (saturates)
+ *              4  u16  crossings in today (saturates)
+ *              6  u16  crossings out today (saturates)
+ */
+
+#ifndef __COMPACTREPORT_H
+#define __COMPACTREPORT_H
+
+#include "Particle.h"
+
+namespace CompactReport {
+
+/** @brief Record version written by encode() without bins. */
+static constexpr uint8_t VERSION = 1;
+
+/** @brief Record version written by encode() with bins. */
+static constexpr uint8_t VERSION_BINS = 2;
+
+/** @brief Number of intra-hour count bins. */
+static constexpr size_t NUM_BINS = 12;
+
+/** @brief Size of the version 1 record. */
+static constexpr size_t RECORD_SIZE = 18;
+
+/** @brief Size of the version 2 record. */
+static constexpr size_t RECORD_SIZE_BINS = RECORD_SIZE + NUM_BINS;
+
+/** @brief Size of the base64 text for @p bytes, including the terminator. */
+static constexpr size_t textSize(size_t bytes) {
+    return ((bytes + 2) / 3) * 4 + 1;
+}
+
+/** @brief Size of the base64 text for one record of either version, including the terminator. */
+static constexpr size_t TEXT_SIZE = textSize(RECORD_SIZE_BINS);
+
+/** @brief Report fields, in the units publishData() already has. */
+struct Fields {
+    uint32_t hourly;
+    uint32_t daily;
+    uint16_t socTenths;       ///< Tenths of a percent
+    uint8_t batteryState;     ///< System.batteryState(); see SensorManager::batteryStateName()
+    int16_t tempCenti;        ///< Hundredths of a degree C
+    uint16_t resets;
+    int8_t alertCode;
+    uint32_t connectSec;
+    uint32_t timestamp;       ///< Unix seconds
+    const uint8_t *bins;      ///< NUM_BINS intra-hour counts, or nullptr for a version 1 record
+};
+
+/** @brief Size of one sensor slot record. */
+static constexpr size_t SENSOR_RECORD_SIZE = 8;
+
+/** @brief One sensor slot, for encodeSensors(). */
+struct SensorFields {
+    uint8_t slot;
+    uint8_t health;
+    uint32_t hourly;
+    uint32_t daily;
+    uint32_t occupiedSec;
+};
+
+/** @brief Size of the alert bitmap ahead of the alert records. */
+static constexpr size_t ALERT_BITMAP_SIZE = 8;
+
+/** @brief Size of one alert record. */
+static constexpr size_t ALERT_RECORD_SIZE = 10;
+
+/** @brief One active alert, for encodeAlerts(). */
+struct AlertFields {
+    uint8_t code;
+    uint8_t count;
+    uint32_t firstSeen;
+    uint32_t lastSeen;
+};
+
+/** @brief Size of the direction record. */
+static constexpr size_t DIRECTION_RECORD_SIZE = 8;
+
+/** @brief In and out counts, for encodeDirections(). */
+struct DirectionFields {
+    uint32_t hourlyIn;
+    uint32_t hourlyOut;
+    uint32_t dailyIn;
+    uint32_t dailyOut;
+};
+
+/**
+ * @brief Pack fields into a version 1 record (version 2 with bins) and base64-encode it
+ *
+ * @param out Receives the null-terminated text; at least TEXT_SIZE bytes
+ * @return Length of the text, or 0 if out is too small
+ */
+size_t encode(const Fields &fields, char *out, size_t outSize);
+
+/**
+ * @brief Pack @p count sensor slots and base64-encode them
+ *
+ * @param out Receives the null-terminated text; at least textSize(count * SENSOR_RECORD_SIZE) bytes
+ * @return Length of the text, or 0 if out is too small
+ */
+size_t encodeSensors(const SensorFields *sensors, size_t count, char *out, size_t outSize);
+
+/**
+ * @brief Pack the active-alert bitmap and @p count alert records and base64-encode them
+ *
+ * @param out Receives the null-terminated text; at least
+ *            textSize(ALERT_BITMAP_SIZE + count * ALERT_RECORD_SIZE) bytes
+ * @return Length of the text, or 0 if out is too small
+ */
+size_t encodeAlerts(uint64_t active, const AlertFields *alerts, size_t count, char *out, size_t outSize);
+
+/**
+ * @brief Pack the in and out counts and base64-encode them
+ *
+ * @param out Receives the null-terminated text; at least textSize(DIRECTION_RECORD_SIZE) bytes
+ * @return Length of the text, or 0 if out is too small
+ */
+size_t encodeDirections(const DirectionFields &dirs, char *out, size_t outSize);
+
+/**
+ * @brief Base64-encode @p len bytes
+ *
+ * @param out Receives the null-terminated text; at least textSize(len) bytes
+ * @return Length of the text, or 0 if out is too small
+ */
+size_t base64(const uint8_t *data, size_t len, char *out, size_t outSize);
+
+} // namespace CompactReport
+
+#endif /* __COMPACTREPORT_H */
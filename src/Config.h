@@ -13,17 +13,42 @@
 #define CONFIG_H
 
 /**
- * @brief Debug serial configuration
- * 
- * Uncomment this line to enable waitFor(Serial.isConnected) on startup
- * and after waking from sleep. This allows you to connect a USB serial
- * terminal to see early boot and wake logs that would otherwise be missed.
- * 
- * WARNING: When enabled, the device will pause for up to 10 seconds waiting
- * for serial connection at boot and after each sleep wake. Only enable this
- * for debugging; leave it commented out for production deployments.
+ * @brief USB serial log buffer (UsbLogSink.h)
+ *
+ * Logs are held in a RAM ring of this many bytes until a USB terminal is
+ * attached, then sent as fast as the host reads them, so early boot and
+ * wake logs are not missed and nothing waits for a host. The oldest text
+ * is dropped when the ring is full.
+ */
+#ifndef USB_LOG_BUFFER_BYTES
+#define USB_LOG_BUFFER_BYTES 4096
+#endif
+
+/**
+ * @brief Send warning and error log lines to the device-log ledger (LedgerLogSink.h)
+ *
+ * Lines at LEDGER_LOG_LEVEL or above are held in a RAM ring of
+ * LEDGER_LOG_BYTES and written only when Cloud::flushLedgers() writes the
+ * other ledgers, so a field device's errors can be read without a USB
+ * cable and without a connection of their own. At most
+ * LEDGER_LOG_DAY_BYTES of lines are kept per UTC day; lines dropped for
+ * the budget or for room are counted in the ledger.
  */
-#define DEBUG_SERIAL
+#ifndef LEDGER_LOG_ENABLED
+#define LEDGER_LOG_ENABLED 1
+#endif
+
+#ifndef LEDGER_LOG_LEVEL
+#define LEDGER_LOG_LEVEL LOG_LEVEL_WARN
+#endif
+
+#ifndef LEDGER_LOG_BYTES
+#define LEDGER_LOG_BYTES 2048
+#endif
+
+#ifndef LEDGER_LOG_DAY_BYTES
+#define LEDGER_LOG_DAY_BYTES 8192
+#endif
 
 /**
  * @brief Sensor type ID mapping (for sysStatus.sensorType).
@@ -37,6 +62,7 @@
  *  -  3: Rain Bucket Sensor
  *  -  4: Vibration / Motion Sensor - Basic
  *  -  5: Vibration Sensor - Advanced (Accel + Magnetometer)
+ *  -  6: Dual PIR / Beam Sensor (in and out counts)
  *  - 10: Indoor Room Occupancy Sensor
  *  - 11: Outdoor Occupancy Sensor
  *  - 12: OpenMV Machine Vision Occupancy Sensor
@@ -45,6 +71,2067 @@
  *  - 21: Distance Sensor (Ultrasonic / TOF)
  *  - 90: LoRA Gateway (gateway device)
  */
-// See SensorFactory.h::SensorType for the corresponding enum.
+// See SensorType.h::SensorType for the corresponding enum.
+
+/**
+ * @brief Sensor driver selection.
+ *
+ * Each SENSOR_DRIVER_xxx switch controls whether that driver is compiled
+ * and linked. Drivers set to 0 are stripped from flash, never allocate
+ * their singleton, and SensorFactory reports their type as not
+ * implemented. Override from the build command line if needed.
+ */
+#ifndef SENSOR_DRIVER_PIR
+#define SENSOR_DRIVER_PIR 1
+#endif
+
+#ifndef SENSOR_DRIVER_VEHICLE_PRESSURE
+#define SENSOR_DRIVER_VEHICLE_PRESSURE 1
+#endif
+
+#ifndef SENSOR_DRIVER_SOIL_MOISTURE
+#define SENSOR_DRIVER_SOIL_MOISTURE 1
+#endif
+
+#ifndef SENSOR_DRIVER_DISTANCE
+#define SENSOR_DRIVER_DISTANCE 1
+#endif
+
+#ifndef SENSOR_DRIVER_VEHICLE_MAGNETOMETER
+#define SENSOR_DRIVER_VEHICLE_MAGNETOMETER 1
+#endif
+
+#ifndef SENSOR_DRIVER_RAIN_BUCKET
+#define SENSOR_DRIVER_RAIN_BUCKET 1
+#endif
+
+#ifndef SENSOR_DRIVER_DUAL_PIR
+#define SENSOR_DRIVER_DUAL_PIR 1
+#endif
+
+// The gateway, camera and accelerometer drivers carry large static buffers
+// (node table, UART ring, enlarged Wire buffer) and run on their own
+// boards, so they are opt-in
+#ifndef SENSOR_DRIVER_LORA_GATEWAY
+#define SENSOR_DRIVER_LORA_GATEWAY 0
+#endif
+
+#ifndef SENSOR_DRIVER_OPENMV
+#define SENSOR_DRIVER_OPENMV 0
+#endif
+
+#ifndef SENSOR_DRIVER_ACCEL_PRESENCE
+#define SENSOR_DRIVER_ACCEL_PRESENCE 0
+#endif
+
+#ifndef SENSOR_DRIVER_VIBRATION
+#define SENSOR_DRIVER_VIBRATION 0
+#endif
+
+/**
+ * @brief LoRa gateway radio and node table (SensorType::LORA_GATEWAY).
+ *
+ * Nodes and gateway must agree on frequency, spreading factor (7-12, at
+ * 125 kHz), sync word and network id. The table holds LORA_MAX_NODES
+ * nodes (20 bytes each); 40 is what one 622-byte event carries. A node
+ * not heard for LORA_NODE_EXPIRE_SEC is dropped at the next report and
+ * its row reused.
+ */
+#ifndef LORA_FREQUENCY_HZ
+#define LORA_FREQUENCY_HZ 915000000UL
+#endif
+
+#ifndef LORA_SPREADING_FACTOR
+#define LORA_SPREADING_FACTOR 9
+#endif
+
+#ifndef LORA_SYNC_WORD
+#define LORA_SYNC_WORD 0x12
+#endif
+
+#ifndef LORA_NETWORK_ID
+#define LORA_NETWORK_ID 1
+#endif
+
+#ifndef LORA_MAX_NODES
+#define LORA_MAX_NODES 40
+#endif
+
+#ifndef LORA_NODE_EXPIRE_SEC
+#define LORA_NODE_EXPIRE_SEC 86400
+#endif
+
+/**
+ * @brief OpenMV camera link and duty cycle (SensorType::OPENMV_OCCUPANCY).
+ *
+ * The camera is powered for OPENMV_ON_SEC at the start of every
+ * OPENMV_PERIOD_SEC while the device is awake. A camera that has not sent
+ * HELLO within OPENMV_BOOT_TIMEOUT_MS, or goes OPENMV_SILENCE_TIMEOUT_MS
+ * without a frame, is powered off until the next period and flagged as a
+ * sensor fault. OPENMV_RX_BUFFER_SIZE replaces Serial1's 64-byte receive
+ * ring.
+ */
+#ifndef OPENMV_BAUD
+#define OPENMV_BAUD 115200
+#endif
+
+#ifndef OPENMV_ON_SEC
+#define OPENMV_ON_SEC 60
+#endif
+
+#ifndef OPENMV_PERIOD_SEC
+#define OPENMV_PERIOD_SEC 300
+#endif
+
+#ifndef OPENMV_BOOT_TIMEOUT_MS
+#define OPENMV_BOOT_TIMEOUT_MS 5000UL
+#endif
+
+#ifndef OPENMV_SILENCE_TIMEOUT_MS
+#define OPENMV_SILENCE_TIMEOUT_MS 10000UL
+#endif
+
+#ifndef OPENMV_RX_BUFFER_SIZE
+#define OPENMV_RX_BUFFER_SIZE 512
+#endif
+
+/**
+ * @brief LIS3DH accelerometer presence sensor (SensorType::ACCEL_PRESENCE).
+ *
+ * The part samples at ACCEL_ODR_HZ (10, 25, 50 or 100) into its 32-sample
+ * FIFO and raises INT1 (wired to intPin) once the high-passed acceleration
+ * on any axis exceeds ACCEL_WAKE_THRESHOLD_MG for ACCEL_WAKE_DURATION
+ * samples. Each interrupt reads the FIFO in one burst and counts presence
+ * when at least ACCEL_PRESENCE_MIN_SAMPLES samples are above the threshold
+ * and none is above ACCEL_IMPACT_MG (a knock or a dropped object).
+ */
+#ifndef ACCEL_I2C_ADDR
+#define ACCEL_I2C_ADDR 0x18
+#endif
+
+#ifndef ACCEL_ODR_HZ
+#define ACCEL_ODR_HZ 25
+#endif
+
+#ifndef ACCEL_WAKE_THRESHOLD_MG
+#define ACCEL_WAKE_THRESHOLD_MG 80
+#endif
+
+#ifndef ACCEL_WAKE_DURATION
+#define ACCEL_WAKE_DURATION 2
+#endif
+
+#ifndef ACCEL_PRESENCE_MIN_SAMPLES
+#define ACCEL_PRESENCE_MIN_SAMPLES 4
+#endif
+
+#ifndef ACCEL_IMPACT_MG
+#define ACCEL_IMPACT_MG 1500
+#endif
+
+/**
+ * @brief LIS3DH + LIS2MDL vibration sensor (SensorType::VIBRATION_ADVANCED).
+ *
+ * Same wiring as ACCEL_PRESENCE, sampled at VIBRATION_ODR_HZ so a 32-point
+ * FFT of one FIFO burst resolves VIBRATION_ODR_HZ / 32 Hz. INT1 rises above
+ * VIBRATION_WAKE_THRESHOLD_MG for VIBRATION_WAKE_DURATION samples. A burst
+ * counts when its RMS reaches VIBRATION_EVENT_RMS_MG and its peak lies in
+ * VIBRATION_EVENT_MIN_HZ..VIBRATION_EVENT_MAX_HZ. A field change of
+ * VIBRATION_MAG_DELTA_MG from the magnetometer's baseline flags a vehicle.
+ */
+#ifndef VIBRATION_ODR_HZ
+#define VIBRATION_ODR_HZ 100
+#endif
+
+#ifndef VIBRATION_WAKE_THRESHOLD_MG
+#define VIBRATION_WAKE_THRESHOLD_MG 48
+#endif
+
+#ifndef VIBRATION_WAKE_DURATION
+#define VIBRATION_WAKE_DURATION 1
+#endif
+
+#ifndef VIBRATION_EVENT_RMS_MG
+#define VIBRATION_EVENT_RMS_MG 30
+#endif
+
+#ifndef VIBRATION_EVENT_MIN_HZ
+#define VIBRATION_EVENT_MIN_HZ 5
+#endif
+
+#ifndef VIBRATION_EVENT_MAX_HZ
+#define VIBRATION_EVENT_MAX_HZ 40
+#endif
+
+#ifndef VIBRATION_MAG_I2C_ADDR
+#define VIBRATION_MAG_I2C_ADDR 0x1E
+#endif
+
+#ifndef VIBRATION_MAG_DELTA_MG
+#define VIBRATION_MAG_DELTA_MG 50
+#endif
+
+/**
+ * @brief Label candidate events with an int8 classifier (see TinyClassifier.h).
+ *
+ * ACCEL_PRESENCE, VIBRATION_ADVANCED and OPENMV_OCCUPANCY events that pass
+ * their thresholds go through the model for their sensor type, if
+ * CLASSIFIER_MODELS_HEADER provides one: noise is dropped and the other
+ * labels ride in SensorEvent::flags. CLASSIFIER_MAX_WIDTH is the widest
+ * layer the static activation arena (two buffers of it) holds.
+ */
+#ifndef CLASSIFIER_ENABLED
+#define CLASSIFIER_ENABLED 0
+#endif
+
+#ifndef CLASSIFIER_MAX_WIDTH
+#define CLASSIFIER_MAX_WIDTH 32
+#endif
+
+/** @brief Largest classifier model blob from asset OTA, and its most layers (AssetStore.h) */
+#ifndef CLASSIFIER_ASSET_BYTES
+#define CLASSIFIER_ASSET_BYTES 4096
+#endif
+
+#ifndef CLASSIFIER_MAX_LAYERS
+#define CLASSIFIER_MAX_LAYERS 4
+#endif
+
+/** @brief Largest blob AssetStore installs from asset OTA */
+#ifndef ASSET_MAX_BYTES
+#define ASSET_MAX_BYTES 16384
+#endif
+
+/**
+ * @brief LIS2MDL vehicle detector (SensorType::VEHICLE_MAGNETOMETER).
+ *
+ * The baseline follows drift with time constant MAG_BASELINE_TAU_SEC and
+ * is frozen during a detection. A detection opens at MAG_ENTER_MG of
+ * deviation, closes after MAG_EXIT_SAMPLES samples below MAG_EXIT_MG, and
+ * is closed as parked after MAG_MAX_DWELL_SEC. Sampling is one single shot
+ * every MAG_QUIET_PERIOD_MS, boosted to MAG_BOOST_ODR_HZ (10, 20, 50 or
+ * 100) from MAG_BOOST_MG until MAG_BOOST_HOLD_MS after the last such
+ * sample. During naps the part's own threshold interrupt (MAG_WAKE_MG on
+ * any axis) wakes the device on intPin.
+ */
+#ifndef MAG_I2C_ADDR
+#define MAG_I2C_ADDR 0x1E
+#endif
+
+#ifndef MAG_QUIET_PERIOD_MS
+#define MAG_QUIET_PERIOD_MS 1000UL
+#endif
+
+#ifndef MAG_BOOST_ODR_HZ
+#define MAG_BOOST_ODR_HZ 50
+#endif
+
+#ifndef MAG_BOOST_MG
+#define MAG_BOOST_MG 15
+#endif
+
+#ifndef MAG_BOOST_HOLD_MS
+#define MAG_BOOST_HOLD_MS 5000UL
+#endif
+
+#ifndef MAG_ENTER_MG
+#define MAG_ENTER_MG 40
+#endif
+
+#ifndef MAG_EXIT_MG
+#define MAG_EXIT_MG 20
+#endif
+
+#ifndef MAG_EXIT_SAMPLES
+#define MAG_EXIT_SAMPLES 5
+#endif
+
+#ifndef MAG_BASELINE_TAU_SEC
+#define MAG_BASELINE_TAU_SEC 900
+#endif
+
+#ifndef MAG_MAX_DWELL_SEC
+#define MAG_MAX_DWELL_SEC 600
+#endif
+
+#ifndef MAG_WAKE_MG
+#define MAG_WAKE_MG 25
+#endif
+
+/**
+ * @brief Tipping-bucket rain gauge (SensorType::RAIN_BUCKET).
+ *
+ * RAIN_UM_PER_TIP is the gauge's calibration (0.2 mm is common). Closures
+ * within RAIN_DEBOUNCE_MS of a tip are reed bounce. Each 5-minute rate in
+ * the Rain-v1 report is classed light below RAIN_MODERATE_MMH10, then
+ * moderate, heavy from RAIN_HEAVY_MMH10 and violent from
+ * RAIN_VIOLENT_MMH10 (mm/h x 10; the defaults are the usual 2.5, 7.6 and
+ * 50 mm/h).
+ */
+#ifndef RAIN_UM_PER_TIP
+#define RAIN_UM_PER_TIP 200
+#endif
+
+#ifndef RAIN_DEBOUNCE_MS
+#define RAIN_DEBOUNCE_MS 100
+#endif
+
+#ifndef RAIN_MODERATE_MMH10
+#define RAIN_MODERATE_MMH10 25
+#endif
+
+#ifndef RAIN_HEAVY_MMH10
+#define RAIN_HEAVY_MMH10 76
+#endif
+
+#ifndef RAIN_VIOLENT_MMH10
+#define RAIN_VIOLENT_MMH10 500
+#endif
+
+/**
+ * @brief Interrupt storm limits for the PIR input.
+ *
+ * A PIR pulse lasts seconds, so more than SENSOR_STORM_EDGES_PER_SEC
+ * rising edges in one second is a chattering line, not motion. The ISR then
+ * stops queueing edges, loop() detaches the interrupt, raises alert 24 and
+ * polls the pin; the interrupt is re-attached once the line has been low
+ * and quiet for SENSOR_STORM_QUIET_SEC.
+ */
+#ifndef SENSOR_STORM_EDGES_PER_SEC
+#define SENSOR_STORM_EDGES_PER_SEC 50
+#endif
+
+#ifndef SENSOR_STORM_QUIET_SEC
+#define SENSOR_STORM_QUIET_SEC 60
+#endif
+
+/**
+ * @brief Seconds a PIR module takes to settle after power-on
+ *
+ * Its output chatters while it settles (HC-SR501: up to a minute; AM312:
+ * about 10 s). SensorManager discards its edges for this long after setup
+ * or a night power-down (ISensor::warmupMs()), and the pin is not a nap
+ * wake source meanwhile. 0 disables the warm-up.
+ */
+#ifndef PIR_WARMUP_SEC
+#define PIR_WARMUP_SEC 30
+#endif
+
+/**
+ * @brief Estimate group size from PIR pulse widths
+ *
+ * A group walking past holds the PIR output high longer, and retriggers it
+ * sooner, than one person, but gives only one or two rising edges. With
+ * this set the ISR also queues falling edges. Pulses less than
+ * PIR_GROUP_GAP_MS apart make one group, and its total high time is turned
+ * into people with the site's sensor.groupBaseMs / sensor.groupStepMs
+ * curve (sensorConfig). The people estimate is reported beside the edge
+ * count, never in place of it, and only once groupStepMs is set.
+ */
+#ifndef PIR_GROUP_ESTIMATE
+#define PIR_GROUP_ESTIMATE 1
+#endif
+
+/** @brief Longest low time between two pulses of the same group, ms */
+#ifndef PIR_GROUP_GAP_MS
+#define PIR_GROUP_GAP_MS 3000
+#endif
+
+/** @brief Longest pulse credited to a group, ms; a fall missed (over a nap) counts as this */
+#ifndef PIR_GROUP_MAX_PULSE_MS
+#define PIR_GROUP_MAX_PULSE_MS 60000
+#endif
+
+/** @brief Largest group one estimate can give */
+#ifndef PIR_GROUP_MAX_PEOPLE
+#define PIR_GROUP_MAX_PEOPLE 20
+#endif
+
+/** @brief Most steps in a PIR group table delivered by asset OTA (AssetStore.h); it replaces the curve */
+#ifndef PIR_GROUP_TABLE_MAX
+#define PIR_GROUP_TABLE_MAX 32
+#endif
+
+/**
+ * @brief Longest gap between the two channels of one DUAL_PIR crossing, ms
+ *
+ * Channel A (intPin) then channel B (intPinB) within this window is one
+ * crossing in; B then A is one out. An edge with no partner by then is
+ * counted without a direction. Set from the beam spacing and walking
+ * speed: 1.5 s covers about 2 m at a slow walk.
+ */
+#ifndef DIRECTION_GAP_MS
+#define DIRECTION_GAP_MS 1500
+#endif
+
+/**
+ * @brief Confirm each primary-sensor event with a range finder burst, cm (0 = off)
+ *
+ * A PIR also fires on sun-warmed vegetation and animals. With this set,
+ * SensorManager takes one DISTANCE burst for each batch of accepted events
+ * and keeps them only if the range finder sees a target closer than this.
+ * The range finder is on its own supply (PowerDomains::RANGE, rangePower),
+ * powered for the burst only. A burst that fails keeps the events, so a
+ * faulty range finder cannot stop the count. Needs SENSOR_DRIVER_DISTANCE;
+ * ignored when the primary sensor is the range finder itself.
+ */
+#ifndef FUSION_RANGE_CM
+#define FUSION_RANGE_CM 0
+#endif
+
+/**
+ * @brief Count PIR edges in hardware during busy-hour naps (Boron only).
+ *
+ * Once EDGE_COUNT_BUSY_PER_HOUR events have been counted in the current
+ * hour, ULTRA_LOW_POWER and STOP naps stop waking on intPin. Rising edges
+ * are counted by the nRF52 GPIOTE -> PPI -> TIMER chain instead (see
+ * EdgeCounter.h) and added to the counters when the nap ends. These
+ * edges skip the event filter and carry the nap's midpoint as their time.
+ * The GPIOTE and PPI channels must be ones Device OS and the SoftDevice
+ * leave free.
+ */
+#ifndef EDGE_COUNT_IN_SLEEP
+#define EDGE_COUNT_IN_SLEEP 0
+#endif
+
+#ifndef EDGE_COUNT_BUSY_PER_HOUR
+#define EDGE_COUNT_BUSY_PER_HOUR 30
+#endif
+
+#ifndef EDGE_COUNT_GPIOTE_CHANNEL
+#define EDGE_COUNT_GPIOTE_CHANNEL 7
+#endif
+
+#ifndef EDGE_COUNT_PPI_CHANNEL
+#define EDGE_COUNT_PPI_CHANNEL 15
+#endif
+
+/**
+ * @brief Service the primary sensor from its own Device OS thread.
+ *
+ * When 1, a thread above the application thread's priority drains the
+ * driver's ISR ring, runs the event filter and polls aux sensors every
+ * SENSOR_THREAD_PERIOD_MS, so a slow state handler, flash write or cloud
+ * call no longer delays filtering (and the ISR ring cannot back up behind
+ * it). Accepted events wait in a lock-free SENSOR_THREAD_QUEUE-entry
+ * queue until the mode handlers apply them; they keep their capture time,
+ * so counts land in the right hour and bin however late that is.
+ */
+#ifndef SENSOR_THREAD_ENABLED
+#define SENSOR_THREAD_ENABLED 0
+#endif
+
+#ifndef SENSOR_THREAD_PERIOD_MS
+#define SENSOR_THREAD_PERIOD_MS 5
+#endif
+
+#ifndef SENSOR_THREAD_PRIORITY
+#define SENSOR_THREAD_PRIORITY (OS_THREAD_PRIORITY_DEFAULT + 1)
+#endif
+
+#ifndef SENSOR_THREAD_STACK
+#define SENSOR_THREAD_STACK 3072
+#endif
+
+#ifndef SENSOR_THREAD_QUEUE
+#define SENSOR_THREAD_QUEUE 64
+#endif
+
+/**
+ * @brief Longest time SensorManager::batteryState() reuses its fuel gauge
+ *        and PMIC snapshot.
+ *
+ * A battery_state or power_source system event refreshes it sooner. Reports,
+ * connects and scheduled samples in between read the cached values with no
+ * I2C traffic.
+ */
+#ifndef POWER_SNAPSHOT_TTL_SEC
+#define POWER_SNAPSHOT_TTL_SEC 900
+#endif
+
+/**
+ * @brief Seconds between TMP112A one-shot conversions while awake.
+ *
+ * The sensor is shut down between conversions; each nap also triggers one
+ * on wake. Only used on boards with a TMP112A (Muon).
+ */
+#ifndef TMP112_INTERVAL_SEC
+#define TMP112_INTERVAL_SEC 300
+#endif
+
+/**
+ * @brief Entries in the retained binary trace ring (TraceLog.h).
+ *
+ * 20 bytes each, in retained RAM alongside the retained counters. State
+ * changes, alerts, sleeps, wakes and connects each add one; 48 covers
+ * the last few report cycles before a reset.
+ */
+#ifndef TRACE_LOG_ENTRIES
+#define TRACE_LOG_ENTRIES 48
+#endif
+
+/**
+ * @brief Per-wake records and the daily "wakes" summary (WakeLedger.h).
+ *
+ * Each awake period is kept as a 16-byte record (reason, seconds asleep,
+ * ms awake, counts, work done) in a retained ring of WAKE_LEDGER_ENTRIES,
+ * and summed per wake reason until the daily cleanup publishes it.
+ */
+#ifndef WAKE_LEDGER_ENABLED
+#define WAKE_LEDGER_ENABLED 1
+#endif
+
+#ifndef WAKE_LEDGER_ENTRIES
+#define WAKE_LEDGER_ENTRIES 24
+#endif
+
+/**
+ * @brief Bench trace replay (TraceReplay.h).
+ *
+ * When 1, the "replay" cloud function feeds a recorded trace of sensor
+ * edges and wakes through the live counting/occupancy pipeline and
+ * publishes a "replay" event with events in, counts out, losses, doubles
+ * and handler time per event. Injected events are counted for real, so
+ * this is for bench units only. Off by default.
+ */
+#ifndef TRACE_REPLAY_ENABLED
+#define TRACE_REPLAY_ENABLED 0
+#endif
+
+/**
+ * @brief Bench loopback counting test (LoopbackTest.h).
+ *
+ * When 1, the "loopback" cloud function drives a pulse train (rate,
+ * bursts, jitter, width) on loopbackOutPin, jumpered to intPin, while the
+ * device goes on with its normal connect and persist work. A "loopback"
+ * event then reports pulses generated against events counted and the
+ * ISR-to-handler latency percentiles. Counts are real; bench units only.
+ * Off by default.
+ */
+#ifndef LOOPBACK_TEST_ENABLED
+#define LOOPBACK_TEST_ENABLED 0
+#endif
+
+/**
+ * @brief Bench soak profile (SoakTest.h).
+ *
+ * When 1, the firmware reports every SOAK_REPORT_INTERVAL_SEC, injects a
+ * synthetic sensor edge every SOAK_EVENT_PERIOD_MS while awake and fails
+ * every SOAK_CONNECT_FAIL_EVERY-th connect attempt, and every
+ * SOAK_REPORT_CYCLES reports it queues a "soak" event with the heap
+ * low-water marks, the longest loop pass, and publish queue and
+ * persistence write latencies. Run it for weeks on a bench unit before a
+ * release and compare the trend. Counts are real. Off by default.
+ */
+#ifndef SOAK_TEST_ENABLED
+#define SOAK_TEST_ENABLED 0
+#endif
+#ifndef SOAK_REPORT_INTERVAL_SEC
+#define SOAK_REPORT_INTERVAL_SEC 60
+#endif
+#ifndef SOAK_EVENT_PERIOD_MS
+#define SOAK_EVENT_PERIOD_MS 2000
+#endif
+#ifndef SOAK_CONNECT_FAIL_EVERY
+#define SOAK_CONNECT_FAIL_EVERY 5
+#endif
+#ifndef SOAK_REPORT_CYCLES
+#define SOAK_REPORT_CYCLES 100
+#endif
+
+/**
+ * @brief Bench fault injection (FaultInject.h).
+ *
+ * When 1, the "fault" cloud function, or the same command as a line on USB
+ * serial, times out connect attempts, drops the cloud session mid-drain,
+ * fails device-data ledger sets or slows persistence saves by
+ * FAULT_STORAGE_DELAY_MS, and a "fault" event gives the time and estimated
+ * energy of each recovery. Bench units only. Off by default.
+ */
+#ifndef FAULT_INJECT_ENABLED
+#define FAULT_INJECT_ENABLED 0
+#endif
+#ifndef FAULT_STORAGE_DELAY_MS
+#define FAULT_STORAGE_DELAY_MS 250
+#endif
+
+/**
+ * @brief Persistent field access profiler (PersistProfile.h).
+ *
+ * When 1, every sysStatus, sensorConfig and current getter and setter is
+ * counted and timed (mutex included) per field, and every
+ * PERSIST_PROFILE_PERIOD_SEC the PERSIST_PROFILE_TOP busiest fields are
+ * logged and queued as a "persistProf" event. Use it to pick fields for
+ * ConfigSnapshot and to check the change on a unit. Debug builds only; off
+ * by default.
+ */
+#ifndef PERSIST_PROFILE_ENABLED
+#define PERSIST_PROFILE_ENABLED 0
+#endif
+#ifndef PERSIST_PROFILE_PERIOD_SEC
+#define PERSIST_PROFILE_PERIOD_SEC 3600
+#endif
+#ifndef PERSIST_PROFILE_TOP
+#define PERSIST_PROFILE_TOP 8
+#endif
+
+/**
+ * @brief On-device microbenchmarks (MicroBench.h).
+ *
+ * When 1, setup() ends by timing the persistent store, the status and data
+ * builders, the publish queue, local time conversion and PMIC reads with
+ * System.ticks(), and prints the table on USB serial. It writes real files
+ * and ledgers; bench units only. Off by default.
+ */
+#ifndef MICROBENCH_ENABLED
+#define MICROBENCH_ENABLED 0
+#endif
+
+/**
+ * @brief Field benchmark pass on request (MicroBench.h)
+ *
+ * When 1, the `bench` cloud function asks for one pass at the next IDLE
+ * pass with no publish in flight. It times a current.dat save, an
+ * event-sized file write and read like the publish queue's, local time
+ * conversions, and a FIELD_BENCH_THROUGHPUT_KB sequential write and read
+ * on the device's own flash, then queues one compact "bench" event.
+ * Scratch files go under /usr/bench and are removed; queued data and the
+ * ledgers are not touched, so it is safe on deployed units.
+ */
+#ifndef FIELD_BENCH_ENABLED
+#define FIELD_BENCH_ENABLED 1
+#endif
+
+#ifndef FIELD_BENCH_THROUGHPUT_KB
+#define FIELD_BENCH_THROUGHPUT_KB 32
+#endif
+
+/**
+ * @brief Per-event logs in the counting and occupancy paths
+ *
+ * "Count detected", each occupancy event and the wake-to-count latency
+ * line run for every sensor batch. At 0 they are compiled out, format
+ * strings included; verboseMode cannot bring them back. Set to 1 on a
+ * bench unit.
+ */
+#ifndef COUNT_PATH_LOGGING
+#define COUNT_PATH_LOGGING 0
+#endif
+
+/**
+ * @brief Drive the phase marker pins for a power analyzer (PhaseMarker.h).
+ *
+ * When 1, three spare pins (phaseMarkerPins, the LoRa gateway's D2, D3 and
+ * SPI SS) carry a 3-bit code for what the device is doing: sleeping,
+ * booting, sensing, connecting, connected or disconnecting. Wire them to
+ * the analyzer's digital inputs and phase_energy.py splits the capture by
+ * phase. Bench units only; not with SENSOR_DRIVER_LORA_GATEWAY.
+ */
+#ifndef PHASE_MARKERS
+#define PHASE_MARKERS 0
+#endif
+
+/**
+ * @brief Counter journal.
+ *
+ * When 1, counting-mode updates are appended to a small journal file
+ * (see CounterJournal.h) instead of rewriting current.dat on every
+ * count; the journal is folded into current.dat periodically. Set to 0
+ * to save current.dat directly.
+ */
+#ifndef COUNTER_JOURNAL
+#define COUNTER_JOURNAL 1
+#endif
+
+/**
+ * @brief Retained-RAM counter tier.
+ *
+ * When 1, counting-mode updates only touch a retained-memory copy of the
+ * counters, which survives soft resets and ULTRA_LOW_POWER naps. current.dat
+ * is checkpointed every COUNTER_CHECKPOINT_MINUTES, at day rollover
+ * and before HIBERNATE, or whenever another field changes. Counts since the
+ * last checkpoint are lost on power loss. Takes precedence over
+ * COUNTER_JOURNAL.
+ */
+#ifndef COUNTER_RETAINED
+#define COUNTER_RETAINED 1
+#endif
+
+#ifndef COUNTER_CHECKPOINT_MINUTES
+#define COUNTER_CHECKPOINT_MINUTES 30
+#endif
+
+/**
+ * @brief Consolidated persistent store.
+ *
+ * When 1, sysStatus, sensorConfig and current share one file
+ * (/usr/store.dat, see PersistentStore.h): one read at boot and one write
+ * for all pending saves. Existing per-object files are migrated on first
+ * boot and left in place. Default 0 keeps one file per object.
+ */
+#ifndef PERSISTENT_SINGLE_FILE
+#define PERSISTENT_SINGLE_FILE 0
+#endif
+
+/**
+ * @brief Coalesced backlog publishing.
+ *
+ * When 1, a backlog of hourly webhook events in the publish queue is sent
+ * as merged "batch" events (see ProjectConfig::webhookBatchEventName()),
+ * as many reports per publish as fit in one event. Off by default: a fleet
+ * needs the Ubidots-Counter-Batch-v1 webhook from docs/webhooks before it
+ * is turned on, or batched reports are acknowledged by the cloud and never
+ * reach Ubidots.
+ */
+#ifndef PUBLISH_COALESCE
+#define PUBLISH_COALESCE 0
+#endif
+
+/**
+ * @brief Segmented publish queue storage.
+ *
+ * When 1, the on-flash publish queue is kept in a ring of fixed-size
+ * segment files (PublishQueuePosix::withSegmentStore()) instead of one
+ * LittleFS file per event, so queueing and sending an event do not create
+ * or delete files and boot reads a few headers instead of the queue
+ * directory. Events already queued in the old format are carried over.
+ */
+#ifndef PUBLISH_SEGMENT_STORE
+#define PUBLISH_SEGMENT_STORE 1
+#endif
+
+/**
+ * @brief Priority lanes in the publish queue.
+ *
+ * When 1, the publish queue keeps separate lanes (ProjectConfig::PublishLane)
+ * for alerts, hourly reports, startup status and diagnostics, each with its
+ * own capacity. Alerts drain first after a reconnect, and a long outage
+ * evicts diagnostics rather than hourly data. Set to 0 for one shared queue.
+ */
+#ifndef PUBLISH_PRIORITY_LANES
+#define PUBLISH_PRIORITY_LANES 1
+#endif
+
+/**
+ * @brief Fold old hourly reports into daily summaries before dropping any.
+ *
+ * When 1 (and PUBLISH_PRIORITY_LANES is on), once more than 600 reports are
+ * queued on flash, the oldest complete local day of hourly reports is
+ * replaced by one daily summary (ReportCompactor) in LANE_SUMMARY, until the
+ * queue is back at 600. A very long outage then keeps each day's total
+ * instead of losing whole days off the front of the queue. Needs the daily
+ * webhook in docs/webhooks.
+ */
+#ifndef PUBLISH_BACKLOG_COMPACTION
+#define PUBLISH_BACKLOG_COMPACTION 1
+#endif
+
+/**
+ * @brief Skip the ledger merge/apply when the settings have not changed
+ *
+ * When 1, Cloud::mergeConfiguration() hashes the default-settings and
+ * device-settings contents and returns early if both match the hashes saved
+ * in sysStatus after the last successful apply. Every connect and every
+ * ledger sync otherwise rebuilds and re-validates the whole configuration.
+ * When a ledger did change, each section of the merged configuration
+ * (sensor, timing, power, messaging, modes) is hashed too, and only the
+ * sections that differ are applied. When 0, every section applies at
+ * every merge. The hashes are seeded with the firmware version, so an
+ * update always applies once.
+ */
+#ifndef CONFIG_APPLY_HASH_SKIP
+#define CONFIG_APPLY_HASH_SKIP 1
+#endif
+
+/**
+ * @brief Apply the device's cached copy of the settings ledgers at boot
+ *
+ * Device OS keeps the last synced default-settings and device-settings on
+ * flash. When 1, Cloud::setup() merges and applies them before the first
+ * state pass, ignoring the CONFIG_APPLY_HASH_SKIP hashes, so a sysStatus or
+ * sensorConfig save that was cut short is corrected without waiting for a
+ * connection. The connect path then skips the apply when nothing changed.
+ */
+#ifndef CONFIG_APPLY_AT_BOOT
+#define CONFIG_APPLY_AT_BOOT 1
+#endif
+
+/**
+ * @brief Merge the settings ledgers once a day in LOW_POWER mode
+ *
+ * Settings change a few times a season, yet every LOW_POWER connect and
+ * every ledger sync reads, hashes and merges default-settings and
+ * device-settings. When 1, in LOW_POWER mode that full merge runs only:
+ *   - on the first connect of a local day,
+ *   - after a "config" function call of "check" (Cloud::requestConfigCheck()),
+ *   - when a "configVersion" field at the top of either settings ledger
+ *     differs from the one seen at the last merge.
+ * Other connects compare just the two configVersion values. Bump
+ * configVersion with a change that should not wait for the next day.
+ * CONNECTED mode merges on every sync, as before.
+ */
+#ifndef CONFIG_CHECK_DAILY
+#define CONFIG_CHECK_DAILY 1
+#endif
+
+/**
+ * @brief Coalesce device-data and device-status ledger writes
+ *
+ * When 1, reports, connects and configuration changes only mark the
+ * device-written ledgers dirty (Cloud::markLedgerDirty()); they are written
+ * together once, on entry to SLEEPING_STATE. In CONNECTED mode, which may not
+ * sleep for hours, they are also flushed once the oldest change is
+ * LEDGER_FLUSH_DELAY_SEC old. When 0, dirty ledgers are written by the
+ * next "ledgers" task run (about once a second) while connected.
+ */
+#ifndef LEDGER_COALESCE_WRITES
+#define LEDGER_COALESCE_WRITES 1
+#endif
+
+#ifndef LEDGER_FLUSH_DELAY_SEC
+#define LEDGER_FLUSH_DELAY_SEC 60
+#endif
+
+/**
+ * @brief Time allowed for one pass of the application loop, in milliseconds
+ *
+ * TaskScheduler defers housekeeping tasks (persistence, publish queue, ledger
+ * work, ...) that would not fit in what is left of the pass after the state
+ * handler, until each task's deadline.
+ */
+#ifndef LOOP_BUDGET_MS
+#define LOOP_BUDGET_MS 100
+#endif
+
+/**
+ * @brief Application watchdog timeout, in milliseconds
+ *
+ * A loop() pass longer than this resets the device. device-status reports
+ * the longest pass and the margin left under this timeout ("loop").
+ */
+#ifndef APP_WATCHDOG_MS
+#define APP_WATCHDOG_MS 60000
+#endif
+
+/**
+ * @brief Learn the connect attempt budget from this site's connect history
+ *
+ * When 1, CONNECTING_STATE gives up after the 95th percentile of recorded
+ * attempts x 1.5 + CONNECT_BUDGET_MARGIN_SEC (30-900 s), failures counting as
+ * longer than any success, instead of the
+ * fixed connectAttemptBudgetSec, once CONNECT_BUDGET_MIN_SAMPLES successful
+ * connects are recorded. See ConnectHistory.h.
+ */
+#ifndef CONNECT_BUDGET_ADAPTIVE
+#define CONNECT_BUDGET_ADAPTIVE 1
+#endif
+
+#ifndef CONNECT_BUDGET_MIN_SAMPLES
+#define CONNECT_BUDGET_MIN_SAMPLES 10
+#endif
+
+#ifndef CONNECT_BUDGET_MARGIN_SEC
+#define CONNECT_BUDGET_MARGIN_SEC 15
+#endif
+
+/**
+ * @brief Keep the cloud session and last network across sleeps
+ *
+ * When 1, the sleep disconnect keeps the cloud session (Boron and P2) so
+ * the next connect resumes it instead of a full handshake, and the P2's
+ * last access point BSSID and IP lease are kept in sysStatus so each
+ * connect is logged as on the same network or a new one. Every connect
+ * logs its phases (radio on, network ready, cloud handshake); see
+ * ConnectCache.h.
+ */
+#ifndef CONNECT_CACHE_ENABLED
+#define CONNECT_CACHE_ENABLED 1
+#endif
+
+/**
+ * @brief Check cellular signal before a report connect in LOW_POWER mode
+ *
+ * When 1, a connect entered from REPORTING_STATE first registers on the
+ * network only (Cellular.connect()) and reads Cellular.RSSI(). If strength
+ * or quality is below the minimums, or registration takes longer than
+ * SIGNAL_PROBE_TIMEOUT_SEC, the radio is turned off and the device goes back
+ * to sleep; the report stays queued and goes with the next one. After
+ * SIGNAL_DEFER_MAX_HOURS of deferring, the next report connects regardless.
+ * Cellular platforms only.
+ */
+#ifndef SIGNAL_GATE_ENABLED
+#define SIGNAL_GATE_ENABLED 1
+#endif
+
+#ifndef SIGNAL_GATE_MIN_STRENGTH
+#define SIGNAL_GATE_MIN_STRENGTH 20
+#endif
+
+#ifndef SIGNAL_GATE_MIN_QUALITY
+#define SIGNAL_GATE_MIN_QUALITY 15
+#endif
+
+#ifndef SIGNAL_PROBE_TIMEOUT_SEC
+#define SIGNAL_PROBE_TIMEOUT_SEC 60
+#endif
+
+#ifndef SIGNAL_DEFER_MAX_HOURS
+#define SIGNAL_DEFER_MAX_HOURS 6
+#endif
+
+/**
+ * @brief Hold firmware updates until the device can afford them
+ *
+ * When 1, Device OS updates stay off until a connect finds SoC at least
+ * OTA_MIN_SOC (OTA_MIN_SOC_CHARGING while charging), cellular signal at
+ * least OTA_MIN_SIGNAL_STRENGTH / OTA_MIN_SIGNAL_QUALITY percent, and the
+ * local hour in [OTA_WINDOW_START_HOUR, OTA_WINDOW_END_HOUR) (equal hours
+ * = any time). After OTA_DEFER_MAX_HOURS of deferring, or for a forced
+ * update, the next connect takes it regardless. See OtaScheduler.h.
+ */
+#ifndef OTA_SCHEDULER_ENABLED
+#define OTA_SCHEDULER_ENABLED 1
+#endif
+
+#ifndef OTA_MIN_SOC
+#define OTA_MIN_SOC 50
+#endif
+
+#ifndef OTA_MIN_SOC_CHARGING
+#define OTA_MIN_SOC_CHARGING 30
+#endif
+
+#ifndef OTA_MIN_SIGNAL_STRENGTH
+#define OTA_MIN_SIGNAL_STRENGTH 30
+#endif
+
+#ifndef OTA_MIN_SIGNAL_QUALITY
+#define OTA_MIN_SIGNAL_QUALITY 20
+#endif
+
+#ifndef OTA_WINDOW_START_HOUR
+#define OTA_WINDOW_START_HOUR 10
+#endif
+
+#ifndef OTA_WINDOW_END_HOUR
+#define OTA_WINDOW_END_HOUR 16
+#endif
+
+#ifndef OTA_DEFER_MAX_HOURS
+#define OTA_DEFER_MAX_HOURS 72
+#endif
+
+/**
+ * @brief Count the sensor events captured while an update is in progress
+ *
+ * When 1, UpdateWindow counts accepted events whose capture time falls in
+ * FIRMWARE_UPDATE_STATE or a Device OS firmware_update, across the reset
+ * that ends a successful update, and reports them in the device status as
+ * "ota". Capture during those windows does not depend on the state
+ * handler: the ISR rings fill regardless, and with SENSOR_THREAD_ENABLED
+ * the sensor thread drains and filters them however long the application
+ * thread is held up. See UpdateWindow.h.
+ */
+#ifndef UPDATE_WINDOW_STATS_ENABLED
+#define UPDATE_WINDOW_STATS_ENABLED 1
+#endif
+
+/**
+ * @brief Skip the daily cloud time sync while a drift model vouches for the clock
+ *
+ * When 1, ClockDrift measures the device clock and the AB1805 against each
+ * cloud time sync, corrects Time for the drift between syncs, and
+ * dailyCleanup() only syncs once the predicted error reaches
+ * CLOCK_SYNC_MAX_ERROR_MS or CLOCK_SYNC_MAX_DAYS have passed. When 0 the
+ * clock is synced every day as before. See ClockDrift.h.
+ */
+#ifndef CLOCK_DRIFT_ENABLED
+#define CLOCK_DRIFT_ENABLED 1
+#endif
+
+/** @brief Shortest interval between syncs that measures drift (1 s resolution) */
+#ifndef CLOCK_DRIFT_MIN_HOURS
+#define CLOCK_DRIFT_MIN_HOURS 24
+#endif
+
+/** @brief Uncertainty given to the first drift measurement, ppm */
+#ifndef CLOCK_DRIFT_FIRST_UNCERTAINTY_PPM
+#define CLOCK_DRIFT_FIRST_UNCERTAINTY_PPM 5
+#endif
+
+/** @brief Floor on the drift uncertainty, ppm (temperature moves crystals this much) */
+#ifndef CLOCK_DRIFT_MIN_UNCERTAINTY_PPM
+#define CLOCK_DRIFT_MIN_UNCERTAINTY_PPM 2
+#endif
+
+/** @brief Sync once the predicted clock error reaches this, ms */
+#ifndef CLOCK_SYNC_MAX_ERROR_MS
+#define CLOCK_SYNC_MAX_ERROR_MS 3000
+#endif
+
+/** @brief Sync at least this often regardless of the model, days */
+#ifndef CLOCK_SYNC_MAX_DAYS
+#define CLOCK_SYNC_MAX_DAYS 7
+#endif
+
+/** @brief AB1805 times before this (Unix, 2026-01-01) are not restored at boot */
+#ifndef RTC_MIN_VALID_TIME
+#define RTC_MIN_VALID_TIME 1767225600
+#endif
+
+/**
+ * @brief Estimate daily energy use from time spent in each state
+ *
+ * When 1, EnergyLedger adds up the seconds spent in each State, with the
+ * network up, with the radio powered, with the sensor ready, and asleep in
+ * ULTRA_LOW_POWER and HIBERNATE. dailyCleanup() publishes the breakdown and
+ * the estimated mAh per day as an "energy" event. The estimate uses the
+ * ENERGY_UA_* currents below (microamps; defaults are datasheet-level
+ * figures per platform, override them with bench measurements):
+ * - AWAKE: MCU running, radio off
+ * - MODEM: radio powered, added to AWAKE
+ * - RADIO: network connected, added to AWAKE and MODEM
+ * - SENSOR: sensor powered
+ * - STOP / ULP / HIBERNATE: whole device asleep (STOP naps are counted
+ *   with ULP; STOP is only used for SleepPlanner's estimate)
+ */
+#ifndef ENERGY_LEDGER_ENABLED
+#define ENERGY_LEDGER_ENABLED 1
+#endif
+
+#if defined(PLATFORM_BORON) && PLATFORM_ID == PLATFORM_BORON
+#ifndef ENERGY_UA_AWAKE
+#define ENERGY_UA_AWAKE 6000
+#endif
+#ifndef ENERGY_UA_MODEM
+#define ENERGY_UA_MODEM 15000
+#endif
+#ifndef ENERGY_UA_RADIO
+#define ENERGY_UA_RADIO 40000
+#endif
+#ifndef ENERGY_UA_STOP
+#define ENERGY_UA_STOP 900
+#endif
+#ifndef ENERGY_UA_ULP
+#define ENERGY_UA_ULP 600
+#endif
+#ifndef ENERGY_UA_HIBERNATE
+#define ENERGY_UA_HIBERNATE 100
+#endif
+#else   // P2 / Photon 2
+#ifndef ENERGY_UA_AWAKE
+#define ENERGY_UA_AWAKE 30000
+#endif
+#ifndef ENERGY_UA_MODEM
+#define ENERGY_UA_MODEM 20000
+#endif
+#ifndef ENERGY_UA_RADIO
+#define ENERGY_UA_RADIO 50000
+#endif
+#ifndef ENERGY_UA_STOP
+#define ENERGY_UA_STOP 1000
+#endif
+#ifndef ENERGY_UA_ULP
+#define ENERGY_UA_ULP 700
+#endif
+#ifndef ENERGY_UA_HIBERNATE
+#define ENERGY_UA_HIBERNATE 100
+#endif
+#endif
+
+#ifndef ENERGY_UA_SENSOR
+#define ENERGY_UA_SENSOR 5000
+#endif
+
+/** @brief Current of one indicator LED, sensor board or BLUE_LED (PowerDomains). */
+#ifndef ENERGY_UA_LED
+#define ENERGY_UA_LED 2000
+#endif
+
+/** @brief Current of the fusion range finder while powered (PowerDomains::RANGE). */
+#ifndef ENERGY_UA_RANGE
+#define ENERGY_UA_RANGE 3000
+#endif
+
+/**
+ * @brief How often EnergyLedger folds its RAM totals into current.dat while awake
+ *
+ * Also done before every sleep and at dailyCleanup().
+ */
+#ifndef ENERGY_CHECKPOINT_SEC
+#define ENERGY_CHECKPOINT_SEC 900
+#endif
+
+/**
+ * @brief Count cloud data use by category
+ *
+ * When 1, DataUsage adds up the bytes each kind of traffic costs: webhook
+ * reports, device-status, device-data and settings ledger syncs,
+ * diagnostics, startup status, OTA, time sync and cloud sessions. The day's
+ * totals are folded with the energy ledger and published in the daily
+ * "energy" event under "bytes". Payloads are counted as sent; protocol
+ * overhead is estimated from these figures, so the totals rank the
+ * categories rather than reproduce a carrier bill. Calibrate them against
+ * the carrier's usage for a day with a known number of connects:
+ * - MESSAGE_OVERHEAD: one CoAP message and its acknowledgement, with
+ *   IPv4/UDP headers, DTLS record header and AEAD tag, CoAP header and token
+ * - SESSION_BYTES: a DTLS session resume and the hello and describe exchange
+ * - OTA_BYTES: one firmware update, about the size of the application binary
+ */
+#ifndef DATA_USAGE_ENABLED
+#define DATA_USAGE_ENABLED 1
+#endif
+
+#ifndef DATA_USAGE_MESSAGE_OVERHEAD
+#define DATA_USAGE_MESSAGE_OVERHEAD 130
+#endif
+
+#ifndef DATA_USAGE_SESSION_BYTES
+#define DATA_USAGE_SESSION_BYTES 1500
+#endif
+
+#ifndef DATA_USAGE_OTA_BYTES
+#define DATA_USAGE_OTA_BYTES 200000
+#endif
+
+/**
+ * @brief Back off reporting as the battery runs down
+ *
+ * When 1, PowerGovernor picks a tier from the battery SoC and its daily
+ * trend, up to the ledger's power.maxGovernorTier:
+ * - 0: configured operatingMode and reportingIntervalSec
+ * - 1: LOW_POWER, reporting at least hourly
+ * - 2: LOW_POWER, reporting at least every POWER_GOV_TIER2_INTERVAL_SEC
+ * - 3: store only (sysStatus lowBatteryMode); counts and reports are queued
+ *      and the device connects once every POWER_GOV_CHECKIN_HOURS as a
+ *      heartbeat that sends the queue, with no ledger syncs and no OTA
+ * A tier is entered when SoC drops below its POWER_GOV_SOC_TIER* threshold,
+ * or one tier early while SoC is falling day over day without charging.
+ * It is left one tier per day, and only once SoC is POWER_GOV_HYSTERESIS
+ * points above the threshold and no longer falling; store-only is left for
+ * tier 2 at once when the battery charges past that point.
+ */
+#ifndef POWER_GOVERNOR_ENABLED
+#define POWER_GOVERNOR_ENABLED 1
+#endif
+
+#ifndef POWER_GOV_SOC_TIER1
+#define POWER_GOV_SOC_TIER1 60
+#endif
+
+#ifndef POWER_GOV_SOC_TIER2
+#define POWER_GOV_SOC_TIER2 40
+#endif
+
+#ifndef POWER_GOV_SOC_TIER3
+#define POWER_GOV_SOC_TIER3 25
+#endif
+
+#ifndef POWER_GOV_HYSTERESIS
+#define POWER_GOV_HYSTERESIS 10
+#endif
+
+#ifndef POWER_GOV_TIER2_INTERVAL_SEC
+#define POWER_GOV_TIER2_INTERVAL_SEC 10800
+#endif
+
+#ifndef POWER_GOV_CHECKIN_HOURS
+#define POWER_GOV_CHECKIN_HOURS 24
+#endif
+
+/**
+ * @brief Spread fleet wakes after each reporting boundary
+ *
+ * Low-power naps wake at the boundary plus a per-device offset in
+ * [0, WAKE_JITTER_WINDOW_SEC), hashed from the device ID, instead of all at
+ * boundary + 1 s. Capped at half the boundary; 0 disables. Report
+ * timestamps stay on the boundary.
+ */
+#ifndef WAKE_JITTER_WINDOW_SEC
+#define WAKE_JITTER_WINDOW_SEC 300
+#endif
+
+/**
+ * @brief Site connect slots in place of the jitter (ReportSlot.h)
+ *
+ * With timing.slotCount and timing.slotIndex set in the device-settings
+ * ledger, low-power naps wake at boundary + slotIndex × slotWidthSec
+ * instead, and report connects that start outside the slot are counted as
+ * misses. REPORT_SLOT_WIDTH_SEC is the product default width.
+ */
+#ifndef REPORT_SLOTS_ENABLED
+#define REPORT_SLOTS_ENABLED 1
+#endif
+
+#ifndef REPORT_SLOT_WIDTH_SEC
+#define REPORT_SLOT_WIDTH_SEC 30
+#endif
+
+/**
+ * @brief Learned margin on boundary naps (WakeAccuracy.h)
+ *
+ * Each boundary nap is programmed from the absolute wake time just before
+ * System.sleep(), plus a per-device correction kept in sysStatus. It starts
+ * at WAKE_CORRECTION_INITIAL_MS (the former fixed +1 s). A timer wake
+ * before the boundary raises it by the shortfall plus a second, up to
+ * WAKE_CORRECTION_MAX_MS; a wake 2 s or more late lowers it by
+ * WAKE_CORRECTION_TRIM_MS. Early wakes cost a second boot-log-sleep cycle,
+ * late ones only delay the report, so it errs late. 0 for
+ * WAKE_ACCURACY_ENABLED keeps the fixed margin.
+ */
+#ifndef WAKE_ACCURACY_ENABLED
+#define WAKE_ACCURACY_ENABLED 1
+#endif
+
+#ifndef WAKE_CORRECTION_INITIAL_MS
+#define WAKE_CORRECTION_INITIAL_MS 1000
+#endif
+
+#ifndef WAKE_CORRECTION_MAX_MS
+#define WAKE_CORRECTION_MAX_MS 10000
+#endif
+
+#ifndef WAKE_CORRECTION_TRIM_MS
+#define WAKE_CORRECTION_TRIM_MS 250
+#endif
+
+/**
+ * @brief Choose STOP, ULTRA_LOW_POWER or HIBERNATE per nap by estimated energy
+ *
+ * When 1, SleepPlanner compares each mode's sleep current (ENERGY_UA_*) over
+ * the nap plus the awake time of every expected wake: SLEEP_WAKE_MS_STOP or
+ * SLEEP_WAKE_MS_ULP, or for HIBERNATE the measured boot time (at least
+ * SLEEP_WAKE_MS_HIBERNATE). Expected wakes are the timer wake plus the recent
+ * PIR wake rate over the nap. When 0, HIBERNATE is used outside opening
+ * hours and ULTRA_LOW_POWER otherwise.
+ */
+#ifndef SLEEP_PLANNER_ENABLED
+#define SLEEP_PLANNER_ENABLED 1
+#endif
+
+#ifndef SLEEP_WAKE_MS_STOP
+#define SLEEP_WAKE_MS_STOP 200
+#endif
+
+#ifndef SLEEP_WAKE_MS_ULP
+#define SLEEP_WAKE_MS_ULP 1000
+#endif
+
+#ifndef SLEEP_WAKE_MS_HIBERNATE
+#define SLEEP_WAKE_MS_HIBERNATE 4000
+#endif
+
+/**
+ * @brief Stay awake through busy spells instead of napping between events
+ *
+ * When 1, SleepPlanner keeps an event rate (per hour, decayed over
+ * STAY_AWAKE_WINDOW_SEC) from every counted or occupancy event. While it is
+ * above the crossover, LOW_POWER and DISCONNECTED devices stay in IDLE with
+ * the sensor interrupt attached instead of taking a nap per event; once it
+ * drops below, timer naps resume. The crossover is where the awake current
+ * (ENERGY_UA_AWAKE) costs as much as napping in ULTRA_LOW_POWER and paying
+ * for each wake: SLEEP_WAKE_MS_ULP plus the measured awake time after a PIR
+ * wake. STAY_AWAKE_CROSSOVER_PER_HOUR overrides it with a bench figure.
+ * Awake mode is entered STAY_AWAKE_HYSTERESIS_PCT above the crossover and
+ * left the same percentage below it.
+ */
+#ifndef STAY_AWAKE_ENABLED
+#define STAY_AWAKE_ENABLED 1
+#endif
+
+#ifndef STAY_AWAKE_WINDOW_SEC
+#define STAY_AWAKE_WINDOW_SEC 300
+#endif
+
+#ifndef STAY_AWAKE_CROSSOVER_PER_HOUR
+#define STAY_AWAKE_CROSSOVER_PER_HOUR 0
+#endif
+
+#ifndef STAY_AWAKE_HYSTERESIS_PCT
+#define STAY_AWAKE_HYSTERESIS_PCT 20
+#endif
+
+/**
+ * @brief Power down through the AB1805 for the whole closed period
+ *
+ * When 1, a night sleep of at least NIGHT_DEEP_POWER_DOWN_MIN_SEC sets an
+ * AB1805 alarm at the next opening time and puts the RTC in sleep mode,
+ * which removes power from the device. This avoids the 546-minute Device
+ * OS sleep limit and its extra overnight wake. Requires valid time and a
+ * set RTC, which restores system time on the next boot. If the power-down
+ * does not happen, the night falls back to Device OS sleep for the session.
+ * Only the AB1805 alarm is armed to end the power-down.
+ */
+#ifndef NIGHT_DEEP_POWER_DOWN
+#define NIGHT_DEEP_POWER_DOWN 1
+#endif
+
+#ifndef NIGHT_DEEP_POWER_DOWN_MIN_SEC
+#define NIGHT_DEEP_POWER_DOWN_MIN_SEC 3600
+#endif
+
+/**
+ * @brief Preallocated publish queue events.
+ *
+ * When 1, events held in RAM by the publish queue come from fixed blocks
+ * allocated once in setup() (PublishQueuePosix::withEventPool()) instead
+ * of a heap allocation per publish and per read from flash, so heap use
+ * stays flat over months of uptime. device-status reports the peak blocks
+ * in use and any allocations that still went to the heap.
+ */
+#ifndef PUBLISH_EVENT_POOL
+#define PUBLISH_EVENT_POOL 1
+#endif
+
+/**
+ * @brief Pack queued event data on flash with a dictionary of report keys.
+ *
+ * When 1, the publish queue stores each occurrence of a string from
+ * ProjectConfig::payloadDictionary() (the JSON keys of the hourly and daily
+ * reports, battery states) as one byte, so a long outage's backlog takes
+ * roughly half the flash and wear. Events are unpacked when read back from
+ * flash; what is published is unchanged.
+ */
+#ifndef PUBLISH_PACKED_PAYLOADS
+#define PUBLISH_PACKED_PAYLOADS 1
+#endif
+
+/**
+ * @brief Publish queue events awaiting cloud acknowledgement at once.
+ *
+ * After a reconnect the backlog is sent with up to this many publishes
+ * outstanding, started one second apart to stay within the Device OS rate
+ * limit, instead of waiting a full round trip for each. On a slow LTE-M
+ * link that shortens the time the modem stays up draining the queue.
+ * 1 publishes strictly one at a time; the maximum is 4.
+ */
+#ifndef PUBLISH_IN_FLIGHT_WINDOW
+#define PUBLISH_IN_FLIGHT_WINDOW 3
+#endif
+
+/**
+ * @brief Flash work done by one publish queue call (withStorageBudget())
+ *
+ * Moving a long RAM or retained queue to flash, or discarding and
+ * compacting a full store, stops after this many events or milliseconds
+ * and the queue's loop() carries on from there, so a full flash never
+ * holds up sensor servicing or comes near the application watchdog. The
+ * longest call is "sto" in the queueMetrics variable. The flush before a
+ * sleep that loses RAM always finishes. 0 means no limit.
+ */
+#ifndef PUBLISH_STORAGE_BUDGET_EVENTS
+#define PUBLISH_STORAGE_BUDGET_EVENTS 16
+#endif
+#ifndef PUBLISH_STORAGE_BUDGET_MS
+#define PUBLISH_STORAGE_BUDGET_MS 50
+#endif
+
+/**
+ * @brief Battery level below which a backlog is not chased to the end.
+ *
+ * In LOW_POWER and DISCONNECTED modes, when the publish queue's drain
+ * estimate (PublishQueuePosix::getEstimatedDrainMs()) is longer than what
+ * is left of connectAttemptBudgetSec and state of charge is below this
+ * percentage, the device sleeps now and sends the rest on the next wake
+ * instead of holding the radio on for a drain that will not finish. At or
+ * above it, the whole budget is used to make progress.
+ */
+#ifndef QUEUE_DRAIN_PARTIAL_SOC
+#define QUEUE_DRAIN_PARTIAL_SOC 50
+#endif
+
+/**
+ * @brief Hours between queueMetrics summary events (0 = off).
+ *
+ * The publish queue's counters and latency histograms are always readable
+ * from the queueMetrics cloud variable. When this is non-zero, the report
+ * state also queues the same JSON as a queueMetrics event on the
+ * diagnostic lane this often, so a fleet can be compared without polling
+ * each device. Used to tune the RAM and file queue sizes per deployment.
+ */
+#ifndef QUEUE_METRICS_EVENT_HOURS
+#define QUEUE_METRICS_EVENT_HOURS 0
+#endif
+
+/**
+ * @brief Compact hourly report encoding.
+ *
+ * When 1, publishData() sends the hourly report as base64 of an 18-byte
+ * versioned binary record (CompactReport) on
+ * ProjectConfig::webhookCompactEventName() instead of the ~200-byte JSON.
+ * Needs the cloud-side decoder described in docs/webhooks/README.md, and
+ * compact reports are not coalesced. Off by default.
+ */
+#ifndef PUBLISH_COMPACT_REPORT
+#define PUBLISH_COMPACT_REPORT 0
+#endif
+
+/**
+ * @brief Boot information in the next report instead of a "status" event
+ *
+ * When 1, a boot after a routine reset (a wake from HIBERNATE or an OTA
+ * update) with no alert active queues no "status" event. The next JSON
+ * hourly report carries the same fields as a "boot" object, and that
+ * report is not suppressed as unchanged; with ledger-only delivery the
+ * device-data ledger's resetReason covers it. Any other reset reason, or
+ * an active alert, still gets its own "status" event at once. Has no
+ * effect with PUBLISH_COMPACT_REPORT.
+ */
+#ifndef STARTUP_STATUS_PIGGYBACK
+#define STARTUP_STATUS_PIGGYBACK 1
+#endif
+
+/**
+ * @brief Field layout of the JSON hourly report, for messaging.reportFields
+ *
+ * Bit N of the messaging.reportFields setting sends field N of
+ * publishData()'s report schema: hourly, daily, battery, key1, temp,
+ * resets, alerts, connecttime, bins, timestamp, sensors, samples,
+ * alertList, seq, dir, buckets, people, boot, then occSec (occupied
+ * seconds today) and signal (strength percent at the last connect), which
+ * are off by default. A new field only ever takes the next bit; anything
+ * else is a new REPORT_SCHEMA_VERSION. A reportFields written for another
+ * version (messaging.reportSchema) is ignored and the default set sent.
+ * timestamp, seq and boot are always sent. A report with a set other than
+ * REPORT_FIELDS_DEFAULT carries "schema" and "fields" so the integration
+ * can tell what it got. JSON reports only, not PUBLISH_COMPACT_REPORT.
+ */
+#ifndef REPORT_SCHEMA_VERSION
+#define REPORT_SCHEMA_VERSION 1
+#endif
+
+/** @brief Fields sent unless messaging.reportFields says otherwise: all but occSec and signal */
+#ifndef REPORT_FIELDS_DEFAULT
+#define REPORT_FIELDS_DEFAULT 0x3FFFFUL
+#endif
+
+/**
+ * @brief Packed history backfill encoding.
+ *
+ * When 1, HourlyHistory publishes backfill as {"p":"<base64>"} "history"
+ * events in the delta-of-delta encoding of HistoryPack.h, about four days of
+ * hours per event, instead of JSON arrays of 12 records. Needs the decoder in
+ * docs/webhooks/README.md. Resends of unconfirmed reports (ReportTracker)
+ * stay JSON.
+ */
+#ifndef HISTORY_PACKED_BACKFILL
+#define HISTORY_PACKED_BACKFILL 1
+#endif
+
+/**
+ * @brief Intra-hour count bins.
+ *
+ * When 1, each count is also added to one of twelve 5-minute bins for the
+ * hour (CurrentData countBins, saturating at 255), and the hourly report
+ * carries them as "bins": 16 characters of base64 of the 12 bytes, slot
+ * 00-05 first. The compact report becomes version 2 with the bins appended.
+ * Off by default, so the report stays as the existing webhooks expect.
+ */
+#ifndef COUNT_BINS_ENABLED
+#define COUNT_BINS_ENABLED 0
+#endif
+
+/**
+ * @brief Learned traffic baselines (TrafficBaseline.h).
+ *
+ * Counting mode keeps a mean and deviation of the hourly count for each
+ * local hour of the week in /usr/baseline.dat. After BASELINE_MIN_WEEKS
+ * samples of a slot, BASELINE_QUIET_HOURS zero-count hours in a row where
+ * the mean is at least BASELINE_BUSY_MEAN raise alert 25 (dead or blocked
+ * sensor), and a count over mean + BASELINE_SPIKE_DEVS deviations (and at
+ * least BASELINE_SPIKE_FLOOR over the mean) raises alert 26.
+ */
+#ifndef TRAFFIC_BASELINE_ENABLED
+#define TRAFFIC_BASELINE_ENABLED 1
+#endif
+
+#ifndef BASELINE_MIN_WEEKS
+#define BASELINE_MIN_WEEKS 3
+#endif
+
+#ifndef BASELINE_BUSY_MEAN
+#define BASELINE_BUSY_MEAN 5
+#endif
+
+#ifndef BASELINE_QUIET_HOURS
+#define BASELINE_QUIET_HOURS 6
+#endif
+
+#ifndef BASELINE_SPIKE_DEVS
+#define BASELINE_SPIKE_DEVS 6
+#endif
+
+#ifndef BASELINE_SPIKE_FLOOR
+#define BASELINE_SPIKE_FLOOR 30
+#endif
+
+/**
+ * @brief Event filter auto-tuning (AutoTune.h).
+ *
+ * With the ledger's sensor.autoTune on, each full counted hour is judged
+ * from the event filter's retrigger and chatter counts, the range finder's
+ * rejections (FUSION_RANGE_CM) and the TrafficBaseline slot. After
+ * AUTO_TUNE_HOURS hours in a row pointing the same way, refractoryMs or
+ * debounceMs moves one step (AUTO_TUNE_REFRACTORY_STEP_MS,
+ * AUTO_TUNE_DEBOUNCE_STEP_MS) within the ledger's tune bounds, whose
+ * product defaults are the AUTO_TUNE_MIN/MAX values. Hours with fewer than
+ * AUTO_TUNE_MIN_EVENTS accepted events are not judged.
+ */
+#ifndef AUTO_TUNE_ENABLED
+#define AUTO_TUNE_ENABLED 1
+#endif
+
+#ifndef AUTO_TUNE_HOURS
+#define AUTO_TUNE_HOURS 3
+#endif
+
+#ifndef AUTO_TUNE_MIN_EVENTS
+#define AUTO_TUNE_MIN_EVENTS 20
+#endif
+
+// An accepted event this soon after the refractory or debounce time ends is a retrigger or chatter
+#ifndef AUTO_TUNE_RETRIGGER_MS
+#define AUTO_TUNE_RETRIGGER_MS 1000
+#endif
+
+#ifndef AUTO_TUNE_CHATTER_MS
+#define AUTO_TUNE_CHATTER_MS 100
+#endif
+
+// Percent of accepted events: at or above HIGH votes to tighten; at or below LOW allows loosening
+#ifndef AUTO_TUNE_RETRIGGER_HIGH_PCT
+#define AUTO_TUNE_RETRIGGER_HIGH_PCT 40
+#endif
+
+#ifndef AUTO_TUNE_RETRIGGER_LOW_PCT
+#define AUTO_TUNE_RETRIGGER_LOW_PCT 10
+#endif
+
+#ifndef AUTO_TUNE_CHATTER_HIGH_PCT
+#define AUTO_TUNE_CHATTER_HIGH_PCT 20
+#endif
+
+// Percent of range-checked events the range finder rejected that votes to tighten
+#ifndef AUTO_TUNE_FUSION_REJECT_PCT
+#define AUTO_TUNE_FUSION_REJECT_PCT 30
+#endif
+
+#ifndef AUTO_TUNE_REFRACTORY_STEP_MS
+#define AUTO_TUNE_REFRACTORY_STEP_MS 250
+#endif
+
+#ifndef AUTO_TUNE_DEBOUNCE_STEP_MS
+#define AUTO_TUNE_DEBOUNCE_STEP_MS 25
+#endif
+
+#ifndef AUTO_TUNE_MIN_REFRACTORY_MS
+#define AUTO_TUNE_MIN_REFRACTORY_MS 250
+#endif
+
+#ifndef AUTO_TUNE_MAX_REFRACTORY_MS
+#define AUTO_TUNE_MAX_REFRACTORY_MS 3000
+#endif
+
+#ifndef AUTO_TUNE_MAX_DEBOUNCE_MS
+#define AUTO_TUNE_MAX_DEBOUNCE_MS 200
+#endif
+
+/**
+ * @brief Tear the connection down without a graceful cloud close when nothing is queued.
+ *
+ * When 1 and the publish queue is empty and sleep-safe at the sleep
+ * disconnect, the cloud session is closed without waiting for the server
+ * (CloudDisconnectOptions::graceful(false)) while the radio is powered
+ * off, so the modem is not kept on for a close that protects nothing.
+ * With events still queued the graceful close is kept. Either way the
+ * cloud, network and modem-off times are logged (ConnectCache).
+ */
+#ifndef SLEEP_FAST_TEARDOWN
+#define SLEEP_FAST_TEARDOWN 1
+#endif
+
+/**
+ * @brief Shortest live count window, in seconds.
+ *
+ * sysStatus liveCountSec (ledger modes.liveCountSec) below this is raised
+ * to it, keeping LiveCount well inside the Device OS publish rate limit.
+ */
+#ifndef LIVE_COUNT_MIN_SEC
+#define LIVE_COUNT_MIN_SEC 10
+#endif
+
+/**
+ * @brief Shortest occupancy change window, in seconds.
+ *
+ * sysStatus occupancyNotifySec (ledger modes.occupancyNotifySec) below
+ * this is raised to it, so a flapping space cannot publish faster.
+ */
+#ifndef OCCUPANCY_NOTIFY_MIN_SEC
+#define OCCUPANCY_NOTIFY_MIN_SEC 5
+#endif
+
+/**
+ * @brief Raw event archive on an SD card (EventArchive.h).
+ *
+ * When 1, every event the mode handlers apply is also written, with its
+ * capture time, to a day file on an SD card on the primary SPI bus (chip
+ * select archiveCsPin), for deployments that need each event and not just
+ * the hourly counts. A writer thread does the card I/O, so loop() never
+ * waits on it. Needs the SdFat library added to project.properties and a
+ * carrier whose SPI pins are not used by the PIR sensor.
+ *
+ * EVENT_ARCHIVE_BLOCKS is the RAM buffer in 512-byte blocks of 31 events;
+ * when the card falls that far behind, new events are dropped and counted.
+ * The block being filled is written every EVENT_ARCHIVE_FLUSH_SEC.
+ */
+#ifndef EVENT_ARCHIVE_ENABLED
+#define EVENT_ARCHIVE_ENABLED 0
+#endif
+
+#ifndef EVENT_ARCHIVE_BLOCKS
+#define EVENT_ARCHIVE_BLOCKS 8
+#endif
+
+#ifndef EVENT_ARCHIVE_FLUSH_SEC
+#define EVENT_ARCHIVE_FLUSH_SEC 30
+#endif
+
+#ifndef EVENT_ARCHIVE_SPI_MHZ
+#define EVENT_ARCHIVE_SPI_MHZ 12
+#endif
+
+#ifndef EVENT_ARCHIVE_STACK
+#define EVENT_ARCHIVE_STACK 3072
+#endif
+
+/**
+ * @brief Bulk upload of the event archive over WiFi (P2).
+ *
+ * When 1, the archive writer also sends the day files to a collector at
+ * EVENT_ARCHIVE_UPLOAD_HOST, EVENT_ARCHIVE_UPLOAD_CHUNK bytes of whole
+ * blocks per HTTP POST to EVENT_ARCHIVE_UPLOAD_PATH with device, day and
+ * offset in the query string; a 2xx reply acknowledges the chunk. This is
+ * far faster than a Particle event per record. Uploads only run while
+ * connected on WiFi at EVENT_ARCHIVE_UPLOAD_MIN_RSSI dBm or better, and in
+ * LOW_POWER or DISCONNECTED mode only within connectAttemptBudgetSec and
+ * above QUEUE_DRAIN_PARTIAL_SOC, like a publish queue drain; they never
+ * keep the device awake. The acknowledged offset is in sysStatus, so an
+ * upload resumes where it stopped. Plain HTTP: point it at a collector on
+ * the site network or a VPN, not the open internet.
+ */
+#ifndef EVENT_ARCHIVE_UPLOAD_ENABLED
+#define EVENT_ARCHIVE_UPLOAD_ENABLED 0
+#endif
+
+#ifndef EVENT_ARCHIVE_UPLOAD_HOST
+#define EVENT_ARCHIVE_UPLOAD_HOST "archive.local"
+#endif
+
+#ifndef EVENT_ARCHIVE_UPLOAD_PORT
+#define EVENT_ARCHIVE_UPLOAD_PORT 80
+#endif
+
+#ifndef EVENT_ARCHIVE_UPLOAD_PATH
+#define EVENT_ARCHIVE_UPLOAD_PATH "/archive"
+#endif
+
+#ifndef EVENT_ARCHIVE_UPLOAD_CHUNK
+#define EVENT_ARCHIVE_UPLOAD_CHUNK 32768
+#endif
+
+#ifndef EVENT_ARCHIVE_UPLOAD_MIN_RSSI
+#define EVENT_ARCHIVE_UPLOAD_MIN_RSSI -70
+#endif
+
+#ifndef EVENT_ARCHIVE_UPLOAD_TIMEOUT_MS
+#define EVENT_ARCHIVE_UPLOAD_TIMEOUT_MS 10000
+#endif
+
+/**
+ * @brief SensorType of a second event sensor counted alongside the primary one (-1 = none)
+ *
+ * Registered by SensorManager::initializeFromConfig() as a counting aux
+ * sensor in slot 1. Its events add to the device's hourly and daily counts
+ * and to its own slot in currentStatusData, which the hourly report carries
+ * as "sensors". It must be a different type from the primary sensor and
+ * use different pins.
+ */
+#ifndef AUX_COUNTING_SENSOR_TYPE
+#define AUX_COUNTING_SENSOR_TYPE -1
+#endif
+
+/**
+ * @brief SensorType of a polled sensor read alongside the primary one (-1 = none)
+ *
+ * Registered by SensorManager::initializeFromConfig() as a polled aux
+ * sensor, after the counting one if both are set, and read every
+ * AUX_POLLED_SENSOR_PERIOD_SEC. Its readings are folded into its slot's
+ * sample aggregate and carried by the hourly report as "samples", as in
+ * SCHEDULED mode. A soil-moisture (20) or distance (21) sensor; it must be
+ * a different type from the primary sensor and use different pins.
+ */
+#ifndef AUX_POLLED_SENSOR_TYPE
+#define AUX_POLLED_SENSOR_TYPE -1
+#endif
+
+/**
+ * @brief Seconds between readings of the AUX_POLLED_SENSOR_TYPE sensor
+ *
+ * Naps in LOW_POWER mode end in time for the next reading, so a short
+ * period costs sleep.
+ */
+#ifndef AUX_POLLED_SENSOR_PERIOD_SEC
+#define AUX_POLLED_SENSOR_PERIOD_SEC 900
+#endif
+
+/**
+ * @brief Warm recoveries ERROR_STATE tries per boot before resetting (0 = always reset)
+ *
+ * A warm recovery restarts only the subsystem behind the alert (the radio
+ * and cloud session, or the sensor) and returns to IDLE, instead of a
+ * System.reset() or AB1805 power cycle and the cold boot that follows.
+ */
+#ifndef WARM_RECOVERY_ATTEMPTS
+#define WARM_RECOVERY_ATTEMPTS 2
+#endif
+
+/**
+ * @brief A recovery followed by the same alert within this many seconds counts as ineffective
+ */
+#ifndef RECOVERY_EFFECTIVE_SEC
+#define RECOVERY_EFFECTIVE_SEC 3600
+#endif
+
+/**
+ * @brief Back off scheduled connects after consecutive connect failures
+ *
+ * After more than CONNECT_BACKOFF_FREE_FAILURES attempts in a row run out
+ * of budget (alert 31), scheduled report connects are skipped, with the
+ * report left queued, for CONNECT_BACKOFF_BASE_SEC, doubling with each
+ * further failure up to CONNECT_BACKOFF_MAX_SEC. A successful connect ends
+ * it. The button still connects. See ConnectHistory.h.
+ */
+#ifndef CONNECT_BACKOFF_ENABLED
+#define CONNECT_BACKOFF_ENABLED 1
+#endif
+
+#ifndef CONNECT_BACKOFF_FREE_FAILURES
+#define CONNECT_BACKOFF_FREE_FAILURES 1
+#endif
+
+#ifndef CONNECT_BACKOFF_BASE_SEC
+#define CONNECT_BACKOFF_BASE_SEC 7200
+#endif
+
+#ifndef CONNECT_BACKOFF_MAX_SEC
+#define CONNECT_BACKOFF_MAX_SEC 86400
+#endif
+
+/**
+ * @brief Cloud drops tolerated between scheduled reports (flap damping).
+ *
+ * A drop is a cloud_status disconnect the firmware did not ask for. After
+ * this many since the last scheduled report the device disconnects, turns
+ * the radio off and makes no connect of its own (surplus drains, CONNECTED
+ * mode reconnects) until the next scheduled report, which starts the count
+ * again. A fringe site then pays for one connect an hour, not a surge of
+ * them. 0 turns damping off; the drops are still counted. See ConnectHistory.h.
+ */
+#ifndef CONNECT_FLAP_LIMIT
+#define CONNECT_FLAP_LIMIT 3
+#endif
+
+/**
+ * @brief Number the hourly reports and resend the ones no webhook response confirms
+ *
+ * Each JSON report carries "seq"; the webhook's response topic echoes it
+ * back. Reports still unconfirmed REPORT_ACK_WAIT_SEC after the publish
+ * queue drains are resent once from HourlyHistory as a "history" event.
+ * A low-power device stays connected that long for the responses. Not
+ * used with PUBLISH_COMPACT_REPORT. See ReportTracker.h.
+ */
+#ifndef REPORT_ACK_TRACKING
+#define REPORT_ACK_TRACKING 1
+#endif
+
+#ifndef REPORT_ACK_WAIT_SEC
+#define REPORT_ACK_WAIT_SEC 10
+#endif
+
+/**
+ * @brief Least time between device-data ledger writes requested by a connect, in minutes
+ *
+ * A connect that is not for a report (button, open-hours wake) refreshes
+ * device-data so Console shows current values, unless a report or another
+ * connect already did within this time. Not used when dataDelivery is
+ * webhook only.
+ */
+#ifndef DATA_LEDGER_CONNECT_MIN
+#define DATA_LEDGER_CONNECT_MIN 60
+#endif
+
+/**
+ * @brief Least time between device-status diagnostics refreshes, in minutes
+ *
+ * Each report marks device-status; its diagnostics (storage, connect, loop,
+ * heap, stacks, rtc, ...) are rewritten when this long has passed since the
+ * last refresh, or with any configuration change. A report with unchanged
+ * configuration and recent diagnostics writes nothing.
+ */
+#ifndef DEVICE_STATUS_DIAG_MIN
+#define DEVICE_STATUS_DIAG_MIN 60
+#endif
+
+/**
+ * @brief Diagnostic events allowed per hour, in all and per event name
+ *
+ * publishDiagnosticSafe() drops what is over either budget, and sends only
+ * every DIAG_REPEAT_SAMPLE-th of a message identical to the last one of
+ * its name. An hourly "diagSuppressed" event counts what was dropped. See
+ * DiagnosticBudget.h.
+ */
+#ifndef DIAG_BUDGET_PER_HOUR
+#define DIAG_BUDGET_PER_HOUR 20
+#endif
+
+#ifndef DIAG_TYPE_BUDGET_PER_HOUR
+#define DIAG_TYPE_BUDGET_PER_HOUR 6
+#endif
+
+#ifndef DIAG_REPEAT_SAMPLE
+#define DIAG_REPEAT_SAMPLE 10
+#endif
+
+/**
+ * @brief Extra connects to send a backlog on surplus power
+ *
+ * In LOW_POWER, while the battery is charging (or charged) at or above
+ * SURPLUS_DRAIN_SOC percent and at least SURPLUS_DRAIN_MIN_EVENTS events
+ * are queued, the device connects to drain them every SURPLUS_DRAIN_GAP_SEC
+ * instead of waiting for the next scheduled report. On solar that is the
+ * middle of the day, so radio time comes out of the surplus rather than
+ * the night reserve. See PowerGovernor::surplusDrainDue().
+ */
+#ifndef SURPLUS_DRAIN_ENABLED
+#define SURPLUS_DRAIN_ENABLED 1
+#endif
+
+#ifndef SURPLUS_DRAIN_SOC
+#define SURPLUS_DRAIN_SOC 80
+#endif
+
+#ifndef SURPLUS_DRAIN_MIN_EVENTS
+#define SURPLUS_DRAIN_MIN_EVENTS 2
+#endif
+
+#ifndef SURPLUS_DRAIN_GAP_SEC
+#define SURPLUS_DRAIN_GAP_SEC 1800
+#endif
+
+/**
+ * @brief Defer report connects while the enclosure is too cold for the battery
+ *
+ * A cold LiPo sags under modem transmit current, which browns the device
+ * out and can leave it in a reset loop. Below COLD_DEFER_BELOW_C a
+ * scheduled report (or surplus drain) in LOW_POWER leaves the report
+ * queued and does not connect; the first report after it warms up sends
+ * the backlog. After COLD_DEFER_MAX_HOURS of deferring the next report
+ * connects regardless. The button still connects. Only with a battery
+ * the fuel gauge can see. See PowerGovernor::coldDeferral().
+ */
+#ifndef COLD_DEFER_ENABLED
+#define COLD_DEFER_ENABLED 1
+#endif
+
+#ifndef COLD_DEFER_BELOW_C
+#define COLD_DEFER_BELOW_C -10
+#endif
+
+#ifndef COLD_DEFER_MAX_HOURS
+#define COLD_DEFER_MAX_HOURS 24
+#endif
+
+/**
+ * @brief Save the counters before the radio draws current, and hold it off
+ *        on a failing battery
+ *
+ * A weak LiPo can brown out in a modem transmit burst, losing the counts
+ * held in RAM and retained memory since the last checkpoint. With this set
+ * every radio power-up (connect or prewarm) first checkpoints current and
+ * sysStatus to flash. A low_battery system event (fuel gauge alert), or a
+ * battery under BROWNOUT_HOLD_SOC and not charging, checkpoints at once
+ * and holds the radio off: a connected device disconnects and scheduled
+ * reports stay queued. The hold ends at BROWNOUT_RELEASE_SOC, on charging,
+ * or after BROWNOUT_HOLD_MAX_HOURS. The button still connects (a second
+ * press, with BLE_READOUT_ENABLED). See BrownoutGuard.h.
+ */
+#ifndef BROWNOUT_GUARD_ENABLED
+#define BROWNOUT_GUARD_ENABLED 1
+#endif
+
+#ifndef BROWNOUT_HOLD_SOC
+#define BROWNOUT_HOLD_SOC 8
+#endif
+
+#ifndef BROWNOUT_RELEASE_SOC
+#define BROWNOUT_RELEASE_SOC 15
+#endif
+
+#ifndef BROWNOUT_HOLD_MAX_HOURS
+#define BROWNOUT_HOLD_MAX_HOURS 24
+#endif
+
+/**
+ * @brief BLE readout for site visits instead of a cellular session
+ *
+ * With this set, on a platform with BLE, a button press no longer connects
+ * the cloud: it opens a BLE window advertising every
+ * BLE_READOUT_ADVERTISE_MS, where a phone can read the metrics snapshot,
+ * the last BLE_READOUT_HISTORY_HOURS hourly records and the alert bitmap,
+ * and send a "config" batch command. The device stays awake until
+ * BLE_READOUT_WINDOW_SEC pass with no command. A second press while the
+ * window is open connects as before. See BleReadout.h.
+ */
+#ifndef BLE_READOUT_ENABLED
+#define BLE_READOUT_ENABLED 1
+#endif
+
+#ifndef BLE_READOUT_WINDOW_SEC
+#define BLE_READOUT_WINDOW_SEC 300
+#endif
+
+#ifndef BLE_READOUT_ADVERTISE_MS
+#define BLE_READOUT_ADVERTISE_MS 1000
+#endif
+
+#ifndef BLE_READOUT_HISTORY_HOURS
+#define BLE_READOUT_HISTORY_HOURS 24
+#endif
+
+/**
+ * @brief Heap monitor sampling and warning thresholds
+ *
+ * HeapMonitor samples the free heap and the largest free block every
+ * HEAP_SAMPLE_SEC and raises alert 13 (minor) below HEAP_WARN_BYTES free,
+ * below HEAP_WARN_BLOCK_BYTES in one block, or when the hourly trend
+ * would use up what is free within HEAP_WARN_HOURS. Well before an
+ * allocation fails and alert 14 resets the device.
+ */
+#ifndef HEAP_SAMPLE_SEC
+#define HEAP_SAMPLE_SEC 60
+#endif
+
+#ifndef HEAP_WARN_BYTES
+#define HEAP_WARN_BYTES 20000
+#endif
+
+#ifndef HEAP_WARN_BLOCK_BYTES
+#define HEAP_WARN_BLOCK_BYTES 4096
+#endif
+
+#ifndef HEAP_WARN_HOURS
+#define HEAP_WARN_HOURS 48
+#endif
+
+/**
+ * @brief Stack high-water marks
+ *
+ * StackMonitor paints the application, sensor, event archive and publish
+ * thread stacks at start and reports the bytes each has never used as
+ * "stacks" in device-status. APP_THREAD_STACK is the Device OS application
+ * thread stack; PUBLISH_THREAD_STACK is given to BackgroundPublishRK.
+ * STACK_PAINT_RESERVE is left unpainted at the top of each stack for what
+ * the thread used before it was painted.
+ */
+#ifndef STACK_MONITOR_ENABLED
+#define STACK_MONITOR_ENABLED 1
+#endif
+
+#ifndef APP_THREAD_STACK
+#define APP_THREAD_STACK 6144
+#endif
+
+#ifndef PUBLISH_THREAD_STACK
+#define PUBLISH_THREAD_STACK 3072
+#endif
+
+#ifndef STACK_PAINT_RESERVE
+#define STACK_PAINT_RESERVE 512
+#endif
+
+/**
+ * @brief Retained RAM tier for the publish queue
+ *
+ * When 1, events that cannot stay in the publish queue's RAM queue
+ * (offline, or more than it holds) go to a PUBLISH_RETAINED_QUEUE_BYTES
+ * retained buffer instead of flash (PublishQueuePosix::withRetainedQueue()),
+ * and are sent from there on the next connect. An offline report before
+ * an ULTRA_LOW_POWER nap then costs no file write. The buffer spills to
+ * flash when full, on reset, and before HIBERNATE or an AB1805 power-down.
+ * Retained RAM is about 3 KB in all, shared with the trace ring and the
+ * retained counters; 1 KB holds about four hourly reports.
+ */
+#ifndef PUBLISH_RETAINED_QUEUE
+#define PUBLISH_RETAINED_QUEUE 1
+#endif
+
+#ifndef PUBLISH_RETAINED_QUEUE_BYTES
+#define PUBLISH_RETAINED_QUEUE_BYTES 1024
+#endif
+
+/**
+ * @brief Publish queue RAM queue that grows while connected
+ *
+ * The RAM queue holds 2 events. With PUBLISH_ADAPTIVE_RAM_QUEUE it grows
+ * by one for each successful publish after a connect, up to
+ * PUBLISH_RAM_QUEUE_MAX, so a burst of diagnostics and reports while the
+ * queue is draining is not written out (PublishQueuePosix::
+ * withAdaptiveRamQueue()). Below PUBLISH_RAM_QUEUE_MIN_FREE bytes of free
+ * heap, a failed publish, or offline it falls back to 2, 2 and 0. The
+ * event pool is sized for the larger queue. queueMetrics reports the
+ * events that still went to flash ("spill", and per hour of uptime).
+ */
+#ifndef PUBLISH_ADAPTIVE_RAM_QUEUE
+#define PUBLISH_ADAPTIVE_RAM_QUEUE 1
+#endif
+
+#ifndef PUBLISH_RAM_QUEUE_MAX
+#define PUBLISH_RAM_QUEUE_MAX 6
+#endif
+
+#ifndef PUBLISH_RAM_QUEUE_MIN_FREE
+#define PUBLISH_RAM_QUEUE_MIN_FREE 40000
+#endif
+
+/**
+ * @brief Indicator LEDs
+ *
+ * With INDICATOR_LEDS the sensor board LED is on while the sensor is, and
+ * BLUE_LED shows startup, occupancy, sensor wakes and counts. Without it
+ * (production) both stay dark; INDICATOR_BLINK_ON_COUNT still blinks
+ * BLUE_LED for each count, for checking an installation.
+ */
+#ifndef INDICATOR_LEDS
+#define INDICATOR_LEDS 0
+#endif
+
+#ifndef INDICATOR_BLINK_ON_COUNT
+#define INDICATOR_BLINK_ON_COUNT 0
+#endif
+
+/**
+ * @brief Power the radio at the start of a report wake
+ *
+ * When 1, REPORTING_STATE turns the radio on and starts network
+ * registration before it measures and builds the report, if the report
+ * is likely to connect (not store-only, backing off or cold-deferred, by
+ * the values the last cycle left). The seconds of modem power-up and
+ * registration then overlap the report work instead of following it. If
+ * the fresh readings decide against connecting, the radio is turned off
+ * again; otherwise CONNECTING_STATE times the connect from the power-up.
+ */
+#ifndef REPORT_RADIO_PREWARM
+#define REPORT_RADIO_PREWARM 1
+#endif
 
 #endif /* CONFIG_H */
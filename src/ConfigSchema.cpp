@@ -0,0 +1,441 @@
+#include "ConfigSchema.h"
+#include "Config.h"
+#include "MyPersistentData.h"
+#include "OpenHours.h"
+#include "PowerGovernor.h"
+#include "PowerPolicy.h"
+#include <stdlib.h>
+#include <string.h>
+
+namespace ConfigSchema {
+
+// Product defaults for thresholds match the fallback used by
+// Cloud::mergeConfiguration() when neither ledger sets them.
+constexpr Field FIELDS[] = {
+    // sensor
+    {"sensor", "threshold1", Type::INT, APPLY | STATUS, 0, 100, 60,
+        []() -> int32_t { return sensorConfig.get_threshold1(); },
+        [](int32_t v) { sensorConfig.set_threshold1((uint16_t)v); }, nullptr, nullptr},
+    {"sensor", "threshold2", Type::INT, APPLY | STATUS, 0, 100, 60,
+        []() -> int32_t { return sensorConfig.get_threshold2(); },
+        [](int32_t v) { sensorConfig.set_threshold2((uint16_t)v); }, nullptr, nullptr},
+    {"sensor", "debounceMs", Type::INT, APPLY | STATUS, 0, 10000, 0,
+        []() -> int32_t { return sensorConfig.get_debounceMs(); },
+        [](int32_t v) { sensorConfig.set_debounceMs((uint16_t)v); }, nullptr, nullptr},
+    {"sensor", "refractoryMs", Type::INT, APPLY | STATUS, 0, 60000, 500,
+        []() -> int32_t { return sensorConfig.get_refractoryMs(); },
+        [](int32_t v) { sensorConfig.set_refractoryMs((uint16_t)v); }, nullptr, nullptr},
+    {"sensor", "minPulseMs", Type::INT, APPLY | STATUS, 0, 10000, 0,
+        []() -> int32_t { return sensorConfig.get_minPulseMs(); },
+        [](int32_t v) { sensorConfig.set_minPulseMs((uint16_t)v); }, nullptr, nullptr},
+    {"sensor", "maxEventsPerSec", Type::INT, APPLY | STATUS, 0, 100, 0,
+        []() -> int32_t { return sensorConfig.get_maxEventsPerSec(); },
+        [](int32_t v) { sensorConfig.set_maxEventsPerSec((uint8_t)v); }, nullptr, nullptr},
+    {"sensor", "groupBaseMs", Type::INT, APPLY | STATUS, 0, 60000, 0,
+        []() -> int32_t { return sensorConfig.get_groupBaseMs(); },
+        [](int32_t v) { sensorConfig.set_groupBaseMs((uint16_t)v); }, nullptr, nullptr},
+    {"sensor", "groupStepMs", Type::INT, APPLY | STATUS, 0, 60000, 0,
+        []() -> int32_t { return sensorConfig.get_groupStepMs(); },
+        [](int32_t v) { sensorConfig.set_groupStepMs((uint16_t)v); }, nullptr, nullptr},
+    {"sensor", "autoTune", Type::BOOL, APPLY | STATUS, 0, 1, 0,
+        []() -> int32_t { return sensorConfig.get_autoTune(); },
+        [](int32_t v) { sensorConfig.set_autoTune(v != 0); }, nullptr, nullptr},
+    {"sensor", "tuneMinRefractoryMs", Type::INT, APPLY | STATUS, 0, 60000, AUTO_TUNE_MIN_REFRACTORY_MS,
+        []() -> int32_t { return sensorConfig.get_tuneMinRefractoryMs(); },
+        [](int32_t v) { sensorConfig.set_tuneMinRefractoryMs((uint16_t)v); }, nullptr, nullptr},
+    {"sensor", "tuneMaxRefractoryMs", Type::INT, APPLY | STATUS, 0, 60000, AUTO_TUNE_MAX_REFRACTORY_MS,
+        []() -> int32_t { return sensorConfig.get_tuneMaxRefractoryMs(); },
+        [](int32_t v) { sensorConfig.set_tuneMaxRefractoryMs((uint16_t)v); }, nullptr, nullptr},
+    {"sensor", "tuneMaxDebounceMs", Type::INT, APPLY | STATUS, 0, 10000, AUTO_TUNE_MAX_DEBOUNCE_MS,
+        []() -> int32_t { return sensorConfig.get_tuneMaxDebounceMs(); },
+        [](int32_t v) { sensorConfig.set_tuneMaxDebounceMs((uint16_t)v); }, nullptr, nullptr},
+
+    // timing
+    {"timing", "timezone", Type::STRING, APPLY | STATUS | RELOAD_SCHEDULE, 1, 38, 0, nullptr, nullptr,
+        [](char *buf, size_t size) { sysStatus.get_timeZoneStr(buf, size); },
+        [](const char *v) -> bool { return sysStatus.set_timeZoneStr(v); }},
+    {"timing", "reportingIntervalSec", Type::INT, APPLY | STATUS, 300, 65535, 3600,
+        []() -> int32_t { return sysStatus.get_reportingInterval(); },
+        [](int32_t v) { sysStatus.set_reportingInterval((uint16_t)v); }, nullptr, nullptr},
+    {"timing", "bucketSec", Type::INT, APPLY | STATUS, 0, 3600, 0,
+        []() -> int32_t { return sysStatus.get_bucketSec(); },
+        [](int32_t v) { sysStatus.set_bucketSec((uint16_t)v); }, nullptr, nullptr},
+    {"timing", "pollingRateSec", Type::INT, APPLY | STATUS, 0, 3600, 0,
+        []() -> int32_t { return sensorConfig.get_pollingRate(); },
+        [](int32_t v) { sensorConfig.set_pollingRate((uint16_t)v); }, nullptr, nullptr},
+    {"timing", "openHour", Type::INT, APPLY | STATUS | RELOAD_SCHEDULE, 0, 23, 0,
+        []() -> int32_t { return sysStatus.get_openTime(); },
+        [](int32_t v) { sysStatus.set_openTime((uint8_t)v); }, nullptr, nullptr},
+    {"timing", "closeHour", Type::INT, APPLY | STATUS | RELOAD_SCHEDULE, 0, 24, 24,
+        []() -> int32_t { return sysStatus.get_closeTime(); },
+        [](int32_t v) { sysStatus.set_closeTime((uint8_t)v); }, nullptr, nullptr},
+    {"timing", "weekSchedule", Type::STRING, APPLY | STATUS | RELOAD_SCHEDULE, 0, 42, 0, nullptr, nullptr,
+        [](char *buf, size_t size) { OpenHours::weekScheduleString(buf, size); },
+        [](const char *v) -> bool { return OpenHours::setWeekSchedule(v); }},
+    {"timing", "slotIndex", Type::INT, APPLY | STATUS, 0, 63, 0,
+        []() -> int32_t { return sysStatus.get_slotIndex(); },
+        [](int32_t v) { sysStatus.set_slotIndex((uint8_t)v); }, nullptr, nullptr},
+    {"timing", "slotCount", Type::INT, APPLY | STATUS, 0, 64, 0,
+        []() -> int32_t { return sysStatus.get_slotCount(); },
+        [](int32_t v) { sysStatus.set_slotCount((uint8_t)v); }, nullptr, nullptr},
+    {"timing", "slotWidthSec", Type::INT, APPLY | STATUS, 5, 900, REPORT_SLOT_WIDTH_SEC,
+        []() -> int32_t { return sysStatus.get_slotWidthSec(); },
+        [](int32_t v) { sysStatus.set_slotWidthSec((uint16_t)v); }, nullptr, nullptr},
+
+    // power
+    {"power", "lowPowerMode", Type::BOOL, STATUS, 0, 1, 0,
+        []() -> int32_t { return sysStatus.get_lowPowerMode(); }, nullptr, nullptr, nullptr},
+    {"power", "solarPowerMode", Type::BOOL, APPLY | STATUS, 0, 1, 1,
+        []() -> int32_t { return sysStatus.get_solarPowerMode(); },
+        [](int32_t v) { sysStatus.set_solarPowerMode(v != 0); }, nullptr, nullptr},
+    {"power", "maxGovernorTier", Type::INT, APPLY | STATUS, 0, 3, 3,
+        []() -> int32_t { return sysStatus.get_powerGovernorMaxTier(); },
+        [](int32_t v) { sysStatus.set_powerGovernorMaxTier((uint8_t)v); }, nullptr, nullptr},
+    {"power", "governorTier", Type::INT, STATUS, 0, 3, 0,
+        []() -> int32_t { return PowerGovernor::tier(); }, nullptr, nullptr, nullptr},
+    {"power", "policyVariant", Type::INT, APPLY | STATUS, 0, PowerPolicy::NUM_VARIANTS - 1, 0,
+        []() -> int32_t { return sysStatus.get_policyVariant(); },
+        [](int32_t v) { PowerPolicy::select((uint8_t)v); }, nullptr, nullptr},
+
+    // messaging
+    {"messaging", "serial", Type::BOOL, APPLY | STATUS, 0, 1, 0,
+        []() -> int32_t { return sysStatus.get_serialConnected(); },
+        [](int32_t v) { sysStatus.set_serialConnected(v != 0); }, nullptr, nullptr},
+    {"messaging", "verboseMode", Type::BOOL, APPLY | STATUS, 0, 1, 0,
+        []() -> int32_t { return sysStatus.get_verboseMode(); },
+        [](int32_t v) { sysStatus.set_verboseMode(v != 0); }, nullptr, nullptr},
+    {"messaging", "reportFields", Type::INT, APPLY | STATUS, 0, 0xFFFFF, (int32_t)REPORT_FIELDS_DEFAULT,
+        []() -> int32_t { return (int32_t)sysStatus.get_reportFields(); },
+        [](int32_t v) { sysStatus.set_reportFields((uint32_t)v); }, nullptr, nullptr},
+    {"messaging", "reportSchema", Type::INT, APPLY | STATUS, 1, 255, REPORT_SCHEMA_VERSION,
+        []() -> int32_t { return sysStatus.get_reportSchema(); },
+        [](int32_t v) { sysStatus.set_reportSchema((uint8_t)v); }, nullptr, nullptr},
+
+    // modes
+    {"modes", "countingMode", Type::INT, APPLY | STATUS, 0, 2, COUNTING,
+        []() -> int32_t { return sysStatus.get_countingMode(); },
+        [](int32_t v) { sysStatus.set_countingMode((uint8_t)v); }, nullptr, nullptr},
+    {"modes", "operatingMode", Type::INT, APPLY | STATUS, 0, 2, CONNECTED,
+        []() -> int32_t { return sysStatus.get_operatingMode(); },
+        [](int32_t v) { sysStatus.set_operatingMode((uint8_t)v); }, nullptr, nullptr},
+    {"modes", "occupancyDebounceMs", Type::INT, APPLY | STATUS, 0, 600000, 0,
+        []() -> int32_t { return (int32_t)sysStatus.get_occupancyDebounceMs(); },
+        [](int32_t v) { sysStatus.set_occupancyDebounceMs((uint32_t)v); }, nullptr, nullptr},
+    {"modes", "connectedReportingIntervalSec", Type::INT, APPLY | STATUS, 60, 65535, 300,
+        []() -> int32_t { return sysStatus.get_connectedReportingIntervalSec(); },
+        [](int32_t v) { sysStatus.set_connectedReportingIntervalSec((uint16_t)v); }, nullptr, nullptr},
+    {"modes", "lowPowerReportingIntervalSec", Type::INT, APPLY | STATUS, 300, 65535, 3600,
+        []() -> int32_t { return sysStatus.get_lowPowerReportingIntervalSec(); },
+        [](int32_t v) { sysStatus.set_lowPowerReportingIntervalSec((uint16_t)v); }, nullptr, nullptr},
+    {"modes", "connectAttemptBudgetSec", Type::INT, APPLY | STATUS, 30, 900, 300,
+        []() -> int32_t { return sysStatus.get_connectAttemptBudgetSec(); },
+        [](int32_t v) { sysStatus.set_connectAttemptBudgetSec((uint16_t)v); }, nullptr, nullptr},
+    {"modes", "cloudDisconnectBudgetSec", Type::INT, APPLY | STATUS, 5, 120, 15,
+        []() -> int32_t { return sysStatus.get_cloudDisconnectBudgetSec(); },
+        [](int32_t v) { sysStatus.set_cloudDisconnectBudgetSec((uint16_t)v); }, nullptr, nullptr},
+    {"modes", "modemOffBudgetSec", Type::INT, APPLY | STATUS, 5, 120, 30,
+        []() -> int32_t { return sysStatus.get_modemOffBudgetSec(); },
+        [](int32_t v) { sysStatus.set_modemOffBudgetSec((uint16_t)v); }, nullptr, nullptr},
+    {"modes", "reportHeartbeatHours", Type::INT, APPLY | STATUS, 0, 24, 0,
+        []() -> int32_t { return sysStatus.get_reportHeartbeatHours(); },
+        [](int32_t v) { sysStatus.set_reportHeartbeatHours((uint8_t)v); }, nullptr, nullptr},
+    {"modes", "reportSocDelta", Type::INT, APPLY | STATUS, 0, 50, 2,
+        []() -> int32_t { return sysStatus.get_reportSocDelta(); },
+        [](int32_t v) { sysStatus.set_reportSocDelta((uint8_t)v); }, nullptr, nullptr},
+    {"modes", "reportTempDelta", Type::INT, APPLY | STATUS, 0, 20, 2,
+        []() -> int32_t { return sysStatus.get_reportTempDelta(); },
+        [](int32_t v) { sysStatus.set_reportTempDelta((uint8_t)v); }, nullptr, nullptr},
+    {"modes", "liveCountSec", Type::INT, APPLY | STATUS, 0, 300, 0,
+        []() -> int32_t { return sysStatus.get_liveCountSec(); },
+        [](int32_t v) { sysStatus.set_liveCountSec((uint16_t)v); }, nullptr, nullptr},
+    {"modes", "occupancyNotifySec", Type::INT, APPLY | STATUS, 0, 3600, 0,
+        []() -> int32_t { return sysStatus.get_occupancyNotifySec(); },
+        [](int32_t v) { sysStatus.set_occupancyNotifySec((uint16_t)v); }, nullptr, nullptr},
+    {"modes", "dataDelivery", Type::INT, APPLY | STATUS, 0, 2, DELIVER_BOTH,
+        []() -> int32_t { return sysStatus.get_dataDelivery(); },
+        [](int32_t v) { sysStatus.set_dataDelivery((uint8_t)v); }, nullptr, nullptr},
+};
+
+const size_t FIELD_COUNT = sizeof(FIELDS) / sizeof(FIELDS[0]);
+
+const char *const SECTIONS[NUM_SECTIONS] = {"sensor", "timing", "power", "messaging", "modes"};
+
+int sectionIndex(const char *section) {
+    for (size_t ii = 0; ii < NUM_SECTIONS; ii++) {
+        if (section && strcmp(section, SECTIONS[ii]) == 0) {
+            return (int)ii;
+        }
+    }
+    return -1;
+}
+
+bool apply(const Variant &config, uint8_t &changedFlags, uint8_t sections, uint8_t *failedSections) {
+    bool success = true;
+    uint8_t failed = 0;
+    changedFlags = 0;
+
+    // Rows are grouped by section, so each section is looked up once
+    const char *sectionName = nullptr;
+    uint8_t sectionBit = 0;
+    Variant section;
+    for (size_t ii = 0; ii < FIELD_COUNT; ii++) {
+        const Field &field = FIELDS[ii];
+        if (!(field.flags & APPLY)) {
+            continue;
+        }
+        if (!sectionName || strcmp(sectionName, field.section) != 0) {
+            sectionName = field.section;
+            int index = sectionIndex(sectionName);
+            sectionBit = index < 0 ? 0 : (uint8_t)(1 << index);
+            section = (sections & sectionBit) && config.has(sectionName) ? config.get(sectionName) : Variant();
+        }
+        if (!section.isMap() || !section.has(field.key)) {
+            continue;
+        }
+        Variant value = section.get(field.key);
+
+        if (field.type == Type::STRING) {
+            String str = value.toString();
+            char stored[MAX_STRING_LEN + 1];
+            field.getString(stored, sizeof(stored));
+            if ((int32_t)str.length() < field.minValue || (int32_t)str.length() > field.maxValue) {
+                Log.warn("Invalid %s.%s length: %d", field.section, field.key, (int)str.length());
+                success = false;
+                failed |= sectionBit;
+            } else if (strcmp(stored, str.c_str()) != 0) {
+                if (!field.setString(str.c_str())) {
+                    Log.warn("Invalid %s.%s value: %s", field.section, field.key, str.c_str());
+                    success = false;
+                    failed |= sectionBit;
+                    continue;
+                }
+                Log.info("Config: %s.%s → %s", field.section, field.key, str.c_str());
+                changedFlags |= field.flags;
+            }
+            continue;
+        }
+
+        int32_t v;
+        if (field.type == Type::BOOL) {
+            v = value.toBool() ? 1 : 0;
+        } else {
+            v = value.toInt();
+            if (v < field.minValue || v > field.maxValue) {
+                Log.warn("Invalid %s.%s value: %ld (must be between %ld and %ld)", field.section, field.key,
+                         (long)v, (long)field.minValue, (long)field.maxValue);
+                success = false;
+                failed |= sectionBit;
+                continue;
+            }
+        }
+        if (field.get() != v) {
+            field.set(v);
+            if (field.type == Type::BOOL) {
+                Log.info("Config: %s.%s → %s", field.section, field.key, v ? "ON" : "OFF");
+            } else {
+                Log.info("Config: %s.%s → %ld", field.section, field.key, (long)v);
+            }
+            changedFlags |= field.flags;
+        }
+    }
+    if (failedSections) {
+        *failedSections = failed;
+    }
+    return success;
+}
+
+// Short names for applyCommand(); any APPLY field's own key works too
+struct Alias {
+    const char *alias;
+    const char *key;
+};
+
+static const Alias ALIASES[] = {
+    {"interval", "reportingIntervalSec"},
+    {"bucket", "bucketSec"},
+    {"polling", "pollingRateSec"},
+    {"open", "openHour"},
+    {"close", "closeHour"},
+    {"tz", "timezone"},
+    {"week", "weekSchedule"},
+    {"slot", "slotIndex"},
+    {"slots", "slotCount"},
+    {"debounce", "debounceMs"},
+    {"refractory", "refractoryMs"},
+    {"minPulse", "minPulseMs"},
+    {"maxRate", "maxEventsPerSec"},
+    {"groupBase", "groupBaseMs"},
+    {"groupStep", "groupStepMs"},
+    {"tune", "autoTune"},
+    {"counting", "countingMode"},
+    {"operating", "operatingMode"},
+    {"verbose", "verboseMode"},
+    {"policy", "policyVariant"},
+};
+
+static const Field *findApplyField(const char *key) {
+    for (size_t ii = 0; ii < sizeof(ALIASES) / sizeof(ALIASES[0]); ii++) {
+        if (strcmp(key, ALIASES[ii].alias) == 0) {
+            key = ALIASES[ii].key;
+            break;
+        }
+    }
+    for (size_t ii = 0; ii < FIELD_COUNT; ii++) {
+        if ((FIELDS[ii].flags & APPLY) && strcmp(FIELDS[ii].key, key) == 0) {
+            return &FIELDS[ii];
+        }
+    }
+    return nullptr;
+}
+
+// INT and BOOL values of a command; false if not a number in range
+static bool parseValue(const Field &field, const char *text, int32_t &v) {
+    if (field.type == Type::BOOL) {
+        if (strcmp(text, "1") == 0 || strcmp(text, "true") == 0 || strcmp(text, "on") == 0) {
+            v = 1;
+        } else if (strcmp(text, "0") == 0 || strcmp(text, "false") == 0 || strcmp(text, "off") == 0) {
+            v = 0;
+        } else {
+            return false;
+        }
+        return true;
+    }
+    char *end = nullptr;
+    long value = strtol(text, &end, 10);
+    if (end == text || *end != 0) {
+        return false;
+    }
+    v = (int32_t)value;
+    return v >= field.minValue && v <= field.maxValue;
+}
+
+int applyCommand(const char *command, uint8_t &changedFlags) {
+    changedFlags = 0;
+
+    // The whole command is parsed and checked before anything is set
+    char buf[256];
+    if (!command || strlen(command) >= sizeof(buf)) {
+        return COMMAND_MALFORMED;
+    }
+    strcpy(buf, command);
+
+    struct Pending {
+        const Field *field;
+        const char *text;       // Into buf
+        int32_t value;          // INT and BOOL
+    };
+    Pending pending[MAX_COMMAND_KEYS];
+    size_t count = 0;
+
+    char *save = nullptr;
+    for (char *pair = strtok_r(buf, ";", &save); pair; pair = strtok_r(nullptr, ";", &save)) {
+        char *equals = strchr(pair, '=');
+        if (!equals || equals == pair || count >= MAX_COMMAND_KEYS) {
+            return COMMAND_MALFORMED;
+        }
+        *equals = 0;
+        const Field *field = findApplyField(pair);
+        if (!field) {
+            Log.warn("Config command: unknown key %s", pair);
+            return COMMAND_UNKNOWN_KEY;
+        }
+        Pending &p = pending[count++];
+        p.field = field;
+        p.text = equals + 1;
+        p.value = 0;
+        size_t length = strlen(p.text);
+        bool valid = (field->type == Type::STRING)
+                         ? (int32_t)length >= field->minValue && (int32_t)length <= field->maxValue
+                         : parseValue(*field, p.text, p.value);
+        if (!valid) {
+            Log.warn("Config command: invalid %s.%s value: %s", field->section, field->key, p.text);
+            return COMMAND_INVALID_VALUE;
+        }
+    }
+    if (count == 0) {
+        return COMMAND_MALFORMED;
+    }
+
+    // Setters that can still refuse (STRING) go first, and are put back if
+    // a later one does, so a refused command leaves every setting as it was
+    char previous[MAX_COMMAND_KEYS][MAX_STRING_LEN + 1];
+    for (size_t ii = 0; ii < count; ii++) {
+        const Field &field = *pending[ii].field;
+        if (field.type != Type::STRING) {
+            continue;
+        }
+        field.getString(previous[ii], sizeof(previous[ii]));
+        if (strcmp(previous[ii], pending[ii].text) == 0) {
+            continue;
+        }
+        if (!field.setString(pending[ii].text)) {
+            Log.warn("Config command: invalid %s.%s value: %s", field.section, field.key, pending[ii].text);
+            for (size_t jj = 0; jj < ii; jj++) {
+                if (pending[jj].field->type == Type::STRING) {
+                    pending[jj].field->setString(previous[jj]);
+                }
+            }
+            changedFlags = 0;
+            return COMMAND_INVALID_VALUE;
+        }
+        Log.info("Config: %s.%s → %s", field.section, field.key, pending[ii].text);
+        changedFlags |= field.flags;
+    }
+    for (size_t ii = 0; ii < count; ii++) {
+        const Field &field = *pending[ii].field;
+        if (field.type == Type::STRING || field.get() == pending[ii].value) {
+            continue;
+        }
+        field.set(pending[ii].value);
+        Log.info("Config: %s.%s → %ld", field.section, field.key, (long)pending[ii].value);
+        changedFlags |= field.flags;
+    }
+    return (int)count;
+}
+
+void writeStatus(JSONWriter &writer) {
+    const char *sectionName = nullptr;
+    for (size_t ii = 0; ii < FIELD_COUNT; ii++) {
+        const Field &field = FIELDS[ii];
+        if (!(field.flags & STATUS)) {
+            continue;
+        }
+        if (!sectionName || strcmp(sectionName, field.section) != 0) {
+            if (sectionName) {
+                writer.endObject();
+            }
+            sectionName = field.section;
+            writer.name(sectionName).beginObject();
+        }
+        writer.name(field.key);
+        switch (field.type) {
+            case Type::STRING: {
+                char str[MAX_STRING_LEN + 1];
+                field.getString(str, sizeof(str));
+                writer.value(str);
+                break;
+            }
+            case Type::BOOL:
+                writer.value(field.get() != 0);
+                break;
+            default:
+                writer.value((int)field.get());
+                break;
+        }
+    }
+    if (sectionName) {
+        writer.endObject();
+    }
+}
+
+bool hasNonDefault() {
+    for (size_t ii = 0; ii < FIELD_COUNT; ii++) {
+        const Field &field = FIELDS[ii];
+        if ((field.flags & APPLY) && field.type != Type::STRING && field.get() != field.defaultValue) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace ConfigSchema
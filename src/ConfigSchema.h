@@ -0,0 +1,129 @@
+/**
+ * @file ConfigSchema.h
+ * @brief Table of the ledger configuration fields.
+ *
+ * @details One row per setting: ledger section and key, type, valid range,
+ *          product default, and the sysStatus / sensorConfig accessors it
+ *          maps to. Cloud applies the merged default-settings/device-settings
+ *          configuration by walking this table, and writes the same rows to
+ *          the device-status ledger, so a setting that can be applied is
+ *          always reported and the two cannot drift apart.
+ *
+ *          The "config" cloud function applies the same rows from a
+ *          key=value command (applyCommand()), for a quick change while
+ *          connected without a ledger sync.
+ *
+ *          To add a setting, add its persistent field and a row in
+ *          ConfigSchema.cpp, and document it in STYLE.md.
+ */
+
+#ifndef __CONFIGSCHEMA_H
+#define __CONFIGSCHEMA_H
+
+#include "Particle.h"
+
+namespace ConfigSchema {
+
+/** @brief How the ledger value is read and written */
+enum class Type : uint8_t {
+    INT,        ///< Integer checked against [minValue, maxValue]
+    BOOL,       ///< true/false; range ignored
+    STRING      ///< Text whose length is checked against [minValue, maxValue]
+};
+
+/** @brief Field flags */
+enum : uint8_t {
+    APPLY = 0x01,           ///< Read from the merged ledger configuration
+    STATUS = 0x02,          ///< Written to the device-status ledger
+    RELOAD_SCHEDULE = 0x08  ///< Changing it requires OpenHours::reloadTimezone()
+};
+
+/** @brief The ledger sections, in FIELDS order; bit n of a section mask is SECTIONS[n] */
+static constexpr size_t NUM_SECTIONS = 5;
+extern const char *const SECTIONS[NUM_SECTIONS];
+
+/** @brief Section mask with every section */
+static constexpr uint8_t ALL_SECTIONS = (1 << NUM_SECTIONS) - 1;
+
+/**
+ * @brief Index of @p section in SECTIONS, or -1
+ */
+int sectionIndex(const char *section);
+
+/** @brief Longest STRING value; every STRING field's maxValue is within it */
+static constexpr size_t MAX_STRING_LEN = 63;
+
+/** @brief Settings one applyCommand() can carry */
+static constexpr size_t MAX_COMMAND_KEYS = 8;
+
+/** @brief applyCommand() results; nothing is applied on any of them */
+enum : int {
+    COMMAND_MALFORMED = -1,         ///< Too long, a pair without '=', or too many pairs
+    COMMAND_UNKNOWN_KEY = -2,       ///< Not a key or alias of an APPLY field
+    COMMAND_INVALID_VALUE = -3      ///< Not a number, out of range, or refused by the setter
+};
+
+struct Field {
+    const char *section;            ///< Top-level ledger object ("sensor", "timing", ...)
+    const char *key;                ///< Key within the section
+    Type type;
+    uint8_t flags;
+    int32_t minValue;               ///< Smallest valid value (STRING: shortest length)
+    int32_t maxValue;               ///< Largest valid value (STRING: longest length)
+    int32_t defaultValue;           ///< Product default (not used for STRING)
+    int32_t (*get)();               ///< INT and BOOL accessors
+    void (*set)(int32_t);           ///< nullptr for status-only fields
+    void (*getString)(char *buf, size_t size);  ///< STRING accessors; buf is MAX_STRING_LEN + 1 bytes
+    bool (*setString)(const char *);
+};
+
+/** @brief The configuration fields, grouped by section */
+extern const Field FIELDS[];
+
+/** @brief Number of entries in FIELDS */
+extern const size_t FIELD_COUNT;
+
+/**
+ * @brief Apply every APPLY field present in a merged configuration
+ *
+ * Invalid values are logged and skipped; the remaining fields are still
+ * applied.
+ *
+ * @param config Merged ledger configuration (a map of sections)
+ * @param changedFlags Receives the OR of the flags of every field that changed
+ *                     (0 if nothing changed)
+ * @param sections Mask of the sections to apply; fields of the others are not read
+ * @param failedSections If not null, receives the mask of sections with an invalid value
+ * @return false if any value was invalid
+ */
+bool apply(const Variant &config, uint8_t &changedFlags, uint8_t sections = ALL_SECTIONS,
+           uint8_t *failedSections = nullptr);
+
+/**
+ * @brief Apply a "key=value;key=value" command, all of it or none of it
+ *
+ * Keys are the ledger keys of APPLY fields (threshold1, pollingRateSec,
+ * ...), or a short alias (interval, polling, open, close, tz, debounce,
+ * refractory, ...; see ALIASES in ConfigSchema.cpp). Every value is
+ * checked against its row before any is set, with the same ranges as
+ * apply().
+ *
+ * @param command e.g. "interval=900;open=6;close=22;debounce=3000"
+ * @param changedFlags Receives the OR of the flags of every field that changed
+ * @return Number of settings in the command, or a negative COMMAND_ result
+ */
+int applyCommand(const char *command, uint8_t &changedFlags);
+
+/**
+ * @brief Write every STATUS field as section objects of an open JSON object
+ */
+void writeStatus(JSONWriter &writer);
+
+/**
+ * @brief true if any APPLY field differs from its product default
+ */
+bool hasNonDefault();
+
+} // namespace ConfigSchema
+
+#endif /* __CONFIGSCHEMA_H */
@@ -0,0 +1,60 @@
+#include "ConfigSnapshot.h"
+#include "AutoTune.h"
+#include "Config.h"
+#include "MyPersistentData.h"
+#include <atomic>
+
+namespace ConfigSnapshot {
+
+static Values buffers[2];
+static std::atomic<uint32_t> seq(0);      // Low bit selects the live buffer
+
+void publish() {
+    uint32_t next = seq.load(std::memory_order_relaxed) + 1;
+    Values &v = buffers[next & 1];
+
+    v.occupancyDebounceMs = sysStatus.get_occupancyDebounceMs();
+    v.connectAttemptBudgetSec = sysStatus.get_connectAttemptBudgetSec();
+    v.pollingRateSec = sensorConfig.get_pollingRate();
+    v.threshold1 = sensorConfig.get_threshold1();
+    v.threshold2 = sensorConfig.get_threshold2();
+    v.debounceMs = sensorConfig.get_debounceMs();
+    v.refractoryMs = sensorConfig.get_refractoryMs();
+#if AUTO_TUNE_ENABLED
+    if (sensorConfig.get_autoTune()) {
+        v.debounceMs = AutoTune::tuned(v.debounceMs, sysStatus.get_tuneDebounceMs(), 0,
+                                       sensorConfig.get_tuneMaxDebounceMs());
+        v.refractoryMs = AutoTune::tuned(v.refractoryMs, sysStatus.get_tuneRefractoryMs(),
+                                         sensorConfig.get_tuneMinRefractoryMs(),
+                                         sensorConfig.get_tuneMaxRefractoryMs());
+    }
+#endif
+    v.minPulseMs = sensorConfig.get_minPulseMs();
+    v.maxEventsPerSec = sensorConfig.get_maxEventsPerSec();
+    v.groupBaseMs = sensorConfig.get_groupBaseMs();
+    v.groupStepMs = sensorConfig.get_groupStepMs();
+    v.sensorType = sysStatus.get_sensorType();
+    v.countingMode = sysStatus.get_countingMode();
+    v.operatingMode = sysStatus.get_operatingMode();
+    v.policyVariant = sysStatus.get_policyVariant();
+    v.verboseMode = sysStatus.get_verboseMode();
+
+    seq.store(next, std::memory_order_release);
+}
+
+Values read() {
+    while (true) {
+        uint32_t before = seq.load(std::memory_order_acquire);
+        Values v = buffers[before & 1];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq.load(std::memory_order_relaxed) == before) {
+            return v;
+        }
+    }
+}
+
+uint32_t sequence() {
+    return seq.load(std::memory_order_relaxed);
+}
+
+} // namespace ConfigSnapshot
@@ -0,0 +1,75 @@
+/**
+ * @file ConfigSnapshot.h
+ * @brief Lock-free copy of the settings read on every pass or from interrupts.
+ *
+ * @details sysStatus and sensorConfig getters take the storage mutex, which
+ *          an ISR must never do and which costs the main loop, the state
+ *          handlers and the sensor thread a lock on every pass. The few
+ *          settings they read are copied into a plain struct instead.
+ *
+ *          There are two copies. publish() fills the one readers are not
+ *          using and then bumps a sequence count whose low bit selects it,
+ *          so a reader sees either the old values or the new ones, never a
+ *          mix. An ISR can preempt publish() but never the other way round,
+ *          so read() from an ISR never retries; a thread retries if two
+ *          publishes land during its copy.
+ *
+ *          The setters of these fields call publish(), so every config
+ *          apply (ledger, cloud function or code) is picked up when it is
+ *          made. Call publish() from the application thread only.
+ *
+ *          The sensor parameters (thresholds, event filter) are here too.
+ *          Drivers and filters that cache them compare sequence() with the
+ *          one they loaded at, before each batch, and reload on a change:
+ *          a tuning change reaches the next event without a sensor
+ *          re-initialization and without taking the sensor lock.
+ */
+
+#ifndef __CONFIGSNAPSHOT_H
+#define __CONFIGSNAPSHOT_H
+
+#include "Particle.h"
+
+namespace ConfigSnapshot {
+
+/** @brief The snapshotted settings; add a field here and to publish() together. */
+struct Values {
+    uint32_t occupancyDebounceMs;       ///< sysStatus
+    uint16_t connectAttemptBudgetSec;   ///< sysStatus
+    uint16_t pollingRateSec;            ///< sensorConfig pollingRate
+    uint16_t threshold1;                ///< sensorConfig, driver-specific
+    uint16_t threshold2;                ///< sensorConfig, driver-specific
+    uint16_t debounceMs;                ///< sensorConfig plus AutoTune offset, EventFilter
+    uint16_t refractoryMs;              ///< sensorConfig plus AutoTune offset, EventFilter
+    uint16_t minPulseMs;                ///< sensorConfig, EventFilter
+    uint8_t maxEventsPerSec;            ///< sensorConfig, EventFilter
+    uint16_t groupBaseMs;               ///< sensorConfig, PIR group estimate
+    uint16_t groupStepMs;               ///< sensorConfig, PIR group estimate
+    uint8_t sensorType;                 ///< sysStatus, a SensorType
+    uint8_t countingMode;               ///< sysStatus, a CountingMode
+    uint8_t operatingMode;              ///< sysStatus, an OperatingMode
+    uint8_t policyVariant;              ///< sysStatus, a PowerPolicy variant
+    bool verboseMode;                   ///< sysStatus
+};
+
+/**
+ * @brief Copy the current settings into the spare buffer and make it the live one
+ *
+ * @details Call after sysStatus and sensorConfig are loaded; their setters
+ *          call it from then on.
+ */
+void publish();
+
+/**
+ * @brief A consistent copy of the live settings; safe in an ISR
+ */
+Values read();
+
+/**
+ * @brief Number of publishes since boot, to notice a change cheaply
+ */
+uint32_t sequence();
+
+} // namespace ConfigSnapshot
+
+#endif /* __CONFIGSNAPSHOT_H */
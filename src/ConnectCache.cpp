@@ -0,0 +1,175 @@
+#include "ConnectCache.h"
+#include "Config.h"
+#include "Connectivity.h"
+#include "MyPersistentData.h"
+#include "TraceLog.h"
+
+namespace ConnectCache {
+
+// Phases of the attempt in progress (millis(); 0 = not reached yet)
+static uint32_t startMs = 0;
+static uint32_t radioOnMs = 0;
+static uint32_t networkMs = 0;
+
+// Phase durations of the last successful connect
+static uint32_t lastRadioMs = 0;
+static uint32_t lastNetworkMs = 0;
+static uint32_t lastCloudMs = 0;
+static bool lastSameNetwork = false;
+static bool haveLast = false;
+
+// Teardown in progress: request time and when each part was seen off (0 = not yet)
+static uint32_t teardownStartMs = 0;
+static uint32_t cloudOffMs = 0;
+static uint32_t networkOffMs = 0;
+static uint32_t modemOffMs = 0;
+static bool teardownFast = false;
+static bool teardownOpen = false;
+
+// Last teardown, ms from the request (-1 = not off when the budget ran out)
+static int32_t lastTeardown[3] = {0, 0, 0};
+static bool lastTeardownFast = false;
+static bool haveTeardown = false;
+
+void setup() {
+#if CONNECT_CACHE_ENABLED
+    // Keep the session on the sleep disconnect so the next connect resumes it
+    Particle.setDisconnectOptions(CloudDisconnectOptions().clearSession(false));
+#endif
+}
+
+void begin() {
+    startMs = millis();
+    radioOnMs = 0;
+    networkMs = 0;
+    poll();   // Radio may already be up (CONNECTED mode, signal probe)
+}
+
+void poll() {
+    uint32_t nowMs = millis();
+    if (networkMs == 0 && Connectivity::isNetworkReady()) {
+        networkMs = nowMs;
+    }
+    if (radioOnMs == 0 && (networkMs != 0 || Connectivity::isRadioPoweredOn())) {
+        radioOnMs = nowMs;
+    }
+}
+
+#if Wiring_WiFi
+// Compare the access point and lease with the cached ones, then cache these
+static bool refreshNetwork() {
+    uint8_t bssid[6] = {0};
+    WiFi.BSSID(bssid);
+    IPAddress ip = WiFi.localIP();
+    uint32_t localIp = ((uint32_t)ip[0] << 24) | ((uint32_t)ip[1] << 16) | ((uint32_t)ip[2] << 8) | ip[3];
+
+    bool same = (localIp == sysStatus.get_netLocalIp());
+    for (size_t ii = 0; ii < sizeof(bssid); ii++) {
+        if (sysStatus.get_netBssid(ii) != bssid[ii]) {
+            same = false;
+            sysStatus.set_netBssid(ii, bssid[ii]);
+        }
+    }
+    if (localIp != sysStatus.get_netLocalIp()) {
+        sysStatus.set_netLocalIp(localIp);
+    }
+    return same;
+}
+#endif
+
+void connected() {
+    poll();
+    uint32_t nowMs = millis();
+    // A phase not seen by poll() ended with the next one
+    uint32_t networkAt = networkMs ? networkMs : nowMs;
+    uint32_t radioAt = radioOnMs ? radioOnMs : networkAt;
+
+    lastRadioMs = radioAt - startMs;
+    lastNetworkMs = networkAt - radioAt;
+    lastCloudMs = nowMs - networkAt;
+    haveLast = true;
+    TraceLog::record(TraceLog::CONNECTED, (int32_t)lastRadioMs, (int32_t)lastNetworkMs, (int32_t)lastCloudMs);
+
+#if Wiring_WiFi && CONNECT_CACHE_ENABLED
+    lastSameNetwork = refreshNetwork();
+    Log.info("Connect phases: radio %lu ms, network %lu ms (%s), cloud %lu ms, total %lu ms",
+             (unsigned long)lastRadioMs, (unsigned long)lastNetworkMs,
+             lastSameNetwork ? "same AP and lease" : "new AP or lease",
+             (unsigned long)lastCloudMs, (unsigned long)(nowMs - startMs));
+#else
+    Log.info("Connect phases: radio %lu ms, network %lu ms, cloud %lu ms, total %lu ms",
+             (unsigned long)lastRadioMs, (unsigned long)lastNetworkMs,
+             (unsigned long)lastCloudMs, (unsigned long)(nowMs - startMs));
+#endif
+}
+
+void beginTeardown(bool fast) {
+    teardownStartMs = millis();
+    cloudOffMs = networkOffMs = modemOffMs = 0;
+    teardownFast = fast;
+    teardownOpen = true;
+}
+
+static int32_t phaseMs(uint32_t offMs) {
+    return offMs ? (int32_t)(offMs - teardownStartMs) : -1;
+}
+
+static void recordTeardown(bool complete) {
+    teardownOpen = false;
+    lastTeardown[0] = phaseMs(cloudOffMs);
+    lastTeardown[1] = phaseMs(networkOffMs);
+    lastTeardown[2] = phaseMs(modemOffMs);
+    lastTeardownFast = teardownFast;
+    haveTeardown = true;
+    TraceLog::record(TraceLog::TEARDOWN, lastTeardown[0], lastTeardown[1], lastTeardown[2]);
+    Log.info("Teardown phases (%s%s): cloud %ld ms, network %ld ms, modem %ld ms",
+             teardownFast ? "fast" : "graceful", complete ? "" : ", budget exceeded",
+             (long)lastTeardown[0], (long)lastTeardown[1], (long)lastTeardown[2]);
+}
+
+bool pollTeardown() {
+    uint32_t nowMs = millis();
+    if (cloudOffMs == 0 && !Particle.connected()) {
+        cloudOffMs = nowMs;
+    }
+    if (networkOffMs == 0 && !Connectivity::isNetworkReady()) {
+        networkOffMs = nowMs;
+    }
+    if (modemOffMs == 0 && !Connectivity::isRadioPoweredOn()) {
+        modemOffMs = nowMs;
+    }
+    bool done = cloudOffMs && networkOffMs && modemOffMs;
+    if (done && teardownOpen) {
+        recordTeardown(true);
+    }
+    return done;
+}
+
+void endTeardown() {
+    if (teardownOpen) {
+        recordTeardown(false);
+    }
+}
+
+void writeStatus(JSONWriter &writer) {
+    if (haveLast) {
+        writer.name("connectPhases").beginObject();
+        writer.name("radioMs").value((unsigned long)lastRadioMs);
+        writer.name("netMs").value((unsigned long)lastNetworkMs);
+        writer.name("cloudMs").value((unsigned long)lastCloudMs);
+#if Wiring_WiFi && CONNECT_CACHE_ENABLED
+        writer.name("sameNet").value(lastSameNetwork);
+#endif
+        writer.endObject();
+    }
+    if (haveTeardown) {
+        writer.name("teardownPhases").beginObject();
+        writer.name("cloudMs").value((int)lastTeardown[0]);
+        writer.name("netMs").value((int)lastTeardown[1]);
+        writer.name("modemMs").value((int)lastTeardown[2]);
+        writer.name("fast").value(lastTeardownFast);
+        writer.endObject();
+    }
+}
+
+} // namespace ConnectCache
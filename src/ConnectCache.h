@@ -0,0 +1,77 @@
+/**
+ * @file ConnectCache.h
+ * @brief Connect- and teardown-phase timing and the network kept from the last connect.
+ *
+ * @details Each connect attempt is split into three phases: radio power-up
+ *          (until the modem or WiFi module is on), network (registration,
+ *          or association and DHCP on WiFi) and cloud (handshake, or session
+ *          resume). connected() logs the split so the dominant phase is
+ *          visible per report, and device-status carries the last one.
+ *
+ *          With CONNECT_CACHE_ENABLED the sleep disconnect keeps the cloud
+ *          session, so the next handshake is a resume, and on WiFi the
+ *          access point BSSID and IP lease of the last connect are kept in
+ *          sysStatus; each connect is tagged as on the same network or a new
+ *          one, which separates a slow AP from a roam or a new lease.
+ *
+ *          The sleep teardown is timed the same way. Cloud close, network
+ *          down and radio off run in parallel once requested, so each is
+ *          the time from the request until it was seen done. The split is
+ *          logged, traced and carried in device-status with whether it was
+ *          a fast teardown (SLEEP_FAST_TEARDOWN).
+ */
+
+#ifndef __CONNECTCACHE_H
+#define __CONNECTCACHE_H
+
+#include "Particle.h"
+
+namespace ConnectCache {
+
+/**
+ * @brief Apply the cloud disconnect options; call once from setup()
+ */
+void setup();
+
+/**
+ * @brief A connect attempt starts now
+ */
+void begin();
+
+/**
+ * @brief Note phase changes; call on every pass through CONNECTING_STATE
+ */
+void poll();
+
+/**
+ * @brief The cloud connected: log the phases and refresh the cached network
+ */
+void connected();
+
+/**
+ * @brief The sleep teardown was requested now; @p fast if without a graceful cloud close
+ */
+void beginTeardown(bool fast);
+
+/**
+ * @brief Note teardown phases; call on every pass while waiting for them
+ *
+ * @return true once the cloud, network and radio are all off (logged the first time)
+ */
+bool pollTeardown();
+
+/**
+ * @brief The teardown budget ran out: log and keep the phases seen so far
+ */
+void endTeardown();
+
+/**
+ * @brief Write {"radioMs","netMs","cloudMs","sameNet"} for the last connect as "connectPhases",
+ *        and {"cloudMs","netMs","modemMs","fast"} for the last teardown as "teardownPhases",
+ *        to an open JSON object
+ */
+void writeStatus(JSONWriter &writer);
+
+} // namespace ConnectCache
+
+#endif /* __CONNECTCACHE_H */
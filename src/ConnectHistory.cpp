@@ -0,0 +1,239 @@
+#include "ConnectHistory.h"
+#include "Config.h"
+#include "MyPersistentData.h"
+#include "StateMachine.h"
+#include <atomic>
+
+namespace ConnectHistory {
+
+// Counted on the system thread by cloudStatusHandler(), folded into current by fold()
+static std::atomic<uint16_t> pendingDrops(0);
+static std::atomic<uint16_t> pendingReconnects(0);
+static std::atomic<uint32_t> pendingDropAfterSec(0);
+static std::atomic<uint8_t> dropsSinceReport(0);
+static std::atomic<bool> dampingStarted(false);
+static unsigned long connectedAtMs = 0;        // 0 = not connected
+static bool disconnectRequested = false;
+static bool droppedSinceConnect = false;
+
+const uint16_t BUCKET_LIMITS_SEC[NUM_BUCKETS - 1] = {10, 20, 30, 45, 60, 90, 120, 180, 300};
+
+// Halve every count so the histogram keeps roughly the last HALVE_AT connects
+static void halve() {
+    for (size_t ii = 0; ii < NUM_BUCKETS; ii++) {
+        sysStatus.set_connectHist(ii, sysStatus.get_connectHist(ii) / 2);
+    }
+    sysStatus.set_connectFailures(sysStatus.get_connectFailures() / 2);
+}
+
+void recordSuccess(uint32_t seconds) {
+    size_t bucket = 0;
+    while (bucket < NUM_BUCKETS - 1 && seconds >= BUCKET_LIMITS_SEC[bucket]) {
+        bucket++;
+    }
+    uint16_t count = sysStatus.get_connectHist(bucket) + 1;
+    sysStatus.set_connectHist(bucket, count);
+    sysStatus.set_connectFailStreak(0);
+    if (sysStatus.get_connectBackoffUntil() != 0) {
+        Log.info("Connect backoff ended by a successful connect");
+        sysStatus.set_connectBackoffUntil(0);
+    }
+    if (count >= HALVE_AT) {
+        halve();
+    }
+}
+
+void recordFailure() {
+    uint16_t failures = sysStatus.get_connectFailures() + 1;
+    sysStatus.set_connectFailures(failures);
+    uint8_t streak = sysStatus.get_connectFailStreak();
+    if (streak < 255) {
+        streak++;
+        sysStatus.set_connectFailStreak(streak);
+    }
+    uint32_t backoff = backoffSec(streak);
+    if (backoff > 0 && Time.isValid()) {
+        sysStatus.set_connectBackoffUntil(Time.now() + backoff);
+        Log.info("Connect backoff: %u failures in a row - next scheduled connect in %lu s",
+                 streak, (unsigned long)backoff);
+    }
+    if (failures >= HALVE_AT) {
+        halve();
+    }
+}
+
+uint32_t samples() {
+    uint32_t total = 0;
+    for (size_t ii = 0; ii < NUM_BUCKETS; ii++) {
+        total += sysStatus.get_connectHist(ii);
+    }
+    return total;
+}
+
+uint32_t configuredSec() {
+    uint16_t budget = sysStatus.get_connectAttemptBudgetSec();
+    if (budget >= MIN_BUDGET_SEC && budget <= MAX_BUDGET_SEC) {
+        return budget;
+    }
+    return maxConnectAttemptMs / 1000;
+}
+
+uint32_t budgetSec() {
+#if CONNECT_BUDGET_ADAPTIVE
+    uint32_t total = samples();
+    if (total < CONNECT_BUDGET_MIN_SAMPLES) {
+        return configuredSec();
+    }
+
+    // Upper limit of the bucket holding the 95th percentile of all attempts. A failure
+    // ran out of budget, so it is longer than any success; with more than 5% failures
+    // the percentile is beyond what was observed and the configured budget stands.
+    uint32_t target = ((total + sysStatus.get_connectFailures()) * 95 + 99) / 100;
+    uint32_t seen = 0;
+    uint32_t p95Sec = 0;
+    for (size_t ii = 0; ii < NUM_BUCKETS - 1; ii++) {
+        seen += sysStatus.get_connectHist(ii);
+        if (seen >= target) {
+            p95Sec = BUCKET_LIMITS_SEC[ii];
+            break;
+        }
+    }
+    if (p95Sec == 0) {
+        return configuredSec();
+    }
+
+    uint32_t learned = constrain(p95Sec + p95Sec / 2 + CONNECT_BUDGET_MARGIN_SEC,
+                                 (uint32_t)MIN_BUDGET_SEC, (uint32_t)MAX_BUDGET_SEC);
+    if (sysStatus.get_connectFailStreak() > 0 && learned < configuredSec()) {
+        return configuredSec();
+    }
+    return learned;
+#else
+    return configuredSec();
+#endif
+}
+
+uint32_t backoffSec(uint8_t streak) {
+#if CONNECT_BACKOFF_ENABLED
+    if (streak <= CONNECT_BACKOFF_FREE_FAILURES) {
+        return 0;
+    }
+    uint32_t backoff = CONNECT_BACKOFF_BASE_SEC;
+    for (uint8_t ii = CONNECT_BACKOFF_FREE_FAILURES + 1; ii < streak && backoff < CONNECT_BACKOFF_MAX_SEC; ii++) {
+        backoff *= 2;
+    }
+    return backoff < CONNECT_BACKOFF_MAX_SEC ? backoff : CONNECT_BACKOFF_MAX_SEC;
+#else
+    return 0;
+#endif
+}
+
+uint32_t backoffRemainingSec() {
+    time_t until = sysStatus.get_connectBackoffUntil();
+    if (until == 0 || !Time.isValid()) {
+        return 0;
+    }
+    time_t now = Time.now();
+    if (now >= until) {
+        return 0;
+    }
+    // A clock step backwards cannot stretch it past the longest backoff
+    uint32_t remaining = (uint32_t)(until - now);
+    return remaining < CONNECT_BACKOFF_MAX_SEC ? remaining : CONNECT_BACKOFF_MAX_SEC;
+}
+
+static void cloudStatusHandler(system_event_t event, int param) {
+    switch (param) {
+    case cloud_status_connected:
+        if (droppedSinceConnect) {
+            pendingReconnects.fetch_add(1, std::memory_order_relaxed);
+        }
+        connectedAtMs = millis() | 1;
+        disconnectRequested = false;
+        droppedSinceConnect = false;
+        break;
+
+    case cloud_status_disconnecting:
+        disconnectRequested = true;
+        break;
+
+    case cloud_status_disconnected:
+        if (connectedAtMs != 0 && !disconnectRequested) {
+            pendingDrops.fetch_add(1, std::memory_order_relaxed);
+            pendingDropAfterSec.fetch_add((millis() - connectedAtMs) / 1000, std::memory_order_relaxed);
+            droppedSinceConnect = true;
+            uint8_t drops = dropsSinceReport.fetch_add(1, std::memory_order_relaxed) + 1;
+            if (CONNECT_FLAP_LIMIT > 0 && drops == CONNECT_FLAP_LIMIT) {
+                dampingStarted.store(true, std::memory_order_relaxed);
+            }
+        }
+        connectedAtMs = 0;
+        disconnectRequested = false;
+        break;
+
+    default:
+        break;
+    }
+}
+
+void setup() {
+    System.on(cloud_status, cloudStatusHandler);
+}
+
+void fold() {
+    uint16_t drops = pendingDrops.exchange(0, std::memory_order_relaxed);
+    uint16_t reconnects = pendingReconnects.exchange(0, std::memory_order_relaxed);
+    uint32_t dropAfterSec = pendingDropAfterSec.exchange(0, std::memory_order_relaxed);
+    if (drops == 0 && reconnects == 0) {
+        return;
+    }
+    auto update = current.updateBatch();
+    current.set_cloudDrops(current.get_cloudDrops() + drops);
+    current.set_cloudReconnects(current.get_cloudReconnects() + reconnects);
+    current.set_cloudDropAfterSec(current.get_cloudDropAfterSec() + dropAfterSec);
+    if (drops) {
+        Log.info("Cloud dropped %u time(s), %u since the last report", (unsigned)drops, (unsigned)dropsSinceReport.load());
+    }
+}
+
+void noteScheduledReport() {
+    if (flapDamped()) {
+        Log.info("Flap damping ended by a scheduled report");
+    }
+    dropsSinceReport.store(0, std::memory_order_relaxed);
+    dampingStarted.store(false, std::memory_order_relaxed);
+}
+
+bool flapDamped() {
+    return CONNECT_FLAP_LIMIT > 0 && dropsSinceReport.load(std::memory_order_relaxed) >= CONNECT_FLAP_LIMIT;
+}
+
+bool takeFlapDamping() {
+    if (!dampingStarted.exchange(false, std::memory_order_relaxed)) {
+        return false;
+    }
+    current.set_flapDamps(current.get_flapDamps() + 1);
+    return true;
+}
+
+void writeStatus(JSONWriter &writer) {
+    writer.name("connect").beginObject();
+    writer.name("hist").beginArray();
+    for (size_t ii = 0; ii < NUM_BUCKETS; ii++) {
+        writer.value((int)sysStatus.get_connectHist(ii));
+    }
+    writer.endArray();
+    writer.name("fail").value((int)sysStatus.get_connectFailures());
+    writer.name("streak").value((int)sysStatus.get_connectFailStreak());
+    writer.name("budget").value((int)budgetSec());
+    writer.name("backoff").value((int)backoffRemainingSec());
+    writer.name("cold").value((int)sysStatus.get_coldDeferrals());
+    uint16_t drops = current.get_cloudDrops();
+    writer.name("drops").value((int)drops);
+    writer.name("dropAfterAvg").value(drops ? (int)(current.get_cloudDropAfterSec() / drops) : 0);
+    writer.name("reconnects").value((int)current.get_cloudReconnects());
+    writer.name("damped").value((int)current.get_flapDamps());
+    writer.endObject();
+}
+
+} // namespace ConnectHistory
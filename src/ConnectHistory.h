@@ -0,0 +1,133 @@
+/**
+ * @file ConnectHistory.h
+ * @brief Connect-time history and the connect budget learned from it.
+ *
+ * @details Each successful cloud connect adds its duration to a ten-bucket
+ *          histogram in sysStatus; each attempt that runs out of budget adds
+ *          a failure. When a bucket reaches HALVE_AT every count is halved,
+ *          so the history follows the site as coverage changes.
+ *
+ *          With CONNECT_BUDGET_ADAPTIVE, budgetSec() returns the 95th
+ *          percentile connect time, plus half again and CONNECT_BUDGET_MARGIN_SEC,
+ *          kept between 30 and 900 s. Failures count as attempts longer
+ *          than any success, so a site where more than 5% of attempts fail
+ *          keeps the configured budget. A good site stops spending five
+ *          minutes of modem power on an attempt that is not going to work,
+ *          and a marginal site gets the time it actually needs. After a
+ *          failed attempt the configured budget is allowed again until the
+ *          next success.
+ *
+ *          With CONNECT_BACKOFF_ENABLED, a run of failures also spaces the
+ *          attempts out: each failure past CONNECT_BACKOFF_FREE_FAILURES
+ *          sets sysStatus connectBackoffUntil, CONNECT_BACKOFF_BASE_SEC
+ *          ahead and doubling per failure up to CONNECT_BACKOFF_MAX_SEC.
+ *          Until then scheduled connects are skipped and reports stay
+ *          queued. A site in a dead zone stops spending a full budget of
+ *          modem time every hour. This is separate from ERROR_STATE's reset
+ *          escalation, and a success from any connect ends it.
+ *
+ *          A connect that succeeds can still drop. The cloud_status system
+ *          event counts each disconnect the firmware did not start (no
+ *          cloud_status_disconnecting first), how long the session lasted,
+ *          and each connect that follows a drop, into today's totals in
+ *          current. After CONNECT_FLAP_LIMIT drops since the last scheduled
+ *          report, flapDamped() holds off every connect but the next
+ *          scheduled report's.
+ */
+
+#ifndef __CONNECTHISTORY_H
+#define __CONNECTHISTORY_H
+
+#include "Particle.h"
+
+namespace ConnectHistory {
+
+/** @brief Number of buckets; must match sysStatus connectHist[]. */
+static constexpr size_t NUM_BUCKETS = 10;
+
+/** @brief Upper limit of each bucket in seconds; the last bucket is open-ended. */
+extern const uint16_t BUCKET_LIMITS_SEC[NUM_BUCKETS - 1];
+
+/** @brief A bucket count that triggers halving of the whole histogram. */
+static constexpr uint16_t HALVE_AT = 200;
+
+/** @brief Shortest and longest budget budgetSec() will return. */
+static constexpr uint16_t MIN_BUDGET_SEC = 30;
+static constexpr uint16_t MAX_BUDGET_SEC = 900;
+
+/**
+ * @brief Record a successful connect that took @p seconds
+ */
+void recordSuccess(uint32_t seconds);
+
+/**
+ * @brief Record an attempt that ran out of budget
+ */
+void recordFailure();
+
+/**
+ * @brief Successful connects in the histogram
+ */
+uint32_t samples();
+
+/**
+ * @brief Configured budget: connectAttemptBudgetSec if valid, else maxConnectAttemptMs
+ */
+uint32_t configuredSec();
+
+/**
+ * @brief Connect budget for the next attempt
+ *
+ * @return configuredSec() until CONNECT_BUDGET_MIN_SAMPLES connects are
+ *         recorded, while more than 5% of attempts fail, or always when
+ *         CONNECT_BUDGET_ADAPTIVE is 0
+ */
+uint32_t budgetSec();
+
+/**
+ * @brief Backoff after @p streak consecutive failures, in seconds (0 = none)
+ */
+uint32_t backoffSec(uint8_t streak);
+
+/**
+ * @brief Seconds left before a scheduled connect may be tried (0 = go ahead)
+ */
+uint32_t backoffRemainingSec();
+
+/**
+ * @brief Register the cloud_status handler that counts drops and reconnects
+ */
+void setup();
+
+/**
+ * @brief Move drops and reconnects counted on the system thread into current
+ */
+void fold();
+
+/**
+ * @brief A scheduled report is starting: count drops from zero and end any damping
+ */
+void noteScheduledReport();
+
+/**
+ * @brief true while connects are held off for flapping (CONNECT_FLAP_LIMIT drops since the last scheduled report)
+ */
+bool flapDamped();
+
+/**
+ * @brief true once each time damping starts, for the caller that tears the connection down
+ */
+bool takeFlapDamping();
+
+/**
+ * @brief Write {"hist":[...],"fail":n,"streak":n,"budget":s,"backoff":s,"cold":n,
+ *        "drops":n,"dropAfterAvg":s,"reconnects":n,"damped":n} to an open JSON object as "connect"
+ *
+ * @details drops, dropAfterAvg (mean seconds from connect to drop), reconnects
+ *          and damped (times damping started) are today's.
+ */
+void writeStatus(JSONWriter &writer);
+
+} // namespace ConnectHistory
+
+#endif /* __CONNECTHISTORY_H */
@@ -14,6 +14,16 @@ inline bool isRadioPoweredOn() {
 #endif
 }
 
+inline bool isNetworkReady() {
+#if Wiring_WiFi
+  return WiFi.ready();
+#elif Wiring_Cellular
+  return Cellular.ready();
+#else
+  return false;
+#endif
+}
+
 inline void requestRadioPowerOff() {
 #if Wiring_Cellular
   Cellular.disconnect();
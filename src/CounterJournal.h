@@ -0,0 +1,116 @@
+/**
+ * @file CounterJournal.h
+ * @brief Append-only journal for the hot counters in currentStatusData.
+ *
+ * @details Each counting batch appends one small record (count delta plus
+ *          last count time) to a journal file instead of rewriting the whole
+ *          current.dat structure. The journal is folded back into the base
+ *          file whenever currentStatusData is saved for any other reason, or
+ *          once it reaches COMPACT_RECORDS records.
+ *
+ *          Records carry the base file's journal generation. Every base save
+ *          bumps the generation before writing and truncates the journal
+ *          after, so a reset between the two can never replay deltas that
+ *          are already included in the base file.
+ */
+
+#ifndef COUNTERJOURNAL_H
+#define COUNTERJOURNAL_H
+
+#include "Particle.h"
+
+class CounterJournal {
+public:
+    /** @brief Journal records before the base file is rewritten. */
+    static constexpr uint16_t COMPACT_RECORDS = 64;
+
+    /** @brief Flash erase block size used for the erase estimate (P2 / Boron LittleFS). */
+    static constexpr uint32_t FLASH_BLOCK_SIZE = 4096;
+
+    /**
+     * @brief Write accounting since boot.
+     *
+     * logicalBytes counts the field bytes that actually changed (counters
+     * and last count time); the physical counts are what reached the file
+     * system. Erases are an upper-bound estimate: one block per base
+     * rewrite plus one each time the journal crosses a block boundary.
+     */
+    struct Stats {
+        uint32_t records;          ///< Journal records appended
+        uint32_t journalBytes;     ///< Bytes appended to the journal
+        uint32_t baseWrites;       ///< Full rewrites of the base file
+        uint32_t baseBytes;        ///< Bytes written by base rewrites
+        uint32_t logicalBytes;     ///< Changed field bytes represented by the writes
+        uint32_t compactions;      ///< Base rewrites that folded in journal records
+        uint32_t eraseEstimate;    ///< Estimated flash block erases
+
+        /** @brief Physical bytes written per logical byte changed (0 if nothing changed). */
+        float writeAmplification() const {
+            return logicalBytes ? (float)(journalBytes + baseBytes) / logicalBytes : 0.0f;
+        }
+    };
+
+    /**
+     * @brief Get singleton instance
+     */
+    static CounterJournal& instance() {
+        static CounterJournal _instance;
+        return _instance;
+    }
+
+    /**
+     * @brief Append a counter delta.
+     * @return false if the record could not be written; the caller must
+     *         then persist the change through a normal base save
+     */
+    bool append(uint16_t delta, time_t lastCountTime, uint16_t generation);
+
+    /**
+     * @brief Sum the valid records of @p generation.
+     *
+     * Reading stops at the first torn or corrupt record. Records from other
+     * generations are skipped; they are already in the base file.
+     *
+     * @return Number of records applied
+     */
+    size_t replay(uint16_t generation, uint32_t& delta, time_t& lastCountTime);
+
+    /**
+     * @brief Record a base file rewrite and empty the journal.
+     */
+    void noteBaseWrite(size_t bytes);
+
+    /** @brief Records appended since the last base write. */
+    uint16_t pendingRecords() const { return _pending; }
+
+    /** @brief true once the journal is long enough to fold into the base file. */
+    bool needsCompaction() const { return _pending >= COMPACT_RECORDS; }
+
+    const Stats& stats() const { return _stats; }
+
+private:
+    CounterJournal() : _stats(), _pending(0), _fileBytes(0) {}
+    CounterJournal(const CounterJournal&) = delete;
+    CounterJournal& operator=(const CounterJournal&) = delete;
+
+    /** @brief On-flash record (12 bytes). */
+    struct Record {
+        uint8_t  tag;              ///< RECORD_TAG
+        uint8_t  check;            ///< Sum of the other 11 bytes, inverted
+        uint16_t generation;       ///< Base file generation this delta applies to
+        uint16_t delta;            ///< Events counted
+        uint16_t reserved;
+        uint32_t lastCountTime;    ///< Time of the last event in the batch
+    };
+    static_assert(sizeof(Record) == 12, "CounterJournal::Record must stay 12 bytes");
+
+    static constexpr uint8_t RECORD_TAG = 0xC7;
+
+    static uint8_t checksum(const Record& rec);
+
+    Stats _stats;
+    uint16_t _pending;             // Records since the last base write
+    uint32_t _fileBytes;           // Current journal length, for the erase estimate
+};
+
+#endif /* COUNTERJOURNAL_H */
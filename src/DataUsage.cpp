@@ -0,0 +1,113 @@
+#include "DataUsage.h"
+#include "Config.h"
+#include "MyPersistentData.h"
+#include "ProjectConfig.h"
+#include "PublishQueuePosixRK.h"
+#include <atomic>
+#include <string.h>
+
+namespace DataUsage {
+
+static_assert(currentStatusData::DATA_CATEGORIES == NUM_CATEGORIES, "One current.dat total per DataUsage category");
+
+// Bytes not yet folded into current.dat
+static std::atomic<uint32_t> pending[NUM_CATEGORIES];
+
+void setup() {
+#if DATA_USAGE_ENABLED
+    PublishQueuePosix::instance().withPublishCompleteUserCallback(
+        [](bool, const char *eventName, const char *eventData) {
+            // A failed publish went out too; only the acknowledgement is missing
+            note(classify(eventName), (eventName ? strlen(eventName) : 0) + (eventData ? strlen(eventData) : 0));
+        });
+    if (System.resetReason() == RESET_REASON_UPDATE) {
+        note(OTA, DATA_USAGE_OTA_BYTES);
+    }
+#endif
+}
+
+void note(Category category, size_t payloadBytes, uint8_t messages) {
+#if DATA_USAGE_ENABLED
+    if (category < NUM_CATEGORIES) {
+        pending[category].fetch_add((uint32_t)(payloadBytes + (size_t)messages * DATA_USAGE_MESSAGE_OVERHEAD),
+                                    std::memory_order_relaxed);
+    }
+#endif
+}
+
+Category classify(const char *eventName) {
+    static const char *const reportEvents[] = {
+        ProjectConfig::webhookEventName(),
+        ProjectConfig::webhookBatchEventName(),
+        ProjectConfig::webhookCompactEventName(),
+        ProjectConfig::webhookDailyEventName(),
+        ProjectConfig::loraNodesEventName(),
+        ProjectConfig::rainEventName(),
+        ProjectConfig::liveCountEventName(),
+        ProjectConfig::occupancyEventName(),
+        "history",
+    };
+    if (!eventName) {
+        return DIAGNOSTIC;
+    }
+    for (size_t ii = 0; ii < sizeof(reportEvents) / sizeof(reportEvents[0]); ii++) {
+        if (strcmp(eventName, reportEvents[ii]) == 0) {
+            return REPORT;
+        }
+    }
+    if (strcmp(eventName, "status") == 0 || strcmp(eventName, "bootProfile") == 0) {
+        return STARTUP;
+    }
+    if (strcmp(eventName, "otaDeferred") == 0) {
+        return OTA;
+    }
+    return DIAGNOSTIC;
+}
+
+void fold() {
+#if DATA_USAGE_ENABLED
+    auto update = current.updateBatch();
+    for (size_t ii = 0; ii < NUM_CATEGORIES; ii++) {
+        uint32_t bytes = pending[ii].exchange(0, std::memory_order_relaxed);
+        if (bytes) {
+            current.set_dataBytes(ii, current.get_dataBytes(ii) + bytes);
+        }
+    }
+#endif
+}
+
+uint32_t bytesToday(Category category) {
+    if (category >= NUM_CATEGORIES) {
+        return 0;
+    }
+    return current.get_dataBytes(category) + pending[category].load(std::memory_order_relaxed);
+}
+
+const char *categoryName(Category category) {
+    switch (category) {
+    case REPORT:          return "report";
+    case LEDGER_STATUS:   return "status";
+    case LEDGER_DATA:     return "data";
+    case LEDGER_SETTINGS: return "settings";
+    case DIAGNOSTIC:      return "diag";
+    case STARTUP:         return "startup";
+    case OTA:             return "ota";
+    case TIME_SYNC:       return "time";
+    case SESSION:         return "session";
+    default:              return "?";
+    }
+}
+
+void writeDay(JSONWriter &writer) {
+    uint32_t total = 0;
+    writer.name("bytes").beginObject();
+    for (size_t ii = 0; ii < NUM_CATEGORIES; ii++) {
+        uint32_t bytes = bytesToday((Category)ii);
+        writer.name(categoryName((Category)ii)).value((unsigned long)bytes);
+        total += bytes;
+    }
+    writer.name("total").value((unsigned long)total);
+    writer.endObject();
+}
+
+} // namespace DataUsage
@@ -0,0 +1,80 @@
+/**
+ * @file DataUsage.h
+ * @brief Estimated cloud data use by category, rolled up daily.
+ *
+ * @details Every publish the queue sends is classified by event name and
+ *          counted as its name and data plus DATA_USAGE_MESSAGE_OVERHEAD.
+ *          Ledger writes (device-status, device-data) and settings syncs
+ *          are counted at their JSON size, an upper bound on the CBOR
+ *          Device OS sends. A time sync is one request and its response, a
+ *          cloud session DATA_USAGE_SESSION_BYTES, and a boot after an OTA
+ *          update DATA_USAGE_OTA_BYTES.
+ *
+ *          note() only adds to RAM counters and may be called from any
+ *          thread (the publish-complete callback runs on the background
+ *          publish thread, ledger syncs on the system thread). fold() moves
+ *          them into current.dat; EnergyLedger calls it at each of its
+ *          checkpoints, before sleep and before the daily report, which
+ *          carries the day's totals (writeDay()).
+ */
+
+#ifndef __DATAUSAGE_H
+#define __DATAUSAGE_H
+
+#include "Particle.h"
+
+namespace DataUsage {
+
+/** @brief What the bytes were for; the order of current dataBytes[]. */
+enum Category : uint8_t {
+    REPORT = 0,         ///< Webhook reports, batches, backfill, live and occupancy updates
+    LEDGER_STATUS,      ///< device-status writes
+    LEDGER_DATA,        ///< device-data writes
+    LEDGER_SETTINGS,    ///< default-settings and device-settings syncs
+    DIAGNOSTIC,         ///< Diagnostic and verbose-mode events
+    STARTUP,            ///< Startup status and boot profile
+    OTA,                ///< Firmware updates and deferral notices
+    TIME_SYNC,          ///< Particle.syncTime()
+    SESSION,            ///< Cloud session setup per connect
+    NUM_CATEGORIES
+};
+
+/**
+ * @brief Register the publish callback; credit an OTA update if this boot followed one
+ */
+void setup();
+
+/**
+ * @brief Count @p payloadBytes sent or received for @p category in @p messages
+ *        CoAP exchanges (each adds DATA_USAGE_MESSAGE_OVERHEAD); any thread
+ */
+void note(Category category, size_t payloadBytes, uint8_t messages = 1);
+
+/**
+ * @brief Category of a published event, by name
+ */
+Category classify(const char *eventName);
+
+/**
+ * @brief Move the RAM counters into current.dat; application thread
+ */
+void fold();
+
+/**
+ * @brief Bytes today in @p category, including those not yet folded
+ */
+uint32_t bytesToday(Category category);
+
+/**
+ * @brief Short name of a category, as used in the daily report
+ */
+const char *categoryName(Category category);
+
+/**
+ * @brief Write today's bytes to an open JSON object as "bytes":{"<category>":n,...,"total":n}
+ */
+void writeDay(JSONWriter &writer);
+
+} // namespace DataUsage
+
+#endif /* __DATAUSAGE_H */
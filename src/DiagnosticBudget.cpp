@@ -0,0 +1,139 @@
+#include "DiagnosticBudget.h"
+#include "Config.h"
+#include "Payload.h"
+#include "StorageHelperRK.h"
+#include <string.h>
+
+namespace DiagnosticBudget {
+
+// Tokens are kept in thousandths so the refill needs no floating point
+static constexpr uint32_t TOKEN = 1000;
+
+struct Bucket {
+    uint32_t tokens;            // Thousandths of a token
+    uint32_t lastRefill;        // clockSec() at the last refill
+};
+
+struct TypeState {
+    const char *name;           // Event names are string literals; nullptr = free
+    Bucket bucket;
+    uint32_t lastHash;          // Hash of the last data seen for this name
+    uint16_t repeats;           // Repeats of lastHash since the last one sent
+    uint16_t suppressed;        // Suppressed since the last summary
+};
+
+static Bucket global = {DIAG_BUDGET_PER_HOUR * TOKEN, 0};
+static TypeState types[MAX_TYPES];
+static uint32_t summaryDue = 0;         // clockSec() when the next summary may go
+static uint32_t totalSuppressed = 0;
+
+// Seconds on a clock that keeps running through sleep when time is valid
+static uint32_t clockSec() {
+    return Time.isValid() ? (uint32_t)Time.now() : (uint32_t)(millis() / 1000);
+}
+
+// Add the tokens earned since the last refill, up to an hour's worth, and
+// take one if there is one
+static bool take(Bucket &bucket, uint32_t perHour, uint32_t now) {
+    uint32_t capacity = perHour * TOKEN;
+    if (bucket.lastRefill == 0 || now < bucket.lastRefill) {
+        // First use, or the clock moved from uptime to wall time
+        bucket.lastRefill = now;
+    }
+    uint32_t elapsed = now - bucket.lastRefill;
+    if (elapsed > 0) {
+        uint32_t earned = (elapsed >= 3600) ? capacity : (elapsed * capacity) / 3600;
+        bucket.tokens = (bucket.tokens + earned > capacity) ? capacity : bucket.tokens + earned;
+        bucket.lastRefill = now;
+    }
+    return bucket.tokens >= TOKEN;
+}
+
+static TypeState &typeFor(const char *eventName) {
+    for (size_t ii = 0; ii < MAX_TYPES - 1; ii++) {
+        if (types[ii].name == nullptr) {
+            types[ii].name = eventName;
+            types[ii].bucket.tokens = DIAG_TYPE_BUDGET_PER_HOUR * TOKEN;
+            return types[ii];
+        }
+        if (types[ii].name == eventName || strcmp(types[ii].name, eventName) == 0) {
+            return types[ii];
+        }
+    }
+    TypeState &other = types[MAX_TYPES - 1];
+    if (other.name == nullptr) {
+        other.name = "other";
+        other.bucket.tokens = DIAG_TYPE_BUDGET_PER_HOUR * TOKEN;
+    }
+    return other;
+}
+
+bool allow(const char *eventName, const char *data) {
+    uint32_t now = clockSec();
+    if (summaryDue == 0) {
+        summaryDue = now + 3600;
+    }
+    TypeState &type = typeFor(eventName);
+
+    // Repeats are sampled before they are budgeted
+    size_t dataLen = data ? strlen(data) : 0;
+    uint32_t hash = StorageHelperRK::murmur3_32((const uint8_t *)(data ? data : ""), dataLen,
+                                               StorageHelperRK::PersistentDataBase::HASH_SEED);
+    bool repeat = (hash == type.lastHash);
+    type.lastHash = hash;
+    bool sampled = true;
+    if (repeat) {
+        type.repeats++;
+        sampled = DIAG_REPEAT_SAMPLE <= 1 || (type.repeats % DIAG_REPEAT_SAMPLE) == 0;
+    } else {
+        type.repeats = 0;
+    }
+
+    // Refill both before taking from either, so neither is spent alone
+    bool typeOk = take(type.bucket, DIAG_TYPE_BUDGET_PER_HOUR, now);
+    bool globalOk = take(global, DIAG_BUDGET_PER_HOUR, now);
+    if (!sampled || !typeOk || !globalOk) {
+        if (type.suppressed < 0xffff) {
+            type.suppressed++;
+        }
+        totalSuppressed++;
+        Log.info("Diagnostic suppressed (%s): %s", !sampled ? "repeat" : "budget", eventName);
+        return false;
+    }
+    type.bucket.tokens -= TOKEN;
+    global.tokens -= TOKEN;
+    return true;
+}
+
+bool summary(char *buf, size_t size) {
+    uint32_t now = clockSec();
+    if (summaryDue == 0 || (int32_t)(now - summaryDue) < 0) {
+        return false;
+    }
+    summaryDue = now + 3600;
+
+    uint32_t suppressed = 0;
+    for (size_t ii = 0; ii < MAX_TYPES; ii++) {
+        suppressed += types[ii].suppressed;
+    }
+    if (suppressed == 0) {
+        return false;
+    }
+
+    Payload::Writer writer(buf, size);
+    writer.beginObject().add("suppressed", (unsigned long)suppressed).beginObject("by");
+    for (size_t ii = 0; ii < MAX_TYPES; ii++) {
+        if (types[ii].name && types[ii].suppressed) {
+            writer.add(types[ii].name, (unsigned)types[ii].suppressed);
+        }
+        types[ii].suppressed = 0;
+    }
+    writer.endObject().endObject();
+    return writer.ok();
+}
+
+uint32_t suppressedTotal() {
+    return totalSuppressed;
+}
+
+} // namespace DiagnosticBudget
@@ -0,0 +1,59 @@
+/**
+ * @file DiagnosticBudget.h
+ * @brief Hourly rate budget for diagnostic events.
+ *
+ * @details publishDiagnosticSafe() asks allow() before queueing anything.
+ *          Two token buckets have to agree: one for all diagnostics,
+ *          DIAG_BUDGET_PER_HOUR, and one per event name,
+ *          DIAG_TYPE_BUDGET_PER_HOUR. Each holds at most an hour's tokens
+ *          and refills continuously, from wall time when it is valid so a
+ *          sleep counts. A burst (the dailyCleanup() reports) still goes
+ *          out, but a message in a loop cannot take the queue or the data
+ *          plan with it.
+ *
+ *          A message with the same data as the last one of its name is a
+ *          repeat. Only every DIAG_REPEAT_SAMPLE-th repeat spends a token
+ *          and is sent; the rest are suppressed like the ones over budget.
+ *
+ *          Suppressed messages are counted per name. Once an hour, if any
+ *          were, summary() gives {"suppressed":n,"by":{"Cellular":3,...}}
+ *          for a "diagSuppressed" event, which does not spend a token, and
+ *          the counts start again.
+ *
+ *          Application thread only.
+ */
+
+#ifndef __DIAGNOSTICBUDGET_H
+#define __DIAGNOSTICBUDGET_H
+
+#include "Particle.h"
+
+namespace DiagnosticBudget {
+
+/** @brief Event names tracked separately; more share the last entry. */
+static constexpr size_t MAX_TYPES = 10;
+
+/**
+ * @brief Whether a diagnostic @p eventName with @p data may be sent now
+ *
+ * @details Spends the tokens when it returns true; counts a suppression
+ *          when it returns false.
+ */
+bool allow(const char *eventName, const char *data);
+
+/**
+ * @brief Format the suppression summary once it is due
+ *
+ * @return false if it is not due yet or nothing was suppressed; otherwise
+ *         true, and the counts are cleared
+ */
+bool summary(char *buf, size_t size);
+
+/**
+ * @brief Messages suppressed since boot
+ */
+uint32_t suppressedTotal();
+
+} // namespace DiagnosticBudget
+
+#endif /* __DIAGNOSTICBUDGET_H */
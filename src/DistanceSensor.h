@@ -0,0 +1,60 @@
+// src/DistanceSensor.h
+#ifndef DISTANCESENSOR_H
+#define DISTANCESENSOR_H
+
+#include "AnalogBurstSensor.h"
+#include "Config.h"
+#include "device_pinout.h"
+
+/**
+ * @brief Analog-output ultrasonic/TOF range finder on analogSensePin.
+ *
+ * Written for MaxBotix HRLV-style modules (analog output Vcc/5120 per
+ * mm), powered through disableModule (active LOW) only during a burst.
+ * A range finder confirming PIR events (FUSION_RANGE_CM) is on
+ * rangePower instead, so the PIR's supply does not keep it on.
+ * The module needs ~50 ms after power-up before its first valid range,
+ * so the settle time dominates the on-time; a median over a short
+ * burst rejects the occasional multipath outlier.
+ *
+ * Output (SensorData):
+ * - primary:   distance in cm
+ * - secondary: reduced raw ADC count
+ * - flag1:     target present (distance below the module's max-range reading)
+ */
+class DistanceSensor : public AnalogBurstSensor {
+public:
+    /**
+     * @brief Get singleton instance
+     */
+    static DistanceSensor& instance() {
+        static DistanceSensor _instance;
+        return _instance;
+    }
+
+    const char* getSensorType() const override { return "Distance"; }
+
+protected:
+    bool convert(uint16_t raw, SensorData& data) override {
+        // With Vcc == ADC reference: mm = raw * 5120 / 4096 = raw * 1.25
+        uint32_t mm = ((uint32_t)raw * 5UL) / 4UL;
+        static const uint32_t MIN_MM = 300;    // HRLV reports 300 mm for closer targets
+        static const uint32_t MAX_MM = 5000;   // Reported when no target is seen
+
+        if (mm < MIN_MM - 50) {
+            return false;  // Below the module's floor: not a valid reading
+        }
+        data.primary = (uint16_t)((mm + 5) / 10);
+        data.secondary = raw;
+        data.flag1 = mm < MAX_MM - 100;
+        return true;
+    }
+
+private:
+    DistanceSensor()
+        : AnalogBurstSensor(Config{analogSensePin, true, 50, 8, 2,
+                                   FUSION_RANGE_CM > 0 ? PowerDomains::RANGE : PowerDomains::SENSOR},
+                            SensorType::DISTANCE) {}
+};
+
+#endif /* DISTANCESENSOR_H */
@@ -0,0 +1,259 @@
+// src/DualPirSensor.cpp
+#include "DualPirSensor.h"
+#include "TraceLog.h"
+
+EventRing<uint32_t, 32> DualPirSensor::_edgeRing;
+volatile uint32_t DualPirSensor::_isrCount[2] = {0, 0};
+volatile bool DualPirSensor::_stormTripped = false;
+volatile uint32_t DualPirSensor::_windowStartMs = 0;
+volatile uint32_t DualPirSensor::_windowEdges = 0;
+
+// micros() with the channel in the low bit; 1 us is far below the gap
+static inline uint32_t stamp(uint32_t channel) {
+    return ((uint32_t)micros() & ~(uint32_t)1) | channel;
+}
+
+void DualPirSensor::edgeA() {
+    pushEdge(0);
+}
+
+void DualPirSensor::edgeB() {
+    pushEdge(CHANNEL_B);
+}
+
+void DualPirSensor::pushEdge(uint32_t channel) {
+    _isrCount[channel]++;
+    if (_stormTripped) {
+        return;     // checkStorm() detaches us; queue nothing until then
+    }
+    uint32_t nowMs = millis();
+    if (nowMs - _windowStartMs >= 1000) {
+        _windowStartMs = nowMs;
+        _windowEdges = 0;
+    }
+    if (++_windowEdges > SENSOR_STORM_EDGES_PER_SEC) {
+        _stormTripped = true;
+        return;
+    }
+    _edgeRing.push(stamp(channel));
+}
+
+bool DualPirSensor::setup() {
+    pinMode(intPin, INPUT_PULLDOWN);
+    pinMode(intPinB, INPUT_PULLDOWN);
+    powerUp();
+    attachBoth();
+    reset();
+    _isReady = true;
+    Log.info("Dual PIR ready (A on intPin, B on intPinB, %d ms gap)", DIRECTION_GAP_MS);
+    return true;
+}
+
+bool DualPirSensor::loop() {
+    SensorEvent event;
+    return drain(&event, 1) == 1;
+}
+
+void DualPirSensor::takeEdges() {
+    uint32_t edge;
+    while (_heldCount < MAX_HELD && _edgeRing.pop(edge)) {
+        _held[_heldCount++] = edge;
+    }
+}
+
+void DualPirSensor::dropHeld(size_t index) {
+    for (size_t ii = index + 1; ii < _heldCount; ii++) {
+        _held[ii - 1] = _held[ii];
+    }
+    _heldCount--;
+}
+
+size_t DualPirSensor::drain(SensorEvent* out, size_t max) {
+    if (!_isReady || !out || max == 0) {
+        return 0;
+    }
+    checkStorm();
+
+    const uint32_t gapUs = DIRECTION_GAP_MS * 1000UL;
+    size_t n = 0;
+    while (n < max) {
+        takeEdges();
+        if (_heldCount == 0) {
+            break;
+        }
+        // Read after takeEdges(), so no held stamp is later than nowUs
+        uint32_t nowUs = micros();
+        uint32_t nowMs = millis();
+
+        // The oldest edge pairs with the first edge of the other channel in the window
+        uint32_t first = _held[0];
+        size_t partner = 0;
+        for (size_t ii = 1; ii < _heldCount && _held[ii] - first <= gapUs; ii++) {
+            if ((_held[ii] & CHANNEL_B) != (first & CHANNEL_B)) {
+                partner = ii;
+                break;
+            }
+        }
+        if (partner == 0 && nowUs - first <= gapUs && _heldCount < MAX_HELD) {
+            break;      // The other channel may still fire
+        }
+
+        // Stamped when the crossing completed
+        uint32_t lastUs = partner ? _held[partner] : first;
+        out[n] = SensorEvent();
+        out[n].type = SensorType::DUAL_PIR;
+        out[n].tickMs = nowMs - (nowUs - lastUs) / 1000UL;
+        if (partner) {
+            uint32_t transitMs = (lastUs - first) / 1000UL;
+            out[n].flags = (first & CHANNEL_B) ? SensorEvent::DIR_OUT : SensorEvent::DIR_IN;
+            out[n].primary = (uint16_t)(transitMs > 0xffff ? 0xffff : transitMs);
+            dropHeld(partner);
+        } else {
+            _unpaired++;
+        }
+        dropHeld(0);
+
+        _data.timestamp = out[n].unixTime();
+        _data.hasNewData = true;
+        _data.primary = out[n].primary;
+        _data.flag1 = (out[n].flags & SensorEvent::DIR_IN) != 0;
+        _data.flag2 = (out[n].flags & SensorEvent::DIR_OUT) != 0;
+        _data.aux1 = (uint16_t)(_unpaired > 0xffff ? 0xffff : _unpaired);
+        n++;
+    }
+
+    uint32_t overflows = _edgeRing.overflows();
+    if (overflows != _lastOverflowCount) {
+        Log.warn("Dual PIR edge ring overflow: %lu edges dropped",
+                 (unsigned long)(overflows - _lastOverflowCount));
+        _lastOverflowCount = overflows;
+    }
+    return n;
+}
+
+void DualPirSensor::reset() {
+    _data = SensorData();
+    _data.type = SensorType::DUAL_PIR;
+    _edgeRing.clear();
+    _heldCount = 0;
+    _unpaired = 0;
+}
+
+void DualPirSensor::armWakeCapture() {
+    _isrCountAtArm[0] = _isrCount[0];
+    _isrCountAtArm[1] = _isrCount[1];
+}
+
+bool DualPirSensor::injectWakeEvent() {
+    if (_stormActive) {
+        return false;
+    }
+    // A PIR pulse lasts seconds, so an edge the ISR missed leaves its line
+    // high; if both were missed the order is lost and they go in A, B
+    bool injected = false;
+    if (_isrCount[0] == _isrCountAtArm[0] && digitalRead(intPin) == HIGH) {
+        _edgeRing.push(stamp(0));
+        injected = true;
+    }
+    if (_isrCount[1] == _isrCountAtArm[1] && digitalRead(intPinB) == HIGH) {
+        _edgeRing.push(stamp(CHANNEL_B));
+        injected = true;
+    }
+    return injected;
+}
+
+bool DualPirSensor::injectEdge() {
+    if (!_isReady) {
+        return false;
+    }
+    _edgeRing.push(stamp(0));
+    return true;
+}
+
+void DualPirSensor::onSleep() {
+    if (!_isReady) {
+        return;
+    }
+    detachBoth();
+    PowerDomains::release(PowerDomains::SENSOR, this);
+    PowerDomains::release(PowerDomains::SENSOR_LED, this);
+    _isReady = false;
+    Log.info("Dual PIR powered down for sleep");
+}
+
+bool DualPirSensor::onWake() {
+    // As with PIRSensor, the ring is kept: it may hold the wake edge
+    pinMode(intPin, INPUT_PULLDOWN);
+    pinMode(intPinB, INPUT_PULLDOWN);
+    powerUp();
+    if (!_stormActive) {
+        attachBoth();       // checkStorm() re-attaches after a storm
+    }
+    _isReady = true;
+    Log.info("Dual PIR powered up after wake (interrupts attached)");
+    return true;
+}
+
+void DualPirSensor::powerUp() {
+    PowerDomains::acquire(PowerDomains::SENSOR, this);
+#if INDICATOR_LEDS
+    PowerDomains::acquire(PowerDomains::SENSOR_LED, this);
+#endif
+}
+
+void DualPirSensor::attachBoth() {
+    attachInterrupt(intPin, edgeA, RISING);
+    attachInterrupt(intPinB, edgeB, RISING);
+}
+
+void DualPirSensor::detachBoth() {
+    detachInterrupt(intPin);
+    detachInterrupt(intPinB);
+}
+
+void DualPirSensor::checkStorm() {
+    uint32_t nowMs = millis();
+
+    if (!_stormActive) {
+        if (!_stormTripped) {
+            return;
+        }
+        detachBoth();
+        _stormActive = true;
+        _storms++;
+        _edgeRing.clear();      // Noise, not crossings
+        _heldCount = 0;
+        _pollLevel[0] = digitalRead(intPin);
+        _pollLevel[1] = digitalRead(intPinB);
+        _pollChanges = 0;
+        _quietStartMs = nowMs;
+        TraceLog::record(TraceLog::SENSOR_STORM, (int32_t)_storms);
+        Log.error("Dual PIR interrupt storm #%lu (>%d edges/s): interrupts detached, polling the lines",
+                  (unsigned long)_storms, SENSOR_STORM_EDGES_PER_SEC);
+        return;
+    }
+
+    // Polling: any change, or either line held high, restarts the quiet period
+    int levels[2] = {digitalRead(intPin), digitalRead(intPinB)};
+    for (size_t ii = 0; ii < 2; ii++) {
+        if (levels[ii] != _pollLevel[ii]) {
+            _pollLevel[ii] = levels[ii];
+            _pollChanges++;
+            _quietStartMs = nowMs;
+        } else if (levels[ii] == HIGH) {
+            _quietStartMs = nowMs;
+        }
+    }
+    if (nowMs - _quietStartMs < SENSOR_STORM_QUIET_SEC * 1000UL) {
+        return;
+    }
+
+    Log.info("Dual PIR lines quiet for %d s (%lu changes polled): interrupts re-attached",
+             SENSOR_STORM_QUIET_SEC, (unsigned long)_pollChanges);
+    _windowEdges = 0;
+    _stormTripped = false;
+    _stormActive = false;
+    if (_isReady) {
+        attachBoth();
+    }
+}
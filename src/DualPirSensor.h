@@ -0,0 +1,152 @@
+// src/DualPirSensor.h
+#ifndef DUALPIRSENSOR_H
+#define DUALPIRSENSOR_H
+
+#include "ISensor.h"
+#include "Config.h"
+#include "EventRing.h"
+#include "Particle.h"
+#include "PowerDomains.h"
+#include "device_pinout.h"
+
+/**
+ * @brief Two PIR modules or break-beam sensors a short walk apart, on
+ *        intPin (channel A, the outside one) and intPinB (channel B).
+ *
+ * Both ISRs push a micros() stamp into one ring, with the channel in the
+ * low bit, so the order of the two edges of a crossing is the order they
+ * arrived in, not the order a loop pass happened to notice them. drain()
+ * pairs the oldest edge with the next edge of the other channel within
+ * DIRECTION_GAP_MS: A then B is one crossing in (SensorEvent::DIR_IN), B
+ * then A one out (DIR_OUT). Edges pair in arrival order, so two people
+ * close behind each other are A A B B, two crossings in. An edge with no
+ * partner by the end of the window is one event with no direction, so the
+ * hourly and daily totals still count everyone and in + out never exceed
+ * them.
+ *
+ * The device stays awake while an edge waits for its partner (isBusy()),
+ * and both pins wake a nap. Edges are not counted in hardware during naps:
+ * a counter cannot tell the channels apart.
+ *
+ * Output (SensorData):
+ * - primary:   transit time of the last crossing, ms (saturates)
+ * - flag1:     last crossing was in
+ * - flag2:     last crossing was out
+ * - aux1:      edges counted without a partner since setup (saturates)
+ */
+class DualPirSensor : public ISensor {
+public:
+    /**
+     * @brief Get singleton instance
+     */
+    static DualPirSensor& instance() {
+        static DualPirSensor _instance;
+        return _instance;
+    }
+
+    bool setup() override;
+    bool loop() override;
+    size_t drain(SensorEvent* out, size_t max) override;
+
+    const SensorData& getData() const override { return _data; }
+    const char* getSensorType() const override { return "DualPIR"; }
+    bool isReady() const override { return _isReady; }
+    void reset() override;
+
+    /**
+     * @brief false while an interrupt storm has the ISRs detached
+     */
+    bool isHealthy() const override { return !_stormActive && !_stormTripped; }
+
+    /**
+     * @brief true while an edge waits for the other channel
+     */
+    bool isBusy() const override { return _heldCount > 0 || !_edgeRing.empty(); }
+
+    bool usesInterrupt() const override { return true; }
+    WakeSource wakeSource() const override { return WakeSource::gpio(intPin, RISING); }
+    WakeSource secondWakeSource() const override { return WakeSource::gpio(intPinB, RISING); }
+
+    /**
+     * @brief Both modules chatter for PIR_WARMUP_SEC after power-on.
+     */
+    uint32_t warmupMs() const override { return PIR_WARMUP_SEC * 1000UL; }
+
+    void onSleep() override;
+    bool onWake() override;
+    void armWakeCapture() override;
+    bool injectWakeEvent() override;
+
+    /**
+     * @brief Queue a channel A edge stamped now, as the ISR would.
+     */
+    bool injectEdge() override;
+
+private:
+    DualPirSensor() {
+        _data.type = SensorType::DUAL_PIR;
+    }
+    ~DualPirSensor() {}
+    DualPirSensor(const DualPirSensor&) = delete;
+    DualPirSensor& operator=(const DualPirSensor&) = delete;
+
+    /** @brief Low bit of a ring entry: 0 for channel A, 1 for channel B. */
+    static constexpr uint32_t CHANNEL_B = 1;
+
+    /** @brief Edges drain() holds while they wait for a partner. */
+    static constexpr size_t MAX_HELD = 16;
+
+    /**
+     * @brief Move ring entries into _held, oldest first.
+     */
+    void takeEdges();
+
+    /**
+     * @brief Drop entry @p index of _held.
+     */
+    void dropHeld(size_t index);
+
+    /**
+     * @brief Hold the sensor supply, and the board LED with INDICATOR_LEDS.
+     */
+    void powerUp();
+
+    void attachBoth();
+    void detachBoth();
+
+    /**
+     * @brief Detach both ISRs when they have tripped, poll the lines while
+     *        detached, and re-attach once both have been quiet long enough.
+     */
+    void checkStorm();
+
+    bool _isReady = false;
+    SensorData _data;
+
+    uint32_t _held[MAX_HELD] = {};      // Ring entries waiting for a partner, oldest first
+    size_t _heldCount = 0;
+    uint32_t _unpaired = 0;
+    uint32_t _lastOverflowCount = 0;
+
+    // ISR counts at the last armWakeCapture()
+    uint32_t _isrCountAtArm[2] = {0, 0};
+
+    // Interrupt storm: detached and polling the lines until they are quiet
+    bool _stormActive = false;
+    uint32_t _storms = 0;
+    int _pollLevel[2] = {LOW, LOW};
+    uint32_t _pollChanges = 0;
+    uint32_t _quietStartMs = 0;
+
+    static EventRing<uint32_t, 32> _edgeRing;  // micros() | channel, ISRs -> drain()
+    static volatile uint32_t _isrCount[2];
+    static volatile bool _stormTripped;        // Set by an ISR past SENSOR_STORM_EDGES_PER_SEC
+    static volatile uint32_t _windowStartMs;   // ISR rate window, both channels together
+    static volatile uint32_t _windowEdges;
+
+    static void edgeA();
+    static void edgeB();
+    static void pushEdge(uint32_t channel);
+};
+
+#endif /* DUALPIRSENSOR_H */
@@ -0,0 +1,86 @@
+#include "EdgeCounter.h"
+#include "Config.h"
+
+#if HAL_PLATFORM_NRF52840
+#include "nrf.h"
+#include "pinmap_hal.h"
+#endif
+
+namespace EdgeCounter {
+
+static bool isArmed = false;
+
+#if HAL_PLATFORM_NRF52840
+
+static NRF_TIMER_Type *const counter = NRF_TIMER4;
+
+bool supported() {
+    return true;
+}
+
+bool arm(pin_t pin) {
+    if (isArmed) {
+        return true;
+    }
+    hal_pin_info_t *info = hal_pin_map() + pin;
+    uint32_t nrfPin = NRF_GPIO_PIN_MAP(info->gpio_port, info->gpio_pin);
+
+    counter->TASKS_STOP = 1;
+    counter->MODE = TIMER_MODE_MODE_LowPowerCounter << TIMER_MODE_MODE_Pos;
+    counter->BITMODE = TIMER_BITMODE_BITMODE_32Bit << TIMER_BITMODE_BITMODE_Pos;
+    counter->TASKS_CLEAR = 1;
+
+    // Event mode only: no GPIOTE interrupt, so an edge never runs code
+    NRF_GPIOTE->EVENTS_IN[EDGE_COUNT_GPIOTE_CHANNEL] = 0;
+    NRF_GPIOTE->CONFIG[EDGE_COUNT_GPIOTE_CHANNEL] =
+        (GPIOTE_CONFIG_MODE_Event << GPIOTE_CONFIG_MODE_Pos) |
+        ((nrfPin & 0x1F) << GPIOTE_CONFIG_PSEL_Pos) |
+        ((nrfPin >> 5) << GPIOTE_CONFIG_PORT_Pos) |
+        (GPIOTE_CONFIG_POLARITY_LoToHi << GPIOTE_CONFIG_POLARITY_Pos);
+
+    NRF_PPI->CH[EDGE_COUNT_PPI_CHANNEL].EEP = (uint32_t)&NRF_GPIOTE->EVENTS_IN[EDGE_COUNT_GPIOTE_CHANNEL];
+    NRF_PPI->CH[EDGE_COUNT_PPI_CHANNEL].TEP = (uint32_t)&counter->TASKS_COUNT;
+    NRF_PPI->CHENSET = 1UL << EDGE_COUNT_PPI_CHANNEL;
+
+    counter->TASKS_START = 1;
+    isArmed = true;
+    return true;
+}
+
+uint32_t disarm() {
+    if (!isArmed) {
+        return 0;
+    }
+    counter->TASKS_CAPTURE[0] = 1;
+    uint32_t edges = counter->CC[0];
+
+    NRF_PPI->CHENCLR = 1UL << EDGE_COUNT_PPI_CHANNEL;
+    NRF_GPIOTE->CONFIG[EDGE_COUNT_GPIOTE_CHANNEL] = 0;
+    counter->TASKS_STOP = 1;
+    counter->TASKS_SHUTDOWN = 1;
+    isArmed = false;
+    return edges;
+}
+
+#else
+
+bool supported() {
+    return false;
+}
+
+bool arm(pin_t pin) {
+    (void)pin;
+    return false;
+}
+
+uint32_t disarm() {
+    return 0;
+}
+
+#endif
+
+bool armed() {
+    return isArmed;
+}
+
+} // namespace EdgeCounter
@@ -0,0 +1,56 @@
+/**
+ * @file EdgeCounter.h
+ * @brief Count rising edges on a pin in hardware while the MCU sleeps.
+ *
+ * @details On the nRF52840 (Boron) a GPIOTE channel turns each rising edge
+ *          into an event, and a PPI channel routes that event to the COUNT
+ *          task of a TIMER in low-power counter mode. No interrupt is
+ *          involved, so the CPU stays asleep however many edges arrive; the
+ *          count is read once on the next wake.
+ *
+ *          The pin must not have attachInterrupt() on it while armed (one
+ *          GPIOTE channel per pin). The GPIOTE channel, PPI channel and
+ *          TIMER instance are chosen to stay clear of Device OS and the
+ *          SoftDevice (EDGE_COUNT_GPIOTE_CHANNEL, EDGE_COUNT_PPI_CHANNEL,
+ *          NRF_TIMER4). A running TIMER keeps the high-frequency clock
+ *          requested, which is why it is only armed in busy hours.
+ *
+ *          Other platforms (RTL872x on P2) have no equivalent that Device
+ *          OS leaves free during sleep; supported() is false there and
+ *          edges wake the MCU as before.
+ */
+
+#ifndef __EDGECOUNTER_H
+#define __EDGECOUNTER_H
+
+#include "Particle.h"
+
+namespace EdgeCounter {
+
+/**
+ * @brief Whether this platform can count edges in hardware
+ */
+bool supported();
+
+/**
+ * @brief Start counting rising edges on @p pin from zero
+ *
+ * @return false if unsupported; nothing is changed then
+ */
+bool arm(pin_t pin);
+
+/**
+ * @brief Stop counting and release the pin, GPIOTE, PPI and TIMER
+ *
+ * @return Edges seen since arm(), 0 if not armed
+ */
+uint32_t disarm();
+
+/**
+ * @brief true between arm() and disarm()
+ */
+bool armed();
+
+} // namespace EdgeCounter
+
+#endif /* __EDGECOUNTER_H */
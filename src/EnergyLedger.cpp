@@ -0,0 +1,244 @@
+#include "EnergyLedger.h"
+#include "Config.h"
+#include "Connectivity.h"
+#include "DataUsage.h"
+#include "MyPersistentData.h"
+#include "PowerDomains.h"
+#include "PowerPolicy.h"
+#include "SensorManager.h"
+#include "StateMachine.h"
+
+namespace EnergyLedger {
+
+// Milliseconds not yet folded into current.dat
+static uint32_t pendingMs[NUM_BUCKETS];
+static uint32_t lastTickMs;
+static uint32_t lastFoldMs;
+
+static bool sleeping = false;
+static bool sleepHibernate = false;
+static bool sleepSensorPowered = false;
+static bool sleepDomainOn[PowerDomains::NUM_DOMAINS];
+static time_t sleepStartTime = 0;
+static uint32_t sleepStartMs = 0;
+
+static_assert(NUM_BUCKETS - DOMAIN_BUCKETS == PowerDomains::NUM_DOMAINS, "One bucket per PowerDomains domain");
+static_assert(currentStatusData::ENERGY_DOMAINS == PowerDomains::NUM_DOMAINS, "One current.dat total per PowerDomains domain");
+
+// Seconds folded into current.dat; the domain buckets were added in a later field
+static uint32_t storedSec(size_t bucket) {
+    return bucket < DOMAIN_BUCKETS ? current.get_energySec(bucket)
+                                   : current.get_energyDomainSec(bucket - DOMAIN_BUCKETS);
+}
+
+static void fold() {
+    auto update = current.updateBatch();
+    for (size_t ii = 0; ii < NUM_BUCKETS; ii++) {
+        if (pendingMs[ii] < 1000) {
+            continue;
+        }
+        uint32_t sec = storedSec(ii) + pendingMs[ii] / 1000;
+        if (ii < DOMAIN_BUCKETS) {
+            current.set_energySec(ii, sec);
+        } else {
+            current.set_energyDomainSec(ii - DOMAIN_BUCKETS, sec);
+        }
+        pendingMs[ii] %= 1000;
+    }
+    DataUsage::fold();
+    lastFoldMs = millis();
+}
+
+static void tick() {
+    uint32_t nowMs = millis();
+    uint32_t elapsedMs = nowMs - lastTickMs;
+    lastTickMs = nowMs;
+
+    if ((size_t)state < STATE_BUCKETS) {
+        pendingMs[state] += elapsedMs;
+    }
+    if (Connectivity::isNetworkReady()) {
+        pendingMs[RADIO] += elapsedMs;
+    }
+    if (Connectivity::isRadioPoweredOn()) {
+        pendingMs[MODEM] += elapsedMs;
+    }
+    if (SensorManager::instance().isSensorReady()) {
+        pendingMs[SENSOR] += elapsedMs;
+    }
+    for (size_t ii = 0; ii < PowerDomains::NUM_DOMAINS; ii++) {
+        if (PowerDomains::isOn((PowerDomains::Domain)ii)) {
+            pendingMs[DOMAIN_BUCKETS + ii] += elapsedMs;
+        }
+    }
+}
+
+void setup(bool wokeFromPowerDown) {
+    lastTickMs = lastFoldMs = millis();
+
+    time_t hibernateStart = current.get_energyHibernateStart();
+    if (hibernateStart == 0) {
+        return;
+    }
+    // Only a wake from HIBERNATE or an AB1805 power-down accounts for the
+    // time; after any other reset the device may have been off rather than
+    // asleep. Both are booked at HIBERNATE current.
+    bool slept = wokeFromPowerDown || System.resetReason() == RESET_REASON_POWER_MANAGEMENT;
+    if (slept && Time.isValid() && Time.now() > hibernateStart) {
+        uint32_t sec = (uint32_t)(Time.now() - hibernateStart);
+        current.set_energySec(SLEEP_HIBERNATE, current.get_energySec(SLEEP_HIBERNATE) + sec);
+        Log.info("Energy: credited %lu s of HIBERNATE", (unsigned long)sec);
+    }
+    current.set_energyHibernateStart(0);
+}
+
+bool loop() {
+#if ENERGY_LEDGER_ENABLED
+    tick();
+    if (millis() - lastFoldMs >= (uint32_t)ENERGY_CHECKPOINT_SEC * 1000UL) {
+        fold();
+    }
+#endif
+    return true;
+}
+
+void beginSleep(bool hibernate) {
+#if ENERGY_LEDGER_ENABLED
+    tick();
+    fold();
+    sleeping = true;
+    sleepHibernate = hibernate;
+    sleepSensorPowered = SensorManager::instance().isSensorReady();
+    for (size_t ii = 0; ii < PowerDomains::NUM_DOMAINS; ii++) {
+        sleepDomainOn[ii] = PowerDomains::isOn((PowerDomains::Domain)ii);
+    }
+    sleepStartTime = Time.isValid() ? Time.now() : 0;
+    sleepStartMs = millis();
+    if (hibernate && sleepStartTime != 0) {
+        current.set_energyHibernateStart(sleepStartTime);  // Saved by the checkpoint before HIBERNATE
+    }
+#endif
+}
+
+void endSleep() {
+#if ENERGY_LEDGER_ENABLED
+    if (!sleeping) {
+        return;
+    }
+    sleeping = false;
+
+    // millis() may not advance during sleep on every platform; prefer the RTC
+    uint32_t sleptMs = millis() - sleepStartMs;
+    if (sleepStartTime != 0 && Time.isValid() && Time.now() >= sleepStartTime) {
+        sleptMs = (uint32_t)(Time.now() - sleepStartTime) * 1000UL;
+    }
+    pendingMs[sleepHibernate ? SLEEP_HIBERNATE : SLEEP_ULP] += sleptMs;
+    if (sleepSensorPowered) {
+        pendingMs[SENSOR] += sleptMs;
+    }
+    for (size_t ii = 0; ii < PowerDomains::NUM_DOMAINS; ii++) {
+        if (sleepDomainOn[ii]) {
+            pendingMs[DOMAIN_BUCKETS + ii] += sleptMs;
+        }
+    }
+    if (sleepHibernate) {
+        current.set_energyHibernateStart(0);    // Returned instead of resetting
+    }
+    lastTickMs = millis();
+#endif
+}
+
+uint32_t seconds(size_t bucket) {
+    if (bucket >= NUM_BUCKETS) {
+        return 0;
+    }
+    return storedSec(bucket) + pendingMs[bucket] / 1000;
+}
+
+// Bucket currents in microamps; awake time is the sum of the state buckets
+static float mAh(uint32_t sec, uint32_t microamps) {
+    return (float)sec * (float)microamps / 3600.0f / 1000.0f;
+}
+
+static uint32_t awakeSeconds() {
+    uint32_t total = 0;
+    for (size_t ii = 0; ii < STATE_BUCKETS; ii++) {
+        total += seconds(ii);
+    }
+    return total;
+}
+
+static uint32_t trackedSeconds() {
+    return awakeSeconds() + seconds(SLEEP_ULP) + seconds(SLEEP_HIBERNATE);
+}
+
+float mAhToday() {
+    return mAh(awakeSeconds(), ENERGY_UA_AWAKE) +
+           mAh(seconds(MODEM), ENERGY_UA_MODEM) +
+           mAh(seconds(RADIO), ENERGY_UA_RADIO) +
+           mAh(seconds(SENSOR), ENERGY_UA_SENSOR) +
+           mAh(seconds(SENSOR_LED) + seconds(STATUS_LED), ENERGY_UA_LED) +
+           mAh(seconds(RANGE_SUPPLY), ENERGY_UA_RANGE) +
+           mAh(seconds(SLEEP_ULP), ENERGY_UA_ULP) +
+           mAh(seconds(SLEEP_HIBERNATE), ENERGY_UA_HIBERNATE);
+}
+
+float mAhPerDay() {
+    uint32_t tracked = trackedSeconds();
+    if (tracked == 0) {
+        return 0.0f;
+    }
+    return mAhToday() * 86400.0f / (float)tracked;
+}
+
+size_t formatReport(char *buffer, size_t bufferSize) {
+    tick();
+    fold();     // So resetting current's daily fields afterwards drops exactly what was reported
+
+    JSONBufferWriter writer(buffer, bufferSize - 1);
+    writer.beginObject();
+    writer.name("mAhDay").value(mAhPerDay(), 1);
+    writer.name("trackedSec").value((unsigned long)trackedSeconds());
+
+    writer.name("mAh").beginObject();
+    writer.name("awake").value(mAh(awakeSeconds(), ENERGY_UA_AWAKE), 2);
+    writer.name("modem").value(mAh(seconds(MODEM), ENERGY_UA_MODEM), 2);
+    writer.name("radio").value(mAh(seconds(RADIO), ENERGY_UA_RADIO), 2);
+    writer.name("sensor").value(mAh(seconds(SENSOR), ENERGY_UA_SENSOR), 2);
+    writer.name("led").value(mAh(seconds(SENSOR_LED) + seconds(STATUS_LED), ENERGY_UA_LED), 2);
+    writer.name("range").value(mAh(seconds(RANGE_SUPPLY), ENERGY_UA_RANGE), 2);
+    writer.name("ulp").value(mAh(seconds(SLEEP_ULP), ENERGY_UA_ULP), 2);
+    writer.name("hib").value(mAh(seconds(SLEEP_HIBERNATE), ENERGY_UA_HIBERNATE), 2);
+    writer.endObject();
+
+    writer.name("sec").beginObject();
+    for (size_t ii = 0; ii < STATE_BUCKETS; ii++) {
+        writer.name(stateName(ii)).value((unsigned long)seconds(ii));
+    }
+    writer.name("radio").value((unsigned long)seconds(RADIO));
+    writer.name("modem").value((unsigned long)seconds(MODEM));
+    writer.name("sensor").value((unsigned long)seconds(SENSOR));
+    writer.name("ulp").value((unsigned long)seconds(SLEEP_ULP));
+    writer.name("hib").value((unsigned long)seconds(SLEEP_HIBERNATE));
+    writer.endObject();
+
+    writer.name("domains").beginObject();
+    writer.name("sensor").value((unsigned long)seconds(SENSOR_SUPPLY));
+    writer.name("sensorLed").value((unsigned long)seconds(SENSOR_LED));
+    writer.name("statusLed").value((unsigned long)seconds(STATUS_LED));
+    writer.name("range").value((unsigned long)seconds(RANGE_SUPPLY));
+    writer.endObject();
+
+    PowerPolicy::writeDay(writer);      // Tags the day with its policy variant
+    DataUsage::writeDay(writer);
+    writer.endObject();
+
+    if (writer.dataSize() >= bufferSize - 1) {
+        buffer[0] = 0;
+        return 0;
+    }
+    buffer[writer.dataSize()] = 0;
+    return writer.dataSize();
+}
+
+} // namespace EnergyLedger
@@ -0,0 +1,101 @@
+/**
+ * @file EnergyLedger.h
+ * @brief Where the battery goes: time in each state and power domain, and
+ *        the daily energy use estimated from it.
+ *
+ * @details A TaskScheduler task adds the time since its last run to the
+ *          bucket of the current State, and to the radio, modem and sensor
+ *          buckets and those of the PowerDomains when those are on. Sleep is timed around System.sleep()
+ *          by beginSleep()/endSleep(); a HIBERNATE, which ends in a reset,
+ *          is credited by setup() on the next boot. Totals are kept in RAM
+ *          and folded into current.dat every ENERGY_CHECKPOINT_SEC and
+ *          before sleeping, and reset with the other daily counts.
+ *
+ *          The estimate is each bucket's seconds times its ENERGY_UA_*
+ *          current from Config.h, scaled to 24 hours of tracked time.
+ */
+
+#ifndef __ENERGYLEDGER_H
+#define __ENERGYLEDGER_H
+
+#include "Particle.h"
+
+namespace EnergyLedger {
+
+/**
+ * @brief Buckets; 0..6 are the State values. 0..11 must match current
+ *        energySec[], the PowerDomains ones energyDomainSec[].
+ */
+enum Bucket : uint8_t {
+    STATE_BUCKETS = 7,          ///< One per State, awake time only
+    RADIO = 7,                  ///< Network connected
+    MODEM = 8,                  ///< Radio powered
+    SENSOR = 9,                 ///< Sensor ready (awake or napping)
+    SLEEP_ULP = 10,             ///< ULTRA_LOW_POWER sleep
+    SLEEP_HIBERNATE = 11,       ///< HIBERNATE sleep
+    DOMAIN_BUCKETS = 12,        ///< First of the PowerDomains buckets, one per Domain
+    SENSOR_SUPPLY = 12,         ///< PowerDomains::SENSOR on
+    SENSOR_LED = 13,            ///< PowerDomains::SENSOR_LED on
+    STATUS_LED = 14,            ///< PowerDomains::STATUS_LED on
+    RANGE_SUPPLY = 15,          ///< PowerDomains::RANGE on
+    NUM_BUCKETS = 16
+};
+
+/**
+ * @brief Credit a HIBERNATE or AB1805 power-down that ended in this boot; call from setup() once time is valid
+ *
+ * @param wokeFromPowerDown true if the AB1805 reports a DEEP_POWER_DOWN wake
+ */
+void setup(bool wokeFromPowerDown);
+
+/**
+ * @brief TaskScheduler task: add the time since the last run to the active buckets
+ */
+bool loop();
+
+/**
+ * @brief Call just before System.sleep()
+ *
+ * @param hibernate true for HIBERNATE, which is credited on the next boot
+ */
+void beginSleep(bool hibernate);
+
+/**
+ * @brief Call when System.sleep() returns
+ */
+void endSleep();
+
+/**
+ * @brief Seconds today in @p bucket, including time not yet folded into current.dat
+ */
+uint32_t seconds(size_t bucket);
+
+/**
+ * @brief Estimated mAh used so far today, unscaled (time not yet ticked excluded)
+ */
+float mAhToday();
+
+/**
+ * @brief Estimated mAh per day from today's buckets (0 before any time is tracked)
+ */
+float mAhPerDay();
+
+/**
+ * @brief Format today's breakdown for the daily "energy" event
+ *
+ * Folds the RAM totals into current.dat first, so the caller can reset the
+ * daily fields right after.
+ *
+ * {"mAhDay":n,"trackedSec":n,"mAh":{"awake","modem","radio","sensor","led","ulp","hib"},
+ *  "sec":{"<state>":n,...,"radio","modem","sensor","ulp","hib"},
+ *  "domains":{"sensor","sensorLed","statusLed"},
+ *  "policy":{...}, the day's policy variant and tallies (PowerPolicy::writeDay()),
+ *  "bytes":{...}}, the day's cloud data by category (DataUsage::writeDay())
+ *
+ * @return Length written, or 0 if it did not fit
+ */
+size_t formatReport(char *buffer, size_t bufferSize);
+
+} // namespace EnergyLedger
+
+#endif /* __ENERGYLEDGER_H */
@@ -0,0 +1,485 @@
+#include "Config.h"
+
+#if EVENT_ARCHIVE_ENABLED
+// Before StorageHelperRK.h, which only declares FileSystemSdFat when SdFat is present
+#include "SdFat.h"
+#endif
+
+#include "EventArchive.h"
+#include "StorageHelperRK.h"
+#include "MyPersistentData.h"
+#include "ConfigSnapshot.h"
+#include "PowerGovernor.h"
+#include "StackMonitor.h"
+#include "StateMachine.h"
+#include "device_pinout.h"
+#include <mutex>
+
+namespace EventArchive {
+
+#if EVENT_ARCHIVE_ENABLED
+
+static const uint32_t WRITER_PERIOD_MS = 100;     // Writer poll when there is nothing to write
+static const uint32_t MOUNT_RETRY_MS = 60000;     // Between mount attempts without a card
+static const char *const INDEX_NAME = "INDEX.EVT";
+static const uint32_t UPLOAD_BACKOFF_MS = 60000;  // After a failed upload chunk
+
+/** @brief INDEX.EVT entry, one per day file. */
+struct IndexEntry {
+    uint32_t day;       // YYYYMMDD
+    uint32_t blocks;    // Blocks in the file
+    uint32_t records;   // Records in those blocks
+    uint32_t lastTime;  // Capture time of the newest record
+};
+
+struct Block {
+    BlockHeader hdr;
+    Record records[RECORDS_PER_BLOCK];
+};
+static_assert(sizeof(Block) == BLOCK_SIZE, "EventArchive block must be BLOCK_SIZE");
+
+// Shared with the writer thread, under lock. blocks[sealed % N] is being
+// filled; blocks[written % N] up to it are full and wait for the card.
+static RecursiveMutex lock;
+static Block blocks[EVENT_ARCHIVE_BLOCKS];
+static uint32_t sealed = 0;
+static uint32_t written = 0;
+static uint16_t fillWritten = 0;       // Records of the filling block already on the card
+static bool flushRequested = false;
+static volatile bool cardMissing = true;
+static volatile bool uploadAllowed = false;    // Set by loop() on the application thread
+static Stats counts = {};
+
+// Writer thread only
+static SdFat sd;
+static StorageHelperRK::FileSystemSdFat dataFile(sd);
+static StorageHelperRK::FileSystemSdFat indexFile(sd);
+static Block writeBuf;
+static os_thread_t thread = nullptr;
+static bool dataOpen = false;
+static uint32_t openDay = 0;
+static uint32_t blockOffset = 0;       // Where the next block goes in the day file
+static uint32_t committedRecords = 0;  // Records in the day file's full blocks
+static int indexPos = -1;              // Byte offset of the day's entry in INDEX.EVT
+static IndexEntry entry = {};
+static system_tick_t lastSync = 0;
+static StorageHelperRK::FileSystemSdFat uploadFile(sd);
+static Block uploadBuf;
+static system_tick_t uploadRetryMs = 0;  // Back-off start after a failed chunk (0 = none)
+static bool uploadCaughtUp = false;      // Nothing full left to send; set again by the next block
+
+static uint16_t crc16(const uint8_t *data, size_t len) {
+    uint16_t crc = 0xffff;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static uint32_t dayOf(time_t time) {
+    struct tm tm;
+    gmtime_r(&time, &tm);
+    return (uint32_t)((tm.tm_year + 1900) * 10000 + (tm.tm_mon + 1) * 100 + tm.tm_mday);
+}
+
+static void startBlock(Block &block, uint32_t day) {
+    memset(&block.hdr, 0, sizeof(block.hdr));
+    block.hdr.magic = BLOCK_MAGIC;
+    block.hdr.day = day;
+    block.hdr.resetCount = sysStatus.get_resetCount();
+}
+
+// Find the day's INDEX.EVT entry, or where to append one
+static bool findIndexEntry(uint32_t day) {
+    if (!indexFile.open(INDEX_NAME)) {
+        return false;
+    }
+    int length = indexFile.getLength();
+    indexPos = length - (length % (int)sizeof(IndexEntry));
+    memset(&entry, 0, sizeof(entry));
+    entry.day = day;
+    indexFile.seek(0);
+    IndexEntry e;
+    for (int pos = 0; pos + (int)sizeof(e) <= length; pos += sizeof(e)) {
+        if (indexFile.read((uint8_t *)&e, sizeof(e)) != sizeof(e)) {
+            break;
+        }
+        if (e.day == day) {
+            indexPos = pos;
+            entry = e;
+            break;
+        }
+    }
+    indexFile.close();
+    return true;
+}
+
+// Close the day file so its size reaches the card, then write the index entry
+static void sync() {
+    if (dataOpen) {
+        dataFile.close();
+        dataOpen = false;
+    }
+    if (indexPos >= 0 && indexFile.open(INDEX_NAME)) {
+        indexFile.seek(indexPos);
+        indexFile.write((const uint8_t *)&entry, sizeof(entry));
+        indexFile.close();
+    }
+    lastSync = millis();
+}
+
+static bool openFile(uint32_t day) {
+    if (dataOpen && day == openDay) {
+        return true;
+    }
+    if (openDay != 0 && day != openDay) {
+        sync();
+        Log.info("EventArchive: %08lu.EVT closed, %lu records", (unsigned long)openDay, (unsigned long)entry.records);
+    }
+    char name[16];
+    snprintf(name, sizeof(name), "%08lu.EVT", (unsigned long)day);
+    if (!dataFile.open(name)) {
+        return false;
+    }
+    dataOpen = true;
+    if (day != openDay) {
+        // Carry on after what is there (an earlier boot today), on a block boundary
+        int length = dataFile.getLength();
+        blockOffset = (length + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+        if (!findIndexEntry(day)) {
+            dataFile.close();
+            dataOpen = false;
+            return false;
+        }
+        committedRecords = entry.records;
+        openDay = day;
+    }
+    return true;
+}
+
+static bool writeBlock(const Block &block) {
+    if (!openFile(block.hdr.day)) {
+        return false;
+    }
+    if (!dataFile.seek(blockOffset) ||
+        dataFile.write((const uint8_t *)&block, BLOCK_SIZE) != BLOCK_SIZE) {
+        return false;
+    }
+    entry.blocks = blockOffset / BLOCK_SIZE + 1;
+    entry.records = committedRecords + block.hdr.count;
+    entry.lastTime = block.records[block.hdr.count - 1].time;
+    return true;
+}
+
+// Oldest day in INDEX.EVT after @p after (0 if none)
+static uint32_t nextIndexedDay(uint32_t after) {
+    uint32_t next = 0;
+    if (!indexFile.open(INDEX_NAME)) {
+        return 0;
+    }
+    int length = indexFile.getLength();
+    indexFile.seek(0);
+    IndexEntry e;
+    for (int pos = 0; pos + (int)sizeof(e) <= length; pos += sizeof(e)) {
+        if (indexFile.read((uint8_t *)&e, sizeof(e)) != sizeof(e)) {
+            break;
+        }
+        if (e.day > after && (next == 0 || e.day < next)) {
+            next = e.day;
+        }
+    }
+    indexFile.close();
+    return next;
+}
+
+// Read the status line; any 2xx acknowledges the chunk
+static bool readStatus(TCPClient &client) {
+    char line[32];
+    size_t len = 0;
+    system_tick_t start = millis();
+    while (millis() - start < EVENT_ARCHIVE_UPLOAD_TIMEOUT_MS && client.connected()) {
+        int c = client.read();
+        if (c < 0) {
+            delay(10);
+            continue;
+        }
+        if (c == '\n' || len == sizeof(line) - 1) {
+            break;
+        }
+        line[len++] = (char)c;
+    }
+    line[len] = 0;
+    const char *code = strchr(line, ' ');
+    return strncmp(line, "HTTP/1.", 7) == 0 && code && code[1] == '2';
+}
+
+// POST bytes [offset, offset + length) of the day file to the collector
+static bool postChunk(uint32_t day, uint32_t offset, uint32_t length) {
+    TCPClient client;
+    if (!client.connect(EVENT_ARCHIVE_UPLOAD_HOST, EVENT_ARCHIVE_UPLOAD_PORT)) {
+        return false;
+    }
+    char header[256];
+    int headerLen = snprintf(header, sizeof(header),
+        "POST %s?device=%s&day=%08lu&offset=%lu HTTP/1.1\r\n"
+        "Host: %s\r\n"
+        "Content-Type: application/octet-stream\r\n"
+        "Content-Length: %lu\r\n"
+        "Connection: close\r\n\r\n",
+        EVENT_ARCHIVE_UPLOAD_PATH, System.deviceID().c_str(), (unsigned long)day, (unsigned long)offset,
+        EVENT_ARCHIVE_UPLOAD_HOST, (unsigned long)length);
+    bool ok = client.write((const uint8_t *)header, headerLen) == (size_t)headerLen && uploadFile.seek(offset);
+    for (uint32_t sent = 0; ok && sent < length; sent += BLOCK_SIZE) {
+        ok = uploadFile.read((uint8_t *)&uploadBuf, BLOCK_SIZE) == BLOCK_SIZE &&
+             client.write((const uint8_t *)&uploadBuf, BLOCK_SIZE) == BLOCK_SIZE;
+    }
+    ok = ok && readStatus(client);
+    client.stop();
+    return ok;
+}
+
+enum UploadResult { UPLOAD_SENT, UPLOAD_CAUGHT_UP, UPLOAD_FAILED };
+
+// Send the next chunk of the archive, or move on to the next day file
+static UploadResult uploadChunk() {
+    uint32_t day = sysStatus.get_archiveUploadDay();
+    uint32_t offset = sysStatus.get_archiveUploadOffset();
+    if (day == 0) {
+        day = nextIndexedDay(0);
+        offset = 0;
+        if (day == 0) {
+            return UPLOAD_CAUGHT_UP;
+        }
+    }
+
+    // Whole blocks only; today's block still being filled waits until it is full
+    char name[16];
+    snprintf(name, sizeof(name), "%08lu.EVT", (unsigned long)day);
+    uint32_t limit = 0;
+    bool open = uploadFile.open(name, O_RDONLY);
+    if (open) {
+        limit = (day == openDay) ? blockOffset : (uint32_t)uploadFile.getLength() / BLOCK_SIZE * BLOCK_SIZE;
+    }
+    if (offset >= limit) {
+        if (open) {
+            uploadFile.close();
+        }
+        uint32_t next = (day == openDay) ? 0 : nextIndexedDay(day);
+        if (next == 0) {
+            return UPLOAD_CAUGHT_UP;
+        }
+        Log.info("EventArchive: %08lu.EVT uploaded", (unsigned long)day);
+        sysStatus.set_archiveUploadDay(next);
+        sysStatus.set_archiveUploadOffset(0);
+        return UPLOAD_SENT;
+    }
+
+    uint32_t length = limit - offset;
+    if (length > EVENT_ARCHIVE_UPLOAD_CHUNK) {
+        length = EVENT_ARCHIVE_UPLOAD_CHUNK / BLOCK_SIZE * BLOCK_SIZE;
+    }
+    bool ok = postChunk(day, offset, length);
+    uploadFile.close();
+
+    std::lock_guard<RecursiveMutex> guard(lock);
+    if (!ok) {
+        counts.uploadErrors++;
+        return UPLOAD_FAILED;
+    }
+    counts.uploadBytes += length;
+    sysStatus.set_archiveUploadDay(day);
+    sysStatus.set_archiveUploadOffset(offset + length);
+    return UPLOAD_SENT;
+}
+
+static void writerMain(void *) {
+    StackMonitor::paint(StackMonitor::ARCHIVE, EVENT_ARCHIVE_STACK);
+    while (true) {
+        if (cardMissing) {
+            if (!sd.begin(archiveCsPin, SD_SCK_MHZ(EVENT_ARCHIVE_SPI_MHZ))) {
+                delay(MOUNT_RETRY_MS);
+                continue;
+            }
+            Log.info("EventArchive: card mounted");
+            cardMissing = false;
+            dataOpen = false;
+            openDay = 0;
+        }
+
+        // Take a copy of the next block to write; the card is never written under the lock
+        bool full = false;
+        bool have = false;
+        uint32_t copiedSeq = 0;
+        {
+            std::lock_guard<RecursiveMutex> guard(lock);
+            if (written != sealed) {
+                writeBuf = blocks[written % EVENT_ARCHIVE_BLOCKS];
+                full = have = true;
+            } else {
+                Block &fill = blocks[sealed % EVENT_ARCHIVE_BLOCKS];
+                if (fill.hdr.count > fillWritten &&
+                    (flushRequested || millis() - lastSync >= EVENT_ARCHIVE_FLUSH_SEC * 1000UL)) {
+                    writeBuf = fill;
+                    have = true;
+                }
+            }
+            flushRequested = false;
+            copiedSeq = sealed;
+        }
+        if (!have) {
+#if EVENT_ARCHIVE_UPLOAD_ENABLED
+            // Between blocks, send the archive while loop() allows it
+            if (uploadAllowed && !uploadCaughtUp &&
+                (uploadRetryMs == 0 || millis() - uploadRetryMs >= UPLOAD_BACKOFF_MS)) {
+                UploadResult result = uploadChunk();
+                uploadRetryMs = (result == UPLOAD_FAILED) ? millis() : 0;
+                uploadCaughtUp = (result == UPLOAD_CAUGHT_UP);
+                continue;
+            }
+#endif
+            delay(WRITER_PERIOD_MS);
+            continue;
+        }
+
+        writeBuf.hdr.crc = crc16((const uint8_t *)writeBuf.records, writeBuf.hdr.count * sizeof(Record));
+        if (!writeBlock(writeBuf)) {
+            Log.error("EventArchive: write to %08lu.EVT failed, remounting", (unsigned long)writeBuf.hdr.day);
+            if (dataOpen) {
+                dataFile.close();
+                dataOpen = false;
+            }
+            std::lock_guard<RecursiveMutex> guard(lock);
+            counts.writeErrors++;
+            cardMissing = true;
+            continue;
+        }
+
+        if (full) {
+            blockOffset += BLOCK_SIZE;
+            committedRecords = entry.records;
+            uploadCaughtUp = false;
+        }
+        // Partial blocks are flushes: let them and a busy card's full blocks reach the directory
+        if (!full || millis() - lastSync >= EVENT_ARCHIVE_FLUSH_SEC * 1000UL) {
+            sync();
+        }
+
+        std::lock_guard<RecursiveMutex> guard(lock);
+        if (full) {
+            written++;
+            fillWritten = 0;
+            counts.blocks++;
+        } else if (copiedSeq == sealed) {
+            fillWritten = writeBuf.hdr.count;
+        }
+    }
+}
+
+#endif
+
+void setup() {
+#if EVENT_ARCHIVE_ENABLED
+    startBlock(blocks[0], 0);
+    lastSync = millis();
+    os_thread_create(&thread, "archive", OS_THREAD_PRIORITY_DEFAULT, writerMain, nullptr, EVENT_ARCHIVE_STACK);
+    Log.info("EventArchive: writer started (%u blocks of %u records)", (unsigned)EVENT_ARCHIVE_BLOCKS,
+             (unsigned)RECORDS_PER_BLOCK);
+#endif
+}
+
+bool loop() {
+#if EVENT_ARCHIVE_ENABLED && EVENT_ARCHIVE_UPLOAD_ENABLED && Wiring_WiFi
+    bool allowed = !cardMissing && Particle.connected() && state != SLEEPING_STATE &&
+                   WiFi.RSSI().getStrengthValue() >= EVENT_ARCHIVE_UPLOAD_MIN_RSSI;
+    if (allowed && PowerGovernor::operatingMode() != CONNECTED) {
+        // What a publish queue drain may use: the connect budget, above the battery floor
+        unsigned long budgetMs = (unsigned long)ConfigSnapshot::read().connectAttemptBudgetSec * 1000UL;
+        uint16_t socTenths = current.get_socTenths();
+        uint8_t battState = current.get_batteryState();
+        bool charging = battState == BATTERY_STATE_CHARGING || battState == BATTERY_STATE_CHARGED;
+        allowed = connectedStartMs != 0 && millis() - connectedStartMs < budgetMs &&
+                  (socTenths == 0 || charging || socTenths >= QUEUE_DRAIN_PARTIAL_SOC * 10);
+    }
+    if (allowed != uploadAllowed) {
+        Log.info("EventArchive: upload %s", allowed ? "allowed" : "paused");
+        uploadAllowed = allowed;
+    }
+#endif
+    return true;
+}
+
+void append(const SensorEvent *events, size_t count) {
+#if EVENT_ARCHIVE_ENABLED
+    if (!thread) {
+        return;
+    }
+    std::lock_guard<RecursiveMutex> guard(lock);
+    if (!Time.isValid()) {
+        counts.noTime += count;
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        const SensorEvent &ev = events[i];
+        time_t time = ev.unixTime();
+        uint32_t day = dayOf(time);
+
+        // Close the filling block when it is full or the day changes
+        Block *block = &blocks[sealed % EVENT_ARCHIVE_BLOCKS];
+        if (block->hdr.count == RECORDS_PER_BLOCK || (block->hdr.count && block->hdr.day != day)) {
+            if (sealed + 1 - written >= EVENT_ARCHIVE_BLOCKS) {
+                counts.dropped++;
+                continue;
+            }
+            sealed++;
+            block = &blocks[sealed % EVENT_ARCHIVE_BLOCKS];
+            block->hdr.count = 0;
+        }
+        if (block->hdr.count == 0) {
+            startBlock(*block, day);
+        }
+
+        Record &rec = block->records[block->hdr.count++];
+        rec.time = (uint32_t)time;
+        rec.tickMs = ev.tickMs;
+        rec.type = (uint8_t)ev.type;
+        rec.flags = ev.flags;
+        rec.primary = ev.primary;
+        rec.secondary = ev.secondary;
+        rec.pulseMs = ev.pulseMs;
+        counts.records++;
+    }
+#else
+    (void)events;
+    (void)count;
+#endif
+}
+
+void flush() {
+#if EVENT_ARCHIVE_ENABLED
+    std::lock_guard<RecursiveMutex> guard(lock);
+    flushRequested = true;
+#endif
+}
+
+bool idle() {
+#if EVENT_ARCHIVE_ENABLED
+    std::lock_guard<RecursiveMutex> guard(lock);
+    return cardMissing || (written == sealed && blocks[sealed % EVENT_ARCHIVE_BLOCKS].hdr.count == fillWritten);
+#else
+    return true;
+#endif
+}
+
+Stats stats() {
+#if EVENT_ARCHIVE_ENABLED
+    std::lock_guard<RecursiveMutex> guard(lock);
+    return counts;
+#else
+    return Stats();
+#endif
+}
+
+} // namespace EventArchive
@@ -0,0 +1,128 @@
+/**
+ * @file EventArchive.h
+ * @brief Raw sensor event archive on an SD card, one file per UTC day.
+ *
+ * @details Every event the mode handlers apply is kept as a 16-byte record
+ *          (capture time, millis() tick, sensor type, flags and values),
+ *          for deployments that need each event rather than hourly counts.
+ *
+ *          append() only copies records into RAM blocks of 512 bytes, a
+ *          16-byte header and 31 records. A writer thread owns the card: a
+ *          full block is written once at its block-aligned offset, and the
+ *          block being filled is rewritten at that same offset every
+ *          EVENT_ARCHIVE_FLUSH_SEC, so files grow by whole blocks and loop()
+ *          never waits on the card. If the writer falls EVENT_ARCHIVE_BLOCKS
+ *          behind, new records are dropped and counted, never blocked on.
+ *
+ *          Files are YYYYMMDD.EVT (8.3 names for SdFat), and a block is
+ *          closed early when the day changes. INDEX.EVT holds one 16-byte
+ *          entry per day (day, blocks, records, last event time), updated
+ *          with each write; a reader can rebuild it from the block headers.
+ *          Events before Time is valid have no day and are not archived.
+ *
+ *          Needs the SdFat library (project.properties) and a carrier with
+ *          the SPI bus free for the card; see EVENT_ARCHIVE_ENABLED.
+ *
+ *          Bulk upload (EVENT_ARCHIVE_UPLOAD_ENABLED): while a P2 is
+ *          connected on WiFi with good RSSI and the energy budget allows
+ *          it, the writer thread also streams whole blocks of the day files
+ *          to a collector, EVENT_ARCHIVE_UPLOAD_CHUNK bytes per HTTP POST,
+ *          instead of one Particle event per record. The day and byte
+ *          offset the collector acknowledged are kept in sysStatus, so an
+ *          upload cut short by sleep or a lost connection resumes there.
+ *          The block still being filled is only sent once it is full.
+ */
+
+#ifndef __EVENTARCHIVE_H
+#define __EVENTARCHIVE_H
+
+#include "Particle.h"
+#include "ISensor.h"
+
+namespace EventArchive {
+
+/** @brief One archived event; append only, the reader depends on the layout. */
+struct Record {
+    uint32_t time;          ///< Capture time (UTC seconds)
+    uint32_t tickMs;        ///< Capture millis(), for sub-second spacing within a boot
+    uint8_t  type;          ///< SensorType
+    uint8_t  flags;         ///< SensorEvent::flags
+    uint16_t primary;       ///< SensorEvent::primary
+    uint16_t secondary;     ///< SensorEvent::secondary
+    uint16_t pulseMs;       ///< SensorEvent::pulseMs
+};
+
+/** @brief Header at the start of each 512-byte block. */
+struct BlockHeader {
+    uint32_t magic;         ///< BLOCK_MAGIC
+    uint32_t day;           ///< UTC day of every record in the block, YYYYMMDD
+    uint16_t count;         ///< Records in use (a block rewritten while filling has fewer)
+    uint16_t crc;           ///< CRC-16/CCITT of the records in use
+    uint8_t  resetCount;    ///< sysStatus resetCount when the block was started
+    uint8_t  reserved[3];
+};
+
+static constexpr uint32_t BLOCK_MAGIC = 0x31415645;     // "EVA1"
+static constexpr size_t BLOCK_SIZE = 512;
+static constexpr size_t RECORDS_PER_BLOCK = (BLOCK_SIZE - sizeof(BlockHeader)) / sizeof(Record);
+
+static_assert(sizeof(Record) == 16, "EventArchive::Record must stay 16 bytes");
+static_assert(sizeof(BlockHeader) == 16, "EventArchive::BlockHeader must stay 16 bytes");
+
+/** @brief Counts since boot. */
+struct Stats {
+    uint32_t records;       ///< Records handed to the writer
+    uint32_t blocks;        ///< Full blocks written
+    uint32_t dropped;       ///< Records lost because the writer was EVENT_ARCHIVE_BLOCKS behind
+    uint32_t noTime;        ///< Events not archived because Time was not valid
+    uint32_t writeErrors;   ///< Failed card writes (the block is retried)
+    uint32_t uploadBytes;   ///< Bytes the collector acknowledged
+    uint32_t uploadErrors;  ///< Upload chunks that failed (resent after a back-off)
+};
+
+/**
+ * @brief Mount the card and start the writer thread
+ *
+ * @details Call after the publish queue in setup(). Without a card the
+ *          writer retries the mount every minute, and records queue up to
+ *          EVENT_ARCHIVE_BLOCKS blocks meanwhile.
+ */
+void setup();
+
+/**
+ * @brief Decide whether the writer may upload now (TaskScheduler task)
+ *
+ * @details Allowed while connected over WiFi at EVENT_ARCHIVE_UPLOAD_MIN_RSSI
+ *          or better, out of SLEEPING_STATE, and within the same connect
+ *          budget and battery floor as a publish queue drain.
+ *
+ * @return true (TaskScheduler task)
+ */
+bool loop();
+
+/**
+ * @brief Queue @p count events from the sensor batch; application thread only
+ */
+void append(const SensorEvent *events, size_t count);
+
+/**
+ * @brief Ask the writer to write the block being filled now
+ */
+void flush();
+
+/**
+ * @brief true when every queued record is on the card, or there is no card
+ *
+ * @details The sleep handler waits for this so a HIBERNATE does not lose
+ *          the records still in RAM.
+ */
+bool idle();
+
+/**
+ * @brief Counts since boot
+ */
+Stats stats();
+
+} // namespace EventArchive
+
+#endif /* __EVENTARCHIVE_H */
@@ -0,0 +1,121 @@
+// src/EventFilter.cpp
+#include "EventFilter.h"
+#include "Config.h"
+#include "ConfigSnapshot.h"
+
+EventFilter::EventFilter() : _params{0, 500, 0, 0}, _configSeq(0), _rejected(0), _accepted(0),
+                             _retriggers(0), _chatter(0) {
+    reset();
+}
+
+void EventFilter::loadConfig() {
+    _configSeq = ConfigSnapshot::sequence();    // Before read(): a later publish loads again
+    ConfigSnapshot::Values config = ConfigSnapshot::read();
+    Params p;
+    p.debounceMs = config.debounceMs;
+    p.refractoryMs = config.refractoryMs;
+    p.minPulseMs = config.minPulseMs;
+    p.maxEventsPerSec = config.maxEventsPerSec;
+    if (p.debounceMs != _params.debounceMs || p.refractoryMs != _params.refractoryMs ||
+        p.minPulseMs != _params.minPulseMs || p.maxEventsPerSec != _params.maxEventsPerSec) {
+        setParams(p);
+    }
+}
+
+void EventFilter::setParams(const Params& params) {
+    _params = params;
+    Log.info("Event filter: debounce=%u ms, refractory=%u ms, minPulse=%u ms, maxRate=%u/s",
+             _params.debounceMs, _params.refractoryMs, _params.minPulseMs,
+             _params.maxEventsPerSec);
+}
+
+void EventFilter::reset() {
+    _haveRawEdge = false;
+    _lastRawMs = 0;
+    _haveAccepted = false;
+    _lastAcceptedMs = 0;
+    _windowStartMs = 0;
+    _windowCount = 0;
+}
+
+uint32_t EventFilter::capEdgeCount(uint32_t edges, uint32_t spanMs) {
+    if (ConfigSnapshot::sequence() != _configSeq) {
+        loadConfig();
+    }
+    uint32_t limit = edges;
+    uint32_t spacingMs = (_params.refractoryMs > _params.debounceMs) ? _params.refractoryMs : _params.debounceMs;
+    if (spacingMs && spanMs / spacingMs + 1 < limit) {
+        limit = spanMs / spacingMs + 1;
+    }
+    if (_params.maxEventsPerSec && (spanMs / 1000 + 1) * _params.maxEventsPerSec < limit) {
+        limit = (spanMs / 1000 + 1) * _params.maxEventsPerSec;
+    }
+    _rejected += edges - limit;
+    return limit;
+}
+
+size_t EventFilter::apply(SensorEvent* events, size_t count) {
+    if (ConfigSnapshot::sequence() != _configSeq) {
+        loadConfig();
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (accept(events[i])) {
+            if (kept != i) {
+                events[kept] = events[i];
+            }
+            kept++;
+        } else {
+            _rejected++;
+        }
+    }
+    return kept;
+}
+
+bool EventFilter::accept(const SensorEvent& ev) {
+    const uint32_t t = ev.tickMs;
+
+    if (_params.minPulseMs && ev.pulseMs && ev.pulseMs < _params.minPulseMs) {
+        return false;
+    }
+
+    // Debounce is measured from the previous raw edge, so a chattering
+    // input stays suppressed until it has been quiet for debounceMs.
+    const bool hadRawEdge = _haveRawEdge;
+    const uint32_t rawGap = t - _lastRawMs;
+    bool bounced = _params.debounceMs && hadRawEdge && rawGap < _params.debounceMs;
+    _haveRawEdge = true;
+    _lastRawMs = t;
+    if (bounced) {
+        return false;
+    }
+
+    if (_params.refractoryMs && _haveAccepted &&
+        (uint32_t)(t - _lastAcceptedMs) < _params.refractoryMs) {
+        return false;
+    }
+
+    if (_params.maxEventsPerSec) {
+        if (_windowCount == 0 || (uint32_t)(t - _windowStartMs) >= 1000UL) {
+            _windowStartMs = t;
+            _windowCount = 0;
+        }
+        if (_windowCount >= _params.maxEventsPerSec) {
+            return false;
+        }
+        _windowCount++;
+    }
+
+    // Accepted events just past the current dead times, for AutoTune
+    if (hadRawEdge && rawGap < (uint32_t)_params.debounceMs + AUTO_TUNE_CHATTER_MS) {
+        _chatter++;
+    }
+    if (_haveAccepted && (uint32_t)(t - _lastAcceptedMs) < (uint32_t)_params.refractoryMs + AUTO_TUNE_RETRIGGER_MS) {
+        _retriggers++;
+    }
+    _accepted++;
+
+    _haveAccepted = true;
+    _lastAcceptedMs = t;
+    return true;
+}
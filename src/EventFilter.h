@@ -0,0 +1,124 @@
+// src/EventFilter.h
+#ifndef EVENTFILTER_H
+#define EVENTFILTER_H
+
+#include "Particle.h"
+#include "ISensor.h"
+
+/**
+ * @brief Event filter stage between ISensor::drain() and the mode handlers.
+ *
+ * Drivers report raw events; SensorManager runs each batch through this
+ * filter before the counting/occupancy handlers see it. Each stage is
+ * disabled when its parameter is 0:
+ *
+ * - minPulseMs:      drop events whose measured pulse width is shorter
+ *                    (events with pulseMs == 0 are not width-checked)
+ * - debounceMs:      drop an edge closer than this to the previous raw
+ *                    edge, accepted or not (contact-bounce style)
+ * - refractoryMs:    dead time after each accepted event
+ * - maxEventsPerSec: cap on accepted events in any 1 s window
+ *
+ * Parameters come from ConfigSnapshot via loadConfig(), which apply()
+ * calls whenever the snapshot has changed since the last load, so a
+ * config change takes effect on the next batch with the timing history
+ * kept. All timing uses SensorEvent::tickMs so late-drained bursts are
+ * judged on their real arrival times.
+ */
+class EventFilter {
+public:
+    /** @brief Filter parameters (0 disables a stage). */
+    struct Params {
+        uint16_t debounceMs;
+        uint16_t refractoryMs;
+        uint16_t minPulseMs;
+        uint8_t  maxEventsPerSec;
+    };
+
+    EventFilter();
+
+    /**
+     * @brief Reload parameters from ConfigSnapshot.
+     */
+    void loadConfig();
+
+    /**
+     * @brief Replace the active parameters.
+     */
+    void setParams(const Params& params);
+
+    const Params& params() const { return _params; }
+
+    /**
+     * @brief Filter a batch in place.
+     *
+     * Accepted events are compacted to the front of @p events, keeping
+     * their order.
+     *
+     * @return Number of accepted events
+     */
+    size_t apply(SensorEvent* events, size_t count);
+
+    /**
+     * @brief Cap an edge count that has no timestamps (counted in hardware
+     *        during sleep) at what the filter could have accepted.
+     *
+     * Accepted events are at least max(debounceMs, refractoryMs) apart and
+     * at most maxEventsPerSec in a second, so a burst that live filtering
+     * would collapse to one count is not counted edge by edge. The excess
+     * counts as rejected.
+     *
+     * @param edges Edges counted
+     * @param spanMs Time they were counted over
+     * @return Edges to count
+     */
+    uint32_t capEdgeCount(uint32_t edges, uint32_t spanMs);
+
+    /**
+     * @brief Forget timing history (e.g. after sleep or a sensor change).
+     */
+    void reset();
+
+    /** @brief Events rejected since boot, for diagnostics. */
+    uint32_t rejectedCount() const { return _rejected; }
+
+    /** @brief Events accepted since boot. */
+    uint32_t acceptedCount() const { return _accepted; }
+
+    /**
+     * @brief Accepted events less than AUTO_TUNE_RETRIGGER_MS past the
+     *        refractory time after the previous accepted event, since boot.
+     *
+     * A PIR watching swaying vegetation retriggers as soon as the dead
+     * time allows; a passer-by seldom does.
+     */
+    uint32_t retriggerCount() const { return _retriggers; }
+
+    /**
+     * @brief Accepted events less than AUTO_TUNE_CHATTER_MS past the
+     *        debounce time after the previous raw edge, since boot.
+     */
+    uint32_t chatterCount() const { return _chatter; }
+
+private:
+    bool accept(const SensorEvent& ev);
+
+    Params _params;
+    uint32_t _configSeq;        // ConfigSnapshot::sequence() at the last loadConfig()
+
+    bool _haveRawEdge;
+    uint32_t _lastRawMs;
+
+    bool _haveAccepted;
+    uint32_t _lastAcceptedMs;
+
+    uint32_t _windowStartMs;
+    uint8_t _windowCount;
+
+    uint32_t _rejected;
+    uint32_t _accepted;
+    uint32_t _retriggers;
+    uint32_t _chatter;
+};
+
+#endif /* EVENTFILTER_H */
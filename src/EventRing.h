@@ -0,0 +1,94 @@
+// src/EventRing.h
+#ifndef EVENTRING_H
+#define EVENTRING_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Fixed-capacity single-producer/single-consumer ring buffer.
+ *
+ * Intended for handing timestamps from an ISR (producer) to the main
+ * loop (consumer) without locks or heap. The producer only writes
+ * @c _head and the consumer only writes @c _tail, so no critical
+ * section is needed on either side.
+ *
+ * When the ring is full, push() drops the new entry and increments the
+ * overflow counter so the loss is visible rather than silent.
+ *
+ * @tparam T         POD element type (e.g. uint32_t timestamp)
+ * @tparam Capacity  Number of slots; must be a power of two
+ */
+template <typename T, size_t Capacity>
+class EventRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "EventRing capacity must be a power of two");
+
+public:
+    EventRing() : _head(0), _tail(0), _overflows(0) {}
+
+    /**
+     * @brief Producer side: append one entry (ISR-safe).
+     * @return false if the ring was full and the entry was dropped
+     */
+    bool push(const T& value) {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        uint32_t tail = _tail.load(std::memory_order_acquire);
+        if (head - tail >= Capacity) {
+            _overflows.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        _buffer[head & (Capacity - 1)] = value;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Consumer side: remove the oldest entry.
+     * @return false if the ring was empty
+     */
+    bool pop(T& out) {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        uint32_t head = _head.load(std::memory_order_acquire);
+        if (head == tail) {
+            return false;
+        }
+        out = _buffer[tail & (Capacity - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Number of entries currently waiting (approximate if the
+     *        producer is concurrently pushing).
+     */
+    size_t size() const {
+        return (size_t)(_head.load(std::memory_order_acquire) -
+                        _tail.load(std::memory_order_acquire));
+    }
+
+    bool empty() const { return size() == 0; }
+
+    /**
+     * @brief Consumer side: discard all pending entries.
+     */
+    void clear() {
+        _tail.store(_head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    /**
+     * @brief Total entries dropped because the ring was full.
+     */
+    uint32_t overflows() const { return _overflows.load(std::memory_order_relaxed); }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    T _buffer[Capacity];
+    std::atomic<uint32_t> _head;       // Written by producer only
+    std::atomic<uint32_t> _tail;       // Written by consumer only
+    std::atomic<uint32_t> _overflows;  // Written by producer only
+};
+
+#endif /* EVENTRING_H */
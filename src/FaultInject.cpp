@@ -0,0 +1,184 @@
+#include "FaultInject.h"
+#include "Config.h"
+
+#if FAULT_INJECT_ENABLED
+
+#include "EnergyLedger.h"
+#include "MonoClock.h"
+#include "MyPersistentData.h"
+#include "Payload.h"
+#include "PublishQueuePosixRK.h"
+#include "StorageHelperRK.h"
+
+extern bool publishDiagnosticSafe(const char* eventName, const char* data, PublishFlags flags);
+
+namespace FaultInject {
+
+struct Episode {
+    uint32_t magic;
+    uint8_t faults;             // Fault bits injected so far
+    uint8_t alert;              // First of 15, 31, 44 raised meanwhile
+    uint16_t recoveries[3];     // sysStatus recoveryAttempts at the start
+    uint64_t startMs;           // MonoClock
+    float startMah;             // EnergyLedger::mAhToday()
+};
+
+// Checked with magic only, like the state table: an episode open at a
+// reset carries on
+static constexpr uint32_t EPISODE_MAGIC = 0xfa017e91;
+static retained Episode episode;
+
+static uint8_t armed[3] = {};           // CONNECT_TIMEOUT, SESSION_DROP, LEDGER_FAIL shots left
+static bool storageDelay = false;
+static bool ledgerFailed = false;       // The last set() failed, injected or not
+static char line[32];
+static size_t lineLen = 0;
+
+static constexpr int8_t WATCHED_ALERTS[] = {15, 31, 44};
+
+static bool episodeOpen() {
+    return episode.magic == EPISODE_MAGIC;
+}
+
+static void inject(Fault fault) {
+    if (!episodeOpen()) {
+        episode = {};
+        episode.magic = EPISODE_MAGIC;
+        episode.startMs = MonoClock::nowMs();
+        episode.startMah = EnergyLedger::mAhToday();
+        for (size_t ii = 0; ii < 3; ii++) {
+            episode.recoveries[ii] = sysStatus.get_recoveryAttempts(ii);
+        }
+    }
+    episode.faults |= fault;
+    Log.info("Fault: injecting 0x%02x", (unsigned)fault);
+}
+
+// Take one shot of @p fault, opening the episode
+static bool take(Fault fault, size_t index) {
+    if (armed[index] == 0) {
+        return false;
+    }
+    armed[index]--;
+    inject(fault);
+    return true;
+}
+
+static uint8_t armedMask() {
+    return (armed[0] ? CONNECT_TIMEOUT : 0) | (armed[1] ? SESSION_DROP : 0) |
+           (armed[2] ? LEDGER_FAIL : 0) | (storageDelay ? STORAGE_DELAY : 0);
+}
+
+static bool recovered() {
+    if (armedMask() || ledgerFailed || !Particle.connected()) {
+        return false;
+    }
+    for (int8_t alert : WATCHED_ALERTS) {
+        if (current.isAlertActive(alert)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void closeEpisode() {
+    float mAh = EnergyLedger::mAhToday() - episode.startMah;
+    char data[160];
+    Payload::Writer(data, sizeof(data))
+        .beginObject()
+        .add("faults", (unsigned)episode.faults)
+        .add("ms", (unsigned long)(MonoClock::nowMs() - episode.startMs))
+        .addFixed("mAh", mAh > 0.0f ? mAh : 0.0f, 1)
+        .add("alert", (int)episode.alert)
+        .add("warm", (unsigned)(sysStatus.get_recoveryAttempts(0) - episode.recoveries[0]))
+        .add("soft", (unsigned)(sysStatus.get_recoveryAttempts(1) - episode.recoveries[1]))
+        .add("hard", (unsigned)(sysStatus.get_recoveryAttempts(2) - episode.recoveries[2]))
+        .endObject();
+    Log.info("Fault: recovered %s", data);
+    publishDiagnosticSafe("fault", data, PRIVATE);
+    episode.magic = 0;
+}
+
+static int command(const char *arg) {
+    static const char *const NAMES[] = {"connect", "drop", "ledger"};
+    char name[16];
+    unsigned count = 1;
+    if (sscanf(arg, "%15[a-z]:%u", name, &count) < 1 || count == 0 || count > 255) {
+        return -1;
+    }
+    if (strcmp(name, "off") == 0) {
+        memset(armed, 0, sizeof(armed));
+        storageDelay = false;
+    } else if (strcmp(name, "storage") == 0) {
+        storageDelay = true;
+        inject(STORAGE_DELAY);
+    } else {
+        size_t index = 0;
+        while (index < 3 && strcmp(name, NAMES[index]) != 0) {
+            index++;
+        }
+        if (index == 3) {
+            return -1;
+        }
+        armed[index] = (uint8_t)count;
+    }
+    StorageHelperRK::PersistentDataFileSystem::writeDelayMs = storageDelay ? FAULT_STORAGE_DELAY_MS : 0;
+    Log.info("Fault: armed 0x%02x", (unsigned)armedMask());
+    return armedMask();
+}
+
+static int faultFunction(String arg) {
+    return command(arg.c_str());
+}
+
+void setup() {
+    Particle.function("fault", faultFunction);
+}
+
+bool loop() {
+    while (Serial.available() > 0) {
+        char c = (char)Serial.read();
+        if (c == '\r' || c == '\n') {
+            line[lineLen] = '\0';
+            if (lineLen > 0) {
+                command(line);
+            }
+            lineLen = 0;
+        } else if (lineLen < sizeof(line) - 1) {
+            line[lineLen++] = c;
+        }
+    }
+
+    // Mid-drain: connected with events still to deliver
+    if (armed[1] && Particle.connected() && PublishQueuePosix::instance().getNumEvents() > 0) {
+        take(SESSION_DROP, 1);
+        Particle.disconnect();
+    }
+
+    if (!episodeOpen()) {
+        return true;
+    }
+    for (int8_t alert : WATCHED_ALERTS) {
+        if (episode.alert == 0 && current.isAlertActive(alert)) {
+            episode.alert = (uint8_t)alert;
+        }
+    }
+    if (recovered()) {
+        closeEpisode();
+    }
+    return true;
+}
+
+bool connectTimeout() {
+    return take(CONNECT_TIMEOUT, 0);
+}
+
+int setLedger(Ledger &ledger, const LedgerData &data) {
+    int result = take(LEDGER_FAIL, 2) ? (int)SYSTEM_ERROR_IO : ledger.set(data);
+    ledgerFailed = result != SYSTEM_ERROR_NONE;
+    return result;
+}
+
+} // namespace FaultInject
+
+#endif /* FAULT_INJECT_ENABLED */
@@ -0,0 +1,80 @@
+/**
+ * @file FaultInject.h
+ * @brief Bench fault injection for the connectivity and storage recovery
+ *        paths, with the time and estimated energy each recovery took.
+ *
+ * @details Alerts 15, 31 and 44 come from field conditions that cannot be
+ *          had on demand. The "fault" cloud function, or the same command
+ *          typed as a line on USB serial, arms one of:
+ *
+ *          - "connect": the next connect attempt runs out of budget at
+ *            once (alert 31 and the error supervisor).
+ *          - "drop": the cloud session is dropped while the publish queue
+ *            still has events to deliver.
+ *          - "ledger": the next device-data ledger set() fails.
+ *          - "storage": every persistence save waits FAULT_STORAGE_DELAY_MS
+ *            first, as a slow flash would, until "off".
+ *
+ *          "<fault>:<n>" arms n in a row; "off" disarms everything. The
+ *          function returns the armed faults as a bitmask of Fault.
+ *
+ *          The first injection opens an episode. It closes once nothing
+ *          is armed, the device is back on the cloud, alerts 15, 31 and
+ *          44 are clear and the last ledger set() worked. A "fault" event
+ *          then gives its duration (MonoClock, so naps and resets count),
+ *          the EnergyLedger estimate of the charge used, the most severe
+ *          alert seen, and the error supervisor's warm, soft and hard
+ *          recoveries meanwhile:
+ *
+ *              {"faults":1,"ms":412380,"mAh":3.8,"alert":31,
+ *               "warm":1,"soft":1,"hard":0}
+ *
+ *          The episode is kept in retained RAM, so a soft reset does not
+ *          end it. A day rollover inside an episode under-counts mAh.
+ *          Bench builds only: FAULT_INJECT_ENABLED.
+ *
+ *          Application thread only.
+ */
+
+#ifndef __FAULTINJECT_H
+#define __FAULTINJECT_H
+
+#include "Particle.h"
+
+namespace FaultInject {
+
+/** @brief Faults, as bits in the "fault" function's return value. */
+enum Fault : uint8_t {
+    CONNECT_TIMEOUT = 0x01,
+    SESSION_DROP = 0x02,
+    LEDGER_FAIL = 0x04,
+    STORAGE_DELAY = 0x08
+};
+
+/**
+ * @brief Register the "fault" cloud function
+ */
+void setup();
+
+/**
+ * @brief TaskScheduler task: serial commands, the session drop, and closing the episode
+ *
+ * @return true (TaskScheduler task)
+ */
+bool loop();
+
+/**
+ * @brief true if the connect attempt in progress is to time out; from CONNECTING_STATE
+ */
+bool connectTimeout();
+
+/**
+ * @brief Set @p ledger to @p data unless a ledger fault is armed
+ *
+ * @return The set() result, or SYSTEM_ERROR_IO when injected
+ */
+int setLedger(Ledger &ledger, const LedgerData &data);
+
+} // namespace FaultInject
+
+#endif /* __FAULTINJECT_H */
@@ -22,26 +22,71 @@
 // Include Particle Device OS APIs
 #include "Particle.h"
 
-// Global configuration (includes DEBUG_SERIAL define)
+// Global configuration
 #include "Config.h"
 
 // Firmware version recognized by Particle Product firmware management
 // Bump this integer whenever you cut a new production release.
 PRODUCT_VERSION(3);
 #include "AB1805_RK.h"
+#include "AppMessages.h"
+#include "AssetStore.h"
+#include "BackgroundPublishRK.h"
+#include "BleReadout.h"
+#include "BootProfile.h"
+#include "BrownoutGuard.h"
+#include "ClockDrift.h"
 #include "Cloud.h"
+#include "ConfigSnapshot.h"
+#include "CompactReport.h"
+#include "ConnectCache.h"
+#include "ConnectHistory.h"
+#include "DataUsage.h"
+#include "DiagnosticBudget.h"
+#include "EnergyLedger.h"
+#include "EventArchive.h"
+#include "FaultInject.h"
+#include "HeapMonitor.h"
+#include "HourlyHistory.h"
+#include "LiveCount.h"
+#include "LocalOffset.h"
+#include "LoopbackTest.h"
+#include "OccupancyNotify.h"
 #include "LocalTimeRK.h"
+#include "MicroBench.h"
+#include "MonoClock.h"
 #include "MyPersistentData.h"
+#include "OpenHours.h"
+#include "OtaScheduler.h"
+#include "PhaseMarker.h"
+#include "Payload.h"
 #include "Particle_Functions.h"
+#include "PersistProfile.h"
+#include "PowerDomains.h"
+#include "PowerGovernor.h"
 #include "PublishQueuePosixRK.h"
+#include "ReportCompactor.h"
+#include "ReportTracker.h"
+#include "RollupStore.h"
+#include "ScheduledSampler.h"
 #include "SensorManager.h"
+#include "StackMonitor.h"
 #include "device_pinout.h"
 #include "ISensor.h"
 #include "SensorFactory.h"
 #include "SensorDefinitions.h"
+#include "TaskScheduler.h"
+#include "TinyClassifier.h"
+#include "TraceLog.h"
+#include "SoakTest.h"
+#include "TraceReplay.h"
+#include "UpdateWindow.h"
+#include "UsbLogSink.h"
+#include "WakeLedger.h"
 #include "Version.h"
 #include "StateMachine.h"
 #include "StateHandlers.h"
+#include "StateTable.h"
 #include "ProjectConfig.h"
 
 // Forward declarations in case Version.h is not picked up correctly
@@ -54,7 +99,8 @@ extern const char* FIRMWARE_RELEASE_NOTES;
  * ----------------------
  * - State machine: setup()/loop() implement a simple state machine
  *   (INITIALIZATION, CONNECTING, IDLE, SLEEPING, REPORTING, ERROR)
- *   that drives sensing, reporting, and power management.
+ *   that drives sensing, reporting, and power management. StateTable
+ *   dispatches it from a row per state with enter/exit hooks.
  * - Sensor abstraction: ISensor + SensorFactory + SensorManager allow
  *   different physical sensors (PIR, ultrasonic, etc.) behind one API.
  * - Cloud configuration: the Cloud singleton uses Particle Ledger to
@@ -70,9 +116,13 @@ extern const char* FIRMWARE_RELEASE_NOTES;
 
 // Forward declarations
 static void appWatchdogHandler(); // Application watchdog handler
+static void checkRtcTime();   // Distrust an implausible AB1805 time before it is restored
+static bool rtcTask();        // TaskScheduler housekeeping tasks
+static bool persistTask();
+static bool queueTask();
+static bool historyTask();
 void publishData();           // Publish the data to the cloud
 void userSwitchISR();         // Interrupt for the user switch
-void sensorISR();             // Interrupt for legacy tire-counting sensor
 void countSignalTimerISR();   // Timer ISR to turn off BLUE LED
 void dailyCleanup();          // Reset daily counters and housekeeping
 void UbidotsHandler(const char *event, const char *data); // Webhook response handler
@@ -83,6 +133,9 @@ bool publishDiagnosticSafe(const char* eventName, const char* data, PublishFlags
 // to be visible for each count or PIR-triggered wake event.
 Timer countSignalTimer(1000, countSignalTimerISR, true);
 
+// PowerDomains owner tag for BLUE_LED during setup()
+static const uint8_t startupIndicator = 0;
+
 // Sleep configuration
 SystemSleepConfiguration config; // Sleep 2.0 configuration
 void outOfMemoryHandler(system_event_t event, int param);
@@ -90,14 +143,33 @@ LocalTimeConvert conv; // For converting UTC time to local time
 AB1805 ab1805(Wire);   // AB1805 RTC / Watchdog
 
 // System Health Variables
-int outOfMemory = -1; // Set by outOfMemoryHandler when heap is exhausted
+int outOfMemory = -1; // Set from an AppMessages::OUT_OF_MEMORY when heap is exhausted
 
 // ********** State Machine **********
-char stateNames[7][16] = {"Initialize", "Error",     "Idle",
-                          "Sleeping",   "Connecting", "Reporting",
-                          "FirmwareUpdate"};
+const char *const stateNames[7] = {"Initialize", "Error",     "Idle",
+                                   "Sleeping",   "Connecting", "Reporting",
+                                   "FirmwareUpdate"};
 State state = INITIALIZATION_STATE;
 State oldState = INITIALIZATION_STATE;
+TransitionReason stateReason = REASON_UNSPECIFIED;
+
+// Indexed by TransitionReason
+static const char *const reasonNames[] = {
+    "UNSPECIFIED",      "BOOT",          "NO_TIME",           "OTA_RESET",
+    "SENSOR_FAILED",    "MAINTAIN_CONNECTION", "OUT_OF_MEMORY", "USER_SWITCH",
+    "SCHEDULED_REPORT", "STORE_ONLY",    "REPORT_DONE",       "PARK_OPEN",
+    "PARK_CLOSED",      "DISCONNECT_TIMEOUT", "SENSOR_BUSY",  "TRAFFIC",
+    "SERVICE_REQUEST",  "OCCUPANCY_TIMEOUT", "SENSOR_WAKE",   "WAKE",
+    "CONNECT_BUDGET",   "QUEUE_DRAINED", "WEAK_SIGNAL",       "CONNECTED",
+    "CONNECT_TIMEOUT",  "UPDATE_PENDING", "UPDATE_DONE",      "UPDATE_CANCELLED",
+    "UPDATE_TIMEOUT",   "ERROR_CLEARED", "SCHEDULED_SAMPLE",
+    "CONNECT_BACKOFF", "SURPLUS_DRAIN", "COLD_DEFER", "FLAP_DAMPED",
+    "BROWNOUT_HOLD"};
+static_assert(sizeof(reasonNames) / sizeof(reasonNames[0]) == REASON_COUNT, "reasonNames must match TransitionReason");
+
+const char *transitionReasonName(int reason) {
+  return (reason >= 0 && reason < REASON_COUNT) ? reasonNames[reason] : "UNKNOWN";
+}
 
 // ********** Global Flags **********
 volatile bool userSwitchDetected = false;
@@ -123,29 +195,153 @@ const unsigned long resetWait = 30000;      // Error state dwell before reset
 const unsigned long maxConnectAttemptMs = 5UL * 60UL * 1000UL; // Max time to spend trying to connect per wake
 
 void setup() {
-  // Wait for serial connection when DEBUG_SERIAL is enabled
-#ifdef DEBUG_SERIAL
-  waitFor(Serial.isConnected, 10000);
-  delay(1000);
-#endif
+  StackMonitor::paint(StackMonitor::APP, APP_THREAD_STACK); // Before anything else, for the application thread high-water mark
+  BootProfile::instance().begin(); // Time each stage of setup()
+  PhaseMarker::setup();            // BOOTING on the power-analyzer pins (PHASE_MARKERS)
 
   Log.info("===== Firmware Version %s =====", FIRMWARE_VERSION);
   Log.info("===== Release Notes: %s =====", FIRMWARE_RELEASE_NOTES);
-  
+  BootProfile::instance().mark("console");
+
   System.on(out_of_memory,
             outOfMemoryHandler); // Enabling an out of memory handler is a good
                                  // safety tip. If we run out of memory a
                                  // System.reset() is done.
 
-  // Application watchdog: reset if loop() doesn't execute within 60 seconds.
+  initializePinModes(); // Initialize the pin modes
+
+  sysStatus.setup();    // Initialize persistent storage
+  sensorConfig.setup(); // Initialize the sensor configuration
+  current.setup();      // Initialize the current status data
+  TraceLog::setup();    // Before alert 16 is cleared below, so a pre-reset trace is published
+  StateTable::setup();  // Retained per-state counts
+  UpdateWindow::setup();  // Retained update-window counts; before the sensors start
+  WakeLedger::setup();    // Retained wake records; opens this boot's record
+  ConfigSnapshot::publish();  // Lock-free copy of the hot settings
+#if PERSIST_PROFILE_ENABLED
+  PersistProfile::setup();    // Debug builds: count field getter and setter calls from here on
+#endif
+  BootProfile::instance().mark("persist");
+
+  // Testing: clear sticky sleep-failure alert to avoid reset/deep-power loops.
+  if (current.isAlertActive(16)) {
+    Log.info("Clearing alert 16 on boot");
+    current.clearAlert(16);
+  }
+
+  // Initialize AB1805 RTC and watchdog. This comes straight after persistent
+  // storage so that open hours, report scheduling and day rollover have time
+  // from boot after HIBERNATE or power loss, without connecting for it.
+  const bool timeValidBeforeRtc = Time.isValid();
+  Wire.begin();
+  if (!timeValidBeforeRtc) {
+    checkRtcTime();                            // Before setup() restores Time from it
+  }
+  ab1805.withFOUT(WKP).setup(false);           // Initialize AB1805 RTC - WKP is D10 on Photon2
+  ab1805.setWDT(AB1805::WATCHDOG_MAX_SECONDS); // Enable watchdog
+
+  // Back from an overnight AB1805 power-down (State_Sleep): disarm the
+  // alarm and clear the sleep status so the next reset is not taken for one.
+  const bool wokeFromPowerDown = ab1805.getWakeReason() == AB1805::WakeReason::DEEP_POWER_DOWN;
+  if (wokeFromPowerDown) {
+    ab1805.clearRepeatingInterrupt();
+    ab1805.clearRegisterBit(AB1805::REG_STATUS, AB1805::REG_STATUS_ALM);
+    ab1805.clearRegisterBit(AB1805::REG_SLEEP_CTRL, AB1805::REG_SLEEP_CTRL_SLST);
+  }
+
+  time_t rtcTime = 0;
+  const bool rtcReadOk = ab1805.getRtcAsTime(rtcTime);
+  const bool timeValidAfterRtc = Time.isValid();
+  if (!timeValidBeforeRtc && timeValidAfterRtc) {
+    if (rtcReadOk) {
+      Log.info("RTC restored system time: %s (rtc=%s)",
+               Time.timeStr().c_str(),
+               Time.format(rtcTime, TIME_FORMAT_DEFAULT).c_str());
+    } else {
+      Log.info("RTC restored system time: %s (rtc read failed)",
+               Time.timeStr().c_str());
+    }
+    ClockDrift::restoredFromRtc();              // Correct for the AB1805's drift while the MCU was off
+  } else if (!timeValidAfterRtc) {
+    Log.warn("RTC did not restore time (rtcSet=%s rtcReadOk=%s)",
+             ab1805.isRTCSet() ? "true" : "false",
+             rtcReadOk ? "true" : "false");
+  }
+
+  BootProfile::instance().mark("rtc");
+
+  // ===== TIME AND TIMEZONE CONFIGURATION =====
+  // Setup local time from persisted timezone string (POSIX TZ format).
+  // This must be configured before we can make any open/close hour decisions.
+  char tz[sizeof(sysStatusData::SysData::timeZoneStr)];
+  sysStatus.get_timeZoneStr(tz, sizeof(tz));
+  if (tz[0] == 0) {
+    strcpy(tz, "SGT-8"); // Fallback default
+    sysStatus.set_timeZoneStr(tz);
+  }
+  LocalTime::instance().withConfig(LocalTimePosixTimezone(tz));
+  LocalOffset::reload(tz);               // Retained UTC offset table, if still for this timezone
+
+  // Sensor supply and LEDs off until something holds them; the LED
+  // polarity follows the configured sensor board
+  SensorType configuredType = static_cast<SensorType>(sysStatus.get_sensorType());
+  const SensorDefinition* sensorDef = SensorDefinitions::getDefinition(configuredType);
+  PowerDomains::setup(sensorDef && sensorDef->ledDefaultOn);
+#if INDICATOR_LEDS
+  PowerDomains::acquire(PowerDomains::STATUS_LED, &startupIndicator);
+#endif
+  AssetStore::setup();                   // Install models and tables from asset OTA before anything loads them
+#if CLASSIFIER_ENABLED
+  TinyClassifier::setup();               // Check the compiled-in and delivered models against the arena
+#endif
+
+  Log.info("Sensor ready at startup: %s", SensorManager::instance().isSensorReady() ? "true" : "false");
+
+  // ===== SENSOR ABSTRACTION LAYER =====
+  // Initialize the sensor based on configuration using *local* time. This
+  // runs after timezone configuration so open/close checks are correct, and
+  // before the rest of setup() so a HIBERNATE wake counts within milliseconds.
+  Log.info("Initial operatingMode: %d (%s)", sysStatus.get_operatingMode(),
+           sysStatus.get_operatingMode() == 0 ? "CONNECTED" :
+           sysStatus.get_operatingMode() == 1 ? "LOW_POWER" : "DISCONNECTED");
+
+  if (!SensorManager::instance().isSensorReady()) {
+    if (isWithinOpenHours()) {
+      Log.info("Initializing sensor after timezone setup");
+      SensorManager::instance().initializeFromConfig();
+
+      if (!SensorManager::instance().isSensorReady()) {
+        Log.error("Sensor failed to initialize after timezone setup; connecting to report error");
+        setState(CONNECTING_STATE, REASON_SENSOR_FAILED);
+      } else {
+        BootProfile::instance().countReady();   // Counting from here; events buffer until loop()
+      }
+    } else {
+      Log.info("Outside opening hours at startup; sensor will remain powered down");
+      // Ensure carrier sensor power rails are actually turned off even if
+      // we skipped sensor initialization while closed.
+      Log.info("Startup CLOSED: forcing sensor power down before sleep");
+      SensorManager::instance().onEnterSleep();
+      Log.info("Sensor ready after startup power-down: %s", SensorManager::instance().isSensorReady() ? "true" : "false");
+    }
+  }
+  // ===================================
+  BootProfile::instance().mark("sensor");
+
+  // ===== REST OF STARTUP =====
+  // The sensor is counting; the slower setup (cloud registrations, radio,
+  // publish queue scan, tasks) runs from here while events buffer.
+
+  // Application watchdog: reset if loop() doesn't execute within 60 seconds (APP_WATCHDOG_MS).
   // This catches state machine hangs, blocking operations, and cellular/cloud
   // stalls that exceed our non-blocking design intent. The AB1805 hardware
   // watchdog (124s) provides ultimate backstop if this software watchdog fails.
-  static ApplicationWatchdog appWatchdog(60000, appWatchdogHandler, 1536);
-  Log.info("Application watchdog enabled: 60s timeout");
+  static ApplicationWatchdog appWatchdog(APP_WATCHDOG_MS, appWatchdogHandler, 1536);
+  Log.info("Application watchdog enabled: %lus timeout", (unsigned long)(APP_WATCHDOG_MS / 1000));
 
   // Subscribe to the Ubidots integration response event so we can track
-  // successful webhook deliveries and update lastHookResponse.
+  // successful webhook deliveries and update lastHookResponse. The topic
+  // is a prefix: "<deviceID>/seq/<n>" responses name the report.
   {
     char responseTopic[125];
     String deviceID = System.deviceID();
@@ -170,19 +366,21 @@ void setup() {
 #endif
 
   Particle_Functions::instance().setup(); // Initialize the Particle functions
-
-  initializePinModes(); // Initialize the pin modes
-
-  sysStatus.setup();    // Initialize persistent storage
-  sensorConfig.setup(); // Initialize the sensor configuration
-  current.setup();      // Initialize the current status data
-
-  // Testing: clear sticky sleep-failure alert to avoid reset/deep-power loops.
-  if (current.get_alertCode() == 16) {
-    Log.info("Clearing alert 16 on boot");
-    current.set_alertCode(0);
-    current.set_lastAlertTime(0);
-  }
+  BleReadout::setup();                    // BLE readout service, off until a button press
+  HourlyHistory::instance().setup();      // Register the history backfill function
+#if FIELD_BENCH_ENABLED
+  MicroBench::setup();                    // Register the field benchmark function
+#endif
+#if TRACE_REPLAY_ENABLED
+  TraceReplay::setup();                   // Register the bench trace replay function
+#endif
+#if LOOPBACK_TEST_ENABLED
+  LoopbackTest::setup();                  // Register the bench loopback pulse train function
+#endif
+#if FAULT_INJECT_ENABLED
+  FaultInject::setup();                   // Register the bench fault injection function
+#endif
+  BootProfile::instance().mark("platform");
 
   // Track how often the device has been resetting so the error supervisor
   // can apply backoffs and avoid permanent reset loops. Only count resets
@@ -198,7 +396,7 @@ void setup() {
     // configuration from ledger. This ensures device-settings
     // (operatingMode, etc.) override any stale FRAM values.
     Log.info("OTA update detected - forcing connection to reload config");
-    state = CONNECTING_STATE;
+    setState(CONNECTING_STATE, REASON_OTA_RESET);
     break;
   case RESET_REASON_POWER_MANAGEMENT:
     // Waking from sleep. If current local hour matches opening hour (e.g., 07:00),
@@ -214,81 +412,134 @@ void setup() {
     break;
   }
 
-  // Ensure sensor-board LED power default matches configured sensor type
-  pinMode(ledPower, OUTPUT);
-  SensorType configuredType = static_cast<SensorType>(sysStatus.get_sensorType());
-  const SensorDefinition* sensorDef = SensorDefinitions::getDefinition(configuredType);
-  if (sensorDef && sensorDef->ledDefaultOn) {
-    digitalWrite(ledPower, HIGH);
-  } else {
-    digitalWrite(ledPower, LOW);
-  }
-
   // Configure publish queue to retain ~30+ days of hourly reports
   // across all supported platforms (P2, Boron, Argon). With an
   // hourly reporting interval, 800 file-backed events provide
   // headroom over the 720 events needed for a full 30 days.
+  PublishQueuePosix::instance().withFileQueueSize(800);
+#if PUBLISH_SEGMENT_STORE
+  // 8 x 24 KB holds the 800-event limit at ~200 bytes per hourly report
+  PublishQueuePosix::instance().withSegmentStore("/usr/pubqseg", 8, 24 * 1024);
+#endif
+#if PUBLISH_COALESCE
+  // After an outage, send the queued hourly reports several per publish
+  PublishQueuePosix::instance().withCoalescedEvent(ProjectConfig::webhookEventName(),
+                                                   ProjectConfig::webhookBatchEventName(), "r");
+#endif
+#if PUBLISH_ADAPTIVE_RAM_QUEUE
+  PublishQueuePosix::instance().withAdaptiveRamQueue(PUBLISH_RAM_QUEUE_MAX, PUBLISH_RAM_QUEUE_MIN_FREE);
+#endif
+#if PUBLISH_EVENT_POOL
+  // RAM queue (2, or PUBLISH_RAM_QUEUE_MAX) + events being sent (up to 3) +
+  // coalescing (2) + a spare; hourly reports fit the small blocks, batches
+  // and backfill need large ones
+  PublishQueuePosix::instance().withEventPool(PUBLISH_ADAPTIVE_RAM_QUEUE ? PUBLISH_RAM_QUEUE_MAX + 6 : 8, 3);
+#endif
+#if PUBLISH_PACKED_PAYLOADS
+  PublishQueuePosix::instance().withPayloadDictionary(ProjectConfig::payloadDictionary,
+                                                      ProjectConfig::payloadDictionaryCount);
+#endif
+  PublishQueuePosix::instance().withInFlightWindow(PUBLISH_IN_FLIGHT_WINDOW);
+  PublishQueuePosix::instance().withStorageBudget(PUBLISH_STORAGE_BUDGET_EVENTS, PUBLISH_STORAGE_BUDGET_MS);
+#if PUBLISH_RETAINED_QUEUE
+  // Offline events wait in retained RAM through ULTRA_LOW_POWER naps
+  static retained uint8_t retainedQueue[PUBLISH_RETAINED_QUEUE_BYTES];
+  PublishQueuePosix::instance().withRetainedQueue(retainedQueue, sizeof(retainedQueue));
+#endif
+#if PUBLISH_PRIORITY_LANES
+  // Hourly reports keep the 800-event store; the other lanes are small
   PublishQueuePosix::instance()
-      .withFileQueueSize(800)
-      .setup(); // Initialize the publish queue
-
-  // Initialize AB1805 RTC and watchdog
-  const bool timeValidBeforeRtc = Time.isValid();
-  ab1805.withFOUT(WKP).setup();                // Initialize AB1805 RTC - WKP is D10 on Photon2
-  ab1805.setWDT(AB1805::WATCHDOG_MAX_SECONDS); // Enable watchdog
-
-  time_t rtcTime = 0;
-  const bool rtcReadOk = ab1805.getRtcAsTime(rtcTime);
-  const bool timeValidAfterRtc = Time.isValid();
-  if (!timeValidBeforeRtc && timeValidAfterRtc) {
-    if (rtcReadOk) {
-      Log.info("RTC restored system time: %s (rtc=%s)",
-               Time.timeStr().c_str(),
-               Time.format(rtcTime, TIME_FORMAT_DEFAULT).c_str());
-    } else {
-      Log.info("RTC restored system time: %s (rtc read failed)",
-               Time.timeStr().c_str());
-    }
-  } else if (!timeValidAfterRtc) {
-    Log.warn("RTC did not restore time (rtcSet=%s rtcReadOk=%s)",
-             ab1805.isRTCSet() ? "true" : "false",
-             rtcReadOk ? "true" : "false");
-  }
+      .withDefaultLane(ProjectConfig::LANE_REPORT)
+      .withLane(ProjectConfig::LANE_ALERT, 24)
+      .withLane(ProjectConfig::LANE_STATUS, 24)
+      .withLane(ProjectConfig::LANE_DIAGNOSTIC, 16, LaneEviction::DISCARD_NEWEST);
+#if PUBLISH_BACKLOG_COMPACTION
+  // Past 600 queued reports (25 days), fold whole old days into one summary
+  // each; 60 summaries cover two more months
+  static ReportCompactor reportCompactor;
+  PublishQueuePosix::instance()
+      .withLane(ProjectConfig::LANE_SUMMARY, 60)
+      .withCompaction(&reportCompactor, 600, ProjectConfig::LANE_SUMMARY);
+#endif
+#endif
+  BackgroundPublishRK::instance()
+      .withStackSize(PUBLISH_THREAD_STACK)
+      .withThreadStart([](size_t stackBytes) { StackMonitor::paint(StackMonitor::PUBLISH, stackBytes); });
+  DataUsage::setup();                    // Cloud bytes by category, counted as the queue sends
+  ConnectHistory::setup();               // Cloud drops and reconnects (cloud_status)
+  BrownoutGuard::setup();                // low_battery event: save counters, hold the radio off
+  PublishQueuePosix::instance().setup(); // Initialize the publish queue
+  BootProfile::instance().mark("queue");
+  EventArchive::setup();                 // Raw event archive writer (EVENT_ARCHIVE_ENABLED)
+
+  // Housekeeping for each transit of the main loop, run by TaskScheduler
+  // under the loop budget: name, period ms, budget us, deadline ms.
+  // APP_TASKS counts every task with all the optional ones built in: the
+  // 14 + 5 added below, "connected" (State_Connect) and "config" and
+  // "ledgers" (Cloud). Keep it in step when adding a task.
+  static constexpr size_t APP_TASKS = 14 + 5 + 1 + 2;
+  static_assert(APP_TASKS <= TaskScheduler::MAX_TASKS, "Raise TaskScheduler::MAX_TASKS for the tasks added here");
+  TaskScheduler::instance().withLoopBudgetMs(LOOP_BUDGET_MS);
+  TaskScheduler::instance().add("usblog", UsbLogSink::poll, 50, 2000, 1000);  // Buffered logs out to a USB host once one attaches
+  TaskScheduler::instance().add("rtc", rtcTask, 1000, 2000, 1000);        // RTC sync after a cloud time sync, AB1805 watchdog pets (no I2C otherwise)
+  TaskScheduler::instance().add("persist", persistTask, 0, 20000, 1000);  // Deferred saves of current, sysStatus, sensorConfig
+  TaskScheduler::instance().add("queue", queueTask, 0, 10000, 500);       // Outgoing publish queue
+  TaskScheduler::instance().add("history", historyTask, 0, 10000, 5000);  // Requested history backfill into the idle queue
+  TaskScheduler::instance().add("reports", ReportTracker::loop, 1000, 5000, 5000); // Resend of reports no webhook response confirmed
+  TaskScheduler::instance().add("energy", EnergyLedger::loop, 1000, 2000, 1000); // Time in each state and power domain
+  TaskScheduler::instance().add("trace", TraceLog::loop, 1000, 20000, 5000);      // Pre-reset trace after an alert 14/15/16 reset
+  TaskScheduler::instance().add("temp", SensorManager::temperatureTask, 0, 2000, 1000); // TMP112A one-shot conversions
+  TaskScheduler::instance().add("live", LiveCount::loop, 1000, 2000, 5000);        // Live count updates in CONNECTED mode
+  TaskScheduler::instance().add("occupancy", OccupancyNotify::loop, 1000, 2000, 5000); // Coalesced occupancy change events
+  TaskScheduler::instance().add("heap", HeapMonitor::loop, 1000, 1000, 10000);     // Free heap and largest block trend (alert 13)
+  TaskScheduler::instance().add("brownout", BrownoutGuard::loop, 1000, 20000, 5000); // Low-battery checkpoint and radio hold
+  TaskScheduler::instance().add("ble", BleReadout::loop, 50, 2000, 1000);          // BLE readout commands and replies
+#if LOOPBACK_TEST_ENABLED
+  TaskScheduler::instance().add("loopback", LoopbackTest::loop, 100, 5000, 1000); // Bench loopback result once the train settles
+#endif
+#if SOAK_TEST_ENABLED
+  TaskScheduler::instance().add("soak", SoakTest::loop, 100, 1000, 1000);          // Bench soak synthetic events
+#endif
+#if FAULT_INJECT_ENABLED
+  TaskScheduler::instance().add("fault", FaultInject::loop, 100, 1000, 1000);      // Bench fault commands and recovery episodes
+#endif
+#if PERSIST_PROFILE_ENABLED
+  TaskScheduler::instance().add("persistprof", PersistProfile::loop, 1000, 5000, 5000); // Debug builds: busiest persistent fields
+#endif
+#if EVENT_ARCHIVE_ENABLED && EVENT_ARCHIVE_UPLOAD_ENABLED
+  TaskScheduler::instance().add("archive", EventArchive::loop, 1000, 2000, 5000);  // Event archive bulk upload gate
+#endif
+  setupConnectingState();                  // Post-connect work beside the queue drain
+  EnergyLedger::setup(wokeFromPowerDown);  // Credit a HIBERNATE or power-down that ended in this boot
+  MonoClock::setup();                      // Continue the monotonic clock from its checkpoint and the RTC
 
   Cloud::instance().setup(); // Initialize the cloud functions
+  ConnectCache::setup();     // Keep the cloud session across sleeps
+  OtaScheduler::setup();     // Firmware updates wait for battery, signal and the update hours
 
   // Enqueue a one-time status snapshot so the cloud can see
   // firmware version, reset reason, and any outstanding alert
   // soon after the first successful connection.
   publishStartupStatus();
-
-  // ===== TIME AND TIMEZONE CONFIGURATION =====
-  // Setup local time from persisted timezone string (POSIX TZ format).
-  // This must be configured before we can make any open/close hour decisions.
-  String tz = sysStatus.get_timeZoneStr();
-  if (tz.length() == 0) {
-    tz = "SGT-8"; // Fallback default
-    sysStatus.set_timeZoneStr(tz.c_str());
-  }
-  LocalTime::instance().withConfig(LocalTimePosixTimezone(tz.c_str()));
+  BootProfile::instance().mark("cloud");
 
   // Validate time and configure local time converter
   if (!Time.isValid()) {
     Log.info("Time is invalid - %s so connecting", Time.timeStr().c_str());
-    state = CONNECTING_STATE;
+    setState(CONNECTING_STATE, REASON_NO_TIME);
   } else {
     Log.info("Time is valid - %s", Time.timeStr().c_str());
     
     // Now that time is valid, configure local time converter for timezone-aware operations
     conv.withCurrentTime().convert();
-    Log.info("Timezone: %s, Local time: %s", tz.c_str(), conv.format(TIME_FORMAT_DEFAULT).c_str());
+    Log.info("Timezone: %s, Local time: %s", tz, conv.format(TIME_FORMAT_DEFAULT).c_str());
     Log.info("Open hours %02u:00-%02u:00, currently: %s",
              sysStatus.get_openTime(), sysStatus.get_closeTime(),
              isWithinOpenHours() ? "OPEN" : "CLOSED");
 
     // Check if waking from overnight hibernate - suppress alert 40 since
     // 8+ hours without webhook during closed hours is expected, not an error.
-    if (System.resetReason() == RESET_REASON_POWER_MANAGEMENT) {
+    if (System.resetReason() == RESET_REASON_POWER_MANAGEMENT || wokeFromPowerDown) {
       uint8_t localHour = (uint8_t)(conv.getLocalTimeHMS().toSeconds() / 3600);
       if (localHour == sysStatus.get_openTime()) {
         Log.info("Wake from overnight hibernate at opening hour - suppressing alert 40");
@@ -298,91 +549,37 @@ void setup() {
 
     // In CONNECTED operating mode, always connect on boot to reload
     // configuration from ledger and prevent stuck-in-IDLE power drain.
-    if (sysStatus.get_operatingMode() == CONNECTED) {
+    if (PowerGovernor::operatingMode() == CONNECTED) {
       Log.info("CONNECTED mode - connecting on boot to reload config");
-      state = CONNECTING_STATE;
+      setState(CONNECTING_STATE, REASON_MAINTAIN_CONNECTION);
     }
   }
 
-  Log.info("Sensor ready at startup: %s", SensorManager::instance().isSensorReady() ? "true" : "false");
-
-  // ===== SENSOR ABSTRACTION LAYER =====
-  // Initialize the sensor based on configuration using *local* time. This
-  // runs after timezone configuration so open/close checks are correct.
-  Log.info("Initial operatingMode: %d (%s)", sysStatus.get_operatingMode(),
-           sysStatus.get_operatingMode() == 0 ? "CONNECTED" :
-           sysStatus.get_operatingMode() == 1 ? "LOW_POWER" : "DISCONNECTED");
-
-  if (!SensorManager::instance().isSensorReady()) {
-    if (isWithinOpenHours()) {
-      Log.info("Initializing sensor after timezone setup");
-      SensorManager::instance().initializeFromConfig();
-
-      if (!SensorManager::instance().isSensorReady()) {
-        Log.error("Sensor failed to initialize after timezone setup; connecting to report error");
-        state = CONNECTING_STATE;
-      }
-    } else {
-      Log.info("Outside opening hours at startup; sensor will remain powered down");
-      // Ensure carrier sensor power rails are actually turned off even if
-      // we skipped sensor initialization while closed.
-      Log.info("Startup CLOSED: forcing sensor power down before sleep");
-      SensorManager::instance().onEnterSleep();
-      Log.info("Sensor ready after startup power-down: %s", SensorManager::instance().isSensorReady() ? "true" : "false");
-    }
-  }
-  // ===================================
+  BootProfile::instance().mark("time");
 
   attachInterrupt(BUTTON_PIN, userSwitchISR,
                   FALLING); // We may need to monitor the user switch to change
                             // behaviours / modes
 
   if (state == INITIALIZATION_STATE)
-    state = IDLE_STATE; // Default to IDLE; CONNECTING only when explicitly requested
+    setState(IDLE_STATE, REASON_BOOT); // Default to IDLE; CONNECTING only when explicitly requested
   Log.info("Startup complete");
-  digitalWrite(BLUE_LED, LOW); // Signal the end of startup
+  BootProfile::instance().end();
+#if MICROBENCH_ENABLED
+  MicroBench::run();   // Bench builds: hot-path timing table on USB serial
+#endif
+  PowerDomains::release(PowerDomains::STATUS_LED, &startupIndicator); // Signal the end of startup
 }
 
 void loop() {
-  // Main state machine driving sensing, reporting, power management
-  switch (state) {
-  case IDLE_STATE:
-    handleIdleState();
-    break;
+  TaskScheduler::instance().beginPass(state);   // Pass times are kept per State
+  AppMessages::loop();                          // What system-thread callbacks posted since the last pass
 
-  case SLEEPING_STATE:
-    handleSleepingState();
-    break;
-
-  case REPORTING_STATE:
-    handleReportingState();
-    break;
-
-  case CONNECTING_STATE:
-    handleConnectingState();
-    break;
-
-  case FIRMWARE_UPDATE_STATE:
-    handleFirmwareUpdateState();
-    break;
-
-  case ERROR_STATE:
-    handleErrorState();
-    break;
-  }
-
-  ab1805.loop(); // Keeps the RTC synchronized with the device clock
-
-  // Housekeeping for each transit of the main loop
-  current.loop();
-  sysStatus.loop();
-  sensorConfig.loop();
-
-  // Service deferred cloud work (ledger status publishes, etc.)
-  Cloud::instance().loop();
+  // Main state machine driving sensing, reporting, power management
+  StateTable::dispatch();
 
-  // Service outgoing publish queue
-  PublishQueuePosix::instance().loop();
+  // Housekeeping and deferred cloud work, within what is left of the loop budget
+  TaskScheduler::instance().loop();
 
   // If an out-of-memory event occurred, go to error state
   if (outOfMemory >= 0) {
@@ -390,14 +587,19 @@ void loop() {
     // Out-of-memory is treated as a critical alert; only overwrite any
     // existing alert if this is more severe.
     current.raiseAlert(14);
-    state = ERROR_STATE;
+    setState(ERROR_STATE, REASON_OUT_OF_MEMORY);
   }
 
-  // If the user switch is pressed, force a connection to drain queue.
+  // If the user switch is pressed, open the BLE readout window; a press
+  // with the window already open forces a connection to drain the queue.
   if (userSwitchDetected) {
-    Log.info("User switch pressed - connecting to drain queue");
     userSwitchDetected = false;
-    state = CONNECTING_STATE;
+    if (BleReadout::takeButton()) {
+      Log.info("User switch pressed - BLE readout open");
+    } else {
+      Log.info("User switch pressed - connecting to drain queue");
+      setState(CONNECTING_STATE, REASON_USER_SWITCH);
+    }
   }
 
   // ********** Centralized sensor event handling **********
@@ -405,7 +607,10 @@ void loop() {
   // counts are captured even during long-running operations like cellular
   // connection attempts (which can take minutes) or firmware updates.
   // SCHEDULED mode is time-based (handled in IDLE only), not interrupt-driven.
-  uint8_t countingMode = sysStatus.get_countingMode();
+  uint8_t countingMode = ConfigSnapshot::read().countingMode;
+#if TRACE_REPLAY_ENABLED
+  TraceReplay::loop();     // Bench only: recorded edges in ahead of the handler
+#endif
   if (countingMode == COUNTING) {
     handleCountingMode();  // Count each sensor event
   } else if (countingMode == OCCUPANCY) {
@@ -416,85 +621,120 @@ void loop() {
 
 // ********** Helper Functions **********
 
+/**
+ * @brief Mark the AB1805 time as not set unless it can be trusted
+ *
+ * @details AB1805::setup() restores Time from the RTC whenever its WRTC bit
+ * is clear, which it is from the first write until the RTC loses power.
+ * A time before RTC_MIN_VALID_TIME, or before the last cloud sync wrote it
+ * (sysStatus rtcSetTime), means the count was corrupted; WRTC is set so
+ * the RTC counts as unset until the next cloud sync writes it again.
+ */
+static void checkRtcTime() {
+  time_t rtcTime = 0;
+  if (!ab1805.isRTCSet() || !ab1805.getRtcAsTime(rtcTime)) {
+    return;
+  }
+  if (rtcTime < RTC_MIN_VALID_TIME || rtcTime < sysStatus.get_rtcSetTime()) {
+    Log.warn("RTC time %s is not plausible - not restoring it",
+             Time.format(rtcTime, TIME_FORMAT_DEFAULT).c_str());
+    ab1805.setRegisterBit(AB1805::REG_CTRL_1, AB1805::REG_CTRL_1_WRTC);
+  }
+}
+
+// TaskScheduler tasks added in setup()
+static bool rtcTask() {
+  ClockDrift::loop();                           // Before ab1805.loop() so a fresh sync is measured first
+  ab1805.loop();
+  return true;
+}
+
+static bool persistTask() {
+  ConnectHistory::fold();
+  MonoClock::checkpoint(false);
+  current.loop();
+  sysStatus.loop();
+  sensorConfig.loop();
+  return true;
+}
+
+static bool queueTask() {
+  PublishQueuePosix::instance().loop();
+  return true;
+}
+
+static bool historyTask() {
+  HourlyHistory::instance().loop();
+  return true;
+}
+
 // ApplicationWatchdog expects a plain function pointer.
 static void appWatchdogHandler() {
+  TraceLog::record(TraceLog::APP_WATCHDOG, state);
   System.reset();
 }
 
 // Helper to determine whether current *local* time is within park open hours.
 // Local time is derived from LocalTimeRK using the configured timezone.
 // If time is not yet valid, we treat it as "open" so the device can start
-// sensing while it acquires time and configuration.
+// sensing while it acquires time and configuration. OpenHours looks the
+// answer up in its precomputed schedule, so this is cheap to call per pass.
 bool isWithinOpenHours() {
-  if (!Time.isValid()) {
-    return true;
-  }
-
-  uint8_t openHour = sysStatus.get_openTime();
-  uint8_t closeHour = sysStatus.get_closeTime();
-  // Use LocalTimeRK to convert UTC to local hour based on the
-  // configured timezone (see setup()).
-  LocalTimeConvert tempConv;
-  tempConv.withConfig(LocalTime::instance().getConfig()).withCurrentTime().convert();
-  uint8_t hour = (uint8_t)(tempConv.getLocalTimeHMS().toSeconds() / 3600);
-
-  if (openHour < closeHour) {
-    // Simple daytime window, e.g. 6 -> 22
-    return (hour >= openHour) && (hour < closeHour);
-  } else if (openHour > closeHour) {
-    // Overnight window, e.g. 20 -> 6
-    return (hour >= openHour) || (hour < closeHour);
-  } else {
-    // openHour == closeHour: treat as always open
-    return true;
-  }
+  return OpenHours::isOpen();
 }
 
-// Helper to compute seconds until next park opening time (local time)
+// Helper to compute seconds until next park opening time (local time),
+// looked up in the OpenHours schedule. Overnight windows (e.g. 20 -> 6)
+// get the real time to the next open rather than an hourly retry.
 int secondsUntilNextOpen() {
-  if (!Time.isValid()) {
-    // Fallback: 1 hour if time is not yet valid
-    return 3600;
-  }
-
-  uint8_t openHour = sysStatus.get_openTime();
-  uint8_t closeHour = sysStatus.get_closeTime();
-
-  LocalTimeConvert tempConv;
-  tempConv.withConfig(LocalTime::instance().getConfig()).withCurrentTime().convert();
-  uint32_t secondsOfDay = tempConv.getLocalTimeHMS().toSeconds();
+  return OpenHours::secondsUntilNextOpen();
+}
 
-  uint32_t openSec = (uint8_t)openHour * 3600;
-  uint32_t closeSec = (uint8_t)closeHour * 3600;
+// The "status" fields of this boot wait for the next report (STARTUP_STATUS_PIGGYBACK)
+static bool bootInfoPending = false;
 
-  // Normalize: if we're currently within opening hours, next open is tomorrow
-  if (isWithinOpenHours()) {
-    return (int)((24 * 3600UL - secondsOfDay) + openSec);
+/**
+ * @brief Decide whether this hour's report can be skipped as unchanged.
+ *
+ * @details Only with reportHeartbeatHours set. A report is redundant when
+ *          nothing was counted this hour, the daily count, battery state,
+ *          alert and reset count match the last queued report, SoC and
+ *          temperature are within their deltas, and the last queued report
+ *          is less than reportHeartbeatHours old. The skipped hours all
+ *          have hourly=0 and the same daily value, so Ubidots' hourly sums
+ *          and last-value daily are the same with or without them;
+ *          battery and temperature interpolate between heartbeats. The
+ *          first report after a piggybacked boot is never redundant.
+ *
+ * @param battState Battery state going into this report
+ * @param reportTime This report's hour stamp, as recorded for the last one
+ */
+static bool reportIsRedundant(uint8_t battState, time_t reportTime) {
+  if (bootInfoPending) {
+    return false;   // The report carries this boot's status
   }
-
-  if (openHour < closeHour) {
-    // Simple daytime window, closed before open or after close
-    if (secondsOfDay < openSec) {
-      // Before opening today
-      return (int)(openSec - secondsOfDay);
-    } else {
-      // After closing, next open is tomorrow
-      return (int)((24 * 3600UL - secondsOfDay) + openSec);
-    }
-  } else if (openHour > closeHour) {
-    // Overnight window; closed between closeHour and openHour
-    if (secondsOfDay < openSec && secondsOfDay >= closeSec) {
-      // During the closed gap today
-      return (int)(openSec - secondsOfDay);
-    } else {
-      // Otherwise next open is later today or tomorrow, but isWithinOpenHours()
-      // was already false so this path will generally be rare; fall back to 1 hour
-      return 3600;
-    }
-  } else {
-    // openHour == closeHour: always open; should not normally reach here
-    return 3600;
+  const uint8_t heartbeatHours = sysStatus.get_reportHeartbeatHours();
+  const time_t lastPublished = current.get_lastPublishedTime();
+  if (heartbeatHours == 0 || lastPublished == 0) {
+    return false;
+  }
+  // Both are hour stamps, so hours with no report at all (asleep, closed) count too
+  if (reportTime - lastPublished >= (time_t)heartbeatHours * 3600) {
+    return false;   // This one is the heartbeat
   }
+  if (current.get_hourlyCount() != 0 || ScheduledSampler::hasSamples() ||
+      current.get_dailyCount() != current.get_lastPublishedDaily() ||
+      battState != current.get_lastPublishedBatteryState() ||
+      current.get_alertCode() != current.get_lastPublishedAlert() ||
+      (uint8_t)sysStatus.get_resetCount() != current.get_lastPublishedResets()) {
+    return false;
+  }
+  // The deltas are whole percent and degrees; the readings are tenths and hundredths
+  if (abs((int)current.get_socTenths() - (int)current.get_lastPublishedSocTenths()) > sysStatus.get_reportSocDelta() * 10 ||
+      abs((int)current.get_internalTempCenti() - (int)current.get_lastPublishedTempCenti()) > sysStatus.get_reportTempDelta() * 100) {
+    return false;
+  }
+  return true;
 }
 
 /**
@@ -503,19 +743,11 @@ int secondsUntilNextOpen() {
  * @details
  * 1) Builds a compact JSON payload expected by the Ubidots webhook template
  *    and enqueues it via PublishQueuePosix to the "Ubidots-Parking-Hook-v1" event.
- * 2) Updates the Particle Ledger "device-data" with a richer JSON snapshot
- *    via Cloud::publishDataToLedger() for Console visibility.
+ * 2) Marks the Particle Ledger "device-data" dirty with a snapshot of the
+ *    report (Cloud::markLedgerDirty()); it is written before sleep.
+ * The dataDelivery setting can drop either one.
  */
 void publishData() {
-  // Legacy Ubidots context strings describing battery state
-  static const char *batteryContext[7] = {
-    "Unknown", "Not Charging", "Charging",
-    "Charged", "Discharging", "Fault",
-    "Diconnected"
-  };
-
-  char data[256];
-
   // Compute the timestamp as the last second of the previous hour so the
   // webhook data aggregates correctly into hourly buckets in Ubidots.
   unsigned long timeStampValue = Time.now() - (Time.minute() * 60L + Time.second() + 1L);
@@ -526,34 +758,294 @@ void publishData() {
     battState = 0;
   }
 
-  // Correct Ubidots webhook JSON structure
-  snprintf(data, sizeof(data),
-           "{\"hourly\":%i, \"daily\":%i, \"battery\":%4.2f,\"key1\":\"%s\", \"temp\":%4.2f, \"resets\":%i, \"alerts\":%i,\"connecttime\":%i,\"timestamp\":%lu000}",
-           current.get_hourlyCount(),
-           current.get_dailyCount(),
-           current.get_stateOfCharge(),
-           batteryContext[battState],
-           current.get_internalTempC(),
-           sysStatus.get_resetCount(),
-           current.get_alertCode(),
-           sysStatus.get_lastConnectionDuration(),
-           timeStampValue);
+#if SENSOR_DRIVER_LORA_GATEWAY
+  // A gateway's own counts stay at zero; its nodes go out every interval
+  if (sysStatus.get_sensorType() == static_cast<uint8_t>(SensorType::LORA_GATEWAY)) {
+    LoRaGatewaySensor::instance().publishNodes((uint32_t)timeStampValue);
+  }
+#endif
+#if SENSOR_DRIVER_RAIN_BUCKET
+  // Rate and intensity for the interval; the tips themselves are the counts
+  if (sysStatus.get_sensorType() == static_cast<uint8_t>(SensorType::RAIN_BUCKET)) {
+    RainBucketSensor::instance().publishReport((uint32_t)timeStampValue);
+  }
+#endif
+
+  if (reportIsRedundant(battState, (time_t)timeStampValue)) {
+    current.set_reportsSuppressed(current.get_reportsSuppressed() + 1);
+    Log.info("Report suppressed as unchanged (%u since last report)", (unsigned)current.get_reportsSuppressed());
+    // The durable copy still gets every hour
+    HourlyHistory::instance().record(timeStampValue,
+                                     current.get_dailyCount(),
+                                     current.get_totalOccupiedSeconds(),
+                                     current.get_socTenths(),
+                                     current.get_internalTempCenti(),
+                                     current.get_alertCode());
+    return;
+  }
+
+#if COUNT_BINS_ENABLED
+  // Shape of the hour: twelve 5-minute counts, 16 characters of base64
+  uint8_t bins[CompactReport::NUM_BINS];
+  for (size_t ii = 0; ii < CompactReport::NUM_BINS; ii++) {
+    bins[ii] = current.get_countBin(ii);
+  }
+  char binsText[CompactReport::textSize(CompactReport::NUM_BINS)];
+  CompactReport::base64(bins, sizeof(bins), binsText, sizeof(binsText));
+#endif
+
+  // A device with several sensors carries their split in the same report:
+  // 8 bytes a sensor, not a report per sensor
+  char sensorsText[CompactReport::textSize(SensorManager::MAX_SENSORS * CompactReport::SENSOR_RECORD_SIZE)] = "";
+  size_t sensorCount = SensorManager::instance().sensorCount();
+  {
+    auto update = current.updateBatch();
+    for (size_t ii = 0; ii < sensorCount; ii++) {
+      current.set_sensorHealth(ii, SensorManager::instance().sensorHealth(ii));
+    }
+  }
+  if (sensorCount > 1) {
+    CompactReport::SensorFields sensors[SensorManager::MAX_SENSORS];
+    for (size_t ii = 0; ii < sensorCount; ii++) {
+      currentStatusData::SensorSlot slot = current.get_sensorSlot(ii);
+      sensors[ii].slot = (uint8_t)ii;
+      sensors[ii].health = slot.health;
+      sensors[ii].hourly = slot.hourlyCount;
+      sensors[ii].daily = slot.dailyCount;
+      sensors[ii].occupiedSec = slot.occupiedSec;
+    }
+    CompactReport::encodeSensors(sensors, sensorCount, sensorsText, sizeof(sensorsText));
+  }
+
+  // Every active alert, not just the most severe one in "alerts", with
+  // when each was first and last raised
+  char alertsText[CompactReport::textSize(CompactReport::ALERT_BITMAP_SIZE +
+                                          currentStatusData::MAX_ALERT_RECORDS * CompactReport::ALERT_RECORD_SIZE)] = "";
+  uint64_t activeAlerts = current.get_activeAlerts();
+  if (activeAlerts != 0) {
+    CompactReport::AlertFields alerts[currentStatusData::MAX_ALERT_RECORDS];
+    size_t alertCount = 0;
+    for (size_t ii = 0; ii < currentStatusData::MAX_ALERT_RECORDS; ii++) {
+      currentStatusData::AlertRecord rec = current.get_alertRecord(ii);
+      if (rec.code != 0) {
+        alerts[alertCount].code = rec.code;
+        alerts[alertCount].count = rec.count;
+        alerts[alertCount].firstSeen = (uint32_t)rec.firstSeen;
+        alerts[alertCount].lastSeen = (uint32_t)rec.lastSeen;
+        alertCount++;
+      }
+    }
+    CompactReport::encodeAlerts(activeAlerts, alerts, alertCount, alertsText, sizeof(alertsText));
+  }
+
+  // A directional sensor's in and out counts, 12 characters
+  char directionsText[CompactReport::textSize(CompactReport::DIRECTION_RECORD_SIZE)] = "";
+  if (sysStatus.get_sensorType() == static_cast<uint8_t>(SensorType::DUAL_PIR)) {
+    CompactReport::DirectionFields dirs;
+    dirs.hourlyIn = current.get_directionHourly(currentStatusData::DIRECTION_IN);
+    dirs.hourlyOut = current.get_directionHourly(currentStatusData::DIRECTION_OUT);
+    dirs.dailyIn = current.get_directionDaily(currentStatusData::DIRECTION_IN);
+    dirs.dailyOut = current.get_directionDaily(currentStatusData::DIRECTION_OUT);
+    CompactReport::encodeDirections(dirs, directionsText, sizeof(directionsText));
+    Log.info("Directions: in %lu/%lu out %lu/%lu (hour/day)",
+             (unsigned long)dirs.hourlyIn, (unsigned long)dirs.dailyIn,
+             (unsigned long)dirs.hourlyOut, (unsigned long)dirs.dailyOut);
+  }
 
   // Explicitly log the counts and alert code used in this report
-  Log.info("Report payload: hourly=%d daily=%d alert=%d",
-           (int)current.get_hourlyCount(),
-           (int)current.get_dailyCount(),
+  Log.info("Report payload: hourly=%lu daily=%lu alert=%d",
+           (unsigned long)current.get_hourlyCount(),
+           (unsigned long)current.get_dailyCount(),
            (int)current.get_alertCode());
 
-  PublishQueuePosix::instance().publish(ProjectConfig::webhookEventName(), data, PRIVATE | WITH_ACK);
-  Log.info("Ubidots Webhook: %s", data);
+  // The first report carrying a new alert code jumps the backlog; the rest
+  // stay in order in the report lane. The last queued report's alert is in
+  // current, so a reset does not send the same alert ahead again.
+  int8_t alertCode = current.get_alertCode();
+  uint8_t lane = (alertCode != 0 && (uint8_t)alertCode != current.get_lastPublishedAlert()) ? ProjectConfig::LANE_ALERT : ProjectConfig::LANE_REPORT;
+
+  // One path is enough for most of the fleet; the other doubles the traffic
+  uint8_t delivery = sysStatus.get_dataDelivery();
+  bool sendWebhook = delivery != DELIVER_LEDGER;
+
+#if PUBLISH_COMPACT_REPORT
+  // Same fields as the JSON above, 24 bytes (40 with bins) instead of ~200 on the air
+  CompactReport::Fields fields;
+  fields.hourly = current.get_hourlyCount();
+  fields.daily = current.get_dailyCount();
+  fields.socTenths = current.get_socTenths();
+  fields.batteryState = battState;
+  fields.tempCenti = current.get_internalTempCenti();
+  fields.resets = sysStatus.get_resetCount();
+  fields.alertCode = alertCode;
+  fields.connectSec = sysStatus.get_lastConnectionDuration();
+  fields.timestamp = timeStampValue;
+#if COUNT_BINS_ENABLED
+  fields.bins = bins;
+#else
+  fields.bins = nullptr;
+#endif
+
+  // The sensor list follows the record after a '.', which base64 never
+  // contains, the alert list after a second '.' and the direction counts
+  // after a third (the lists before them may then be empty)
+  char compact[CompactReport::TEXT_SIZE + 1 + sizeof(sensorsText) + 1 + sizeof(alertsText) + 1 + sizeof(directionsText)];
+  size_t compactLen = CompactReport::encode(fields, compact, sizeof(compact));
+  if (compactLen && directionsText[0]) {
+    snprintf(compact + compactLen, sizeof(compact) - compactLen, ".%s.%s.%s", sensorsText, alertsText, directionsText);
+  } else if (compactLen && alertsText[0]) {
+    snprintf(compact + compactLen, sizeof(compact) - compactLen, ".%s.%s", sensorsText, alertsText);
+  } else if (compactLen && sensorsText[0]) {
+    snprintf(compact + compactLen, sizeof(compact) - compactLen, ".%s", sensorsText);
+  }
+  if (sendWebhook) {
+    PublishQueuePosix::instance().publishToLane(lane, ProjectConfig::webhookCompactEventName(), compact, PRIVATE | WITH_ACK);
+    Log.info("Compact report: %s", compact);
+  }
+#else
+  // Fields the Ubidots webhook template expects; bit N of messaging.reportFields
+  // is entry N, so new fields only go on the end (REPORT_SCHEMA_VERSION)
+  static const Payload::Field reportSchema[] = {
+    {"hourly", Payload::INT, 0},
+    {"daily", Payload::INT, 0},
+    {"battery", Payload::SCALED, 1},
+    {"key1", Payload::STRING, 0},
+    {"temp", Payload::SCALED, 2},
+    {"resets", Payload::INT, 0},
+    {"alerts", Payload::INT, 0},
+    {"connecttime", Payload::INT, 0},
+    {"bins", Payload::STRING, 0},
+    {"timestamp", Payload::UINT64, 0},
+    {"sensors", Payload::STRING, 0},
+    {"samples", Payload::RAW, 0},
+    {"alertList", Payload::STRING, 0},
+    {"seq", Payload::UINT, 0},
+    {"dir", Payload::STRING, 0},
+    {"buckets", Payload::RAW, 0},
+    {"people", Payload::RAW, 0},
+    {"boot", Payload::RAW, 0},
+    {"occSec", Payload::UINT, 0},
+    {"signal", Payload::RAW, 0},
+    {"schema", Payload::UINT, 0},
+    {"fields", Payload::UINT, 0},
+  };
+  static_assert(sizeof(reportSchema) / sizeof(reportSchema[0]) <= 32, "reportFields is one bit per field");
+  Payload::Value values[sizeof(reportSchema) / sizeof(reportSchema[0])];
+  values[0].i = current.get_hourlyCount();
+  values[1].i = current.get_dailyCount();
+  values[2].i = current.get_socTenths();
+  values[3].s = SensorManager::batteryStateName(battState);
+  values[4].i = current.get_internalTempCenti();
+  values[5].i = sysStatus.get_resetCount();
+  values[6].i = current.get_alertCode();
+  values[7].i = sysStatus.get_lastConnectionDuration();
+#if COUNT_BINS_ENABLED
+  values[8].s = binsText;
+#else
+  values[8].s = nullptr;
+#endif
+  values[9].u64 = (uint64_t)timeStampValue * 1000;
+  values[10].s = sensorsText[0] ? sensorsText : nullptr;
+  // SCHEDULED mode: min/max/mean of this interval's readings, per sensor
+  char samplesText[256];
+  values[11].s = ScheduledSampler::formatReport(samplesText, sizeof(samplesText)) ? samplesText : nullptr;
+  values[12].s = alertsText[0] ? alertsText : nullptr;
+#if REPORT_ACK_TRACKING
+  // Echoed back in the webhook response topic; see ReportTracker.h
+  values[13].u = sendWebhook ? ReportTracker::nextSeq(timeStampValue) : 0;
+#else
+  values[13].u = 0;
+#endif
+  values[14].s = directionsText[0] ? directionsText : nullptr;
+  // Counts in each bucketSec since the last report, up to the current one
+  char bucketsText[200];
+  values[15].s = nullptr;
+  uint16_t bucketSec = current.get_bucketSec();
+  if (bucketSec != 0 && sysStatus.get_countingMode() == COUNTING) {
+    time_t bucketStart = current.get_bucketStart();
+    size_t buckets = (Time.now() > bucketStart) ? (size_t)((Time.now() - bucketStart + bucketSec - 1) / bucketSec) : 1;
+    buckets = constrain(buckets, (size_t)1, currentStatusData::MAX_BUCKETS);
+    int len = snprintf(bucketsText, sizeof(bucketsText), "{\"t\":%lu,\"s\":%u,\"n\":[", (unsigned long)bucketStart, (unsigned)bucketSec);
+    for (size_t ii = 0; ii < buckets && len < (int)sizeof(bucketsText); ii++) {
+      len += snprintf(bucketsText + len, sizeof(bucketsText) - len, ii ? ",%u" : "%u", (unsigned)current.get_bucket(ii));
+    }
+    if (len < (int)sizeof(bucketsText)) {
+      len += snprintf(bucketsText + len, sizeof(bucketsText) - len, "]}");
+    }
+    values[15].s = (len < (int)sizeof(bucketsText)) ? bucketsText : nullptr;
+  }
+  // People estimated from PIR pulse widths, beside the edge count, once the site is calibrated
+  char peopleText[24];
+  values[16].s = nullptr;
+  if (PIR_GROUP_ESTIMATE && sensorConfig.get_groupStepMs() != 0 && sysStatus.get_countingMode() == COUNTING) {
+    snprintf(peopleText, sizeof(peopleText), "%lu", (unsigned long)current.get_hourlyPeople());
+    values[16].s = peopleText;
+  }
+  // This boot's "status" fields, once, after a routine reset
+  char bootText[96];
+  values[17].s = nullptr;
+  if (bootInfoPending) {
+    Payload::Writer(bootText, sizeof(bootText))
+      .beginObject()
+      .add("version", FIRMWARE_VERSION)
+      .add("resetReason", (int)System.resetReason())
+      .add("resetReasonData", (unsigned long)System.resetReasonData())
+      .endObject();
+    values[17].s = bootText;
+  }
+  values[18].u = current.get_totalOccupiedSeconds();
+  char signalText[8];
+  values[19].s = nullptr;
+  int signal = SensorManager::instance().signalStrength();
+  if (signal >= 0) {
+    snprintf(signalText, sizeof(signalText), "%d", signal);
+    values[19].s = signalText;
+  }
+
+  // timestamp, seq and boot always; schema and fields only with a custom set
+  const uint32_t requiredFields = (1UL << 9) | (1UL << 13) | (1UL << 17);
+  const uint32_t tagFields = (1UL << 20) | (1UL << 21);
+  uint32_t reportFields = REPORT_FIELDS_DEFAULT;
+  if (sysStatus.get_reportSchema() == REPORT_SCHEMA_VERSION) {
+    reportFields = sysStatus.get_reportFields() & ~tagFields;
+  }
+  reportFields |= requiredFields;
+  values[20].u = REPORT_SCHEMA_VERSION;
+  values[21].u = reportFields;
+  if (reportFields != (REPORT_FIELDS_DEFAULT | requiredFields)) {
+    reportFields |= tagFields;
+  }
+
+  char data[768];
+  Payload::Writer(data, sizeof(data)).beginObject().writeFields(reportSchema, values, sizeof(values) / sizeof(values[0]), reportFields).endObject();
+  if (sendWebhook) {
+    PublishQueuePosix::instance().publishToLane(lane, ProjectConfig::webhookEventName(), data, PRIVATE | WITH_ACK);
+    Log.info("Ubidots Webhook: %s", data);
+  }
+#endif
 
-  // Also update device-data ledger with structured JSON snapshot
-  if (!Cloud::instance().publishDataToLedger()) {
-    // Data ledger publish failure; escalate via alert so the error
-    // supervisor can decide on corrective action.
-    current.raiseAlert(42);
+  current.recordPublishedReport(timeStampValue, current.get_dailyCount(),
+                                current.get_socTenths(), current.get_internalTempCenti(),
+                                battState, current.get_alertCode(),
+                                (uint8_t)sysStatus.get_resetCount());
+
+  // Keep a durable copy of the hour in case the queued event is dropped
+  HourlyHistory::instance().record(timeStampValue,
+                                   current.get_dailyCount(),
+                                   current.get_totalOccupiedSeconds(),
+                                   current.get_socTenths(),
+                                   current.get_internalTempCenti(),
+                                   current.get_alertCode());
+
+  // Also update the device-data ledger; the snapshot is taken now and
+  // written with any other ledger changes before the radio goes off.
+  if (delivery != DELIVER_WEBHOOK) {
+    Cloud::instance().markLedgerDirty(Cloud::LEDGER_DATA);
+    sysStatus.set_lastConnectDataLedger(Time.now());
   }
+  // device-status diagnostics, written if DEVICE_STATUS_DIAG_MIN has passed
+  Cloud::instance().markLedgerDirty(Cloud::LEDGER_STATUS);
+  bootInfoPending = false;
 }
 
 /**
@@ -562,35 +1054,51 @@ void publishData() {
  *
  * This uses PublishQueuePosix so the event will be delivered
  * after the next successful cloud connection, even if called
- * before the radio is brought up.
+ * before the radio is brought up. With STARTUP_STATUS_PIGGYBACK a
+ * routine reset with no alert leaves it to the next report instead.
  */
 void publishStartupStatus() {
+#if STARTUP_STATUS_PIGGYBACK && !PUBLISH_COMPACT_REPORT
+  int reason = System.resetReason();
+  if ((reason == RESET_REASON_POWER_MANAGEMENT || reason == RESET_REASON_UPDATE) &&
+      current.get_alertCode() == 0) {
+    bootInfoPending = true;
+    Log.info("Startup status: routine reset (%d) - carried by the next report", reason);
+    return;
+  }
+#endif
   char status[192];
-
-  int resetReason = System.resetReason();
-  uint32_t resetReasonData = System.resetReasonData();
-  int8_t alertCode = current.get_alertCode();
-  time_t lastAlert = current.get_lastAlertTime();
-
-  snprintf(status, sizeof(status),
-           "{\"version\":\"%s\",\"resetReason\":%d,\"resetReasonData\":%lu,\"alert\":%d,\"lastAlert\":%ld}",
-           FIRMWARE_VERSION,
-           resetReason,
-           (unsigned long)resetReasonData,
-           (int)alertCode,
-           (long)lastAlert);
-
-  PublishQueuePosix::instance().publish("status", status, PRIVATE | WITH_ACK);
+  Payload::Writer(status, sizeof(status))
+    .beginObject()
+    .add("version", FIRMWARE_VERSION)
+    .add("resetReason", (int)System.resetReason())
+    .add("resetReasonData", (unsigned long)System.resetReasonData())
+    .add("alert", (int)current.get_alertCode())
+    .add("lastAlert", (long)current.get_lastAlertTime())
+    .endObject();
+
+  PublishQueuePosix::instance().publishToLane(ProjectConfig::LANE_STATUS, "status", status, PRIVATE | WITH_ACK);
   Log.info("Startup status: %s", status);
 }
 
 void UbidotsHandler(const char *event, const char *data) {
-  // Handle response from Ubidots webhook (legacy integration)
+  // Response from the Ubidots webhook, on the system thread: only hand the
+  // status (a single number, thanks to the template) and the report seqs
+  // in the topic to the application thread
+  int status = (data && *data) ? atoi(data) : -1;
+#if REPORT_ACK_TRACKING && !PUBLISH_COMPACT_REPORT
+  if (status == 200 || status == 201) {
+    ReportTracker::postConfirms(event);
+  }
+#endif
+  AppMessages::post(AppMessages::HOOK_RESPONSE, status);
+}
+
+void handleHookResponse(int status) {
   char responseString[64];
-  // Response is only a single number thanks to Template
-  if (!strlen(data)) { // No data in response - Error
+  if (status < 0) { // No data in response - Error
     snprintf(responseString, sizeof(responseString), "No Data");
-  } else if (atoi(data) == 200 || atoi(data) == 201) {
+  } else if (status == 200 || status == 201) {
     snprintf(responseString, sizeof(responseString), "Response Received");
     dataInFlight =
         false; // We have received a response - so we can send another
@@ -600,13 +1108,12 @@ void UbidotsHandler(const char *event, const char *data) {
     // If a webhook supervision alert (40) was active, clear it now that
     // we have a confirmed successful response, so future reports reflect
     // the healthy state.
-    if (current.get_alertCode() == 40) {
-      current.set_alertCode(0);
-      current.set_lastAlertTime(0);
+    if (current.isAlertActive(40)) {
+      current.clearAlert(40);
     }
   } else {
     snprintf(responseString, sizeof(responseString),
-             "Unknown response recevied %i", atoi(data));
+             "Unknown response recevied %i", status);
   }
   if (sysStatus.get_verboseMode() && Particle.connected()) {
     publishDiagnosticSafe("Ubidots Hook", responseString, PRIVATE);
@@ -614,74 +1121,77 @@ void UbidotsHandler(const char *event, const char *data) {
   Log.info(responseString);
 }
 
-/**
- * @brief Publish a state transition to the log handler.
- */
 /**
  * @brief Safely publish diagnostic message through queue with depth guard.
  *
  * @details Routes low-priority diagnostic messages through PublishQueuePosix
  *          only when queue depth is below threshold, preventing displacement
  *          of critical telemetry data during tight loops or error conditions.
+ *          DiagnosticBudget then limits how many go out per hour.
  *
- * @param eventName The event name for the publish.
+ * @param eventName The event name for the publish; a string literal.
  * @param data The event data payload.
  * @param flags Particle publish flags (e.g., PRIVATE).
  *
- * @return true if message was queued or published, false if queue was too full.
+ * @return true if message was queued or published, false if queue was too
+ *         full or the message was over budget.
  */
 bool publishDiagnosticSafe(const char* eventName, const char* data, PublishFlags flags) {
   // Guard: only add diagnostics when queue has capacity for them.
   // Reserve headroom for critical data payloads (hourly reports, alerts).
-  // Threshold: allow diagnostics if queue has <10 events pending.
+  // Threshold: allow diagnostics if queue has <10 events pending. With
+  // priority lanes only the diagnostic lane counts; it cannot displace
+  // anything else.
   const size_t DIAGNOSTIC_QUEUE_THRESHOLD = 10;
   
+#if PUBLISH_PRIORITY_LANES
+  size_t queueDepth = PublishQueuePosix::instance().getNumEventsInLane(ProjectConfig::LANE_DIAGNOSTIC);
+#else
   size_t queueDepth = PublishQueuePosix::instance().getNumEvents();
+#endif
   
   if (queueDepth >= DIAGNOSTIC_QUEUE_THRESHOLD) {
     Log.info("Diagnostic publish skipped (queue depth=%u): %s", (unsigned)queueDepth, eventName);
     return false;
   }
-  
+
+  // What the budget dropped in the last hour goes first, outside the budget
+  char suppressed[192];
+  if (DiagnosticBudget::summary(suppressed, sizeof(suppressed))) {
+    PublishQueuePosix::instance().publishToLane(ProjectConfig::LANE_DIAGNOSTIC, "diagSuppressed", suppressed, PRIVATE | WITH_ACK);
+  }
+  if (!DiagnosticBudget::allow(eventName, data)) {
+    return false;
+  }
+
   // Queue has capacity; safe to add diagnostic message
-  PublishQueuePosix::instance().publish(eventName, data, flags | WITH_ACK);
+  PublishQueuePosix::instance().publishToLane(ProjectConfig::LANE_DIAGNOSTIC, eventName, data, flags | WITH_ACK);
   return true;
 }
 
+/**
+ * @brief Record a state transition in the trace ring and the log.
+ *
+ * @details The trace entry is a few stores; the text is only built when
+ *          the ring is dumped, and by the logger if a handler takes info.
+ */
 void publishStateTransition() {
-  char stateTransitionString[256];
-  if (state == IDLE_STATE) {
-    if (!Time.isValid())
-      snprintf(stateTransitionString, sizeof(stateTransitionString),
-               "From %s to %s with invalid time", stateNames[oldState],
-               stateNames[state]);
-    else
-      snprintf(stateTransitionString, sizeof(stateTransitionString),
-               "From %s to %s", stateNames[oldState], stateNames[state]);
-  } else
-    snprintf(stateTransitionString, sizeof(stateTransitionString),
-             "From %s to %s", stateNames[oldState], stateNames[state]);
+  TraceLog::record(TraceLog::TRANSITION, oldState, state, stateReason);
+  Log.info("From %s to %s (%s)%s", stateName(oldState), stateName(state), transitionReasonName(stateReason),
+           (state == IDLE_STATE && !Time.isValid()) ? " with invalid time" : "");
   oldState = state;
-  Log.info(stateTransitionString);
+  stateReason = REASON_UNSPECIFIED;
 }
 
 // ********** Interrupt Service Routines **********
 void outOfMemoryHandler(system_event_t event, int param) {
-  outOfMemory = param;
+  TraceLog::record(TraceLog::OUT_OF_MEMORY, param);
+  AppMessages::post(AppMessages::OUT_OF_MEMORY, param);
 }
 
 void userSwitchISR() { userSwitchDetected = true; }
 
-void sensorISR() {
-  static bool frontTireFlag = false;
-  if (frontTireFlag || sysStatus.get_sensorType() == 1) { // Counts the rear tire for pressure sensors and once for PIR (sensor type 1)
-    sensorDetect = true;                                  // sets the sensor flag for the main loop
-    frontTireFlag = false;
-  } else
-    frontTireFlag = true;
-}
-
-void countSignalTimerISR() { digitalWrite(BLUE_LED, LOW); }
+void countSignalTimerISR() { PowerDomains::release(PowerDomains::STATUS_LED, &countSignalTimer); }
 
 /**
  * @brief Cleanup function that is run at the beginning of the day.
@@ -694,19 +1204,66 @@ void dailyCleanup() {
   if (Particle.connected()) {
     publishDiagnosticSafe("Daily Cleanup", "Running", PRIVATE);
     
-    // Force time sync once per day to prevent clock drift
-    Log.info("Daily time sync requested");
-    Particle.syncTime();
-    sysStatus.set_lastTimeSync(Time.now());
+    // Sync time only when the drift model can no longer vouch for the clock
+    if (ClockDrift::syncDue()) {
+      Log.info("Daily time sync requested");
+      ClockDrift::requestSync();
+    }
   }
   
   Log.info("Running Daily Cleanup");
-  // Leave verbose mode enabled for now to aid debugging
-  if (sysStatus.get_solarPowerMode() ||
-      current.get_stateOfCharge() <=
-          65) { // If Solar or if the battery is being discharged
-    // setLowPowerMode("1");
+  // Update the SoC trend; the power tier can only step back down here
+  PowerGovernor::dailyUpdate();
+
+#if ENERGY_LEDGER_ENABLED
+  // Yesterday's energy breakdown, before resetEverything() zeroes it
+  char energyReport[768];
+  if (EnergyLedger::formatReport(energyReport, sizeof(energyReport))) {
+    Log.info("Energy: %s", energyReport);
+    publishDiagnosticSafe("energy", energyReport, PRIVATE);
+  }
+#endif
+
+  // Yesterday's wakes by reason, mean awake time and idle wakes, then start again
+  char wakeReport[512];
+  if (WakeLedger::formatReport(wakeReport, sizeof(wakeReport))) {
+    Log.info("Wakes: %s", wakeReport);
+    publishDiagnosticSafe("wakes", wakeReport, PRIVATE);
+  }
+
+  // Yesterday's state entries, dwell and transitions, then start again
+  char stateReport[512];
+  if (StateTable::formatReport(stateReport, sizeof(stateReport))) {
+    Log.info("States: %s", stateReport);
+    publishDiagnosticSafe("states", stateReport, PRIVATE);
+  }
+
+  // How well ERROR_STATE recoveries work, by level, since first boot:
+  // started, and followed by the same alert within RECOVERY_EFFECTIVE_SEC
+  static const char *const recoveryLevels[] = {"warm", "soft", "hard"};
+  uint32_t recoveries = 0;
+  char recoveryReport[128];
+  Payload::Writer recovery(recoveryReport, sizeof(recoveryReport));
+  recovery.beginObject();
+  for (size_t ii = 0; ii < sizeof(recoveryLevels) / sizeof(recoveryLevels[0]); ii++) {
+    recoveries += sysStatus.get_recoveryAttempts(ii);
+    recovery.beginObject(recoveryLevels[ii])
+            .add("n", (unsigned)sysStatus.get_recoveryAttempts(ii))
+            .add("again", (unsigned)sysStatus.get_recoveryRepeats(ii))
+            .endObject();
+  }
+  recovery.endObject();
+  if (recoveries > 0 && recovery.ok()) {
+    Log.info("Recovery: %s", recoveryReport);
+    publishDiagnosticSafe("recovery", recoveryReport, PRIVATE);
   }
+
+  // Roll the day that just ended into the day and week history
+  if (Time.isValid() && sysStatus.get_lastReport() != 0) {
+    time_t dayEnd = sysStatus.get_nextLocalMidnight();
+    RollupStore::closeDay(dayEnd ? dayEnd : OpenHours::nextMidnightAfter(sysStatus.get_lastReport()));
+  }
+
   current
       .resetEverything(); // If so, we need to Zero the counts for the new day
 }
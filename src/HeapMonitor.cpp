@@ -0,0 +1,136 @@
+#include "HeapMonitor.h"
+#include "Config.h"
+#include "MyPersistentData.h"
+#include <algorithm>
+#include <string.h>
+
+namespace HeapMonitor {
+
+static const int8_t HEAP_ALERT = 13;
+
+static uint32_t freeNow = 0;
+static uint32_t blockNow = 0;
+static uint32_t minFree = UINT32_MAX;
+static uint32_t minBlock = UINT32_MAX;
+static uint8_t maxFragPct = 0;
+
+static uint32_t hourMin[TREND_HOURS];   // Lowest free heap of each completed hour, oldest first
+static size_t hours = 0;                // Entries in hourMin
+static uint32_t thisHour = 0;           // clockSec() / 3600 of the hour being sampled
+static uint32_t thisHourMin = UINT32_MAX;
+
+static unsigned long lastSampleMs = 0;
+static bool warned = false;
+
+// Seconds on a clock that keeps running through sleep when time is valid
+static uint32_t clockSec() {
+    return Time.isValid() ? (uint32_t)Time.now() : (uint32_t)(millis() / 1000);
+}
+
+static uint8_t fragPct(uint32_t freeBytes, uint32_t block) {
+    if (freeBytes == 0 || block >= freeBytes) {
+        return 0;
+    }
+    return (uint8_t)(100 - (uint64_t)block * 100 / freeBytes);
+}
+
+// Close out the hour being sampled once the clock has left it
+static void rollHour(uint32_t hour) {
+    if (thisHour == 0 || hour == thisHour) {
+        thisHour = hour;
+        return;
+    }
+    if (hour < thisHour) {
+        // The clock moved from uptime to wall time; the hours so far are not comparable
+        hours = 0;
+    } else if (thisHourMin != UINT32_MAX) {
+        if (hours == TREND_HOURS) {
+            memmove(hourMin, hourMin + 1, (TREND_HOURS - 1) * sizeof(hourMin[0]));
+            hours--;
+        }
+        hourMin[hours++] = thisHourMin;
+    }
+    thisHour = hour;
+    thisHourMin = UINT32_MAX;
+}
+
+uint32_t lowWaterFree() {
+    return minFree;
+}
+
+uint32_t lowWaterBlock() {
+    return minBlock;
+}
+
+uint8_t worstFragPct() {
+    return maxFragPct;
+}
+
+int32_t trendPerHour() {
+    if (hours < 3) {
+        return 0;
+    }
+    // Least-squares slope of hourMin against its index
+    int64_t n = hours;
+    int64_t sumX = 0, sumY = 0, sumXY = 0, sumXX = 0;
+    for (size_t ii = 0; ii < hours; ii++) {
+        sumX += ii;
+        sumY += hourMin[ii];
+        sumXY += (int64_t)ii * hourMin[ii];
+        sumXX += (int64_t)ii * ii;
+    }
+    int64_t denom = n * sumXX - sumX * sumX;
+    return (int32_t)((n * sumXY - sumX * sumY) / denom);
+}
+
+bool loop() {
+    if (lastSampleMs != 0 && millis() - lastSampleMs < HEAP_SAMPLE_SEC * 1000UL) {
+        return true;
+    }
+    lastSampleMs = millis() | 1;
+
+    runtime_info_t info = {};
+    info.size = sizeof(info);
+    HAL_Core_Runtime_Info(&info, nullptr);
+    freeNow = info.freeheap;
+    blockNow = info.largest_free_block_heap;
+
+    minFree = std::min(minFree, freeNow);
+    minBlock = std::min(minBlock, blockNow);
+    maxFragPct = std::max(maxFragPct, fragPct(freeNow, blockNow));
+    rollHour(clockSec() / 3600);
+    thisHourMin = std::min(thisHourMin, freeNow);
+
+    int32_t trend = trendPerHour();
+    bool running = trend < 0 && (uint32_t)(-trend) * HEAP_WARN_HOURS >= freeNow;
+    bool low = freeNow < HEAP_WARN_BYTES || blockNow < HEAP_WARN_BLOCK_BYTES || running;
+    if (low && !warned) {
+        Log.warn("Heap: %lu free, largest block %lu, trend %ld B/h",
+                 (unsigned long)freeNow, (unsigned long)blockNow, (long)trend);
+        current.raiseAlert(HEAP_ALERT);
+        warned = true;
+    } else if (!low && warned) {
+        Log.info("Heap: recovered, %lu free", (unsigned long)freeNow);
+        current.clearAlert(HEAP_ALERT);
+        warned = false;
+    }
+    return true;
+}
+
+void writeStatus(JSONWriter &writer) {
+    if (lastSampleMs == 0) {
+        return;
+    }
+    writer.name("heap").beginObject();
+    writer.name("free").value((unsigned long)freeNow);
+    writer.name("minFree").value((unsigned long)minFree);
+    writer.name("block").value((unsigned long)blockNow);
+    writer.name("minBlock").value((unsigned long)minBlock);
+    writer.name("fragPct").value((int)fragPct(freeNow, blockNow));
+    writer.name("maxFragPct").value((int)maxFragPct);
+    writer.name("trend").value((int)trendPerHour());
+    writer.name("hours").value((int)hours);
+    writer.endObject();
+}
+
+} // namespace HeapMonitor
@@ -0,0 +1,64 @@
+/**
+ * @file HeapMonitor.h
+ * @brief Free heap, largest free block and their trend since boot.
+ *
+ * @details A slow leak does not show until an allocation fails, and then
+ *          it is alert 14, a reset, and the same again some hours later.
+ *          loop() samples the free heap and the largest free block every
+ *          HEAP_SAMPLE_SEC and keeps their low-water marks and the worst
+ *          fragmentation seen (the share of free heap not in the largest
+ *          block). Each hour's lowest free heap goes into a ring of
+ *          TREND_HOURS, and the least-squares slope over it is the trend,
+ *          in bytes per hour.
+ *
+ *          Below HEAP_WARN_BYTES free, below HEAP_WARN_BLOCK_BYTES in one
+ *          block, or with a falling trend that runs out within
+ *          HEAP_WARN_HOURS, it logs a warning and raises alert 13 (minor);
+ *          the alert clears once none of those hold.
+ *
+ *          Heap does not survive a reset, so neither does any of this.
+ *          Application thread only.
+ */
+
+#ifndef __HEAPMONITOR_H
+#define __HEAPMONITOR_H
+
+#include "Particle.h"
+
+namespace HeapMonitor {
+
+/** @brief Hourly low-water marks kept for the trend. */
+static constexpr size_t TREND_HOURS = 12;
+
+/**
+ * @brief Sample the heap when it is due and raise or clear alert 13; call from a task
+ *
+ * @return true (TaskScheduler convention)
+ */
+bool loop();
+
+/**
+ * @brief Bytes per hour the free heap is changing by, negative when shrinking
+ *
+ * @details 0 until there are three hours to fit.
+ */
+int32_t trendPerHour();
+
+/** @brief Lowest free heap sampled since boot (UINT32_MAX before the first sample) */
+uint32_t lowWaterFree();
+
+/** @brief Smallest largest-free-block sampled since boot (UINT32_MAX before the first sample) */
+uint32_t lowWaterBlock();
+
+/** @brief Worst fragmentation seen since boot, percent of free heap not in the largest block */
+uint8_t worstFragPct();
+
+/**
+ * @brief Write {"free":n,"minFree":n,"block":n,"minBlock":n,"fragPct":n,"maxFragPct":n,"trend":n,"hours":n}
+ *        to an open JSON object as "heap"
+ */
+void writeStatus(JSONWriter &writer);
+
+} // namespace HeapMonitor
+
+#endif /* __HEAPMONITOR_H */
@@ -0,0 +1,69 @@
+#include "HistoryPack.h"
+#include "CompactReport.h"
+
+namespace {
+
+// Fields coded as delta-of-delta; the others as plain deltas
+const bool DOD_FIELD[HistoryPack::NUM_FIELDS] = {false, false, true, true, false};
+
+void put32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+size_t putVarint(uint8_t *p, int32_t v) {
+    uint32_t zz = ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+    size_t len = 0;
+    while (zz >= 0x80) {
+        p[len++] = (uint8_t)(zz | 0x80);
+        zz >>= 7;
+    }
+    p[len++] = (uint8_t)zz;
+    return len;
+}
+
+} // namespace
+
+void HistoryPack::Encoder::begin(Kind kind, uint32_t stepSec) {
+    _buf[0] = VERSION;
+    _buf[1] = kind;
+    put32(&_buf[2], 0);
+    put32(&_buf[6], stepSec);
+    _len = HEADER_SIZE;
+    _records = 0;
+    _prevDelta = (int32_t)stepSec;
+    for (size_t ii = 0; ii < NUM_FIELDS; ii++) {
+        _prev[ii] = 0;
+        _prevFieldDelta[ii] = 0;
+    }
+}
+
+bool HistoryPack::Encoder::add(uint32_t epoch, const int32_t values[NUM_FIELDS]) {
+    if (_len + MAX_RECORD_SIZE > sizeof(_buf)) {
+        return false;
+    }
+    if (_records == 0) {
+        put32(&_buf[2], epoch);
+        _prevEpoch = epoch - (uint32_t)_prevDelta;
+    }
+
+    int32_t delta = (int32_t)(epoch - _prevEpoch);
+    _len += putVarint(&_buf[_len], delta - _prevDelta);
+    _prevEpoch = epoch;
+    _prevDelta = delta;
+
+    for (size_t ii = 0; ii < NUM_FIELDS; ii++) {
+        int32_t fieldDelta = values[ii] - _prev[ii];
+        _len += putVarint(&_buf[_len], DOD_FIELD[ii] ? fieldDelta - _prevFieldDelta[ii] : fieldDelta);
+        _prev[ii] = values[ii];
+        _prevFieldDelta[ii] = fieldDelta;
+    }
+    _records++;
+    return true;
+}
+
+size_t HistoryPack::Encoder::text(char *out, size_t outSize) const {
+    return CompactReport::base64(_buf, _len, out, outSize);
+}
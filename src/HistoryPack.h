@@ -0,0 +1,104 @@
+/**
+ * @file HistoryPack.h
+ * @brief Packed time-series encoding of history backfill.
+ *
+ * @details A backfill "history" event as JSON costs about 40 bytes a
+ *          record. Consecutive hours differ little, so this codes each
+ *          record as small differences from the one before it, in varints:
+ *          about 7 bytes an hour, so one event carries four days of hours,
+ *          and a week offline comes back in two events.
+ *
+ *          Version 1 layout, little-endian, then base64 (CompactReport::base64()):
+ *
+ *              0  u8   version (1)
+ *              1  u8   kind: 0 hours, 1 days, 2 weeks
+ *              2  u32  first record's start, Unix seconds
+ *              6  u32  step, seconds (3600, 86400 or 604800)
+ *
+ *          then per record, each a zig-zag varint (LEB128 of (v << 1) ^ (v >> 31)):
+ *
+ *              time     delta-of-delta of the start, from (start - step, step)
+ *              count    delta from the previous record's count (first from 0)
+ *              occupied delta from the previous record's occupied seconds
+ *              field 2  delta-of-delta: SoC percent (hours), lowest SoC (days, weeks)
+ *              field 3  delta-of-delta: temperature C (hours), parts (days, weeks)
+ *              alert    delta from the previous record's alert code
+ *
+ *          SoC and temperature are already stored in whole percent and
+ *          degrees, so their scale is 1. An evenly spaced series codes its
+ *          times as single zero bytes; a gap costs one larger one, and DST
+ *          days (23 or 25 hours) code exactly. Records run to the end of the
+ *          data. The decoder is in docs/webhooks/README.md (History-Packed-v1).
+ */
+
+#ifndef __HISTORYPACK_H
+#define __HISTORYPACK_H
+
+#include "Particle.h"
+
+namespace HistoryPack {
+
+/** @brief Encoding version written by Encoder. */
+static constexpr uint8_t VERSION = 1;
+
+/** @brief Values per record, after the time. */
+static constexpr size_t NUM_FIELDS = 5;
+
+/** @brief Header bytes ahead of the records. */
+static constexpr size_t HEADER_SIZE = 10;
+
+/** @brief Largest record: six 5-byte varints. */
+static constexpr size_t MAX_RECORD_SIZE = 30;
+
+/** @brief Bytes packed per event: base64 of this, in {"p":"..."}, fits one publish. */
+static constexpr size_t PACK_SIZE = ((particle::protocol::MAX_EVENT_DATA_LENGTH - 8) / 4) * 3;
+
+/** @brief Series kinds; the header's kind byte. */
+enum Kind : uint8_t {
+    HOURS = 0,
+    DAYS,
+    WEEKS
+};
+
+/**
+ * @brief Packs records into one event's worth of bytes
+ *
+ * begin(), add() until it returns false or the series ends, then text().
+ */
+class Encoder {
+public:
+    /**
+     * @brief Start an empty packet of @p kind, spaced @p stepSec apart
+     */
+    void begin(Kind kind, uint32_t stepSec);
+
+    /**
+     * @brief Append the record starting at @p epoch
+     * @return false, leaving the packet as it was, if the record does not fit
+     */
+    bool add(uint32_t epoch, const int32_t values[NUM_FIELDS]);
+
+    /** @brief Records in the packet. */
+    size_t records() const { return _records; }
+
+    /**
+     * @brief Base64 of the packet
+     *
+     * @param out Receives the null-terminated text; at least CompactReport::textSize(PACK_SIZE) bytes
+     * @return Length of the text, or 0 if out is too small
+     */
+    size_t text(char *out, size_t outSize) const;
+
+private:
+    uint8_t _buf[PACK_SIZE];
+    size_t _len = 0;
+    size_t _records = 0;
+    uint32_t _prevEpoch = 0;
+    int32_t _prevDelta = 0;
+    int32_t _prev[NUM_FIELDS] = {};
+    int32_t _prevFieldDelta[NUM_FIELDS] = {};
+};
+
+} // namespace HistoryPack
+
+#endif /* __HISTORYPACK_H */
@@ -0,0 +1,302 @@
+#include "HourlyHistory.h"
+#include "Config.h"
+#include "MyPersistentData.h"
+#include "PublishQueuePosixRK.h"
+#include "RollupStore.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static const char *historyPath = "/usr/history.dat";
+
+HourlyHistory *HourlyHistory::_instance;
+
+// [static]
+HourlyHistory &HourlyHistory::instance() {
+    if (!_instance) {
+        _instance = new HourlyHistory();
+    }
+    return *_instance;
+}
+
+HourlyHistory::HourlyHistory() {}
+
+HourlyHistory::~HourlyHistory() {}
+
+void HourlyHistory::setup() {
+    Particle.function("backfill", &HourlyHistory::backfillFunction, this);
+}
+
+uint8_t HourlyHistory::checksum(const Record &rec) {
+    const uint8_t *p = (const uint8_t *)&rec;
+    uint8_t sum = 0x5a;
+    for (size_t i = 0; i < offsetof(Record, check); i++) {
+        sum += p[i];
+    }
+    return (uint8_t)~sum;
+}
+
+void HourlyHistory::record(time_t hourEpoch, uint32_t dailyCount, uint32_t totalOccupiedSec, uint16_t socTenths, int16_t tempCenti, int8_t alert) {
+    uint32_t hour = (uint32_t)(hourEpoch - (hourEpoch % 3600));
+
+    // Both totals are daily running totals; this record's share is what they
+    // gained since the last one (all of it after the daily reset)
+    uint32_t dailyBase = current.get_historyDailyBase();
+    uint32_t occupiedBase = current.get_historyOccupiedBase();
+    uint32_t count = (dailyCount >= dailyBase) ? dailyCount - dailyBase : dailyCount;
+    uint32_t occupied = (totalOccupiedSec >= occupiedBase) ? totalOccupiedSec - occupiedBase : totalOccupiedSec;
+
+    int fd = open(historyPath, O_RDWR | O_CREAT, 0666);
+    if (fd < 0) {
+        Log.warn("History: open failed (%d)", errno);
+        return;
+    }
+    off_t offset = (off_t)((hour / 3600) % CAPACITY) * sizeof(Record);
+
+    // Reports more often than hourly add to the hour's slot
+    Record rec = {};
+    if (lseek(fd, offset, SEEK_SET) != offset || ::read(fd, &rec, sizeof(rec)) != (int)sizeof(rec) ||
+        rec.hourEpoch != hour || rec.check != checksum(rec)) {
+        rec = {};
+        rec.hourEpoch = hour;
+    }
+    count += rec.count;
+    occupied += rec.occupiedSec;
+    rec.count = (uint16_t)((count > 0xffff) ? 0xffff : count);
+    rec.occupiedSec = (uint16_t)((occupied > 3600) ? 3600 : occupied);
+
+    rec.soc = (uint8_t)constrain((socTenths + 5) / 10, 0, 100);
+    rec.tempC = (int8_t)constrain((tempCenti + (tempCenti < 0 ? -50 : 50)) / 100, -128, 127);
+    rec.alert = alert;
+    rec.check = checksum(rec);
+
+    if (lseek(fd, offset, SEEK_SET) != offset || write(fd, &rec, sizeof(rec)) != (int)sizeof(rec)) {
+        Log.warn("History: write failed at slot %lu", (unsigned long)(offset / sizeof(Record)));
+    }
+    else {
+        current.setHistoryBase(dailyCount, totalOccupiedSec);
+    }
+    close(fd);
+}
+
+bool HourlyHistory::read(time_t hourEpoch, Record &rec) {
+    uint32_t hour = (uint32_t)(hourEpoch - (hourEpoch % 3600));
+
+    int fd = open(historyPath, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    off_t offset = (off_t)((hour / 3600) % CAPACITY) * sizeof(Record);
+    bool ok = lseek(fd, offset, SEEK_SET) == offset && ::read(fd, &rec, sizeof(rec)) == (int)sizeof(rec);
+    close(fd);
+
+    return ok && rec.hourEpoch == hour && rec.check == checksum(rec);
+}
+
+// How far back level 0 (hours) or RollupStore level - 1 reaches
+static time_t retentionSec(uint8_t level) {
+    if (level == 0) {
+        return (time_t)HourlyHistory::CAPACITY * 3600;
+    }
+    RollupStore::Level rollup = (RollupStore::Level)(level - 1);
+    return (time_t)RollupStore::capacity(rollup) * RollupStore::periodSec(rollup);
+}
+
+int HourlyHistory::requestBackfill(time_t startEpoch, time_t endEpoch, uint32_t resolutionSec) {
+    if (!Time.isValid() || startEpoch > endEpoch) {
+        return -1;
+    }
+    time_t now = Time.now();
+
+    // The coarsest level the resolution allows, then coarser until it reaches back to the start
+    uint8_t level = 0;
+    for (uint8_t ii = RollupStore::NUM_LEVELS; ii > 0; ii--) {
+        if (RollupStore::periodSec((RollupStore::Level)(ii - 1)) <= resolutionSec) {
+            level = ii;
+            break;
+        }
+    }
+    time_t oldest = now - retentionSec(level);
+    while (startEpoch < oldest && level < RollupStore::NUM_LEVELS) {
+        oldest = now - retentionSec(++level);
+    }
+    if (endEpoch < oldest) {
+        return -1;
+    }
+    if (startEpoch < oldest) {
+        startEpoch = oldest;
+    }
+    if (endEpoch > now) {
+        endEpoch = now;
+    }
+
+    _backfillLevel = level;
+    _pack.begin((HistoryPack::Kind)level, (level > 0) ? RollupStore::periodSec((RollupStore::Level)(level - 1)) : 3600);
+    if (level > 0) {
+        RollupStore::Level rollup = (RollupStore::Level)(level - 1);
+        _backfillNext = RollupStore::periodAt(rollup, startEpoch);
+        _backfillEnd = RollupStore::periodAt(rollup, endEpoch);
+        int periods = (int)(_backfillEnd - _backfillNext) + 1;
+        Log.info("History: backfill of %d %s queued", periods, (rollup == RollupStore::WEEK) ? "weeks" : "days");
+        return periods;
+    }
+    _backfillNext = (uint32_t)(startEpoch - (startEpoch % 3600));
+    _backfillEnd = (uint32_t)(endEpoch - (endEpoch % 3600));
+    int hours = (int)((_backfillEnd - _backfillNext) / 3600) + 1;
+    Log.info("History: backfill of %d hours queued", hours);
+    return hours;
+}
+
+int HourlyHistory::backfillFunction(String command) {
+    long first = 0;
+    long second = 0;
+    long resolution = 3600;
+    int fields = sscanf(command.c_str(), "%ld,%ld,%ld", &first, &second, &resolution);
+    if (fields == 1) {
+        // A single value is a number of recent hours
+        if (first < 1) {
+            return -1;
+        }
+        time_t now = Time.now();
+        return requestBackfill(now - (time_t)first * 3600, now);
+    }
+    if (fields < 2 || resolution < 1) {
+        return -1;
+    }
+    return requestBackfill((time_t)first, (time_t)second, (uint32_t)resolution);
+}
+
+void HourlyHistory::loop() {
+    if (!_backfillNext || !Particle.connected()) {
+        return;
+    }
+    // One chunk at a time, only behind normal traffic
+    if (PublishQueuePosix::instance().getNumEvents() > 0) {
+        return;
+    }
+#if HISTORY_PACKED_BACKFILL
+    loopPacked();
+    return;
+#endif
+
+    char data[512];
+    JSONBufferWriter writer(data, sizeof(data) - 1);
+    writer.beginObject();
+    writer.name((_backfillLevel == 0) ? "h" : (_backfillLevel == 1) ? "d" : "w").beginArray();
+
+    // Bound the slot reads per pass so a sparse range does not stall loop()
+    uint8_t found = 0;
+    uint8_t scanned = 0;
+    while (_backfillLevel > 0 && _backfillNext && found < RECORDS_PER_EVENT && scanned++ < 48) {
+        RollupStore::Record rec;
+        if (RollupStore::read((RollupStore::Level)(_backfillLevel - 1), _backfillNext, rec)) {
+            writer.beginArray()
+                .value((unsigned long)rec.startEpoch)
+                .value((unsigned long)rec.count)
+                .value((unsigned long)rec.occupiedSec)
+                .value(rec.socMin)
+                .value(rec.parts)
+                .value(rec.alert)
+                .endArray();
+            found++;
+        }
+        _backfillNext = (_backfillNext >= _backfillEnd) ? 0 : _backfillNext + 1;
+    }
+    while (_backfillLevel == 0 && _backfillNext && found < RECORDS_PER_EVENT && scanned++ < 48) {
+        Record rec;
+        if (read(_backfillNext, rec)) {
+            writer.beginArray()
+                .value((unsigned long)rec.hourEpoch)
+                .value(rec.count)
+                .value(rec.occupiedSec)
+                .value(rec.soc)
+                .value(rec.tempC)
+                .value(rec.alert)
+                .endArray();
+            found++;
+        }
+        _backfillNext = (_backfillNext >= _backfillEnd) ? 0 : _backfillNext + 3600;
+    }
+
+    writer.endArray();
+    writer.endObject();
+    if (writer.dataSize() >= sizeof(data)) {
+        Log.warn("History: chunk truncated");
+        return;
+    }
+    data[writer.dataSize()] = '\0';
+
+    if (found) {
+        PublishQueuePosix::instance().publish("history", data, PRIVATE | WITH_ACK);
+    }
+    if (!_backfillNext) {
+        Log.info("History: backfill complete");
+    }
+}
+
+bool HourlyHistory::readPacked(uint32_t index, uint32_t &epoch, int32_t values[HistoryPack::NUM_FIELDS]) {
+    if (_backfillLevel > 0) {
+        RollupStore::Record rec;
+        if (!RollupStore::read((RollupStore::Level)(_backfillLevel - 1), index, rec)) {
+            return false;
+        }
+        epoch = rec.startEpoch;
+        values[0] = (int32_t)rec.count;
+        values[1] = (int32_t)rec.occupiedSec;
+        values[2] = rec.socMin;
+        values[3] = rec.parts;
+        values[4] = rec.alert;
+        return true;
+    }
+    Record rec;
+    if (!read(index, rec)) {
+        return false;
+    }
+    epoch = rec.hourEpoch;
+    values[0] = rec.count;
+    values[1] = rec.occupiedSec;
+    values[2] = rec.soc;
+    values[3] = rec.tempC;
+    values[4] = rec.alert;
+    return true;
+}
+
+void HourlyHistory::publishPacked() {
+    // The text goes straight into the JSON wrapper
+    char data[particle::protocol::MAX_EVENT_DATA_LENGTH + 1];
+    memcpy(data, "{\"p\":\"", 6);
+    size_t len = _pack.text(data + 6, sizeof(data) - 8);
+    if (len) {
+        memcpy(data + 6 + len, "\"}", 3);
+        PublishQueuePosix::instance().publish("history", data, PRIVATE | WITH_ACK);
+    } else {
+        Log.warn("History: packet too large");
+    }
+    _pack.begin((HistoryPack::Kind)_backfillLevel,
+                (_backfillLevel > 0) ? RollupStore::periodSec((RollupStore::Level)(_backfillLevel - 1)) : 3600);
+}
+
+void HourlyHistory::loopPacked() {
+    uint32_t step = (_backfillLevel > 0) ? 1 : 3600;
+
+    // Bound the slot reads per pass; a full packet waits for the queue to drain
+    uint8_t scanned = 0;
+    while (_backfillNext && scanned++ < 48) {
+        uint32_t epoch;
+        int32_t values[HistoryPack::NUM_FIELDS];
+        bool found = readPacked(_backfillNext, epoch, values);
+        _backfillNext = (_backfillNext >= _backfillEnd) ? 0 : _backfillNext + step;
+        if (found && !_pack.add(epoch, values)) {
+            publishPacked();
+            _pack.add(epoch, values);
+            break;
+        }
+    }
+
+    if (!_backfillNext) {
+        if (_pack.records()) {
+            publishPacked();
+        }
+        Log.info("History: backfill complete");
+    }
+}
@@ -0,0 +1,140 @@
+/**
+ * @file HourlyHistory.h
+ * @brief On-flash ring of hourly report records with cloud backfill.
+ *
+ * @details Every hourly report is also written as a 12-byte record to a
+ *          fixed-size file. A record lives in slot (hour % CAPACITY), so
+ *          the file needs no head/tail pointers and a torn write can only
+ *          damage the one slot being written. CAPACITY covers 16 days.
+ *
+ *          The "backfill" cloud function takes "startEpoch,endEpoch" (or a
+ *          single number of recent hours). The stored records in that range
+ *          are then republished as compact "history" events, a chunk at a
+ *          time and only while the publish queue is otherwise empty, so a
+ *          lost hour can be recovered without keeping a backlog of publish
+ *          events queued on the device.
+ *
+ *          An optional third field, "startEpoch,endEpoch,resolutionSec",
+ *          asks for coarser history: the coarsest of hours, RollupStore days
+ *          and RollupStore weeks no longer than the resolution, or a coarser
+ *          one if that level no longer reaches back to startEpoch. Days and
+ *          weeks are published as "d" and "w" arrays instead of "h".
+ *
+ *          With HISTORY_PACKED_BACKFILL the records are instead packed by
+ *          HistoryPack as {"p":"<base64>"}, as many as fit one event.
+ */
+
+#ifndef __HOURLYHISTORY_H
+#define __HOURLYHISTORY_H
+
+#include "Particle.h"
+#include "HistoryPack.h"
+
+/**
+ * This class is a singleton; you do not create one as a global, on the stack, or with new.
+ *
+ * From global application setup you must call:
+ * HourlyHistory::instance().setup();
+ *
+ * From global application loop you must call:
+ * HourlyHistory::instance().loop();
+ */
+class HourlyHistory {
+public:
+    /** @brief Number of hourly slots in the ring (16 days). */
+    static constexpr uint16_t CAPACITY = 384;
+
+    /** @brief Records per "history" event. */
+    static constexpr uint8_t RECORDS_PER_EVENT = 12;
+
+    /** @brief One stored hour. */
+    struct Record {
+        uint32_t hourEpoch;        ///< Start of the hour (UTC epoch, multiple of 3600)
+        uint16_t count;            ///< Events counted in the hour (saturates)
+        uint16_t occupiedSec;      ///< Seconds occupied in the hour (0..3600)
+        uint8_t  soc;              ///< Battery state of charge, percent
+        int8_t   tempC;            ///< Enclosure temperature, whole degrees C
+        int8_t   alert;            ///< Alert code at report time
+        uint8_t  check;            ///< Checksum of the other 11 bytes
+    };
+    static_assert(sizeof(Record) == 12, "HourlyHistory::Record must stay 12 bytes");
+
+    /**
+     * @brief Gets the singleton instance of this class, allocating it if necessary
+     */
+    static HourlyHistory &instance();
+
+    /**
+     * @brief Register the backfill cloud function
+     */
+    void setup();
+
+    /**
+     * @brief Publish the next backfill chunk when the queue is idle
+     */
+    void loop();
+
+    /**
+     * @brief Add the report to the record for the hour containing @p hourEpoch
+     *
+     * Called from publishData() after every report, sent or suppressed. The
+     * counts and occupied seconds the daily totals gained since the previous
+     * call (baselines kept in current.dat) are added to the hour's slot, so
+     * reports more often than hourly and resets between them keep the hour
+     * whole; battery, temperature and alert are the latest.
+     */
+    void record(time_t hourEpoch, uint32_t dailyCount, uint32_t totalOccupiedSec, uint16_t socTenths, int16_t tempCenti, int8_t alert);
+
+    /**
+     * @brief Read the record for one hour
+     * @return false if that slot is empty or holds a different hour
+     */
+    bool read(time_t hourEpoch, Record &rec);
+
+    /**
+     * @brief Queue a backfill of [startEpoch, endEpoch] at no finer than @p resolutionSec
+     * @return Number of hours, days or weeks that will be scanned, or -1 if the range is invalid
+     */
+    int requestBackfill(time_t startEpoch, time_t endEpoch, uint32_t resolutionSec = 3600);
+
+    /** @brief true while a backfill is still being published. */
+    bool backfillPending() const { return _backfillNext != 0; }
+
+protected:
+    HourlyHistory();
+    virtual ~HourlyHistory();
+    HourlyHistory(const HourlyHistory&) = delete;
+    HourlyHistory& operator=(const HourlyHistory&) = delete;
+
+    /**
+     * @brief Particle.function handler: "startEpoch,endEpoch[,resolutionSec]" or "hours"
+     */
+    int backfillFunction(String command);
+
+    /**
+     * @brief Pack the next records of the backfill, publishing each full packet
+     */
+    void loopPacked();
+
+    /**
+     * @brief Read the backfill's hour or period @p index as packed fields
+     * @return false if it is not stored
+     */
+    bool readPacked(uint32_t index, uint32_t &epoch, int32_t values[HistoryPack::NUM_FIELDS]);
+
+    /**
+     * @brief Publish the packet and start the next one
+     */
+    void publishPacked();
+
+    static uint8_t checksum(const Record &rec);
+
+    uint32_t _backfillNext = 0;        // Next hour or period number to publish (0 = idle)
+    uint32_t _backfillEnd = 0;         // Last hour or period number to publish
+    uint8_t _backfillLevel = 0;        // 0 = hours, else RollupStore level + 1
+    HistoryPack::Encoder _pack;        // Packet being filled (HISTORY_PACKED_BACKFILL)
+
+    static HourlyHistory *_instance;
+};
+
+#endif /* __HOURLYHISTORY_H */
@@ -0,0 +1,43 @@
+// src/ISensor.cpp
+#include "ISensor.h"
+#include "SensorFactory.h"  // getSensorTypeName() for serialization
+#include "Payload.h"
+#include "TinyClassifier.h"
+
+bool SensorData::toJSON(char* buffer, size_t bufferSize) const {
+    if (!buffer || bufferSize < 100) return false;
+    
+    Payload::Writer writer(buffer, bufferSize);
+    writer.beginObject();
+    
+    writer.add("sensorType", SensorFactory::getSensorTypeName(type));  // Name resolved here only
+    writer.add("timestamp", (long)timestamp);
+    
+    // Only include non-default values to save bandwidth
+    if (primary > 0) {
+        writer.add("primary", (unsigned)primary);
+    }
+    if (secondary > 0) {
+        writer.add("secondary", (unsigned)secondary);
+    }
+    if (aux1 > 0) {
+        writer.add("aux1", (unsigned)aux1);
+    }
+    if (aux2 > 0) {
+        writer.add("aux2", (unsigned)aux2);
+    }
+    if (flag1) {
+        writer.add("flag1", flag1);
+    }
+    if (flag2) {
+        writer.add("flag2", flag2);
+    }
+    if (classBits) {
+        writer.add("class", TinyClassifier::labelName(
+            (TinyClassifier::Label)((classBits >> SensorEvent::CLASS_SHIFT) - 1)));
+    }
+
+    writer.endObject();
+    
+    return writer.ok();
+}
@@ -3,14 +3,14 @@
 #define ISENSOR_H
 
 #include "Particle.h"
+#include "SensorType.h"
 
 /**
  * @brief Generic sensor data structure.
  *
  * This structure is intentionally generic so different sensor types
  * (PIR, ultrasonic, gesture, etc.) can share the same layout. The
- * meaning of each numeric/boolean field is defined by the @ref sensorType
- * string.
+ * meaning of each numeric/boolean field is defined by the @ref type.
  *
  * Examples:
  *   - PIR: hasNewData=true when motion edge detected; primary/secondary unused.
@@ -24,8 +24,8 @@ struct SensorData {
     /** When the data was captured (Unix time). */
     time_t timestamp;
 
-    /** Type of sensor ("PIR", "Ultrasonic", etc.). */
-    char sensorType[16];
+    /** Type of sensor; the display name is resolved only in toJSON(). */
+    SensorType type;
 
     /** Flag indicating if this record contains new data. */
     bool hasNewData;
@@ -48,14 +48,15 @@ struct SensorData {
     /** Spare boolean flag for future use. */
     bool flag2;
 
+    /** Classifier label in SensorEvent::CLASS_MASK position (0 = none). */
+    uint8_t classBits;
+
     /**
      * @brief Construct a new SensorData with default values.
      */
-    SensorData() : timestamp(0), hasNewData(false),
+    SensorData() : timestamp(0), type(SensorType::UNKNOWN), hasNewData(false),
                    primary(0), secondary(0), aux1(0), aux2(0),
-                   flag1(false), flag2(false) {
-        sensorType[0] = '\0';
-    }
+                   flag1(false), flag2(false), classBits(0) {}
     
     /**
      * @brief Convert sensor data to JSON string for publishing
@@ -66,6 +67,119 @@ struct SensorData {
     bool toJSON(char* buffer, size_t bufferSize) const;
 };
 
+/**
+ * @brief Packed per-event record returned by ISensor::drain().
+ *
+ * One entry per sensor event, sized so a RAM batch of events stays
+ * small (12 bytes each). Only the millis() capture time is stored;
+ * unixTime() derives wall-clock time when it's actually needed, and the
+ * sensor name is resolved from @ref type only at serialization time.
+ */
+struct SensorEvent {
+    /** Capture time on the millis() clock. */
+    uint32_t tickMs;
+
+    /** Which sensor produced the event. */
+    SensorType type;
+
+    /**
+     * Sensor-specific flag bits in the low five (0 for simple edge
+     * sensors); SensorManager puts the sensor slot in the top three.
+     */
+    uint8_t flags;
+
+    /** Sensor-specific value (0 for simple edge sensors like PIR). */
+    uint16_t primary;
+
+    /** Sensor-specific secondary value. */
+    uint16_t secondary;
+
+    /** Measured pulse width in ms, or 0 if the sensor can't measure it. */
+    uint16_t pulseMs;
+
+    SensorEvent() : tickMs(0), type(SensorType::UNKNOWN), flags(0),
+                    primary(0), secondary(0), pulseMs(0) {}
+
+    /**
+     * Direction of a crossing, in @ref flags, from a two-channel sensor
+     * (DUAL_PIR); an edge with no partner has neither.
+     */
+    static constexpr uint8_t DIR_IN = 0x01;
+    static constexpr uint8_t DIR_OUT = 0x02;
+
+    /**
+     * TinyClassifier label + 1 in @ref flags (0 = not labelled), from the
+     * accelerometer, vibration and OpenMV sensors with CLASSIFIER_ENABLED.
+     */
+    static constexpr uint8_t CLASS_SHIFT = 2;
+    static constexpr uint8_t CLASS_MASK = 0x1c;
+
+    /** Bits of @ref flags that hold the sensor slot. */
+    static constexpr uint8_t SOURCE_SHIFT = 5;
+    static constexpr uint8_t SOURCE_MASK = 0xe0;
+
+    /**
+     * @brief SensorManager slot of the sensor that produced the event:
+     *        0 for the primary sensor, 1 + index for an aux sensor.
+     */
+    uint8_t source() const { return flags >> SOURCE_SHIFT; }
+
+    void setSource(uint8_t slot) {
+        flags = (uint8_t)((flags & ~SOURCE_MASK) | (slot << SOURCE_SHIFT));
+    }
+
+    /**
+     * @brief Wall-clock capture time, back-dated from tickMs.
+     *
+     * Valid while the event is younger than the millis() wrap (~49 days),
+     * which holds for anything still sitting in a RAM batch.
+     */
+    time_t unixTime() const {
+        return Time.now() - (time_t)((uint32_t)(millis() - tickMs) / 1000UL);
+    }
+};
+
+static_assert(sizeof(SensorEvent) == 12, "SensorEvent must stay a 12-byte packed record");
+
+/**
+ * @brief What can wake the device for a sensor during a nap.
+ *
+ * A sensor that waits for events between polls declares the pin and edge
+ * its ISR listens on (or, on nRF52, a pin and threshold for the low-power
+ * comparator); SensorManager adds it to each nap's SystemSleepConfiguration.
+ * A polled sensor declares none and leaves the nap to the timer, which
+ * lets the planner consider deeper modes.
+ */
+struct WakeSource {
+    enum Kind : uint8_t { NONE, GPIO, ANALOG };
+
+    Kind kind;
+    pin_t pin;
+    InterruptMode edge;                 ///< GPIO
+    uint16_t thresholdMv;               ///< ANALOG
+    AnalogInterruptMode crossing;       ///< ANALOG
+
+    WakeSource() : kind(NONE), pin(PIN_INVALID), edge(RISING),
+                   thresholdMv(0), crossing(AnalogInterruptMode::ABOVE) {}
+
+    static WakeSource gpio(pin_t pin, InterruptMode edge) {
+        WakeSource source;
+        source.kind = GPIO;
+        source.pin = pin;
+        source.edge = edge;
+        return source;
+    }
+
+    static WakeSource analog(pin_t pin, uint16_t thresholdMv, AnalogInterruptMode crossing) {
+        WakeSource source;
+        source.kind = ANALOG;
+        source.pin = pin;
+        source.thresholdMv = thresholdMv;
+        source.crossing = crossing;
+        return source;
+    }
+};
+
 /**
  * @brief Abstract interface for all sensors
  * 
@@ -90,9 +204,9 @@ public:
     
     /**
      * @brief Get the latest sensor data
-     * @return SensorData structure with current readings
+     * @return Reference to the sensor's current readings (no copy)
      */
-    virtual SensorData getData() const = 0;
+    virtual const SensorData& getData() const = 0;
     
     /**
      * @brief Get sensor type identifier
@@ -111,6 +225,33 @@ public:
      */
     virtual void reset() = 0;
 
+    /**
+     * @brief Drain up to @p max pending events in one call.
+     *
+     * Lets callers consume a whole burst per main-loop pass instead of
+     * one event per pass. The default implementation simply calls
+     * loop()/getData() repeatedly; sensors that buffer events
+     * internally should override it.
+     *
+     * @param out Array of at least @p max entries
+     * @param max Capacity of @p out
+     * @return Number of events written to @p out
+     */
+    virtual size_t drain(SensorEvent* out, size_t max) {
+        size_t n = 0;
+        while (n < max && loop()) {
+            const SensorData& data = getData();
+            out[n] = SensorEvent();
+            out[n].tickMs = millis();
+            out[n].type = data.type;
+            out[n].flags = (data.flag1 ? 0x01 : 0) | (data.flag2 ? 0x02 : 0) | data.classBits;
+            out[n].primary = data.primary;
+            out[n].secondary = data.secondary;
+            n++;
+        }
+        return n;
+    }
+
     /**
      * @brief Initialize underlying hardware after power-on.
      *
@@ -133,11 +274,109 @@ public:
      */
     virtual bool onWake() { return true; }
 
+    /**
+     * @brief Called just before an ULTRA_LOW_POWER nap that this sensor
+     *        may wake from.
+     *
+     * Sensors that can inject a wake event snapshot their ISR state here.
+     */
+    virtual void armWakeCapture() {}
+
+    /**
+     * @brief Called after this sensor's pin woke the device.
+     *
+     * If the ISR did not record the wake edge (it can be lost across
+     * ULTRA_LOW_POWER on some platforms), push one into the sensor's own
+     * event queue so it flows through drain() and the filter like any
+     * other event.
+     *
+     * @return true if an event was injected, false if the ISR already had it
+     */
+    virtual bool injectWakeEvent() { return false; }
+
+    /**
+     * @brief Push one edge into the sensor's event queue, as its ISR would.
+     *
+     * Used by TraceReplay to drive the pipeline from a recorded trace.
+     *
+     * @return false if this sensor has no edge queue
+     */
+    virtual bool injectEdge() { return false; }
+
+    /**
+     * @brief Detach the interrupt for a nap so a hardware edge counter can
+     *        use the pin; the sensor stays powered.
+     *
+     * @return false if this sensor has no interrupt pin to lend (or it is
+     *         storming); the nap then uses the normal pin wake
+     */
+    virtual bool releaseInterruptPin() { return false; }
+
+    /**
+     * @brief Re-attach the interrupt after releaseInterruptPin().
+     */
+    virtual void reclaimInterruptPin() {}
+
+    /**
+     * @brief true to count this sensor's edges in hardware on every nap,
+     *        not only in busy hours (EDGE_COUNT_IN_SLEEP).
+     *
+     * For sensors whose events come in dense bursts that need no work per
+     * event, such as a rain gauge in a storm.
+     */
+    virtual bool countsEdgesInSleep() const { return false; }
+
+    /**
+     * @brief Edges counted in hardware during a nap of @p seconds from
+     *        @p start, after they have been added to the counters.
+     */
+    virtual void noteSleepEdges(uint32_t edges, time_t start, uint32_t seconds) {
+        (void)edges;
+        (void)start;
+        (void)seconds;
+    }
+
+    /**
+     * @brief true while the sensor needs the device awake to finish an
+     *        event it has started (e.g. a vehicle still over a
+     *        magnetometer); the next nap is deferred until it clears.
+     */
+    virtual bool isBusy() const { return false; }
+
+    /**
+     * @brief People estimated from event timing since the last call
+     *        (PIR_GROUP_ESTIMATE); 0 for a sensor that does not estimate.
+     *
+     * Kept apart from the event count, which stays one per edge.
+     */
+    virtual uint16_t takePeople() { return 0; }
+
     /**
      * @brief Whether this sensor uses a hardware interrupt for events.
      */
     virtual bool usesInterrupt() const { return false; }
 
+    /**
+     * @brief The pin, edge or comparator that should wake a nap for this
+     *        sensor; none (the default) for a polled sensor.
+     */
+    virtual WakeSource wakeSource() const { return WakeSource(); }
+
+    /**
+     * @brief A second pin that should also wake a nap, for a sensor with
+     *        two input lines; none (the default) for everything else.
+     */
+    virtual WakeSource secondWakeSource() const { return WakeSource(); }
+
+    /**
+     * @brief Milliseconds after power-up (setup, or onWake() after
+     *        onSleep()) during which this sensor's output is not trusted.
+     *
+     * SensorManager discards its events and leaves it out of the nap wake
+     * sources until the time has passed. 0 (the default) for none.
+     */
+    virtual uint32_t warmupMs() const { return 0; }
+
     /**
      * @brief Health check for the sensor.
      *
@@ -152,39 +391,4 @@ public:
     virtual int lastErrorCode() const { return 0; }
 };
 
-// Implementation of SensorData::toJSON
-inline bool SensorData::toJSON(char* buffer, size_t bufferSize) const {
-    if (!buffer || bufferSize < 100) return false;
-    
-    JSONBufferWriter writer(buffer, bufferSize);
-    writer.beginObject();
-    
-    writer.name("sensorType").value(sensorType);  // Already char*, no .c_str() needed
-    writer.name("timestamp").value((int)timestamp);
-    
-    // Only include non-default values to save bandwidth
-    if (primary > 0) {
-        writer.name("primary").value(primary);
-    }
-    if (secondary > 0) {
-        writer.name("secondary").value(secondary);
-    }
-    if (aux1 > 0) {
-        writer.name("aux1").value(aux1);
-    }
-    if (aux2 > 0) {
-        writer.name("aux2").value(aux2);
-    }
-    if (flag1) {
-        writer.name("flag1").value(flag1);
-    }
-    if (flag2) {
-        writer.name("flag2").value(flag2);
-    }
-
-    writer.endObject();
-    
-    return writer.dataSize() > 0;
-}
-
 #endif /* ISENSOR_H */
\ No newline at end of file
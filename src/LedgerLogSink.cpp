@@ -0,0 +1,139 @@
+#include "LedgerLogSink.h"
+#include "Config.h"
+#include <algorithm>
+
+static const size_t RING_BYTES = LEDGER_LOG_BYTES;
+
+LedgerLogSink *LedgerLogSink::_instance;
+
+// [static]
+LedgerLogSink &LedgerLogSink::instance() {
+    if (!_instance) {
+        _instance = new LedgerLogSink();
+    }
+    return *_instance;
+}
+
+LedgerLogSink::LedgerLogSink() {
+    os_mutex_recursive_create(&mutex);
+    ring = new char[RING_BYTES];
+}
+
+size_t LedgerLogSink::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t LedgerLogSink::write(const uint8_t *buffer, size_t size) {
+    if (!ring) {
+        return size;
+    }
+    os_mutex_recursive_lock(mutex);
+    for (size_t ii = 0; ii < size; ii++) {
+        char c = (char)buffer[ii];
+        if (c == '\r') {
+            continue;       // Lines end in CRLF; '\n' separates them here
+        }
+        if (atLineStart) {
+            startLine();
+            atLineStart = false;
+        }
+        if (c == '\n') {
+            atLineStart = true;
+        }
+        if (skipping) {
+            continue;
+        }
+        while (count == RING_BYTES) {
+            dropOldestLine();
+        }
+        ring[(head + count) % RING_BYTES] = c;
+        count++;
+        dayBytes++;
+    }
+    os_mutex_recursive_unlock(mutex);
+    return size;
+}
+
+void LedgerLogSink::startLine() {
+    uint32_t today = Time.isValid() ? (uint32_t)(Time.now() / 86400) : day;
+    if (today != day) {
+        day = today;
+        dayBytes = 0;
+    }
+    skipping = dayBytes >= LEDGER_LOG_DAY_BYTES;
+    if (skipping) {
+        overBudget++;
+    }
+}
+
+void LedgerLogSink::dropOldestLine() {
+    while (count > 0) {
+        char c = ring[head];
+        head = (head + 1) % RING_BYTES;
+        count--;
+        headSeq++;
+        if (c == '\n') {
+            break;
+        }
+    }
+    dropped++;
+}
+
+bool LedgerLogSink::snapshot(LedgerData &data, uint32_t &endSeq) {
+    static char copy[RING_BYTES];
+
+    // Whole lines only; the one being written waits for the next flush
+    os_mutex_recursive_lock(mutex);
+    size_t len = 0;
+    for (size_t ii = 0; ii < count; ii++) {
+        copy[ii] = ring[(head + ii) % RING_BYTES];
+        if (copy[ii] == '\n') {
+            len = ii + 1;
+        }
+    }
+    endSeq = headSeq + len;
+    sentDropped = dropped;
+    sentOverBudget = overBudget;
+    uint32_t bytesToday = dayBytes;
+    os_mutex_recursive_unlock(mutex);
+
+    if (len == 0 && sentDropped == 0 && sentOverBudget == 0) {
+        return false;
+    }
+    VariantArray lines;
+    size_t start = 0;
+    for (size_t ii = 0; ii < len; ii++) {
+        if (copy[ii] == '\n') {
+            lines.append(Variant(String(&copy[start], ii - start)));
+            start = ii + 1;
+        }
+    }
+    data.set("lines", Variant(lines));
+    data.set("dropped", Variant((unsigned long)sentDropped));
+    data.set("overBudget", Variant((unsigned long)sentOverBudget));
+    data.set("dayBytes", Variant((unsigned long)bytesToday));
+    return true;
+}
+
+void LedgerLogSink::consumed(uint32_t endSeq) {
+    os_mutex_recursive_lock(mutex);
+    // Lines dropped for room since the snapshot have already gone
+    int32_t sent = (int32_t)(endSeq - headSeq);
+    size_t remove = sent > 0 ? std::min((size_t)sent, count) : 0;
+    head = (head + remove) % RING_BYTES;
+    count -= remove;
+    headSeq += remove;
+    dropped -= sentDropped;
+    overBudget -= sentOverBudget;
+    sentDropped = sentOverBudget = 0;
+    os_mutex_recursive_unlock(mutex);
+}
+
+LedgerLogHandler::LedgerLogHandler(LogLevel level, LogCategoryFilters filters) :
+        StreamLogHandler(LedgerLogSink::instance(), level, filters) {
+    LogManager::instance()->addHandler(this);
+}
+
+LedgerLogHandler::~LedgerLogHandler() {
+    LogManager::instance()->removeHandler(this);
+}
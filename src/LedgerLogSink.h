@@ -0,0 +1,101 @@
+/**
+ * @file LedgerLogSink.h
+ * @brief Warning and error log lines kept for the device-log ledger, sent
+ *        only with the other device-written ledgers.
+ *
+ * @details Log lines at LEDGER_LOG_LEVEL or above go into a RAM ring of
+ *          LEDGER_LOG_BYTES. Cloud::flushLedgers() writes whatever the ring
+ *          holds to the device-log ledger in the same pass as device-data
+ *          and device-status, so the log adds no connection and no write
+ *          of its own, and a device that never flushes never sends it. Lines sent are
+ *          removed from the ring.
+ *
+ *          At most LEDGER_LOG_DAY_BYTES of lines are kept per UTC day;
+ *          the rest are dropped whole and counted. A full ring drops its
+ *          oldest lines, also counted. The ledger carries both counts:
+ *
+ *              {"lines":["0000123456 [app] WARN: ...", ...],
+ *               "dropped":3,"overBudget":12,"dayBytes":8190}
+ *
+ *          The DeviceInfoLedger library's log handler writes its own
+ *          ledger on its own schedule, so it is not used.
+ *
+ *          LedgerLogHandler is StreamLogHandler with this as its stream.
+ *          The log manager serializes handler calls; the flush runs on the
+ *          application thread, so the ring has its own mutex.
+ */
+
+#ifndef __LEDGERLOGSINK_H
+#define __LEDGERLOGSINK_H
+
+#include "Particle.h"
+
+/**
+ * This class is a singleton; you do not create one as a global, on the stack, or with new.
+ */
+class LedgerLogSink : public Print {
+public:
+    /**
+     * @brief Gets the singleton instance of this class, allocating it if necessary
+     */
+    static LedgerLogSink &instance();
+
+    virtual size_t write(uint8_t c);
+    virtual size_t write(const uint8_t *buffer, size_t size);
+
+    /**
+     * @brief Fill @p data with the lines held and the drop counts
+     *
+     * @param endSeq Set to pass to consumed() once the write worked
+     * @return false if there is nothing new to send
+     */
+    bool snapshot(LedgerData &data, uint32_t &endSeq);
+
+    /**
+     * @brief The lines up to @p endSeq were written; drop them from the ring
+     */
+    void consumed(uint32_t endSeq);
+
+protected:
+    LedgerLogSink();
+    virtual ~LedgerLogSink() {};
+    LedgerLogSink(const LedgerLogSink&) = delete;
+    LedgerLogSink& operator=(const LedgerLogSink&) = delete;
+
+    /**
+     * @brief A line is starting: decide whether it fits today's budget; call with the mutex held
+     */
+    void startLine();
+
+    /**
+     * @brief Drop the oldest line to make room; call with the mutex held
+     */
+    void dropOldestLine();
+
+    os_mutex_recursive_t mutex;
+    char *ring;
+    size_t head = 0;            ///< Oldest byte
+    size_t count = 0;           ///< Bytes held
+    uint32_t headSeq = 0;       ///< Bytes ever removed from the ring, so snapshot() and consumed() agree
+    bool atLineStart = true;
+    bool skipping = false;      ///< The current line is over budget
+    uint32_t day = 0;           ///< UTC day dayBytes is for
+    uint32_t dayBytes = 0;
+    uint32_t dropped = 0;       ///< Lines lost to a full ring, since the last write
+    uint32_t overBudget = 0;    ///< Lines over LEDGER_LOG_DAY_BYTES, since the last write
+    uint32_t sentDropped = 0;   ///< dropped and overBudget as of the snapshot
+    uint32_t sentOverBudget = 0;
+
+    static LedgerLogSink *_instance;
+};
+
+/**
+ * @brief StreamLogHandler writing into LedgerLogSink
+ */
+class LedgerLogHandler : public StreamLogHandler {
+public:
+    explicit LedgerLogHandler(LogLevel level, LogCategoryFilters filters = {});
+    virtual ~LedgerLogHandler();
+};
+
+#endif /* __LEDGERLOGSINK_H */
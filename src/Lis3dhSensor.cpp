@@ -0,0 +1,248 @@
+// src/Lis3dhSensor.cpp
+#include "Lis3dhSensor.h"
+#include "PowerDomains.h"
+
+// LIS3DH registers and values used here
+namespace {
+const uint8_t REG_WHO_AM_I = 0x0F;
+const uint8_t REG_CTRL_REG1 = 0x20;
+const uint8_t REG_CTRL_REG2 = 0x21;
+const uint8_t REG_CTRL_REG3 = 0x22;
+const uint8_t REG_CTRL_REG4 = 0x23;
+const uint8_t REG_CTRL_REG5 = 0x24;
+const uint8_t REG_REFERENCE = 0x26;
+const uint8_t REG_OUT_X_L = 0x28;
+const uint8_t REG_FIFO_CTRL = 0x2E;
+const uint8_t REG_FIFO_SRC = 0x2F;
+const uint8_t REG_INT1_CFG = 0x30;
+const uint8_t REG_INT1_SRC = 0x31;
+const uint8_t REG_INT1_THS = 0x32;
+const uint8_t REG_INT1_DURATION = 0x33;
+
+const uint8_t WHO_AM_I_LIS3DH = 0x33;
+const uint8_t AUTO_INCREMENT = 0x80;        // MSB of the sub-address
+
+const uint8_t CTRL1_XYZ_EN = 0x07;
+const uint8_t CTRL2_FDS_HP_IA1 = 0x09;      // High-pass to the FIFO and to INT1
+const uint8_t CTRL3_I1_IA1 = 0x40;          // Motion interrupt on INT1
+const uint8_t CTRL4_BDU = 0x80;             // ±2 g, normal (10-bit) mode
+const uint8_t CTRL5_FIFO_EN_LIR_INT1 = 0x48;
+const uint8_t FIFO_BYPASS = 0x00;
+const uint8_t FIFO_STREAM = 0x80;
+const uint8_t INT1_OR_HIGH_XYZ = 0x2A;
+
+const uint8_t FIFO_SRC_OVRN = 0x40;
+const uint8_t FIFO_SRC_EMPTY = 0x20;
+const uint8_t FIFO_SRC_FSS = 0x1F;
+
+const int16_t MG_PER_DIGIT = 4;             // ±2 g, 10-bit
+const uint16_t THS_MG_PER_LSB = 16;         // INT1_THS at ±2 g
+
+uint8_t odrCode(int hz) {
+    return hz == 10 ? 0x2 : hz == 25 ? 0x3 : hz == 50 ? 0x4 : 0x5;
+}
+} // namespace
+
+#if SENSOR_DRIVER_ACCEL_PRESENCE || SENSOR_DRIVER_VIBRATION
+// Wire's buffers, in place of the 32-byte defaults, so a full FIFO is one
+// requestFrom(). Only small register writes go out.
+static uint8_t wireRxBuffer[Lis3dhSensor::FIFO_DEPTH * Lis3dhSensor::SAMPLE_SIZE];
+static uint8_t wireTxBuffer[32];
+
+hal_i2c_config_t acquireWireBuffer() {
+    hal_i2c_config_t config = {};
+    config.size = sizeof(hal_i2c_config_t);
+    config.version = HAL_I2C_CONFIG_VERSION_1;
+    config.rx_buffer = wireRxBuffer;
+    config.rx_buffer_size = sizeof(wireRxBuffer);
+    config.tx_buffer = wireTxBuffer;
+    config.tx_buffer_size = sizeof(wireTxBuffer);
+    return config;
+}
+#endif
+
+volatile bool Lis3dhSensor::_irqPending = false;
+volatile uint32_t Lis3dhSensor::_irqMs = 0;
+
+// INT1 is latched in the part; the FIFO is read over I2C in loop(), not here.
+void Lis3dhSensor::int1ISR() {
+    _irqMs = millis();
+    _irqPending = true;
+}
+
+int16_t Lis3dhSensor::sampleMg(const uint8_t* sample, int axis) {
+    int16_t raw = (int16_t)(sample[2 * axis] | (sample[2 * axis + 1] << 8)) >> 6;
+    return (int16_t)(raw * MG_PER_DIGIT);
+}
+
+bool Lis3dhSensor::setup() {
+    PowerDomains::acquire(PowerDomains::SENSOR, this);
+    pinMode(intPin, INPUT_PULLDOWN);
+    if (!Wire.isEnabled()) {
+        Wire.begin();
+    }
+    delay(5);                           // Boot time after power-up
+
+    reset();
+    uint8_t whoAmI = 0;
+    if (!i2cRead(ACCEL_I2C_ADDR, REG_WHO_AM_I, &whoAmI, 1) || whoAmI != WHO_AM_I_LIS3DH) {
+        Log.error("LIS3DH not found at 0x%02x (WHO_AM_I 0x%02x)", ACCEL_I2C_ADDR, whoAmI);
+        _lastErrorCode = ERROR_NOT_FOUND;
+        _isReady = false;
+        return false;
+    }
+    if (!configure()) {
+        Log.error("LIS3DH configuration failed");
+        _isReady = false;
+        return false;
+    }
+
+    attachInterrupt(intPin, int1ISR, RISING);
+    _isReady = true;
+    Log.info("LIS3DH ready for %s (%d Hz, wake above %u mg for %u samples)",
+             getSensorType(), _odrHz, _thresholdMg, _duration);
+    return true;
+}
+
+bool Lis3dhSensor::configure() {
+    uint8_t scratch;
+    bool ok = i2cWrite(ACCEL_I2C_ADDR, REG_CTRL_REG1, (uint8_t)((odrCode(_odrHz) << 4) | CTRL1_XYZ_EN)) &&
+              i2cWrite(ACCEL_I2C_ADDR, REG_CTRL_REG2, CTRL2_FDS_HP_IA1) &&
+              i2cWrite(ACCEL_I2C_ADDR, REG_CTRL_REG3, CTRL3_I1_IA1) &&
+              i2cWrite(ACCEL_I2C_ADDR, REG_CTRL_REG4, CTRL4_BDU) &&
+              i2cWrite(ACCEL_I2C_ADDR, REG_CTRL_REG5, CTRL5_FIFO_EN_LIR_INT1) &&
+              i2cWrite(ACCEL_I2C_ADDR, REG_INT1_THS, (uint8_t)(_thresholdMg / THS_MG_PER_LSB)) &&
+              i2cWrite(ACCEL_I2C_ADDR, REG_INT1_DURATION, _duration) &&
+              i2cWrite(ACCEL_I2C_ADDR, REG_FIFO_CTRL, FIFO_BYPASS) &&       // Empties the FIFO
+              i2cWrite(ACCEL_I2C_ADDR, REG_FIFO_CTRL, FIFO_STREAM) &&
+              i2cRead(ACCEL_I2C_ADDR, REG_REFERENCE, &scratch, 1) &&        // Loads the high-pass reference
+              i2cWrite(ACCEL_I2C_ADDR, REG_INT1_CFG, INT1_OR_HIGH_XYZ) &&
+              i2cRead(ACCEL_I2C_ADDR, REG_INT1_SRC, &scratch, 1);           // Clears a stale latch
+    _lastErrorCode = ok ? 0 : ERROR_I2C;
+    return ok;
+}
+
+bool Lis3dhSensor::loop() {
+    if (!_isReady) {
+        return false;
+    }
+    // The latched line also covers an edge the ISR missed across a nap
+    if (!_irqPending && digitalRead(intPin) == LOW) {
+        return false;
+    }
+    return service();
+}
+
+size_t Lis3dhSensor::drain(SensorEvent* out, size_t max) {
+    if (!out || max == 0 || !loop()) {
+        return 0;
+    }
+    out[0] = SensorEvent();
+    out[0].tickMs = _eventMs;
+    out[0].type = _type;
+    out[0].flags = (_data.flag1 ? 0x01 : 0) | (_data.flag2 ? 0x02 : 0) | _data.classBits;
+    out[0].primary = _data.primary;
+    out[0].secondary = _data.secondary;
+    return 1;
+}
+
+bool Lis3dhSensor::service() {
+    uint32_t eventMs = _irqPending ? _irqMs : millis();
+    _irqPending = false;
+
+    // Count first, then every sample in one burst, then release the latch
+    uint8_t fifoSrc = 0;
+    if (!i2cRead(ACCEL_I2C_ADDR, REG_FIFO_SRC, &fifoSrc, 1)) {
+        return false;
+    }
+    size_t samples = 0;
+    if (!(fifoSrc & FIFO_SRC_EMPTY)) {
+        samples = (fifoSrc & FIFO_SRC_FSS) + ((fifoSrc & FIFO_SRC_OVRN) ? 1 : 0);
+        if (samples > FIFO_DEPTH) {
+            samples = FIFO_DEPTH;
+        }
+    }
+
+    static uint8_t burst[FIFO_DEPTH * SAMPLE_SIZE];
+    uint8_t int1Src = 0;
+    bool ok = (samples == 0 ||
+               i2cRead(ACCEL_I2C_ADDR, REG_OUT_X_L | AUTO_INCREMENT, burst, samples * SAMPLE_SIZE)) &&
+              i2cRead(ACCEL_I2C_ADDR, REG_INT1_SRC, &int1Src, 1);
+    if (!ok) {
+        return false;
+    }
+    _lastErrorCode = 0;     // The part answered; clear a transient I2C error
+    if (samples == 0) {
+        return false;
+    }
+
+    if (!classify(burst, samples)) {
+        _rejected++;
+        return false;
+    }
+    _eventMs = eventMs;
+    _data.timestamp = Time.now();
+    _data.hasNewData = true;
+    return true;
+}
+
+bool Lis3dhSensor::i2cRead(uint8_t address, uint8_t subAddress, uint8_t* buffer, size_t length) {
+    Wire.lock();
+    Wire.beginTransmission(address);
+    Wire.write(subAddress);
+    if (Wire.endTransmission(false) != 0) {
+        Wire.unlock();
+        _lastErrorCode = ERROR_I2C;
+        return false;
+    }
+    size_t received = Wire.requestFrom((int)address, (int)length);
+    if (received < length || (size_t)Wire.available() < length) {
+        Wire.unlock();
+        _lastErrorCode = ERROR_I2C;
+        return false;
+    }
+    for (size_t ii = 0; ii < length; ii++) {
+        buffer[ii] = (uint8_t)Wire.read();
+    }
+    Wire.unlock();
+    return true;
+}
+
+bool Lis3dhSensor::i2cWrite(uint8_t address, uint8_t reg, uint8_t value) {
+    Wire.lock();
+    Wire.beginTransmission(address);
+    Wire.write(reg);
+    Wire.write(value);
+    bool ok = (Wire.endTransmission() == 0);
+    Wire.unlock();
+    if (!ok) {
+        _lastErrorCode = ERROR_I2C;
+    }
+    return ok;
+}
+
+void Lis3dhSensor::reset() {
+    _data = SensorData();
+    _data.type = _type;
+    _irqPending = false;
+}
+
+void Lis3dhSensor::onSleep() {
+    if (!_isReady) {
+        return;
+    }
+    detachInterrupt(intPin);
+    i2cWrite(ACCEL_I2C_ADDR, REG_CTRL_REG1, 0x00);     // Power-down mode
+    PowerDomains::release(PowerDomains::SENSOR, this);
+    _isReady = false;
+    Log.info("LIS3DH powered down for sleep");
+}
+
+bool Lis3dhSensor::onWake() {
+    // After a nap the part kept watching; its FIFO and latched interrupt
+    // hold the wake and must not be reset here
+    if (_isReady) {
+        return true;
+    }
+    return setup();
+}
@@ -0,0 +1,124 @@
+// src/Lis3dhSensor.h
+#ifndef LIS3DHSENSOR_H
+#define LIS3DHSENSOR_H
+
+#include "ISensor.h"
+#include "Config.h"
+#include "Particle.h"
+#include "device_pinout.h"
+
+/**
+ * @brief Shared LIS3DH accelerometer handling for drivers that classify
+ *        bursts of acceleration on the device.
+ *
+ * The part does the watching: it samples into its own 32-sample FIFO
+ * (stream mode) and raises INT1 on intPin when the high-passed
+ * acceleration on any axis crosses a threshold. INT1 is latched, so the
+ * nap wake on intPin works unchanged and an edge missed across
+ * ULTRA_LOW_POWER is still seen as a high line. The MCU touches the part
+ * only after an interrupt.
+ *
+ * Per interrupt, loop() reads the whole FIFO in one auto-increment burst
+ * (6 bytes per sample; Wire's buffers are enlarged for it), clears the
+ * latch and hands the burst to the subclass's classify(). The FIFO holds
+ * high-passed data (gravity removed), ±2 g, 10-bit; sampleMg() converts
+ * one axis of one sample.
+ *
+ * Subclasses provide instance(), getSensorType() and classify(). Only one
+ * is the primary sensor at a time, so the ISR state is shared.
+ */
+class Lis3dhSensor : public ISensor {
+public:
+    bool setup() override;
+    bool loop() override;
+    size_t drain(SensorEvent* out, size_t max) override;
+
+    const SensorData& getData() const override { return _data; }
+    bool isReady() const override { return _isReady; }
+    void reset() override;
+
+    bool usesInterrupt() const override { return true; }
+    WakeSource wakeSource() const override { return WakeSource::gpio(intPin, RISING); }
+    void onSleep() override;
+    bool onWake() override;
+
+    bool isHealthy() const override { return _lastErrorCode == 0; }
+    int lastErrorCode() const override { return _lastErrorCode; }
+
+    /** @brief Interrupts whose burst classify() turned down. */
+    uint32_t rejected() const { return _rejected; }
+
+    /** @brief LIS3DH FIFO depth in samples. */
+    static constexpr uint8_t FIFO_DEPTH = 32;
+
+    /** @brief Bytes per FIFO sample (X, Y, Z, 16 bits each). */
+    static constexpr size_t SAMPLE_SIZE = 6;
+
+    /** @brief Error code: no LIS3DH answered at ACCEL_I2C_ADDR. */
+    static constexpr int ERROR_NOT_FOUND = 1;
+    /** @brief Error code: an I2C transfer failed. */
+    static constexpr int ERROR_I2C = 2;
+
+protected:
+    /**
+     * @param type Reported in _data and every SensorEvent
+     * @param odrHz Sample rate: 10, 25, 50 or 100
+     * @param thresholdMg INT1 threshold, 16..2032 mg
+     * @param duration Samples above the threshold before INT1 rises
+     */
+    Lis3dhSensor(SensorType type, int odrHz, uint16_t thresholdMg, uint8_t duration)
+        : _type(type), _odrHz(odrHz), _thresholdMg(thresholdMg), _duration(duration) {
+        _data.type = type;
+    }
+    ~Lis3dhSensor() {}
+    Lis3dhSensor(const Lis3dhSensor&) = delete;
+    Lis3dhSensor& operator=(const Lis3dhSensor&) = delete;
+
+    /**
+     * @brief Decide whether a burst is an event and fill _data if so.
+     *
+     * _data.timestamp and hasNewData are set by the caller. SensorEvent
+     * takes primary, secondary and flag1/flag2 from _data.
+     *
+     * @param burst @p samples FIFO samples, SAMPLE_SIZE bytes each
+     * @return true for an event
+     */
+    virtual bool classify(const uint8_t* burst, size_t samples) = 0;
+
+    /** @brief Signed mg for @p axis (0 = X) of one FIFO sample. */
+    static int16_t sampleMg(const uint8_t* sample, int axis);
+
+    /** @brief Register read from any device on Wire; @p subAddress as sent. */
+    bool i2cRead(uint8_t address, uint8_t subAddress, uint8_t* buffer, size_t length);
+    bool i2cWrite(uint8_t address, uint8_t reg, uint8_t value);
+
+    int odrHz() const { return _odrHz; }
+
+    SensorData _data;
+    int _lastErrorCode = 0;
+
+private:
+    bool configure();
+
+    /**
+     * @brief Read the FIFO, clear the latch and classify the burst.
+     * @return true for an event, now in _data
+     */
+    bool service();
+
+    const SensorType _type;
+    const int _odrHz;
+    const uint16_t _thresholdMg;
+    const uint8_t _duration;
+
+    bool _isReady = false;
+    uint32_t _rejected = 0;
+    uint32_t _eventMs = 0;      // millis() of the interrupt behind _data
+
+    static volatile bool _irqPending;
+    static volatile uint32_t _irqMs;
+
+    static void int1ISR();
+};
+
+#endif /* LIS3DHSENSOR_H */
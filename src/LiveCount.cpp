@@ -0,0 +1,64 @@
+#include "LiveCount.h"
+#include "Config.h"
+#include "MyPersistentData.h"
+#include "Payload.h"
+#include "PowerGovernor.h"
+#include "ProjectConfig.h"
+#include "PublishQueuePosixRK.h"
+
+namespace LiveCount {
+
+static uint32_t pending = 0;            // Counts since the last update
+static uint32_t windowStartMs = 0;      // Start of the current window
+
+static bool active() {
+    return sysStatus.get_liveCountSec() != 0 && PowerGovernor::operatingMode() == CONNECTED;
+}
+
+static uint32_t windowMs() {
+    uint32_t windowSec = sysStatus.get_liveCountSec();
+    return (windowSec < LIVE_COUNT_MIN_SEC ? LIVE_COUNT_MIN_SEC : windowSec) * 1000UL;
+}
+
+void noteCounts(uint16_t count) {
+    if (!active() || !Particle.connected()) {
+        return;
+    }
+    if (pending == 0 && millis() - windowStartMs >= windowMs()) {
+        windowStartMs = millis();       // A quiet spell ends; the window starts with this count
+    }
+    pending += count;
+}
+
+bool loop() {
+    if (!active() || !Particle.connected()) {
+        pending = 0;
+        return true;
+    }
+    if (pending == 0 || millis() - windowStartMs < windowMs() ||
+        PublishQueuePosix::instance().getNumEvents() != 0) {
+        return true;
+    }
+
+    static const Payload::Field liveSchema[] = {
+        {"delta", Payload::UINT, 0},
+        {"hourly", Payload::INT, 0},
+        {"daily", Payload::INT, 0},
+        {"timestamp", Payload::UINT64, 0},
+    };
+    Payload::Value values[sizeof(liveSchema) / sizeof(liveSchema[0])];
+    values[0].u = pending;
+    values[1].i = current.get_hourlyCount();
+    values[2].i = current.get_dailyCount();
+    values[3].u64 = (uint64_t)Time.now() * 1000;
+
+    char data[96];
+    Payload::Writer(data, sizeof(data)).beginObject().writeFields(liveSchema, values, sizeof(values) / sizeof(values[0])).endObject();
+    if (PublishQueuePosix::instance().publish(ProjectConfig::liveCountEventName(), data, PRIVATE | NO_ACK)) {
+        pending = 0;
+        windowStartMs = millis();
+    }
+    return true;
+}
+
+} // namespace LiveCount
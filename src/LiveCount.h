@@ -0,0 +1,42 @@
+/**
+ * @file LiveCount.h
+ * @brief Near-real-time count updates for connected sites.
+ *
+ * @details In CONNECTED mode the hourly report is the only place counts
+ *          reach the cloud. With sysStatus liveCountSec set, counts are
+ *          summed over that window and, when there were any, sent as one
+ *          liveCountEventName() event: the delta since the last one plus
+ *          the hourly and daily totals, so a dashboard that misses one
+ *          still shows the right totals. There is never more than one event
+ *          per window (at least LIVE_COUNT_MIN_SEC), far inside the Device
+ *          OS publish limit.
+ *
+ *          Updates go through the publish queue without an ack, and only
+ *          when it is empty: a backlog, such as the hourly report, goes
+ *          first, and the delta keeps growing until there is room. Outside
+ *          CONNECTED mode, or offline, nothing is kept; the hourly report
+ *          carries the counts.
+ */
+
+#ifndef __LIVECOUNT_H
+#define __LIVECOUNT_H
+
+#include "Particle.h"
+
+namespace LiveCount {
+
+/**
+ * @brief Add @p count applied counts to the current window
+ */
+void noteCounts(uint16_t count);
+
+/**
+ * @brief Publish the window's delta when it is due (TaskScheduler task)
+ *
+ * @return true (TaskScheduler task)
+ */
+bool loop();
+
+} // namespace LiveCount
+
+#endif /* __LIVECOUNT_H */
@@ -0,0 +1,378 @@
+// src/LoRaGatewaySensor.cpp
+#include "LoRaGatewaySensor.h"
+#include "CompactReport.h"
+#include "MyPersistentData.h"
+#include "ProjectConfig.h"
+#include "PublishQueuePosixRK.h"
+
+// SX1276/77/78/79 registers and values used here (LoRa mode)
+namespace {
+const uint8_t REG_FIFO = 0x00;
+const uint8_t REG_OP_MODE = 0x01;
+const uint8_t REG_FRF_MSB = 0x06;
+const uint8_t REG_FRF_MID = 0x07;
+const uint8_t REG_FRF_LSB = 0x08;
+const uint8_t REG_LNA = 0x0C;
+const uint8_t REG_FIFO_ADDR_PTR = 0x0D;
+const uint8_t REG_FIFO_RX_BASE_ADDR = 0x0F;
+const uint8_t REG_FIFO_RX_CURRENT_ADDR = 0x10;
+const uint8_t REG_IRQ_FLAGS = 0x12;
+const uint8_t REG_RX_NB_BYTES = 0x13;
+const uint8_t REG_PKT_RSSI_VALUE = 0x1A;
+const uint8_t REG_MODEM_CONFIG_1 = 0x1D;
+const uint8_t REG_MODEM_CONFIG_2 = 0x1E;
+const uint8_t REG_MODEM_CONFIG_3 = 0x26;
+const uint8_t REG_SYNC_WORD = 0x39;
+const uint8_t REG_DIO_MAPPING_1 = 0x40;
+const uint8_t REG_VERSION = 0x42;
+
+const uint8_t MODE_LONG_RANGE = 0x80;
+const uint8_t MODE_SLEEP = 0x00;
+const uint8_t MODE_STDBY = 0x01;
+const uint8_t MODE_RX_CONTINUOUS = 0x05;
+
+const uint8_t IRQ_RX_DONE = 0x40;
+const uint8_t IRQ_PAYLOAD_CRC_ERROR = 0x20;
+
+const uint8_t CHIP_VERSION = 0x12;
+
+const SPISettings radioSPI(8 * MHZ, MSBFIRST, SPI_MODE0);
+
+void put16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+void put32(uint8_t *p, uint32_t v) {
+    put16(p, (uint16_t)v);
+    put16(p + 2, (uint16_t)(v >> 16));
+}
+
+uint16_t get16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+uint8_t addSaturated(uint8_t value, uint32_t more) {
+    uint32_t sum = value + more;
+    return (uint8_t)(sum > 255 ? 255 : sum);
+}
+} // namespace
+
+static_assert(LORA_MAX_NODES <= 255, "Node count is one byte in the uplink");
+static_assert(CompactReport::textSize(LoRaGatewaySensor::UPLINK_HEADER_SIZE +
+                                      LORA_MAX_NODES * LoRaGatewaySensor::UPLINK_NODE_SIZE) <=
+              particle::protocol::MAX_EVENT_DATA_LENGTH + 1,
+              "LORA_MAX_NODES does not fit in one event");
+
+volatile bool LoRaGatewaySensor::_rxPending = false;
+
+// DIO0 is mapped to RxDone; the FIFO is read over SPI in loop(), not here.
+void LoRaGatewaySensor::dio0ISR() {
+    _rxPending = true;
+}
+
+bool LoRaGatewaySensor::setup() {
+    pinMode(loraCsPin, OUTPUT);
+    digitalWrite(loraCsPin, HIGH);
+    pinMode(loraResetPin, OUTPUT);
+    pinMode(loraDio0Pin, INPUT_PULLDOWN);
+    SPI.begin();
+
+    // Hardware reset: low for at least 100 us, then 5 ms to start
+    digitalWrite(loraResetPin, LOW);
+    delayMicroseconds(200);
+    digitalWrite(loraResetPin, HIGH);
+    delay(5);
+
+    reset();
+    _data.type = SensorType::LORA_GATEWAY;
+
+    uint8_t version = readRegister(REG_VERSION);
+    _radioFound = (version == CHIP_VERSION);
+    _data.flag1 = _radioFound;
+    if (!_radioFound) {
+        Log.error("LoRa radio not found (version 0x%02x)", version);
+        _isReady = false;
+        return false;
+    }
+
+    configureRadio();
+    attachInterrupt(loraDio0Pin, dio0ISR, RISING);
+    setMode(MODE_RX_CONTINUOUS);
+    _isReady = true;
+
+    if (sysStatus.get_operatingMode() != CONNECTED) {
+        Log.warn("LoRa gateway is not in CONNECTED mode; node reports sent while it sleeps are lost");
+    }
+    Log.info("LoRa gateway listening at %lu Hz SF%d, network %d, up to %d nodes",
+             (unsigned long)LORA_FREQUENCY_HZ, LORA_SPREADING_FACTOR, LORA_NETWORK_ID, LORA_MAX_NODES);
+    return true;
+}
+
+bool LoRaGatewaySensor::configureRadio() {
+    // LoRa mode can only be selected from sleep
+    writeRegister(REG_OP_MODE, MODE_SLEEP);
+    writeRegister(REG_OP_MODE, MODE_LONG_RANGE | MODE_SLEEP);
+
+    uint64_t frf = ((uint64_t)LORA_FREQUENCY_HZ << 19) / 32000000ULL;
+    writeRegister(REG_FRF_MSB, (uint8_t)(frf >> 16));
+    writeRegister(REG_FRF_MID, (uint8_t)(frf >> 8));
+    writeRegister(REG_FRF_LSB, (uint8_t)frf);
+
+    writeRegister(REG_FIFO_RX_BASE_ADDR, 0);
+    writeRegister(REG_LNA, readRegister(REG_LNA) | 0x03);      // LNA boost for HF
+    writeRegister(REG_MODEM_CONFIG_1, 0x72);                   // 125 kHz, 4/5, explicit header
+    writeRegister(REG_MODEM_CONFIG_2, (uint8_t)((LORA_SPREADING_FACTOR << 4) | 0x04));   // CRC on
+    // AGC on; low data rate optimisation when a symbol exceeds 16 ms
+    writeRegister(REG_MODEM_CONFIG_3, LORA_SPREADING_FACTOR >= 11 ? 0x0C : 0x04);
+    writeRegister(REG_SYNC_WORD, LORA_SYNC_WORD);
+    writeRegister(REG_DIO_MAPPING_1, 0x00);                    // DIO0 = RxDone
+    setMode(MODE_STDBY);
+    return true;
+}
+
+uint8_t LoRaGatewaySensor::readRegister(uint8_t reg) {
+    SPI.beginTransaction(radioSPI);
+    digitalWrite(loraCsPin, LOW);
+    SPI.transfer(reg & 0x7F);
+    uint8_t value = SPI.transfer(0x00);
+    digitalWrite(loraCsPin, HIGH);
+    SPI.endTransaction();
+    return value;
+}
+
+void LoRaGatewaySensor::writeRegister(uint8_t reg, uint8_t value) {
+    SPI.beginTransaction(radioSPI);
+    digitalWrite(loraCsPin, LOW);
+    SPI.transfer(reg | 0x80);
+    SPI.transfer(value);
+    digitalWrite(loraCsPin, HIGH);
+    SPI.endTransaction();
+}
+
+void LoRaGatewaySensor::setMode(uint8_t mode) {
+    writeRegister(REG_OP_MODE, MODE_LONG_RANGE | mode);
+}
+
+bool LoRaGatewaySensor::loop() {
+    if (!_isReady) {
+        return false;
+    }
+    // DIO0 normally flags a packet; the once-a-second poll covers a lost edge
+    uint32_t now = millis();
+    if (!_rxPending && now - _lastPollMs < 1000) {
+        return false;
+    }
+    _lastPollMs = now;
+    _rxPending = false;
+    receivePacket();
+    // Node reports are aggregates, not count events for this device
+    return false;
+}
+
+size_t LoRaGatewaySensor::drain(SensorEvent* out, size_t max) {
+    (void)out;
+    (void)max;
+    loop();
+    return 0;
+}
+
+void LoRaGatewaySensor::receivePacket() {
+    uint8_t flags = readRegister(REG_IRQ_FLAGS);
+    if (!(flags & IRQ_RX_DONE)) {
+        return;
+    }
+    writeRegister(REG_IRQ_FLAGS, flags);    // Write 1s to clear
+
+    if (flags & IRQ_PAYLOAD_CRC_ERROR) {
+        _rejected++;
+        return;
+    }
+
+    uint8_t length = readRegister(REG_RX_NB_BYTES);
+    int8_t rssi = (int8_t)constrain((int)readRegister(REG_PKT_RSSI_VALUE) - 157, -128, 0);
+    writeRegister(REG_FIFO_ADDR_PTR, readRegister(REG_FIFO_RX_CURRENT_ADDR));
+
+    uint8_t report[REPORT_SIZE];
+    if (length != REPORT_SIZE) {
+        _rejected++;
+        return;
+    }
+    SPI.beginTransaction(radioSPI);
+    digitalWrite(loraCsPin, LOW);
+    SPI.transfer(REG_FIFO & 0x7F);
+    for (size_t ii = 0; ii < REPORT_SIZE; ii++) {
+        report[ii] = SPI.transfer(0x00);
+    }
+    digitalWrite(loraCsPin, HIGH);
+    SPI.endTransaction();
+
+    if (report[0] != VERSION || report[1] != LORA_NETWORK_ID) {
+        _rejected++;
+        return;
+    }
+    applyReport(report, rssi);
+}
+
+void LoRaGatewaySensor::applyReport(const uint8_t* report, int8_t rssi) {
+    uint16_t id = get16(&report[2]);
+    uint8_t seq = report[4];
+    bool booted = report[5] & 0x01;
+    uint16_t total = get16(&report[6]);
+
+    bool added = false;
+    Node* node = findOrAddNode(id, added);
+    if (!node) {
+        _dropped++;
+        return;
+    }
+
+    if (!added && !booted) {
+        uint8_t gap = (uint8_t)(seq - node->lastSeq);
+        if (gap == 0) {
+            return;     // Repeat of the last report
+        }
+        if (gap < 128) {
+            node->missed = addSaturated(node->missed, gap - 1);
+        }
+        node->count += (uint16_t)(total - node->lastTotal);
+    } else if (booted) {
+        node->count += total;   // Everything since the node started counting
+    } else {
+        // First heard from a node that was already running (the gateway reset, or the
+        // row expired): its total includes counts already sent, so it is only a baseline
+        Log.info("LoRa node %u first heard at total %u; counting from the next report", id, total);
+    }
+
+    node->lastTotal = total;
+    node->lastSeq = seq;
+    node->reports = addSaturated(node->reports, 1);
+    node->battery = report[8];
+    node->tempC = (int8_t)report[9];
+    node->alertCode = report[10];
+    node->rssi = rssi;
+    node->lastSeenSec = millis() / 1000;
+    _received++;
+
+    _data.timestamp = Time.now();
+    _data.hasNewData = true;
+    _data.primary = _nodeCount;
+    _data.secondary = _received;
+    _data.aux1 = id;
+}
+
+LoRaGatewaySensor::Node* LoRaGatewaySensor::findOrAddNode(uint16_t id, bool& added) {
+    added = false;
+    for (uint8_t ii = 0; ii < _nodeCount; ii++) {
+        if (_nodes[ii].id == id) {
+            return &_nodes[ii];
+        }
+    }
+    if (_nodeCount >= LORA_MAX_NODES) {
+        expireNodes();
+        if (_nodeCount >= LORA_MAX_NODES) {
+            return nullptr;
+        }
+    }
+    Node* node = &_nodes[_nodeCount++];
+    memset(node, 0, sizeof(*node));
+    node->id = id;
+    added = true;
+    Log.info("LoRa node %u added (%u in table)", id, _nodeCount);
+    return node;
+}
+
+void LoRaGatewaySensor::expireNodes() {
+    uint32_t nowSec = millis() / 1000;
+    uint8_t kept = 0;
+    for (uint8_t ii = 0; ii < _nodeCount; ii++) {
+        if (nowSec - _nodes[ii].lastSeenSec > LORA_NODE_EXPIRE_SEC) {
+            Log.info("LoRa node %u expired", _nodes[ii].id);
+            continue;
+        }
+        _nodes[kept++] = _nodes[ii];
+    }
+    _nodeCount = kept;
+}
+
+bool LoRaGatewaySensor::publishNodes(uint32_t timestamp) {
+    expireNodes();
+    if (_nodeCount == 0) {
+        Log.info("LoRa gateway: no nodes to report");
+        return false;
+    }
+
+    uint8_t record[UPLINK_HEADER_SIZE + LORA_MAX_NODES * UPLINK_NODE_SIZE];
+    record[0] = VERSION;
+    record[1] = _nodeCount;
+    put32(&record[2], timestamp);
+
+    uint32_t nowSec = millis() / 1000;
+    uint8_t *p = &record[UPLINK_HEADER_SIZE];
+    for (uint8_t ii = 0; ii < _nodeCount; ii++, p += UPLINK_NODE_SIZE) {
+        Node &node = _nodes[ii];
+        uint32_t ageMin = (nowSec - node.lastSeenSec) / 60;
+        put16(&p[0], node.id);
+        put16(&p[2], node.count);
+        p[4] = node.reports;
+        p[5] = node.missed;
+        p[6] = node.battery;
+        p[7] = (uint8_t)node.tempC;
+        p[8] = node.alertCode;
+        p[9] = (uint8_t)node.rssi;
+        p[10] = (uint8_t)(ageMin > 255 ? 255 : ageMin);
+    }
+
+    size_t size = UPLINK_HEADER_SIZE + _nodeCount * UPLINK_NODE_SIZE;
+    char text[CompactReport::textSize(sizeof(record))];
+    CompactReport::base64(record, size, text, sizeof(text));
+    PublishQueuePosix::instance().publishToLane(ProjectConfig::LANE_REPORT, ProjectConfig::loraNodesEventName(),
+                                                text, PRIVATE | WITH_ACK);
+    Log.info("LoRa gateway: %u nodes, %u reports (%u rejected, %u dropped) in %u bytes",
+             _nodeCount, _received, _rejected, _dropped, (unsigned)strlen(text));
+
+    // Next interval; node ids, totals and sequence numbers carry over
+    for (uint8_t ii = 0; ii < _nodeCount; ii++) {
+        _nodes[ii].count = 0;
+        _nodes[ii].reports = 0;
+        _nodes[ii].missed = 0;
+    }
+    _received = 0;
+    _rejected = 0;
+    _dropped = 0;
+    _data.secondary = 0;
+    return true;
+}
+
+void LoRaGatewaySensor::reset() {
+    _nodeCount = 0;
+    _received = 0;
+    _rejected = 0;
+    _dropped = 0;
+    _rxPending = false;
+    _data = SensorData();
+    _data.type = SensorType::LORA_GATEWAY;
+    _data.flag1 = _radioFound;
+}
+
+void LoRaGatewaySensor::onSleep() {
+    if (!_isReady) {
+        return;
+    }
+    detachInterrupt(loraDio0Pin);
+    setMode(MODE_SLEEP);
+}
+
+bool LoRaGatewaySensor::onWake() {
+    if (!_radioFound) {
+        return false;
+    }
+    SPI.begin();
+    // Register contents are kept in sleep mode
+    setMode(MODE_STDBY);
+    writeRegister(REG_IRQ_FLAGS, 0xFF);
+    _rxPending = false;
+    attachInterrupt(loraDio0Pin, dio0ISR, RISING);
+    setMode(MODE_RX_CONTINUOUS);
+    return true;
+}
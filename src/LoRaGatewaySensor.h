@@ -0,0 +1,161 @@
+// src/LoRaGatewaySensor.h
+#ifndef LORAGATEWAYSENSOR_H
+#define LORAGATEWAYSENSOR_H
+
+#include "ISensor.h"
+#include "Config.h"
+#include "Particle.h"
+#include "device_pinout.h"
+
+/**
+ * @brief Gateway hub: receives node reports over an SPI-attached SX127x
+ *        LoRa radio and uplinks them all in one event per report.
+ *
+ * Trail counters without a cellular modem send a small report to the
+ * gateway every few minutes. The gateway keeps one row per node in a
+ * fixed table (LORA_MAX_NODES) and folds reports into it as they arrive:
+ * the node's running total becomes a count for the reporting interval,
+ * sequence gaps become a missed-report count, and the latest battery,
+ * temperature, alert and link quality are kept. publishNodes() packs
+ * every row into one base64 record, queues it through PublishQueuePosix
+ * and starts the next interval, so one cellular connection carries all
+ * of the nodes.
+ *
+ * The node table is RAM only. A node's first report after the gateway
+ * resets, or after its row expired, only sets the baseline total unless
+ * the node has just booted too; the counts it sent before are not added
+ * again, and those made while it was unheard are lost.
+ *
+ * The radio listens continuously (RXCONTINUOUS) and is put to sleep in
+ * onSleep(), so a gateway should run in CONNECTED mode; reports sent
+ * while it naps are lost and show up as missed.
+ *
+ * Node report, LoRa payload version 1 (11 bytes, little-endian):
+ *
+ *     0  u8   version (1)
+ *     1  u8   network id (LORA_NETWORK_ID); other networks are ignored
+ *     2  u16  node id
+ *     4  u8   sequence number, +1 per report
+ *     5  u8   flags: bit 0 = first report since the node booted
+ *     6  u16  running count since the node booted (wraps)
+ *     8  u8   battery percent
+ *     9  i8   temperature C
+ *    10  u8   alert code
+ *
+ * Uplink record, version 1 (LoRa-Nodes event, base64):
+ *
+ *     0  u8   version (1)
+ *     1  u8   number of nodes N
+ *     2  u32  Unix seconds (the report timestamp)
+ *     6  N x 11 bytes:
+ *          u16 node id, u16 count this interval, u8 reports received,
+ *          u8 reports missed, u8 battery percent, i8 temperature C,
+ *          u8 alert code, i8 last RSSI dBm, u8 minutes since last heard
+ *
+ * Output (SensorData):
+ * - primary:   nodes in the table
+ * - secondary: reports received this interval
+ * - aux1:      id of the node heard last
+ * - flag1:     radio answered at setup
+ */
+class LoRaGatewaySensor : public ISensor {
+public:
+    /**
+     * @brief Get singleton instance
+     */
+    static LoRaGatewaySensor& instance() {
+        static LoRaGatewaySensor _instance;
+        return _instance;
+    }
+
+    bool setup() override;
+    bool loop() override;
+    size_t drain(SensorEvent* out, size_t max) override;
+
+    const SensorData& getData() const override { return _data; }
+    const char* getSensorType() const override { return "LoRaGateway"; }
+    bool isReady() const override { return _isReady; }
+    void reset() override;
+
+    // Serviced on every pass so no report waits in the radio FIFO
+    bool usesInterrupt() const override { return true; }
+    WakeSource wakeSource() const override { return WakeSource::gpio(loraDio0Pin, RISING); }
+    void onSleep() override;
+    bool onWake() override;
+
+    bool isHealthy() const override { return _radioFound; }
+    int lastErrorCode() const override { return _radioFound ? 0 : 1; }
+
+    /**
+     * @brief Queue one LoRa-Nodes event with every node and start a new interval.
+     *
+     * Nodes not heard for LORA_NODE_EXPIRE_SEC are dropped first.
+     *
+     * @param timestamp Unix seconds written into the record
+     * @return true if an event was queued (false with no nodes)
+     */
+    bool publishNodes(uint32_t timestamp);
+
+    /** @brief Version byte of node reports and of the uplink record. */
+    static constexpr uint8_t VERSION = 1;
+
+    /** @brief Size of a version 1 node report. */
+    static constexpr size_t REPORT_SIZE = 11;
+
+    /** @brief Size of the uplink header and of each node in it. */
+    static constexpr size_t UPLINK_HEADER_SIZE = 6;
+    static constexpr size_t UPLINK_NODE_SIZE = 11;
+
+private:
+    LoRaGatewaySensor() {}
+    ~LoRaGatewaySensor() {}
+    LoRaGatewaySensor(const LoRaGatewaySensor&) = delete;
+    LoRaGatewaySensor& operator=(const LoRaGatewaySensor&) = delete;
+
+    /** @brief Aggregate for one node over the current interval. */
+    struct Node {
+        uint16_t id;
+        uint16_t lastTotal;     // Running count in the last report
+        uint16_t count;         // Counted this interval
+        uint8_t  lastSeq;
+        uint8_t  reports;       // Received this interval
+        uint8_t  missed;        // Sequence gaps this interval
+        uint8_t  battery;
+        int8_t   tempC;
+        uint8_t  alertCode;
+        int8_t   rssi;
+        uint32_t lastSeenSec;   // millis() / 1000
+    };
+
+    uint8_t readRegister(uint8_t reg);
+    void writeRegister(uint8_t reg, uint8_t value);
+    void setMode(uint8_t mode);
+    bool configureRadio();
+
+    /**
+     * @brief Read one packet from the FIFO and fold it into the table.
+     */
+    void receivePacket();
+
+    void applyReport(const uint8_t* report, int8_t rssi);
+    Node* findOrAddNode(uint16_t id, bool& added);
+    void expireNodes();
+
+    bool _isReady = false;
+    bool _radioFound = false;
+    SensorData _data;
+
+    Node _nodes[LORA_MAX_NODES];
+    uint8_t _nodeCount = 0;
+    uint16_t _received = 0;     // Reports this interval
+    uint16_t _rejected = 0;     // CRC errors, foreign or malformed packets this interval
+    uint16_t _dropped = 0;      // Reports from new nodes with the table full
+
+    uint32_t _lastPollMs = 0;
+
+    static volatile bool _rxPending;
+
+    static void dio0ISR();
+};
+
+#endif /* LORAGATEWAYSENSOR_H */
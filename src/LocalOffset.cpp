@@ -0,0 +1,152 @@
+#include "LocalOffset.h"
+#include "LocalTimeRK.h"
+#include "StorageHelperRK.h"
+#include <string.h>
+
+namespace LocalOffset {
+
+static constexpr uint32_t MAGIC = 0x4c4f4654;      // "LOFT"
+static constexpr size_t MAX_CHANGES = 4;           // Two DST changes a year, two years
+
+// From at on, local time is UTC + offsetSec
+struct Change {
+    time_t at;
+    int32_t offsetSec;
+};
+
+struct Table {
+    uint32_t magic;
+    uint32_t tzHash;            // hashTz() of the TZ string it was built for
+    time_t start;               // January 1 of the first year, 00:00 UTC
+    time_t end;                 // January 1 two years later
+    int32_t offsetAtStart;      // Offset before changes[0]
+    uint8_t count;
+    Change changes[MAX_CHANGES];
+};
+
+static retained Table table;
+static uint32_t wantHash = 0;   // TZ string from reload(); 0 until it is called
+
+static uint32_t hashTz(const char *tz) {
+    uint32_t hash = StorageHelperRK::murmur3_32((const uint8_t *)tz, strlen(tz),
+                                               StorageHelperRK::PersistentDataBase::HASH_SEED);
+    return hash ? hash : 1;
+}
+
+// Days since 1970-01-01 of a civil date, and back (proleptic Gregorian)
+static int32_t daysFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    unsigned yoe = (unsigned)(year - era * 400);
+    unsigned doy = (153 * (unsigned)(month > 2 ? month - 3 : month + 9) + 2) / 5 + (unsigned)day - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int32_t)doe - 719468;
+}
+
+static void civilFromDays(int32_t days, int &year, int &month, int &day) {
+    days += 719468;
+    int era = (days >= 0 ? days : days - 146096) / 146097;
+    unsigned doe = (unsigned)(days - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp = (5 * doy + 2) / 153;
+    day = (int)(doy - (153 * mp + 2) / 5 + 1);
+    month = (int)(mp < 10 ? mp + 3 : mp - 9);
+    year = (int)yoe + era * 400 + (month <= 2);
+}
+
+static time_t yearStart(int year) {
+    return (time_t)daysFromCivil(year, 1, 1) * 86400;
+}
+
+static void addChange(time_t at, int32_t offsetSec) {
+    if (table.count < MAX_CHANGES) {
+        table.changes[table.count].at = at;
+        table.changes[table.count].offsetSec = offsetSec;
+        table.count++;
+    }
+}
+
+// The DST changes of year and year + 1, from LocalTimeConvert once per year
+static void build(int year) {
+    const LocalTimePosixTimezone &config = LocalTime::instance().getConfig();
+    int32_t standardSec = -config.standardHMS.toSeconds();
+    int32_t dstSec = -config.dstHMS.toSeconds();
+
+    table.magic = 0;
+    table.count = 0;
+    table.start = yearStart(year);
+    table.end = yearStart(year + 2);
+    table.offsetAtStart = standardSec;
+    if (config.hasDST()) {
+        for (int yy = year; yy <= year + 1; yy++) {
+            // Mid-year, so the rules are evaluated for that year
+            LocalTimeConvert conv;
+            conv.withConfig(config).withTime(yearStart(yy) + 182 * 86400).convert();
+            if (conv.dstStart < conv.standardStart) {
+                // Northern hemisphere: standard time at new year
+                addChange(conv.dstStart, dstSec);
+                addChange(conv.standardStart, standardSec);
+            } else {
+                if (yy == year) {
+                    table.offsetAtStart = dstSec;
+                }
+                addChange(conv.standardStart, standardSec);
+                addChange(conv.dstStart, dstSec);
+            }
+        }
+    }
+    table.tzHash = wantHash;
+    table.magic = MAGIC;
+    Log.info("LocalOffset: %d-%d, %u DST changes, offset %ld s at the start",
+             year, year + 1, (unsigned)table.count, (long)table.offsetAtStart);
+}
+
+// Rebuild if the table is for another timezone or Time.now() has left it
+static bool covers(time_t utc) {
+    if (wantHash == 0) {
+        return false;
+    }
+    bool usable = table.magic == MAGIC && table.tzHash == wantHash;
+    if (Time.isValid()) {
+        time_t now = Time.now();
+        if (!usable || now < table.start || now >= table.end) {
+            int year, month, day;
+            civilFromDays((int32_t)(now / 86400), year, month, day);
+            build(year);
+            usable = true;
+        }
+    }
+    return usable && utc >= table.start && utc < table.end;
+}
+
+void reload(const char *tz) {
+    wantHash = hashTz(tz ? tz : "");
+    if (table.magic == MAGIC && table.tzHash == wantHash) {
+        Log.info("LocalOffset: kept table for %s", tz ? tz : "");
+    }
+}
+
+bool split(time_t utc, Fields &fields) {
+    if (!covers(utc)) {
+        return false;
+    }
+    int32_t offsetSec = table.offsetAtStart;
+    for (size_t ii = 0; ii < table.count && utc >= table.changes[ii].at; ii++) {
+        offsetSec = table.changes[ii].offsetSec;
+    }
+    time_t local = utc + offsetSec;
+    int32_t days = (int32_t)(local / 86400);
+    int32_t secOfDay = (int32_t)(local % 86400);
+    if (secOfDay < 0) {
+        secOfDay += 86400;
+        days--;
+    }
+    civilFromDays(days, fields.year, fields.month, fields.day);
+    fields.dayOfWeek = (int)((days % 7 + 11) % 7);     // 1970-01-01 was a Thursday
+    fields.hour = secOfDay / 3600;
+    fields.minute = (secOfDay % 3600) / 60;
+    return true;
+}
+
+} // namespace LocalOffset
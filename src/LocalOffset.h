@@ -0,0 +1,55 @@
+/**
+ * @file LocalOffset.h
+ * @brief UTC offset table for the configured timezone, for cheap local times.
+ *
+ * @details LocalTimeConvert::convert() copies the timezone configuration
+ *          (two Strings) and works out the year's DST changes from the POSIX
+ *          rules on every call. This table holds the UTC times of the DST
+ *          changes in the current and the next year, with the offset after
+ *          each, so a local time is a short scan and some integer arithmetic.
+ *
+ *          The table is in retained memory, keyed by a hash of the TZ
+ *          string, so a wake from HIBERNATE finds it still valid and only a
+ *          new year or a new timezone builds it again. It needs a valid
+ *          Time to be built; until then, and for times outside the two
+ *          years, split() returns false and the caller converts the usual
+ *          way.
+ *
+ *          Application thread only.
+ */
+
+#ifndef __LOCALOFFSET_H
+#define __LOCALOFFSET_H
+
+#include "Particle.h"
+
+namespace LocalOffset {
+
+/** @brief A local time broken into the fields the callers use. */
+struct Fields {
+    int year;           ///< e.g. 2026
+    int month;          ///< 1-12
+    int day;            ///< 1-31
+    int dayOfWeek;      ///< 0 = Sunday
+    int hour;           ///< 0-23
+    int minute;         ///< 0-59
+};
+
+/**
+ * @brief Take the timezone in LocalTime; call after each withConfig()
+ *
+ * @param tz The POSIX TZ string LocalTime was configured with
+ */
+void reload(const char *tz);
+
+/**
+ * @brief Local time of @p utc
+ *
+ * @return false if the table does not cover @p utc (or Time was never
+ *         valid); @p fields is not set
+ */
+bool split(time_t utc, Fields &fields);
+
+} // namespace LocalOffset
+
+#endif /* __LOCALOFFSET_H */
@@ -0,0 +1,178 @@
+#include "LoopbackTest.h"
+#include "Config.h"
+
+#if LOOPBACK_TEST_ENABLED
+
+#include "ISensor.h"
+#include "MyPersistentData.h"
+#include "Payload.h"
+#include "SensorManager.h"
+#include "device_pinout.h"
+#include <algorithm>
+#include <atomic>
+
+extern bool publishDiagnosticSafe(const char* eventName, const char* data, PublishFlags flags);
+
+namespace LoopbackTest {
+
+// The train, as parsed from the function argument
+struct Train {
+    uint32_t count;
+    uint32_t periodMs;
+    uint32_t burst;         // Pulses per burst (0 = no bursts)
+    uint32_t burstGapMs;    // Extra gap after each burst
+    uint32_t jitterMs;      // Rising edge moved by up to +/- this
+    uint32_t widthMs;
+};
+
+static Train train;
+static Thread *generator = nullptr;
+static std::atomic<uint32_t> generated(0);
+static std::atomic<uint32_t> lastPulseMs(0);
+static std::atomic<bool> stopRequested(false);
+static std::atomic<bool> generating(false);
+static bool running = false;
+static uint32_t startMs = 0;
+
+// Pipeline state when the run started
+static uint32_t rejectedAtStart = 0;
+static uint32_t dailyAtStart = 0;
+
+static uint16_t samples[MAX_SAMPLES];
+static size_t sampleCount = 0;
+static uint32_t maxLatencyMs = 0;
+
+// "<count>,<periodMs>[,<burst>,<burstGapMs>,<jitterMs>,<widthMs>]"
+static bool parse(const char *text, Train &out) {
+    uint32_t fields[6] = {0, 0, 0, 0, 0, 0};
+    size_t n = 0;
+    while (*text && n < 6) {
+        char *end;
+        fields[n++] = (uint32_t)strtoul(text, &end, 10);
+        if (end == text || (*end != ',' && *end != 0)) {
+            return false;
+        }
+        text = (*end == ',') ? end + 1 : end;
+    }
+    out = {fields[0], fields[1], fields[2], fields[3], fields[4], n >= 6 ? fields[5] : 20};
+    // The pulse and its low time must both fit the shortest period
+    return n >= 2 && *text == 0 && out.count > 0 &&
+           out.widthMs > 0 && out.jitterMs + out.widthMs < out.periodMs;
+}
+
+// Generator thread: one rising edge per period, moved by the jitter
+static void generate() {
+    for (uint32_t ii = 0; ii < train.count && !stopRequested.load(); ii++) {
+        uint32_t lowMs = train.periodMs - train.widthMs;
+        if (train.jitterMs > 0) {
+            lowMs += (uint32_t)random(-(int)train.jitterMs, (int)train.jitterMs + 1);
+        }
+        if (train.burst > 0 && ii > 0 && ii % train.burst == 0) {
+            lowMs += train.burstGapMs;
+        }
+        delay(lowMs);
+        digitalWrite(loopbackOutPin, HIGH);
+        lastPulseMs.store(millis());
+        generated.fetch_add(1);
+        delay(train.widthMs);
+        digitalWrite(loopbackOutPin, LOW);
+    }
+    generating.store(false);
+}
+
+// Value at fraction @p permille of the sorted samples
+static uint32_t percentile(uint32_t permille) {
+    if (sampleCount == 0) {
+        return 0;
+    }
+    size_t index = std::min(sampleCount - 1, (size_t)((uint64_t)sampleCount * permille / 1000));
+    return samples[index];
+}
+
+static void report() {
+    delete generator;       // Joins the finished thread
+    generator = nullptr;
+    running = false;
+
+    std::sort(samples, samples + sampleCount);
+    uint32_t in = generated.load();
+    uint32_t rejected = SensorManager::instance().filter().rejectedCount() - rejectedAtStart;
+    int32_t expected = (int32_t)(in - rejected);
+    int32_t out = (int32_t)(current.get_dailyCount() - dailyAtStart);
+
+    char data[256];
+    Payload::Writer writer(data, sizeof(data));
+    writer.beginObject()
+        .add("gen", (unsigned long)in)
+        .add("rejected", (unsigned long)rejected)
+        .add("out", (long)out)
+        .add("lost", (long)(expected > out ? expected - out : 0))
+        .add("doubled", (long)(out > expected ? out - expected : 0))
+        .add("p50Ms", (unsigned long)percentile(500))
+        .add("p95Ms", (unsigned long)percentile(950))
+        .add("p99Ms", (unsigned long)percentile(990))
+        .add("maxMs", (unsigned long)maxLatencyMs)
+        .add("samples", (unsigned long)sampleCount)
+        .add("durMs", (unsigned long)(millis() - startMs))
+        .endObject();
+    Log.info("Loopback done: %s", data);
+    publishDiagnosticSafe("loopback", data, PRIVATE);
+}
+
+static int loopbackFunction(String command) {
+    if (command == "stop") {
+        stopRequested.store(true);
+        return 0;
+    }
+    Train parsed;
+    if (running || sysStatus.get_countingMode() != COUNTING || !parse(command.c_str(), parsed)) {
+        return -1;
+    }
+    train = parsed;
+    generated.store(0);
+    lastPulseMs.store(millis());
+    stopRequested.store(false);
+    sampleCount = 0;
+    maxLatencyMs = 0;
+    rejectedAtStart = SensorManager::instance().filter().rejectedCount();
+    dailyAtStart = current.get_dailyCount();
+    startMs = millis();
+    running = true;
+    generating.store(true);
+    generator = new Thread("loopback", generate, OS_THREAD_PRIORITY_DEFAULT + 1, 1024);
+    Log.info("Loopback: %lu pulses every %lu ms, burst %lu gap %lu ms, jitter %lu ms, width %lu ms",
+             (unsigned long)train.count, (unsigned long)train.periodMs, (unsigned long)train.burst,
+             (unsigned long)train.burstGapMs, (unsigned long)train.jitterMs, (unsigned long)train.widthMs);
+    return (int)train.count;
+}
+
+void setup() {
+    pinMode(loopbackOutPin, OUTPUT);
+    digitalWrite(loopbackOutPin, LOW);
+    Particle.function("loopback", loopbackFunction);
+}
+
+bool loop() {
+    if (running && !generating.load() && millis() - lastPulseMs.load() >= SETTLE_MS) {
+        report();
+    }
+    return true;
+}
+
+void noteApplied(const SensorEvent *batch, size_t count) {
+    if (!running) {
+        return;
+    }
+    uint32_t nowMs = millis();
+    for (size_t ii = 0; ii < count; ii++) {
+        uint32_t latencyMs = nowMs - batch[ii].tickMs;
+        maxLatencyMs = std::max(maxLatencyMs, latencyMs);
+        if (sampleCount < MAX_SAMPLES) {
+            samples[sampleCount++] = (uint16_t)std::min(latencyMs, (uint32_t)UINT16_MAX);
+        }
+    }
+}
+
+} // namespace LoopbackTest
+
+#endif /* LOOPBACK_TEST_ENABLED */
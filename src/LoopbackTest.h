@@ -0,0 +1,60 @@
+/**
+ * @file LoopbackTest.h
+ * @brief Bench measurement of counting loss and ISR-to-handler latency
+ *        with a generated pulse train looped back to intPin.
+ *
+ * @details Jumper loopbackOutPin to intPin and call the "loopback" cloud
+ *          function with "<count>,<periodMs>[,<burst>,<burstGapMs>,
+ *          <jitterMs>,<widthMs>]", e.g. "500,200,5,3000,50,40": 500 pulses
+ *          of 40 ms, rising every 200 ms +/- 50 ms, with an extra 3 s after
+ *          every 5. A thread of its own drives the pin, so the train keeps
+ *          its timing while the application thread connects, publishes
+ *          and saves as usual. "stop" ends a run early.
+ *
+ *          handleCountingMode() passes each applied batch to noteApplied(),
+ *          which records the time from the edge's capture in the ISR
+ *          (SensorEvent::tickMs) to the handler. SETTLE_MS after
+ *          the last pulse a "loopback" event reports pulses generated,
+ *          filter rejections, counts, lost and doubled events, and the
+ *          latency p50, p95, p99 and max in milliseconds. The percentiles
+ *          cover the first MAX_SAMPLES events.
+ *
+ *          COUNTING mode only. The counts are real; use a bench unit.
+ *          Bench builds only: LOOPBACK_TEST_ENABLED.
+ */
+
+#ifndef __LOOPBACKTEST_H
+#define __LOOPBACKTEST_H
+
+#include "Particle.h"
+
+struct SensorEvent;
+
+namespace LoopbackTest {
+
+/** @brief Events whose latency is kept for the percentiles. */
+static constexpr size_t MAX_SAMPLES = 1024;
+
+/** @brief Wait after the last pulse for its event to be drained and counted. */
+static constexpr uint32_t SETTLE_MS = 3000;
+
+/**
+ * @brief Register the "loopback" cloud function and set up the output pin
+ */
+void setup();
+
+/**
+ * @brief TaskScheduler task: report once the train has ended and settled
+ *
+ * @return true (TaskScheduler task)
+ */
+bool loop();
+
+/**
+ * @brief handleCountingMode() applied @p count events of @p batch
+ */
+void noteApplied(const SensorEvent *batch, size_t count);
+
+} // namespace LoopbackTest
+
+#endif /* __LOOPBACKTEST_H */
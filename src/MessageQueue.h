@@ -0,0 +1,97 @@
+// src/MessageQueue.h
+#ifndef MESSAGEQUEUE_H
+#define MESSAGEQUEUE_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Fixed-capacity multi-producer/single-consumer queue.
+ *
+ * For callbacks on the system thread, a timer or a worker thread that
+ * hand a small message to the application loop. Unlike EventRing, any
+ * number of threads may push at once: each slot carries a sequence
+ * number, a producer claims a slot by advancing @c _head with a
+ * compare-and-swap, writes it, then publishes it by storing the slot's
+ * sequence. No lock is taken, so a producer never blocks behind the
+ * application thread and push() is safe from an ISR.
+ *
+ * When the queue is full, push() drops the message and counts it.
+ *
+ * @tparam T         POD message type
+ * @tparam Capacity  Number of slots; must be a power of two
+ */
+template <typename T, size_t Capacity>
+class MessageQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "MessageQueue capacity must be a power of two");
+
+public:
+    MessageQueue() : _head(0), _tail(0), _overflows(0) {
+        for (size_t i = 0; i < Capacity; i++) {
+            _slots[i].seq.store((uint32_t)i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Producer side: append one message; safe from any thread.
+     * @return false if the queue was full and the message was dropped
+     */
+    bool push(const T& value) {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        while (true) {
+            Slot &slot = _slots[head & (Capacity - 1)];
+            int32_t diff = (int32_t)(slot.seq.load(std::memory_order_acquire) - head);
+            if (diff == 0) {
+                // Slot is free for this lap; claim it
+                if (_head.compare_exchange_weak(head, head + 1, std::memory_order_relaxed)) {
+                    slot.value = value;
+                    slot.seq.store(head + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                _overflows.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                head = _head.load(std::memory_order_relaxed);   // Another producer got it
+            }
+        }
+    }
+
+    /**
+     * @brief Consumer side: remove the oldest message; one thread only.
+     * @return false if the queue was empty (or the oldest is still being written)
+     */
+    bool pop(T& out) {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        Slot &slot = _slots[tail & (Capacity - 1)];
+        if ((int32_t)(slot.seq.load(std::memory_order_acquire) - (tail + 1)) < 0) {
+            return false;
+        }
+        out = slot.value;
+        slot.seq.store(tail + Capacity, std::memory_order_release);
+        _tail.store(tail + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Total messages dropped because the queue was full.
+     */
+    uint32_t overflows() const { return _overflows.load(std::memory_order_relaxed); }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> seq;
+        T value;
+    };
+
+    Slot _slots[Capacity];
+    std::atomic<uint32_t> _head;       // Next slot to claim, all producers
+    std::atomic<uint32_t> _tail;       // Consumer only
+    std::atomic<uint32_t> _overflows;
+};
+
+#endif /* MESSAGEQUEUE_H */
@@ -0,0 +1,227 @@
+#include "MicroBench.h"
+#include "Config.h"
+
+#if MICROBENCH_ENABLED || FIELD_BENCH_ENABLED
+
+#include "Cloud.h"
+#include "LocalOffset.h"
+#include "LocalTimeRK.h"
+#include "MyPersistentData.h"
+#include "Payload.h"
+#include "PlatformTraits.h"
+#include "ProjectConfig.h"
+#include "PublishQueuePosixRK.h"
+#include "StateMachine.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace MicroBench {
+
+// Min, total and max cycles over the runs of one operation
+struct Result {
+    uint32_t n;
+    uint32_t minTicks;
+    uint32_t maxTicks;
+    uint64_t totalTicks;
+};
+
+template <typename Fn>
+static Result measure(uint32_t n, Fn fn) {
+    Result result = {n, UINT32_MAX, 0, 0};
+    for (uint32_t ii = 0; ii < n; ii++) {
+        uint32_t start = System.ticks();
+        fn(ii);
+        uint32_t ticks = System.ticks() - start;
+        result.totalTicks += ticks;
+        if (ticks < result.minTicks) {
+            result.minTicks = ticks;
+        }
+        if (ticks > result.maxTicks) {
+            result.maxTicks = ticks;
+        }
+        Particle.process();     // Keep the system thread and watchdog serviced between runs
+    }
+    return result;
+}
+
+static uint32_t meanUs(const Result &result) {
+    return (uint32_t)(result.totalTicks / result.n / System.ticksPerMicrosecond());
+}
+
+#if MICROBENCH_ENABLED
+
+// Ticks as hundredths of a microsecond
+static int32_t centiUs(uint64_t ticks) {
+    return (int32_t)(ticks * 100 / System.ticksPerMicrosecond());
+}
+
+static void print(const char *op, const Result &result) {
+    Serial.printlnf("%-26s %6lu %10s %10s %10s", op, (unsigned long)result.n,
+                    Payload::Scaled(centiUs(result.minTicks), 2).c_str(),
+                    Payload::Scaled(centiUs(result.totalTicks / result.n), 2).c_str(),
+                    Payload::Scaled(centiUs(result.maxTicks), 2).c_str());
+}
+
+void run() {
+    waitFor(Serial.isConnected, 10000);
+    Serial.printlnf("MicroBench %s, %lu ticks/us", System.version().c_str(), (unsigned long)System.ticksPerMicrosecond());
+    Serial.printlnf("%-26s %6s %10s %10s %10s", "op", "n", "min us", "mean us", "max us");
+
+    // Persistent store: RAM update (hash deferred), then a forced save
+    uint8_t suppressed = current.get_reportsSuppressed();
+    print("current.setValue", measure(1000, [](uint32_t ii) { current.set_reportsSuppressed((uint8_t)ii); }));
+    print("current.flush", measure(10, [](uint32_t ii) {
+        current.set_reportsSuppressed((uint8_t)ii);
+        current.flush(true);
+    }));
+    current.set_reportsSuppressed(suppressed);
+    current.flush(true);
+
+    // Builders; after the first run the ledgers are unchanged, so the rest
+    // time the build and hash that decide to skip the write
+    print("writeDeviceStatusToCloud", measure(10, [](uint32_t) { Cloud::instance().writeDeviceStatusToCloud(); }));
+    print("publishDataToLedger", measure(10, [](uint32_t) { Cloud::instance().publishDataToLedger(); }));
+
+    // Publish queue: to the RAM queue, then the RAM queue to files
+    PublishQueuePosix &queue = PublishQueuePosix::instance();
+    queue.setPausePublishing(true);
+    // One hourly report end to end (a repeat could take the suppressed path)
+    print("publishData", measure(1, [](uint32_t) { publishData(); }));
+    print("PublishQueue publish", measure(8, [&queue](uint32_t) {
+        queue.publish("bench", "{\"hourly\":12,\"daily\":345,\"battery\":87.50}", PRIVATE | WITH_ACK);
+    }));
+    print("PublishQueue to file", measure(1, [&queue](uint32_t) { queue.writeQueueToFiles(); }));
+    queue.clearQueues();
+    queue.setPausePublishing(false);
+
+    // Local time conversion, as OpenHours and the baseline do it
+    time_t now = Time.isValid() ? Time.now() : 1767225600;
+    print("LocalTimeConvert::convert", measure(100, [now](uint32_t ii) {
+        LocalTimeConvert conv;
+        conv.withConfig(LocalTime::instance().getConfig()).withTime(now + ii * 3600).convert();
+    }));
+    print("LocalOffset::split", measure(100, [now](uint32_t ii) {
+        LocalOffset::Fields local;
+        LocalOffset::split(now + ii * 3600, local);
+    }));
+
+#if PLATFORM_TRAITS_KIND == PLATFORM_TRAITS_BORON
+    PMIC pmic(true);
+    print("PMIC readFaultRegister", measure(100, [&pmic](uint32_t) { pmic.readFaultRegister(); }));
+#endif
+
+    Serial.println("MicroBench done");
+}
+
+#endif /* MICROBENCH_ENABLED */
+
+#if FIELD_BENCH_ENABLED
+
+static const char *benchDir = "/usr/bench";
+static const char *eventPath = "/usr/bench/event";
+static const char *throughputPath = "/usr/bench/bulk";
+static const size_t EVENT_BYTES = 256;          // A queued event file: header, name and data
+static const size_t CHUNK_BYTES = 512;
+static uint8_t buf[CHUNK_BYTES];
+static bool requested = false;
+
+static int benchFunction(String command) {
+    if (command.length() > 0 && command != "run") {
+        return -1;
+    }
+    requested = true;
+    Log.info("Bench: pass requested for the next idle window");
+    return 1;
+}
+
+// Whole-file write or read in chunks, as the queue stores do
+static bool writeFile(const char *path, size_t chunk, size_t total) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = true;
+    for (size_t done = 0; ok && done < total; done += chunk) {
+        ok = ::write(fd, buf, chunk) == (int)chunk;
+    }
+    close(fd);
+    return ok;
+}
+
+static bool readFile(const char *path, size_t chunk, size_t total) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = true;
+    for (size_t done = 0; ok && done < total; done += chunk) {
+        ok = ::read(fd, buf, chunk) == (int)chunk;
+    }
+    close(fd);
+    return ok;
+}
+
+static uint32_t kbPerSec(const Result &result, size_t bytes) {
+    uint32_t us = meanUs(result);
+    return us ? (uint32_t)((uint64_t)bytes * 1000000ULL / 1024 / us) : 0;
+}
+
+void setup() {
+    Particle.function("bench", benchFunction);
+}
+
+void runIfRequested() {
+    // Not while the queue is writing or sending, which would time both
+    if (!requested || !PublishQueuePosix::instance().getCanSleep()) {
+        return;
+    }
+    requested = false;
+    unsigned long startMs = millis();
+    memset(buf, 0xa5, sizeof(buf));
+    mkdir(benchDir, 0777);
+
+    // A save of unchanged data still writes the whole file
+    Result flush = measure(5, [](uint32_t) { current.flush(true); });
+
+    bool ok = true;
+    Result eventWrite = measure(10, [&ok](uint32_t) { ok &= writeFile(eventPath, EVENT_BYTES, EVENT_BYTES); });
+    Result eventRead = measure(10, [&ok](uint32_t) { ok &= readFile(eventPath, EVENT_BYTES, EVENT_BYTES); });
+    unlink(eventPath);
+
+    time_t now = Time.isValid() ? Time.now() : 1767225600;
+    Result convert = measure(20, [now](uint32_t ii) {
+        LocalTimeConvert conv;
+        conv.withConfig(LocalTime::instance().getConfig()).withTime(now + ii * 3600).convert();
+    });
+
+    const size_t bulkBytes = (size_t)FIELD_BENCH_THROUGHPUT_KB * 1024;
+    Result bulkWrite = measure(1, [&ok, bulkBytes](uint32_t) { ok &= writeFile(throughputPath, CHUNK_BYTES, bulkBytes); });
+    Result bulkRead = measure(1, [&ok, bulkBytes](uint32_t) { ok &= readFile(throughputPath, CHUNK_BYTES, bulkBytes); });
+    unlink(throughputPath);
+
+    char data[192];
+    Payload::Writer writer(data, sizeof(data));
+    writer.beginObject()
+        .add("flushUs", (unsigned long)meanUs(flush))
+        .add("flushMaxUs", (unsigned long)(flush.maxTicks / System.ticksPerMicrosecond()))
+        .add("evWrUs", (unsigned long)meanUs(eventWrite))
+        .add("evRdUs", (unsigned long)meanUs(eventRead))
+        .add("convUs", (unsigned long)meanUs(convert))
+        .add("wrKBs", (unsigned long)kbPerSec(bulkWrite, bulkBytes))
+        .add("rdKBs", (unsigned long)kbPerSec(bulkRead, bulkBytes))
+        .add("queued", (unsigned long)PublishQueuePosix::instance().getNumEvents())
+        .add("up", (unsigned long)System.uptime());
+    if (!ok) {
+        writer.add("fsError", true);
+    }
+    writer.endObject();
+    Log.info("Bench: %s (%lu ms)", data, millis() - startMs);
+    PublishQueuePosix::instance().publishToLane(ProjectConfig::LANE_STATUS, "bench", data, PRIVATE | WITH_ACK);
+}
+
+#endif /* FIELD_BENCH_ENABLED */
+
+} // namespace MicroBench
+
+#endif /* MICROBENCH_ENABLED || FIELD_BENCH_ENABLED */
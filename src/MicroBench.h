@@ -0,0 +1,59 @@
+/**
+ * @file MicroBench.h
+ * @brief On-device timing of the firmware's hot-path operations.
+ *
+ * @details Bench builds only (MICROBENCH_ENABLED). At the end of setup()
+ *          each operation is run a fixed number of times and timed with
+ *          System.ticks(), the CPU cycle counter, and a table of min, mean
+ *          and max microseconds is printed on USB serial:
+ *
+ *              op                          n     min us    mean us     max us
+ *              current.setValue         1000       0.41       0.44       2.10
+ *              ...
+ *
+ *          The suite writes current.dat, the hourly history, the
+ *          device-status and device-data ledgers and the publish queue (which
+ *          it empties again), so run it
+ *          on a bench unit and compare the table between releases built for
+ *          the same platform.
+ *
+ *          Deployed units get a smaller, non-destructive pass instead
+ *          (FIELD_BENCH_ENABLED): the `bench` cloud function requests it,
+ *          runIfRequested() runs it from IDLE_STATE once no publish is in
+ *          flight, and the result is queued as one "bench" event:
+ *
+ *              {"flushUs":2150,"flushMaxUs":4810,"evWrUs":3120,"evRdUs":410,
+ *               "convUs":38,"wrKBs":61,"rdKBs":640,"queued":3,"up":86400}
+ *
+ *          Means in microseconds, sequential throughput in KB/s, the events
+ *          queued at the time and the uptime in seconds. Compare units of
+ *          one platform, and one unit over months as its flash ages.
+ *
+ *          Application thread only.
+ */
+
+#ifndef __MICROBENCH_H
+#define __MICROBENCH_H
+
+#include "Particle.h"
+
+namespace MicroBench {
+
+/**
+ * @brief Run the suite and print the table; call at the end of setup()
+ */
+void run();
+
+/**
+ * @brief Register the `bench` cloud function; from setup()
+ */
+void setup();
+
+/**
+ * @brief Run a requested field pass and queue its "bench" event; from IDLE_STATE
+ */
+void runIfRequested();
+
+} // namespace MicroBench
+
+#endif /* __MICROBENCH_H */
@@ -0,0 +1,62 @@
+#include "MonoClock.h"
+#include "MyPersistentData.h"
+
+namespace MonoClock {
+
+// nowMs() - System.millis(); signed, as a boot can restore less than millis() already counted
+static int64_t baseMs = 0;
+static uint64_t lastCheckpointMs = 0;
+static uint64_t sleepStartMillis = 0;
+static time_t sleepStartTime = 0;
+
+void setup() {
+    uint64_t saved = sysStatus.get_monoSavedMs();
+    time_t savedTime = sysStatus.get_monoSavedTime();
+    uint64_t restored = saved;
+    if (Time.isValid() && savedTime != 0 && Time.now() >= savedTime) {
+        restored += (uint64_t)(Time.now() - savedTime) * 1000;
+    }
+    baseMs = (int64_t)restored - (int64_t)System.millis();
+    Log.info("MonoClock: %lu s, %lu s since the last checkpoint",
+             (unsigned long)(nowMs() / 1000), (unsigned long)((restored - saved) / 1000));
+    checkpoint();
+}
+
+uint64_t nowMs() {
+    return (uint64_t)(baseMs + (int64_t)System.millis());
+}
+
+void checkpoint(bool force) {
+    uint64_t now = nowMs();
+    if (!force && now - lastCheckpointMs < (uint64_t)MONO_CHECKPOINT_SEC * 1000) {
+        return;
+    }
+    lastCheckpointMs = now;
+    auto update = sysStatus.updateBatch();
+    sysStatus.set_monoSavedMs(now);
+    sysStatus.set_monoSavedTime(Time.isValid() ? Time.now() : 0);
+}
+
+void beginSleep(bool resets) {
+    sleepStartMillis = System.millis();
+    sleepStartTime = Time.isValid() ? Time.now() : 0;
+    checkpoint();
+    if (resets) {
+        sysStatus.flush(true);
+    }
+}
+
+void endSleep() {
+    if (sleepStartTime == 0 || !Time.isValid() || Time.now() < sleepStartTime) {
+        return;
+    }
+    uint64_t rtcMs = (uint64_t)(Time.now() - sleepStartTime) * 1000;
+    uint64_t countedMs = System.millis() - sleepStartMillis;
+    // The RTC has whole seconds; only a gap larger than that is time millis() missed
+    if (rtcMs > countedMs + 1000) {
+        baseMs += (int64_t)(rtcMs - countedMs);
+    }
+    sleepStartTime = 0;
+}
+
+} // namespace MonoClock
@@ -0,0 +1,65 @@
+/**
+ * @file MonoClock.h
+ * @brief 64-bit monotonic milliseconds that carry on across resets and sleep.
+ *
+ * @details millis() starts again at every reset and HIBERNATE wake, wraps
+ *          after 49 days, and may not advance in every sleep mode, so a
+ *          millis() value saved to flash means nothing on the next boot.
+ *          nowMs() is System.millis() plus a base that setup() restores
+ *          from sysStatus: the last checkpoint's value plus the RTC time
+ *          since it, so the time the device was off or asleep is counted.
+ *          Without a valid RTC the off time is lost but the clock still
+ *          never goes back.
+ *
+ *          checkpoint() saves the pair before every sleep and deliberate
+ *          reset, and from the persistence task at most every
+ *          MONO_CHECKPOINT_SEC; endSleep()
+ *          adds any RTC time millis() did not count.
+ *
+ *          Use it for any interval whose start is persisted. Times shown
+ *          to people or the cloud stay Unix seconds.
+ *
+ *          Application thread only.
+ */
+
+#ifndef __MONOCLOCK_H
+#define __MONOCLOCK_H
+
+#include "Particle.h"
+
+namespace MonoClock {
+
+/** @brief Least time between checkpoints from the persistence task. */
+static constexpr uint32_t MONO_CHECKPOINT_SEC = 600;
+
+/**
+ * @brief Restore the base from the last checkpoint; call once the RTC has set Time
+ */
+void setup();
+
+/**
+ * @brief Monotonic milliseconds, continuing across resets and sleep
+ */
+uint64_t nowMs();
+
+/**
+ * @brief Save the clock to sysStatus; with @p force false, only every MONO_CHECKPOINT_SEC
+ */
+void checkpoint(bool force = true);
+
+/**
+ * @brief Note the start of a sleep and checkpoint
+ *
+ * @param resets the sleep ends in a reset (HIBERNATE or AB1805 power-down),
+ *        so the checkpoint is written to flash now
+ */
+void beginSleep(bool resets);
+
+/**
+ * @brief Add the RTC time of the sleep that millis() did not count
+ */
+void endSleep();
+
+} // namespace MonoClock
+
+#endif /* __MONOCLOCK_H */
@@ -33,6 +33,12 @@
  */
 
 #include "MyPersistentData.h"
+#include "Config.h"
+#include "ConfigSnapshot.h"
+#include "CounterJournal.h"
+#include "ISensor.h"
+#include "PersistentStore.h"
+#include "TraceLog.h"
 
 // Forward declaration for safe diagnostic publishing (defined in Generalized-Core-Counter.cpp)
 bool publishDiagnosticSafe(const char* eventName, const char* data, PublishFlags flags = PRIVATE);
@@ -73,6 +79,22 @@ void sysStatusData::loop() {
     sysStatus.flush(false);
 }
 
+bool sysStatusData::load() {
+#if PERSISTENT_SINGLE_FILE
+    return PersistentStore::instance().loadSection(*this, PersistentStore::SECTION_SYS, &sysData.sysHeader, sizeof(SysData));
+#else
+    return PersistentDataFile::load();
+#endif
+}
+
+void sysStatusData::save() {
+#if PERSISTENT_SINGLE_FILE
+    PersistentStore::instance().saveSection(*this, PersistentStore::SECTION_SYS);
+#else
+    PersistentDataFile::save();
+#endif
+}
+
 bool sysStatusData::validate(size_t dataSize) {
     bool valid = PersistentDataFile::validate(dataSize);
     if (valid) {
@@ -100,6 +122,32 @@ bool sysStatusData::validate(size_t dataSize) {
     return valid;
 }
 
+void sysStatusData::initializeAppended(size_t oldSize) {
+    // Appended fields read as zero; these have a different default in initialize()
+    if (oldSize <= offsetof(SysData, reportSocDelta)) {
+        sysData.reportSocDelta = 2;
+    }
+    if (oldSize <= offsetof(SysData, reportTempDelta)) {
+        sysData.reportTempDelta = 2;
+    }
+    if (oldSize <= offsetof(SysData, powerGovernorMaxTier)) {
+        sysData.powerGovernorMaxTier = 3;
+    }
+    if (oldSize <= offsetof(SysData, socAtDayStart)) {
+        sysData.socAtDayStart = -1.0f;
+    }
+    if (oldSize <= offsetof(SysData, wakeCorrectionMs)) {
+        sysData.wakeCorrectionMs = WAKE_CORRECTION_INITIAL_MS;
+    }
+    if (oldSize <= offsetof(SysData, slotWidthSec)) {
+        sysData.slotWidthSec = REPORT_SLOT_WIDTH_SEC;
+    }
+    if (oldSize <= offsetof(SysData, reportFields)) {
+        sysData.reportFields = REPORT_FIELDS_DEFAULT;
+        sysData.reportSchema = REPORT_SCHEMA_VERSION;
+    }
+}
+
 void sysStatusData::initialize() {
     PersistentDataFile::initialize();
 
@@ -128,6 +176,90 @@ void sysStatusData::initialize() {
     sysStatus.set_connectAttemptBudgetSec(300);                            // Default 300s (5 minutes) max connect attempt per wake
     sysStatus.set_cloudDisconnectBudgetSec(15);                            // Default 15s max wait for cloud disconnect
     sysStatus.set_modemOffBudgetSec(30);                                   // Default 30s max wait for modem power-down
+    sysStatus.set_reportHeartbeatHours(0);                                 // Default: send every hourly report
+    sysStatus.set_reportSocDelta(2);                                       // 2% SoC change counts as a change
+    sysStatus.set_reportTempDelta(2);                                      // 2 C temperature change counts as a change
+    sysStatus.set_configHashDefaults(0);                                   // No ledger configuration applied yet
+    sysStatus.set_configHashDevice(0);
+    sysStatus.set_deviceStatusHash(0);                                     // device-status not written yet
+    sysStatus.set_deviceDataHash(0);                                       // device-data not written yet
+    for (size_t ii = 0; ii < sizeof(SysData::connectHist) / sizeof(uint16_t); ii++) {
+        sysStatus.set_connectHist(ii, 0);                                  // No connect history yet
+    }
+    sysStatus.set_connectFailures(0);
+    sysStatus.set_connectFailStreak(0);
+    sysStatus.set_signalDeferSince(0);                                     // Not deferring for weak signal
+    sysStatus.set_powerGovernorMaxTier(3);                                 // Governor may go as far as store-only
+    sysStatus.set_powerTier(0);
+    sysStatus.set_socSlopeTenths(0);
+    sysStatus.set_socAtDayStart(-1.0f);                                    // No daily SoC sample yet
+    sysStatus.set_chargedToday(false);
+    for (size_t ii = 0; ii < sizeof(SysData::netBssid); ii++) {
+        sysStatus.set_netBssid(ii, 0);                                     // No network cached yet
+    }
+    sysStatus.set_netLocalIp(0);
+    sysStatus.set_nextLocalMidnight(0);                                    // Computed at the first report
+    for (size_t ii = 0; ii < sizeof(SysData::weekSchedule); ii++) {
+        sysStatus.set_weekSchedule(ii, 0);                                 // No weekly schedule; openTime/closeTime apply
+    }
+    sysStatus.set_otaDeferSince(0);                                        // Not deferring a firmware update
+    sysStatus.set_otaDeferReason(0);
+    sysStatus.set_clockDriftPpm10(0);                                      // No clock drift model yet; sync daily until one forms
+    sysStatus.set_clockUncertaintyPpm10(0);
+    sysStatus.set_clockBaseTime(0);
+    sysStatus.set_clockBaseErrorMs(0);
+    sysStatus.set_clockCorrectionSec(0);
+    sysStatus.set_rtcSetTime(0);
+    sysStatus.set_rtcDriftPpm10(0);
+    sysStatus.set_rtcUncertaintyPpm10(0);
+    sysStatus.set_archiveUploadDay(0);                                     // Upload the event archive from its oldest day
+    sysStatus.set_archiveUploadOffset(0);
+    sysStatus.set_liveCountSec(0);                                         // No live count updates; hourly reports only
+    sysStatus.set_occupancyNotifySec(0);                                   // No occupancy change events
+    for (size_t ii = 0; ii < sizeof(SysData::recoveryAttempts) / sizeof(uint16_t); ii++) {
+        sysStatus.set_recoveryAttempts(ii, 0);                             // No ERROR_STATE recoveries yet
+        sysStatus.set_recoveryRepeats(ii, 0);
+    }
+    sysStatus.set_lastRecoveryLevel(0);
+    sysStatus.set_lastRecoveryAlert(0);
+    sysStatus.set_lastRecoveryTime(0);
+    sysStatus.set_connectBackoffUntil(0);                                  // Not backing off connects
+    sysStatus.set_reportSeq(0);                                            // First report is sequence 1
+    for (size_t ii = 0; ii < sizeof(SysData::unackedSeq) / sizeof(uint32_t); ii++) {
+        sysStatus.set_unackedSeq(ii, 0);                                   // No reports awaiting a webhook response
+        sysStatus.set_unackedHour(ii, 0);
+    }
+    sysStatus.set_reportsResent(0);
+    sysStatus.set_reportsLost(0);
+    sysStatus.set_reportsUntracked(0);
+    sysStatus.set_dataDelivery(DELIVER_BOTH);                              // Webhook and device-data ledger
+    sysStatus.set_lastConnectDataLedger(0);
+    sysStatus.set_coldDeferSince(0);                                       // Not deferring for cold
+    sysStatus.set_coldDeferrals(0);
+    sysStatus.set_policyVariant(0);                                        // Control policy
+    for (size_t ii = 0; ii < sizeof(SysData::configSectionHash) / sizeof(uint32_t); ii++) {
+        sysStatus.set_configSectionHash(ii, 0);                            // Every section applies at the first merge
+    }
+    sysStatus.set_bucketSec(0);                                            // One count per report, no buckets
+    sysStatus.set_monoSavedMs(0);                                          // MonoClock starts from zero
+    sysStatus.set_monoSavedTime(0);
+    sysStatus.set_configCheckTime(0);                                      // First LOW_POWER connect merges the settings ledgers
+    sysStatus.set_configVersionHash(0);
+    sysStatus.set_reportFields(REPORT_FIELDS_DEFAULT);                     // The Ubidots template's fields
+    sysStatus.set_reportSchema(REPORT_SCHEMA_VERSION);
+    sysStatus.set_wakeCorrectionMs(WAKE_CORRECTION_INITIAL_MS);            // The former fixed +1 s margin
+    sysStatus.set_timerWakes(0);
+    sysStatus.set_earlyWakes(0);
+    sysStatus.set_tuneRefractoryMs(0);                                     // The ledger's filter settings as they are
+    sysStatus.set_tuneDebounceMs(0);
+    sysStatus.set_tuneStreak(0);
+    sysStatus.set_tuneSteps(0);
+    sysStatus.set_slotIndex(0);                                            // No site slot: the fleet wake jitter
+    sysStatus.set_slotCount(0);
+    sysStatus.set_slotWidthSec(REPORT_SLOT_WIDTH_SEC);
+    sysStatus.set_slotConnects(0);
+    sysStatus.set_slotMisses(0);
+    sysStatus.set_deviceStatusDiagTime(0);                                 // Diagnostics go with the first device-status write
 }
 
 uint8_t sysStatusData::get_structuresVersion() const {
@@ -144,6 +276,7 @@ bool sysStatusData::get_verboseMode() const {
 
 void sysStatusData::set_verboseMode(bool value) {
     setValue<bool>(offsetof(SysData, verboseMode), value);
+    ConfigSnapshot::publish();
 }
 
 bool sysStatusData::get_solarPowerMode() const  {
@@ -180,6 +313,10 @@ String sysStatusData::get_timeZoneStr() const {
 	return result;
 }
 
+bool sysStatusData::get_timeZoneStr(char *buf, size_t size) const {
+	return getValueString(offsetof(SysData, timeZoneStr), sizeof(SysData::timeZoneStr), buf, size);
+}
+
 bool sysStatusData::set_timeZoneStr(const char *str) {
 	return setValueString(offsetof(SysData, timeZoneStr), sizeof(SysData::timeZoneStr), str);
 }
@@ -231,6 +368,7 @@ uint8_t sysStatusData::get_sensorType() const  {
 }
 void sysStatusData::set_sensorType(uint8_t value) {
     setValue<uint8_t>(offsetof(SysData, sensorType), value);
+    ConfigSnapshot::publish();
 }
 
 bool sysStatusData::get_updatesPending() const  {
@@ -282,6 +420,7 @@ uint8_t sysStatusData::get_countingMode() const {
 }
 void sysStatusData::set_countingMode(uint8_t value) {
     setValue<uint8_t>(offsetof(SysData,countingMode), value);
+    ConfigSnapshot::publish();
 }
 
 uint8_t sysStatusData::get_operatingMode() const {
@@ -289,6 +428,7 @@ uint8_t sysStatusData::get_operatingMode() const {
 }
 void sysStatusData::set_operatingMode(uint8_t value) {
     setValue<uint8_t>(offsetof(SysData,operatingMode), value);
+    ConfigSnapshot::publish();
 }
 
 uint32_t sysStatusData::get_occupancyDebounceMs() const {
@@ -296,6 +436,7 @@ uint32_t sysStatusData::get_occupancyDebounceMs() const {
 }
 void sysStatusData::set_occupancyDebounceMs(uint32_t value) {
     setValue<uint32_t>(offsetof(SysData,occupancyDebounceMs), value);
+    ConfigSnapshot::publish();
 }
 
 uint16_t sysStatusData::get_connectedReportingIntervalSec() const {
@@ -317,6 +458,7 @@ uint16_t sysStatusData::get_connectAttemptBudgetSec() const {
 }
 void sysStatusData::set_connectAttemptBudgetSec(uint16_t value) {
     setValue<uint16_t>(offsetof(SysData,connectAttemptBudgetSec), value);
+    ConfigSnapshot::publish();
 }
 
 uint16_t sysStatusData::get_cloudDisconnectBudgetSec() const {
@@ -333,322 +475,1545 @@ void sysStatusData::set_modemOffBudgetSec(uint16_t value) {
     setValue<uint16_t>(offsetof(SysData,modemOffBudgetSec), value);
 }
 
-// End of sysStatusData class
-
-// *****************  Sensor Config Storage Object *******************
-// 
-// ********************************************************************
-
-const char *persistentDataPathSensor = "/usr/sensor.dat";
+uint8_t sysStatusData::get_reportHeartbeatHours() const {
+    return getValue<uint8_t>(offsetof(SysData,reportHeartbeatHours));
+}
+void sysStatusData::set_reportHeartbeatHours(uint8_t value) {
+    setValue<uint8_t>(offsetof(SysData,reportHeartbeatHours), value);
+}
 
-sensorConfigData *sensorConfigData::_instance;
+uint8_t sysStatusData::get_reportSocDelta() const {
+    return getValue<uint8_t>(offsetof(SysData,reportSocDelta));
+}
+void sysStatusData::set_reportSocDelta(uint8_t value) {
+    setValue<uint8_t>(offsetof(SysData,reportSocDelta), value);
+}
 
-// [static]
-sensorConfigData &sensorConfigData::instance() {
-    if (!_instance) {
-        _instance = new sensorConfigData();
-    }
-    return *_instance;
+uint8_t sysStatusData::get_reportTempDelta() const {
+    return getValue<uint8_t>(offsetof(SysData,reportTempDelta));
+}
+void sysStatusData::set_reportTempDelta(uint8_t value) {
+    setValue<uint8_t>(offsetof(SysData,reportTempDelta), value);
 }
 
-sensorConfigData::sensorConfigData() : StorageHelperRK::PersistentDataFile(persistentDataPathSensor, &sensorData.sensorHeader, sizeof(SensorData), SENSOR_DATA_MAGIC, SENSOR_DATA_VERSION) {
-};
+uint32_t sysStatusData::get_configHashDefaults() const {
+    return getValue<uint32_t>(offsetof(SysData,configHashDefaults));
+}
+void sysStatusData::set_configHashDefaults(uint32_t value) {
+    setValue<uint32_t>(offsetof(SysData,configHashDefaults), value);
+}
 
-sensorConfigData::~sensorConfigData() {
+uint32_t sysStatusData::get_configHashDevice() const {
+    return getValue<uint32_t>(offsetof(SysData,configHashDevice));
+}
+void sysStatusData::set_configHashDevice(uint32_t value) {
+    setValue<uint32_t>(offsetof(SysData,configHashDevice), value);
 }
 
-void sensorConfigData::setup() {
-    sensorConfig
-    //    .withLogData(true)
-        .withSaveDelayMs(250)
-        .load();
+uint32_t sysStatusData::get_deviceStatusHash() const {
+    return getValue<uint32_t>(offsetof(SysData,deviceStatusHash));
+}
+void sysStatusData::set_deviceStatusHash(uint32_t value) {
+    setValue<uint32_t>(offsetof(SysData,deviceStatusHash), value);
 }
 
-void sensorConfigData::loop() {
-    sensorConfig.flush(false);
+uint32_t sysStatusData::get_deviceDataHash() const {
+    return getValue<uint32_t>(offsetof(SysData,deviceDataHash));
+}
+void sysStatusData::set_deviceDataHash(uint32_t value) {
+    setValue<uint32_t>(offsetof(SysData,deviceDataHash), value);
 }
 
-bool sensorConfigData::validate(size_t dataSize) {
-    bool valid = PersistentDataFile::validate(dataSize);
-    if (valid) {
-        if (sensorConfig.get_threshold1() > 100 || sensorConfig.get_threshold2() > 100) {
-            Log.info("Sensor config: thresholds not valid (threshold1=%d, threshold2=%d)", 
-                     sensorConfig.get_threshold1(), sensorConfig.get_threshold2());
-            valid = false;
-        }
+uint16_t sysStatusData::get_connectHist(size_t bucket) const {
+    if (bucket >= sizeof(SysData::connectHist) / sizeof(uint16_t)) {
+        return 0;
     }
-    Log.info("Sensor config is %s", (valid) ? "valid" : "not valid");
-    return valid;
+    return getValue<uint16_t>(offsetof(SysData,connectHist) + bucket * sizeof(uint16_t));
 }
-
-void sensorConfigData::initialize() {
-    PersistentDataFile::initialize();
-
-    Log.info("Current Data Initialized");
-
-    // If you manually update fields here, be sure to update the hash
-    updateHash();
+void sysStatusData::set_connectHist(size_t bucket, uint16_t value) {
+    if (bucket < sizeof(SysData::connectHist) / sizeof(uint16_t)) {
+        setValue<uint16_t>(offsetof(SysData,connectHist) + bucket * sizeof(uint16_t), value);
+    }
 }
 
-uint16_t sensorConfigData::get_threshold1() const {
-    return getValue<uint16_t>(offsetof(SensorData, threshold1));
+uint16_t sysStatusData::get_connectFailures() const {
+    return getValue<uint16_t>(offsetof(SysData,connectFailures));
 }
-
-void sensorConfigData::set_threshold1(uint16_t value) {
-    setValue<uint16_t>(offsetof(SensorData, threshold1), value);
+void sysStatusData::set_connectFailures(uint16_t value) {
+    setValue<uint16_t>(offsetof(SysData,connectFailures), value);
 }
 
-uint16_t sensorConfigData::get_threshold2() const {
-    return getValue<uint16_t>(offsetof(SensorData, threshold2));
+uint8_t sysStatusData::get_connectFailStreak() const {
+    return getValue<uint8_t>(offsetof(SysData,connectFailStreak));
+}
+void sysStatusData::set_connectFailStreak(uint8_t value) {
+    setValue<uint8_t>(offsetof(SysData,connectFailStreak), value);
 }
 
-void sensorConfigData::set_threshold2(uint16_t value) {
-    setValue<uint16_t>(offsetof(SensorData, threshold2), value);
+time_t sysStatusData::get_signalDeferSince() const {
+    return getValue<time_t>(offsetof(SysData,signalDeferSince));
 }
-uint16_t sensorConfigData::get_pollingRate() const {
-    return getValue<uint16_t>(offsetof(SensorData, pollingRate));
+void sysStatusData::set_signalDeferSince(time_t value) {
+    setValue<time_t>(offsetof(SysData,signalDeferSince), value);
 }
 
-void sensorConfigData::set_pollingRate(uint16_t value) {
-    setValue<uint16_t>(offsetof(SensorData, pollingRate), value);
-}  // End of sensorConfigData class
-
-
+uint8_t sysStatusData::get_powerGovernorMaxTier() const {
+    return getValue<uint8_t>(offsetof(SysData,powerGovernorMaxTier));
+}
+void sysStatusData::set_powerGovernorMaxTier(uint8_t value) {
+    setValue<uint8_t>(offsetof(SysData,powerGovernorMaxTier), value);
+}
 
+uint8_t sysStatusData::get_powerTier() const {
+    return getValue<uint8_t>(offsetof(SysData,powerTier));
+}
+void sysStatusData::set_powerTier(uint8_t value) {
+    setValue<uint8_t>(offsetof(SysData,powerTier), value);
+}
 
-// *****************  Current Status Storage Object *******************
-// 
-// ********************************************************************
+int16_t sysStatusData::get_socSlopeTenths() const {
+    return getValue<int16_t>(offsetof(SysData,socSlopeTenths));
+}
+void sysStatusData::set_socSlopeTenths(int16_t value) {
+    setValue<int16_t>(offsetof(SysData,socSlopeTenths), value);
+}
 
-const char *persistentDataPathCurrent = "/usr/current.dat";
+float sysStatusData::get_socAtDayStart() const {
+    return getValue<float>(offsetof(SysData,socAtDayStart));
+}
+void sysStatusData::set_socAtDayStart(float value) {
+    setValue<float>(offsetof(SysData,socAtDayStart), value);
+}
 
-currentStatusData *currentStatusData::_instance;
+bool sysStatusData::get_chargedToday() const {
+    return getValue<bool>(offsetof(SysData,chargedToday));
+}
+void sysStatusData::set_chargedToday(bool value) {
+    setValue<bool>(offsetof(SysData,chargedToday), value);
+}
 
-// [static]
-currentStatusData &currentStatusData::instance() {
-    if (!_instance) {
-        _instance = new currentStatusData();
+uint8_t sysStatusData::get_netBssid(size_t index) const {
+    if (index >= sizeof(SysData::netBssid)) {
+        return 0;
     }
-    return *_instance;
+    return getValue<uint8_t>(offsetof(SysData,netBssid) + index);
 }
-
-currentStatusData::currentStatusData() : StorageHelperRK::PersistentDataFile(persistentDataPathCurrent, &currentData.currentHeader, sizeof(CurrentData), CURRENT_DATA_MAGIC, CURRENT_DATA_VERSION) {
-};
-
-currentStatusData::~currentStatusData() {
+void sysStatusData::set_netBssid(size_t index, uint8_t value) {
+    if (index < sizeof(SysData::netBssid)) {
+        setValue<uint8_t>(offsetof(SysData,netBssid) + index, value);
+    }
 }
 
-void currentStatusData::setup() {
-    current
-    //    .withLogData(true)
-        .withSaveDelayMs(250)
-        .load();
+uint32_t sysStatusData::get_netLocalIp() const {
+    return getValue<uint32_t>(offsetof(SysData,netLocalIp));
 }
-
-void currentStatusData::loop() {
-    current.flush(false);
+void sysStatusData::set_netLocalIp(uint32_t value) {
+    setValue<uint32_t>(offsetof(SysData,netLocalIp), value);
 }
 
-void currentStatusData::resetEverything() {                             // The device is waking up in a new day or is a new install
-  current.set_lastCountTime(Time.now());
-  sysStatus.set_resetCount(0);                                          // Reset the reset count as well
-  
-  // ********** Reset Counting Mode Fields **********
-  current.set_hourlyCount(0);
-  current.set_dailyCount(0);
-  
-  // ********** Reset Occupancy Mode Fields **********
-  current.set_occupied(false);
-  current.set_lastOccupancyEvent(0);
-  current.set_occupancyStartTime(0);
-  current.set_totalOccupiedSeconds(0);
+time_t sysStatusData::get_nextLocalMidnight() const {
+    return getValue<time_t>(offsetof(SysData,nextLocalMidnight));
+}
+void sysStatusData::set_nextLocalMidnight(time_t value) {
+    setValue<time_t>(offsetof(SysData,nextLocalMidnight), value);
 }
 
-bool currentStatusData::validate(size_t dataSize) {
-    bool valid = PersistentDataFile::validate(dataSize);
-    if (valid) {
-        // Basic sanity checks on data
-        if (current.get_hourlyCount() > 10000 || current.get_dailyCount() > 100000) {
-            Log.info("Current: counts appear invalid, resetting");
-            current.set_hourlyCount(0);
-            current.set_dailyCount(0);
-            valid = false;
-        }
+uint8_t sysStatusData::get_weekSchedule(size_t index) const {
+    if (index >= sizeof(SysData::weekSchedule)) {
+        return 0;
     }
-    Log.info("Current data is %s", (valid) ? "valid" : "not valid");
-    return valid;
+    return getValue<uint8_t>(offsetof(SysData,weekSchedule) + index);
 }
-
-void currentStatusData::initialize() {
-    PersistentDataFile::initialize();
-
-    Log.info("Current Data Initialized");
-
-    currentStatusData::resetEverything();
-
-    // If you manually update fields here, be sure to update the hash
-    updateHash();
+void sysStatusData::set_weekSchedule(size_t index, uint8_t value) {
+    if (index < sizeof(SysData::weekSchedule)) {
+        setValue<uint8_t>(offsetof(SysData,weekSchedule) + index, value);
+    }
 }
 
-uint16_t currentStatusData::get_faceNumber() const {
-    return getValue<uint16_t>(offsetof(CurrentData, faceNumber));
+time_t sysStatusData::get_otaDeferSince() const {
+    return getValue<time_t>(offsetof(SysData,otaDeferSince));
 }
-
-void currentStatusData::set_faceNumber(uint16_t value) {
-    setValue<uint16_t>(offsetof(CurrentData, faceNumber), value);
+void sysStatusData::set_otaDeferSince(time_t value) {
+    setValue<time_t>(offsetof(SysData,otaDeferSince), value);
 }
 
-uint16_t currentStatusData::get_faceScore() const {
-    return getValue<uint16_t>(offsetof(CurrentData, faceScore));
+uint8_t sysStatusData::get_otaDeferReason() const {
+    return getValue<uint8_t>(offsetof(SysData,otaDeferReason));
+}
+void sysStatusData::set_otaDeferReason(uint8_t value) {
+    setValue<uint8_t>(offsetof(SysData,otaDeferReason), value);
 }
 
-void currentStatusData::set_faceScore(uint16_t value) {
-    setValue<uint16_t>(offsetof(CurrentData, faceScore), value);
+int16_t sysStatusData::get_clockDriftPpm10() const {
+    return getValue<int16_t>(offsetof(SysData,clockDriftPpm10));
 }
-uint16_t currentStatusData::get_gestureType() const {
-    return getValue<uint16_t>(offsetof(CurrentData, gestureType));
+void sysStatusData::set_clockDriftPpm10(int16_t value) {
+    setValue<int16_t>(offsetof(SysData,clockDriftPpm10), value);
 }
 
-void currentStatusData::set_gestureType(uint16_t value) {
-    setValue<uint16_t>(offsetof(CurrentData, gestureType), value);
+uint16_t sysStatusData::get_clockUncertaintyPpm10() const {
+    return getValue<uint16_t>(offsetof(SysData,clockUncertaintyPpm10));
 }
-
-uint16_t currentStatusData::get_gestureScore() const {
-    return getValue<uint16_t>(offsetof(CurrentData, gestureScore));
+void sysStatusData::set_clockUncertaintyPpm10(uint16_t value) {
+    setValue<uint16_t>(offsetof(SysData,clockUncertaintyPpm10), value);
 }
 
-void currentStatusData::set_gestureScore(uint16_t value) {
-    setValue<uint16_t>(offsetof(CurrentData, gestureScore), value);
+time_t sysStatusData::get_clockBaseTime() const {
+    return getValue<time_t>(offsetof(SysData,clockBaseTime));
 }
-
-time_t currentStatusData::get_lastCountTime() const {
-    return getValue<time_t>(offsetof(CurrentData, lastCountTime));
+void sysStatusData::set_clockBaseTime(time_t value) {
+    setValue<time_t>(offsetof(SysData,clockBaseTime), value);
 }
 
-void currentStatusData::set_lastCountTime(time_t value) {
-    setValue<time_t>(offsetof(CurrentData, lastCountTime), value);
+uint32_t sysStatusData::get_clockBaseErrorMs() const {
+    return getValue<uint32_t>(offsetof(SysData,clockBaseErrorMs));
+}
+void sysStatusData::set_clockBaseErrorMs(uint32_t value) {
+    setValue<uint32_t>(offsetof(SysData,clockBaseErrorMs), value);
 }
 
-float currentStatusData::get_internalTempC() const {
-    return getValue<float>(offsetof(CurrentData, internalTempC));
+int16_t sysStatusData::get_clockCorrectionSec() const {
+    return getValue<int16_t>(offsetof(SysData,clockCorrectionSec));
+}
+void sysStatusData::set_clockCorrectionSec(int16_t value) {
+    setValue<int16_t>(offsetof(SysData,clockCorrectionSec), value);
 }
 
-void currentStatusData::set_internalTempC(float value) {
-    setValue<float>(offsetof(CurrentData, internalTempC), value);
+time_t sysStatusData::get_rtcSetTime() const {
+    return getValue<time_t>(offsetof(SysData,rtcSetTime));
+}
+void sysStatusData::set_rtcSetTime(time_t value) {
+    setValue<time_t>(offsetof(SysData,rtcSetTime), value);
 }
 
-float currentStatusData::get_externalTempC() const {
-    return getValue<float>(offsetof(CurrentData, externalTempC));
+int16_t sysStatusData::get_rtcDriftPpm10() const {
+    return getValue<int16_t>(offsetof(SysData,rtcDriftPpm10));
+}
+void sysStatusData::set_rtcDriftPpm10(int16_t value) {
+    setValue<int16_t>(offsetof(SysData,rtcDriftPpm10), value);
 }
 
-void currentStatusData::set_externalTempC(float value) {
-    setValue<float>(offsetof(CurrentData, externalTempC), value);
+uint16_t sysStatusData::get_rtcUncertaintyPpm10() const {
+    return getValue<uint16_t>(offsetof(SysData,rtcUncertaintyPpm10));
+}
+void sysStatusData::set_rtcUncertaintyPpm10(uint16_t value) {
+    setValue<uint16_t>(offsetof(SysData,rtcUncertaintyPpm10), value);
 }
 
-int8_t currentStatusData::get_alertCode() const {
-    return getValue<int8_t>(offsetof(CurrentData, alertCode));
+uint32_t sysStatusData::get_archiveUploadDay() const {
+    return getValue<uint32_t>(offsetof(SysData,archiveUploadDay));
+}
+void sysStatusData::set_archiveUploadDay(uint32_t value) {
+    setValue<uint32_t>(offsetof(SysData,archiveUploadDay), value);
 }
 
-void currentStatusData::set_alertCode(int8_t value) {
-    setValue<int8_t>(offsetof(CurrentData, alertCode), value);
+uint32_t sysStatusData::get_archiveUploadOffset() const {
+    return getValue<uint32_t>(offsetof(SysData,archiveUploadOffset));
+}
+void sysStatusData::set_archiveUploadOffset(uint32_t value) {
+    setValue<uint32_t>(offsetof(SysData,archiveUploadOffset), value);
 }
 
-time_t currentStatusData::get_lastAlertTime() const {
-    // lastAlertTime is stored as time_t in CurrentData; retrieve with correct type
-    return getValue<time_t>(offsetof(CurrentData,lastAlertTime));
+uint16_t sysStatusData::get_liveCountSec() const {
+    return getValue<uint16_t>(offsetof(SysData,liveCountSec));
+}
+void sysStatusData::set_liveCountSec(uint16_t value) {
+    setValue<uint16_t>(offsetof(SysData,liveCountSec), value);
 }
 
-void currentStatusData::set_lastAlertTime(time_t value) {
-    setValue<time_t>(offsetof(CurrentData,lastAlertTime),value);
+uint16_t sysStatusData::get_occupancyNotifySec() const {
+    return getValue<uint16_t>(offsetof(SysData,occupancyNotifySec));
+}
+void sysStatusData::set_occupancyNotifySec(uint16_t value) {
+    setValue<uint16_t>(offsetof(SysData,occupancyNotifySec), value);
 }
 
-// Local helper to convert an alert code into a coarse severity bucket.
-// Higher numbers indicate more severe conditions.
-static int getAlertSeverity(int8_t code) {
-    if (code <= 0) {
-        return 0; // no alert
+uint16_t sysStatusData::get_recoveryAttempts(size_t level) const {
+    if (level >= sizeof(SysData::recoveryAttempts) / sizeof(uint16_t)) {
+        return 0;
     }
-
-    // Map known codes into tiers. This is intentionally simple and can be
-    // extended as new alert codes are added over time.
-    switch (code) {
-        case 14: // out-of-memory
-        case 15: // modem / disconnect failure
-        case 16: // repeated sleep failures (HIBERNATE / ULP)
-        case 20: // PMIC thermal shutdown (critical battery/charging fault)
-        case 21: // PMIC charge timeout / stuck charging
-            return 3; // critical
-
-        case 23: // PMIC battery fault (general)
-        case 30: // connectivity timeout with radio up
-        case 31: // failed to connect to cloud
-        case 32: // connect taking too long
-        case 40: // repeated webhook failures
-        case 41: // configuration/ledger apply failure
-        case 42: // data ledger publish failure
-        case 43: // publish queue not drained before forced sleep
-            return 2; // major
-        default:
-            return 1; // minor / warning
+    return getValue<uint16_t>(offsetof(SysData,recoveryAttempts) + level * sizeof(uint16_t));
+}
+void sysStatusData::set_recoveryAttempts(size_t level, uint16_t value) {
+    if (level < sizeof(SysData::recoveryAttempts) / sizeof(uint16_t)) {
+        setValue<uint16_t>(offsetof(SysData,recoveryAttempts) + level * sizeof(uint16_t), value);
     }
 }
 
-void currentStatusData::raiseAlert(int8_t value) {
-    if (value <= 0) {
-        return; // ignore attempts to "raise" a non-alert here
+uint16_t sysStatusData::get_recoveryRepeats(size_t level) const {
+    if (level >= sizeof(SysData::recoveryRepeats) / sizeof(uint16_t)) {
+        return 0;
     }
-
-    int8_t existing = get_alertCode();
-    if (getAlertSeverity(value) > getAlertSeverity(existing)) {
-        set_alertCode(value);
-        set_lastAlertTime(Time.now());
+    return getValue<uint16_t>(offsetof(SysData,recoveryRepeats) + level * sizeof(uint16_t));
+}
+void sysStatusData::set_recoveryRepeats(size_t level, uint16_t value) {
+    if (level < sizeof(SysData::recoveryRepeats) / sizeof(uint16_t)) {
+        setValue<uint16_t>(offsetof(SysData,recoveryRepeats) + level * sizeof(uint16_t), value);
     }
 }
 
-float currentStatusData::get_stateOfCharge() const  {
-    return getValue<float>(offsetof(CurrentData,stateOfCharge));
+uint8_t sysStatusData::get_lastRecoveryLevel() const {
+    return getValue<uint8_t>(offsetof(SysData,lastRecoveryLevel));
 }
-void currentStatusData::set_stateOfCharge(float value) {
-    setValue<float>(offsetof(CurrentData, stateOfCharge), value);
+void sysStatusData::set_lastRecoveryLevel(uint8_t value) {
+    setValue<uint8_t>(offsetof(SysData,lastRecoveryLevel), value);
 }
 
-uint8_t currentStatusData::get_batteryState() const  {
-    return getValue<uint8_t>(offsetof(CurrentData, batteryState));
+uint8_t sysStatusData::get_lastRecoveryAlert() const {
+    return getValue<uint8_t>(offsetof(SysData,lastRecoveryAlert));
 }
-void currentStatusData::set_batteryState(uint8_t value) {
-    setValue<uint8_t>(offsetof(CurrentData, batteryState), value);
+void sysStatusData::set_lastRecoveryAlert(uint8_t value) {
+    setValue<uint8_t>(offsetof(SysData,lastRecoveryAlert), value);
 }
 
-// ********** Counting Mode Get/Set Functions **********
-
-uint16_t currentStatusData::get_hourlyCount() const {
-    return getValue<uint16_t>(offsetof(CurrentData, hourlyCount));
+time_t sysStatusData::get_lastRecoveryTime() const {
+    return getValue<time_t>(offsetof(SysData,lastRecoveryTime));
 }
-void currentStatusData::set_hourlyCount(uint16_t value) {
-    setValue<uint16_t>(offsetof(CurrentData, hourlyCount), value);
+void sysStatusData::set_lastRecoveryTime(time_t value) {
+    setValue<time_t>(offsetof(SysData,lastRecoveryTime), value);
 }
 
-uint16_t currentStatusData::get_dailyCount() const {
-    return getValue<uint16_t>(offsetof(CurrentData, dailyCount));
+time_t sysStatusData::get_connectBackoffUntil() const {
+    return getValue<time_t>(offsetof(SysData,connectBackoffUntil));
 }
-void currentStatusData::set_dailyCount(uint16_t value) {
-    setValue<uint16_t>(offsetof(CurrentData, dailyCount), value);
+void sysStatusData::set_connectBackoffUntil(time_t value) {
+    setValue<time_t>(offsetof(SysData,connectBackoffUntil), value);
 }
 
-// ********** Occupancy Mode Get/Set Functions **********
-
-bool currentStatusData::get_occupied() const {
-    return getValue<bool>(offsetof(CurrentData, occupied));
+uint32_t sysStatusData::get_reportSeq() const {
+    return getValue<uint32_t>(offsetof(SysData,reportSeq));
 }
-void currentStatusData::set_occupied(bool value) {
-    setValue<bool>(offsetof(CurrentData, occupied), value);
+void sysStatusData::set_reportSeq(uint32_t value) {
+    setValue<uint32_t>(offsetof(SysData,reportSeq), value);
 }
 
-uint32_t currentStatusData::get_lastOccupancyEvent() const {
-    return getValue<uint32_t>(offsetof(CurrentData, lastOccupancyEvent));
+uint32_t sysStatusData::get_unackedSeq(size_t index) const {
+    if (index >= sizeof(SysData::unackedSeq) / sizeof(uint32_t)) {
+        return 0;
+    }
+    return getValue<uint32_t>(offsetof(SysData,unackedSeq) + index * sizeof(uint32_t));
 }
-void currentStatusData::set_lastOccupancyEvent(uint32_t value) {
-    setValue<uint32_t>(offsetof(CurrentData, lastOccupancyEvent), value);
+void sysStatusData::set_unackedSeq(size_t index, uint32_t value) {
+    if (index < sizeof(SysData::unackedSeq) / sizeof(uint32_t)) {
+        setValue<uint32_t>(offsetof(SysData,unackedSeq) + index * sizeof(uint32_t), value);
+    }
+}
+
+uint32_t sysStatusData::get_unackedHour(size_t index) const {
+    if (index >= sizeof(SysData::unackedHour) / sizeof(uint32_t)) {
+        return 0;
+    }
+    return getValue<uint32_t>(offsetof(SysData,unackedHour) + index * sizeof(uint32_t));
+}
+void sysStatusData::set_unackedHour(size_t index, uint32_t value) {
+    if (index < sizeof(SysData::unackedHour) / sizeof(uint32_t)) {
+        setValue<uint32_t>(offsetof(SysData,unackedHour) + index * sizeof(uint32_t), value);
+    }
+}
+
+uint16_t sysStatusData::get_reportsResent() const {
+    return getValue<uint16_t>(offsetof(SysData,reportsResent));
+}
+void sysStatusData::set_reportsResent(uint16_t value) {
+    setValue<uint16_t>(offsetof(SysData,reportsResent), value);
+}
+
+uint16_t sysStatusData::get_reportsLost() const {
+    return getValue<uint16_t>(offsetof(SysData,reportsLost));
+}
+void sysStatusData::set_reportsLost(uint16_t value) {
+    setValue<uint16_t>(offsetof(SysData,reportsLost), value);
+}
+
+uint16_t sysStatusData::get_reportsUntracked() const {
+    return getValue<uint16_t>(offsetof(SysData,reportsUntracked));
+}
+void sysStatusData::set_reportsUntracked(uint16_t value) {
+    setValue<uint16_t>(offsetof(SysData,reportsUntracked), value);
+}
+
+uint8_t sysStatusData::get_dataDelivery() const {
+    return getValue<uint8_t>(offsetof(SysData,dataDelivery));
+}
+void sysStatusData::set_dataDelivery(uint8_t value) {
+    setValue<uint8_t>(offsetof(SysData,dataDelivery), value);
+}
+
+time_t sysStatusData::get_lastConnectDataLedger() const {
+    return getValue<time_t>(offsetof(SysData,lastConnectDataLedger));
+}
+void sysStatusData::set_lastConnectDataLedger(time_t value) {
+    setValue<time_t>(offsetof(SysData,lastConnectDataLedger), value);
+}
+
+time_t sysStatusData::get_coldDeferSince() const {
+    return getValue<time_t>(offsetof(SysData,coldDeferSince));
+}
+void sysStatusData::set_coldDeferSince(time_t value) {
+    setValue<time_t>(offsetof(SysData,coldDeferSince), value);
+}
+
+uint16_t sysStatusData::get_coldDeferrals() const {
+    return getValue<uint16_t>(offsetof(SysData,coldDeferrals));
+}
+void sysStatusData::set_coldDeferrals(uint16_t value) {
+    setValue<uint16_t>(offsetof(SysData,coldDeferrals), value);
+}
+
+uint8_t sysStatusData::get_policyVariant() const {
+    return getValue<uint8_t>(offsetof(SysData,policyVariant));
+}
+void sysStatusData::set_policyVariant(uint8_t value) {
+    setValue<uint8_t>(offsetof(SysData,policyVariant), value);
+    ConfigSnapshot::publish();
+}
+
+uint32_t sysStatusData::get_configSectionHash(size_t section) const {
+    if (section >= sizeof(SysData::configSectionHash) / sizeof(uint32_t)) {
+        return 0;
+    }
+    return getValue<uint32_t>(offsetof(SysData,configSectionHash) + section * sizeof(uint32_t));
+}
+void sysStatusData::set_configSectionHash(size_t section, uint32_t value) {
+    if (section < sizeof(SysData::configSectionHash) / sizeof(uint32_t)) {
+        setValue<uint32_t>(offsetof(SysData,configSectionHash) + section * sizeof(uint32_t), value);
+    }
+}
+
+uint16_t sysStatusData::get_bucketSec() const {
+    return getValue<uint16_t>(offsetof(SysData,bucketSec));
+}
+void sysStatusData::set_bucketSec(uint16_t value) {
+    setValue<uint16_t>(offsetof(SysData,bucketSec), value);
+}
+
+uint64_t sysStatusData::get_monoSavedMs() const {
+    return getValue<uint64_t>(offsetof(SysData,monoSavedMs));
+}
+void sysStatusData::set_monoSavedMs(uint64_t value) {
+    setValue<uint64_t>(offsetof(SysData,monoSavedMs), value);
+}
+
+time_t sysStatusData::get_monoSavedTime() const {
+    return getValue<time_t>(offsetof(SysData,monoSavedTime));
+}
+void sysStatusData::set_monoSavedTime(time_t value) {
+    setValue<time_t>(offsetof(SysData,monoSavedTime), value);
+}
+
+time_t sysStatusData::get_configCheckTime() const {
+    return getValue<time_t>(offsetof(SysData,configCheckTime));
+}
+void sysStatusData::set_configCheckTime(time_t value) {
+    setValue<time_t>(offsetof(SysData,configCheckTime), value);
+}
+
+uint32_t sysStatusData::get_configVersionHash() const {
+    return getValue<uint32_t>(offsetof(SysData,configVersionHash));
+}
+void sysStatusData::set_configVersionHash(uint32_t value) {
+    setValue<uint32_t>(offsetof(SysData,configVersionHash), value);
+}
+
+uint32_t sysStatusData::get_reportFields() const {
+    return getValue<uint32_t>(offsetof(SysData,reportFields));
+}
+void sysStatusData::set_reportFields(uint32_t value) {
+    setValue<uint32_t>(offsetof(SysData,reportFields), value);
+}
+
+uint8_t sysStatusData::get_reportSchema() const {
+    return getValue<uint8_t>(offsetof(SysData,reportSchema));
+}
+void sysStatusData::set_reportSchema(uint8_t value) {
+    setValue<uint8_t>(offsetof(SysData,reportSchema), value);
+}
+
+int16_t sysStatusData::get_wakeCorrectionMs() const {
+    return getValue<int16_t>(offsetof(SysData,wakeCorrectionMs));
+}
+void sysStatusData::set_wakeCorrectionMs(int16_t value) {
+    setValue<int16_t>(offsetof(SysData,wakeCorrectionMs), value);
+}
+
+uint16_t sysStatusData::get_timerWakes() const {
+    return getValue<uint16_t>(offsetof(SysData,timerWakes));
+}
+void sysStatusData::set_timerWakes(uint16_t value) {
+    setValue<uint16_t>(offsetof(SysData,timerWakes), value);
+}
+
+uint16_t sysStatusData::get_earlyWakes() const {
+    return getValue<uint16_t>(offsetof(SysData,earlyWakes));
+}
+void sysStatusData::set_earlyWakes(uint16_t value) {
+    setValue<uint16_t>(offsetof(SysData,earlyWakes), value);
+}
+
+int16_t sysStatusData::get_tuneRefractoryMs() const {
+    return getValue<int16_t>(offsetof(SysData,tuneRefractoryMs));
+}
+void sysStatusData::set_tuneRefractoryMs(int16_t value) {
+    setValue<int16_t>(offsetof(SysData,tuneRefractoryMs), value);
+    ConfigSnapshot::publish();
+}
+
+int16_t sysStatusData::get_tuneDebounceMs() const {
+    return getValue<int16_t>(offsetof(SysData,tuneDebounceMs));
+}
+void sysStatusData::set_tuneDebounceMs(int16_t value) {
+    setValue<int16_t>(offsetof(SysData,tuneDebounceMs), value);
+    ConfigSnapshot::publish();
+}
+
+int8_t sysStatusData::get_tuneStreak() const {
+    return getValue<int8_t>(offsetof(SysData,tuneStreak));
+}
+void sysStatusData::set_tuneStreak(int8_t value) {
+    setValue<int8_t>(offsetof(SysData,tuneStreak), value);
+}
+
+uint16_t sysStatusData::get_tuneSteps() const {
+    return getValue<uint16_t>(offsetof(SysData,tuneSteps));
+}
+void sysStatusData::set_tuneSteps(uint16_t value) {
+    setValue<uint16_t>(offsetof(SysData,tuneSteps), value);
+}
+
+uint8_t sysStatusData::get_slotIndex() const {
+    return getValue<uint8_t>(offsetof(SysData,slotIndex));
+}
+void sysStatusData::set_slotIndex(uint8_t value) {
+    setValue<uint8_t>(offsetof(SysData,slotIndex), value);
+}
+
+uint8_t sysStatusData::get_slotCount() const {
+    return getValue<uint8_t>(offsetof(SysData,slotCount));
+}
+void sysStatusData::set_slotCount(uint8_t value) {
+    setValue<uint8_t>(offsetof(SysData,slotCount), value);
+}
+
+uint16_t sysStatusData::get_slotWidthSec() const {
+    return getValue<uint16_t>(offsetof(SysData,slotWidthSec));
+}
+void sysStatusData::set_slotWidthSec(uint16_t value) {
+    setValue<uint16_t>(offsetof(SysData,slotWidthSec), value);
+}
+
+uint16_t sysStatusData::get_slotConnects() const {
+    return getValue<uint16_t>(offsetof(SysData,slotConnects));
+}
+void sysStatusData::set_slotConnects(uint16_t value) {
+    setValue<uint16_t>(offsetof(SysData,slotConnects), value);
+}
+
+uint16_t sysStatusData::get_slotMisses() const {
+    return getValue<uint16_t>(offsetof(SysData,slotMisses));
+}
+void sysStatusData::set_slotMisses(uint16_t value) {
+    setValue<uint16_t>(offsetof(SysData,slotMisses), value);
+}
+
+time_t sysStatusData::get_deviceStatusDiagTime() const {
+    return getValue<time_t>(offsetof(SysData,deviceStatusDiagTime));
+}
+void sysStatusData::set_deviceStatusDiagTime(time_t value) {
+    setValue<time_t>(offsetof(SysData,deviceStatusDiagTime), value);
+}
+
+// End of sysStatusData class
+
+// *****************  Sensor Config Storage Object *******************
+// 
+// ********************************************************************
+
+const char *persistentDataPathSensor = "/usr/sensor.dat";
+
+sensorConfigData *sensorConfigData::_instance;
+
+// [static]
+sensorConfigData &sensorConfigData::instance() {
+    if (!_instance) {
+        _instance = new sensorConfigData();
+    }
+    return *_instance;
+}
+
+sensorConfigData::sensorConfigData() : StorageHelperRK::PersistentDataFile(persistentDataPathSensor, &sensorData.sensorHeader, sizeof(SensorData), SENSOR_DATA_MAGIC, SENSOR_DATA_VERSION) {
+};
+
+sensorConfigData::~sensorConfigData() {
+}
+
+void sensorConfigData::setup() {
+    sensorConfig
+    //    .withLogData(true)
+        .withSaveDelayMs(250)
+        .load();
+}
+
+void sensorConfigData::loop() {
+    sensorConfig.flush(false);
+}
+
+bool sensorConfigData::load() {
+#if PERSISTENT_SINGLE_FILE
+    return PersistentStore::instance().loadSection(*this, PersistentStore::SECTION_SENSOR, &sensorData.sensorHeader, sizeof(SensorData));
+#else
+    return PersistentDataFile::load();
+#endif
+}
+
+void sensorConfigData::save() {
+#if PERSISTENT_SINGLE_FILE
+    PersistentStore::instance().saveSection(*this, PersistentStore::SECTION_SENSOR);
+#else
+    PersistentDataFile::save();
+#endif
+}
+
+bool sensorConfigData::validate(size_t dataSize) {
+    bool valid = PersistentDataFile::validate(dataSize);
+    if (valid) {
+        if (sensorConfig.get_threshold1() > 100 || sensorConfig.get_threshold2() > 100) {
+            Log.info("Sensor config: thresholds not valid (threshold1=%d, threshold2=%d)", 
+                     sensorConfig.get_threshold1(), sensorConfig.get_threshold2());
+            valid = false;
+        }
+        if (valid && sensorConfig.get_filterDefaultsVersion() == 0) {
+            Log.info("Sensor config: applying event filter defaults");
+            setFilterDefaults();
+        } else if (valid && sensorConfig.get_filterDefaultsVersion() == 1) {
+            Log.info("Sensor config: applying auto-tune defaults");
+            setTuneDefaults();
+        }
+    }
+    Log.info("Sensor config is %s", (valid) ? "valid" : "not valid");
+    return valid;
+}
+
+void sensorConfigData::initialize() {
+    PersistentDataFile::initialize();
+
+    Log.info("Current Data Initialized");
+    setFilterDefaults();
+    set_groupBaseMs(0);                 // No people estimate until the site is calibrated
+    set_groupStepMs(0);
+
+    // If you manually update fields here, be sure to update the hash
+    updateHash();
+}
+
+uint16_t sensorConfigData::get_threshold1() const {
+    return getValue<uint16_t>(offsetof(SensorData, threshold1));
+}
+
+void sensorConfigData::set_threshold1(uint16_t value) {
+    setValue<uint16_t>(offsetof(SensorData, threshold1), value);
+    ConfigSnapshot::publish();
+}
+
+uint16_t sensorConfigData::get_threshold2() const {
+    return getValue<uint16_t>(offsetof(SensorData, threshold2));
+}
+
+void sensorConfigData::set_threshold2(uint16_t value) {
+    setValue<uint16_t>(offsetof(SensorData, threshold2), value);
+    ConfigSnapshot::publish();
+}
+uint16_t sensorConfigData::get_pollingRate() const {
+    return getValue<uint16_t>(offsetof(SensorData, pollingRate));
+}
+
+void sensorConfigData::set_pollingRate(uint16_t value) {
+    setValue<uint16_t>(offsetof(SensorData, pollingRate), value);
+    ConfigSnapshot::publish();
+}
+
+uint16_t sensorConfigData::get_debounceMs() const {
+    return getValue<uint16_t>(offsetof(SensorData, debounceMs));
+}
+
+void sensorConfigData::set_debounceMs(uint16_t value) {
+    setValue<uint16_t>(offsetof(SensorData, debounceMs), value);
+    ConfigSnapshot::publish();
+}
+
+uint16_t sensorConfigData::get_refractoryMs() const {
+    return getValue<uint16_t>(offsetof(SensorData, refractoryMs));
+}
+
+void sensorConfigData::set_refractoryMs(uint16_t value) {
+    setValue<uint16_t>(offsetof(SensorData, refractoryMs), value);
+    ConfigSnapshot::publish();
+}
+
+uint16_t sensorConfigData::get_minPulseMs() const {
+    return getValue<uint16_t>(offsetof(SensorData, minPulseMs));
+}
+
+void sensorConfigData::set_minPulseMs(uint16_t value) {
+    setValue<uint16_t>(offsetof(SensorData, minPulseMs), value);
+    ConfigSnapshot::publish();
+}
+
+uint8_t sensorConfigData::get_maxEventsPerSec() const {
+    return getValue<uint8_t>(offsetof(SensorData, maxEventsPerSec));
+}
+
+void sensorConfigData::set_maxEventsPerSec(uint8_t value) {
+    setValue<uint8_t>(offsetof(SensorData, maxEventsPerSec), value);
+    ConfigSnapshot::publish();
+}
+
+uint8_t sensorConfigData::get_filterDefaultsVersion() const {
+    return getValue<uint8_t>(offsetof(SensorData, filterDefaultsVersion));
+}
+
+void sensorConfigData::set_filterDefaultsVersion(uint8_t value) {
+    setValue<uint8_t>(offsetof(SensorData, filterDefaultsVersion), value);
+}
+
+uint16_t sensorConfigData::get_groupBaseMs() const {
+    return getValue<uint16_t>(offsetof(SensorData, groupBaseMs));
+}
+
+void sensorConfigData::set_groupBaseMs(uint16_t value) {
+    setValue<uint16_t>(offsetof(SensorData, groupBaseMs), value);
+    ConfigSnapshot::publish();
+}
+
+uint16_t sensorConfigData::get_groupStepMs() const {
+    return getValue<uint16_t>(offsetof(SensorData, groupStepMs));
+}
+
+void sensorConfigData::set_groupStepMs(uint16_t value) {
+    setValue<uint16_t>(offsetof(SensorData, groupStepMs), value);
+    ConfigSnapshot::publish();
+}
+
+bool sensorConfigData::get_autoTune() const {
+    return getValue<uint8_t>(offsetof(SensorData, autoTune)) != 0;
+}
+
+void sensorConfigData::set_autoTune(bool value) {
+    setValue<uint8_t>(offsetof(SensorData, autoTune), value ? 1 : 0);
+    ConfigSnapshot::publish();
+}
+
+uint16_t sensorConfigData::get_tuneMinRefractoryMs() const {
+    return getValue<uint16_t>(offsetof(SensorData, tuneMinRefractoryMs));
+}
+
+void sensorConfigData::set_tuneMinRefractoryMs(uint16_t value) {
+    setValue<uint16_t>(offsetof(SensorData, tuneMinRefractoryMs), value);
+    ConfigSnapshot::publish();
+}
+
+uint16_t sensorConfigData::get_tuneMaxRefractoryMs() const {
+    return getValue<uint16_t>(offsetof(SensorData, tuneMaxRefractoryMs));
+}
+
+void sensorConfigData::set_tuneMaxRefractoryMs(uint16_t value) {
+    setValue<uint16_t>(offsetof(SensorData, tuneMaxRefractoryMs), value);
+    ConfigSnapshot::publish();
+}
+
+uint16_t sensorConfigData::get_tuneMaxDebounceMs() const {
+    return getValue<uint16_t>(offsetof(SensorData, tuneMaxDebounceMs));
+}
+
+void sensorConfigData::set_tuneMaxDebounceMs(uint16_t value) {
+    setValue<uint16_t>(offsetof(SensorData, tuneMaxDebounceMs), value);
+    ConfigSnapshot::publish();
+}
+
+void sensorConfigData::setFilterDefaults() {
+    set_debounceMs(0);
+    set_refractoryMs(500);        // Matches the former hard-coded PIR 500 ms lockout
+    set_minPulseMs(0);
+    set_maxEventsPerSec(0);
+    set_filterDefaultsVersion(1);
+    setTuneDefaults();
+}
+
+void sensorConfigData::setTuneDefaults() {
+    set_autoTune(false);
+    set_tuneMinRefractoryMs(AUTO_TUNE_MIN_REFRACTORY_MS);
+    set_tuneMaxRefractoryMs(AUTO_TUNE_MAX_REFRACTORY_MS);
+    set_tuneMaxDebounceMs(AUTO_TUNE_MAX_DEBOUNCE_MS);
+    set_filterDefaultsVersion(2);
+}  // End of sensorConfigData class
+
+
+
+
+// *****************  Current Status Storage Object *******************
+// 
+// ********************************************************************
+
+const char *persistentDataPathCurrent = "/usr/current.dat";
+
+currentStatusData *currentStatusData::_instance;
+
+// [static]
+currentStatusData &currentStatusData::instance() {
+    if (!_instance) {
+        _instance = new currentStatusData();
+    }
+    return *_instance;
+}
+
+currentStatusData::currentStatusData() : StorageHelperRK::PersistentDataFile(persistentDataPathCurrent, &currentData.currentHeader, sizeof(CurrentData), CURRENT_DATA_MAGIC, CURRENT_DATA_VERSION) {
+};
+
+currentStatusData::~currentStatusData() {
+}
+
+#if COUNTER_RETAINED
+// Retained-RAM copy of the hot counters. It survives soft resets, watchdog
+// resets and ULTRA_LOW_POWER naps (not power loss or HIBERNATE), and is
+// validated with the usual StorageHelperRK magic/version/size/hash header.
+class RetainedCounters : public StorageHelperRK::PersistentDataRetained {
+public:
+    class Data {
+    public:
+        StorageHelperRK::PersistentDataBase::SavedDataHeader header;
+        uint32_t hourlyCount;
+        uint32_t dailyCount;
+        time_t lastCountTime;
+        uint16_t generation;                            // current.dat journalGeneration these counts build on
+    };
+
+    // Version 1, with 16-bit counts
+    class DataV1 {
+    public:
+        StorageHelperRK::PersistentDataBase::SavedDataHeader header;
+        uint16_t hourlyCount;
+        uint16_t dailyCount;
+        time_t lastCountTime;
+        uint16_t generation;
+    };
+
+    RetainedCounters(Data *data) : StorageHelperRK::PersistentDataRetained(&data->header, sizeof(Data), RETAINED_MAGIC, RETAINED_VERSION), data(data) {}
+
+    bool loadedValid = false;                           // true if the retained copy survived the last reset
+
+    bool validate(size_t dataSize) override {
+        loadedValid = PersistentDataRetained::validate(dataSize);
+        return loadedValid;
+    }
+
+    // Counts kept across the reset into firmware with 32-bit counts
+    static void upgradeV1(const uint8_t *from, uint8_t *to) {
+        const DataV1 &v1 = *(const DataV1 *)from;
+        Data &v2 = *(Data *)to;
+        v2.hourlyCount = v1.hourlyCount;
+        v2.dailyCount = v1.dailyCount;
+        v2.lastCountTime = v1.lastCountTime;
+        v2.generation = v1.generation;
+    }
+
+    void store(uint32_t hourly, uint32_t daily, time_t lastCount, uint16_t generation) {
+        auto update = UpdateBatch(*this);
+        setValue<uint32_t>(offsetof(Data, hourlyCount), hourly);
+        setValue<uint32_t>(offsetof(Data, dailyCount), daily);
+        setValue<time_t>(offsetof(Data, lastCountTime), lastCount);
+        setValue<uint16_t>(offsetof(Data, generation), generation);
+    }
+
+    Data *data;
+
+    static const uint32_t RETAINED_MAGIC = 0x5c0a7e11;
+    static const uint16_t RETAINED_VERSION = 2;     // 2: 32-bit counts
+};
+
+static retained RetainedCounters::Data retainedCountersData;
+static RetainedCounters retainedCounters(&retainedCountersData);
+
+static const StorageHelperRK::PersistentDataBase::MigrationStep retainedMigrations[] = {
+    {1, sizeof(RetainedCounters::DataV1), RetainedCounters::upgradeV1},
+};
+
+static bool retainedDirty = false;                     // Counts changed since current.dat was written
+static uint32_t lastCheckpointMs = 0;
+#endif
+
+// current.dat as written by firmware before the counts were widened. Only
+// used to read an old file; never add fields here. Fields after
+// totalOccupiedSeconds were appended within version 1, so a file may end
+// anywhere from there on (CURRENT_V1_MIN_SIZE).
+class CurrentDataV1 {
+public:
+    StorageHelperRK::PersistentDataBase::SavedDataHeader currentHeader;
+    uint16_t faceNumber;
+    uint16_t faceScore;
+    uint16_t gestureType;
+    uint16_t gestureScore;
+    time_t lastCountTime;
+    float internalTempC;
+    float externalTempC;
+    uint8_t alertCode;
+    time_t lastAlertTime;
+    float stateOfCharge;
+    uint8_t batteryState;
+    uint16_t hourlyCount;
+    uint16_t dailyCount;
+    bool occupied;
+    uint32_t lastOccupancyEvent;
+    time_t occupancyStartTime;
+    uint32_t totalOccupiedSeconds;
+    uint16_t journalGeneration;
+    time_t lastPublishedTime;
+    uint16_t lastPublishedDaily;
+    float lastPublishedSoc;
+    float lastPublishedTempC;
+    uint8_t lastPublishedBatteryState;
+    uint8_t lastPublishedAlert;
+    uint8_t lastPublishedResets;
+    uint8_t reportsSuppressed;
+    uint32_t energySec[12];
+    time_t energyHibernateStart;
+    uint8_t countBins[12];
+    uint16_t sessionCount;
+    uint32_t sessionMinSec;
+    uint32_t sessionMaxSec;
+    uint16_t sessionHist[6];
+    time_t peakHourStart;
+    uint32_t peakHourSec;
+    time_t runHourStart;
+    uint32_t runHourSec;
+};
+
+static const uint16_t CURRENT_V1_MIN_SIZE = offsetof(CurrentDataV1, totalOccupiedSeconds) + sizeof(uint32_t);
+
+// Float battery and temperature fields of older files, as scaled integers;
+// anything out of range (or not a number) is taken as 0
+static int16_t centiFromFloat(float tempC) {
+    return (tempC > -300.0f && tempC < 300.0f) ? (int16_t)(tempC * 100.0f + (tempC < 0 ? -0.5f : 0.5f)) : 0;
+}
+
+static uint16_t tenthsFromFloat(float percent) {
+    return (percent > 0.0f && percent <= 100.0f) ? (uint16_t)(percent * 10.0f + 0.5f) : 0;
+}
+
+// Version 1 had 16-bit counts
+static void upgradeCurrentV1(const uint8_t *from, uint8_t *to) {
+    const CurrentDataV1 &v1 = *(const CurrentDataV1 *)from;
+    currentStatusData::CurrentData &v2 = *(currentStatusData::CurrentData *)to;
+
+#define COPY_V1(field) memcpy(&v2.field, &v1.field, sizeof(v1.field))
+    COPY_V1(faceNumber);
+    COPY_V1(faceScore);
+    COPY_V1(gestureType);
+    COPY_V1(gestureScore);
+    COPY_V1(lastCountTime);
+    COPY_V1(externalTempC);
+    COPY_V1(alertCode);
+    COPY_V1(lastAlertTime);
+    COPY_V1(batteryState);
+    COPY_V1(occupied);
+    // lastOccupancyEvent was raw millis(), no use after the reset that loaded it; left 0
+    COPY_V1(occupancyStartTime);
+    COPY_V1(totalOccupiedSeconds);
+    COPY_V1(journalGeneration);
+    COPY_V1(lastPublishedTime);
+    COPY_V1(lastPublishedBatteryState);
+    COPY_V1(lastPublishedAlert);
+    COPY_V1(lastPublishedResets);
+    COPY_V1(reportsSuppressed);
+    COPY_V1(energySec);
+    COPY_V1(energyHibernateStart);
+    COPY_V1(countBins);
+    COPY_V1(sessionCount);
+    COPY_V1(sessionMinSec);
+    COPY_V1(sessionMaxSec);
+    COPY_V1(sessionHist);
+    COPY_V1(peakHourStart);
+    COPY_V1(peakHourSec);
+    COPY_V1(runHourStart);
+    COPY_V1(runHourSec);
+#undef COPY_V1
+    v2.hourlyCount = v1.hourlyCount;
+    v2.dailyCount = v1.dailyCount;
+    v2.lastPublishedDaily = v1.lastPublishedDaily;
+    v2.internalTempCenti = centiFromFloat(v1.internalTempC);
+    v2.socTenths = tenthsFromFloat(v1.stateOfCharge);
+    v2.lastPublishedTempCenti = centiFromFloat(v1.lastPublishedTempC);
+    v2.lastPublishedSocTenths = tenthsFromFloat(v1.lastPublishedSoc);
+    // Version 1 had no hourly history bases; start the deltas from now, as initializeAppended() does
+    v2.historyDailyBase = v2.dailyCount;
+    v2.historyOccupiedBase = v2.totalOccupiedSeconds;
+}
+
+// One step per older version; StorageHelperRK runs them in validate()
+static const StorageHelperRK::PersistentDataBase::MigrationStep currentMigrations[] = {
+    {1, sizeof(CurrentDataV1), upgradeCurrentV1, CURRENT_V1_MIN_SIZE},
+};
+
+void currentStatusData::setup() {
+    current
+    //    .withLogData(true)
+        .withSaveDelayMs(250)
+        .withMigrations(currentMigrations, sizeof(currentMigrations) / sizeof(currentMigrations[0]))
+        .load();
+
+#if COUNTER_RETAINED
+    retainedCounters.withMigrations(retainedMigrations, sizeof(retainedMigrations) / sizeof(retainedMigrations[0])).load();
+    if (retainedCounters.loadedValid && retainedCountersData.generation == current.get_journalGeneration()) {
+        // Counts made since the last checkpoint; keep them RAM-only until the next one
+        WITH_LOCK(current) {
+            currentData.hourlyCount = retainedCountersData.hourlyCount;
+            currentData.dailyCount = retainedCountersData.dailyCount;
+            currentData.lastCountTime = retainedCountersData.lastCountTime;
+        }
+        retainedDirty = true;
+        Log.info("Current: restored counts from retained memory (hourly %lu, daily %lu)",
+                 (unsigned long)currentData.hourlyCount, (unsigned long)currentData.dailyCount);
+    }
+    else {
+        retainedCounters.store(current.get_hourlyCount(), current.get_dailyCount(), current.get_lastCountTime(), current.get_journalGeneration());
+    }
+    lastCheckpointMs = millis();
+#elif COUNTER_JOURNAL
+    // Fold in any counts journaled since current.dat was last written
+    uint32_t delta = 0;
+    time_t lastCount = current.get_lastCountTime();
+    if (CounterJournal::instance().replay(current.get_journalGeneration(), delta, lastCount)) {
+        auto update = current.updateBatch();
+        current.set_hourlyCount(current.get_hourlyCount() + delta);
+        current.set_dailyCount(current.get_dailyCount() + delta);
+        current.set_lastCountTime(lastCount);
+    }
+#endif
+}
+
+// Runs once current's data has actually reached flash
+static void currentWritten() {
+#if COUNTER_RETAINED
+    retainedCounters.store(current.currentData.hourlyCount, current.currentData.dailyCount, current.currentData.lastCountTime, current.currentData.journalGeneration);
+    retainedDirty = false;
+    lastCheckpointMs = millis();
+#elif COUNTER_JOURNAL
+    CounterJournal::instance().noteBaseWrite(sizeof(currentStatusData::CurrentData));
+#endif
+}
+
+bool currentStatusData::load() {
+#if PERSISTENT_SINGLE_FILE
+    return PersistentStore::instance().loadSection(*this, PersistentStore::SECTION_CURRENT, &currentData.currentHeader, sizeof(CurrentData), currentWritten);
+#else
+    return PersistentDataFile::load();
+#endif
+}
+
+void currentStatusData::initializeAppended(size_t oldSize) {
+    if (oldSize <= offsetof(CurrentData, internalTempCenti)) {
+        currentData.internalTempCenti = centiFromFloat(currentData.internalTempCFloat);
+        currentData.socTenths = tenthsFromFloat(currentData.stateOfChargeFloat);
+        currentData.lastPublishedTempCenti = centiFromFloat(currentData.lastPublishedTempCFloat);
+        currentData.lastPublishedSocTenths = tenthsFromFloat(currentData.lastPublishedSocFloat);
+    }
+    if (oldSize <= offsetof(CurrentData, historyDailyBase)) {
+        // Older firmware stored the last record's hour outright; start the deltas from now
+        currentData.historyDailyBase = currentData.dailyCount;
+        currentData.historyOccupiedBase = currentData.totalOccupiedSeconds;
+    }
+}
+
+void currentStatusData::save() {
+    WITH_LOCK(*this) {
+#if COUNTER_RETAINED || COUNTER_JOURNAL
+        // Counts recorded from here on belong to the new generation; older ones
+        // are part of the file being written.
+        currentData.journalGeneration++;
+#endif
+#if PERSISTENT_SINGLE_FILE
+        bool written = PersistentStore::instance().saveSection(*this, PersistentStore::SECTION_CURRENT);   // Calls currentWritten()
+#else
+        uint32_t failures = getSaveStats().failures;
+        PersistentDataFile::save();
+        bool written = getSaveStats().failures == failures;
+        if (written) {
+            currentWritten();
+        }
+#endif
+#if COUNTER_RETAINED || COUNTER_JOURNAL
+        if (!written) {
+            // The file on flash still has the old generation; the journal and
+            // the counts recorded until the next save must keep it
+            currentData.journalGeneration--;
+            updateHash();
+        }
+#else
+        (void)written;
+#endif
+    }
+}
+
+void currentStatusData::checkpoint() {
+#if COUNTER_RETAINED
+    if (retainedDirty) {
+        updateHash();
+    }
+#endif
+    flush(true);
+}
+
+#if COUNT_BINS_ENABLED
+// 5-minute slot of the hour; report hours are UTC hours, so no timezone here
+static size_t countBinFor(time_t countTime) {
+    return (size_t)((countTime % 3600) / 300);
+}
+
+static uint8_t saturatingAdd(uint8_t bin, uint16_t events) {
+    return (uint8_t)((bin + events > 255) ? 255 : bin + events);
+}
+#endif
+
+// Bucket of the report for a count, or MAX_BUCKETS when buckets are off
+static size_t bucketFor(time_t bucketStart, uint16_t bucketSec, time_t countTime) {
+    if (bucketSec == 0) {
+        return currentStatusData::MAX_BUCKETS;
+    }
+    if (countTime < bucketStart) {
+        return 0;
+    }
+    size_t bucket = (size_t)((countTime - bucketStart) / bucketSec);
+    return (bucket < currentStatusData::MAX_BUCKETS) ? bucket : currentStatusData::MAX_BUCKETS - 1;
+}
+
+static uint16_t saturatingAdd16(uint16_t bucket, uint16_t events) {
+    return (uint16_t)(((uint32_t)bucket + events > 0xffff) ? 0xffff : bucket + events);
+}
+
+void currentStatusData::addToBins(uint16_t events, time_t countTime) {
+    WITH_LOCK(*this) {
+#if COUNT_BINS_ENABLED
+        uint8_t &bin = currentData.countBins[countBinFor(countTime)];
+        bin = saturatingAdd(bin, events);
+#endif
+        size_t bucket = bucketFor(currentData.bucketStart, currentData.bucketSec, countTime);
+        if (bucket < MAX_BUCKETS) {
+            currentData.buckets[bucket] = saturatingAdd16(currentData.buckets[bucket], events);
+        }
+    }
+}
+
+void currentStatusData::addCounts(uint16_t events, time_t lastCountTime) {
+#if COUNTER_RETAINED
+    WITH_LOCK(*this) {
+        // RAM and retained memory only; current.dat is written at the next checkpoint
+        currentData.hourlyCount += events;
+        currentData.dailyCount += events;
+        currentData.lastCountTime = lastCountTime;
+        retainedCounters.store(currentData.hourlyCount, currentData.dailyCount, lastCountTime, currentData.journalGeneration);
+        retainedDirty = true;
+    }
+#elif COUNTER_JOURNAL
+    WITH_LOCK(*this) {
+        // RAM only; the journal record makes the change durable
+        currentData.hourlyCount += events;
+        currentData.dailyCount += events;
+        currentData.lastCountTime = lastCountTime;
+
+        CounterJournal &journal = CounterJournal::instance();
+        if (!journal.append(events, lastCountTime, currentData.journalGeneration) || journal.needsCompaction()) {
+            updateHash();               // Schedule a normal save, which folds the journal in
+        }
+    }
+#else
+    auto update = current.updateBatch();
+    current.set_hourlyCount(current.get_hourlyCount() + events);
+    current.set_dailyCount(current.get_dailyCount() + events);
+    current.set_lastCountTime(lastCountTime);
+#endif
+    // The bins are not journaled or retained; they reach current.dat with
+    // the next save, and a reset before it loses only the shape, not the counts
+    addToBins(events, lastCountTime);
+}
+
+void currentStatusData::loop() {
+#if COUNTER_RETAINED
+    if (retainedDirty && millis() - lastCheckpointMs >= COUNTER_CHECKPOINT_MINUTES * 60000UL) {
+        updateHash();                   // Periodic checkpoint of the retained counts to flash
+    }
+#endif
+    current.flush(false);
+}
+
+void currentStatusData::resetEverything() {                             // The device is waking up in a new day or is a new install
+  auto update = current.updateBatch();                                  // Hash and save once for all the fields below
+  current.set_lastCountTime(Time.now());
+  sysStatus.set_resetCount(0);                                          // Reset the reset count as well
+  
+  // ********** Reset Counting Mode Fields **********
+  current.set_hourlyCount(0);
+  current.set_dailyCount(0);
+  
+  // ********** Reset Occupancy Mode Fields **********
+  current.set_occupied(false);
+  current.set_lastOccupancyEvent(0);
+  current.set_occupancyStartTime(0);
+  current.set_totalOccupiedSeconds(0);
+  current.set_sessionCount(0);
+  current.set_sessionMinSec(0);
+  current.set_sessionMaxSec(0);
+  for (size_t ii = 0; ii < sizeof(CurrentData::sessionHist) / sizeof(uint16_t); ii++) {
+    current.set_sessionHist(ii, 0);
+  }
+  current.set_peakHourStart(0);
+  current.set_peakHourSec(0);
+  current.set_runHourStart(0);
+  current.set_runHourSec(0);
+
+  // ********** Reset Energy Ledger **********
+  for (size_t ii = 0; ii < sizeof(CurrentData::energySec) / sizeof(uint32_t); ii++) {
+    current.set_energySec(ii, 0);
+  }
+  for (size_t ii = 0; ii < ENERGY_DOMAINS; ii++) {
+    current.set_energyDomainSec(ii, 0);
+  }
+
+  // ********** Reset Intra-hour Count Bins **********
+  current.clearCountBins();
+
+  // ********** Reset Per-sensor Counts (health is kept) **********
+  for (size_t ii = 0; ii < MAX_SENSOR_SLOTS; ii++) {
+    size_t slot = offsetof(CurrentData, sensorSlots) + ii * sizeof(SensorSlot);
+    current.setValue<uint32_t>(slot + offsetof(SensorSlot, hourlyCount), 0);
+    current.setValue<uint32_t>(slot + offsetof(SensorSlot, dailyCount), 0);
+    current.setValue<uint32_t>(slot + offsetof(SensorSlot, occupiedSec), 0);
+  }
+  for (size_t ii = 0; ii < sizeof(CurrentData::directionDaily) / sizeof(uint32_t); ii++) {
+    current.setValue<uint32_t>(offsetof(CurrentData, directionHourly) + ii * sizeof(uint32_t), 0);
+    current.setValue<uint32_t>(offsetof(CurrentData, directionDaily) + ii * sizeof(uint32_t), 0);
+  }
+
+  // ********** Reset Policy Experiment Tallies **********
+  for (size_t ii = 0; ii < POLICY_TALLIES; ii++) {
+    current.setValue<uint32_t>(offsetof(CurrentData, policyTally) + ii * sizeof(uint32_t), 0);
+  }
+  current.set_policyVariantDay(sysStatus.get_policyVariant());
+
+  // ********** Reset Data Usage **********
+  for (size_t ii = 0; ii < DATA_CATEGORIES; ii++) {
+    current.set_dataBytes(ii, 0);
+  }
+
+  // ********** Reset Connection Stability **********
+  current.set_cloudDrops(0);
+  current.set_cloudReconnects(0);
+  current.set_cloudDropAfterSec(0);
+  current.set_flapDamps(0);
+
+  // ********** Reset Group Estimate **********
+  current.set_hourlyPeople(0);
+  current.set_dailyPeople(0);
+
+  // ********** Reset Hourly History Baselines **********
+  current.setHistoryBase(0, 0);
+
+  // ********** Reset Scheduled Sample Aggregates **********
+  current.clearSampleStats();
+}
+
+bool currentStatusData::validate(size_t dataSize) {
+    bool valid = PersistentDataFile::validate(dataSize);
+    if (valid) {
+        // Basic sanity checks on data
+        // Far above what a road site counts; a byte error, not traffic
+        if (current.get_hourlyCount() > 200000 || current.get_dailyCount() > 2000000) {
+            Log.info("Current: counts appear invalid, resetting");
+            current.set_hourlyCount(0);
+            current.set_dailyCount(0);
+            valid = false;
+        }
+    }
+    Log.info("Current data is %s", (valid) ? "valid" : "not valid");
+    return valid;
+}
+
+void currentStatusData::initialize() {
+    PersistentDataFile::initialize();
+
+    Log.info("Current Data Initialized");
+
+    currentStatusData::resetEverything();
+
+    // If you manually update fields here, be sure to update the hash
+    updateHash();
+}
+
+uint16_t currentStatusData::get_faceNumber() const {
+    return getValue<uint16_t>(offsetof(CurrentData, faceNumber));
+}
+
+void currentStatusData::set_faceNumber(uint16_t value) {
+    setValue<uint16_t>(offsetof(CurrentData, faceNumber), value);
+}
+
+uint16_t currentStatusData::get_faceScore() const {
+    return getValue<uint16_t>(offsetof(CurrentData, faceScore));
+}
+
+void currentStatusData::set_faceScore(uint16_t value) {
+    setValue<uint16_t>(offsetof(CurrentData, faceScore), value);
+}
+uint16_t currentStatusData::get_gestureType() const {
+    return getValue<uint16_t>(offsetof(CurrentData, gestureType));
+}
+
+void currentStatusData::set_gestureType(uint16_t value) {
+    setValue<uint16_t>(offsetof(CurrentData, gestureType), value);
+}
+
+uint16_t currentStatusData::get_gestureScore() const {
+    return getValue<uint16_t>(offsetof(CurrentData, gestureScore));
+}
+
+void currentStatusData::set_gestureScore(uint16_t value) {
+    setValue<uint16_t>(offsetof(CurrentData, gestureScore), value);
+}
+
+time_t currentStatusData::get_lastCountTime() const {
+    return getValue<time_t>(offsetof(CurrentData, lastCountTime));
+}
+
+void currentStatusData::set_lastCountTime(time_t value) {
+    setValue<time_t>(offsetof(CurrentData, lastCountTime), value);
+}
+
+int16_t currentStatusData::get_internalTempCenti() const {
+    return getValue<int16_t>(offsetof(CurrentData, internalTempCenti));
+}
+
+void currentStatusData::set_internalTempCenti(int16_t value) {
+    setValue<int16_t>(offsetof(CurrentData, internalTempCenti), value);
+}
+
+float currentStatusData::get_externalTempC() const {
+    return getValue<float>(offsetof(CurrentData, externalTempC));
+}
+
+void currentStatusData::set_externalTempC(float value) {
+    setValue<float>(offsetof(CurrentData, externalTempC), value);
+}
+
+int8_t currentStatusData::get_alertCode() const {
+    return getValue<int8_t>(offsetof(CurrentData, alertCode));
+}
+
+void currentStatusData::set_alertCode(int8_t value) {
+    int8_t previous = get_alertCode();
+    if (value != previous) {
+        TraceLog::record(TraceLog::ALERT, value, previous);
+    }
+    setValue<int8_t>(offsetof(CurrentData, alertCode), value);
+}
+
+time_t currentStatusData::get_lastAlertTime() const {
+    // lastAlertTime is stored as time_t in CurrentData; retrieve with correct type
+    return getValue<time_t>(offsetof(CurrentData,lastAlertTime));
+}
+
+void currentStatusData::set_lastAlertTime(time_t value) {
+    setValue<time_t>(offsetof(CurrentData,lastAlertTime),value);
+}
+
+// Local helper to convert an alert code into a coarse severity bucket.
+// Higher numbers indicate more severe conditions.
+static int getAlertSeverity(int8_t code) {
+    if (code <= 0) {
+        return 0; // no alert
+    }
+
+    // Map known codes into tiers. This is intentionally simple and can be
+    // extended as new alert codes are added over time.
+    switch (code) {
+        case 14: // out-of-memory
+        case 15: // modem / disconnect failure
+        case 16: // repeated sleep failures (HIBERNATE / ULP)
+        case 20: // PMIC thermal shutdown (critical battery/charging fault)
+        case 21: // PMIC charge timeout / stuck charging
+            return 3; // critical
+
+        case 23: // PMIC battery fault (general)
+        case 24: // sensor fault (PIR interrupt storm)
+        case 25: // no counts in normally busy hours (dead or blocked sensor)
+        case 30: // connectivity timeout with radio up
+        case 31: // failed to connect to cloud
+        case 32: // connect taking too long
+        case 40: // repeated webhook failures
+        case 41: // configuration/ledger apply failure
+        case 42: // data ledger publish failure
+        case 43: // publish queue not drained before forced sleep
+            return 2; // major
+        default:
+            return 1; // minor / warning
+    }
+}
+
+static size_t alertRecordOffset(size_t index) {
+    return offsetof(currentStatusData::CurrentData, alertRecords) + index * sizeof(currentStatusData::AlertRecord);
+}
+
+void currentStatusData::raiseAlert(int8_t value) {
+    if (value <= 0) {
+        return; // ignore attempts to "raise" a non-alert here
+    }
+
+    auto update = updateBatch();
+    time_t now = Time.now();
+
+    if (value <= MAX_ALERT_CODE) {
+        uint64_t active = get_activeAlerts();
+        bool wasActive = (active >> value) & 1;
+
+        // Its own record, else a free one, else the one raised longest ago
+        size_t slot = MAX_ALERT_RECORDS;
+        size_t spare = 0;
+        for (size_t ii = 0; ii < MAX_ALERT_RECORDS; ii++) {
+            AlertRecord rec = get_alertRecord(ii);
+            if (rec.code == (uint8_t)value) {
+                slot = ii;
+                break;
+            }
+            AlertRecord best = get_alertRecord(spare);
+            if (best.code != 0 && (rec.code == 0 || rec.lastSeen < best.lastSeen)) {
+                spare = ii;
+            }
+        }
+
+        size_t offset;
+        if (slot < MAX_ALERT_RECORDS && wasActive) {
+            offset = alertRecordOffset(slot);
+            uint8_t count = getValue<uint8_t>(offset + offsetof(AlertRecord, count));
+            if (count < 255) {
+                setValue<uint8_t>(offset + offsetof(AlertRecord, count), count + 1);
+            }
+        } else {
+            offset = alertRecordOffset(slot < MAX_ALERT_RECORDS ? slot : spare);
+            setValue<uint8_t>(offset + offsetof(AlertRecord, code), (uint8_t)value);
+            setValue<uint8_t>(offset + offsetof(AlertRecord, count), 1);
+            setValue<time_t>(offset + offsetof(AlertRecord, firstSeen), now);
+        }
+        setValue<time_t>(offset + offsetof(AlertRecord, lastSeen), now);
+        setValue<uint64_t>(offsetof(CurrentData, activeAlerts), active | (1ULL << value));
+    }
+
+    int8_t existing = get_alertCode();
+    if (getAlertSeverity(value) > getAlertSeverity(existing)) {
+        set_alertCode(value);
+        set_lastAlertTime(now);
+    }
+}
+
+void currentStatusData::clearAlert(int8_t value) {
+    if (value <= 0) {
+        return;
+    }
+
+    auto update = updateBatch();
+    uint64_t active = get_activeAlerts();
+    if (value <= MAX_ALERT_CODE) {
+        active &= ~(1ULL << value);
+        setValue<uint64_t>(offsetof(CurrentData, activeAlerts), active);
+        for (size_t ii = 0; ii < MAX_ALERT_RECORDS; ii++) {
+            if (get_alertRecord(ii).code == (uint8_t)value) {
+                setValue<uint8_t>(alertRecordOffset(ii) + offsetof(AlertRecord, code), 0);
+            }
+        }
+    }
+
+    if (get_alertCode() != value) {
+        return;
+    }
+
+    // The most severe alert still active takes its place
+    int8_t next = 0;
+    for (int8_t code = 1; code <= MAX_ALERT_CODE; code++) {
+        if (((active >> code) & 1) && getAlertSeverity(code) > getAlertSeverity(next)) {
+            next = code;
+        }
+    }
+    time_t nextTime = 0;
+    for (size_t ii = 0; next != 0 && ii < MAX_ALERT_RECORDS; ii++) {
+        AlertRecord rec = get_alertRecord(ii);
+        if (rec.code == (uint8_t)next) {
+            nextTime = rec.lastSeen;
+        }
+    }
+    set_alertCode(next);
+    set_lastAlertTime(nextTime);
+}
+
+bool currentStatusData::isAlertActive(int8_t value) const {
+    if (value > 0 && value <= MAX_ALERT_CODE && ((get_activeAlerts() >> value) & 1)) {
+        return true;
+    }
+    return value > 0 && get_alertCode() == value;
+}
+
+uint64_t currentStatusData::get_activeAlerts() const {
+    return getValue<uint64_t>(offsetof(CurrentData, activeAlerts));
+}
+
+currentStatusData::AlertRecord currentStatusData::get_alertRecord(size_t index) const {
+    AlertRecord result = {};
+    if (index < MAX_ALERT_RECORDS) {
+        WITH_LOCK(*this) {
+            result = currentData.alertRecords[index];
+        }
+    }
+    return result;
+}
+
+uint16_t currentStatusData::get_socTenths() const  {
+    return getValue<uint16_t>(offsetof(CurrentData, socTenths));
+}
+void currentStatusData::set_socTenths(uint16_t value) {
+    setValue<uint16_t>(offsetof(CurrentData, socTenths), value);
+}
+
+uint8_t currentStatusData::get_batteryState() const  {
+    return getValue<uint8_t>(offsetof(CurrentData, batteryState));
+}
+void currentStatusData::set_batteryState(uint8_t value) {
+    setValue<uint8_t>(offsetof(CurrentData, batteryState), value);
+}
+
+// ********** Counting Mode Get/Set Functions **********
+
+uint32_t currentStatusData::get_hourlyCount() const {
+    return getValue<uint32_t>(offsetof(CurrentData, hourlyCount));
+}
+void currentStatusData::set_hourlyCount(uint32_t value) {
+    setValue<uint32_t>(offsetof(CurrentData, hourlyCount), value);
+}
+
+uint32_t currentStatusData::get_dailyCount() const {
+    return getValue<uint32_t>(offsetof(CurrentData, dailyCount));
+}
+void currentStatusData::set_dailyCount(uint32_t value) {
+    setValue<uint32_t>(offsetof(CurrentData, dailyCount), value);
+}
+
+// ********** Occupancy Mode Get/Set Functions **********
+
+bool currentStatusData::get_occupied() const {
+    return getValue<bool>(offsetof(CurrentData, occupied));
+}
+void currentStatusData::set_occupied(bool value) {
+    setValue<bool>(offsetof(CurrentData, occupied), value);
+}
+
+uint64_t currentStatusData::get_lastOccupancyEvent() const {
+    return getValue<uint64_t>(offsetof(CurrentData, lastOccupancyEvent));
+}
+void currentStatusData::set_lastOccupancyEvent(uint64_t value) {
+    setValue<uint64_t>(offsetof(CurrentData, lastOccupancyEvent), value);
 }
 
 time_t currentStatusData::get_occupancyStartTime() const {
@@ -665,4 +2030,417 @@ void currentStatusData::set_totalOccupiedSeconds(uint32_t value) {
     setValue<uint32_t>(offsetof(CurrentData, totalOccupiedSeconds), value);
 }
 
+time_t currentStatusData::get_lastPublishedTime() const {
+    return getValue<time_t>(offsetof(CurrentData, lastPublishedTime));
+}
+uint32_t currentStatusData::get_lastPublishedDaily() const {
+    return getValue<uint32_t>(offsetof(CurrentData, lastPublishedDaily));
+}
+uint16_t currentStatusData::get_lastPublishedSocTenths() const {
+    return getValue<uint16_t>(offsetof(CurrentData, lastPublishedSocTenths));
+}
+int16_t currentStatusData::get_lastPublishedTempCenti() const {
+    return getValue<int16_t>(offsetof(CurrentData, lastPublishedTempCenti));
+}
+uint8_t currentStatusData::get_lastPublishedBatteryState() const {
+    return getValue<uint8_t>(offsetof(CurrentData, lastPublishedBatteryState));
+}
+uint8_t currentStatusData::get_lastPublishedAlert() const {
+    return getValue<uint8_t>(offsetof(CurrentData, lastPublishedAlert));
+}
+uint8_t currentStatusData::get_lastPublishedResets() const {
+    return getValue<uint8_t>(offsetof(CurrentData, lastPublishedResets));
+}
+
+uint8_t currentStatusData::get_reportsSuppressed() const {
+    return getValue<uint8_t>(offsetof(CurrentData, reportsSuppressed));
+}
+void currentStatusData::set_reportsSuppressed(uint8_t value) {
+    setValue<uint8_t>(offsetof(CurrentData, reportsSuppressed), value);
+}
+
+uint32_t currentStatusData::get_energySec(size_t bucket) const {
+    if (bucket >= sizeof(CurrentData::energySec) / sizeof(uint32_t)) {
+        return 0;
+    }
+    return getValue<uint32_t>(offsetof(CurrentData, energySec) + bucket * sizeof(uint32_t));
+}
+void currentStatusData::set_energySec(size_t bucket, uint32_t value) {
+    if (bucket < sizeof(CurrentData::energySec) / sizeof(uint32_t)) {
+        setValue<uint32_t>(offsetof(CurrentData, energySec) + bucket * sizeof(uint32_t), value);
+    }
+}
+
+// The fourth domain came after energyDomainSec[] was laid out, in its own field
+static size_t energyDomainOffset(size_t domain) {
+    if (domain < sizeof(currentStatusData::CurrentData::energyDomainSec) / sizeof(uint32_t)) {
+        return offsetof(currentStatusData::CurrentData, energyDomainSec) + domain * sizeof(uint32_t);
+    }
+    return offsetof(currentStatusData::CurrentData, energyRangeSec);
+}
+
+uint32_t currentStatusData::get_energyDomainSec(size_t domain) const {
+    if (domain >= ENERGY_DOMAINS) {
+        return 0;
+    }
+    return getValue<uint32_t>(energyDomainOffset(domain));
+}
+void currentStatusData::set_energyDomainSec(size_t domain, uint32_t value) {
+    if (domain < ENERGY_DOMAINS) {
+        setValue<uint32_t>(energyDomainOffset(domain), value);
+    }
+}
+
+time_t currentStatusData::get_energyHibernateStart() const {
+    return getValue<time_t>(offsetof(CurrentData, energyHibernateStart));
+}
+void currentStatusData::set_energyHibernateStart(time_t value) {
+    setValue<time_t>(offsetof(CurrentData, energyHibernateStart), value);
+}
+
+uint8_t currentStatusData::get_countBin(size_t bin) const {
+    if (bin >= sizeof(CurrentData::countBins)) {
+        return 0;
+    }
+    return getValue<uint8_t>(offsetof(CurrentData, countBins) + bin);
+}
+void currentStatusData::set_countBin(size_t bin, uint8_t value) {
+    if (bin < sizeof(CurrentData::countBins)) {
+        setValue<uint8_t>(offsetof(CurrentData, countBins) + bin, value);
+    }
+}
+
+void currentStatusData::clearCountBins() {
+    auto update = updateBatch();
+    for (size_t ii = 0; ii < sizeof(CurrentData::countBins); ii++) {
+        set_countBin(ii, 0);
+    }
+}
+
+uint16_t currentStatusData::get_sessionCount() const {
+    return getValue<uint16_t>(offsetof(CurrentData, sessionCount));
+}
+void currentStatusData::set_sessionCount(uint16_t value) {
+    setValue<uint16_t>(offsetof(CurrentData, sessionCount), value);
+}
+
+uint32_t currentStatusData::get_sessionMinSec() const {
+    return getValue<uint32_t>(offsetof(CurrentData, sessionMinSec));
+}
+void currentStatusData::set_sessionMinSec(uint32_t value) {
+    setValue<uint32_t>(offsetof(CurrentData, sessionMinSec), value);
+}
+
+uint32_t currentStatusData::get_sessionMaxSec() const {
+    return getValue<uint32_t>(offsetof(CurrentData, sessionMaxSec));
+}
+void currentStatusData::set_sessionMaxSec(uint32_t value) {
+    setValue<uint32_t>(offsetof(CurrentData, sessionMaxSec), value);
+}
+
+uint16_t currentStatusData::get_sessionHist(size_t bucket) const {
+    if (bucket >= sizeof(CurrentData::sessionHist) / sizeof(uint16_t)) {
+        return 0;
+    }
+    return getValue<uint16_t>(offsetof(CurrentData, sessionHist) + bucket * sizeof(uint16_t));
+}
+void currentStatusData::set_sessionHist(size_t bucket, uint16_t value) {
+    if (bucket < sizeof(CurrentData::sessionHist) / sizeof(uint16_t)) {
+        setValue<uint16_t>(offsetof(CurrentData, sessionHist) + bucket * sizeof(uint16_t), value);
+    }
+}
+
+time_t currentStatusData::get_peakHourStart() const {
+    return getValue<time_t>(offsetof(CurrentData, peakHourStart));
+}
+void currentStatusData::set_peakHourStart(time_t value) {
+    setValue<time_t>(offsetof(CurrentData, peakHourStart), value);
+}
+
+uint32_t currentStatusData::get_peakHourSec() const {
+    return getValue<uint32_t>(offsetof(CurrentData, peakHourSec));
+}
+void currentStatusData::set_peakHourSec(uint32_t value) {
+    setValue<uint32_t>(offsetof(CurrentData, peakHourSec), value);
+}
+
+time_t currentStatusData::get_runHourStart() const {
+    return getValue<time_t>(offsetof(CurrentData, runHourStart));
+}
+void currentStatusData::set_runHourStart(time_t value) {
+    setValue<time_t>(offsetof(CurrentData, runHourStart), value);
+}
+
+uint32_t currentStatusData::get_runHourSec() const {
+    return getValue<uint32_t>(offsetof(CurrentData, runHourSec));
+}
+void currentStatusData::set_runHourSec(uint32_t value) {
+    setValue<uint32_t>(offsetof(CurrentData, runHourSec), value);
+}
+
+currentStatusData::SensorSlot currentStatusData::get_sensorSlot(size_t slot) const {
+    SensorSlot result = {};
+    if (slot < MAX_SENSOR_SLOTS) {
+        WITH_LOCK(*this) {
+            result = currentData.sensorSlots[slot];
+        }
+    }
+    return result;
+}
+void currentStatusData::set_sensorHealth(size_t slot, uint8_t value) {
+    if (slot < MAX_SENSOR_SLOTS) {
+        setValue<uint8_t>(offsetof(CurrentData, sensorSlots) + slot * sizeof(SensorSlot) + offsetof(SensorSlot, health), value);
+    }
+}
+
+void currentStatusData::noteSensorEvents(const SensorEvent *events, size_t count) {
+    WITH_LOCK(*this) {
+        // RAM only; hashed with the save the caller's counter update schedules
+        for (size_t ii = 0; ii < count; ii++) {
+            uint8_t source = events[ii].source();
+            if (source < MAX_SENSOR_SLOTS) {
+                SensorSlot &slot = currentData.sensorSlots[source];
+                slot.hourlyCount++;
+                slot.dailyCount++;
+                slot.lastEventTime = events[ii].unixTime();
+            }
+            // Other sensors use the same flag bits for their own meanings
+            if (events[ii].type == SensorType::DUAL_PIR && (events[ii].flags & (SensorEvent::DIR_IN | SensorEvent::DIR_OUT))) {
+                size_t dir = (events[ii].flags & SensorEvent::DIR_IN) ? DIRECTION_IN : DIRECTION_OUT;
+                currentData.directionHourly[dir]++;
+                currentData.directionDaily[dir]++;
+            }
+        }
+    }
+}
+
+void currentStatusData::addSensorOccupiedSeconds(uint8_t slotMask, uint32_t seconds) {
+    auto update = updateBatch();
+    for (size_t ii = 0; ii < MAX_SENSOR_SLOTS; ii++) {
+        if (slotMask & (1 << ii)) {
+            size_t offset = offsetof(CurrentData, sensorSlots) + ii * sizeof(SensorSlot) + offsetof(SensorSlot, occupiedSec);
+            setValue<uint32_t>(offset, getValue<uint32_t>(offset) + seconds);
+        }
+    }
+}
+
+void currentStatusData::clearSensorHourlyCounts() {
+    auto update = updateBatch();
+    for (size_t ii = 0; ii < MAX_SENSOR_SLOTS; ii++) {
+        setValue<uint32_t>(offsetof(CurrentData, sensorSlots) + ii * sizeof(SensorSlot) + offsetof(SensorSlot, hourlyCount), 0);
+    }
+    setValue<uint32_t>(offsetof(CurrentData, directionHourly) + DIRECTION_IN * sizeof(uint32_t), 0);
+    setValue<uint32_t>(offsetof(CurrentData, directionHourly) + DIRECTION_OUT * sizeof(uint32_t), 0);
+}
+
+uint32_t currentStatusData::get_directionHourly(size_t dir) const {
+    if (dir > DIRECTION_OUT) {
+        return 0;
+    }
+    return getValue<uint32_t>(offsetof(CurrentData, directionHourly) + dir * sizeof(uint32_t));
+}
+
+uint32_t currentStatusData::get_directionDaily(size_t dir) const {
+    if (dir > DIRECTION_OUT) {
+        return 0;
+    }
+    return getValue<uint32_t>(offsetof(CurrentData, directionDaily) + dir * sizeof(uint32_t));
+}
+
+uint32_t currentStatusData::get_policyTally(size_t tally) const {
+    if (tally >= POLICY_TALLIES) {
+        return 0;
+    }
+    return getValue<uint32_t>(offsetof(CurrentData, policyTally) + tally * sizeof(uint32_t));
+}
+void currentStatusData::addPolicyTally(size_t tally, uint32_t amount) {
+    if (tally < POLICY_TALLIES) {
+        size_t offset = offsetof(CurrentData, policyTally) + tally * sizeof(uint32_t);
+        setValue<uint32_t>(offset, getValue<uint32_t>(offset) + amount);
+    }
+}
+
+uint8_t currentStatusData::get_policyVariantDay() const {
+    return getValue<uint8_t>(offsetof(CurrentData, policyVariantDay));
+}
+void currentStatusData::set_policyVariantDay(uint8_t value) {
+    setValue<uint8_t>(offsetof(CurrentData, policyVariantDay), value);
+}
+
+uint32_t currentStatusData::get_dataBytes(size_t category) const {
+    if (category >= DATA_CATEGORIES) {
+        return 0;
+    }
+    return getValue<uint32_t>(offsetof(CurrentData, dataBytes) + category * sizeof(uint32_t));
+}
+void currentStatusData::set_dataBytes(size_t category, uint32_t value) {
+    if (category < DATA_CATEGORIES) {
+        setValue<uint32_t>(offsetof(CurrentData, dataBytes) + category * sizeof(uint32_t), value);
+    }
+}
+
+time_t currentStatusData::get_bucketStart() const {
+    return getValue<time_t>(offsetof(CurrentData, bucketStart));
+}
+
+uint16_t currentStatusData::get_bucketSec() const {
+    return getValue<uint16_t>(offsetof(CurrentData, bucketSec));
+}
+
+uint16_t currentStatusData::get_bucket(size_t bucket) const {
+    if (bucket >= MAX_BUCKETS) {
+        return 0;
+    }
+    return getValue<uint16_t>(offsetof(CurrentData, buckets) + bucket * sizeof(uint16_t));
+}
+
+void currentStatusData::startBuckets(time_t now, uint16_t bucketSec, uint16_t reportSec) {
+    static uint16_t loggedSec = 0;
+    if (bucketSec != 0) {
+        uint16_t configured = bucketSec;
+        // MAX_BUCKETS of them must cover the report, or the rest piles into the
+        // last; one of them may go to bucketStart being rounded down
+        uint16_t fit = (uint16_t)((reportSec + MAX_BUCKETS - 2) / (MAX_BUCKETS - 1));
+        bucketSec = constrain(std::max(bucketSec, fit), (uint16_t)60, (uint16_t)3600);
+        if (bucketSec != configured && bucketSec != loggedSec) {
+            Log.info("Count buckets of %u s for a %u s report (bucketSec %u)", (unsigned)bucketSec,
+                     (unsigned)reportSec, (unsigned)configured);
+        }
+    }
+    loggedSec = bucketSec;
+    auto update = updateBatch();
+    setValue<time_t>(offsetof(CurrentData, bucketStart), bucketSec ? now - (now % bucketSec) : 0);
+    setValue<uint16_t>(offsetof(CurrentData, bucketSec), bucketSec);
+    for (size_t ii = 0; ii < MAX_BUCKETS; ii++) {
+        setValue<uint16_t>(offsetof(CurrentData, buckets) + ii * sizeof(uint16_t), 0);
+    }
+}
+
+uint16_t currentStatusData::get_cloudDrops() const {
+    return getValue<uint16_t>(offsetof(CurrentData, cloudDrops));
+}
+void currentStatusData::set_cloudDrops(uint16_t value) {
+    setValue<uint16_t>(offsetof(CurrentData, cloudDrops), value);
+}
+
+uint16_t currentStatusData::get_cloudReconnects() const {
+    return getValue<uint16_t>(offsetof(CurrentData, cloudReconnects));
+}
+void currentStatusData::set_cloudReconnects(uint16_t value) {
+    setValue<uint16_t>(offsetof(CurrentData, cloudReconnects), value);
+}
+
+uint32_t currentStatusData::get_cloudDropAfterSec() const {
+    return getValue<uint32_t>(offsetof(CurrentData, cloudDropAfterSec));
+}
+void currentStatusData::set_cloudDropAfterSec(uint32_t value) {
+    setValue<uint32_t>(offsetof(CurrentData, cloudDropAfterSec), value);
+}
+
+uint16_t currentStatusData::get_flapDamps() const {
+    return getValue<uint16_t>(offsetof(CurrentData, flapDamps));
+}
+void currentStatusData::set_flapDamps(uint16_t value) {
+    setValue<uint16_t>(offsetof(CurrentData, flapDamps), value);
+}
+
+uint32_t currentStatusData::get_hourlyPeople() const {
+    return getValue<uint32_t>(offsetof(CurrentData, hourlyPeople));
+}
+void currentStatusData::set_hourlyPeople(uint32_t value) {
+    setValue<uint32_t>(offsetof(CurrentData, hourlyPeople), value);
+}
+
+uint32_t currentStatusData::get_dailyPeople() const {
+    return getValue<uint32_t>(offsetof(CurrentData, dailyPeople));
+}
+void currentStatusData::set_dailyPeople(uint32_t value) {
+    setValue<uint32_t>(offsetof(CurrentData, dailyPeople), value);
+}
+
+void currentStatusData::addPeople(uint16_t people) {
+    auto update = current.updateBatch();
+    current.set_hourlyPeople(current.get_hourlyPeople() + people);
+    current.set_dailyPeople(current.get_dailyPeople() + people);
+}
+
+uint32_t currentStatusData::get_historyDailyBase() const {
+    return getValue<uint32_t>(offsetof(CurrentData, historyDailyBase));
+}
+
+uint32_t currentStatusData::get_historyOccupiedBase() const {
+    return getValue<uint32_t>(offsetof(CurrentData, historyOccupiedBase));
+}
+
+void currentStatusData::setHistoryBase(uint32_t daily, uint32_t occupiedSec) {
+    auto update = updateBatch();
+    setValue<uint32_t>(offsetof(CurrentData, historyDailyBase), daily);
+    setValue<uint32_t>(offsetof(CurrentData, historyOccupiedBase), occupiedSec);
+}
+
+time_t currentStatusData::get_lastSampleTime() const {
+    return getValue<time_t>(offsetof(CurrentData, lastSampleTime));
+}
+
+currentStatusData::SampleStats currentStatusData::get_sampleStats(size_t slot) const {
+    SampleStats result = {};
+    if (slot < MAX_SENSOR_SLOTS) {
+        WITH_LOCK(*this) {
+            result = currentData.sampleStats[slot];
+        }
+    }
+    return result;
+}
+
+void currentStatusData::addSamples(time_t boundary, const uint16_t *values, const bool *valid, size_t count) {
+    auto update = updateBatch();
+    setValue<time_t>(offsetof(CurrentData, lastSampleTime), boundary);
+    for (size_t ii = 0; ii < count && ii < MAX_SENSOR_SLOTS; ii++) {
+        if (!valid[ii]) {
+            continue;
+        }
+        SampleStats stats = get_sampleStats(ii);
+        if (stats.count == 0) {
+            stats.minValue = values[ii];
+            stats.maxValue = values[ii];
+            stats.sum = 0;
+        } else {
+            stats.minValue = values[ii] < stats.minValue ? values[ii] : stats.minValue;
+            stats.maxValue = values[ii] > stats.maxValue ? values[ii] : stats.maxValue;
+        }
+        stats.sum += values[ii];
+        if (stats.count < 0xffff) {
+            stats.count++;
+        }
+        size_t offset = offsetof(CurrentData, sampleStats) + ii * sizeof(SampleStats);
+        setValue<uint16_t>(offset + offsetof(SampleStats, minValue), stats.minValue);
+        setValue<uint16_t>(offset + offsetof(SampleStats, maxValue), stats.maxValue);
+        setValue<uint32_t>(offset + offsetof(SampleStats, sum), stats.sum);
+        setValue<uint16_t>(offset + offsetof(SampleStats, count), stats.count);
+    }
+}
+
+void currentStatusData::clearSampleStats() {
+    auto update = updateBatch();
+    for (size_t ii = 0; ii < MAX_SENSOR_SLOTS; ii++) {
+        setValue<uint16_t>(offsetof(CurrentData, sampleStats) + ii * sizeof(SampleStats) + offsetof(SampleStats, count), 0);
+    }
+}
+
+void currentStatusData::recordPublishedReport(time_t timestamp, uint32_t daily, uint16_t socTenths, int16_t tempCenti, uint8_t batteryState, uint8_t alert, uint8_t resets) {
+    auto update = updateBatch();
+    setValue<time_t>(offsetof(CurrentData, lastPublishedTime), timestamp);
+    setValue<uint32_t>(offsetof(CurrentData, lastPublishedDaily), daily);
+    setValue<uint16_t>(offsetof(CurrentData, lastPublishedSocTenths), socTenths);
+    setValue<int16_t>(offsetof(CurrentData, lastPublishedTempCenti), tempCenti);
+    setValue<uint8_t>(offsetof(CurrentData, lastPublishedBatteryState), batteryState);
+    setValue<uint8_t>(offsetof(CurrentData, lastPublishedAlert), alert);
+    setValue<uint8_t>(offsetof(CurrentData, lastPublishedResets), resets);
+    setValue<uint8_t>(offsetof(CurrentData, reportsSuppressed), 0);
+}
+
+uint16_t currentStatusData::get_journalGeneration() const {
+    return getValue<uint16_t>(offsetof(CurrentData, journalGeneration));
+}
+
 // End of currentStatusData class
\ No newline at end of file
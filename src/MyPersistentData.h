@@ -37,6 +37,9 @@
 
 #include "Particle.h"
 #include "StorageHelperRK.h" 
+
+struct SensorEvent;
+
 // This way you can do "data.setup()" instead of "MyPersistentData::instance().setup()" as an example
 #define current currentStatusData::instance()
 #define sysStatus sysStatusData::instance()
@@ -69,6 +72,18 @@ enum OperatingMode {
 	DISCONNECTED = 2   // Stay offline unless manually overridden
 };
 
+/**
+ * @brief Where the hourly report goes
+ *
+ * @details The device-data ledger can be forwarded by a server-side ledger
+ *          webhook, so a fleet that only uses one path need not send both.
+ */
+enum DataDelivery {
+	DELIVER_BOTH    = 0,  // Webhook event and device-data ledger
+	DELIVER_WEBHOOK = 1,  // Webhook event only
+	DELIVER_LEDGER  = 2   // device-data ledger only
+};
+
 // NOTE: TriggerMode has been deprecated in favor of using
 // CountingMode (COUNTING/OCCUPANCY/SCHEDULED) as the single
 // source of truth for behavioral mode. The legacy TriggerMode
@@ -112,18 +127,38 @@ public:
      */
     void loop();
 
+    /**
+     * @brief Load from this object's own file, or its section of the consolidated store (PERSISTENT_SINGLE_FILE)
+     */
+    bool load() override;
+
+    /**
+     * @brief Save to this object's own file, or its section of the consolidated store (PERSISTENT_SINGLE_FILE)
+     */
+    void save() override;
+
 	/**
 	 * @brief Validates values and, if valid, checks that data is in the correct range.
 	 * 
 	 */
 	bool validate(size_t dataSize);
 
+	/**
+	 * @brief Defaults for fields appended since the file was written that are not zero
+	 * 
+	 * @details Devices updated from older firmware would otherwise run with zero there
+	 * until the next ledger sync.
+	 * 
+	 */
+	void initializeAppended(size_t oldSize) override;
+
 	/**
 	 * @brief Will reinitialize data if it is found not to be valid
 	 * 
 	 * Be careful doing this, because when MyData is extended to add new fields,
 	 * the initialize method is not called! This is only called when first
-	 * initialized.
+	 * initialized. Fields that need a non-zero default on upgraded devices
+	 * also go in initializeAppended().
 	 * 
 	 */
 	void initialize();
@@ -167,6 +202,78 @@ public:
 		uint16_t connectAttemptBudgetSec;                 // Max seconds to spend attempting a cloud connect per wake
 		uint16_t cloudDisconnectBudgetSec;                // Max seconds to wait for cloud disconnect before error
 		uint16_t modemOffBudgetSec;                       // Max seconds to wait for modem power-down before error
+		uint8_t reportHeartbeatHours;                     // Send at least one report every N hours; unchanged reports in between are skipped (0 = never skip)
+		uint8_t reportSocDelta;                           // State of charge change (percent) that counts as a change for report suppression
+		uint8_t reportTempDelta;                          // Temperature change (degrees C) that counts as a change for report suppression
+		uint32_t configHashDefaults;                      // Hash of the default-settings ledger last applied successfully (0 = none)
+		uint32_t configHashDevice;                        // Hash of the device-settings ledger last applied successfully (0 = none)
+		uint32_t deviceStatusHash;                        // Hash of the configuration last written to the device-status ledger (0 = none)
+		uint32_t deviceDataHash;                          // Hash of the fields last written to the device-data ledger (0 = none)
+		uint16_t connectHist[10];                         // Successful connect times by bucket (see ConnectHistory), halved as they fill
+		uint16_t connectFailures;                         // Connect attempts that ran out of budget, halved with connectHist
+		uint8_t connectFailStreak;                        // Consecutive connect attempts that ran out of budget
+		time_t signalDeferSince;                          // When reports were first deferred for weak signal (0 = not deferring)
+		uint8_t powerGovernorMaxTier;                     // Highest tier PowerGovernor may use (0 = governor off)
+		uint8_t powerTier;                                // Current PowerGovernor tier (0 = configured mode and interval)
+		int16_t socSlopeTenths;                           // Smoothed SoC change per day, in tenths of a percent
+		float socAtDayStart;                              // SoC at the last dailyCleanup() (-1 = not yet known)
+		bool chargedToday;                                // Battery was seen charging or charged since the last dailyCleanup()
+		uint8_t netBssid[6];                              // BSSID of the access point at the last connect (WiFi only, zero if unknown)
+		uint32_t netLocalIp;                              // IPv4 lease at the last connect, first octet in the high byte (WiFi only)
+		time_t nextLocalMidnight;                         // Next local midnight after the last report; dailyCleanup() runs once past it (0 = recompute)
+		uint8_t weekSchedule[21];                         // Open hours by hour of week, Sunday 00:00 first, MSB first (all zero = use openTime/closeTime)
+		time_t otaDeferSince;                             // When a pending firmware update was first deferred (0 = not deferring)
+		uint8_t otaDeferReason;                           // OtaScheduler::Reason last reported for the deferral
+		int16_t clockDriftPpm10;                          // Device clock drift estimate, ppm x 10 (positive = runs fast)
+		uint16_t clockUncertaintyPpm10;                   // Uncertainty of clockDriftPpm10, ppm x 10 (0 = no estimate yet)
+		time_t clockBaseTime;                             // Start of the current clock interval: the last sync or AB1805 restore
+		uint32_t clockBaseErrorMs;                        // Predicted clock error at clockBaseTime (0 after a sync)
+		int16_t clockCorrectionSec;                       // Drift correction stepped into Time since clockBaseTime
+		time_t rtcSetTime;                                // When the AB1805 was last set from cloud time (0 = unknown)
+		int16_t rtcDriftPpm10;                            // AB1805 drift estimate, ppm x 10 (positive = runs fast)
+		uint16_t rtcUncertaintyPpm10;                     // Uncertainty of rtcDriftPpm10, ppm x 10 (0 = no estimate yet)
+		uint32_t archiveUploadDay;                        // Event archive day file being uploaded, YYYYMMDD (0 = from the oldest)
+		uint32_t archiveUploadOffset;                     // Bytes of that file the collector has acknowledged
+		uint16_t liveCountSec;                            // Live count update window in CONNECTED mode, seconds (0 = off)
+		uint16_t occupancyNotifySec;                      // Occupancy change coalescing window, seconds (0 = no change events)
+		uint16_t recoveryAttempts[3];                     // ERROR_STATE recoveries started, by level: warm, soft reset, power cycle
+		uint16_t recoveryRepeats[3];                      // Of those, how many saw the same alert again within RECOVERY_EFFECTIVE_SEC
+		uint8_t lastRecoveryLevel;                        // Level (1-3) of the last recovery, until the next ERROR_STATE judges it (0 = none)
+		uint8_t lastRecoveryAlert;                        // Alert code it was for
+		time_t lastRecoveryTime;                          // When it started (0 = time was not valid)
+		time_t connectBackoffUntil;                       // No scheduled connect before this time (0 = not backing off)
+		uint32_t reportSeq;                               // Sequence number of the last hourly report queued (see ReportTracker)
+		uint32_t unackedSeq[24];                          // Reports queued and not yet confirmed by a webhook response (0 = free slot)
+		uint32_t unackedHour[24];                         // Report timestamp of each, to find it in HourlyHistory
+		uint16_t reportsResent;                           // Unconfirmed reports resent from HourlyHistory
+		uint16_t reportsLost;                             // Unconfirmed reports no longer in HourlyHistory to resend
+		uint16_t reportsUntracked;                        // Reports pushed out of a full window unconfirmed
+		uint8_t dataDelivery;                             // DataDelivery: webhook, device-data ledger or both
+		time_t lastConnectDataLedger;                     // Last time a report or connect marked device-data for writing (0 = never)
+		time_t coldDeferSince;                            // When report connects were first deferred for cold (0 = not deferring)
+		uint16_t coldDeferrals;                           // Report connects deferred for cold since first boot
+		uint8_t policyVariant;                            // PowerPolicy variant in effect (0 = control, the Config.h values)
+		uint32_t configSectionHash[5];                    // Hash of each merged settings section last applied, ConfigSchema::SECTIONS order (0 = apply it)
+		uint16_t bucketSec;                               // Count bucket length within a report, seconds (0 = no buckets)
+		uint64_t monoSavedMs;                             // MonoClock::nowMs() at the last checkpoint
+		time_t monoSavedTime;                             // Time.now() at that checkpoint (0 = RTC not valid then)
+		time_t configCheckTime;                           // Last settings ledger merge that applied cleanly (0 = never)
+		uint32_t configVersionHash;                       // Hash of the configVersion ledger fields at that merge (0 = none)
+		uint32_t reportFields;                            // Report fields sent, a bit per REPORT_SCHEMA_VERSION field (see Config.h)
+		uint8_t reportSchema;                             // REPORT_SCHEMA_VERSION that reportFields was written for
+		int16_t wakeCorrectionMs;                         // Added to each boundary nap, learned from timer wake errors (see WakeAccuracy)
+		uint16_t timerWakes;                              // Boundary timer wakes measured
+		uint16_t earlyWakes;                              // Of those, how many arrived before the boundary
+		int16_t tuneRefractoryMs;                         // AutoTune offset added to sensor.refractoryMs
+		int16_t tuneDebounceMs;                           // AutoTune offset added to sensor.debounceMs
+		int8_t tuneStreak;                                // AutoTune hours in a row voting to tighten (+) or loosen (-)
+		uint16_t tuneSteps;                               // AutoTune steps taken since first boot
+		uint8_t slotIndex;                                // ReportSlot: this device's connect slot in its site group
+		uint8_t slotCount;                                // ReportSlot: slots in the site group (0 = fleet jitter instead)
+		uint16_t slotWidthSec;                            // ReportSlot: length of each slot
+		uint16_t slotConnects;                            // ReportSlot: scheduled report connects checked against the slot
+		uint16_t slotMisses;                              // ReportSlot: of those, how many started outside it
+		time_t deviceStatusDiagTime;                      // Last device-status write with current diagnostics (0 = never)
 
 	};
 
@@ -196,6 +303,22 @@ public:
 	 * 
 	 */
 
+	/**
+	 * @brief Start a scoped batch of set calls
+	 * 
+	 * @details Takes the lock once; the set calls made while the returned object is in scope
+	 * only write their fields, and the structure is hashed and a save scheduled once when
+	 * it goes out of scope or commit() is called.
+	 * 
+	 *     auto batch = sysStatus.updateBatch();
+	 *     sysStatus.set_...(...);
+	 *     sysStatus.set_...(...);
+	 * 
+	 * @returns The batch; keep it in a local variable
+	 * 
+	 */
+	UpdateBatch updateBatch() { return UpdateBatch(*this); }
+
 	uint8_t get_structuresVersion() const ;
 	void set_structuresVersion(uint8_t value);
 
@@ -215,6 +338,7 @@ public:
 	void set_resetCount(uint8_t value);
 
 	String get_timeZoneStr() const;
+	bool get_timeZoneStr(char *buf, size_t size) const;	// No heap; size 39 holds any value
 	bool set_timeZoneStr(const char *str);
 
 	uint8_t get_openTime() const;
@@ -288,6 +412,222 @@ public:
 	uint16_t get_modemOffBudgetSec() const;
 	void set_modemOffBudgetSec(uint16_t value);
 
+	uint8_t get_reportHeartbeatHours() const;
+	void set_reportHeartbeatHours(uint8_t value);
+
+	uint8_t get_reportSocDelta() const;
+	void set_reportSocDelta(uint8_t value);
+
+	uint8_t get_reportTempDelta() const;
+	void set_reportTempDelta(uint8_t value);
+
+	uint32_t get_configHashDefaults() const;
+	void set_configHashDefaults(uint32_t value);
+
+	uint32_t get_configHashDevice() const;
+	void set_configHashDevice(uint32_t value);
+
+	uint32_t get_deviceStatusHash() const;
+	void set_deviceStatusHash(uint32_t value);
+
+	uint32_t get_deviceDataHash() const;
+	void set_deviceDataHash(uint32_t value);
+
+	uint16_t get_connectHist(size_t bucket) const;
+	void set_connectHist(size_t bucket, uint16_t value);
+
+	uint16_t get_connectFailures() const;
+	void set_connectFailures(uint16_t value);
+
+	uint8_t get_connectFailStreak() const;
+	void set_connectFailStreak(uint8_t value);
+
+	time_t get_signalDeferSince() const;
+	void set_signalDeferSince(time_t value);
+
+	uint8_t get_powerGovernorMaxTier() const;
+	void set_powerGovernorMaxTier(uint8_t value);
+
+	uint8_t get_powerTier() const;
+	void set_powerTier(uint8_t value);
+
+	int16_t get_socSlopeTenths() const;
+	void set_socSlopeTenths(int16_t value);
+
+	float get_socAtDayStart() const;
+	void set_socAtDayStart(float value);
+
+	bool get_chargedToday() const;
+	void set_chargedToday(bool value);
+
+	uint8_t get_netBssid(size_t index) const;
+	void set_netBssid(size_t index, uint8_t value);
+
+	uint32_t get_netLocalIp() const;
+	void set_netLocalIp(uint32_t value);
+
+	time_t get_nextLocalMidnight() const;
+	void set_nextLocalMidnight(time_t value);
+
+	uint8_t get_weekSchedule(size_t index) const;
+	void set_weekSchedule(size_t index, uint8_t value);
+
+	time_t get_otaDeferSince() const;
+	void set_otaDeferSince(time_t value);
+
+	uint8_t get_otaDeferReason() const;
+	void set_otaDeferReason(uint8_t value);
+
+	int16_t get_clockDriftPpm10() const;
+	void set_clockDriftPpm10(int16_t value);
+
+	uint16_t get_clockUncertaintyPpm10() const;
+	void set_clockUncertaintyPpm10(uint16_t value);
+
+	time_t get_clockBaseTime() const;
+	void set_clockBaseTime(time_t value);
+
+	uint32_t get_clockBaseErrorMs() const;
+	void set_clockBaseErrorMs(uint32_t value);
+
+	int16_t get_clockCorrectionSec() const;
+	void set_clockCorrectionSec(int16_t value);
+
+	time_t get_rtcSetTime() const;
+	void set_rtcSetTime(time_t value);
+
+	int16_t get_rtcDriftPpm10() const;
+	void set_rtcDriftPpm10(int16_t value);
+
+	uint16_t get_rtcUncertaintyPpm10() const;
+	void set_rtcUncertaintyPpm10(uint16_t value);
+
+	uint32_t get_archiveUploadDay() const;
+	void set_archiveUploadDay(uint32_t value);
+
+	uint32_t get_archiveUploadOffset() const;
+	void set_archiveUploadOffset(uint32_t value);
+
+	uint16_t get_liveCountSec() const;
+	void set_liveCountSec(uint16_t value);
+
+	uint16_t get_occupancyNotifySec() const;
+	void set_occupancyNotifySec(uint16_t value);
+
+	uint16_t get_recoveryAttempts(size_t level) const;
+	void set_recoveryAttempts(size_t level, uint16_t value);
+
+	uint16_t get_recoveryRepeats(size_t level) const;
+	void set_recoveryRepeats(size_t level, uint16_t value);
+
+	uint8_t get_lastRecoveryLevel() const;
+	void set_lastRecoveryLevel(uint8_t value);
+
+	uint8_t get_lastRecoveryAlert() const;
+	void set_lastRecoveryAlert(uint8_t value);
+
+	time_t get_lastRecoveryTime() const;
+	void set_lastRecoveryTime(time_t value);
+
+	time_t get_connectBackoffUntil() const;
+	void set_connectBackoffUntil(time_t value);
+
+	uint32_t get_reportSeq() const;
+	void set_reportSeq(uint32_t value);
+
+	uint32_t get_unackedSeq(size_t index) const;
+	void set_unackedSeq(size_t index, uint32_t value);
+
+	uint32_t get_unackedHour(size_t index) const;
+	void set_unackedHour(size_t index, uint32_t value);
+
+	uint16_t get_reportsResent() const;
+	void set_reportsResent(uint16_t value);
+
+	uint16_t get_reportsLost() const;
+	void set_reportsLost(uint16_t value);
+
+	uint16_t get_reportsUntracked() const;
+	void set_reportsUntracked(uint16_t value);
+
+	uint8_t get_dataDelivery() const;
+	void set_dataDelivery(uint8_t value);
+
+	time_t get_lastConnectDataLedger() const;
+	void set_lastConnectDataLedger(time_t value);
+
+	time_t get_coldDeferSince() const;
+	void set_coldDeferSince(time_t value);
+
+	uint16_t get_coldDeferrals() const;
+	void set_coldDeferrals(uint16_t value);
+
+	uint8_t get_policyVariant() const;
+	void set_policyVariant(uint8_t value);
+
+	uint32_t get_configSectionHash(size_t section) const;
+	void set_configSectionHash(size_t section, uint32_t value);
+
+	uint16_t get_bucketSec() const;
+	void set_bucketSec(uint16_t value);
+
+	uint64_t get_monoSavedMs() const;
+	void set_monoSavedMs(uint64_t value);
+
+	time_t get_monoSavedTime() const;
+	void set_monoSavedTime(time_t value);
+
+	time_t get_configCheckTime() const;
+	void set_configCheckTime(time_t value);
+
+	uint32_t get_configVersionHash() const;
+	void set_configVersionHash(uint32_t value);
+
+	uint32_t get_reportFields() const;
+	void set_reportFields(uint32_t value);
+
+	uint8_t get_reportSchema() const;
+	void set_reportSchema(uint8_t value);
+
+	int16_t get_wakeCorrectionMs() const;
+	void set_wakeCorrectionMs(int16_t value);
+
+	uint16_t get_timerWakes() const;
+	void set_timerWakes(uint16_t value);
+
+	uint16_t get_earlyWakes() const;
+	void set_earlyWakes(uint16_t value);
+
+	int16_t get_tuneRefractoryMs() const;
+	void set_tuneRefractoryMs(int16_t value);
+
+	int16_t get_tuneDebounceMs() const;
+	void set_tuneDebounceMs(int16_t value);
+
+	int8_t get_tuneStreak() const;
+	void set_tuneStreak(int8_t value);
+
+	uint16_t get_tuneSteps() const;
+	void set_tuneSteps(uint16_t value);
+
+	uint8_t get_slotIndex() const;
+	void set_slotIndex(uint8_t value);
+
+	uint8_t get_slotCount() const;
+	void set_slotCount(uint8_t value);
+
+	uint16_t get_slotWidthSec() const;
+	void set_slotWidthSec(uint16_t value);
+
+	uint16_t get_slotConnects() const;
+	void set_slotConnects(uint16_t value);
+
+	uint16_t get_slotMisses() const;
+	void set_slotMisses(uint16_t value);
+
+	time_t get_deviceStatusDiagTime() const;
+	void set_deviceStatusDiagTime(time_t value);
+
 
 	//Members here are internal only and therefore protected
 protected:
@@ -322,6 +662,8 @@ protected:
 
     //Since these variables are only used internally - They can be private. 
 	static const uint32_t SYS_DATA_MAGIC = 0x20a15e75;
+	// Appending a field needs no new version. To change the size or position of a field,
+	// bump the version and add a MigrationStep from the old layout (see currentStatusData).
 	static const uint16_t SYS_DATA_VERSION = 3;
 
 };  // End of sysStatusData class
@@ -354,6 +696,16 @@ public:
      */
     void loop();
 
+    /**
+     * @brief Load from this object's own file, or its section of the consolidated store (PERSISTENT_SINGLE_FILE)
+     */
+    bool load() override;
+
+    /**
+     * @brief Save to this object's own file, or its section of the consolidated store (PERSISTENT_SINGLE_FILE)
+     */
+    void save() override;
+
 	/**
 	 * @brief Load the appropriate system defaults - good ot initialize a system to "factory settings"
 	 * 
@@ -388,6 +740,17 @@ public:
 		uint16_t threshold1;                            // Sensor-specific threshold 1 (e.g., confidence, distance)
 		uint16_t threshold2;                            // Sensor-specific threshold 2 (e.g., secondary parameter)
 		uint16_t pollingRate;                           // How often to poll the sensor in seconds - a value of zero means no polling
+		uint16_t debounceMs;                            // Event filter: ignore edges closer than this to the previous edge (0 = off)
+		uint16_t refractoryMs;                          // Event filter: dead time after each accepted event (0 = off)
+		uint16_t minPulseMs;                            // Event filter: drop pulses shorter than this when width is known (0 = off)
+		uint8_t maxEventsPerSec;                        // Event filter: cap on accepted events per second (0 = no cap)
+		uint8_t filterDefaultsVersion;                  // 0 on devices upgraded from before the filter fields existed, 1 before AutoTune
+		uint16_t groupBaseMs;                           // PIR high time of a group of one, ms (PIR_GROUP_ESTIMATE)
+		uint16_t groupStepMs;                           // Extra PIR high time per further person, ms (0 = no people estimate)
+		uint8_t autoTune;                               // AutoTune may move refractoryMs and debounceMs within the bounds below
+		uint16_t tuneMinRefractoryMs;                   // AutoTune: lowest refractory it may set
+		uint16_t tuneMaxRefractoryMs;                   // AutoTune: highest refractory it may set
+		uint16_t tuneMaxDebounceMs;                     // AutoTune: highest debounce it may set
 	};
 	SensorData sensorData;
 
@@ -420,9 +783,60 @@ public:
 	void set_threshold1(uint16_t value);
 
 	uint16_t get_threshold2() const;
-	void set_threshold2(uint16_t value);	uint16_t get_pollingRate() const;
+	void set_threshold2(uint16_t value);
+
+	uint16_t get_pollingRate() const;
 	void set_pollingRate(uint16_t value);
 
+	uint16_t get_debounceMs() const;
+	void set_debounceMs(uint16_t value);
+
+	uint16_t get_refractoryMs() const;
+	void set_refractoryMs(uint16_t value);
+
+	uint16_t get_minPulseMs() const;
+	void set_minPulseMs(uint16_t value);
+
+	uint8_t get_maxEventsPerSec() const;
+	void set_maxEventsPerSec(uint8_t value);
+
+	uint8_t get_filterDefaultsVersion() const;
+	void set_filterDefaultsVersion(uint8_t value);
+
+	uint16_t get_groupBaseMs() const;
+	void set_groupBaseMs(uint16_t value);
+
+	uint16_t get_groupStepMs() const;
+	void set_groupStepMs(uint16_t value);
+
+	bool get_autoTune() const;
+	void set_autoTune(bool value);
+
+	uint16_t get_tuneMinRefractoryMs() const;
+	void set_tuneMinRefractoryMs(uint16_t value);
+
+	uint16_t get_tuneMaxRefractoryMs() const;
+	void set_tuneMaxRefractoryMs(uint16_t value);
+
+	uint16_t get_tuneMaxDebounceMs() const;
+	void set_tuneMaxDebounceMs(uint16_t value);
+
+	/**
+	 * @brief Write the default event-filter parameters.
+	 *
+	 * Used by initialize() and when loading a file saved before the
+	 * filter fields were appended (those bytes load as zero).
+	 */
+	void setFilterDefaults();
+
+	/**
+	 * @brief Write the default AutoTune switch and bounds (off).
+	 *
+	 * Used by setFilterDefaults() and when loading a file saved before the
+	 * AutoTune fields were appended (filterDefaultsVersion 1).
+	 */
+	void setTuneDefaults();
+
 		//Members here are internal only and therefore protected
 protected:
     /**
@@ -456,6 +870,7 @@ protected:
 
     //Since these variables are only used internally - They can be private. 
 	static const uint32_t SENSOR_DATA_MAGIC = 0x20a47e74;
+	// Layout changes other than appending need a version bump and a MigrationStep, as for sysStatus
 	static const uint16_t SENSOR_DATA_VERSION = 1;
 }; // End of sensorConfigData class
 
@@ -488,6 +903,18 @@ public:
      */
     void loop();
 
+    /**
+     * @brief Load from this object's own file, or its section of the consolidated store (PERSISTENT_SINGLE_FILE)
+     */
+    bool load() override;
+
+	/**
+	 * @brief Carry the float battery and temperature fields of an older file
+	 *        into their scaled replacements
+	 * 
+	 */
+	void initializeAppended(size_t oldSize) override;
+
 	/**
 	 * @brief Load the appropriate system defaults - good ot initialize a system to "factory settings"
 	 * 
@@ -516,6 +943,43 @@ public:
 	 */
 	void initialize();  
 
+	/** @brief Sensor slots kept in current.dat: the primary and SensorManager::MAX_AUX_SENSORS */
+	static constexpr size_t MAX_SENSOR_SLOTS = 5;
+
+	/** @brief Aggregates for one sensor of a multi-sensor device */
+	struct SensorSlot {
+		uint32_t hourlyCount;                           // Events from this sensor this hour
+		uint32_t dailyCount;                            // Events from this sensor today
+		uint32_t occupiedSec;                           // Today's occupancy sessions this sensor saw events in, in seconds
+		time_t lastEventTime;                           // Its most recent event (0 = none)
+		uint8_t health;                                 // SensorManager::SensorHealth at the last report
+		uint8_t reserved[3];
+	};
+
+	/** @brief Highest alert code the active-alert bitmap holds */
+	static constexpr int8_t MAX_ALERT_CODE = 63;
+
+	/** @brief Active alerts whose first and last raise times are kept */
+	static constexpr size_t MAX_ALERT_RECORDS = 8;
+
+	/** @brief When one active alert was raised */
+	struct AlertRecord {
+		time_t firstSeen;                               // First raiseAlert() since it was last cleared
+		time_t lastSeen;                                // Most recent raiseAlert()
+		uint8_t code;                                   // Alert code (0 = free record)
+		uint8_t count;                                  // raiseAlert() calls since firstSeen (saturates at 255)
+		uint8_t reserved[2];
+	};
+
+	/** @brief SCHEDULED-mode readings of one sensor since the last report */
+	struct SampleStats {
+		uint16_t minValue;                              // Smallest primary value
+		uint16_t maxValue;                              // Largest primary value
+		uint32_t sum;                                   // Sum of the readings, for the mean
+		uint16_t count;                                 // Readings (0 = none; the other fields are stale)
+		uint16_t reserved;
+	};
+
 	class CurrentData {
 	public:
 		// This structure must always begin with the header (16 bytes)
@@ -529,22 +993,107 @@ public:
 		uint16_t gestureType;                           // Gesure observed
 		uint16_t gestureScore;                          // faceNumber to the object in cm
 		time_t lastCountTime;							// Last time a count was made
-		float internalTempC;                            // Enclosure temperature in degrees C
+		float internalTempCFloat;                       // Unused: see internalTempCenti
 		float externalTempC;							// Temp Sensor at the ultrasonic device
 		uint8_t alertCode;								// Current Alert Code
 		time_t lastAlertTime;
-		float stateOfCharge;                            // Battery charge level
+		float stateOfChargeFloat;                       // Unused: see socTenths
 		uint8_t batteryState;                           // Stores the current battery state
 		
 		// ********** Counting Mode Fields **********
-		uint16_t hourlyCount;                           // Events counted this hour
-		uint16_t dailyCount;                            // Events counted today
+		uint32_t hourlyCount;                           // Events counted this hour (16 bits in version 1)
+		uint32_t dailyCount;                            // Events counted today (16 bits in version 1)
 		
 		// ********** Occupancy Mode Fields **********
 		bool occupied;                                  // Is the space currently occupied? (occupancy mode)
-		uint32_t lastOccupancyEvent;                    // Timestamp of last occupancy detection (millis) - uint32_t to match millis() return type
+		uint32_t lastOccupancyEventV1;                  // Unused: raw millis(), meaningless after a reset (see lastOccupancyEvent)
 		time_t occupancyStartTime;                      // When current occupancy session started (epoch time)
 		uint32_t totalOccupiedSeconds;                  // Total occupied time today (in seconds)
+
+		// ********** Counter Journal **********
+		uint16_t journalGeneration;                     // Bumped on every save; journal records from older generations are already included
+
+		// ********** Last Published Report (report suppression) **********
+		time_t lastPublishedTime;                       // Timestamp of the last hourly report actually queued (0 = none)
+		uint32_t lastPublishedDaily;                    // dailyCount in that report (16 bits in version 1)
+		float lastPublishedSocFloat;                    // Unused: see lastPublishedSocTenths
+		float lastPublishedTempCFloat;                  // Unused: see lastPublishedTempCenti
+		uint8_t lastPublishedBatteryState;              // batteryState in that report
+		uint8_t lastPublishedAlert;                     // alertCode in that report
+		uint8_t lastPublishedResets;                    // resetCount in that report
+		uint8_t reportsSuppressed;                      // Hourly reports skipped since that report
+
+		// ********** Energy Ledger **********
+		uint32_t energySec[12];                         // Seconds today in each EnergyLedger bucket
+		time_t energyHibernateStart;                    // When the last HIBERNATE began (0 = not hibernating)
+
+		// ********** Intra-hour Count Bins **********
+		uint8_t countBins[12];                          // Events in each 5-minute slot of this hour (saturate at 255)
+
+		// ********** Occupancy Session Statistics **********
+		uint16_t sessionCount;                          // Occupancy sessions closed today
+		uint32_t sessionMinSec;                         // Shortest of them (0 = none yet)
+		uint32_t sessionMaxSec;                         // Longest of them
+		uint16_t sessionHist[6];                        // Sessions by length, OccupancyStats buckets
+		time_t peakHourStart;                           // UTC hour with the most occupied seconds today (0 = none)
+		uint32_t peakHourSec;                           // Occupied seconds in that hour
+		time_t runHourStart;                            // UTC hour being accumulated
+		uint32_t runHourSec;                            // Occupied seconds so far in that hour
+
+		// ********** Per-sensor Slots **********
+		SensorSlot sensorSlots[MAX_SENSOR_SLOTS];       // Indexed by SensorEvent::source()
+
+		// ********** Scheduled Sampling **********
+		time_t lastSampleTime;                          // pollingRate boundary of the last SCHEDULED sample (0 = none)
+		SampleStats sampleStats[MAX_SENSOR_SLOTS];      // Indexed like sensorSlots
+
+		// ********** Active Alerts **********
+		uint64_t activeAlerts;                          // Bit n set while alert code n is active; alertCode is the most severe of them
+		AlertRecord alertRecords[MAX_ALERT_RECORDS];    // Raise times of active alerts, in no particular order
+
+		// ********** Energy Ledger, Power Domains **********
+		uint32_t energyDomainSec[3];                    // Seconds today each PowerDomains domain was on
+
+		// ********** Direction Counts (DUAL_PIR) **********
+		uint32_t directionHourly[2];                    // Crossings this hour, [DIRECTION_IN] and [DIRECTION_OUT]
+		uint32_t directionDaily[2];                     // Crossings today, same order
+
+		// ********** Energy Ledger, Power Domains (cont.) **********
+		uint32_t energyRangeSec;                        // Seconds today PowerDomains::RANGE was on; domain 3 of get_energyDomainSec()
+
+		// ********** Policy Experiment (PowerPolicy) **********
+		uint32_t policyTally[5];                        // Connect and report tallies today, by PolicyTally
+		uint8_t policyVariantDay;                       // Variant in effect since the daily reset (POLICY_VARIANT_MIXED = changed during the day)
+
+		// ********** Data Usage (DataUsage) **********
+		uint32_t dataBytes[9];                          // Estimated cloud bytes today, by DataUsage::Category
+
+		// ********** Count Buckets (sysStatus bucketSec) **********
+		time_t bucketStart;                             // Start of bucket 0, a multiple of bucketSec
+		uint16_t bucketSec;                             // Bucket length for this report (0 = no buckets)
+		uint16_t buckets[24];                           // Events in each bucket since bucketStart (saturate at 65535)
+
+		// ********** Connection Stability (ConnectHistory) **********
+		uint16_t cloudDrops;                            // Cloud disconnects today the firmware did not start
+		uint16_t cloudReconnects;                       // Cloud connects today that followed a drop
+		uint32_t cloudDropAfterSec;                     // Sum of the connected time before each drop today
+		uint16_t flapDamps;                             // Times today connects were held off for flapping
+
+		uint64_t lastOccupancyEvent;                    // MonoClock::nowMs() of the last occupancy detection (0 = none)
+
+		// ********** Group Estimate (PIR_GROUP_ESTIMATE) **********
+		uint32_t hourlyPeople;                          // People estimated from PIR pulse widths this hour
+		uint32_t dailyPeople;                           // People estimated from PIR pulse widths today
+
+		// ********** Battery and Enclosure, Scaled Integers **********
+		int16_t internalTempCenti;                      // Enclosure temperature in hundredths of a degree C
+		uint16_t socTenths;                             // Battery charge in tenths of a percent
+		int16_t lastPublishedTempCenti;                 // internalTempCenti in the last published report
+		uint16_t lastPublishedSocTenths;                // socTenths in that report
+
+		// ********** Hourly History (HourlyHistory) **********
+		uint32_t historyDailyBase;                      // dailyCount at the last HourlyHistory record
+		uint32_t historyOccupiedBase;                   // totalOccupiedSeconds at that record
 	};
 	CurrentData currentData;
 
@@ -572,6 +1121,22 @@ public:
 	 * 
 	 */
 
+	/**
+	 * @brief Start a scoped batch of set calls
+	 * 
+	 * @details Takes the lock once; the set calls made while the returned object is in scope
+	 * only write their fields, and the structure is hashed and a save scheduled once when
+	 * it goes out of scope or commit() is called.
+	 * 
+	 *     auto batch = current.updateBatch();
+	 *     current.set_...(...);
+	 *     current.set_...(...);
+	 * 
+	 * @returns The batch; keep it in a local variable
+	 * 
+	 */
+	UpdateBatch updateBatch() { return UpdateBatch(*this); }
+
 	uint16_t get_faceNumber() const;
 	void set_faceNumber(uint16_t value);
 
@@ -587,8 +1152,8 @@ public:
 	time_t get_lastCountTime() const;
 	void set_lastCountTime(time_t value);
 
-	float get_internalTempC() const ;
-	void set_internalTempC(float value);
+	int16_t get_internalTempCenti() const;
+	void set_internalTempCenti(int16_t value);
 
 	float get_externalTempC() const ;
 	void set_externalTempC(float value);
@@ -603,33 +1168,57 @@ public:
 	 * existing code to the new one and only overwrites when the new alert is
 	 * more severe. This prevents a later, less serious warning from masking a
 	 * prior critical condition.
+	 *
+	 * Every raised alert is also set in activeAlerts, with its first and last
+	 * raise times in an AlertRecord, so the masked ones are still reported.
 	 */
 	void raiseAlert(int8_t value);
 
+	/**
+	 * @brief Clear one alert that has recovered
+	 *
+	 * @details Clears its bit and record. If it was alertCode, the most severe
+	 * alert still active takes its place (0 if none), so clearing one alert does
+	 * not hide the others. Use this rather than set_alertCode(0).
+	 */
+	void clearAlert(int8_t value);
+
+	/**
+	 * @brief Whether alert @p value is active, whether or not it is alertCode
+	 */
+	bool isAlertActive(int8_t value) const;
+
+	uint64_t get_activeAlerts() const;
+
+	/**
+	 * @brief Copy of one alert record (code 0 = free)
+	 */
+	AlertRecord get_alertRecord(size_t index) const;
+
 	time_t get_lastAlertTime() const;
 	void set_lastAlertTime(time_t value);
 
-	float get_stateOfCharge() const;
-	void set_stateOfCharge(float value);
+	uint16_t get_socTenths() const;
+	void set_socTenths(uint16_t value);
 
 	uint8_t get_batteryState() const;
 	void set_batteryState(uint8_t value);
 
 	// ********** Counting Mode Get/Set Functions **********
 	
-	uint16_t get_hourlyCount() const;
-	void set_hourlyCount(uint16_t value);
+	uint32_t get_hourlyCount() const;
+	void set_hourlyCount(uint32_t value);
 
-	uint16_t get_dailyCount() const;
-	void set_dailyCount(uint16_t value);
+	uint32_t get_dailyCount() const;
+	void set_dailyCount(uint32_t value);
 
 	// ********** Occupancy Mode Get/Set Functions **********
 	
 	bool get_occupied() const;
 	void set_occupied(bool value);
 
-	uint32_t get_lastOccupancyEvent() const;
-	void set_lastOccupancyEvent(uint32_t value);
+	uint64_t get_lastOccupancyEvent() const;
+	void set_lastOccupancyEvent(uint64_t value);
 
 	time_t get_occupancyStartTime() const;
 	void set_occupancyStartTime(time_t value);
@@ -637,6 +1226,228 @@ public:
 	uint32_t get_totalOccupiedSeconds() const;
 	void set_totalOccupiedSeconds(uint32_t value);
 
+	uint16_t get_journalGeneration() const;
+
+	time_t get_lastPublishedTime() const;
+	uint32_t get_lastPublishedDaily() const;
+	uint16_t get_lastPublishedSocTenths() const;
+	int16_t get_lastPublishedTempCenti() const;
+	uint8_t get_lastPublishedBatteryState() const;
+	uint8_t get_lastPublishedAlert() const;
+	uint8_t get_lastPublishedResets() const;
+
+	uint8_t get_reportsSuppressed() const;
+	void set_reportsSuppressed(uint8_t value);
+
+	uint32_t get_energySec(size_t bucket) const;
+	void set_energySec(size_t bucket, uint32_t value);
+
+	/** @brief PowerDomains domains with an energy total: energyDomainSec[] and energyRangeSec */
+	static constexpr size_t ENERGY_DOMAINS = 4;
+
+	uint32_t get_energyDomainSec(size_t domain) const;
+	void set_energyDomainSec(size_t domain, uint32_t value);
+
+	time_t get_energyHibernateStart() const;
+	void set_energyHibernateStart(time_t value);
+
+	uint8_t get_countBin(size_t bin) const;
+	void set_countBin(size_t bin, uint8_t value);
+
+	/**
+	 * @brief Zero all the intra-hour count bins in one batched update
+	 */
+	void clearCountBins();
+
+	uint16_t get_sessionCount() const;
+	void set_sessionCount(uint16_t value);
+
+	uint32_t get_sessionMinSec() const;
+	void set_sessionMinSec(uint32_t value);
+
+	uint32_t get_sessionMaxSec() const;
+	void set_sessionMaxSec(uint32_t value);
+
+	uint16_t get_sessionHist(size_t bucket) const;
+	void set_sessionHist(size_t bucket, uint16_t value);
+
+	time_t get_peakHourStart() const;
+	void set_peakHourStart(time_t value);
+
+	uint32_t get_peakHourSec() const;
+	void set_peakHourSec(uint32_t value);
+
+	time_t get_runHourStart() const;
+	void set_runHourStart(time_t value);
+
+	uint32_t get_runHourSec() const;
+	void set_runHourSec(uint32_t value);
+
+	/**
+	 * @brief Copy of one sensor slot (all zero for an index out of range)
+	 */
+	SensorSlot get_sensorSlot(size_t slot) const;
+
+	void set_sensorHealth(size_t slot, uint8_t health);
+
+	/**
+	 * @brief Tally a batch of events into the slots of the sensors that produced them
+	 * 
+	 * @details Adds to each slot's hourly and daily counts and sets its lastEventTime, and
+	 * counts the crossings of a directional sensor (DUAL_PIR) in and out. The
+	 * slots are only changed in RAM and reach current.dat with the next save, which the
+	 * counting or occupancy update for the same batch schedules; with COUNTER_RETAINED or
+	 * COUNTER_JOURNAL a reset before that save loses the per-sensor split, not the totals.
+	 * 
+	 */
+	void noteSensorEvents(const SensorEvent *events, size_t count);
+
+	/**
+	 * @brief Add a closed occupancy session to the slots in @p slotMask (bit n = slot n)
+	 */
+	void addSensorOccupiedSeconds(uint8_t slotMask, uint32_t seconds);
+
+	/**
+	 * @brief Zero every slot's hourly count and the hourly direction counts, after the hourly report
+	 */
+	void clearSensorHourlyCounts();
+
+	/** @brief Index into the direction counts */
+	enum Direction : uint8_t { DIRECTION_IN, DIRECTION_OUT };
+
+	/**
+	 * @brief Crossings in @p dir this hour / today, tallied by noteSensorEvents() from
+	 *        SensorEvent::DIR_IN and DIR_OUT (0 for an index out of range)
+	 */
+	uint32_t get_directionHourly(size_t dir) const;
+	uint32_t get_directionDaily(size_t dir) const;
+
+	/** @brief Index into the policy experiment tallies, zeroed with the day */
+	enum PolicyTally : uint8_t {
+		POLICY_CONNECTS,            ///< Successful cloud connects
+		POLICY_CONNECT_FAILS,       ///< Connect attempts that ran out of budget
+		POLICY_CONNECT_SEC,         ///< Seconds the successful connects took
+		POLICY_REPORTS_QUEUED,      ///< Hourly reports queued
+		POLICY_REPORTS_CONFIRMED,   ///< Reports confirmed by a webhook response
+		POLICY_TALLIES
+	};
+
+	/** @brief policyVariantDay when the variant changed during the day */
+	static constexpr uint8_t POLICY_VARIANT_MIXED = 0xff;
+
+	uint32_t get_policyTally(size_t tally) const;
+	void addPolicyTally(size_t tally, uint32_t amount);
+
+	uint8_t get_policyVariantDay() const;
+	void set_policyVariantDay(uint8_t value);
+
+	/** @brief DataUsage categories with a daily total in dataBytes[] */
+	static constexpr size_t DATA_CATEGORIES = 9;
+
+	uint32_t get_dataBytes(size_t category) const;
+	void set_dataBytes(size_t category, uint32_t value);
+
+	/** @brief Count buckets per report; later counts go in the last one */
+	static constexpr size_t MAX_BUCKETS = 24;
+
+	time_t get_bucketStart() const;
+	uint16_t get_bucketSec() const;
+	uint16_t get_bucket(size_t bucket) const;
+
+	/**
+	 * @brief Zero the count buckets and start the next report's at the bucket containing @p now
+	 *
+	 * @param bucketSec sysStatus bucketSec; 0 turns buckets off, others are held to 60-3600
+	 *        and raised so that MAX_BUCKETS of them cover @p reportSec from a rounded-down start
+	 * @param reportSec Reporting interval the buckets must cover
+	 */
+	void startBuckets(time_t now, uint16_t bucketSec, uint16_t reportSec);
+
+	uint16_t get_cloudDrops() const;
+	void set_cloudDrops(uint16_t value);
+
+	uint16_t get_cloudReconnects() const;
+	void set_cloudReconnects(uint16_t value);
+
+	uint32_t get_cloudDropAfterSec() const;
+	void set_cloudDropAfterSec(uint32_t value);
+
+	uint16_t get_flapDamps() const;
+	void set_flapDamps(uint16_t value);
+
+	uint32_t get_hourlyPeople() const;
+	void set_hourlyPeople(uint32_t value);
+
+	uint32_t get_dailyPeople() const;
+	void set_dailyPeople(uint32_t value);
+
+	/**
+	 * @brief Add people estimated from PIR pulse widths to the hourly and daily totals
+	 */
+	void addPeople(uint16_t people);
+
+	uint32_t get_historyDailyBase() const;
+	uint32_t get_historyOccupiedBase() const;
+
+	/**
+	 * @brief Note the daily totals an HourlyHistory record has taken in
+	 */
+	void setHistoryBase(uint32_t daily, uint32_t occupiedSec);
+
+	time_t get_lastSampleTime() const;
+
+	/**
+	 * @brief Copy of one sensor's sample aggregate (all zero for an index out of range)
+	 */
+	SampleStats get_sampleStats(size_t slot) const;
+
+	/**
+	 * @brief Fold one scheduled sample of every sensor into the aggregates
+	 * 
+	 * @details One batched update that also sets lastSampleTime to @p boundary.
+	 * 
+	 * @param values primary value of each slot, @p count entries
+	 * @param valid  false for a slot whose reading failed; it is left out
+	 */
+	void addSamples(time_t boundary, const uint16_t *values, const bool *valid, size_t count);
+
+	/**
+	 * @brief Zero every sample aggregate, after the report that carried them
+	 */
+	void clearSampleStats();
+
+	/**
+	 * @brief Remember the fields of an hourly report that was queued, for report suppression
+	 * 
+	 * @details One batched update; also clears reportsSuppressed.
+	 * 
+	 */
+	void recordPublishedReport(time_t timestamp, uint32_t daily, uint16_t socTenths, int16_t tempCenti, uint8_t batteryState, uint8_t alert, uint8_t resets);
+
+	/**
+	 * @brief Add counted events to the hourly and daily counts and set lastCountTime
+	 * 
+	 * @details With COUNTER_RETAINED the counts are kept in retained memory and current.dat
+	 * is only written at a checkpoint. With COUNTER_JOURNAL the change is appended to the
+	 * counter journal and current.dat is only rewritten when the journal is compacted or
+	 * another field changes. Otherwise this is a single batched update of the three fields.
+	 * 
+	 */
+	void addCounts(uint16_t events, time_t lastCountTime);
+
+	/**
+	 * @brief Writes current.dat; with COUNTER_RETAINED or COUNTER_JOURNAL this also starts a new counter generation
+	 */
+	void save() override;
+
+	/**
+	 * @brief Write current.dat now if anything is pending, including retained-only counts
+	 * 
+	 * @details Call before HIBERNATE or anything else that loses retained memory.
+	 * 
+	 */
+	void checkpoint();
+
 
 		//Members here are internal only and therefore protected
 protected:
@@ -669,9 +1480,18 @@ protected:
      */
     static currentStatusData *_instance;
 
+	/**
+	 * @brief Add counted events to the 5-minute bin (COUNT_BINS_ENABLED) and the report bucket of @p countTime
+	 *
+	 * @details Called by addCounts() for every path. Writes CurrentData under the lock
+	 * without hashing; the bins reach current.dat with the counts' next save.
+	 */
+	void addToBins(uint16_t events, time_t countTime);
+
     //Since these variables are only used internally - They can be private. 
 	static const uint32_t CURRENT_DATA_MAGIC = 0x20a99e74;
-	static const uint16_t CURRENT_DATA_VERSION = 1;
+	// Each older version has a MigrationStep in MyPersistentData.cpp, so an update keeps the counts
+	static const uint16_t CURRENT_DATA_VERSION = 2;   // 2: 32-bit hourlyCount, dailyCount and lastPublishedDaily
 };
 
 
@@ -0,0 +1,64 @@
+#include "OccupancyNotify.h"
+#include "Config.h"
+#include "MyPersistentData.h"
+#include "Payload.h"
+#include "ProjectConfig.h"
+#include "PublishQueuePosixRK.h"
+
+namespace OccupancyNotify {
+
+static bool pending = false;        // A change is waiting for its window to end
+static uint32_t windowStartMs = 0;  // First change of the window
+static bool occupiedNow = false;    // Newest state and when it began
+static time_t since = 0;
+static int8_t sentState = -1;       // State in the last event (-1 = none since boot)
+
+void noteChange(bool occupied, time_t changedAt) {
+    if (sysStatus.get_occupancyNotifySec() == 0) {
+        return;
+    }
+    if (!pending) {
+        pending = true;
+        windowStartMs = millis();
+    }
+    occupiedNow = occupied;
+    since = changedAt;
+}
+
+bool loop() {
+    uint32_t windowSec = sysStatus.get_occupancyNotifySec();
+    if (windowSec == 0) {
+        pending = false;
+        return true;
+    }
+    if (windowSec < OCCUPANCY_NOTIFY_MIN_SEC) {
+        windowSec = OCCUPANCY_NOTIFY_MIN_SEC;
+    }
+    if (!pending || millis() - windowStartMs < windowSec * 1000UL || !Particle.connected()) {
+        return true;
+    }
+
+    pending = false;
+    if (sentState == (int8_t)occupiedNow) {
+        Log.info("Occupancy back to %s within the window; nothing sent", occupiedNow ? "occupied" : "unoccupied");
+        return true;
+    }
+
+    static const Payload::Field occupancySchema[] = {
+        {"o", Payload::INT, 0},
+        {"s", Payload::UINT, 0},
+    };
+    Payload::Value values[sizeof(occupancySchema) / sizeof(occupancySchema[0])];
+    values[0].i = occupiedNow ? 1 : 0;
+    values[1].u = (uint32_t)since;
+
+    char data[40];
+    Payload::Writer(data, sizeof(data)).beginObject().writeFields(occupancySchema, values, sizeof(values) / sizeof(values[0])).endObject();
+    if (PublishQueuePosix::instance().publishToLane(ProjectConfig::LANE_ALERT, ProjectConfig::occupancyEventName(), data, PRIVATE | WITH_ACK)) {
+        sentState = occupiedNow ? 1 : 0;
+        Log.info("Occupancy change: %s", data);
+    }
+    return true;
+}
+
+} // namespace OccupancyNotify
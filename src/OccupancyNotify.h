@@ -0,0 +1,41 @@
+/**
+ * @file OccupancyNotify.h
+ * @brief Occupied / unoccupied change events for OCCUPANCY mode.
+ *
+ * @details With sysStatus occupancyNotifySec set, a change of state starts
+ *          a window of that many seconds (at least OCCUPANCY_NOTIFY_MIN_SEC).
+ *          At its end the state is sent as one occupancyEventName() event,
+ *          {"o":<0|1>,"s":<epoch of the last change>}, unless it is back to
+ *          the state last sent: a space that flaps inside the window sends
+ *          one update or none.
+ *
+ *          The event is only queued while connected, so no mode is made to
+ *          connect for it. In CONNECTED mode it goes out at the end of the
+ *          window; in LOW_POWER and DISCONNECTED modes the newest state
+ *          goes out on the next connection and the changes between are
+ *          coalesced into it. It uses the highest-priority publish lane so
+ *          it is not held behind a report backlog.
+ */
+
+#ifndef __OCCUPANCYNOTIFY_H
+#define __OCCUPANCYNOTIFY_H
+
+#include "Particle.h"
+
+namespace OccupancyNotify {
+
+/**
+ * @brief The space became @p occupied at @p since (from the occupancy handlers)
+ */
+void noteChange(bool occupied, time_t since);
+
+/**
+ * @brief Send the state once its window has passed (TaskScheduler task)
+ *
+ * @return true (TaskScheduler task)
+ */
+bool loop();
+
+} // namespace OccupancyNotify
+
+#endif /* __OCCUPANCYNOTIFY_H */
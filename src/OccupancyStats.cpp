@@ -0,0 +1,69 @@
+#include "OccupancyStats.h"
+#include "MyPersistentData.h"
+
+namespace OccupancyStats {
+
+static size_t bucketFor(uint32_t sec) {
+    for (size_t ii = 0; ii < NUM_BUCKETS - 1; ii++) {
+        if (sec < BUCKET_LIMIT_SEC[ii]) {
+            return ii;
+        }
+    }
+    return NUM_BUCKETS - 1;
+}
+
+// Close the running hour if it beats the peak
+static void foldRunningHour() {
+    if (current.get_runHourSec() > current.get_peakHourSec()) {
+        current.set_peakHourStart(current.get_runHourStart());
+        current.set_peakHourSec(current.get_runHourSec());
+    }
+}
+
+void recordSession(time_t start, time_t end) {
+    if (end < start) {
+        return;
+    }
+    uint32_t sec = (uint32_t)(end - start);
+
+    auto update = current.updateBatch();
+    uint16_t count = current.get_sessionCount();
+    if (count < 0xffff) {
+        current.set_sessionCount(count + 1);
+    }
+    if (count == 0 || sec < current.get_sessionMinSec()) {
+        current.set_sessionMinSec(sec);
+    }
+    if (sec > current.get_sessionMaxSec()) {
+        current.set_sessionMaxSec(sec);
+    }
+    size_t bucket = bucketFor(sec);
+    uint16_t inBucket = current.get_sessionHist(bucket);
+    if (inBucket < 0xffff) {
+        current.set_sessionHist(bucket, inBucket + 1);
+    }
+
+    // Spread the session over the UTC hours it covers
+    time_t at = start;
+    while (at < end) {
+        time_t hourStart = at - (at % 3600);
+        time_t chunkEnd = (end < hourStart + 3600) ? end : hourStart + 3600;
+        if (hourStart != current.get_runHourStart()) {
+            foldRunningHour();
+            current.set_runHourStart(hourStart);
+            current.set_runHourSec(0);
+        }
+        current.set_runHourSec(current.get_runHourSec() + (uint32_t)(chunkEnd - at));
+        at = chunkEnd;
+    }
+}
+
+time_t peakHourStart() {
+    return (current.get_runHourSec() > current.get_peakHourSec()) ? current.get_runHourStart() : current.get_peakHourStart();
+}
+
+uint32_t peakHourSec() {
+    return (current.get_runHourSec() > current.get_peakHourSec()) ? current.get_runHourSec() : current.get_peakHourSec();
+}
+
+} // namespace OccupancyStats
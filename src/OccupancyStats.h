@@ -0,0 +1,41 @@
+/**
+ * @file OccupancyStats.h
+ * @brief Per-day occupancy session statistics, kept incrementally.
+ *
+ * @details Each closed session updates a handful of counters in current:
+ *          the session count, shortest and longest session, a six-bucket
+ *          length histogram, and the UTC hour with the most occupied
+ *          seconds. The mean is totalOccupiedSeconds / sessionCount. The
+ *          peak hour is found by splitting each session across the hours it
+ *          spans and keeping only the running hour and the best hour so far,
+ *          which works because sessions close in time order. Everything is
+ *          reset with the other daily counts.
+ */
+
+#ifndef __OCCUPANCYSTATS_H
+#define __OCCUPANCYSTATS_H
+
+#include "Particle.h"
+
+namespace OccupancyStats {
+
+/** @brief Histogram buckets; must match current sessionHist[]. */
+static constexpr size_t NUM_BUCKETS = 6;
+
+/** @brief Upper bounds (exclusive) of the first five buckets, seconds: <1 min, <5 min, <15 min, <1 h, <4 h, longer. */
+static constexpr uint32_t BUCKET_LIMIT_SEC[NUM_BUCKETS - 1] = {60, 300, 900, 3600, 14400};
+
+/**
+ * @brief A session from @p start to @p end (Unix seconds) has closed
+ */
+void recordSession(time_t start, time_t end);
+
+/** @brief UTC start of the busiest hour today, or 0 if no session has closed. */
+time_t peakHourStart();
+
+/** @brief Occupied seconds in that hour. */
+uint32_t peakHourSec();
+
+} // namespace OccupancyStats
+
+#endif /* __OCCUPANCYSTATS_H */
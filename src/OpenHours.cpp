@@ -0,0 +1,249 @@
+#include "OpenHours.h"
+#include "LocalOffset.h"
+#include "LocalTimeRK.h"
+#include "MyPersistentData.h"
+
+namespace OpenHours {
+
+// One open or close, in UTC
+struct Transition {
+    time_t at;
+    bool opens;
+};
+
+// Two days of opens and closes: one of each per day with openHour/closeHour
+// (plus the first of the third day), or a few per day with a weekly
+// schedule that has a midday closure
+static constexpr size_t MAX_TRANSITIONS = 16;
+static constexpr time_t LOOKAHEAD_SEC = 48 * 3600;
+static constexpr time_t REBUILD_SEC = 24 * 3600;
+
+static bool tableValid = false;
+static Transition table[MAX_TRANSITIONS];
+static size_t tableCount = 0;
+static bool openAtBuild = true;     // Open/closed before table[0]
+static time_t builtAt = 0;          // Time.now() when the table was built
+static time_t builtUntil = 0;       // Last time covered by the table
+static uint8_t builtOpenHour = 0;
+static uint8_t builtCloseHour = 0;
+
+// Weekly schedule, copied from sysStatus when the table is built
+static uint8_t week[WEEK_BYTES];
+static bool weekActive = false;
+
+static void loadWeek() {
+    weekActive = false;
+    for (size_t ii = 0; ii < WEEK_BYTES; ii++) {
+        week[ii] = sysStatus.get_weekSchedule(ii);
+        weekActive = weekActive || week[ii] != 0;
+    }
+}
+
+static bool openAtHourOfWeek(LocalTimeConvert &conv) {
+    int hourOfWeek = conv.getLocalTimeYMD().getDayOfWeek() * 24 + conv.getLocalTimeHMS().hour;
+    if (hourOfWeek < 0 || hourOfWeek >= (int)WEEK_BYTES * 8) {
+        return true;
+    }
+    return (week[hourOfWeek / 8] & (0x80 >> (hourOfWeek % 8))) != 0;
+}
+
+static bool openAtHour(uint8_t hour, uint8_t openHour, uint8_t closeHour) {
+    if (openHour < closeHour) {
+        // Simple daytime window, e.g. 6 -> 22
+        return (hour >= openHour) && (hour < closeHour);
+    } else if (openHour > closeHour) {
+        // Overnight window, e.g. 20 -> 6
+        return (hour >= openHour) || (hour < closeHour);
+    }
+    // openHour == closeHour: treat as always open
+    return true;
+}
+
+static void build(time_t now) {
+    builtOpenHour = sysStatus.get_openTime();
+    builtCloseHour = sysStatus.get_closeTime();
+    builtAt = now;
+    tableCount = 0;
+
+    loadWeek();
+
+    LocalTimeConvert conv;
+    conv.withConfig(LocalTime::instance().getConfig()).withTime(now).convert();
+
+    if (weekActive) {
+        // Walk the local hours; nextHour() follows the timezone's DST rules
+        openAtBuild = openAtHourOfWeek(conv);
+        bool open = openAtBuild;
+        while (tableCount < MAX_TRANSITIONS && conv.time - now <= LOOKAHEAD_SEC) {
+            conv.nextHour();
+            bool openThen = openAtHourOfWeek(conv);
+            if (openThen != open) {
+                open = openThen;
+                table[tableCount].at = conv.time;
+                table[tableCount].opens = open;
+                tableCount++;
+            }
+        }
+        builtUntil = conv.time;
+        tableValid = true;
+        Log.info("Weekly schedule: %s, %u opens/closes in the next 48 h", openAtBuild ? "OPEN" : "CLOSED",
+                 (unsigned)tableCount);
+        return;
+    }
+
+    uint8_t hour = (uint8_t)(conv.getLocalTimeHMS().toSeconds() / 3600);
+    openAtBuild = openAtHour(hour, builtOpenHour, builtCloseHour);
+
+    // Walk forward one transition at a time; nextTime() follows the
+    // timezone's DST rules, so a window across a change is still exact.
+    // 0-24 is the same hour on the clock: always open, no transitions.
+    if (builtOpenHour % 24 != builtCloseHour % 24) {
+        bool open = openAtBuild;
+        while (tableCount < MAX_TRANSITIONS) {
+            LocalTimeHMS next;
+            next.hour = (int8_t)((open ? builtCloseHour : builtOpenHour) % 24);   // closeHour 24 is midnight
+            time_t before = conv.time;
+            conv.nextTime(next);
+            if (conv.time <= before) {
+                break;
+            }
+            open = !open;
+            table[tableCount].at = conv.time;
+            table[tableCount].opens = open;
+            tableCount++;
+            if (conv.time - now > LOOKAHEAD_SEC) {
+                break;
+            }
+        }
+    }
+    builtUntil = (tableCount > 0) ? table[tableCount - 1].at : now + REBUILD_SEC;
+    tableValid = true;
+
+    if (tableCount > 0) {
+        Log.info("Open hours %02u-%02u: %s, %u opens/closes in the next 48 h, next %s at %s",
+                 builtOpenHour, builtCloseHour, openAtBuild ? "OPEN" : "CLOSED", (unsigned)tableCount,
+                 table[0].opens ? "open" : "close", Time.format(table[0].at, TIME_FORMAT_DEFAULT).c_str());
+    } else {
+        Log.info("Open hours %02u-%02u: always open", builtOpenHour, builtCloseHour);
+    }
+}
+
+// Build the table if it is missing, stale or no longer matches the settings
+static void refresh(time_t now) {
+    bool stale = !tableValid || now < builtAt || now - builtAt >= REBUILD_SEC || now >= builtUntil ||
+                 sysStatus.get_openTime() != builtOpenHour || sysStatus.get_closeTime() != builtCloseHour;
+    if (stale) {
+        build(now);
+    }
+}
+
+// First transition after now, or nullptr if always open
+static const Transition *nextTransition(time_t now) {
+    for (size_t ii = 0; ii < tableCount; ii++) {
+        if (table[ii].at > now) {
+            return &table[ii];
+        }
+    }
+    return nullptr;
+}
+
+bool isOpen() {
+    if (!Time.isValid()) {
+        return true;
+    }
+    time_t now = Time.now();
+    refresh(now);
+    const Transition *next = nextTransition(now);
+    if (!next) {
+        return openAtBuild;
+    }
+    // Open until a close, closed until an open
+    return !next->opens;
+}
+
+int secondsUntilNextOpen() {
+    if (!Time.isValid()) {
+        return 3600;    // Fallback: 1 hour if time is not yet valid
+    }
+    time_t now = Time.now();
+    refresh(now);
+    for (size_t ii = 0; ii < tableCount; ii++) {
+        if (table[ii].opens && table[ii].at > now) {
+            return (int)(table[ii].at - now);
+        }
+    }
+    if (!isOpen() && builtUntil > now) {
+        return (int)(builtUntil - now);     // Closed for the whole table (weekly schedule)
+    }
+    return 3600;        // Always open; should not normally be asked
+}
+
+bool setWeekSchedule(const char *hex) {
+    size_t len = hex ? strlen(hex) : 0;
+    if (len != 0 && len != WEEK_BYTES * 2) {
+        return false;
+    }
+    uint8_t bytes[WEEK_BYTES] = {0};
+    for (size_t ii = 0; ii < len; ii++) {
+        char c = hex[ii];
+        uint8_t nibble;
+        if (c >= '0' && c <= '9') {
+            nibble = c - '0';
+        } else if (c >= 'A' && c <= 'F') {
+            nibble = c - 'A' + 10;
+        } else if (c >= 'a' && c <= 'f') {
+            nibble = c - 'a' + 10;
+        } else {
+            return false;
+        }
+        bytes[ii / 2] |= (ii % 2) ? nibble : (uint8_t)(nibble << 4);
+    }
+    for (size_t ii = 0; ii < WEEK_BYTES; ii++) {
+        sysStatus.set_weekSchedule(ii, bytes[ii]);
+    }
+    invalidate();
+    return true;
+}
+
+void weekScheduleString(char *buf, size_t size) {
+    if (size == 0) {
+        return;
+    }
+    buf[0] = 0;
+    if (size < WEEK_BYTES * 2 + 1) {
+        return;
+    }
+    bool any = false;
+    for (size_t ii = 0; ii < WEEK_BYTES; ii++) {
+        uint8_t value = sysStatus.get_weekSchedule(ii);
+        snprintf(&buf[ii * 2], 3, "%02X", value);
+        any = any || value != 0;
+    }
+    if (!any) {
+        buf[0] = 0;
+    }
+}
+
+time_t nextMidnightAfter(time_t time) {
+    LocalTimeConvert conv;
+    conv.withConfig(LocalTime::instance().getConfig()).withTime(time).convert();
+    conv.nextDayMidnight();
+    return conv.time;
+}
+
+void reloadTimezone() {
+    char tz[sizeof(sysStatusData::SysData::timeZoneStr)];
+    sysStatus.get_timeZoneStr(tz, sizeof(tz));
+    if (tz[0]) {
+        LocalTime::instance().withConfig(LocalTimePosixTimezone(tz));
+        LocalOffset::reload(tz);
+    }
+    sysStatus.set_nextLocalMidnight(0);
+    invalidate();
+}
+
+void invalidate() {
+    tableValid = false;
+}
+
+} // namespace OpenHours
@@ -0,0 +1,82 @@
+/**
+ * @file OpenHours.h
+ * @brief Precomputed open/close schedule for the park's opening hours.
+ *
+ * @details Once a day, and whenever openHour, closeHour or the timezone
+ *          change, a small table of the UTC times of every open and close
+ *          in the next 48 hours is built with LocalTimeConvert::nextTime(),
+ *          so DST changes from the timezone's POSIX rules are included.
+ *          isOpen() and secondsUntilNextOpen() are then lookups against
+ *          Time.now(), for daytime and overnight windows alike. The table is
+ *          also rebuilt when the clock steps backwards and on
+ *          reloadTimezone().
+ *
+ *          A weekly schedule, when set, replaces openHour/closeHour: one
+ *          bit per local hour of the week (168 bits, 21 bytes in sysStatus),
+ *          so weekend hours and midday closures are exact. In the ledger it
+ *          is 42 hex digits, 6 per day from Sunday, leftmost bit 00:00-01:00;
+ *          e.g. 03FFFC is open 06:00-22:00. An empty string clears it.
+ */
+
+#ifndef __OPENHOURS_H
+#define __OPENHOURS_H
+
+#include "Particle.h"
+
+namespace OpenHours {
+
+/** @brief Bytes in the weekly schedule; must match sysStatus weekSchedule[]. */
+static constexpr size_t WEEK_BYTES = 21;
+
+/**
+ * @brief true if the current local time is within opening hours
+ *
+ * @details Also true while Time is not valid, so the device senses while it
+ *          acquires time, and when openHour == closeHour (always open).
+ */
+bool isOpen();
+
+/**
+ * @brief Seconds until the next opening time
+ *
+ * @return 3600 while Time is not valid, or when always open; the end of the
+ *         48-hour table if the weekly schedule is closed all that time
+ */
+int secondsUntilNextOpen();
+
+/**
+ * @brief Set the weekly schedule from 42 hex digits, or clear it with ""
+ *
+ * @return false (and nothing changed) if @p hex is not empty or 42 hex digits
+ */
+bool setWeekSchedule(const char *hex);
+
+/**
+ * @brief The weekly schedule as 42 uppercase hex digits, or "" when not set
+ *
+ * @param buf Receives the string; @p size must be at least 43
+ */
+void weekScheduleString(char *buf, size_t size);
+
+/**
+ * @brief UTC time of the first local midnight after @p time
+ */
+time_t nextMidnightAfter(time_t time);
+
+/**
+ * @brief Re-apply sysStatus timeZoneStr to LocalTime and drop the table
+ *
+ * @details Call after the ledger changes the timezone or opening hours.
+ *          Also clears sysStatus nextLocalMidnight so the day boundary is
+ *          recomputed in the new timezone.
+ */
+void reloadTimezone();
+
+/**
+ * @brief Drop the table; the next lookup rebuilds it
+ */
+void invalidate();
+
+} // namespace OpenHours
+
+#endif /* __OPENHOURS_H */
@@ -0,0 +1,221 @@
+// src/OpenMVSensor.cpp
+#include "OpenMVSensor.h"
+#include "PowerDomains.h"
+#include "TinyClassifier.h"
+
+#if SENSOR_DRIVER_OPENMV
+// Serial1's ring buffers, in place of the 64-byte defaults. Device OS fills
+// the RX ring from the UART interrupt; the camera is only read, so TX stays small.
+static uint8_t serial1RxBuffer[OPENMV_RX_BUFFER_SIZE];
+static uint8_t serial1TxBuffer[64];
+
+hal_usart_buffer_config_t acquireSerial1Buffer() {
+    hal_usart_buffer_config_t config = {};
+    config.size = sizeof(hal_usart_buffer_config_t);
+    config.rx_buffer = serial1RxBuffer;
+    config.rx_buffer_size = sizeof(serial1RxBuffer);
+    config.tx_buffer = serial1TxBuffer;
+    config.tx_buffer_size = sizeof(serial1TxBuffer);
+    return config;
+}
+#endif
+
+// Bytes parsed per loop() call, so a full buffer costs one bounded pass
+static const int MAX_BYTES_PER_PASS = 128;
+
+bool OpenMVSensor::setup() {
+    reset();
+    powerOff();
+    // First window opens now
+    _cycleStartMs = millis() - (uint32_t)OPENMV_PERIOD_SEC * 1000UL;
+    _isReady = true;
+    Log.info("OpenMV camera ready (on %d s every %d s, %lu baud)",
+             OPENMV_ON_SEC, OPENMV_PERIOD_SEC, (unsigned long)OPENMV_BAUD);
+    return true;
+}
+
+void OpenMVSensor::powerOn() {
+    PowerDomains::acquire(PowerDomains::SENSOR, this);
+    Serial1.begin(OPENMV_BAUD);
+    _powered = true;
+    _helloSeen = false;
+    _poweredAtMs = millis();
+    _lastFrameMs = _poweredAtMs;
+    _state = WAIT_SYNC1;
+}
+
+void OpenMVSensor::powerOff() {
+    if (_powered) {
+        Serial1.end();
+    }
+    PowerDomains::release(PowerDomains::SENSOR, this);
+    _powered = false;
+    _helloSeen = false;
+}
+
+void OpenMVSensor::runSchedule(uint32_t now) {
+    if (!_powered) {
+        if (now - _cycleStartMs >= (uint32_t)OPENMV_PERIOD_SEC * 1000UL) {
+            _cycleStartMs = now;
+            powerOn();
+        }
+        return;
+    }
+
+    if (now - _cycleStartMs >= (uint32_t)OPENMV_ON_SEC * 1000UL) {
+        powerOff();
+        return;
+    }
+    if (!_helloSeen && now - _poweredAtMs > OPENMV_BOOT_TIMEOUT_MS) {
+        if (_lastErrorCode != ERROR_NO_HELLO) {
+            Log.error("OpenMV: no HELLO %lu ms after power-on", (unsigned long)(now - _poweredAtMs));
+        }
+        _lastErrorCode = ERROR_NO_HELLO;
+        powerOff();     // Try again next period rather than burn the window
+    } else if (_helloSeen && now - _lastFrameMs > OPENMV_SILENCE_TIMEOUT_MS) {
+        if (_lastErrorCode != ERROR_SILENT) {
+            Log.error("OpenMV: no frame for %lu ms", (unsigned long)(now - _lastFrameMs));
+        }
+        _lastErrorCode = ERROR_SILENT;
+        powerOff();
+    }
+}
+
+bool OpenMVSensor::loop() {
+    if (!_isReady) {
+        return false;
+    }
+    runSchedule(millis());
+    if (!_powered) {
+        return false;
+    }
+
+    // Returns at the first detection; the rest of the buffer waits for the
+    // next call, which drain() makes straight away
+    for (int ii = 0; ii < MAX_BYTES_PER_PASS && Serial1.available() > 0; ii++) {
+        if (parseByte((uint8_t)Serial1.read()) && handleFrame()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint16_t OpenMVSensor::crc16(uint16_t crc, uint8_t byte) {
+    crc ^= (uint16_t)byte << 8;
+    for (int bit = 0; bit < 8; bit++) {
+        crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+bool OpenMVSensor::parseByte(uint8_t byte) {
+    switch (_state) {
+    case WAIT_SYNC1:
+        if (byte == SYNC1) {
+            _state = WAIT_SYNC2;
+        }
+        return false;
+    case WAIT_SYNC2:
+        _state = (byte == SYNC2) ? READ_TYPE : (byte == SYNC1 ? WAIT_SYNC2 : WAIT_SYNC1);
+        return false;
+    case READ_TYPE:
+        _frameType = byte;
+        _runningCrc = crc16(0xFFFF, byte);
+        _state = READ_LENGTH;
+        return false;
+    case READ_LENGTH:
+        if (byte > MAX_PAYLOAD) {
+            _badFrames++;
+            _state = WAIT_SYNC1;
+            return false;
+        }
+        _frameLength = byte;
+        _frameIndex = 0;
+        _runningCrc = crc16(_runningCrc, byte);
+        _state = byte ? READ_PAYLOAD : READ_CRC_LOW;
+        return false;
+    case READ_PAYLOAD:
+        _payload[_frameIndex++] = byte;
+        _runningCrc = crc16(_runningCrc, byte);
+        if (_frameIndex >= _frameLength) {
+            _state = READ_CRC_LOW;
+        }
+        return false;
+    case READ_CRC_LOW:
+        _frameCrc = byte;
+        _state = READ_CRC_HIGH;
+        return false;
+    case READ_CRC_HIGH:
+        _frameCrc |= (uint16_t)byte << 8;
+        _state = WAIT_SYNC1;
+        if (_frameCrc != _runningCrc) {
+            _badFrames++;
+            return false;
+        }
+        return true;
+    }
+    _state = WAIT_SYNC1;
+    return false;
+}
+
+bool OpenMVSensor::handleFrame() {
+    _lastFrameMs = millis();
+
+    switch (_frameType) {
+    case FRAME_HELLO:
+        _helloSeen = true;
+        _lastErrorCode = 0;
+        Log.info("OpenMV: camera up after %lu ms (protocol %u)",
+                 (unsigned long)(_lastFrameMs - _poweredAtMs), _frameLength ? _payload[0] : 0);
+        return false;
+
+    case FRAME_DETECTION:
+        if (!_helloSeen || _frameLength < 8) {
+            _badFrames++;
+            return false;
+        }
+        _data.timestamp = Time.now();
+        _data.hasNewData = true;
+        _data.primary = (uint16_t)(_payload[0] | (_payload[1] << 8));
+        _data.secondary = (uint16_t)(_payload[2] | (_payload[3] << 8));
+        _data.aux1 = (uint16_t)(_payload[4] | (_payload[5] << 8));
+        _data.aux2 = (uint16_t)(_payload[6] | (_payload[7] << 8));
+        _data.flag1 = _data.primary > 0;
+        _data.classBits = 0;
+#if CLASSIFIER_ENABLED
+        if (_data.flag1) {
+            // Only frames with a detection are candidates
+            const float features[] = {(float)_data.primary, (float)_data.secondary,
+                                      (float)_data.aux1, (float)_data.aux2};
+            if (!TinyClassifier::screen(SensorType::OPENMV_OCCUPANCY, features, 4, _data.classBits)) {
+                return false;
+            }
+        }
+#endif
+        return true;
+
+    case FRAME_STATUS:
+        _lastErrorCode = 0;
+        return false;
+
+    default:
+        return false;   // Newer camera script; ignore types we don't know
+    }
+}
+
+void OpenMVSensor::reset() {
+    _data = SensorData();
+    _data.type = SensorType::OPENMV_OCCUPANCY;
+    _state = WAIT_SYNC1;
+    _lastErrorCode = 0;
+}
+
+void OpenMVSensor::onSleep() {
+    powerOff();
+}
+
+bool OpenMVSensor::onWake() {
+    // Start a new period on wake; the camera boots again either way
+    _cycleStartMs = millis() - (uint32_t)OPENMV_PERIOD_SEC * 1000UL;
+    return true;
+}
@@ -0,0 +1,151 @@
+// src/OpenMVSensor.h
+#ifndef OPENMVSENSOR_H
+#define OPENMVSENSOR_H
+
+#include "ISensor.h"
+#include "Config.h"
+#include "Particle.h"
+#include "device_pinout.h"
+
+/**
+ * @brief OpenMV machine-vision camera on Serial1, power-gated by schedule.
+ *
+ * The camera runs its own detector and sends results as small binary
+ * frames. Serial1 receives into a ring buffer in the UART interrupt
+ * (enlarged to OPENMV_RX_BUFFER_SIZE), and loop() parses whatever has
+ * arrived with a byte-at-a-time state machine, so a frame split across
+ * passes never blocks the main loop.
+ *
+ * The camera draws more than everything else on the board combined, so
+ * it is powered through disableModule (active LOW) only for
+ * OPENMV_ON_SEC out of every OPENMV_PERIOD_SEC while the device is
+ * awake, and always off in sleep. Serial1 is closed while it is off so
+ * the TX line does not back-power it.
+ *
+ * Frame (little-endian):
+ *
+ *     0  u8   0xA5
+ *     1  u8   0x5A
+ *     2  u8   type
+ *     3  u8   payload length (0..MAX_PAYLOAD)
+ *     4  ...  payload
+ *     n  u16  CRC-16/CCITT (poly 0x1021, init 0xFFFF) over type, length and payload
+ *
+ * Frame types:
+ * - HELLO (1):     u8 protocol version; sent once the camera script runs
+ * - DETECTION (2): u16 faceNumber, u16 faceScore, u16 gestureType, u16 gestureScore
+ * - STATUS (3):    u16 frames processed since the last STATUS (heartbeat)
+ *
+ * Output per DETECTION (SensorData):
+ * - primary:   faceNumber
+ * - secondary: faceScore
+ * - aux1:      gestureType
+ * - aux2:      gestureScore
+ * - flag1:     at least one face
+ * - classBits: classifier label of a frame with a face (CLASSIFIER_ENABLED
+ *              with a model); a frame labelled noise is dropped
+ */
+class OpenMVSensor : public ISensor {
+public:
+    /**
+     * @brief Get singleton instance
+     */
+    static OpenMVSensor& instance() {
+        static OpenMVSensor _instance;
+        return _instance;
+    }
+
+    bool setup() override;
+    bool loop() override;
+
+    const SensorData& getData() const override { return _data; }
+    const char* getSensorType() const override { return "OpenMVOccupancy"; }
+    bool isReady() const override { return _isReady; }
+    void reset() override;
+
+    // Serviced on every pass so the UART ring never overflows
+    bool usesInterrupt() const override { return true; }
+    void onSleep() override;
+    bool onWake() override;
+
+    bool isHealthy() const override { return _lastErrorCode == 0; }
+    int lastErrorCode() const override { return _lastErrorCode; }
+
+    /** @brief Frames dropped for a bad CRC or length since setup(). */
+    uint32_t badFrames() const { return _badFrames; }
+
+    static constexpr uint8_t SYNC1 = 0xA5;
+    static constexpr uint8_t SYNC2 = 0x5A;
+    static constexpr uint8_t MAX_PAYLOAD = 32;
+
+    enum FrameType : uint8_t {
+        FRAME_HELLO = 1,
+        FRAME_DETECTION = 2,
+        FRAME_STATUS = 3,
+    };
+
+    /** @brief Error code: no HELLO within OPENMV_BOOT_TIMEOUT_MS of power-on. */
+    static constexpr int ERROR_NO_HELLO = 1;
+    /** @brief Error code: no frame for OPENMV_SILENCE_TIMEOUT_MS while running. */
+    static constexpr int ERROR_SILENT = 2;
+
+private:
+    OpenMVSensor() {}
+    ~OpenMVSensor() {}
+    OpenMVSensor(const OpenMVSensor&) = delete;
+    OpenMVSensor& operator=(const OpenMVSensor&) = delete;
+
+    enum ParseState : uint8_t {
+        WAIT_SYNC1,
+        WAIT_SYNC2,
+        READ_TYPE,
+        READ_LENGTH,
+        READ_PAYLOAD,
+        READ_CRC_LOW,
+        READ_CRC_HIGH,
+    };
+
+    /**
+     * @brief Advance the duty cycle: power on at the start of a period, off after OPENMV_ON_SEC.
+     */
+    void runSchedule(uint32_t now);
+
+    void powerOn();
+    void powerOff();
+
+    /**
+     * @brief Feed one received byte to the parser.
+     * @return true if it completed a valid frame
+     */
+    bool parseByte(uint8_t byte);
+
+    /**
+     * @brief Act on the frame in _frame*.
+     * @return true if it was a DETECTION now in _data
+     */
+    bool handleFrame();
+
+    static uint16_t crc16(uint16_t crc, uint8_t byte);
+
+    bool _isReady = false;
+    int _lastErrorCode = 0;
+    SensorData _data;
+
+    bool _powered = false;
+    bool _helloSeen = false;
+    uint32_t _cycleStartMs = 0;
+    uint32_t _poweredAtMs = 0;
+    uint32_t _lastFrameMs = 0;
+
+    ParseState _state = WAIT_SYNC1;
+    uint8_t _frameType = 0;
+    uint8_t _frameLength = 0;
+    uint8_t _frameIndex = 0;
+    uint16_t _frameCrc = 0;
+    uint16_t _runningCrc = 0;
+    uint8_t _payload[MAX_PAYLOAD];
+
+    uint32_t _badFrames = 0;
+};
+
+#endif /* OPENMVSENSOR_H */
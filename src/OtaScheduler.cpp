@@ -0,0 +1,156 @@
+#include "OtaScheduler.h"
+#include "Config.h"
+#include "LocalTimeRK.h"
+#include "MyPersistentData.h"
+#include "Payload.h"
+#include "PowerGovernor.h"
+#include "ProjectConfig.h"
+#include "PublishQueuePosixRK.h"
+#include <math.h>
+
+namespace OtaScheduler {
+
+static bool allowed = !OTA_SCHEDULER_ENABLED;
+
+#if OTA_SCHEDULER_ENABLED
+
+// With no fuel gauge reading the supply is not a battery worth protecting
+static bool batteryOk() {
+    uint16_t socTenths = current.get_socTenths();
+    uint8_t battState = current.get_batteryState();
+    if (socTenths == 0 || battState == BATTERY_STATE_UNKNOWN || battState == BATTERY_STATE_DISCONNECTED) {
+        return true;
+    }
+    bool charging = battState == BATTERY_STATE_CHARGING || battState == BATTERY_STATE_CHARGED;
+    return socTenths >= (charging ? OTA_MIN_SOC_CHARGING : OTA_MIN_SOC) * 10;
+}
+
+static bool signalOk(float &strength, float &quality) {
+#if Wiring_Cellular
+    CellularSignal sig = Cellular.RSSI();
+    strength = sig.getStrength();
+    quality = sig.getQuality();
+    return strength >= OTA_MIN_SIGNAL_STRENGTH && quality >= OTA_MIN_SIGNAL_QUALITY;
+#else
+    strength = -1.0f;
+    quality = -1.0f;
+    return true;
+#endif
+}
+
+// Without valid time the window cannot be judged; don't hold the update for it
+static bool inWindow() {
+    if (OTA_WINDOW_START_HOUR == OTA_WINDOW_END_HOUR || !Time.isValid()) {
+        return true;
+    }
+    LocalTimeConvert conv;
+    conv.withConfig(LocalTime::instance().getConfig()).withCurrentTime().convert();
+    int hour = conv.getLocalTimeHMS().hour;
+    if (OTA_WINDOW_START_HOUR < OTA_WINDOW_END_HOUR) {
+        return hour >= OTA_WINDOW_START_HOUR && hour < OTA_WINDOW_END_HOUR;
+    }
+    return hour >= OTA_WINDOW_START_HOUR || hour < OTA_WINDOW_END_HOUR;
+}
+
+static void publishDeferral(uint8_t reason, float strength, float quality) {
+    char data[128];
+    Payload::Writer(data, sizeof(data))
+        .beginObject()
+        .add("reason", reasonName(reason))
+        .add("since", (long)sysStatus.get_otaDeferSince())
+        .addScaled("soc", current.get_socTenths(), 1)
+        .addFixed("strength", strength, 0)
+        .addFixed("quality", quality, 0)
+        .endObject();
+    PublishQueuePosix::instance().publishToLane(ProjectConfig::LANE_STATUS, "otaDeferred", data, PRIVATE | WITH_ACK);
+}
+
+#endif
+
+void setup() {
+#if OTA_SCHEDULER_ENABLED
+    System.disableUpdates();
+#endif
+}
+
+bool updateNow() {
+    if (!System.updatesPending()) {
+        if (sysStatus.get_otaDeferSince() != 0) {
+            sysStatus.set_otaDeferSince(0);
+            sysStatus.set_otaDeferReason(REASON_NONE);
+        }
+        return false;
+    }
+#if OTA_SCHEDULER_ENABLED
+    float strength;
+    float quality;
+    uint8_t reason = PowerGovernor::storeOnly() ? REASON_STORE_ONLY :
+                     !batteryOk() ? REASON_BATTERY :
+                     !signalOk(strength, quality) ? REASON_SIGNAL :
+                     !inWindow() ? REASON_WINDOW : REASON_NONE;
+    if (reason == REASON_BATTERY || reason == REASON_STORE_ONLY) {
+        signalOk(strength, quality);    // For the event
+    }
+
+    time_t deferSince = sysStatus.get_otaDeferSince();
+    if (reason != REASON_NONE && System.updatesForced()) {
+        Log.info("OTA: update forced from the console; not deferring (%s)", reasonName(reason));
+        reason = REASON_NONE;
+    } else if (reason != REASON_NONE && reason != REASON_STORE_ONLY && deferSince != 0 && Time.isValid() &&
+               Time.now() - deferSince >= (time_t)OTA_DEFER_MAX_HOURS * 3600) {
+        Log.info("OTA: deferred since %s - updating regardless (%s)",
+                 Time.format(deferSince, TIME_FORMAT_DEFAULT).c_str(), reasonName(reason));
+        reason = REASON_NONE;
+    }
+
+    if (reason == REASON_NONE) {
+        allowed = true;
+        System.enableUpdates();
+        return true;
+    }
+
+    allowed = false;
+    if (deferSince == 0) {
+        sysStatus.set_otaDeferSince(Time.isValid() ? Time.now() : 1);
+    }
+    Log.info("OTA: update deferred (%s; SoC=%s%% S=%d%% Q=%d%%)", reasonName(reason),
+             Payload::Scaled(current.get_socTenths(), 1).c_str(), (int)lroundf(strength), (int)lroundf(quality));
+    if (reason != sysStatus.get_otaDeferReason()) {
+        sysStatus.set_otaDeferReason(reason);
+        publishDeferral(reason, strength, quality);
+    }
+    return false;
+#else
+    return true;
+#endif
+}
+
+void endUpdate() {
+#if OTA_SCHEDULER_ENABLED
+    allowed = false;
+    System.disableUpdates();
+#endif
+}
+
+bool updateAllowed() {
+    return allowed;
+}
+
+const char *reasonName(uint8_t reason) {
+    switch (reason) {
+    case REASON_NONE:
+        return "none";
+    case REASON_BATTERY:
+        return "battery";
+    case REASON_SIGNAL:
+        return "signal";
+    case REASON_WINDOW:
+        return "window";
+    case REASON_STORE_ONLY:
+        return "storeOnly";
+    default:
+        return "unknown";
+    }
+}
+
+} // namespace OtaScheduler
@@ -0,0 +1,75 @@
+/**
+ * @file OtaScheduler.h
+ * @brief Holds firmware updates until the battery, signal and time of day
+ *        can afford them.
+ *
+ * @details A fleet rollout would otherwise start an OTA at every site's
+ *          next connect, including weak-signal solar units at low charge,
+ *          where it can keep the modem up for minutes. setup() turns
+ *          Device OS updates off, so the cloud only flags them
+ *          (System.updatesPending()). At each connect with an update
+ *          waiting, updateNow() checks:
+ *          - battery: SoC at least OTA_MIN_SOC, or OTA_MIN_SOC_CHARGING
+ *            while charging (or no fuel gauge reading);
+ *          - signal: strength and quality at least OTA_MIN_SIGNAL_STRENGTH
+ *            and OTA_MIN_SIGNAL_QUALITY (cellular only);
+ *          - time: the local hour is in [OTA_WINDOW_START_HOUR,
+ *            OTA_WINDOW_END_HOUR), which may wrap past midnight.
+ *          If all pass, updates are turned on and FIRMWARE_UPDATE_STATE
+ *          takes the update. Otherwise the device goes on as if none were
+ *          pending and the first failing check is the deferral reason. It
+ *          is kept in sysStatus with the time deferral began, and a
+ *          change of reason queues an "otaDeferred" status event. After
+ *          OTA_DEFER_MAX_HOURS of deferring, or for an update forced from
+ *          the console, the update goes ahead regardless. In PowerGovernor's
+ *          store-only tier only a forced update does.
+ */
+
+#ifndef __OTASCHEDULER_H
+#define __OTASCHEDULER_H
+
+#include "Particle.h"
+
+namespace OtaScheduler {
+
+/** @brief Why a pending update is being held (sysStatus otaDeferReason) */
+enum Reason : uint8_t {
+    REASON_NONE = 0,            ///< Not deferring
+    REASON_BATTERY = 1,         ///< State of charge below the minimum
+    REASON_SIGNAL = 2,          ///< Cellular signal below the minimum
+    REASON_WINDOW = 3,          ///< Outside the update hours
+    REASON_STORE_ONLY = 4       ///< PowerGovernor store-only tier
+};
+
+/**
+ * @brief Turn Device OS updates off so they wait for updateNow(); from setup()
+ */
+void setup();
+
+/**
+ * @brief After a connect: whether to take a pending update now
+ *
+ * @return true if an update is pending and allowed; updates are then on
+ *         until endUpdate()
+ */
+bool updateNow();
+
+/**
+ * @brief Leaving FIRMWARE_UPDATE_STATE without a reset; turn updates off again
+ */
+void endUpdate();
+
+/**
+ * @brief true while the last updateNow() allowed the pending update
+ *
+ * @details IDLE_STATE keeps a connected device awake only for an allowed
+ *          update; a deferred one does not hold off sleep.
+ */
+bool updateAllowed();
+
+/** @brief Short name for @p reason, as in the otaDeferred event. */
+const char *reasonName(uint8_t reason);
+
+} // namespace OtaScheduler
+
+#endif /* __OTASCHEDULER_H */
@@ -1,14 +1,178 @@
 // src/PIRSensor.cpp
 #include "PIRSensor.h"
+#include "AssetStore.h"
+#include "Config.h"
+#include "ConfigSnapshot.h"
 #include "device_pinout.h"
+#include "TraceLog.h"
+#include <algorithm>
 
-// Static ISR flag and a simple counter so we can see
-// in the main loop whether the ISR is ever firing.
-volatile bool PIRSensor::_motionDetected = false;
+// Edge timestamps captured in the ISR and drained by loop(), plus a
+// simple counter so we can see in the main loop whether the ISR is
+// ever firing.
+EventRing<uint32_t, PIRSensor::EDGE_RING_SIZE> PIRSensor::_edgeRing;
 volatile uint32_t PIRSensor::_isrCount = 0;
+volatile bool PIRSensor::_stormTripped = false;
+volatile uint32_t PIRSensor::_windowStartMs = 0;
+volatile uint32_t PIRSensor::_windowEdges = 0;
 
 // Static ISR handler
 void PIRSensor::pirISR() {
-    _motionDetected = true;
+    uint32_t stampUs = (uint32_t)micros();
+#if PIR_GROUP_ESTIMATE
+    if (pinReadFast(intPin) == LOW) {
+        // Falling edge: times the pulse for the group estimate, not an event
+        if (!_stormTripped) {
+            _edgeRing.push(stampUs & ~EDGE_RISE);
+        }
+        return;
+    }
+#endif
     _isrCount++;
+    if (_stormTripped) {
+        return;     // loop() detaches us; queue nothing until then
+    }
+    uint32_t nowMs = millis();
+    if (nowMs - _windowStartMs >= 1000) {
+        _windowStartMs = nowMs;
+        _windowEdges = 0;
+    }
+    if (++_windowEdges > SENSOR_STORM_EDGES_PER_SEC) {
+        _stormTripped = true;
+        return;
+    }
+    _edgeRing.push(stampUs | EDGE_RISE);
+}
+
+bool PIRSensor::popRise(uint32_t &edgeUs) {
+    uint32_t entry;
+    while (_edgeRing.pop(entry)) {
+        if (entry & EDGE_RISE) {
+#if PIR_GROUP_ESTIMATE
+            closeStaleGroup(entry);
+            // A rise with the pulse still open missed its fall; the group keeps the earlier start
+            if (!_pulseOpen) {
+                _riseUs = entry;
+                _pulseOpen = true;
+            }
+            if (!_groupOpen) {
+                _groupOpen = true;
+                _groupHighUs = 0;
+            }
+#endif
+            edgeUs = entry;
+            return true;
+        }
+        if (_pulseOpen) {
+            _groupHighUs += entry - _riseUs;
+            _pulseOpen = false;
+            _lastFallUs = entry;
+        }
+    }
+    return false;
+}
+
+void PIRSensor::closeStaleGroup(uint32_t nowUs) {
+    if (!_groupOpen) {
+        return;
+    }
+    if (_pulseOpen) {
+        if (nowUs - _riseUs < PIR_GROUP_MAX_PULSE_MS * 1000UL) {
+            return;
+        }
+        _groupHighUs += PIR_GROUP_MAX_PULSE_MS * 1000UL;
+        _pulseOpen = false;
+    } else if (nowUs - _lastFallUs < PIR_GROUP_GAP_MS * 1000UL) {
+        return;
+    }
+    closeGroup();
+}
+
+// PIR_GROUP_TABLE blob: steps in rising highMs; a group of at least highMs
+// is people. Takes the place of the groupBaseMs / groupStepMs curve.
+struct GroupStep {
+    uint16_t highMs;
+    uint16_t people;
+};
+static GroupStep groupTable[PIR_GROUP_TABLE_MAX];
+static size_t groupTableLen = 0;
+
+void PIRSensor::loadGroupTable() {
+    uint16_t version = 0;
+    size_t length = AssetStore::load(AssetStore::PIR_GROUP_TABLE, groupTable, sizeof(groupTable), version);
+    groupTableLen = length / sizeof(GroupStep);
+    for (size_t ii = 1; ii < groupTableLen; ii++) {
+        if (groupTable[ii].highMs <= groupTable[ii - 1].highMs) {
+            groupTableLen = 0;      // Not in order: the curve instead
+        }
+    }
+    if (groupTableLen > 0) {
+        Log.info("PIR group table v%u: %u steps", (unsigned)version, (unsigned)groupTableLen);
+    }
+}
+
+void PIRSensor::closeGroup() {
+    _groupOpen = false;
+    ConfigSnapshot::Values config = ConfigSnapshot::read();
+    if (config.groupStepMs == 0 && groupTableLen == 0) {
+        return;     // Not calibrated for this site
+    }
+    uint32_t highMs = _groupHighUs / 1000;
+    uint32_t people = 1;
+    if (groupTableLen > 0) {
+        for (size_t ii = 0; ii < groupTableLen && highMs >= groupTable[ii].highMs; ii++) {
+            people = std::max((uint32_t)groupTable[ii].people, (uint32_t)1);
+        }
+    } else if (highMs > config.groupBaseMs) {
+        people += (highMs - config.groupBaseMs + config.groupStepMs / 2) / config.groupStepMs;
+    }
+    people = std::min(people, (uint32_t)PIR_GROUP_MAX_PEOPLE);
+    _people = (uint16_t)std::min((uint32_t)_people + people, (uint32_t)UINT16_MAX);
+    if (config.verboseMode) {
+        Log.info("PIR group closed: %lu ms high, %lu people", (unsigned long)highMs, (unsigned long)people);
+    }
+}
+
+void PIRSensor::checkStorm() {
+    uint32_t nowMs = millis();
+
+    if (!_stormActive) {
+        if (!_stormTripped) {
+            return;
+        }
+        detachInterrupt(intPin);
+        _stormActive = true;
+        _storms++;
+        _edgeRing.clear();      // Noise, not motion
+        _pendingEvents = 0;
+        _pollLevel = digitalRead(intPin);
+        _pollChanges = 0;
+        _quietStartMs = nowMs;
+        TraceLog::record(TraceLog::SENSOR_STORM, (int32_t)_storms);
+        Log.error("PIR interrupt storm #%lu (>%d edges/s): interrupt detached, polling the line",
+                  (unsigned long)_storms, SENSOR_STORM_EDGES_PER_SEC);
+        return;
+    }
+
+    // Polling: any change, or the line held high, restarts the quiet period
+    int level = digitalRead(intPin);
+    if (level != _pollLevel) {
+        _pollLevel = level;
+        _pollChanges++;
+        _quietStartMs = nowMs;
+    } else if (level == HIGH) {
+        _quietStartMs = nowMs;
+    }
+    if (nowMs - _quietStartMs < SENSOR_STORM_QUIET_SEC * 1000UL) {
+        return;
+    }
+
+    Log.info("PIR line quiet for %d s (%lu changes polled): interrupt re-attached",
+             SENSOR_STORM_QUIET_SEC, (unsigned long)_pollChanges);
+    _windowEdges = 0;
+    _stormTripped = false;
+    _stormActive = false;
+    if (_isReady) {
+        attachInterrupt(intPin, pirISR, EDGE_MODE);
+    }
 }
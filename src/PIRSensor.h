@@ -3,7 +3,10 @@
 #define PIRSENSOR_H
 
 #include "ISensor.h"
+#include "Config.h"
+#include "EventRing.h"
 #include "Particle.h"
+#include "PowerDomains.h"
 #include "device_pinout.h"
 #include "MyPersistentData.h"  // for sysStatus (verboseMode)
 
@@ -38,17 +41,14 @@ public:
      * @return true if initialization successful
      */
     bool setup() override {
-        // Configure PIR-related pins from device_pinout
         pinMode(intPin, INPUT_PULLDOWN);   // PIR interrupt output with pull-down
-        pinMode(disableModule, OUTPUT);    // Sensor enable line (active LOW)
-        pinMode(ledPower, OUTPUT);         // Sensor indicator LED power
+        powerUp();
 
-        // Enable sensor and LED by default
-        digitalWrite(disableModule, LOW);  // Bring low to turn sensor ON
-        digitalWrite(ledPower, LOW);       // Active-LOW: bring low to turn LED ON
-
-        // Attach interrupt on RISING edge (PIR output is active-high).
-        attachInterrupt(intPin, pirISR, RISING);
+        // PIR output is active-high: RISING, or CHANGE to time the pulses
+        attachInterrupt(intPin, pirISR, EDGE_MODE);
+#if PIR_GROUP_ESTIMATE
+        loadGroupTable();
+#endif
 
         reset();           // Ensure SensorData is initialized
         _isReady = true;   // Mark as ready
@@ -59,39 +59,85 @@ public:
      * @brief Poll the PIR sensor for motion detection
      * @return true if new motion detected
      * 
-     * @note Currently interrupt-driven only. Returns false in polling mode.
-     *       Motion is detected via a hardware interrupt (pirISR) which sets
-     *       an internal flag. This method returns true once per interrupt
-     *       and clears the flag.
+     * @note Interrupt-driven. pirISR() pushes a micros() timestamp for
+     *       every edge into a lock-free ring; this method drains the
+     *       ring and returns true once per rising edge (falling edges,
+     *       with PIR_GROUP_ESTIMATE, only time the group estimate). Several edges that
+     *       arrive during one slow loop pass are therefore reported on
+     *       consecutive calls instead of being merged into one.
+     *       Debounce is applied by SensorManager's EventFilter, not here.
      */
     bool loop() override {
         if (!_isReady) {
             return false;
         }
+        checkStorm();
 
-        // If no motion flag, nothing to report
-        if (!_motionDetected) {
-            return false;
+        uint32_t edgeUs;
+        while (popRise(edgeUs)) {
+            if (_pendingEvents < UINT16_MAX) {
+                _pendingEvents++;
+            }
         }
+        reportOverflows();
 
-        // Clear flag and apply debounce: ignore events within 500 ms
-        _motionDetected = false;
-        unsigned long nowMs = millis();
-        if (nowMs - _lastEventMs < 500) {
+        if (_pendingEvents == 0) {
             return false;
         }
-        _lastEventMs = nowMs;
+        _pendingEvents--;
 
         _data.timestamp = Time.now();
         _data.hasNewData = true;
         return true;
     }
 
+    /**
+     * @brief Drain motion edges directly from the edge ring.
+     *
+     * Each event timestamp is back-dated from the ISR capture time, so
+     * a burst drained late still carries its real arrival times and the
+     * filter stage can debounce on them.
+     */
+    size_t drain(SensorEvent* out, size_t max) override {
+        if (!_isReady || !out || max == 0) {
+            return 0;
+        }
+        checkStorm();
+
+        size_t n = 0;
+        uint32_t nowUs = micros();
+        uint32_t nowMs = millis();
+
+        // Edges already pulled by loop() but not yet returned
+        while (_pendingEvents > 0 && n < max) {
+            out[n] = SensorEvent();
+            out[n].type = SensorType::PIR;
+            out[n].tickMs = nowMs;
+            n++;
+            _pendingEvents--;
+        }
+
+        uint32_t edgeUs;
+        while (n < max && popRise(edgeUs)) {
+            out[n] = SensorEvent();
+            out[n].type = SensorType::PIR;
+            out[n].tickMs = nowMs - (uint32_t)(nowUs - edgeUs) / 1000UL;
+            n++;
+        }
+        reportOverflows();
+
+        if (n > 0) {
+            _data.timestamp = out[n - 1].unixTime();
+            _data.hasNewData = true;
+        }
+        return n;
+    }
+
     /**
      * @brief Get latest sensor reading
      * @return SensorData with motion detection info
      */
-    SensorData getData() const override {
+    const SensorData& getData() const override {
         return _data;
     }
 
@@ -109,15 +155,71 @@ public:
         return _isReady;
     }
 
+    /**
+     * @brief false while an interrupt storm has the ISR detached
+     */
+    bool isHealthy() const override {
+        return !_stormActive && !_stormTripped;
+    }
+
     /**
      * @brief Reset sensor state
      */
     void reset() override {
         _data = SensorData();
-        strncpy(_data.sensorType, "PIR", sizeof(_data.sensorType) - 1);
-        _data.sensorType[sizeof(_data.sensorType) - 1] = '\0';
+        _data.type = SensorType::PIR;
         // Clear any pending motion
-        _motionDetected = false;
+        _edgeRing.clear();
+        _pendingEvents = 0;
+        _groupOpen = false;
+        _pulseOpen = false;
+        _people = 0;
+    }
+
+    /**
+     * @brief Snapshot the ISR count before a nap.
+     */
+    void armWakeCapture() override {
+        _isrCountAtArm = _isrCount;
+    }
+
+    /**
+     * @brief Add the wake edge to the ring if the ISR missed it.
+     */
+    bool injectWakeEvent() override {
+        if (_stormActive || _isrCount != _isrCountAtArm) {
+            return false;   // ISR fired during/after the nap (edge already queued), or storm
+        }
+        _edgeRing.push((uint32_t)micros() | EDGE_RISE);
+        return true;
+    }
+
+    /**
+     * @brief Queue an edge stamped now, as pirISR() would.
+     */
+    bool injectEdge() override {
+        if (!_isReady) {
+            return false;
+        }
+        _edgeRing.push((uint32_t)micros() | EDGE_RISE);
+        return true;
+    }
+
+    /**
+     * @brief Detach pirISR() for a hardware-counted nap.
+     */
+    bool releaseInterruptPin() override {
+        if (!_isReady || _stormActive || _stormTripped) {
+            return false;
+        }
+        detachInterrupt(intPin);
+        return true;
+    }
+
+    void reclaimInterruptPin() override {
+        if (_isReady && !_stormActive) {
+            attachInterrupt(intPin, pirISR, EDGE_MODE);
+        }
     }
 
     /**
@@ -125,6 +227,27 @@ public:
      */
     bool usesInterrupt() const override { return true; }
 
+    /**
+     * @brief People in the groups closed since the last call
+     *        (PIR_GROUP_ESTIMATE and a calibrated sensor.groupStepMs).
+     */
+    uint16_t takePeople() override {
+        closeStaleGroup((uint32_t)micros());
+        uint16_t people = _people;
+        _people = 0;
+        return people;
+    }
+
+    /**
+     * @brief A motion edge wakes a nap.
+     */
+    WakeSource wakeSource() const override { return WakeSource::gpio(intPin, RISING); }
+
+    /**
+     * @brief The module chatters for PIR_WARMUP_SEC after power-on.
+     */
+    uint32_t warmupMs() const override { return PIR_WARMUP_SEC * 1000UL; }
+
     /**
      * @brief Prepare sensor for deep sleep: detach ISR and power down.
      */
@@ -134,8 +257,8 @@ public:
         }
 
         detachInterrupt(intPin);
-        digitalWrite(disableModule, HIGH); // Disable sensor module
-        digitalWrite(ledPower, HIGH);      // Active-LOW: bring high to turn LED OFF
+        PowerDomains::release(PowerDomains::SENSOR, this);
+        PowerDomains::release(PowerDomains::SENSOR_LED, this);
         _isReady = false;
         Log.info("PIR sensor powered down for sleep");
     }
@@ -146,18 +269,16 @@ public:
     bool onWake() override {
         // For ULTRA_LOW_POWER naps we normally keep the PIR powered
         // and its interrupt attached across sleep so it can wake the
-        // MCU. In that case we should NOT clear the motion flag here,
+        // MCU. In that case we should NOT clear the edge ring here,
         // otherwise the wake-causing event is lost before the main
         // loop can count it.
 
-        pinMode(disableModule, OUTPUT);
-        pinMode(ledPower, OUTPUT);
         pinMode(intPin, INPUT_PULLDOWN);
+        powerUp();
 
-        digitalWrite(disableModule, LOW);
-        digitalWrite(ledPower, LOW);       // Active-LOW: LED ON after wake
-
-        attachInterrupt(intPin, pirISR, RISING);
+        if (!_stormActive) {
+            attachInterrupt(intPin, pirISR, EDGE_MODE);   // checkStorm() re-attaches after a storm
+        }
 
         _isReady = true;
         Log.info("PIR sensor powered up after wake (interrupt attached)");
@@ -166,8 +287,7 @@ public:
 
 private:
     PIRSensor() : _isReady(false) {
-        strncpy(_data.sensorType, "PIR", sizeof(_data.sensorType) - 1);
-        _data.sensorType[sizeof(_data.sensorType) - 1] = '\0';  // Ensure null termination
+        _data.type = SensorType::PIR;
     }
     ~PIRSensor() {}
     
@@ -178,12 +298,98 @@ private:
     bool _isReady;
     SensorData _data;
 
-    // Debounce state: last accepted motion event time (ms)
-    unsigned long _lastEventMs = 0;
+    // Edges pulled from the ring but not yet returned by loop()
+    uint16_t _pendingEvents = 0;
+    uint32_t _lastOverflowCount = 0;
+
+    // _isrCount at the last armWakeCapture()
+    uint32_t _isrCountAtArm = 0;
+
+    // Interrupt storm: detached and polling the line until it is quiet
+    bool _stormActive = false;
+    uint32_t _storms = 0;
+    int _pollLevel = LOW;
+    uint32_t _pollChanges = 0;
+    uint32_t _quietStartMs = 0;
+
+    // Group estimate (PIR_GROUP_ESTIMATE): pulses of the open group, on the micros() clock
+    bool _groupOpen = false;
+    bool _pulseOpen = false;
+    uint32_t _riseUs = 0;
+    uint32_t _lastFallUs = 0;
+    uint32_t _groupHighUs = 0;
+    uint16_t _people = 0;           // Closed groups' people not yet taken
+
+    // Ring entries are micros() with the low bit replaced by the edge: 1 = rising
+    static constexpr uint32_t EDGE_RISE = 1;
+#if PIR_GROUP_ESTIMATE
+    static constexpr InterruptMode EDGE_MODE = CHANGE;
+    static constexpr size_t EDGE_RING_SIZE = 32;   // Two entries per pulse
+#else
+    static constexpr InterruptMode EDGE_MODE = RISING;
+    static constexpr size_t EDGE_RING_SIZE = 16;
+#endif
 
     // PIR-specific state
-    static volatile bool _motionDetected;  // Set by ISR, read/cleared in loop()
-    static volatile uint32_t _isrCount;    // Counts how many times ISR fired
+    static EventRing<uint32_t, EDGE_RING_SIZE> _edgeRing;  // Edge timestamps, ISR -> loop()
+    static volatile uint32_t _isrCount;        // Counts how many times ISR fired
+    static volatile bool _stormTripped;        // Set by the ISR past SENSOR_STORM_EDGES_PER_SEC
+    static volatile uint32_t _windowStartMs;   // ISR rate window
+    static volatile uint32_t _windowEdges;
+
+    /**
+     * @brief Hold the sensor supply, and the board LED with INDICATOR_LEDS.
+     */
+    void powerUp() {
+        PowerDomains::acquire(PowerDomains::SENSOR, this);
+#if INDICATOR_LEDS
+        PowerDomains::acquire(PowerDomains::SENSOR_LED, this);
+#endif
+    }
+
+    /**
+     * @brief Pop ring entries up to the next rising edge, feeding each
+     *        edge to the group estimate
+     *
+     * @return false once the ring is empty
+     */
+    bool popRise(uint32_t &edgeUs);
+
+    /**
+     * @brief Close the open group once it has been quiet for
+     *        PIR_GROUP_GAP_MS, or its pulse has outlasted PIR_GROUP_MAX_PULSE_MS
+     */
+    void closeStaleGroup(uint32_t nowUs);
+
+    /**
+     * @brief Add the open group's people, from its high time and the
+     *        asset table, or else the sensor.groupBaseMs / groupStepMs
+     *        curve, to _people
+     */
+    void closeGroup();
+
+    /**
+     * @brief Load the AssetStore PIR_GROUP_TABLE blob, if one is installed
+     */
+    void loadGroupTable();
+
+    /**
+     * @brief Detach the ISR when it has tripped, poll the line while
+     *        detached, and re-attach once it has been quiet long enough.
+     */
+    void checkStorm();
+
+    /**
+     * @brief Log any edges dropped by a full ring since the last check.
+     */
+    void reportOverflows() {
+        uint32_t overflows = _edgeRing.overflows();
+        if (overflows != _lastOverflowCount) {
+            Log.warn("PIR edge ring overflow: %lu edges dropped",
+                     (unsigned long)(overflows - _lastOverflowCount));
+            _lastOverflowCount = overflows;
+        }
+    }
 
     // ISR handler
     static void pirISR();
@@ -1,7 +1,14 @@
 #include "Particle_Functions.h"
 #include "Particle.h"
+#include "Cloud.h"
+#include "ConnectHistory.h"
+#include "EnergyLedger.h"
 #include "SensorManager.h"
 #include "MyPersistentData.h"  // For sysStatus (serialConnected configuration)
+#include "PublishQueuePosixRK.h"
+#include "TaskScheduler.h"
+#include "LedgerLogSink.h"
+#include "UsbLogSink.h"
 
 // Prototypes and System Mode calls
 // SYSTEM_THREAD is enabled by default in Device OS 6.2.0+
@@ -13,13 +20,13 @@ STARTUP(System.enableFeature(FEATURE_RESET_INFO));
 // Temporary - will fix with config file later
 
 #if SERIAL_LOG_LEVEL == 0
-SerialLogHandler logHandler(LOG_LEVEL_NONE); // Easier to see the program flow
+UsbLogHandler logHandler(LOG_LEVEL_NONE); // Easier to see the program flow
 #elif SERIAL_LOG_LEVEL == 1
-SerialLogHandler logHandler(LOG_LEVEL_ERROR);
+UsbLogHandler logHandler(LOG_LEVEL_ERROR);
 #elif SERIAL_LOG_LEVEL == 2
-SerialLogHandler logHandler(LOG_LEVEL_WARN);
+UsbLogHandler logHandler(LOG_LEVEL_WARN);
 #elif SERIAL_LOG_LEVEL == 3
-SerialLogHandler logHandler(LOG_LEVEL_INFO,
+UsbLogHandler logHandler(LOG_LEVEL_INFO,
                             {// Logging level for non-application messages
                              {"app.pubq", LOG_LEVEL_ERROR},
                              {"app.seqfile", LOG_LEVEL_ERROR},
@@ -34,7 +41,19 @@ SerialLogHandler logHandler(LOG_LEVEL_INFO,
                              {"app.system.reset", LOG_LEVEL_ERROR},
                              {"app.ab1805", LOG_LEVEL_ERROR}});
 #elif SERIAL_LOG_LEVEL == 4
-SerialLogHandler logHandler(LOG_LEVEL_ALL);
+UsbLogHandler logHandler(LOG_LEVEL_ALL);
+#endif
+
+#if LEDGER_LOG_ENABLED
+// Radio and system chatter at WARN would use up the day's budget
+LedgerLogHandler ledgerLogHandler(LEDGER_LOG_LEVEL,
+                            {{"comm", LOG_LEVEL_ERROR},
+                             {"comm.dtls", LOG_LEVEL_ERROR},
+                             {"comm.protocol", LOG_LEVEL_ERROR},
+                             {"ncp.rltk.client", LOG_LEVEL_ERROR},
+                             {"net.ifapi", LOG_LEVEL_ERROR},
+                             {"system", LOG_LEVEL_ERROR},
+                             {"hal", LOG_LEVEL_ERROR}});
 #endif
 
 Particle_Functions *Particle_Functions::_instance;
@@ -51,6 +70,161 @@ Particle_Functions::Particle_Functions() {}
 
 Particle_Functions::~Particle_Functions() {}
 
+static void writeTiming(JSONBufferWriter &writer, const char *name, const PublishQueueTiming &timing) {
+  writer.name(name).beginObject();
+  writer.name("n").value((unsigned long)timing.count);
+  writer.name("max").value((unsigned long)timing.max);
+  writer.name("avg").value((unsigned long)timing.avg());
+  writer.name("hist").beginArray();
+  for (size_t i = 0; i < PublishQueueTiming::NUM_BUCKETS; i++) {
+    writer.value((unsigned long)timing.histogram[i]);
+  }
+  writer.endArray();
+  writer.endObject();
+}
+
+size_t Particle_Functions::formatQueueMetrics(char *buffer, size_t bufferSize) {
+  PublishQueueMetrics metrics = PublishQueuePosix::instance().getMetrics();
+
+  JSONBufferWriter writer(buffer, bufferSize - 1);
+  writer.beginObject();
+  writer.name("depth").value((unsigned)PublishQueuePosix::instance().getNumEvents());
+  writer.name("peak").value((unsigned long)metrics.peakDepth);
+  writer.name("pub").value((unsigned long)metrics.published);
+  writer.name("fail").value((unsigned long)metrics.failures);
+  writer.name("drop").value((unsigned long)metrics.discarded);
+  writer.name("held").value((unsigned long)metrics.retainedHeld);
+  writer.name("ram").value((unsigned)PublishQueuePosix::instance().getRamQueueLimit());
+  writer.name("spill").value((unsigned long)metrics.spilled);
+  uint32_t uptimeSec = std::max((uint32_t)System.uptime(), (uint32_t)1);
+  writer.name("spillHr").value((double)metrics.spilled * 3600.0 / uptimeSec, 1);
+  writeTiming(writer, "enq", metrics.enqueueUs);
+  writeTiming(writer, "io", metrics.writeFilesUs);
+  writer.name("sto").value((unsigned long)metrics.storageWorstUs);
+  writer.name("stoDef").value((unsigned long)metrics.storageDeferred);
+  writeTiming(writer, "rtt", metrics.roundTripMs);
+  writer.endObject();
+
+  if (writer.dataSize() >= bufferSize - 1) {
+    buffer[0] = 0;
+    return 0;
+  }
+  buffer[writer.dataSize()] = 0;
+  return writer.dataSize();
+}
+
+size_t Particle_Functions::formatTaskStats(char *buffer, size_t bufferSize) {
+  TaskScheduler &tasks = TaskScheduler::instance();
+  const TaskScheduler::PassStats &pass = tasks.passStats();
+
+  JSONBufferWriter writer(buffer, bufferSize - 1);
+  writer.beginObject();
+  writer.name("pass").beginObject();
+  writer.name("n").value((unsigned long)pass.passes);
+  writer.name("over").value((unsigned long)pass.overBudget);
+  writer.name("maxUs").value((unsigned long)pass.maxUs);
+  writer.endObject();
+  for (size_t ii = 0; ii < tasks.taskCount(); ii++) {
+    const TaskScheduler::TaskStats &stats = tasks.taskStats(ii);
+    writer.name(tasks.taskName(ii)).beginArray();
+    writer.value((unsigned long)stats.runs);
+    writer.value((unsigned long)stats.avgUs());
+    writer.value((unsigned long)stats.maxUs);
+    writer.value((unsigned long)stats.overruns);
+    writer.value((unsigned long)stats.deferrals);
+    writer.endArray();
+  }
+  writer.endObject();
+
+  if (writer.dataSize() >= bufferSize - 1) {
+    buffer[0] = 0;
+    return 0;
+  }
+  buffer[writer.dataSize()] = 0;
+  return writer.dataSize();
+}
+
+void Particle_Functions::captureMetrics(Metrics &metrics) {
+  const TaskScheduler::PassStats &pass = TaskScheduler::instance().passStats();
+
+  metrics.uptimeSec = (uint32_t)System.uptime();
+  metrics.hourlyCount = current.get_hourlyCount();
+  metrics.dailyCount = current.get_dailyCount();
+  metrics.queueDepth = (uint16_t)PublishQueuePosix::instance().getNumEvents();
+  metrics.loopMaxUs = pass.maxUs;
+  metrics.loopOverBudget = pass.overBudget;
+  metrics.mAhPerDay = EnergyLedger::mAhPerDay();
+  metrics.radioSec = EnergyLedger::seconds(EnergyLedger::RADIO);
+  metrics.lastConnectSec = sysStatus.get_lastConnectionDuration();
+  metrics.connectFailures = sysStatus.get_connectFailures();
+  metrics.connectFailStreak = sysStatus.get_connectFailStreak();
+  metrics.connectBudgetSec = (uint16_t)ConnectHistory::budgetSec();
+  metrics.socTenths = current.get_socTenths();
+  metrics.alertCode = current.get_alertCode();
+  metrics.connected = Particle.connected();
+}
+
+size_t Particle_Functions::formatMetrics(char *buffer, size_t bufferSize) {
+  Metrics metrics;
+  captureMetrics(metrics);
+
+  JSONBufferWriter writer(buffer, bufferSize - 1);
+  writer.beginObject();
+  writer.name("up").value((unsigned long)metrics.uptimeSec);
+  writer.name("hr").value((unsigned long)metrics.hourlyCount);
+  writer.name("day").value((unsigned long)metrics.dailyCount);
+  writer.name("q").value((unsigned)metrics.queueDepth);
+  writer.name("loopMaxUs").value((unsigned long)metrics.loopMaxUs);
+  writer.name("over").value((unsigned long)metrics.loopOverBudget);
+  writer.name("mAhDay").value((double)metrics.mAhPerDay, 1);
+  writer.name("radioSec").value((unsigned long)metrics.radioSec);
+  writer.name("conn").beginObject();
+  writer.name("on").value(metrics.connected);
+  writer.name("lastSec").value((unsigned)metrics.lastConnectSec);
+  writer.name("fail").value((unsigned)metrics.connectFailures);
+  writer.name("streak").value((unsigned)metrics.connectFailStreak);
+  writer.name("budget").value((unsigned)metrics.connectBudgetSec);
+  writer.endObject();
+  writer.name("soc").value(metrics.socTenths / 10.0, 1);
+  writer.name("alert").value((int)metrics.alertCode);
+  writer.endObject();
+
+  if (writer.dataSize() >= bufferSize - 1) {
+    buffer[0] = 0;
+    return 0;
+  }
+  buffer[writer.dataSize()] = 0;
+  return writer.dataSize();
+}
+
+// "config" function: e.g. "interval=900;open=6;close=22;debounce=3000", or
+// "check" to merge the settings ledgers now (CONFIG_CHECK_DAILY)
+static int configFunction(String command) {
+  if (command == "check") {
+    Cloud::instance().requestConfigCheck();
+    return 0;
+  }
+  return Cloud::instance().applyCommand(command.c_str());
+}
+
+static String queueMetricsVariable() {
+  char buffer[512];
+  Particle_Functions::formatQueueMetrics(buffer, sizeof(buffer));
+  return String(buffer);
+}
+
+static String metricsVariable() {
+  char buffer[384];
+  Particle_Functions::formatMetrics(buffer, sizeof(buffer));
+  return String(buffer);
+}
+
+static String taskStatsVariable() {
+  char buffer[512];
+  Particle_Functions::formatTaskStats(buffer, sizeof(buffer));
+  return String(buffer);
+}
+
 void Particle_Functions::setup() {
   // Do not block waiting for USB serial; if a host is connected, logs
   // will be visible. This firmware is designed to run unattended.
@@ -62,6 +236,10 @@ void Particle_Functions::setup() {
                                                         // to in first 30
                                                         // seconds
   // Define the Particle variables and functions
+  Particle.variable("queueMetrics", queueMetricsVariable);
+  Particle.variable("taskStats", taskStatsVariable);
+  Particle.variable("metrics", metricsVariable);
+  Particle.function("config", configFunction);
 }
 
 // This is the end of the Particle_Functions class
\ No newline at end of file
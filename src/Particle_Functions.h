@@ -20,6 +20,46 @@
  */
 class Particle_Functions {
 public:
+    /**
+     * @brief Live values for the metrics cloud variable, copied in one place
+     *
+     * Every field is a counter the firmware already keeps; capture() only
+     * reads them, so nothing runs between queries.
+     */
+    struct Metrics {
+        uint32_t uptimeSec;
+        uint32_t hourlyCount;
+        uint32_t dailyCount;
+        uint16_t queueDepth;            ///< Reports waiting to publish
+        uint32_t loopMaxUs;             ///< Longest main-loop pass since boot
+        uint32_t loopOverBudget;        ///< Passes past LOOP_BUDGET_MS
+        float mAhPerDay;                ///< EnergyLedger estimate from today's buckets
+        uint32_t radioSec;              ///< Network connected today
+        uint16_t lastConnectSec;        ///< Duration of the last cloud connect
+        uint16_t connectFailures;
+        uint8_t connectFailStreak;
+        uint16_t connectBudgetSec;
+        uint16_t socTenths;             ///< State of charge, tenths of a percent
+        int8_t alertCode;
+        bool connected;
+    };
+
+    /**
+     * @brief Fill @p metrics from the live counters
+     */
+    static void captureMetrics(Metrics &metrics);
+
+    /**
+     * @brief Write a metrics snapshot as JSON
+     *
+     * Used by the metrics cloud variable, serialized only when it is read:
+     * {"up","hr","day","q","loopMaxUs","over","mAhDay","radioSec",
+     *  "conn":{"on","lastSec","fail","streak","budget"},"soc","alert"}
+     *
+     * @return Length of the JSON, or 0 if it did not fit
+     */
+    static size_t formatMetrics(char *buffer, size_t bufferSize);
+
     /**
      * @brief Gets the singleton instance of this class, allocating it if necessary
      * 
@@ -34,6 +74,27 @@ public:
      */
     void setup();
 
+    /**
+     * @brief Write the publish queue metrics as JSON
+     * 
+     * Used by the queueMetrics cloud variable and the periodic queueMetrics event
+     * (QUEUE_METRICS_EVENT_HOURS). Timing objects are {"n","max","avg","hist":[5 buckets]};
+     * enq and io are in microseconds, rtt in milliseconds.
+     * 
+     * @return Length of the JSON, or 0 if it did not fit
+     */
+    static size_t formatQueueMetrics(char *buffer, size_t bufferSize);
+
+    /**
+     * @brief Write the TaskScheduler statistics as JSON
+     * 
+     * Used by the taskStats cloud variable:
+     * {"pass":{"n","over","maxUs"},"<task>":[runs,avgUs,maxUs,overruns,deferrals],...}
+     * 
+     * @return Length of the JSON, or 0 if it did not fit
+     */
+    static size_t formatTaskStats(char *buffer, size_t bufferSize);
+
 protected:
     /**
      * @brief The constructor is protected because the class is a singleton
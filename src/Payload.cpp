@@ -0,0 +1,204 @@
+#include "Payload.h"
+
+namespace Payload {
+
+Writer::Writer(char *buf, size_t size) : _buf(buf), _size(size) {
+    if (_buf && _size > 0) {
+        _buf[0] = 0;
+    } else {
+        _ok = false;
+    }
+}
+
+void Writer::put(char c) {
+    if (!_ok || _len + 1 >= _size) {
+        _ok = false;
+        return;
+    }
+    _buf[_len++] = c;
+    _buf[_len] = 0;
+}
+
+void Writer::put(const char *text) {
+    while (*text) {
+        put(*text++);
+    }
+}
+
+void Writer::putUnsigned(uint64_t value) {
+    char digits[20];
+    size_t count = 0;
+    do {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    while (count) {
+        put(digits[--count]);
+    }
+}
+
+void Writer::putKey(const char *key) {
+    if (_needComma) {
+        put(',');
+    }
+    _needComma = true;
+    if (key) {
+        put('"');
+        put(key);
+        put("\":");
+    }
+}
+
+Writer &Writer::beginObject(const char *key) {
+    putKey(key);
+    put('{');
+    _needComma = false;
+    return *this;
+}
+
+Writer &Writer::endObject() {
+    put('}');
+    _needComma = true;
+    return *this;
+}
+
+Writer &Writer::add(const char *key, long long value) {
+    putKey(key);
+    if (value < 0) {
+        put('-');
+        putUnsigned(0ULL - (unsigned long long)value);
+    } else {
+        putUnsigned((unsigned long long)value);
+    }
+    return *this;
+}
+
+Writer &Writer::add(const char *key, unsigned long long value) {
+    putKey(key);
+    putUnsigned(value);
+    return *this;
+}
+
+Writer &Writer::add(const char *key, bool value) {
+    putKey(key);
+    put(value ? "true" : "false");
+    return *this;
+}
+
+Writer &Writer::add(const char *key, const char *value) {
+    putKey(key);
+    put('"');
+    for (const char *p = value ? value : ""; *p; p++) {
+        char c = *p;
+        if (c == '"' || c == '\\') {
+            put('\\');
+            put(c);
+        } else if ((uint8_t)c < 0x20) {
+            put(' ');       // Control characters never belong in these payloads
+        } else {
+            put(c);
+        }
+    }
+    put('"');
+    return *this;
+}
+
+static uint32_t scaleFor(uint8_t decimals) {
+    uint32_t scale = 1;
+    for (uint8_t ii = 0; ii < decimals && ii < 6; ii++) {
+        scale *= 10;
+    }
+    return scale;
+}
+
+void Writer::putScaled(bool negative, uint64_t magnitude, uint32_t scale) {
+    if (negative && magnitude > 0) {
+        put('-');
+    }
+    putUnsigned(magnitude / scale);
+    if (scale > 1) {
+        put('.');
+        uint32_t frac = (uint32_t)(magnitude % scale);
+        for (uint32_t digit = scale / 10; digit > 0; digit /= 10) {
+            put((char)('0' + (frac / digit) % 10));
+        }
+    }
+}
+
+Writer &Writer::addFixed(const char *key, float value, uint8_t decimals) {
+    putKey(key);
+    uint32_t scale = scaleFor(decimals);
+    if (!(value == value)) {
+        value = 0.0f;       // NaN is not JSON
+    }
+    bool negative = value < 0;
+    if (negative) {
+        value = -value;
+    }
+    putScaled(negative, (uint64_t)(value * (float)scale + 0.5f), scale);
+    return *this;
+}
+
+Writer &Writer::addScaled(const char *key, int32_t value, uint8_t decimals) {
+    putKey(key);
+    bool negative = value < 0;
+    putScaled(negative, negative ? 0ULL - (uint64_t)(int64_t)value : (uint64_t)value, scaleFor(decimals));
+    return *this;
+}
+
+Writer &Writer::addRaw(const char *key, const char *json) {
+    putKey(key);
+    put(json);
+    return *this;
+}
+
+Writer &Writer::writeFields(const Field *schema, const Value *values, size_t count) {
+    return writeFields(schema, values, count, 0xFFFFFFFFUL);
+}
+
+Writer &Writer::writeFields(const Field *schema, const Value *values, size_t count, uint32_t mask) {
+    for (size_t ii = 0; ii < count; ii++) {
+        if (ii < 32 && !(mask & (1UL << ii))) {
+            continue;
+        }
+        const Field &field = schema[ii];
+        const Value &value = values[ii];
+        switch (field.kind) {
+        case INT:
+            add(field.key, (long long)value.i);
+            break;
+        case UINT:
+            add(field.key, (unsigned long long)value.u);
+            break;
+        case UINT64:
+            add(field.key, (unsigned long long)value.u64);
+            break;
+        case FIXED:
+            addFixed(field.key, value.f, field.decimals);
+            break;
+        case SCALED:
+            addScaled(field.key, value.i, field.decimals);
+            break;
+        case STRING:
+            if (value.s) {
+                add(field.key, value.s);
+            }
+            break;
+        case BOOL:
+            add(field.key, value.b);
+            break;
+        case RAW:
+            if (value.s) {
+                addRaw(field.key, value.s);
+            }
+            break;
+        }
+    }
+    return *this;
+}
+
+Scaled::Scaled(int32_t value, uint8_t decimals) {
+    Writer(_text, sizeof(_text)).addScaled(nullptr, value, decimals);
+}
+
+} // namespace Payload
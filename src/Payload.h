@@ -0,0 +1,141 @@
+/**
+ * @file Payload.h
+ * @brief JSON for outbound events, written into a caller's buffer.
+ *
+ * @details Writer appends "key":value pairs to one flat or nested object
+ *          with no heap, no String and no printf: integers are converted
+ *          by hand and decimals are written as fixed point (scaled
+ *          integers), so the float printf code is not needed for payloads.
+ *          Its only state is the buffer pointer, length and a comma flag.
+ *
+ *          An event with a fixed set of fields describes them once in a
+ *          const Field table (key, kind, decimals); the caller fills a
+ *          matching Value array and writeFields() emits them in order. The
+ *          hourly report, the daily batch, the startup status and
+ *          SensorData use this.
+ *
+ *          If the buffer fills, the writer stops, ok() turns false and the
+ *          output is still NUL-terminated.
+ */
+
+#ifndef __PAYLOAD_H
+#define __PAYLOAD_H
+
+#include "Particle.h"
+
+namespace Payload {
+
+/** @brief How a schema field's value is written. */
+enum Kind : uint8_t {
+    INT,        ///< Value::i
+    UINT,       ///< Value::u
+    UINT64,     ///< Value::u64
+    FIXED,      ///< Value::f with Field::decimals places
+    SCALED,     ///< Value::i, already in units of 10^-Field::decimals
+    STRING,     ///< Value::s, escaped and quoted; skipped when nullptr
+    BOOL,       ///< Value::b
+    RAW,        ///< Value::s, already JSON; skipped when nullptr
+};
+
+/** @brief One field of an event schema. */
+struct Field {
+    const char *key;
+    Kind kind;
+    uint8_t decimals;       ///< FIXED and SCALED only
+};
+
+/** @brief A field's value; the member used follows Field::kind. */
+union Value {
+    int32_t i;
+    uint32_t u;
+    uint64_t u64;
+    float f;
+    const char *s;
+    bool b;
+};
+
+class Writer {
+public:
+    /**
+     * @brief Write into @p buf of @p size bytes (including the NUL)
+     */
+    Writer(char *buf, size_t size);
+
+    Writer &beginObject(const char *key = nullptr);
+    Writer &endObject();
+
+    // Builtin types rather than intN_t, which differ between ARM and host
+    Writer &add(const char *key, int value) { return add(key, (long long)value); }
+    Writer &add(const char *key, long value) { return add(key, (long long)value); }
+    Writer &add(const char *key, long long value);
+    Writer &add(const char *key, unsigned value) { return add(key, (unsigned long long)value); }
+    Writer &add(const char *key, unsigned long value) { return add(key, (unsigned long long)value); }
+    Writer &add(const char *key, unsigned long long value);
+    Writer &add(const char *key, bool value);
+    Writer &add(const char *key, const char *value);
+
+    /**
+     * @brief Write @p value rounded to @p decimals places, e.g. 87.25
+     */
+    Writer &addFixed(const char *key, float value, uint8_t decimals);
+
+    /**
+     * @brief Write the scaled integer @p value with @p decimals places, e.g.
+     *        2150 with 2 as 21.50
+     */
+    Writer &addScaled(const char *key, int32_t value, uint8_t decimals);
+
+    /**
+     * @brief Write @p json as the value verbatim (an object, array or number)
+     */
+    Writer &addRaw(const char *key, const char *json);
+
+    /**
+     * @brief Write @p count fields of @p schema with the matching @p values
+     */
+    Writer &writeFields(const Field *schema, const Value *values, size_t count);
+
+    /**
+     * @brief As above, writing field N only where bit N of @p mask is set
+     */
+    Writer &writeFields(const Field *schema, const Value *values, size_t count, uint32_t mask);
+
+    /** @brief false if anything did not fit. */
+    bool ok() const { return _ok; }
+
+    /** @brief Characters written, not counting the NUL. */
+    size_t length() const { return _len; }
+
+    const char *c_str() const { return _buf; }
+
+private:
+    void put(char c);
+    void put(const char *text);
+    void putUnsigned(uint64_t value);
+    void putScaled(bool negative, uint64_t magnitude, uint32_t scale);
+    void putKey(const char *key);
+
+    char *_buf;
+    size_t _size;
+    size_t _len = 0;
+    bool _ok = true;
+    bool _needComma = false;
+};
+
+/**
+ * @brief A scaled integer as text for Log lines, without the float printf
+ *
+ * @details Log.info("Temp %s C", Payload::Scaled(tempCenti, 2).c_str())
+ */
+class Scaled {
+public:
+    Scaled(int32_t value, uint8_t decimals);
+    const char *c_str() const { return _text; }
+
+private:
+    char _text[16];
+};
+
+} // namespace Payload
+
+#endif /* __PAYLOAD_H */
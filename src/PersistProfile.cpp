@@ -0,0 +1,137 @@
+#include "PersistProfile.h"
+#include "Config.h"
+
+#if PERSIST_PROFILE_ENABLED
+
+#include "MyPersistentData.h"
+#include "Payload.h"
+
+extern bool publishDiagnosticSafe(const char* eventName, const char* data, PublishFlags flags);
+
+namespace PersistProfile {
+
+static const size_t SLOTS = 128;            // Power of two; more than the fields in use
+static const uint32_t EMPTY = 0xffffffff;
+
+struct Slot {
+    uint32_t key;                           // Object << 16 | write << 15 | offset
+    uint32_t calls;
+    uint32_t ticks;
+};
+
+static Slot slots[SLOTS];
+static uint32_t totalCalls = 0;
+static uint32_t lost = 0;                   // Accesses with no free slot
+static unsigned long periodStartMs = 0;
+
+static const char *const objectNames[] = {"sys", "cfg", "cur"};
+static const StorageHelperRK::PersistentDataBase *objects[3];
+
+static void clear() {
+    for (Slot &slot : slots) {
+        slot = {EMPTY, 0, 0};
+    }
+    totalCalls = 0;
+    lost = 0;
+}
+
+static void onAccess(const StorageHelperRK::PersistentDataBase *data, size_t offset, bool write, uint32_t ticks) {
+    uint32_t object = 0;
+    while (object < 3 && objects[object] != data) {
+        object++;
+    }
+    if (object == 3) {
+        return;     // The consolidated store or a library object
+    }
+    uint32_t key = (object << 16) | ((write ? 1u : 0u) << 15) | (offset & 0x7fff);
+    size_t index = (key * 2654435761u) >> 25;  // Top 7 bits: SLOTS
+
+    SINGLE_THREADED_BLOCK() {
+        totalCalls++;
+        for (size_t probe = 0; probe < SLOTS; probe++) {
+            Slot &slot = slots[(index + probe) & (SLOTS - 1)];
+            if (slot.key == EMPTY) {
+                slot.key = key;
+            }
+            if (slot.key == key) {
+                slot.calls++;
+                slot.ticks += ticks;
+                return;
+            }
+        }
+        lost++;
+    }
+}
+
+static void report(uint32_t periodSec) {
+    // The hook is off while the table is read, so the report's own reads are not counted
+    StorageHelperRK::PersistentDataBase::accessHook = nullptr;
+
+    size_t top[PERSIST_PROFILE_TOP];
+    size_t found = 0;
+    for (size_t ii = 0; ii < SLOTS; ii++) {
+        if (slots[ii].key == EMPTY) {
+            continue;
+        }
+        size_t pos = found < PERSIST_PROFILE_TOP ? found++ : PERSIST_PROFILE_TOP;
+        while (pos > 0 && slots[top[pos - 1]].calls < slots[ii].calls) {
+            if (pos < PERSIST_PROFILE_TOP) {
+                top[pos] = top[pos - 1];
+            }
+            pos--;
+        }
+        if (pos < PERSIST_PROFILE_TOP) {
+            top[pos] = ii;
+        }
+    }
+
+    char data[512];
+    Payload::Writer writer(data, sizeof(data));
+    writer.beginObject()
+          .add("sec", (unsigned long)periodSec)
+          .add("calls", (unsigned long)totalCalls);
+    if (lost) {
+        writer.add("lost", (unsigned long)lost);
+    }
+    for (size_t ii = 0; ii < found; ii++) {
+        const Slot &slot = slots[top[ii]];
+        char key[16];
+        char value[32];
+        snprintf(key, sizeof(key), "%s+%u%c", objectNames[slot.key >> 16], (unsigned)(slot.key & 0x7fff),
+                 (slot.key & 0x8000) ? 's' : 'g');
+        snprintf(value, sizeof(value), "[%lu,%lu]", (unsigned long)slot.calls,
+                 (unsigned long)(slot.ticks / System.ticksPerMicrosecond()));
+        writer.addRaw(key, value);
+    }
+    writer.endObject();
+    if (writer.ok()) {
+        Log.info("PersistProfile: %s", data);
+        publishDiagnosticSafe("persistProf", data, PRIVATE);
+    }
+
+    clear();
+    StorageHelperRK::PersistentDataBase::accessHook = onAccess;
+}
+
+void setup() {
+    objects[0] = &sysStatus;
+    objects[1] = &sensorConfig;
+    objects[2] = &current;
+    clear();
+    periodStartMs = millis();
+    StorageHelperRK::PersistentDataBase::accessHook = onAccess;
+    Log.info("PersistProfile: counting field accesses, report every %d s", PERSIST_PROFILE_PERIOD_SEC);
+}
+
+bool loop() {
+    uint32_t elapsedMs = millis() - periodStartMs;
+    if (elapsedMs >= (uint32_t)PERSIST_PROFILE_PERIOD_SEC * 1000UL) {
+        periodStartMs = millis();
+        report(elapsedMs / 1000);
+    }
+    return true;
+}
+
+} // namespace PersistProfile
+
+#endif /* PERSIST_PROFILE_ENABLED */
@@ -0,0 +1,54 @@
+/**
+ * @file PersistProfile.h
+ * @brief Counts and times every persistent field getter and setter, and
+ *        reports the busiest fields each period.
+ *
+ * @details Debug builds only (PERSIST_PROFILE_ENABLED). Each sysStatus,
+ *          sensorConfig and current get_ and set_ goes through the
+ *          object's mutex; a field read several times a pass (operating
+ *          mode, counting mode, reporting interval) belongs in
+ *          ConfigSnapshot instead. setup() installs the StorageHelperRK
+ *          access hook, which adds each access's calls and System.ticks()
+ *          to a table keyed by object, field offset and direction.
+ *
+ *          Every PERSIST_PROFILE_PERIOD_SEC the PERSIST_PROFILE_TOP fields
+ *          with the most calls are logged and queued as one "persistProf"
+ *          event, and the table starts again:
+ *
+ *              {"sec":3600,"calls":48210,"sys+52g":[9120,3410],
+ *               "sys+12g":[8800,3290],"cur+40s":[420,610],...}
+ *
+ *          Each entry is object ("sys", "cfg", "cur"), the field's offset
+ *          in SysData, SensorData or CurrentData (offsetof(), header
+ *          included), g or s, then calls and total microseconds for the
+ *          period. "calls" covers every field. A full table counts the
+ *          accesses it could not place in "lost".
+ *
+ *          The hook runs on whichever thread made the access; the table is
+ *          updated with thread switching held off. loop() runs on the
+ *          application thread.
+ */
+
+#ifndef __PERSISTPROFILE_H
+#define __PERSISTPROFILE_H
+
+#include "Particle.h"
+
+namespace PersistProfile {
+
+/**
+ * @brief Install the access hook; from setup() once sysStatus, sensorConfig
+ *        and current are set up
+ */
+void setup();
+
+/**
+ * @brief TaskScheduler task: report and reset once a period has passed
+ *
+ * @return true (TaskScheduler task)
+ */
+bool loop();
+
+} // namespace PersistProfile
+
+#endif /* __PERSISTPROFILE_H */
@@ -0,0 +1,219 @@
+#include "PersistentStore.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+
+static const char *storePath = "/usr/store.dat";
+static const char *storeTempPath = "/usr/store.tmp";
+
+PersistentStore *PersistentStore::_instance;
+
+// [static]
+PersistentStore &PersistentStore::instance() {
+    if (!_instance) {
+        _instance = new PersistentStore();
+    }
+    return *_instance;
+}
+
+PersistentStore::PersistentStore() {}
+
+PersistentStore::~PersistentStore() {
+    delete[] _image;
+}
+
+void PersistentStore::attach(Section id, StorageHelperRK::PersistentDataBase &data, const void *image, size_t size, void (*onWritten)()) {
+    Slot &slot = _slots[id - 1];
+    slot.data = &data;
+    slot.image = image;
+    slot.size = (uint16_t)size;
+    slot.onWritten = onWritten;
+}
+
+void PersistentStore::markDirty(Section id) {
+    _slots[id - 1].dirty = true;
+}
+
+bool PersistentStore::readImage() {
+    _imageRead = true;
+
+    int fd = open(storePath, O_RDONLY);
+    if (fd < 0) {
+        return false;   // First boot with the consolidated store
+    }
+    off_t length = lseek(fd, 0, SEEK_END);
+    if (length < (off_t)sizeof(FileHeader) || length > 8192) {
+        close(fd);
+        Log.warn("Store: unexpected file size %ld", (long)length);
+        return false;
+    }
+    _image = new uint8_t[length];
+    if (!_image) {
+        close(fd);
+        return false;
+    }
+    lseek(fd, 0, SEEK_SET);
+    int count = read(fd, _image, length);
+    close(fd);
+
+    const FileHeader *hdr = (const FileHeader *)_image;
+    if (count != (int)length || hdr->magic != STORE_MAGIC || hdr->version != STORE_VERSION ||
+        sizeof(FileHeader) + hdr->sectionCount * sizeof(SectionEntry) > (size_t)length) {
+        Log.warn("Store: file header invalid");
+        delete[] _image;
+        _image = nullptr;
+        return false;
+    }
+    _imageSize = length;
+    return true;
+}
+
+size_t PersistentStore::readSection(Section id, void *dest, size_t size) {
+    if (!_imageRead) {
+        readImage();
+    }
+    if (!_image) {
+        return 0;
+    }
+
+    const FileHeader *hdr = (const FileHeader *)_image;
+    const SectionEntry *table = (const SectionEntry *)(_image + sizeof(FileHeader));
+    for (uint8_t i = 0; i < hdr->sectionCount; i++) {
+        const SectionEntry &entry = table[i];
+        if (entry.id != id) {
+            continue;
+        }
+        if ((size_t)entry.offset + entry.size > _imageSize) {
+            Log.warn("Store: section %u out of bounds", id);
+            return 0;
+        }
+        // A section saved by older firmware may be shorter; validate() pads it
+        size_t count = (entry.size < size) ? entry.size : size;
+        memset(dest, 0, size);
+        memcpy(dest, _image + entry.offset, count);
+        return count;
+    }
+    return 0;
+}
+
+void PersistentStore::releaseImage(Section id) {
+    _sectionsLoaded |= (uint8_t)(1 << (id - 1));
+    if (_sectionsLoaded == (1 << NUM_SECTIONS) - 1) {
+        delete[] _image;
+        _image = nullptr;
+        _imageSize = 0;
+    }
+}
+
+bool PersistentStore::saveSection(StorageHelperRK::PersistentDataBase &data, Section id) {
+    // Hash (and optionally log) the section, as a file save would
+    data.StorageHelperRK::PersistentDataBase::save();
+    markDirty(id);
+
+    if (_writing) {
+        return true;    // Pulled into a write already in progress
+    }
+    _writing = true;
+
+    // Fold every other pending save into this write
+    for (Slot &slot : _slots) {
+        if (slot.data && slot.data != &data) {
+            slot.data->flush(true);
+        }
+    }
+    bool ok = writeFile();
+
+    _writing = false;
+    return ok;
+}
+
+// Returns the bytes written, 0 on error
+static size_t writeBytes(int fd, const void *buf, size_t len) {
+    int n = write(fd, buf, len);
+    return (n > 0) ? (size_t)n : 0;
+}
+
+bool PersistentStore::writeFile() {
+    uint32_t start = micros();
+    if (StorageHelperRK::PersistentDataFileSystem::writeDelayMs) {
+        delay(StorageHelperRK::PersistentDataFileSystem::writeDelayMs);   // Bench slow-flash fault, as for the files
+    }
+
+    // Each section comes from its live object, or, for a section whose
+    // object has not loaded yet this boot, from the boot image so it is
+    // not dropped from the file.
+    const void *sources[NUM_SECTIONS] = {};
+    uint16_t sizes[NUM_SECTIONS] = {};
+    for (uint8_t i = 0; i < NUM_SECTIONS; i++) {
+        if (_slots[i].data) {
+            sources[i] = _slots[i].image;
+            sizes[i] = _slots[i].size;
+        }
+        else if (_image) {
+            const FileHeader *old = (const FileHeader *)_image;
+            const SectionEntry *oldTable = (const SectionEntry *)(_image + sizeof(FileHeader));
+            for (uint8_t j = 0; j < old->sectionCount; j++) {
+                if (oldTable[j].id == i + 1 && (size_t)oldTable[j].offset + oldTable[j].size <= _imageSize) {
+                    sources[i] = _image + oldTable[j].offset;
+                    sizes[i] = oldTable[j].size;
+                }
+            }
+        }
+    }
+
+    FileHeader hdr = {};
+    hdr.magic = STORE_MAGIC;
+    hdr.version = STORE_VERSION;
+
+    SectionEntry table[NUM_SECTIONS] = {};
+    uint16_t offset = sizeof(FileHeader) + sizeof(table);
+    for (uint8_t i = 0; i < NUM_SECTIONS; i++) {
+        if (!sources[i]) {
+            continue;
+        }
+        SectionEntry &entry = table[hdr.sectionCount++];
+        entry.id = i + 1;
+        entry.size = sizes[i];
+        entry.offset = offset;
+        offset += sizes[i];
+    }
+
+    size_t expected = offset;
+    size_t count = 0;
+    int fd = open(storeTempPath, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd >= 0) {
+        count += writeBytes(fd, &hdr, sizeof(hdr));
+        count += writeBytes(fd, table, sizeof(table));
+        for (uint8_t i = 0; i < NUM_SECTIONS; i++) {
+            if (!sources[i]) {
+                continue;
+            }
+            if (_slots[i].data) {
+                WITH_LOCK(*_slots[i].data) {
+                    count += writeBytes(fd, sources[i], sizes[i]);
+                }
+            }
+            else {
+                count += writeBytes(fd, sources[i], sizes[i]);
+            }
+        }
+        close(fd);
+    }
+
+    bool ok = (fd >= 0 && count == expected && rename(storeTempPath, storePath) == 0);
+    _stats.add(micros() - start, count, ok);
+    if (!ok) {
+        Log.warn("Store: write failed (%u of %u bytes)", (unsigned)count, (unsigned)expected);
+        return false;
+    }
+
+    for (Slot &slot : _slots) {
+        if (slot.dirty) {
+            slot.dirty = false;
+            if (slot.onWritten) {
+                slot.onWritten();
+            }
+        }
+    }
+    return true;
+}
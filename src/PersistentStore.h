@@ -0,0 +1,151 @@
+/**
+ * @file PersistentStore.h
+ * @brief Optional consolidated file for sysStatus, sensorConfig and current.
+ *
+ * @details With PERSISTENT_SINGLE_FILE enabled the three persistent data
+ *          objects keep their structures, getters and setters, but load
+ *          from and save to sections of one file (/usr/store.dat) instead of
+ *          one file each:
+ *
+ *          - Boot opens and reads the file once; each object validates its
+ *            own section with its usual header and hash.
+ *          - When an object saves, any other object with a pending save is
+ *            saved too, and all sections go out in a single write. The write
+ *            goes to a temporary file that is then renamed, so a reset
+ *            mid-write keeps the previous file intact.
+ *          - A section missing from the file (first boot with this option,
+ *            or an added section) is loaded from the object's legacy file
+ *            and migrated on the next write. Legacy files are left in
+ *            place so older firmware can still read them.
+ *
+ * File layout: FileHeader, then NUM_SECTIONS SectionEntry records, then
+ * the section images (each a complete SavedDataHeader + data structure).
+ */
+
+#ifndef __PERSISTENTSTORE_H
+#define __PERSISTENTSTORE_H
+
+#include "Particle.h"
+#include "StorageHelperRK.h"
+
+class PersistentStore {
+public:
+    /** @brief Section IDs; stable on flash. */
+    enum Section : uint8_t {
+        SECTION_SYS     = 1,
+        SECTION_SENSOR  = 2,
+        SECTION_CURRENT = 3,
+    };
+
+    static constexpr uint8_t NUM_SECTIONS = 3;
+
+    /**
+     * @brief Gets the singleton instance of this class, allocating it if necessary
+     */
+    static PersistentStore &instance();
+
+    /**
+     * @brief Load one object's section, falling back to its legacy file
+     *
+     * Called from the object's load() override. @p onWritten, if set, is
+     * called after a file write that included this section.
+     */
+    template<class T>
+    bool loadSection(T &data, Section id, StorageHelperRK::PersistentDataBase::SavedDataHeader *image, size_t size, void (*onWritten)() = nullptr) {
+        attach(id, data, image, size, onWritten);
+        WITH_LOCK(data) {
+            size_t loaded = readSection(id, image, size);
+            if (loaded == 0) {
+                Log.info("Store: section %u not found, loading legacy file", id);
+                data.StorageHelperRK::PersistentDataFile::load();
+                markDirty(id);
+            }
+            else if (!data.validate(loaded)) {
+                data.initialize();
+            }
+        }
+        releaseImage(id);
+        return true;
+    }
+
+    /**
+     * @brief Hash one object's section and write the file
+     *
+     * Called from the object's save() override. Other objects with a
+     * pending save are flushed into the same write.
+     *
+     * @return false if the file could not be written; true once written, or
+     *         when the section was pulled into a write already in progress
+     */
+    bool saveSection(StorageHelperRK::PersistentDataBase &data, Section id);
+
+    /**
+     * @brief Write instrumentation for the consolidated file
+     */
+    const StorageHelperRK::PersistentDataBase::SaveStats &getSaveStats() const { return _stats; }
+
+protected:
+    PersistentStore();
+    virtual ~PersistentStore();
+    PersistentStore(const PersistentStore&) = delete;
+    PersistentStore& operator=(const PersistentStore&) = delete;
+
+    /** @brief File header (12 bytes). */
+    struct FileHeader {
+        uint32_t magic;
+        uint16_t version;
+        uint8_t  sectionCount;
+        uint8_t  reserved;
+        uint32_t reserved2;
+    };
+
+    /** @brief Section table entry (8 bytes). */
+    struct SectionEntry {
+        uint8_t  id;
+        uint8_t  reserved;
+        uint16_t size;
+        uint16_t offset;
+        uint16_t reserved2;
+    };
+
+    struct Slot {
+        StorageHelperRK::PersistentDataBase *data;
+        const void *image;
+        uint16_t size;
+        bool dirty;
+        void (*onWritten)();
+    };
+
+    void attach(Section id, StorageHelperRK::PersistentDataBase &data, const void *image, size_t size, void (*onWritten)());
+    void markDirty(Section id);
+
+    /**
+     * @brief Copy a section from the boot image into @p dest
+     * @return Bytes copied (0 if the section is not in the file)
+     */
+    size_t readSection(Section id, void *dest, size_t size);
+
+    /**
+     * @brief Free the boot image once every section has been loaded
+     */
+    void releaseImage(Section id);
+
+    bool readImage();
+    bool writeFile();
+
+    Slot _slots[NUM_SECTIONS] = {};
+    uint8_t *_image = nullptr;         // Whole file, read once at boot
+    size_t _imageSize = 0;
+    bool _imageRead = false;
+    uint8_t _sectionsLoaded = 0;       // Bit per section loaded at boot
+    bool _writing = false;
+
+    StorageHelperRK::PersistentDataBase::SaveStats _stats;
+
+    static const uint32_t STORE_MAGIC = 0x73d0c5e1;
+    static const uint16_t STORE_VERSION = 1;
+
+    static PersistentStore *_instance;
+};
+
+#endif /* __PERSISTENTSTORE_H */
@@ -0,0 +1,61 @@
+#include "PhaseMarker.h"
+#include "Config.h"
+#include "device_pinout.h"
+
+#if PHASE_MARKERS && SENSOR_DRIVER_LORA_GATEWAY
+#error "PHASE_MARKERS uses the LoRa gateway pins"
+#endif
+
+namespace PhaseMarker {
+
+#if PHASE_MARKERS
+static uint8_t shown = 0xff;
+
+void setup() {
+    for (size_t ii = 0; ii < 3; ii++) {
+        pinMode(phaseMarkerPins[ii], OUTPUT);
+    }
+    set(BOOTING);
+}
+
+void set(Phase phase) {
+    if (phase == shown) {
+        return;
+    }
+    shown = phase;
+    for (size_t ii = 0; ii < 3; ii++) {
+        if (phase & (1 << ii)) {
+            pinSetFast(phaseMarkerPins[ii]);
+        } else {
+            pinResetFast(phaseMarkerPins[ii]);
+        }
+    }
+}
+
+void noteState(State to) {
+    switch (to) {
+    case INITIALIZATION_STATE:
+        set(BOOTING);
+        break;
+    case SLEEPING_STATE:
+        break;
+    case CONNECTING_STATE:
+        set(Particle.connected() ? CONNECTED : CONNECTING);
+        break;
+    default:
+        set(Particle.connected() ? CONNECTED : SENSING);
+        break;
+    }
+}
+
+void noteWake() {
+    set(Particle.connected() ? CONNECTED : SENSING);
+}
+#else
+void setup() {}
+void set(Phase) {}
+void noteState(State) {}
+void noteWake() {}
+#endif
+
+} // namespace PhaseMarker
@@ -0,0 +1,66 @@
+/**
+ * @file PhaseMarker.h
+ * @brief What the device is doing, on three GPIOs, for a power analyzer.
+ *
+ * @details With PHASE_MARKERS, phaseMarkerPins carry a 3-bit Phase code
+ *          that follows the state machine and the radio: BOOTING from
+ *          setup(), SENSING while awake offline, CONNECTING until the cloud
+ *          session is up, CONNECTED while it is, DISCONNECTING from the
+ *          disconnect request until sleep, and SLEEPING (all pins low) for
+ *          the duration of System.sleep(). Recorded on an analyzer's digital
+ *          inputs next to the current, phase_energy.py turns a capture into
+ *          time and charge per phase, so the bench comparison in
+ *          docs/bench-validation.md is a number, not a reading of the log.
+ *
+ *          Pins change only when the phase does, with pinSetFast(), so the
+ *          markers add no measurable current or time. HIBERNATE leaves the
+ *          pins floating; give the analyzer inputs pull-downs so it reads
+ *          SLEEPING. Without PHASE_MARKERS every call is empty.
+ *
+ *          Application thread only.
+ */
+
+#ifndef __PHASEMARKER_H
+#define __PHASEMARKER_H
+
+#include "Particle.h"
+#include "StateMachine.h"
+
+namespace PhaseMarker {
+
+/** @brief The code on the pins; bit 0 on phaseMarkerPins[0]. Do not renumber: phase_energy.py uses it. */
+enum Phase : uint8_t {
+    SLEEPING = 0,
+    BOOTING = 1,
+    SENSING = 2,
+    CONNECTING = 3,
+    CONNECTED = 4,
+    DISCONNECTING = 5
+};
+
+/**
+ * @brief Make the pins outputs and show BOOTING; call first in setup()
+ */
+void setup();
+
+/**
+ * @brief Show @p phase
+ */
+void set(Phase phase);
+
+/**
+ * @brief Show the phase of state @p to; called on every state transition
+ *
+ * Awake states show CONNECTED while the cloud is connected. SLEEPING_STATE
+ * keeps the current phase: its disconnect and System.sleep() set their own.
+ */
+void noteState(State to);
+
+/**
+ * @brief Show SENSING or CONNECTED after System.sleep() returns
+ */
+void noteWake();
+
+} // namespace PhaseMarker
+
+#endif /* __PHASEMARKER_H */
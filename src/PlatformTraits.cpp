@@ -0,0 +1,366 @@
+#include "PlatformTraits.h"
+#include "MyPersistentData.h"
+#include "Payload.h"
+#include <math.h>
+
+// One section per platform; only the one being built is compiled.
+
+namespace {
+
+#if HAL_PLATFORM_CELLULAR
+bool cellularSignalText(char *buf, size_t size, float &strength) {
+  const char *radioTech[10] = {"Unknown",    "None",       "WiFi", "GSM",
+                               "UMTS",       "CDMA",       "LTE",  "IEEE802154",
+                               "LTE_CAT_M1", "LTE_CAT_NB1"};
+  // New Signal Strength capability -
+  // https://community.particle.io/t/boron-lte-and-cellular-rssi-funny-values/45299/8
+  CellularSignal sig = Cellular.RSSI();
+
+  auto rat = sig.getAccessTechnology();
+
+  // float strengthVal = sig.getStrengthValue();
+  float strengthPercentage = sig.getStrength();
+
+  // float qualityVal = sig.getQualityValue();
+  float qualityPercentage = sig.getQuality();
+
+  snprintf(buf, size, "%s S:%2d%%, Q:%2d%% ",
+           radioTech[rat], (int)lroundf(strengthPercentage), (int)lroundf(qualityPercentage));
+  strength = strengthPercentage;
+  return true;
+}
+#endif
+
+#if HAL_PLATFORM_WIFI && !HAL_PLATFORM_CELLULAR
+bool wifiSignalText(char *buf, size_t size, float &strength) {
+  WiFiSignal sig = WiFi.RSSI();
+  float strengthPercentage = sig.getStrength();
+  float qualityPercentage = sig.getQuality();
+
+  snprintf(buf, size, "WiFi S:%2d%%, Q:%2d%% ",
+           (int)lroundf(strengthPercentage), (int)lroundf(qualityPercentage));
+  strength = strengthPercentage;
+  return true;
+}
+#endif
+
+#if PLATFORM_TRAITS_KIND == PLATFORM_TRAITS_BORON || PLATFORM_TRAITS_KIND == PLATFORM_TRAITS_MSOM || \
+    PLATFORM_TRAITS_KIND == PLATFORM_TRAITS_ARGON
+// Gen 3 devices: built-in System battery APIs backed by the fuel gauge
+// (and a BQ24195 PMIC on Boron only).
+bool readFuelGauge(Platform::BatteryReading &reading) {
+  reading.batteryState = System.batteryState();
+  // The fuel gauge reports percent as a float (-1 when unknown); scaled once here
+  float charge = System.batteryCharge();
+  reading.socTenths = (charge > 0.0f) ? (uint16_t)(charge * 10.0f + 0.5f) : 0;
+  if (reading.socTenths > 1000) {
+    reading.socTenths = 1000;
+  }
+  reading.powerSource = System.powerSource();
+  reading.millivolts = 0;
+  return true;
+}
+#endif
+
+#if PLATFORM_TRAITS_KIND == PLATFORM_TRAITS_P2
+// Single-cell LiPo open-circuit voltage against state of charge, 10% steps
+struct LipoPoint {
+  uint16_t millivolts;
+  uint16_t socTenths;
+};
+
+constexpr LipoPoint LIPO_CURVE[] = {
+  {3270, 0},   {3610, 50},  {3690, 100}, {3730, 200}, {3770, 300}, {3800, 400},
+  {3840, 500}, {3870, 600}, {3950, 700}, {4020, 800}, {4110, 900}, {4200, 1000},
+};
+constexpr size_t LIPO_POINTS = sizeof(LIPO_CURVE) / sizeof(LIPO_CURVE[0]);
+
+// Linear between the points of LIPO_CURVE, clamped at both ends
+uint16_t lipoSocTenths(uint16_t millivolts) {
+  if (millivolts <= LIPO_CURVE[0].millivolts) {
+    return 0;
+  }
+  for (size_t ii = 1; ii < LIPO_POINTS; ii++) {
+    const LipoPoint &lo = LIPO_CURVE[ii - 1];
+    const LipoPoint &hi = LIPO_CURVE[ii];
+    if (millivolts < hi.millivolts) {
+      return (uint16_t)(lo.socTenths + (uint32_t)(millivolts - lo.millivolts) * (hi.socTenths - lo.socTenths) /
+                                           (hi.millivolts - lo.millivolts));
+    }
+  }
+  return 1000;
+}
+#endif
+
+#if PLATFORM_TRAITS_KIND == PLATFORM_TRAITS_BORON || PLATFORM_TRAITS_KIND == PLATFORM_TRAITS_MSOM
+void setPmicCharging(bool enable) {
+  PMIC pmic(true);
+  if (enable) {
+    pmic.enableCharging();
+  } else {
+    pmic.disableCharging();
+  }
+}
+#endif
+
+} // namespace
+
+namespace Platform {
+
+#if PLATFORM_TRAITS_KIND == PLATFORM_TRAITS_BORON
+
+bool Traits<Kind::BORON>::readBattery(BatteryReading &reading) {
+  return readFuelGauge(reading);
+}
+
+// =========================================================================
+// PMIC Health Monitoring & Smart Remediation (BQ24195 PMIC)
+// =========================================================================
+// Supported platforms: Boron (Gen 3 cellular with BQ24195 PMIC)
+// Excluded platforms: M-SoM/Muon (uses Particle Power Module with MAX17043, not BQ24195)
+//
+// Detects charging faults (1Hz amber LED = fault register set) and attempts
+// automatic recovery with escalating remediation levels to prevent thrashing.
+//
+// Alert Codes (auto-reported via webhook):
+//   20 = PMIC Thermal Shutdown (critical - charging stopped due to temp)
+//   21 = PMIC Charge Timeout (critical - safety timer expired, stuck charging)
+//   23 = PMIC Battery Fault (major - general charging issue)
+//
+// Log-Only Diagnostics (NOT alerted - transient/normal conditions):
+//   Input Fault: VBUS out of range (solar undervoltage common, backend detects sustained issues)
+//
+// Remediation Strategy:
+//   Level 0: Monitor only (log diagnostics, raise alert)
+//   Level 1: Soft reset (cycle charging off/on after 2+ consecutive faults)
+//   Level 2: Power cycle with watchdog (after 3+ consecutive faults)
+//   Cooldown: 1 hour minimum between remediation attempts
+//   Auto-Clear: Resets all counters when charging returns to healthy state
+//
+// This prevents the common "loss of charge until power cycle" issue by
+// detecting PMIC faults early and automatically attempting recovery before
+// requiring manual intervention.
+// =========================================================================
+void Traits<Kind::BORON>::checkCharger(uint16_t socTenths, bool safeToCharge, ChargerStatus &status) {
+  // Tracks charging faults and attempts smart remediation with escalation
+  static unsigned long lastRemediationAttempt = 0;
+  static uint8_t remediationLevel = 0; // 0=none, 1=soft reset, 2=power cycle
+  static uint8_t consecutiveFaults = 0;
+  const unsigned long REMEDIATION_COOLDOWN = 3600000; // 1 hour between attempts
+
+  PMIC pmic(true); // true = lock I2C during operations
+
+  // Read REG09 (Fault Register)
+  byte faultReg = pmic.readFaultRegister();
+  status.faultReg = faultReg;
+
+  // Check for charging faults (bits 3-5: CHRG_FAULT)
+  if (faultReg & 0x38) {
+    uint8_t chargeFault = (faultReg >> 3) & 0x07;
+    consecutiveFaults++;
+
+    switch(chargeFault) {
+      case 0x01: // Input fault (VBUS overvoltage or undervoltage)
+        // This triggers when VIN < powerSourceMinVoltage (5.08V) or > max
+        // Most common cause: obscured/faulty solar panel insufficient voltage
+        // LOG ONLY - transient voltage dips are normal (clouds, trees, dawn/dusk)
+        // Backend detects sustained panel failures via multi-day SoC decline
+        Log.info("PMIC: Input fault - VBUS out of range (likely solar variation)");
+        break;
+      case 0x02: // Thermal shutdown
+        Log.error("PMIC: Thermal shutdown - charging stopped due to temperature");
+        current.raiseAlert(20); // Alert code 20: PMIC Thermal (critical)
+        break;
+      case 0x03: // Charge safety timer expired
+        Log.error("PMIC: Charge safety timer expired - charging timeout (common stuck charging indicator)");
+        current.raiseAlert(21); // Alert code 21: PMIC Charge Timeout (critical)
+        break;
+      default:
+        Log.warn("PMIC: Charge fault detected (code=0x%02x)", chargeFault);
+        current.raiseAlert(23); // Alert code 23: PMIC Battery Fault
+        break;
+    }
+
+    // Smart remediation with escalation and thrash prevention
+    // CRITICAL SAFETY CHECK: Never attempt remediation if charging is disabled due to temperature
+    if (!safeToCharge) {
+      Log.info("PMIC: Fault detected but charging disabled due to temperature (%sC) - skipping remediation",
+               Payload::Scaled(current.get_internalTempCenti(), 2).c_str());
+      // Don't escalate fault counters when temperature is the issue
+      // Temperature will recover naturally without intervention
+    } else {
+      unsigned long now = millis();
+      if (now - lastRemediationAttempt > REMEDIATION_COOLDOWN) {
+        // Escalate remediation level based on consecutive faults
+        if (consecutiveFaults >= 3 && remediationLevel < 2) {
+          remediationLevel = 2; // Escalate to power cycle reset
+        } else if (consecutiveFaults >= 2 && remediationLevel < 1) {
+          remediationLevel = 1; // Escalate to disable/enable charging
+        }
+
+        // Apply remediation based on level
+        switch(remediationLevel) {
+          case 1:
+            Log.warn("PMIC: Attempting soft remediation - cycle charging (level 1)");
+            pmic.disableCharging();
+            delay(500);
+            pmic.enableCharging();
+            Log.info("PMIC: Charging re-enabled after soft reset");
+            break;
+
+          case 2:
+            Log.error("PMIC: Attempting aggressive remediation - power cycle reset (level 2)");
+            pmic.disableCharging();
+            delay(1000);
+            // Set watchdog to force reset in 10 seconds if charging doesn't recover
+            pmic.setWatchdog(0b01); // 40 seconds
+            pmic.enableCharging();
+            Log.info("PMIC: Charging re-enabled with watchdog supervision");
+            remediationLevel = 0; // Reset level after power cycle attempt
+            break;
+
+          default:
+            Log.info("PMIC: Fault detected but remediation level 0 - monitoring only");
+            break;
+        }
+
+        lastRemediationAttempt = now;
+      } else {
+        unsigned long remainingCooldown = (REMEDIATION_COOLDOWN - (now - lastRemediationAttempt)) / 60000;
+        Log.info("PMIC: Fault detected but in cooldown period (%lu min remaining)", remainingCooldown);
+      }
+    }
+  } else {
+    // No faults detected - clear counters if charging is healthy
+    if (consecutiveFaults > 0) {
+      Log.info("PMIC: Charging healthy - clearing fault counters");
+      consecutiveFaults = 0;
+      remediationLevel = 0;
+
+      // Clear PMIC-related alerts if they were active
+      for (int8_t pmicAlert = 20; pmicAlert <= 23; pmicAlert++) {
+        if (current.isAlertActive(pmicAlert)) {
+          Log.info("PMIC: Clearing battery/charging alert %d - charging resumed", pmicAlert);
+          current.clearAlert(pmicAlert);
+        }
+      }
+    }
+  }
+
+  // Read REG08 (System Status Register) for additional diagnostics
+  byte systemStatus = pmic.readSystemStatusRegister();
+  status.systemStatus = systemStatus;
+  uint8_t chargeStatus = (systemStatus >> 4) & 0x03;
+  bool vbusGood = (systemStatus & 0x80) != 0;
+  uint8_t thermalStatus = systemStatus & 0x03;
+
+  const char* chargeStatusStr[] = {"Not Charging", "Pre-charge", "Fast Charging", "Charge Done"};
+  const char* thermalStr[] = {"Normal", "Warm", "Hot", "Cold"};
+
+  Log.info("PMIC Status: charge=%s, VBUS=%s, thermal=%s, faultReg=0x%02x",
+           chargeStatusStr[chargeStatus],
+           vbusGood ? "Good" : "Fault",
+           thermalStr[thermalStatus],
+           faultReg);
+
+  // Detect stuck charging state (charging for >6 hours at same SoC)
+  static uint8_t lastChargeStatus = 0xFF;
+  static int lastSocTenths = -1;
+  static unsigned long chargeStateStartTime = 0;
+
+  if (chargeStatus == 2) { // Fast Charging
+    if (lastChargeStatus == 2) {
+      // Still in fast charging
+      if (abs((int)socTenths - lastSocTenths) < 10) { // SoC not increasing
+        if (chargeStateStartTime == 0) {
+          chargeStateStartTime = millis();
+        } else if (millis() - chargeStateStartTime > 6UL * 3600000UL) { // 6 hours
+          Log.error("PMIC: Stuck in Fast Charging for 6+ hours with no SoC increase (%s%%) - possible fault",
+                    Payload::Scaled(socTenths, 1).c_str());
+          current.raiseAlert(21); // Charge timeout alert
+        }
+      } else {
+        chargeStateStartTime = 0; // SoC increasing, reset timer
+      }
+    } else {
+      chargeStateStartTime = millis(); // Just entered fast charging
+    }
+  } else {
+    chargeStateStartTime = 0; // Not charging or charge done
+  }
+
+  lastChargeStatus = chargeStatus;
+  lastSocTenths = socTenths;
+}
+
+void Traits<Kind::BORON>::setCharging(bool enable) {
+  setPmicCharging(enable);
+}
+
+bool Traits<Kind::BORON>::signalText(char *buf, size_t size, float &strength) {
+  return cellularSignalText(buf, size, strength);
+}
+
+#elif PLATFORM_TRAITS_KIND == PLATFORM_TRAITS_MSOM
+
+bool Traits<Kind::MSOM>::readBattery(BatteryReading &reading) {
+  return readFuelGauge(reading);
+}
+
+void Traits<Kind::MSOM>::setCharging(bool enable) {
+  setPmicCharging(enable);
+}
+
+bool Traits<Kind::MSOM>::signalText(char *buf, size_t size, float &strength) {
+  return cellularSignalText(buf, size, strength);
+}
+
+#elif PLATFORM_TRAITS_KIND == PLATFORM_TRAITS_ARGON
+
+bool Traits<Kind::ARGON>::readBattery(BatteryReading &reading) {
+  return readFuelGauge(reading);
+}
+
+bool Traits<Kind::ARGON>::signalText(char *buf, size_t size, float &strength) {
+  return wifiSignalText(buf, size, strength);
+}
+
+#elif PLATFORM_TRAITS_KIND == PLATFORM_TRAITS_P2
+
+bool Traits<Kind::P2>::readBattery(BatteryReading &reading) {
+  // Measure battery voltage (VBAT_MEAS on Photon 2, or same pin on P2
+  // carrier) using A6 as described in the Photon 2 battery voltage docs.
+  int raw = analogRead(A6);
+  uint16_t millivolts = (uint16_t)(((uint32_t)raw * 5000 + 2048) / 4096); // Map ADC count (0-4095) to 0-5V
+
+  // Approximate state-of-charge from voltage for a LiPo battery, along its
+  // resting discharge curve: flat through the middle, steep at both ends.
+  uint16_t socTenths = lipoSocTenths(millivolts);
+
+  // Photon 2/P2 cannot reliably determine charging state without a PMIC.
+  // Always report "Unknown" since voltage alone can't distinguish between
+  // charging and discharging at the same voltage level.
+  reading.batteryState = 0;
+  reading.socTenths = socTenths;
+  reading.powerSource = 0;
+  reading.millivolts = millivolts;
+  return true;
+}
+
+bool Traits<Kind::P2>::signalText(char *buf, size_t size, float &strength) {
+  return wifiSignalText(buf, size, strength);
+}
+
+#else
+
+bool Traits<Kind::OTHER>::signalText(char *buf, size_t size, float &strength) {
+#if HAL_PLATFORM_WIFI
+  return wifiSignalText(buf, size, strength);
+#else
+  return false;
+#endif
+}
+
+#endif
+
+} // namespace Platform
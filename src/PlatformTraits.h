@@ -0,0 +1,157 @@
+/**
+ * @file PlatformTraits.h
+ * @brief Battery, charger, temperature and radio operations for the
+ *        platform being built.
+ *
+ * @details PLATFORM_TRAITS_KIND is worked out once below from PLATFORM_ID
+ *          and the HAL feature macros; Platform::This is the Traits
+ *          specialization for it. Callers test its constants with
+ *          `if constexpr` and call its functions, so a build contains only
+ *          its own platform's code and no platform checks at run time.
+ *          PlatformTraits.cpp defines the functions, one section per
+ *          platform, each compiled only for that platform.
+ *
+ *          - BORON: Boron and B SoM. Fuel gauge, BQ24195 PMIC with charge
+ *            control and fault remediation, cellular.
+ *          - MSOM: M-SoM/Muon. Fuel gauge and charge control, no PMIC
+ *            fault register, cellular.
+ *          - ARGON: fuel gauge only, Wi-Fi.
+ *          - P2: Photon 2/P2. SoC estimated from the VBAT voltage on A6, no
+ *            TMP36 unless MUON_HAS_TMP36, Wi-Fi.
+ *          - OTHER: no battery readings.
+ *
+ *          Application thread only.
+ */
+
+#ifndef __PLATFORMTRAITS_H
+#define __PLATFORMTRAITS_H
+
+#include "Particle.h"
+
+#define PLATFORM_TRAITS_OTHER 0
+#define PLATFORM_TRAITS_BORON 1
+#define PLATFORM_TRAITS_MSOM 2
+#define PLATFORM_TRAITS_ARGON 3
+#define PLATFORM_TRAITS_P2 4
+
+#if HAL_PLATFORM_CELLULAR && (PLATFORM_ID != PLATFORM_MSOM)
+#define PLATFORM_TRAITS_KIND PLATFORM_TRAITS_BORON
+#elif HAL_PLATFORM_CELLULAR
+#define PLATFORM_TRAITS_KIND PLATFORM_TRAITS_MSOM
+#elif PLATFORM_ID == PLATFORM_ARGON
+#define PLATFORM_TRAITS_KIND PLATFORM_TRAITS_ARGON
+#elif PLATFORM_ID == 32 || PLATFORM_ID == 34
+#define PLATFORM_TRAITS_KIND PLATFORM_TRAITS_P2
+#else
+#define PLATFORM_TRAITS_KIND PLATFORM_TRAITS_OTHER
+#endif
+
+namespace Platform {
+
+enum class Kind : uint8_t {
+    OTHER = PLATFORM_TRAITS_OTHER,
+    BORON = PLATFORM_TRAITS_BORON,
+    MSOM = PLATFORM_TRAITS_MSOM,
+    ARGON = PLATFORM_TRAITS_ARGON,
+    P2 = PLATFORM_TRAITS_P2
+};
+
+/** @brief The platform this firmware is built for */
+constexpr Kind THIS_KIND = (Kind)PLATFORM_TRAITS_KIND;
+
+/** @brief One battery reading */
+struct BatteryReading {
+    uint8_t batteryState;   ///< System.batteryState() (0 where unknown)
+    uint16_t socTenths;     ///< Tenths of a percent (0 where unknown)
+    int powerSource;        ///< System.powerSource() (0 where unknown)
+    uint16_t millivolts;    ///< VBAT where SoC comes from it, else 0
+};
+
+/** @brief PMIC registers read by checkCharger() */
+struct ChargerStatus {
+    uint8_t faultReg;       ///< REG09
+    uint8_t systemStatus;   ///< REG08
+};
+
+/** @brief What a platform lacks; each Traits specialization hides what it has. */
+struct TraitsBase {
+    /** @brief battery_state and power_source system events are sent */
+    static constexpr bool POWER_EVENTS = false;
+    /** @brief Charging can be switched off for temperature */
+    static constexpr bool CHARGE_CONTROL = false;
+    /** @brief PMIC faults are read and remediated by checkCharger() */
+    static constexpr bool CHARGER_FAULTS = false;
+    /** @brief socTenths is estimated from BatteryReading::millivolts */
+    static constexpr bool SOC_FROM_VOLTAGE = false;
+    /** @brief A TMP36 is wired to TMP36_SENSE_PIN */
+    static constexpr bool TMP36 = true;
+
+    /** @brief Read the battery; false where the platform cannot */
+    static bool readBattery(BatteryReading &reading) { return false; }
+
+    /**
+     * @brief Check the PMIC for charge faults, raise alerts 20-23 and
+     *        remediate with escalation (CHARGER_FAULTS only)
+     *
+     * @param socTenths this refresh's socTenths, for stuck-charging detection
+     * @param safeToCharge SensorManager::isItSafeToCharge(); no remediation when false
+     */
+    static void checkCharger(uint16_t socTenths, bool safeToCharge, ChargerStatus &status) {}
+
+    /** @brief Enable or disable charging (CHARGE_CONTROL only) */
+    static void setCharging(bool enable) {}
+
+    /**
+     * @brief Radio technology, strength and quality for the log, and the
+     *        strength in percent; false without a radio
+     */
+    static bool signalText(char *buf, size_t size, float &strength) { return false; }
+};
+
+template <Kind K> struct Traits;
+
+template <> struct Traits<Kind::OTHER> : TraitsBase {
+    static bool signalText(char *buf, size_t size, float &strength);
+};
+
+template <> struct Traits<Kind::BORON> : TraitsBase {
+    static constexpr bool POWER_EVENTS = true;
+    static constexpr bool CHARGE_CONTROL = true;
+    static constexpr bool CHARGER_FAULTS = true;
+    static bool readBattery(BatteryReading &reading);
+    static void checkCharger(uint16_t socTenths, bool safeToCharge, ChargerStatus &status);
+    static void setCharging(bool enable);
+    static bool signalText(char *buf, size_t size, float &strength);
+};
+
+template <> struct Traits<Kind::MSOM> : TraitsBase {
+    static constexpr bool POWER_EVENTS = true;
+    static constexpr bool CHARGE_CONTROL = true;
+    static bool readBattery(BatteryReading &reading);
+    static void setCharging(bool enable);
+    static bool signalText(char *buf, size_t size, float &strength);
+};
+
+template <> struct Traits<Kind::ARGON> : TraitsBase {
+    static constexpr bool POWER_EVENTS = true;
+    static bool readBattery(BatteryReading &reading);
+    static bool signalText(char *buf, size_t size, float &strength);
+};
+
+template <> struct Traits<Kind::P2> : TraitsBase {
+    static constexpr bool SOC_FROM_VOLTAGE = true;
+#if defined(MUON_HAS_TMP36)
+    static constexpr bool TMP36 = true;
+#else
+    static constexpr bool TMP36 = false;   // Nothing on an ADC pin on the Photon 2 dev carrier
+#endif
+    static bool readBattery(BatteryReading &reading);
+    static bool signalText(char *buf, size_t size, float &strength);
+};
+
+/** @brief The traits of the platform being built */
+using This = Traits<THIS_KIND>;
+
+} // namespace Platform
+
+#endif /* __PLATFORMTRAITS_H */
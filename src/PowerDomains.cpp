@@ -0,0 +1,105 @@
+#include "PowerDomains.h"
+#include "device_pinout.h"
+#include <mutex>
+#include <string.h>
+
+namespace PowerDomains {
+
+struct DomainState {
+    pin_t pin;
+    bool activeHigh;
+    const void *owners[MAX_OWNERS];     // nullptr = free
+    uint8_t held;                       // Non-null entries in owners
+};
+
+static DomainState domains[NUM_DOMAINS];
+static RecursiveMutex lock;
+static bool pinsSet = false;            // Holds taken before setup() are driven by it
+
+static void drive(const DomainState &dom) {
+    if (!pinsSet) {
+        return;
+    }
+    bool on = dom.held > 0;
+    digitalWrite(dom.pin, (on == dom.activeHigh) ? HIGH : LOW);
+}
+
+void setup(bool sensorLedActiveHigh) {
+    std::lock_guard<RecursiveMutex> guard(lock);
+    domains[SENSOR].pin = disableModule;
+    domains[SENSOR].activeHigh = false;
+    domains[SENSOR_LED].pin = ledPower;
+    domains[SENSOR_LED].activeHigh = sensorLedActiveHigh;
+    domains[STATUS_LED].pin = BLUE_LED;
+    domains[STATUS_LED].activeHigh = true;
+    domains[RANGE].pin = rangePower;
+    domains[RANGE].activeHigh = true;
+    pinsSet = true;
+    for (size_t ii = 0; ii < NUM_DOMAINS; ii++) {
+        pinMode(domains[ii].pin, OUTPUT);
+        drive(domains[ii]);
+    }
+}
+
+bool acquire(Domain domain, const void *owner) {
+    if (domain >= NUM_DOMAINS || !owner) {
+        return false;
+    }
+    std::lock_guard<RecursiveMutex> guard(lock);
+    DomainState &dom = domains[domain];
+    const void **freeSlot = nullptr;
+    for (size_t ii = 0; ii < MAX_OWNERS; ii++) {
+        if (dom.owners[ii] == owner) {
+            return true;
+        }
+        if (!dom.owners[ii] && !freeSlot) {
+            freeSlot = &dom.owners[ii];
+        }
+    }
+    if (!freeSlot) {
+        Log.error("PowerDomains: domain %u has %u owners already", (unsigned)domain, (unsigned)MAX_OWNERS);
+        return false;
+    }
+    *freeSlot = owner;
+    if (dom.held++ == 0) {
+        drive(dom);
+    }
+    return true;
+}
+
+void release(Domain domain, const void *owner) {
+    if (domain >= NUM_DOMAINS || !owner) {
+        return;
+    }
+    std::lock_guard<RecursiveMutex> guard(lock);
+    DomainState &dom = domains[domain];
+    for (size_t ii = 0; ii < MAX_OWNERS; ii++) {
+        if (dom.owners[ii] == owner) {
+            dom.owners[ii] = nullptr;
+            if (--dom.held == 0) {
+                drive(dom);
+            }
+            return;
+        }
+    }
+}
+
+void releaseAll(Domain domain) {
+    if (domain >= NUM_DOMAINS) {
+        return;
+    }
+    std::lock_guard<RecursiveMutex> guard(lock);
+    DomainState &dom = domains[domain];
+    bool wasOn = dom.held > 0;
+    memset(dom.owners, 0, sizeof(dom.owners));
+    dom.held = 0;
+    if (wasOn) {
+        drive(dom);
+    }
+}
+
+bool isOn(Domain domain) {
+    return domain < NUM_DOMAINS && domains[domain].held > 0;
+}
+
+} // namespace PowerDomains
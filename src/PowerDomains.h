@@ -0,0 +1,82 @@
+/**
+ * @file PowerDomains.h
+ * @brief One owner for the switched peripheral supplies and indicator LEDs.
+ *
+ * @details The sensor enable line (disableModule, active LOW), the sensor
+ *          board LED (ledPower, polarity per board), the on-module
+ *          BLUE_LED and the fusion range finder supply (rangePower, active
+ *          HIGH) are each a domain. Anything that needs one acquires it
+ *          with an owner tag and releases it with the same tag; the domain
+ *          is on while any owner holds it. Acquiring twice with one tag
+ *          counts once, so a driver that is set up again, or a release
+ *          from a path that never acquired, cannot leave a supply on or cut
+ *          it under another module.
+ *
+ *          setup() drives every domain off; nothing is on until it is
+ *          acquired. The indicator LEDs are only acquired with
+ *          INDICATOR_LEDS (count blinks also with INDICATOR_BLINK_ON_COUNT),
+ *          so a production build keeps them dark. EnergyLedger books the
+ *          time each domain is on.
+ *
+ *          The TMP112 is already in one-shot shutdown mode between reads,
+ *          and the PMIC and fuel gauge have no switched supply, so they
+ *          are not domains.
+ *
+ *          Safe from any thread, including the countSignalTimer callback.
+ */
+
+#ifndef __POWERDOMAINS_H
+#define __POWERDOMAINS_H
+
+#include "Particle.h"
+
+namespace PowerDomains {
+
+enum Domain : uint8_t {
+    SENSOR,                     ///< Sensor module supply (disableModule)
+    SENSOR_LED,                 ///< Sensor board indicator LED (ledPower)
+    STATUS_LED,                 ///< On-module BLUE_LED
+    RANGE,                      ///< Range finder confirming PIR events (rangePower)
+    NUM_DOMAINS
+};
+
+/** @brief Owners that can hold one domain at the same time. */
+static constexpr size_t MAX_OWNERS = 4;
+
+/**
+ * @brief Assign the pins and drive every domain that is not held off; call
+ *        from setup() before any sensor is set up
+ *
+ * @param sensorLedActiveHigh true if the configured sensor board turns its
+ *        LED on with ledPower HIGH (SensorDefinition::ledDefaultOn)
+ */
+void setup(bool sensorLedActiveHigh);
+
+/**
+ * @brief Hold @p domain on for @p owner
+ *
+ * @return false if the domain already has MAX_OWNERS other owners
+ */
+bool acquire(Domain domain, const void *owner);
+
+/**
+ * @brief Drop @p owner's hold; the domain turns off with the last one
+ */
+void release(Domain domain, const void *owner);
+
+/**
+ * @brief Drop every hold on @p domain
+ *
+ * @details For the status LED before sleep, which no indication outlasts.
+ *          Not for supplies: their owners release them.
+ */
+void releaseAll(Domain domain);
+
+/**
+ * @brief Whether @p domain is on
+ */
+bool isOn(Domain domain);
+
+} // namespace PowerDomains
+
+#endif /* __POWERDOMAINS_H */
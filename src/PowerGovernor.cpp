@@ -0,0 +1,228 @@
+#include "PowerGovernor.h"
+#include "Config.h"
+#include "Cloud.h"
+#include "ConnectHistory.h"
+#include "MyPersistentData.h"
+#include "Payload.h"
+#include "PublishQueuePosixRK.h"
+
+namespace PowerGovernor {
+
+// In tenths of a percent, like current socTenths
+static const uint16_t SOC_THRESHOLDS[] = {0, POWER_GOV_SOC_TIER1 * 10, POWER_GOV_SOC_TIER2 * 10, POWER_GOV_SOC_TIER3 * 10};
+static const uint16_t HYSTERESIS_TENTHS = POWER_GOV_HYSTERESIS * 10;
+
+static uint8_t maxTier() {
+#if POWER_GOVERNOR_ENABLED
+    uint8_t max = sysStatus.get_powerGovernorMaxTier();
+    return max > TIER_STORE_ONLY ? TIER_STORE_ONLY : max;
+#else
+    return TIER_NORMAL;
+#endif
+}
+
+// The fuel gauge is only meaningful with a battery attached
+static bool batteryKnown() {
+    uint8_t battState = current.get_batteryState();
+    return current.get_socTenths() > 0 &&
+           battState != BATTERY_STATE_UNKNOWN && battState != BATTERY_STATE_DISCONNECTED;
+}
+
+static void setTier(uint8_t newTier, const char *reason) {
+    uint8_t oldTier = sysStatus.get_powerTier();
+    if (newTier == oldTier) {
+        return;
+    }
+    sysStatus.set_powerTier(newTier);
+    sysStatus.set_lowBatteryMode(newTier == TIER_STORE_ONLY);
+    Log.info("PowerGovernor: tier %u -> %u (%s, SoC=%s%%, slope=%s%%/day)", oldTier, newTier, reason,
+             Payload::Scaled(current.get_socTenths(), 1).c_str(),
+             Payload::Scaled(sysStatus.get_socSlopeTenths(), 1).c_str());
+    Cloud::instance().markLedgerDirty(Cloud::LEDGER_STATUS);
+}
+
+// Tier for the current SoC alone, plus one while SoC is falling with no charging
+static uint8_t targetTier() {
+    uint16_t socTenths = current.get_socTenths();
+    uint8_t target = TIER_NORMAL;
+    for (uint8_t ii = TIER_HOURLY; ii <= TIER_STORE_ONLY; ii++) {
+        if (socTenths < SOC_THRESHOLDS[ii]) {
+            target = ii;
+        }
+    }
+    if (target < TIER_STORE_ONLY && sysStatus.get_socSlopeTenths() < 0 && !sysStatus.get_chargedToday()) {
+        target++;
+    }
+    uint8_t max = maxTier();
+    return target > max ? max : target;
+}
+
+void update() {
+    if (!batteryKnown()) {
+        return;
+    }
+    uint8_t battState = current.get_batteryState();
+    if (battState == BATTERY_STATE_CHARGING || battState == BATTERY_STATE_CHARGED) {
+        if (!sysStatus.get_chargedToday()) {
+            sysStatus.set_chargedToday(true);
+        }
+    }
+
+    uint8_t target = targetTier();
+    if (sysStatus.get_powerTier() > maxTier()) {
+        setTier(maxTier(), "ledger limit");
+    } else if (target > sysStatus.get_powerTier()) {
+        setTier(target, "battery low");
+    } else if (sysStatus.get_powerTier() == TIER_STORE_ONLY &&
+               (battState == BATTERY_STATE_CHARGING || battState == BATTERY_STATE_CHARGED) &&
+               current.get_socTenths() >= SOC_THRESHOLDS[TIER_STORE_ONLY] + HYSTERESIS_TENTHS) {
+        // Out of store-only on the day the battery recovers, not the next dailyUpdate()
+        setTier(TIER_SLOW, "charging");
+    }
+}
+
+void dailyUpdate() {
+    if (batteryKnown()) {
+        uint16_t socTenths = current.get_socTenths();
+        float dayStart = sysStatus.get_socAtDayStart();   // Percent, a float in sysStatus
+        if (dayStart >= 0.0f) {
+            int deltaTenths = (int)socTenths - (int)(dayStart * 10.0f + 0.5f);
+            int slope = sysStatus.get_socSlopeTenths();
+            // Average with the previous days so one cloudy day does not swing the tier
+            slope = (slope + deltaTenths) / 2;
+            sysStatus.set_socSlopeTenths((int16_t)constrain(slope, -1000, 1000));
+        }
+        sysStatus.set_socAtDayStart(socTenths / 10.0f);
+
+        // Step down one tier per day, with hysteresis, once the trend has stopped falling
+        uint8_t tierNow = sysStatus.get_powerTier();
+        bool recovering = sysStatus.get_socSlopeTenths() >= 0 || sysStatus.get_chargedToday();
+        if (tierNow > TIER_NORMAL && recovering && socTenths >= SOC_THRESHOLDS[tierNow] + HYSTERESIS_TENTHS) {
+            setTier(tierNow - 1, "battery recovered");
+        }
+    }
+    else if (sysStatus.get_powerTier() != TIER_NORMAL) {
+        setTier(TIER_NORMAL, "no battery");
+    }
+    sysStatus.set_chargedToday(false);
+}
+
+uint8_t tier() {
+    uint8_t active = sysStatus.get_powerTier();
+    uint8_t max = maxTier();
+    return active > max ? max : active;
+}
+
+uint8_t operatingMode() {
+    uint8_t mode = sysStatus.get_operatingMode();
+    if (tier() > TIER_NORMAL && mode == CONNECTED) {
+        return LOW_POWER;
+    }
+    return mode;
+}
+
+uint16_t reportingIntervalSec() {
+#if SOAK_TEST_ENABLED
+    return SOAK_REPORT_INTERVAL_SEC;     // Accelerated bench cycles
+#endif
+    uint16_t interval = sysStatus.get_reportingInterval();
+    uint16_t minimum = 0;
+    switch (tier()) {
+        case TIER_HOURLY:
+            minimum = 3600;
+            break;
+        case TIER_SLOW:
+        case TIER_STORE_ONLY:
+            minimum = POWER_GOV_TIER2_INTERVAL_SEC;
+            break;
+        default:
+            break;
+    }
+    return interval < minimum ? minimum : interval;
+}
+
+bool storeOnly() {
+    return tier() == TIER_STORE_ONLY;
+}
+
+bool reportShouldConnect() {
+    if (tier() < TIER_STORE_ONLY) {
+        return true;
+    }
+    time_t lastConnection = sysStatus.get_lastConnection();
+    return !Time.isValid() || lastConnection == 0 ||
+           (Time.now() - lastConnection) >= (time_t)POWER_GOV_CHECKIN_HOURS * 3600;
+}
+
+bool surplusPower() {
+    if (!batteryKnown()) {
+        return false;
+    }
+    uint8_t battState = current.get_batteryState();
+    return (battState == BATTERY_STATE_CHARGING || battState == BATTERY_STATE_CHARGED) &&
+           current.get_socTenths() >= SURPLUS_DRAIN_SOC * 10;
+}
+
+// Seconds until the next surplus drain, with a drain wanted at all
+static bool surplusDrainWanted(uint32_t &waitSec) {
+#if SURPLUS_DRAIN_ENABLED
+    if (operatingMode() != LOW_POWER || !Time.isValid() || !surplusPower() ||
+        ConnectHistory::backoffRemainingSec() > 0 || coldDeferral() ||
+        PublishQueuePosix::instance().getNumEvents() < SURPLUS_DRAIN_MIN_EVENTS) {
+        return false;
+    }
+    time_t lastConnection = sysStatus.get_lastConnection();
+    time_t now = Time.now();
+    if (lastConnection == 0 || now < lastConnection || (now - lastConnection) >= SURPLUS_DRAIN_GAP_SEC) {
+        waitSec = 0;
+    } else {
+        waitSec = (uint32_t)(SURPLUS_DRAIN_GAP_SEC - (now - lastConnection));
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint32_t surplusDrainWaitSec() {
+    uint32_t waitSec = 0;
+    if (!surplusDrainWanted(waitSec)) {
+        return 0;
+    }
+    return waitSec > 0 ? waitSec : 1;
+}
+
+bool surplusDrainDue() {
+    uint32_t waitSec = 0;
+    return !Particle.connected() && !ConnectHistory::flapDamped() && surplusDrainWanted(waitSec) && waitSec == 0;
+}
+
+bool coldDeferral() {
+#if COLD_DEFER_ENABLED
+    if (operatingMode() != LOW_POWER || !batteryKnown() ||
+        current.get_internalTempCenti() >= COLD_DEFER_BELOW_C * 100) {
+        return false;
+    }
+    time_t since = sysStatus.get_coldDeferSince();
+    if (since != 0 && Time.isValid() && (Time.now() - since) >= (time_t)COLD_DEFER_MAX_HOURS * 3600) {
+        Log.info("Cold deferral: deferring since %s - connecting regardless",
+                 Time.format(since, TIME_FORMAT_DEFAULT).c_str());
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void noteColdDeferral() {
+    if (sysStatus.get_coldDeferSince() == 0 && Time.isValid()) {
+        sysStatus.set_coldDeferSince(Time.now());
+    }
+    uint16_t count = sysStatus.get_coldDeferrals();
+    if (count < 0xffff) {
+        sysStatus.set_coldDeferrals(count + 1);
+    }
+}
+
+} // namespace PowerGovernor
@@ -0,0 +1,110 @@
+/**
+ * @file PowerGovernor.h
+ * @brief Steps reporting back as the battery runs down, and forward again
+ *        as it recovers.
+ *
+ * @details The ledger sets operatingMode and reportingIntervalSec; the
+ *          governor only ever makes them more conservative, and never past
+ *          the ledger's power.maxGovernorTier. State handlers read the
+ *          effective values from operatingMode() and reportingIntervalSec()
+ *          instead of sysStatus, so the configured values (and the
+ *          device-status ledger) are left alone.
+ *
+ *          update() runs at every report with fresh battery data and can
+ *          raise the tier at once. dailyUpdate() runs from dailyCleanup(),
+ *          updates the SoC trend and is the only place the tier is lowered,
+ *          one step per day, except that store-only is left as soon as a
+ *          charging battery is POWER_GOV_HYSTERESIS points above its
+ *          threshold. See POWER_GOVERNOR_ENABLED in Config.h.
+ *
+ *          Store-only (sysStatus lowBatteryMode) is the winter tier: counts
+ *          keep going into flash and the queue, and the daily check-in is
+ *          a heartbeat that only sends the queue. storeOnly() tells the
+ *          ledger sync and OtaScheduler to stand aside.
+ *
+ *          The other way round, a queued backlog is sent early while there
+ *          is power to spare: surplusDrainDue() asks for an extra connect
+ *          while charging at a high SoC (SURPLUS_DRAIN_ENABLED).
+ */
+
+#ifndef __POWERGOVERNOR_H
+#define __POWERGOVERNOR_H
+
+#include "Particle.h"
+
+namespace PowerGovernor {
+
+/** @brief Tiers, from configured behavior to store-only */
+enum Tier : uint8_t {
+    TIER_NORMAL = 0,        ///< Configured operatingMode and reportingIntervalSec
+    TIER_HOURLY = 1,        ///< LOW_POWER, at least hourly
+    TIER_SLOW = 2,          ///< LOW_POWER, at least POWER_GOV_TIER2_INTERVAL_SEC
+    TIER_STORE_ONLY = 3     ///< Queue reports; connect every POWER_GOV_CHECKIN_HOURS
+};
+
+/**
+ * @brief Re-evaluate after measure.batteryState(); may raise the tier
+ */
+void update();
+
+/**
+ * @brief Once a day from dailyCleanup(): update the SoC trend; may lower the tier by one
+ */
+void dailyUpdate();
+
+/** @brief Current tier (TIER_NORMAL when the governor is off). */
+uint8_t tier();
+
+/** @brief Effective operating mode: the configured one, at least LOW_POWER above TIER_NORMAL. */
+uint8_t operatingMode();
+
+/** @brief Effective reporting interval: the configured one, lengthened by the tier. */
+uint16_t reportingIntervalSec();
+
+/** @brief true in TIER_STORE_ONLY: no ledger syncs and no OTA on a connect. */
+bool storeOnly();
+
+/**
+ * @brief true if a scheduled report should connect; false in TIER_STORE_ONLY
+ *        until POWER_GOV_CHECKIN_HOURS have passed since the last connection
+ */
+bool reportShouldConnect();
+
+/**
+ * @brief true while charging (or charged) at or above SURPLUS_DRAIN_SOC
+ */
+bool surplusPower();
+
+/**
+ * @brief Seconds until an extra connect would be due to send the queued
+ *        backlog on surplus power, or 0 if none is wanted now
+ *
+ * @details Only for LOW_POWER with at least SURPLUS_DRAIN_MIN_EVENTS queued,
+ *          surplus power and no connect backoff; the connect is due
+ *          SURPLUS_DRAIN_GAP_SEC after the last one. SLEEPING_STATE caps
+ *          the nap at this.
+ */
+uint32_t surplusDrainWaitSec();
+
+/**
+ * @brief true if IDLE should connect now to send the backlog on surplus power
+ */
+bool surplusDrainDue();
+
+/**
+ * @brief true if a non-critical connect should wait for the enclosure to warm up
+ *
+ * @details Below COLD_DEFER_BELOW_C in LOW_POWER, until COLD_DEFER_MAX_HOURS
+ *          after the first deferral. Reads the temperature of the last
+ *          measure.batteryState().
+ */
+bool coldDeferral();
+
+/**
+ * @brief Record that a report connect was deferred for cold
+ */
+void noteColdDeferral();
+
+} // namespace PowerGovernor
+
+#endif /* __POWERGOVERNOR_H */
@@ -0,0 +1,73 @@
+#include "PowerPolicy.h"
+#include "Config.h"
+#include "ConfigSnapshot.h"
+#include "MyPersistentData.h"
+
+namespace PowerPolicy {
+
+// Append new variants; a row's meaning must not change while devices report it
+static const Bundle VARIANTS[NUM_VARIANTS] = {
+    // name        jitter                  stay-awake window      hysteresis                 fast teardown               prewarm
+    {"control",  WAKE_JITTER_WINDOW_SEC, STAY_AWAKE_WINDOW_SEC, STAY_AWAKE_HYSTERESIS_PCT, SLEEP_FAST_TEARDOWN != 0, REPORT_RADIO_PREWARM != 0},
+    {"napFirst", WAKE_JITTER_WINDOW_SEC, 120,                   40,                        SLEEP_FAST_TEARDOWN != 0, REPORT_RADIO_PREWARM != 0},
+    {"graceful", WAKE_JITTER_WINDOW_SEC, STAY_AWAKE_WINDOW_SEC, STAY_AWAKE_HYSTERESIS_PCT, false,                    false},
+    {"spread",   900,                    600,                   STAY_AWAKE_HYSTERESIS_PCT, SLEEP_FAST_TEARDOWN != 0, REPORT_RADIO_PREWARM != 0},
+};
+
+uint8_t variant() {
+    uint8_t value = ConfigSnapshot::read().policyVariant;
+    return value < NUM_VARIANTS ? value : 0;
+}
+
+const Bundle &active() {
+    return VARIANTS[variant()];
+}
+
+void select(uint8_t value) {
+    if (value >= NUM_VARIANTS || value == sysStatus.get_policyVariant()) {
+        return;
+    }
+    Log.info("PowerPolicy: variant %u (%s) -> %u (%s)", (unsigned)variant(), active().name,
+             (unsigned)value, VARIANTS[value].name);
+    sysStatus.set_policyVariant(value);
+    if (current.get_policyVariantDay() != value) {
+        current.set_policyVariantDay(currentStatusData::POLICY_VARIANT_MIXED);
+    }
+}
+
+void noteConnect(uint32_t seconds) {
+    auto update = current.updateBatch();
+    current.addPolicyTally(currentStatusData::POLICY_CONNECTS, 1);
+    current.addPolicyTally(currentStatusData::POLICY_CONNECT_SEC, seconds);
+}
+
+void noteConnectFailure() {
+    current.addPolicyTally(currentStatusData::POLICY_CONNECT_FAILS, 1);
+}
+
+void noteReportQueued() {
+    current.addPolicyTally(currentStatusData::POLICY_REPORTS_QUEUED, 1);
+}
+
+void noteReportConfirmed() {
+    current.addPolicyTally(currentStatusData::POLICY_REPORTS_CONFIRMED, 1);
+}
+
+void writeDay(JSONWriter &writer) {
+    uint8_t day = current.get_policyVariantDay();
+    bool mixed = day >= NUM_VARIANTS;
+    uint32_t connects = current.get_policyTally(currentStatusData::POLICY_CONNECTS);
+    uint32_t connectSec = current.get_policyTally(currentStatusData::POLICY_CONNECT_SEC);
+
+    writer.name("policy").beginObject();
+    writer.name("variant").value(mixed ? -1 : (int)day);
+    writer.name("name").value(mixed ? "mixed" : VARIANTS[day].name);
+    writer.name("connects").value((unsigned long)connects);
+    writer.name("connectAvgSec").value(connects ? (float)connectSec / (float)connects : 0.0f, 1);
+    writer.name("connectFails").value((unsigned long)current.get_policyTally(currentStatusData::POLICY_CONNECT_FAILS));
+    writer.name("reports").value((unsigned long)current.get_policyTally(currentStatusData::POLICY_REPORTS_QUEUED));
+    writer.name("confirmed").value((unsigned long)current.get_policyTally(currentStatusData::POLICY_REPORTS_CONFIRMED));
+    writer.endObject();
+}
+
+} // namespace PowerPolicy
@@ -0,0 +1,95 @@
+/**
+ * @file PowerPolicy.h
+ * @brief Power-policy variants for fleet A/B experiments.
+ *
+ * @details A variant is a bundle of the sleep, connect and teardown choices
+ *          that were build-time constants: the wake jitter window, the
+ *          stay-awake rate window and hysteresis, fast teardown and radio
+ *          prewarm. Variant 0 is the control and uses the Config.h values;
+ *          the others are rows of the table in PowerPolicy.cpp. The ledger
+ *          key power.policyVariant (device-settings or default-settings)
+ *          selects one, so a fleet can be split across variants without a
+ *          firmware build per arm.
+ *
+ *          The Config.h flags stay the build-wide switch: with
+ *          SLEEP_FAST_TEARDOWN or REPORT_RADIO_PREWARM at 0 no variant can
+ *          turn that feature on.
+ *
+ *          Each day's outcome is tallied in current (connects, their time,
+ *          failures, reports queued and confirmed) and writeDay() adds it,
+ *          with the variant, to the daily energy event, so energy, connect
+ *          time and data completeness can be compared per variant across
+ *          sites. A day on which the variant changed is reported as mixed
+ *          and belongs to neither arm.
+ *
+ *          active() reads the variant from ConfigSnapshot, so it takes no
+ *          lock. Tallies are application thread only.
+ */
+
+#ifndef __POWERPOLICY_H
+#define __POWERPOLICY_H
+
+#include "Particle.h"
+
+namespace PowerPolicy {
+
+/** @brief One variant's settings. */
+struct Bundle {
+    const char *name;
+    uint16_t wakeJitterWindowSec;       ///< As WAKE_JITTER_WINDOW_SEC
+    uint16_t stayAwakeWindowSec;        ///< As STAY_AWAKE_WINDOW_SEC
+    uint8_t stayAwakeHysteresisPct;     ///< As STAY_AWAKE_HYSTERESIS_PCT
+    bool fastTeardown;                  ///< As SLEEP_FAST_TEARDOWN
+    bool radioPrewarm;                  ///< As REPORT_RADIO_PREWARM
+};
+
+/** @brief Rows in the variant table; the ledger range of power.policyVariant. */
+constexpr uint8_t NUM_VARIANTS = 4;
+
+/**
+ * @brief The bundle in effect (the control if the stored variant is out of range)
+ */
+const Bundle &active();
+
+/**
+ * @brief The variant in effect
+ */
+uint8_t variant();
+
+/**
+ * @brief Switch to @p variant; a change marks today's tallies as mixed
+ */
+void select(uint8_t variant);
+
+/**
+ * @brief Tally a successful connect that took @p seconds
+ */
+void noteConnect(uint32_t seconds);
+
+/**
+ * @brief Tally a connect attempt that ran out of budget
+ */
+void noteConnectFailure();
+
+/**
+ * @brief Tally an hourly report queued
+ */
+void noteReportQueued();
+
+/**
+ * @brief Tally a report a webhook response confirmed
+ */
+void noteReportConfirmed();
+
+/**
+ * @brief Write today's variant and tallies to an open JSON object as "policy"
+ *
+ * @details {"variant":n,"name":"...","connects":n,"connectAvgSec":n,
+ *          "connectFails":n,"reports":n,"confirmed":n}; variant is -1 and
+ *          name "mixed" when the variant changed during the day.
+ */
+void writeDay(JSONWriter &writer);
+
+} // namespace PowerPolicy
+
+#endif /* __POWERPOLICY_H */
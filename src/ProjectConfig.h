@@ -11,4 +11,90 @@ static inline const char *webhookEventName() {
     return "Ubidots-Counter-Hook-v1";
 }
 
+// Webhook event name for a backlog of hourly reports merged into one
+// publish: {"r":[<report>,<report>,...]}, each element the same JSON
+// object sent to webhookEventName().
+static inline const char *webhookBatchEventName() {
+    return "Ubidots-Counter-Batch-v1";
+}
+
+// Event name for the hourly report in CompactReport encoding
+// (PUBLISH_COMPACT_REPORT). The data is base64 of a versioned binary
+// record; a cloud-side decoder expands it to the webhookEventName() JSON.
+static inline const char *webhookCompactEventName() {
+    return "Counter-Compact-v1";
+}
+
+// Webhook event name for a day of old hourly reports folded into one
+// summary when a long outage fills the queue (PUBLISH_BACKLOG_COMPACTION,
+// see ReportCompactor.h).
+static inline const char *webhookDailyEventName() {
+    return "Ubidots-Counter-Daily-v1";
+}
+
+// Event name for a LoRa gateway's per-node report (SensorType::LORA_GATEWAY):
+// base64 of a versioned record with one row per node heard, see
+// LoRaGatewaySensor.h.
+static inline const char *loraNodesEventName() {
+    return "LoRa-Nodes-v1";
+}
+
+// Event name for a rain gauge's interval summary (SensorType::RAIN_BUCKET):
+// depth, peak rate and minutes per intensity class, see RainBucketSensor.h.
+static inline const char *rainEventName() {
+    return "Rain-v1";
+}
+
+// Event name for near-real-time count updates in CONNECTED mode
+// (sysStatus liveCountSec, see LiveCount.h):
+// {"delta":n,"hourly":h,"daily":d,"timestamp":ms}.
+static inline const char *liveCountEventName() {
+    return "Counter-Live-v1";
+}
+
+// Event name for occupied/unoccupied changes in OCCUPANCY mode
+// (sysStatus occupancyNotifySec, see OccupancyNotify.h):
+// {"o":<0|1>,"s":<epoch seconds of the change>}.
+static inline const char *occupancyEventName() {
+    return "Occupancy-v1";
+}
+
+// Publish queue priority lanes (PUBLISH_PRIORITY_LANES). Lower numbers
+// are sent first after a connection; each lane has its own capacity, so a
+// backlog of one kind of event cannot push out another. With lanes
+// disabled every publishToLane() goes to the single default queue.
+enum PublishLane : uint8_t {
+    LANE_ALERT = 0,       // Hourly report that first carries a new alert code; occupancy changes
+    LANE_REPORT = 1,      // Hourly webhook reports and history backfill (default lane)
+    LANE_STATUS = 2,      // Startup status and boot profile
+    LANE_DIAGNOSTIC = 3,  // Verbose-mode chatter ("Ubidots Hook", "Daily Cleanup", ...)
+    LANE_SUMMARY = 4      // Daily summaries folded from an old report backlog
+};
+
+// Strings the publish queue packs to one byte each in event data waiting
+// on flash (PUBLISH_PACKED_PAYLOADS). Queued events refer to entries by
+// position: only ever append, never reorder, edit or remove. At most 127.
+static const char *const payloadDictionary[] = {
+    "{\"hourly\":",        // Hourly report (webhookEventName())
+    ",\"daily\":",
+    ",\"battery\":",
+    ",\"key1\":\"",
+    ",\"temp\":",
+    ",\"resets\":",
+    ",\"alerts\":",
+    ",\"connecttime\":",
+    ",\"bins\":\"",
+    ",\"timestamp\":",
+    "{\"hours\":",         // Daily summary (webhookDailyEventName())
+    ",\"hourly\":",
+    ",\"first\":",
+    "Not Charging",         // key1 battery states
+    "Discharging",
+    "Charging",
+    "Charged",
+    "000}",                 // ms timestamps end in 000
+};
+
+static const size_t payloadDictionaryCount = sizeof(payloadDictionary) / sizeof(payloadDictionary[0]);
+
 } // namespace ProjectConfig
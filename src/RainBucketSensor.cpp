@@ -0,0 +1,227 @@
+// src/RainBucketSensor.cpp
+#include "RainBucketSensor.h"
+#include "Payload.h"
+#include "ProjectConfig.h"
+#include "PublishQueuePosixRK.h"
+
+static_assert(RAIN_MODERATE_MMH10 < RAIN_HEAVY_MMH10 && RAIN_HEAVY_MMH10 < RAIN_VIOLENT_MMH10,
+              "Rain intensity classes must be in increasing order");
+
+EventRing<uint32_t, 16> RainBucketSensor::_tipRing;
+volatile uint32_t RainBucketSensor::_isrCount = 0;
+volatile uint32_t RainBucketSensor::_lastTipMs = 0;
+
+// Reed switch closure; bounces inside RAIN_DEBOUNCE_MS are the same tip
+void RainBucketSensor::tipISR() {
+    uint32_t nowMs = millis();
+    if (_isrCount > 0 && nowMs - _lastTipMs < RAIN_DEBOUNCE_MS) {
+        return;
+    }
+    _lastTipMs = nowMs;
+    _isrCount++;
+    _tipRing.push(nowMs);
+}
+
+bool RainBucketSensor::setup() {
+    pinMode(intPin, INPUT_PULLDOWN);
+    attachInterrupt(intPin, tipISR, RISING);
+    if (_intervalStart == 0) {
+        reset();
+    }
+    _isReady = true;
+    Log.info("Rain bucket ready (%u um per tip)", (unsigned)RAIN_UM_PER_TIP);
+    return true;
+}
+
+bool RainBucketSensor::loop() {
+    if (!_isReady) {
+        return false;
+    }
+    uint32_t tipMs;
+    if (!_tipRing.pop(tipMs)) {
+        return false;
+    }
+    SensorEvent tip;
+    tip.tickMs = tipMs;
+    record(tip.unixTime(), 1);
+    return true;
+}
+
+size_t RainBucketSensor::drain(SensorEvent* out, size_t max) {
+    if (!_isReady || !out || max == 0) {
+        return 0;
+    }
+    size_t n = 0;
+    uint32_t tipMs;
+    while (n < max && _tipRing.pop(tipMs)) {
+        out[n] = SensorEvent();
+        out[n].type = SensorType::RAIN_BUCKET;
+        out[n].tickMs = tipMs;
+        record(out[n].unixTime(), 1);
+        n++;
+    }
+
+    static uint32_t reportedOverflows = 0;
+    uint32_t overflows = _tipRing.overflows();
+    if (overflows != reportedOverflows) {
+        Log.warn("Rain bucket: %lu tips lost to a full queue", (unsigned long)(overflows - reportedOverflows));
+        reportedOverflows = overflows;
+    }
+    return n;
+}
+
+void RainBucketSensor::record(time_t when, uint32_t tips) {
+    if (tips == 0) {
+        return;
+    }
+    if (_intervalStart == 0) {
+        _intervalStart = when;      // First tip since boot
+    }
+    uint32_t slot = when > _intervalStart ? (uint32_t)(when - _intervalStart) / RAIN_SLOT_SEC : 0;
+    if (slot >= RAIN_SLOTS) {
+        slot = RAIN_SLOTS - 1;      // A late report folds into the last slot
+    }
+    uint32_t slotTips = _slotTips[slot] + tips;
+    _slotTips[slot] = (uint16_t)(slotTips > 0xffff ? 0xffff : slotTips);
+    _intervalTips += tips;
+
+    uint32_t rate = rateMmh10(_slotTips[slot]);
+    _data.timestamp = when;
+    _data.hasNewData = true;
+    _data.primary = (uint16_t)(_intervalTips > 0xffff ? 0xffff : _intervalTips);
+    _data.secondary = (uint16_t)(rate > 0xffff ? 0xffff : rate);
+}
+
+uint32_t RainBucketSensor::rateMmh10(uint32_t tips) {
+    // um per slot -> mm/h x 10
+    return tips * RAIN_UM_PER_TIP * (3600 / RAIN_SLOT_SEC) / 100;
+}
+
+void RainBucketSensor::noteSleepEdges(uint32_t edges, time_t start, uint32_t seconds) {
+    if (edges == 0) {
+        return;
+    }
+    // Spread evenly: one share per slot-length chunk of the nap, at its middle
+    uint32_t chunks = seconds / RAIN_SLOT_SEC + 1;
+    for (uint32_t ii = 0; ii < chunks; ii++) {
+        uint32_t share = edges * (ii + 1) / chunks - edges * ii / chunks;
+        record(start + (time_t)((uint64_t)seconds * (2 * ii + 1) / (2 * chunks)), share);
+    }
+    _sleepTips += edges;
+    _data.aux1 = (uint16_t)(_sleepTips > 0xffff ? 0xffff : _sleepTips);
+}
+
+bool RainBucketSensor::publishReport(uint32_t timestamp) {
+    bool published = false;
+    if (_intervalTips > 0) {
+        uint32_t peakTips = 0;
+        uint32_t minutes[4] = {0, 0, 0, 0};     // Light, moderate, heavy, violent
+        for (size_t ii = 0; ii < RAIN_SLOTS; ii++) {
+            if (_slotTips[ii] == 0) {
+                continue;
+            }
+            if (_slotTips[ii] > peakTips) {
+                peakTips = _slotTips[ii];
+            }
+            uint32_t rate = rateMmh10(_slotTips[ii]);
+            size_t intensity = rate >= RAIN_VIOLENT_MMH10 ? 3 : rate >= RAIN_HEAVY_MMH10 ? 2 :
+                               rate >= RAIN_MODERATE_MMH10 ? 1 : 0;
+            minutes[intensity] += RAIN_SLOT_SEC / 60;
+        }
+
+        static const Payload::Field rainSchema[] = {
+            {"tips", Payload::UINT, 0},
+            {"mm", Payload::FIXED, 2},
+            {"peakMmh", Payload::FIXED, 1},
+            {"light", Payload::UINT, 0},
+            {"moderate", Payload::UINT, 0},
+            {"heavy", Payload::UINT, 0},
+            {"violent", Payload::UINT, 0},
+            {"timestamp", Payload::UINT64, 0},
+        };
+        Payload::Value values[sizeof(rainSchema) / sizeof(rainSchema[0])];
+        values[0].u = _intervalTips;
+        values[1].f = (float)_intervalTips * RAIN_UM_PER_TIP / 1000.0f;
+        values[2].f = (float)rateMmh10(peakTips) / 10.0f;
+        for (size_t ii = 0; ii < 4; ii++) {
+            values[3 + ii].u = minutes[ii];
+        }
+        values[7].u64 = (uint64_t)timestamp * 1000;
+
+        char data[160];
+        Payload::Writer(data, sizeof(data)).beginObject().writeFields(rainSchema, values, sizeof(values) / sizeof(values[0])).endObject();
+        PublishQueuePosix::instance().publishToLane(ProjectConfig::LANE_REPORT, ProjectConfig::rainEventName(),
+                                                    data, PRIVATE | WITH_ACK);
+        Log.info("Rain: %s (%lu tips counted asleep)", data, (unsigned long)_sleepTips);
+        published = true;
+    }
+
+    // Next interval
+    _intervalStart = (time_t)timestamp;
+    memset(_slotTips, 0, sizeof(_slotTips));
+    _intervalTips = 0;
+    _sleepTips = 0;
+    _data.primary = 0;
+    _data.secondary = 0;
+    _data.aux1 = 0;
+    return published;
+}
+
+void RainBucketSensor::reset() {
+    _tipRing.clear();
+    _intervalStart = Time.isValid() ? Time.now() : 0;
+    memset(_slotTips, 0, sizeof(_slotTips));
+    _intervalTips = 0;
+    _sleepTips = 0;
+    _data = SensorData();
+    _data.type = SensorType::RAIN_BUCKET;
+}
+
+void RainBucketSensor::onSleep() {
+    if (!_isReady) {
+        return;
+    }
+    detachInterrupt(intPin);
+    _isReady = false;
+}
+
+bool RainBucketSensor::onWake() {
+    if (_isReady) {
+        return true;
+    }
+    return setup();
+}
+
+void RainBucketSensor::armWakeCapture() {
+    _isrCountAtArm = _isrCount;
+}
+
+bool RainBucketSensor::injectWakeEvent() {
+    if (!_isReady || _isrCount != _isrCountAtArm) {
+        return false;   // The ISR saw the wake tip
+    }
+    _tipRing.push(millis());
+    return true;
+}
+
+bool RainBucketSensor::injectEdge() {
+    if (!_isReady) {
+        return false;
+    }
+    _tipRing.push(millis());
+    return true;
+}
+
+bool RainBucketSensor::releaseInterruptPin() {
+    if (!_isReady) {
+        return false;
+    }
+    detachInterrupt(intPin);
+    return true;
+}
+
+void RainBucketSensor::reclaimInterruptPin() {
+    if (_isReady) {
+        attachInterrupt(intPin, tipISR, RISING);
+    }
+}
@@ -0,0 +1,124 @@
+// src/RainBucketSensor.h
+#ifndef RAINBUCKETSENSOR_H
+#define RAINBUCKETSENSOR_H
+
+#include "ISensor.h"
+#include "Config.h"
+#include "EventRing.h"
+#include "Particle.h"
+#include "device_pinout.h"
+
+/**
+ * @brief Tipping-bucket rain gauge: a reed switch closes on intPin once
+ *        per tip of RAIN_UM_PER_TIP micrometres of rain.
+ *
+ * Each tip is one event, so in COUNTING mode the hourly and daily counts
+ * are tips. A storm tips the bucket every few seconds, and a wake per tip
+ * would cost more than the rest of the day. So every nap counts tips in
+ * hardware instead (countsEdgesInSleep(), EdgeCounter.h) and the device
+ * sleeps through the burst. The count is read on the next wake. Where
+ * EdgeCounter is not supported (P2), each tip wakes the device as a PIR
+ * edge would. The hardware counter sees every edge, so the reed switch
+ * needs an RC debounce on the line (about 1 ms); while awake the ISR also
+ * ignores edges within RAIN_DEBOUNCE_MS.
+ *
+ * Tips, awake or counted asleep, are kept in RAIN_SLOTS slots of
+ * RAIN_SLOT_SEC from the start of the report interval. Tips counted in a
+ * nap are spread evenly over the slots it covered. publishReport() turns
+ * the slots into depth, peak rate and minutes per intensity class, then
+ * starts a new interval. The slots are in RAM, so a gauge should have
+ * open hours covering the whole day (no HIBERNATE).
+ *
+ * Rain-v1 event (JSON, only for an interval with tips):
+ * - tips:      tips in the interval
+ * - mm:        depth, tips x RAIN_UM_PER_TIP
+ * - peakMmh:   highest RAIN_SLOT_SEC rate in mm/h
+ * - light, moderate, heavy, violent: minutes at each intensity, split at
+ *   RAIN_MODERATE_MMH10, RAIN_HEAVY_MMH10 and RAIN_VIOLENT_MMH10 (mm/h x 10)
+ * - timestamp: report time, ms
+ *
+ * Output (SensorData):
+ * - primary:   tips this interval
+ * - secondary: rate of the current slot, mm/h x 10
+ * - aux1:      tips counted in hardware during naps this interval
+ */
+class RainBucketSensor : public ISensor {
+public:
+    /**
+     * @brief Get singleton instance
+     */
+    static RainBucketSensor& instance() {
+        static RainBucketSensor _instance;
+        return _instance;
+    }
+
+    bool setup() override;
+    bool loop() override;
+    size_t drain(SensorEvent* out, size_t max) override;
+
+    const SensorData& getData() const override { return _data; }
+    const char* getSensorType() const override { return "RainBucket"; }
+    bool isReady() const override { return _isReady; }
+    void reset() override;
+
+    bool usesInterrupt() const override { return true; }
+    WakeSource wakeSource() const override { return WakeSource::gpio(intPin, RISING); }
+    void onSleep() override;
+    bool onWake() override;
+    void armWakeCapture() override;
+    bool injectWakeEvent() override;
+    bool injectEdge() override;
+
+    bool releaseInterruptPin() override;
+    void reclaimInterruptPin() override;
+    bool countsEdgesInSleep() const override { return true; }
+    void noteSleepEdges(uint32_t edges, time_t start, uint32_t seconds) override;
+
+    /**
+     * @brief Queue one Rain-v1 event for the interval and start a new one.
+     *
+     * @param timestamp Unix seconds of the report
+     * @return true if an event was queued (false with no tips)
+     */
+    bool publishReport(uint32_t timestamp);
+
+    /** @brief Number of rate slots per report interval. */
+    static constexpr size_t RAIN_SLOTS = 12;
+
+    /** @brief Length of one rate slot. */
+    static constexpr uint32_t RAIN_SLOT_SEC = 300;
+
+private:
+    RainBucketSensor() {}
+    ~RainBucketSensor() {}
+    RainBucketSensor(const RainBucketSensor&) = delete;
+    RainBucketSensor& operator=(const RainBucketSensor&) = delete;
+
+    /**
+     * @brief Add @p tips to the slot holding @p when.
+     */
+    void record(time_t when, uint32_t tips);
+
+    /**
+     * @brief Rate in mm/h x 10 for @p tips in one slot.
+     */
+    static uint32_t rateMmh10(uint32_t tips);
+
+    bool _isReady = false;
+    SensorData _data;
+
+    time_t _intervalStart = 0;
+    uint16_t _slotTips[RAIN_SLOTS] = {};
+    uint32_t _intervalTips = 0;
+    uint32_t _sleepTips = 0;
+
+    uint32_t _isrCountAtArm = 0;
+
+    static EventRing<uint32_t, 16> _tipRing;    // Tip millis(), ISR -> drain()
+    static volatile uint32_t _isrCount;
+    static volatile uint32_t _lastTipMs;
+
+    static void tipISR();
+};
+
+#endif /* RAINBUCKETSENSOR_H */
@@ -0,0 +1,130 @@
+#include "ReportCompactor.h"
+#include "LocalOffset.h"
+#include "LocalTimeRK.h"
+#include "Payload.h"
+#include "ProjectConfig.h"
+
+namespace {
+
+// The reports are flat objects written by publishData() (Payload::Writer),
+// so a key search is enough; no need for a JSON parser per queued event.
+const char *findValue(const char *json, const char *key) {
+    char pattern[24];
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+    const char *p = strstr(json, pattern);
+    if (!p) {
+        return nullptr;
+    }
+    p += strlen(pattern);
+    while (*p == ' ') {
+        p++;
+    }
+    return p;
+}
+
+double numberValue(const char *json, const char *key) {
+    const char *p = findValue(json, key);
+    return p ? strtod(p, nullptr) : 0;
+}
+
+uint64_t timestampValue(const char *json) {
+    const char *p = findValue(json, "timestamp");
+    return p ? strtoull(p, nullptr, 10) : 0;
+}
+
+} // namespace
+
+uint32_t ReportCompactor::groupOf(const PublishQueueEvent *event) {
+    if (strcmp(event->eventName, ProjectConfig::webhookEventName()) != 0) {
+        return 0;
+    }
+    uint64_t timestamp = timestampValue(event->eventData);
+    if (timestamp == 0) {
+        return 0;
+    }
+
+    time_t time = (time_t)(timestamp / 1000);
+    LocalOffset::Fields local;
+    if (LocalOffset::split(time, local)) {
+        return (uint32_t)local.year * 10000 + local.month * 100 + local.day;
+    }
+    LocalTimeConvert conv;
+    conv.withConfig(LocalTime::instance().getConfig()).withTime(time).convert();
+    LocalTimeYMD ymd = conv.getLocalTimeYMD();
+    return (uint32_t)ymd.getYear() * 10000 + ymd.getMonth() * 100 + ymd.getDay();
+}
+
+void ReportCompactor::begin() {
+    hours = 0;
+    hourlySum = 0;
+    alerts = 0;
+    key1[0] = 0;
+    firstTimestamp = 0;
+}
+
+void ReportCompactor::add(const PublishQueueEvent *event) {
+    const char *json = event->eventData;
+
+    hours++;
+    hourlySum += (uint32_t)numberValue(json, "hourly");
+    daily = (long)numberValue(json, "daily");
+    battery = (float)numberValue(json, "battery");
+    temp = (float)numberValue(json, "temp");
+    resets = (long)numberValue(json, "resets");
+
+    long alert = (long)numberValue(json, "alerts");
+    if (alert > alerts) {
+        alerts = alert;
+    }
+
+    const char *p = findValue(json, "key1");
+    if (p && *p == '"') {
+        p++;
+        size_t len = 0;
+        while (p[len] && p[len] != '"' && len < sizeof(key1) - 1) {
+            key1[len] = p[len];
+            len++;
+        }
+        key1[len] = 0;
+    }
+
+    lastTimestamp = timestampValue(json);
+    if (firstTimestamp == 0) {
+        firstTimestamp = lastTimestamp;
+    }
+}
+
+bool ReportCompactor::finish(char *eventName, char *eventData) {
+    if (hours == 0) {
+        return false;
+    }
+    strcpy(eventName, ProjectConfig::webhookDailyEventName());
+    static const Payload::Field batchSchema[] = {
+        {"hours", Payload::UINT, 0},
+        {"hourly", Payload::UINT, 0},
+        {"daily", Payload::INT, 0},
+        {"battery", Payload::FIXED, 2},
+        {"key1", Payload::STRING, 0},
+        {"temp", Payload::FIXED, 2},
+        {"resets", Payload::INT, 0},
+        {"alerts", Payload::INT, 0},
+        {"first", Payload::UINT64, 0},
+        {"timestamp", Payload::UINT64, 0},
+    };
+    Payload::Value values[sizeof(batchSchema) / sizeof(batchSchema[0])];
+    values[0].u = hours;
+    values[1].u = hourlySum;
+    values[2].i = (int32_t)daily;
+    values[3].f = battery;
+    values[4].s = key1;
+    values[5].f = temp;
+    values[6].i = (int32_t)resets;
+    values[7].i = (int32_t)alerts;
+    values[8].u64 = firstTimestamp;
+    values[9].u64 = lastTimestamp;
+    Payload::Writer(eventData, particle::protocol::MAX_EVENT_DATA_LENGTH + 1)
+        .beginObject()
+        .writeFields(batchSchema, values, sizeof(values) / sizeof(values[0]))
+        .endObject();
+    return true;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file ReportCompactor.h
+ * @brief Folds a day of queued hourly reports into one daily summary.
+ *
+ * @details Used with PublishQueuePosix::withCompaction() (PUBLISH_BACKLOG_COMPACTION).
+ *          When a long outage fills the report lane past its high-water mark,
+ *          the oldest complete local day of webhookEventName() reports is
+ *          replaced by one webhookDailyEventName() event:
+ *
+ *              {"hours":N,"hourly":<sum>,"daily":<last>,"battery":<last>,
+ *               "key1":"<last>","temp":<last>,"resets":<last>,"alerts":<max>,
+ *               "first":<first timestamp>,"timestamp":<last timestamp>}
+ *
+ *          "daily" is the running daily count of the last hour, so the day's
+ *          total survives even though the per-hour values do not.
+ */
+
+#ifndef __REPORTCOMPACTOR_H
+#define __REPORTCOMPACTOR_H
+
+#include "Particle.h"
+#include "PublishQueuePosixRK.h"
+
+class ReportCompactor : public PublishQueueCompactor {
+public:
+    /**
+     * @brief Local date of the report's timestamp as YYYYMMDD, or 0 if it is not an hourly report
+     */
+    virtual uint32_t groupOf(const PublishQueueEvent *event);
+
+    virtual void begin();
+    virtual void add(const PublishQueueEvent *event);
+    virtual bool finish(char *eventName, char *eventData);
+
+protected:
+    uint16_t hours = 0;          ///< Reports added
+    uint32_t hourlySum = 0;      ///< Sum of "hourly"
+    long daily = 0;              ///< Last "daily"
+    float battery = 0;           ///< Last "battery"
+    char key1[16] = "";          ///< Last "key1"
+    float temp = 0;              ///< Last "temp"
+    long resets = 0;             ///< Last "resets"
+    long alerts = 0;             ///< Largest "alerts"
+    uint64_t firstTimestamp = 0; ///< "timestamp" of the first report (ms)
+    uint64_t lastTimestamp = 0;  ///< "timestamp" of the last report (ms)
+};
+
+#endif /* __REPORTCOMPACTOR_H */
@@ -0,0 +1,93 @@
+#include "ReportSlot.h"
+#include "Config.h"
+#include "MyPersistentData.h"
+#include "PowerGovernor.h"
+#include "StateMachine.h"
+
+namespace ReportSlot {
+
+static int32_t lastMissSec = -1;        // Start after the boundary of the last missed connect
+
+struct Slot {
+    int startSec;
+    int widthSec;
+};
+
+// This device's slot; widthSec 0 when no slot applies
+static Slot activeSlot() {
+    Slot slot = {0, 0};
+#if REPORT_SLOTS_ENABLED
+    static uint32_t loggedKey = 0;
+    uint8_t count = sysStatus.get_slotCount();
+    uint8_t index = sysStatus.get_slotIndex();
+    if (count == 0 || index >= count || wakeBoundary <= 0) {
+        return slot;
+    }
+    int width = sysStatus.get_slotWidthSec();
+    int fit = (wakeBoundary / 2) / count;      // Keep every slot in the first half of the boundary
+    uint32_t key = ((uint32_t)count << 24) | ((uint32_t)index << 16) | (uint32_t)width;
+    if (width > fit) {
+        if (key != loggedKey) {
+            Log.warn("ReportSlot: %u slots of %d s do not fit in %d s; %d s each", (unsigned)count, width,
+                     wakeBoundary / 2, fit);
+        }
+        width = fit;
+    }
+    if (width > 0) {
+        slot = {index * width, width};
+        if (key != loggedKey) {
+            Log.info("ReportSlot: slot %u of %u, %d-%d s after each boundary", (unsigned)index, (unsigned)count,
+                     slot.startSec, slot.startSec + slot.widthSec);
+        }
+    }
+    loggedKey = key;
+#endif
+    return slot;
+}
+
+int wakeOffsetSec(int jitterSec) {
+    Slot slot = activeSlot();
+    return slot.widthSec > 0 ? slot.startSec : jitterSec;
+}
+
+void noteConnectStart() {
+#if REPORT_SLOTS_ENABLED
+    Slot slot = activeSlot();
+    if (slot.widthSec == 0 || !Time.isValid() || PowerGovernor::operatingMode() != LOW_POWER ||
+        Particle.connected()) {
+        return;
+    }
+    int32_t sinceBoundary = (int32_t)(Time.now() % wakeBoundary);
+    if (sysStatus.get_slotConnects() < UINT16_MAX) {
+        sysStatus.set_slotConnects(sysStatus.get_slotConnects() + 1);
+    }
+    if (sinceBoundary < slot.startSec || sinceBoundary >= slot.startSec + slot.widthSec) {
+        lastMissSec = sinceBoundary;
+        if (sysStatus.get_slotMisses() < UINT16_MAX) {
+            sysStatus.set_slotMisses(sysStatus.get_slotMisses() + 1);
+        }
+        Log.warn("ReportSlot: connect %ld s after the boundary, outside slot %d-%d s (%u misses in %u)",
+                 (long)sinceBoundary, slot.startSec, slot.startSec + slot.widthSec,
+                 (unsigned)sysStatus.get_slotMisses(), (unsigned)sysStatus.get_slotConnects());
+    }
+#endif
+}
+
+void writeStatus(JSONWriter &writer) {
+#if REPORT_SLOTS_ENABLED
+    Slot slot = activeSlot();
+    if (slot.widthSec == 0) {
+        return;
+    }
+    writer.name("slot").beginObject();
+    writer.name("i").value((int)sysStatus.get_slotIndex());
+    writer.name("of").value((int)sysStatus.get_slotCount());
+    writer.name("w").value(slot.widthSec);
+    writer.name("n").value((unsigned long)sysStatus.get_slotConnects());
+    writer.name("miss").value((unsigned long)sysStatus.get_slotMisses());
+    writer.name("lastSec").value((int)lastMissSec);
+    writer.endObject();
+#endif
+}
+
+} // namespace ReportSlot
@@ -0,0 +1,57 @@
+/**
+ * @file ReportSlot.h
+ * @brief Non-overlapping connect slots for devices that share a site.
+ *
+ * @details The fleet's wake jitter spreads devices over
+ *          WAKE_JITTER_WINDOW_SEC, but two counters on the same tower can
+ *          still hash into the same seconds. A site group is given slots
+ *          instead: the device-settings ledger sets timing.slotCount (the
+ *          devices in the group), timing.slotIndex (this one, 0-based) and
+ *          timing.slotWidthSec, and a low-power nap then wakes at
+ *          boundary + slotIndex × slotWidthSec in place of the jitter.
+ *          Slots are kept within the first half of the boundary, like the
+ *          jitter; a width that does not fit is narrowed and logged.
+ *          slotCount 0, or an index outside it, keeps the jitter.
+ *
+ *          Each connect that a scheduled report starts from a disconnected
+ *          radio in LOW_POWER mode is checked against the slot: starting
+ *          outside [slot start, slot start + width) after the boundary is a
+ *          miss (late wake, a long report, a stay-awake report on the old
+ *          phase). Connects and misses are kept in sysStatus, a miss is
+ *          logged as a warning, and the status ledger carries
+ *          "slot":{"i":n,"of":n,"w":n,"n":n,"miss":n,"lastSec":n}, lastSec
+ *          being the last miss's start after the boundary.
+ *
+ *          Application thread only.
+ */
+
+#ifndef __REPORTSLOT_H
+#define __REPORTSLOT_H
+
+#include "Particle.h"
+
+namespace ReportSlot {
+
+/**
+ * @brief Seconds after each wakeBoundary to wake: this device's slot start
+ *        when slots are set, else @p jitterSec
+ *
+ * @param jitterSec The fleet jitter, used when no slot applies
+ */
+int wakeOffsetSec(int jitterSec);
+
+/**
+ * @brief A scheduled report is starting a connect; count it, and a miss if
+ *        it is outside this device's slot
+ */
+void noteConnectStart();
+
+/**
+ * @brief Write the slot and its counts to an open JSON object as "slot",
+ *        when slots are set
+ */
+void writeStatus(JSONWriter &writer);
+
+} // namespace ReportSlot
+
+#endif /* __REPORTSLOT_H */
@@ -0,0 +1,194 @@
+#include "ReportTracker.h"
+#include "AppMessages.h"
+#include "Config.h"
+#include "HourlyHistory.h"
+#include "MyPersistentData.h"
+#include "PowerPolicy.h"
+#include "PublishQueuePosixRK.h"
+#include <stdlib.h>
+#include <string.h>
+
+namespace ReportTracker {
+
+static unsigned long drainedSinceMs = 0;   // When the queue was last seen drained while connected (0 = not drained)
+
+uint32_t nextSeq(time_t timestamp) {
+    uint32_t seq = sysStatus.get_reportSeq() + 1;
+    if (seq == 0) {
+        seq = 1;            // 0 marks a free slot
+    }
+    sysStatus.set_reportSeq(seq);
+
+    // A free slot, else the oldest entry makes room
+    size_t slot = 0;
+    for (size_t ii = 0; ii < WINDOW; ii++) {
+        uint32_t entry = sysStatus.get_unackedSeq(ii);
+        if (entry == 0) {
+            slot = ii;
+            break;
+        }
+        if (entry < sysStatus.get_unackedSeq(slot)) {
+            slot = ii;
+        }
+    }
+    if (sysStatus.get_unackedSeq(slot) != 0) {
+        Log.info("Reports: window full - no longer tracking seq %lu", (unsigned long)sysStatus.get_unackedSeq(slot));
+        sysStatus.set_reportsUntracked(sysStatus.get_reportsUntracked() + 1);
+    }
+    sysStatus.set_unackedSeq(slot, seq);
+    sysStatus.set_unackedHour(slot, (uint32_t)timestamp);
+    PowerPolicy::noteReportQueued();
+    return seq;
+}
+
+void confirm(uint32_t seq) {
+    size_t slot = WINDOW;
+    for (size_t ii = 0; ii < WINDOW; ii++) {
+        uint32_t entry = sysStatus.get_unackedSeq(ii);
+        if (entry == 0) {
+            continue;
+        }
+        if (entry == seq) {
+            slot = ii;
+            break;
+        }
+        if (seq == 0 && (slot == WINDOW || entry < sysStatus.get_unackedSeq(slot))) {
+            slot = ii;
+        }
+    }
+    if (slot == WINDOW) {
+        return;             // Already confirmed, resent, or pushed out of the window
+    }
+    sysStatus.set_unackedSeq(slot, 0);
+    sysStatus.set_unackedHour(slot, 0);
+    PowerPolicy::noteReportConfirmed();
+}
+
+void postConfirms(const char *topic) {
+    const char *list = topic ? strstr(topic, "/seq/") : nullptr;
+    if (!list) {
+        AppMessages::post(AppMessages::HOOK_CONFIRM, 0);
+        return;
+    }
+    list += 5;
+    while (*list) {
+        char *end;
+        unsigned long seq = strtoul(list, &end, 10);
+        if (end == list) {
+            break;
+        }
+        if (seq != 0) {
+            AppMessages::post(AppMessages::HOOK_CONFIRM, (int32_t)seq);
+        }
+        list = (*end == ',') ? end + 1 : end;
+    }
+}
+
+size_t pending() {
+    size_t count = 0;
+    for (size_t ii = 0; ii < WINDOW; ii++) {
+        if (sysStatus.get_unackedSeq(ii) != 0) {
+            count++;
+        }
+    }
+    return count;
+}
+
+bool awaitingResponse() {
+#if REPORT_ACK_TRACKING && !PUBLISH_COMPACT_REPORT
+    return Particle.connected() && pending() > 0;
+#else
+    return false;
+#endif
+}
+
+// Resend what is left in the window as a "history" event, the same rows
+// HourlyHistory backfill sends, with the seqs alongside. Past
+// RECORDS_PER_EVENT the rest wait for the next drain.
+static void resendPending() {
+    char data[640];
+    JSONBufferWriter writer(data, sizeof(data) - 1);
+    writer.beginObject();
+    writer.name("h").beginArray();
+    uint32_t seqs[HourlyHistory::RECORDS_PER_EVENT];
+    size_t found = 0;
+    uint16_t lost = 0;
+    for (size_t ii = 0; ii < WINDOW && found < HourlyHistory::RECORDS_PER_EVENT; ii++) {
+        uint32_t seq = sysStatus.get_unackedSeq(ii);
+        if (seq == 0) {
+            continue;
+        }
+        HourlyHistory::Record rec;
+        if (HourlyHistory::instance().read((time_t)sysStatus.get_unackedHour(ii), rec)) {
+            writer.beginArray()
+                .value((unsigned long)rec.hourEpoch)
+                .value(rec.count)
+                .value(rec.occupiedSec)
+                .value(rec.soc)
+                .value(rec.tempC)
+                .value(rec.alert)
+                .endArray();
+            seqs[found++] = seq;
+        } else {
+            lost++;
+        }
+        sysStatus.set_unackedSeq(ii, 0);
+        sysStatus.set_unackedHour(ii, 0);
+    }
+    writer.endArray();
+    writer.name("seq").beginArray();
+    for (size_t ii = 0; ii < found; ii++) {
+        writer.value((unsigned long)seqs[ii]);
+    }
+    writer.endArray();
+    writer.endObject();
+
+    if (lost) {
+        Log.info("Reports: %u unconfirmed reports no longer in history", lost);
+        sysStatus.set_reportsLost(sysStatus.get_reportsLost() + lost);
+    }
+    if (!found) {
+        return;
+    }
+    if (writer.dataSize() >= sizeof(data)) {
+        Log.warn("Reports: resend truncated");
+        return;
+    }
+    data[writer.dataSize()] = '\0';
+    PublishQueuePosix::instance().publish("history", data, PRIVATE | WITH_ACK);
+    sysStatus.set_reportsResent(sysStatus.get_reportsResent() + found);
+    Log.info("Reports: resent %u unconfirmed reports", (unsigned)found);
+}
+
+bool loop() {
+#if REPORT_ACK_TRACKING && !PUBLISH_COMPACT_REPORT
+    // Responses only follow once the reports have left the queue
+    if (!Particle.connected() || PublishQueuePosix::instance().getNumEvents() > 0 ||
+        !PublishQueuePosix::instance().getCanSleep()) {
+        drainedSinceMs = 0;
+        return true;
+    }
+    if (drainedSinceMs == 0) {
+        drainedSinceMs = millis() | 1;
+        return true;
+    }
+    if (millis() - drainedSinceMs < REPORT_ACK_WAIT_SEC * 1000UL || pending() == 0) {
+        return true;
+    }
+    resendPending();
+    drainedSinceMs = 0;
+#endif
+    return true;
+}
+
+void writeStatus(JSONWriter &writer) {
+    writer.name("reports").beginObject();
+    writer.name("seq").value((unsigned long)sysStatus.get_reportSeq());
+    writer.name("pending").value((int)pending());
+    writer.name("resent").value((int)sysStatus.get_reportsResent());
+    writer.name("lost").value((int)sysStatus.get_reportsLost());
+    writer.name("untracked").value((int)sysStatus.get_reportsUntracked());
+    writer.endObject();
+}
+
+} // namespace ReportTracker
@@ -0,0 +1,86 @@
+/**
+ * @file ReportTracker.h
+ * @brief Report sequence numbers, webhook confirmation and one-time resend.
+ *
+ * @details Every JSON hourly report is published WITH_ACK, but that only
+ *          means the Particle cloud took it; the webhook to Ubidots can
+ *          still fail, and a report dropped from the queue is never sent.
+ *          Each report therefore gets "seq", one more than the last, kept
+ *          in sysStatus across resets. The seq and report timestamp go into
+ *          a window of WINDOW unconfirmed reports, also in sysStatus.
+ *
+ *          The webhook's response topic is "<deviceID>/seq/<seq>" (a merged
+ *          publish lists its reports' seqs, comma-separated), so
+ *          UbidotsHandler() knows which report a response is for. A 2xx
+ *          response removes that seq from the window. A response on the
+ *          bare device ID topic, from a webhook not yet updated, confirms
+ *          the oldest one.
+ *
+ *          Once the publish queue has drained and REPORT_ACK_WAIT_SEC has
+ *          passed with no more responses, whatever is left in the window
+ *          was lost on the way or is not going to be confirmed. Those
+ *          hours are resent once, from HourlyHistory, as a "history" event
+ *          with their seqs, and leave the window. Hours already delivered
+ *          arrive twice with the same seq, which the cloud can discard.
+ *          A full window drops its oldest entry, counted as untracked; a
+ *          long outage is the backlog's job, not this one's.
+ */
+
+#ifndef __REPORTTRACKER_H
+#define __REPORTTRACKER_H
+
+#include "Particle.h"
+
+namespace ReportTracker {
+
+/** @brief Unconfirmed reports tracked; must match sysStatus unackedSeq[]. */
+static constexpr size_t WINDOW = 24;
+
+/**
+ * @brief Assign the next sequence number to the report for @p timestamp and track it
+ *
+ * @return The sequence number to put in the report as "seq"
+ */
+uint32_t nextSeq(time_t timestamp);
+
+/**
+ * @brief A 2xx webhook response confirmed report @p seq (0 = the oldest unconfirmed)
+ */
+void confirm(uint32_t seq);
+
+/**
+ * @brief Parse the seqs out of a webhook response topic and post HOOK_CONFIRM for each
+ *
+ * @details Called from UbidotsHandler() on the system thread for a 2xx
+ *          response; only posts AppMessages.
+ */
+void postConfirms(const char *topic);
+
+/**
+ * @brief Resend unconfirmed reports once the queue has drained; call from a task
+ *
+ * @return true (TaskScheduler convention)
+ */
+bool loop();
+
+/**
+ * @brief true while connected with reports still waiting for a webhook response
+ *
+ * @details A low-power device holds off sleep until the responses arrive
+ *          or loop() resends what is still missing.
+ */
+bool awaitingResponse();
+
+/**
+ * @brief Reports in the window
+ */
+size_t pending();
+
+/**
+ * @brief Write {"seq":n,"pending":n,"resent":n,"lost":n,"untracked":n} to an open JSON object as "reports"
+ */
+void writeStatus(JSONWriter &writer);
+
+} // namespace ReportTracker
+
+#endif /* __REPORTTRACKER_H */
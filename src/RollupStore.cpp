@@ -0,0 +1,128 @@
+#include "RollupStore.h"
+#include "HourlyHistory.h"
+#include "MyPersistentData.h"
+#include "OpenHours.h"
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace RollupStore {
+
+static const char *rollupPath = "/usr/rollup.dat";
+
+// Day slots first, then week slots
+static off_t slotOffset(Level level, uint32_t period) {
+    off_t base = (level == WEEK) ? (off_t)DAY_CAPACITY * sizeof(Record) : 0;
+    return base + (off_t)(period % capacity(level)) * sizeof(Record);
+}
+
+static uint8_t checksum(const Record &rec) {
+    const uint8_t *p = (const uint8_t *)&rec;
+    uint8_t sum = 0x5a;
+    for (size_t ii = 0; ii < offsetof(Record, check); ii++) {
+        sum += p[ii];
+    }
+    return (uint8_t)~sum;
+}
+
+static bool write(Level level, uint32_t period, Record &rec) {
+    rec.check = checksum(rec);
+
+    int fd = open(rollupPath, O_RDWR | O_CREAT, 0666);
+    if (fd < 0) {
+        Log.warn("Rollup: open failed (%d)", errno);
+        return false;
+    }
+    off_t offset = slotOffset(level, period);
+    bool ok = lseek(fd, offset, SEEK_SET) == offset && ::write(fd, &rec, sizeof(rec)) == (int)sizeof(rec);
+    close(fd);
+    if (!ok) {
+        Log.warn("Rollup: write failed at level %u slot %lu", (unsigned)level, (unsigned long)(period % capacity(level)));
+    }
+    return ok;
+}
+
+uint16_t capacity(Level level) {
+    return (level == WEEK) ? WEEK_CAPACITY : DAY_CAPACITY;
+}
+
+uint32_t periodSec(Level level) {
+    return (level == WEEK) ? 7 * 86400 : 86400;
+}
+
+uint32_t periodOf(Level level, time_t startEpoch) {
+    // The UTC day nearest local midnight; 1970-01-05, day 4, was a Monday
+    uint32_t day = (uint32_t)((startEpoch + 43200) / 86400);
+    return (level == WEEK) ? (day + 3) / 7 : day;
+}
+
+uint32_t periodAt(Level level, time_t time) {
+    return periodOf(level, OpenHours::nextMidnightAfter(time - 86400));
+}
+
+bool read(Level level, uint32_t period, Record &rec) {
+    int fd = open(rollupPath, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    off_t offset = slotOffset(level, period);
+    bool ok = lseek(fd, offset, SEEK_SET) == offset && ::read(fd, &rec, sizeof(rec)) == (int)sizeof(rec);
+    close(fd);
+
+    return ok && rec.startEpoch != 0 && periodOf(level, (time_t)rec.startEpoch) == period && rec.check == checksum(rec);
+}
+
+void closeDay(time_t dayEnd) {
+    // 26 hours back lands in the previous local day even across a DST change
+    time_t dayStart = OpenHours::nextMidnightAfter(dayEnd - 26 * 3600);
+    uint32_t dayPeriod = periodOf(DAY, dayStart);
+
+    Record day = {};
+    day.startEpoch = (uint32_t)dayStart;
+    day.count = current.get_dailyCount();
+    day.occupiedSec = current.get_totalOccupiedSeconds();
+    day.socMin = (uint8_t)constrain((current.get_socTenths() + 5) / 10, 0, 100);
+    day.alert = current.get_alertCode();
+
+    // The last hour's record is not written yet; its SoC and alert are current's
+    for (time_t hour = dayStart; hour < dayEnd; hour += 3600) {
+        HourlyHistory::Record rec;
+        if (HourlyHistory::instance().read(hour, rec)) {
+            day.parts++;
+            day.socMin = std::min(day.socMin, rec.soc);
+            day.alert = std::max(day.alert, rec.alert);
+        }
+    }
+
+    // A day closed twice (a reset before the midnight was moved on) replaces its first close
+    Record prior;
+    bool again = read(DAY, dayPeriod, prior);
+    write(DAY, dayPeriod, day);
+
+    // Start the week's record on its first day, or on any day if the slot is stale
+    uint32_t weekPeriod = periodOf(WEEK, dayStart);
+    Record week;
+    if (!read(WEEK, weekPeriod, week)) {
+        uint32_t back = (dayPeriod + 3) % 7;        // Days since Monday
+        week = {};
+        week.startEpoch = (uint32_t)OpenHours::nextMidnightAfter(dayStart - (time_t)back * 86400 - 3 * 3600);
+        week.socMin = day.socMin;
+        week.alert = day.alert;
+    } else if (again) {
+        week.count -= std::min(week.count, prior.count);
+        week.occupiedSec -= std::min(week.occupiedSec, prior.occupiedSec);
+        week.parts -= (week.parts > 0) ? 1 : 0;
+    }
+    week.count += day.count;
+    week.occupiedSec += day.occupiedSec;
+    week.socMin = std::min(week.socMin, day.socMin);
+    week.alert = std::max(week.alert, day.alert);
+    week.parts++;
+    write(WEEK, weekPeriod, week);
+
+    Log.info("Rollup: day %lu count %lu, week %lu day %u", (unsigned long)day.startEpoch, (unsigned long)day.count,
+             (unsigned long)week.startEpoch, (unsigned)week.parts);
+}
+
+} // namespace RollupStore
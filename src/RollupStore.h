@@ -0,0 +1,98 @@
+/**
+ * @file RollupStore.h
+ * @brief Fixed-size on-flash daily and weekly rollups of the hourly history.
+ *
+ * @details HourlyHistory keeps 16 days of hours. This keeps the same data
+ *          rolled up coarser, for longer: DAY_CAPACITY local days and
+ *          WEEK_CAPACITY local weeks (Monday to Sunday) of 16-byte records
+ *          in one file of fixed size, about 2.4 KB, so history on the
+ *          device never grows.
+ *
+ *          As in HourlyHistory, a record lives in slot (period % capacity)
+ *          and carries its own start time and checksum, so there are no
+ *          pointers to keep and a torn write only damages the one slot.
+ *          Periods are numbered by the UTC day nearest the local start
+ *          (weeks by the Monday), which stays one apart across a DST change.
+ *
+ *          closeDay() runs from dailyCleanup(), before the daily counts are
+ *          zeroed: the day record takes the day's count and occupied time
+ *          from current, and the lowest SoC, the highest alert and the
+ *          number of hours stored from the day's HourlyHistory records.
+ *          The day is then added to its week's record, so the week level
+ *          is up to date every day and rolls over by itself when a new
+ *          week's first day lands in the next slot.
+ *
+ *          The "backfill" function reads these levels for ranges, or
+ *          resolutions, the hourly ring cannot serve (see HourlyHistory).
+ *
+ *          Application thread only.
+ */
+
+#ifndef __ROLLUPSTORE_H
+#define __ROLLUPSTORE_H
+
+#include "Particle.h"
+
+namespace RollupStore {
+
+/** @brief Rollup levels, finest first. */
+enum Level : uint8_t {
+    DAY = 0,
+    WEEK,
+    NUM_LEVELS
+};
+
+/** @brief Local days kept (90 days and some margin). */
+static constexpr uint16_t DAY_CAPACITY = 96;
+
+/** @brief Local weeks kept (a year and some margin). */
+static constexpr uint16_t WEEK_CAPACITY = 56;
+
+/** @brief One stored day or week. */
+struct Record {
+    uint32_t startEpoch;        ///< Local midnight starting the period (UTC epoch)
+    uint32_t count;             ///< Events counted in the period
+    uint32_t occupiedSec;       ///< Seconds occupied in the period
+    uint8_t  socMin;            ///< Lowest battery state of charge reported, percent
+    uint8_t  parts;             ///< Hours stored (DAY) or days rolled up (WEEK)
+    int8_t   alert;             ///< Highest alert code reported
+    uint8_t  check;             ///< Checksum of the other 15 bytes
+};
+static_assert(sizeof(Record) == 16, "RollupStore::Record must stay 16 bytes");
+
+/**
+ * @brief Slots at @p level
+ */
+uint16_t capacity(Level level);
+
+/**
+ * @brief Length of a period at @p level, in seconds (nominal; DST days differ)
+ */
+uint32_t periodSec(Level level);
+
+/**
+ * @brief Period number at @p level of the period containing local midnight @p startEpoch
+ */
+uint32_t periodOf(Level level, time_t startEpoch);
+
+/**
+ * @brief Period number at @p level of the period containing any time @p time
+ */
+uint32_t periodAt(Level level, time_t time);
+
+/**
+ * @brief Store the local day ending at @p dayEnd and add it to its week
+ *
+ * @details Call from dailyCleanup() while current still holds the day.
+ */
+void closeDay(time_t dayEnd);
+
+/**
+ * @brief Read period @p period of @p level
+ * @return false if that slot is empty or holds a different period
+ */
+bool read(Level level, uint32_t period, Record &rec);
+
+} // namespace RollupStore
+
+#endif /* __ROLLUPSTORE_H */
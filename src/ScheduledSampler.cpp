@@ -0,0 +1,105 @@
+#include "ScheduledSampler.h"
+#include "ConfigSnapshot.h"
+#include "MyPersistentData.h"
+#include "Payload.h"
+#include "PowerGovernor.h"
+#include "SensorManager.h"
+
+namespace ScheduledSampler {
+
+uint32_t periodSec() {
+    uint32_t period = ConfigSnapshot::read().pollingRateSec;
+    if (period == 0) {
+        period = PowerGovernor::reportingIntervalSec();
+    }
+    return period ? period : 3600;
+}
+
+uint32_t secondsUntilDue() {
+    uint32_t period = periodSec();
+    time_t now = Time.now();
+    time_t boundary = now - (now % period);
+    if (boundary != current.get_lastSampleTime()) {
+        return 0;
+    }
+    return period - (uint32_t)(now - boundary);
+}
+
+bool sampleIfDue() {
+    if (ConfigSnapshot::read().countingMode != SCHEDULED || !Time.isValid()) {
+        return false;
+    }
+    uint32_t period = periodSec();
+    time_t now = Time.now();
+    time_t boundary = now - (now % period);
+    if (boundary == current.get_lastSampleTime()) {
+        return false;
+    }
+
+    SensorManager &sensors = SensorManager::instance();
+    size_t count = sensors.sensorCount();
+    uint16_t values[SensorManager::MAX_SENSORS] = {};
+    bool valid[SensorManager::MAX_SENSORS] = {};
+    for (size_t ii = 0; ii < count; ii++) {
+        valid[ii] = sensors.sampleSlot(ii, values[ii]);
+    }
+    current.addSamples(boundary, values, valid, count);
+
+    Log.info("Scheduled sample at %s: primary=%u%s (%u sensor(s))",
+             Time.format(boundary, TIME_FORMAT_DEFAULT).c_str(), values[0],
+             valid[0] ? "" : " (failed)", (unsigned)count);
+    return true;
+}
+
+bool recordPolled() {
+    if (ConfigSnapshot::read().countingMode == SCHEDULED) {
+        return false;
+    }
+    SensorManager &sensors = SensorManager::instance();
+    if (sensors.auxSensorCount() == 0) {
+        return false;
+    }
+    uint16_t values[SensorManager::MAX_SENSORS] = {};
+    bool valid[SensorManager::MAX_SENSORS] = {};
+    if (sensors.takeAuxReadings(values, valid) == 0) {
+        return false;
+    }
+    // Not a boundary sample: lastSampleTime stays as it is
+    current.addSamples(current.get_lastSampleTime(), values, valid, sensors.sensorCount());
+    return true;
+}
+
+bool hasSamples() {
+    for (size_t ii = 0; ii < currentStatusData::MAX_SENSOR_SLOTS; ii++) {
+        if (current.get_sampleStats(ii).count != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool formatReport(char *buf, size_t size) {
+    if (!hasSamples()) {
+        return false;
+    }
+    Payload::Writer writer(buf, size);
+    writer.beginObject();
+    for (size_t ii = 0; ii < currentStatusData::MAX_SENSOR_SLOTS; ii++) {
+        currentStatusData::SampleStats stats = current.get_sampleStats(ii);
+        if (stats.count == 0) {
+            continue;
+        }
+        char key[4];
+        snprintf(key, sizeof(key), "%u", (unsigned)ii);
+        writer.beginObject(key)
+              .add("min", (unsigned)stats.minValue)
+              .add("max", (unsigned)stats.maxValue)
+              .addFixed("mean", (float)stats.sum / stats.count, 1)
+              .add("n", (unsigned)stats.count)
+              .endObject();
+    }
+    writer.endObject();
+    return writer.ok();
+}
+
+} // namespace ScheduledSampler
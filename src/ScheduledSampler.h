@@ -0,0 +1,76 @@
+/**
+ * @file ScheduledSampler.h
+ * @brief Timed readings of every sensor in SCHEDULED counting mode.
+ *
+ * @details Soil-moisture, distance and similar polled sensors have no
+ *          events to count. In SCHEDULED mode they are read together once
+ *          per sensorConfig pollingRate, on wall-clock boundaries (every
+ *          15 minutes means :00, :15, :30, :45), rather than by
+ *          SensorManager's own polling. The sleep path naps from one
+ *          boundary to the next with no sensor wake armed; each wake takes
+ *          one burst from every sensor through SensorManager::sampleSlot()
+ *          and goes straight back to sleep.
+ *
+ *          Readings are folded into a min/max/sum/count per sensor slot in
+ *          current.dat, so they survive a reset or HIBERNATE, and reported
+ *          as min/max/mean with the next hourly report. In the other
+ *          modes a polled aux sensor (AUX_POLLED_SENSOR_TYPE) is read on
+ *          its own period by SensorManager, and recordPolled() folds its
+ *          readings into the same aggregates.
+ */
+
+#ifndef __SCHEDULEDSAMPLER_H
+#define __SCHEDULEDSAMPLER_H
+
+#include "Particle.h"
+
+namespace ScheduledSampler {
+
+/**
+ * @brief Sampling period in seconds: pollingRate, or the reporting interval when that is 0
+ */
+uint32_t periodSec();
+
+/**
+ * @brief Seconds until the next sample is due (0 = due now)
+ *
+ * @details Only meaningful with valid time.
+ */
+uint32_t secondsUntilDue();
+
+/**
+ * @brief Read every sensor if this period has not been sampled yet
+ *
+ * @details Does nothing outside SCHEDULED mode or without valid time.
+ *
+ * @return true if a sample was taken
+ */
+bool sampleIfDue();
+
+/**
+ * @brief Fold in the readings polled aux sensors have made since the last call
+ *
+ * @details Does nothing in SCHEDULED mode, where sampleIfDue() reads them.
+ *
+ * @return true if any reading was added
+ */
+bool recordPolled();
+
+/**
+ * @brief true if any sensor has readings waiting for the report
+ */
+bool hasSamples();
+
+/**
+ * @brief Write the aggregates as a JSON object keyed by sensor slot
+ *
+ * @details e.g. {"0":{"min":412,"max":431,"mean":420.5,"n":4}} in the
+ *          sensor's primary units. Slots without readings are left out.
+ *
+ * @return false if there are no readings or they did not fit
+ */
+bool formatReport(char *buf, size_t size);
+
+} // namespace ScheduledSampler
+
+#endif /* __SCHEDULEDSAMPLER_H */
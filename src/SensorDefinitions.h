@@ -2,47 +2,232 @@
 #ifndef SENSORDEFINITIONS_H
 #define SENSORDEFINITIONS_H
 
-#include "SensorFactory.h"
+#include "Config.h"
+#include "ISensor.h"
+#include "SensorType.h"
+
+// Drivers are only included (and their singletons only linked) when
+// enabled in Config.h.
+#if SENSOR_DRIVER_PIR
+#include "PIRSensor.h"
+#endif
+#if SENSOR_DRIVER_VEHICLE_PRESSURE
+#include "VehiclePressureSensor.h"
+#endif
+#if SENSOR_DRIVER_SOIL_MOISTURE
+#include "SoilMoistureSensor.h"
+#endif
+#if SENSOR_DRIVER_DISTANCE
+#include "DistanceSensor.h"
+#endif
+#if SENSOR_DRIVER_VEHICLE_MAGNETOMETER
+#include "VehicleMagnetometerSensor.h"
+#endif
+#if SENSOR_DRIVER_RAIN_BUCKET
+#include "RainBucketSensor.h"
+#endif
+#if SENSOR_DRIVER_DUAL_PIR
+#include "DualPirSensor.h"
+#endif
+#if SENSOR_DRIVER_LORA_GATEWAY
+#include "LoRaGatewaySensor.h"
+#endif
+#if SENSOR_DRIVER_OPENMV
+#include "OpenMVSensor.h"
+#endif
+#if SENSOR_DRIVER_ACCEL_PRESENCE
+#include "AccelPresenceSensor.h"
+#endif
+#if SENSOR_DRIVER_VIBRATION
+#include "VibrationSensor.h"
+#endif
 
 /**
  * @brief Static metadata for each supported sensor type.
  *
- * This provides a single place to review which sensor types are
- * defined in the firmware and to adjust device-specific defaults
- * (such as LED behavior, interrupt usage, etc.).
+ * This is the single registry for sensor types: driver accessor, display
+ * name, LED polarity and interrupt use all live in one row, so adding a
+ * sensor means editing one table instead of several switches.
  */
 struct SensorDefinition {
     SensorType   type;              ///< SensorType enum value
     const char*  name;              ///< Short name for logging / display
-    bool         ledDefaultOn;      ///< true if LED should be ON at boot (polarity-specific)
+    bool         ledDefaultOn;      ///< true if the board's LED enable is active-high (PowerDomains::SENSOR_LED)
     bool         usesInterrupt;     ///< true if sensor uses a hardware interrupt line
+    ISensor*   (*instance)();       ///< Driver singleton accessor, nullptr if not built
 };
 
 namespace SensorDefinitions {
 
-// NOTE: Keep this table in sync with SensorType in SensorFactory.h.
-// Only a subset of sensor types are currently implemented.
-static constexpr SensorDefinition DEFINITIONS[] = {
+/**
+ * @brief Adapter from a driver's static instance() to the registry signature.
+ */
+template <typename Driver>
+ISensor* driverInstance() {
+    return &Driver::instance();
+}
+
+#if SENSOR_DRIVER_PIR
+#define SENSOR_REGISTRY_PIR (&driverInstance<PIRSensor>)
+#else
+#define SENSOR_REGISTRY_PIR nullptr
+#endif
+
+#if SENSOR_DRIVER_VEHICLE_PRESSURE
+#define SENSOR_REGISTRY_VEHICLE_PRESSURE (&driverInstance<VehiclePressureSensor>)
+#else
+#define SENSOR_REGISTRY_VEHICLE_PRESSURE nullptr
+#endif
+
+#if SENSOR_DRIVER_SOIL_MOISTURE
+#define SENSOR_REGISTRY_SOIL_MOISTURE (&driverInstance<SoilMoistureSensor>)
+#else
+#define SENSOR_REGISTRY_SOIL_MOISTURE nullptr
+#endif
+
+#if SENSOR_DRIVER_DISTANCE
+#define SENSOR_REGISTRY_DISTANCE (&driverInstance<DistanceSensor>)
+#else
+#define SENSOR_REGISTRY_DISTANCE nullptr
+#endif
+
+#if SENSOR_DRIVER_VEHICLE_MAGNETOMETER
+#define SENSOR_REGISTRY_VEHICLE_MAGNETOMETER (&driverInstance<VehicleMagnetometerSensor>)
+#else
+#define SENSOR_REGISTRY_VEHICLE_MAGNETOMETER nullptr
+#endif
+
+#if SENSOR_DRIVER_RAIN_BUCKET
+#define SENSOR_REGISTRY_RAIN_BUCKET (&driverInstance<RainBucketSensor>)
+#else
+#define SENSOR_REGISTRY_RAIN_BUCKET nullptr
+#endif
+
+#if SENSOR_DRIVER_DUAL_PIR
+#define SENSOR_REGISTRY_DUAL_PIR (&driverInstance<DualPirSensor>)
+#else
+#define SENSOR_REGISTRY_DUAL_PIR nullptr
+#endif
+
+#if SENSOR_DRIVER_LORA_GATEWAY
+#define SENSOR_REGISTRY_LORA_GATEWAY (&driverInstance<LoRaGatewaySensor>)
+#else
+#define SENSOR_REGISTRY_LORA_GATEWAY nullptr
+#endif
+
+#if SENSOR_DRIVER_OPENMV
+#define SENSOR_REGISTRY_OPENMV (&driverInstance<OpenMVSensor>)
+#else
+#define SENSOR_REGISTRY_OPENMV nullptr
+#endif
+
+#if SENSOR_DRIVER_ACCEL_PRESENCE
+#define SENSOR_REGISTRY_ACCEL_PRESENCE (&driverInstance<AccelPresenceSensor>)
+#else
+#define SENSOR_REGISTRY_ACCEL_PRESENCE nullptr
+#endif
+
+#if SENSOR_DRIVER_VIBRATION
+#define SENSOR_REGISTRY_VIBRATION (&driverInstance<VibrationSensor>)
+#else
+#define SENSOR_REGISTRY_VIBRATION nullptr
+#endif
+
+// One row per SensorType. Types without a driver keep their name so
+// logs and the device-status ledger stay readable.
+inline constexpr SensorDefinition DEFINITIONS[] = {
     // Vehicle pressure sensor (legacy tire sensor) - LED enable is ACTIVE-HIGH
-    { SensorType::VEHICLE_PRESSURE, "VehiclePressure", true,  true },
+    { SensorType::VEHICLE_PRESSURE,     "VehiclePressure",     true,  true,  SENSOR_REGISTRY_VEHICLE_PRESSURE },
 
     // PIR pedestrian sensor (current default) - LED enable is ACTIVE-LOW
-    { SensorType::PIR,              "PIR",             false, true },
+    { SensorType::PIR,                  "PIR",                 false, true,  SENSOR_REGISTRY_PIR },
+
+    // Two PIR / beam channels on intPin and intPinB for in/out counts - same board LED as PIR
+    { SensorType::DUAL_PIR,             "DualPIR",             false, true,  SENSOR_REGISTRY_DUAL_PIR },
+
+    // Burst-sampled analog sensors (polled) - powered via disableModule
+    { SensorType::SOIL_MOISTURE,        "SoilMoisture",        false, false, SENSOR_REGISTRY_SOIL_MOISTURE },
+    { SensorType::DISTANCE,             "Distance",            false, false, SENSOR_REGISTRY_DISTANCE },
+
+    // LIS2MDL magnetometer on I2C, paces its own sampling; threshold interrupt on intPin for naps
+    { SensorType::VEHICLE_MAGNETOMETER, "VehicleMagnetometer", false, true,  SENSOR_REGISTRY_VEHICLE_MAGNETOMETER },
+
+    // Reed switch on intPin; naps count tips in hardware where supported
+    { SensorType::RAIN_BUCKET,          "RainBucket",          false, true,  SENSOR_REGISTRY_RAIN_BUCKET },
+
+    // OpenMV camera on Serial1, powered via disableModule on a duty cycle
+    { SensorType::OPENMV_OCCUPANCY,     "OpenMVOccupancy",     false, true,  SENSOR_REGISTRY_OPENMV },
+
+    // Gateway hub: SX127x radio on SPI, RxDone on loraDio0Pin
+    { SensorType::LORA_GATEWAY,         "LoRaGateway",         false, true,  SENSOR_REGISTRY_LORA_GATEWAY },
 
-    // Additional sensor types can be added here as they are implemented.
+    // LIS3DH accelerometer on I2C, motion interrupt on intPin
+    { SensorType::ACCEL_PRESENCE,       "AccelPresence",       false, true,  SENSOR_REGISTRY_ACCEL_PRESENCE },
+
+    // LIS3DH + LIS2MDL, spectral features per FIFO burst
+    { SensorType::VIBRATION_ADVANCED,   "VibrationAdvanced",   false, true,  SENSOR_REGISTRY_VIBRATION },
+
+    // Not yet implemented
+    { SensorType::VIBRATION_BASIC,      "VibrationBasic",      false, false, nullptr },
+    { SensorType::INDOOR_OCCUPANCY,     "IndoorOccupancy",     false, false, nullptr },
+    { SensorType::OUTDOOR_OCCUPANCY,    "OutdoorOccupancy",    false, false, nullptr },
 };
 
+inline constexpr size_t COUNT = sizeof(DEFINITIONS) / sizeof(DEFINITIONS[0]);
+
+/** @brief Largest SensorType id; sizes the direct-lookup index. */
+inline constexpr uint8_t MAX_TYPE_ID = 90;
+
+/** @brief Index value for ids with no registry row. */
+inline constexpr uint8_t NO_ENTRY = 0xFF;
+
+/**
+ * @brief Direct SensorType id -> DEFINITIONS row index, built at compile time.
+ */
+struct TypeIndex {
+    uint8_t row[MAX_TYPE_ID + 1];
+};
+
+constexpr TypeIndex buildTypeIndex() {
+    TypeIndex index{};
+    for (size_t id = 0; id <= MAX_TYPE_ID; id++) {
+        index.row[id] = NO_ENTRY;
+    }
+    for (size_t i = 0; i < COUNT; i++) {
+        index.row[static_cast<uint8_t>(DEFINITIONS[i].type)] = static_cast<uint8_t>(i);
+    }
+    return index;
+}
+
+constexpr bool registryIsConsistent() {
+    for (size_t i = 0; i < COUNT; i++) {
+        if (static_cast<uint8_t>(DEFINITIONS[i].type) > MAX_TYPE_ID) {
+            return false;
+        }
+        for (size_t j = i + 1; j < COUNT; j++) {
+            if (DEFINITIONS[i].type == DEFINITIONS[j].type) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static_assert(COUNT < NO_ENTRY, "Too many sensor registry rows");
+static_assert(registryIsConsistent(), "Duplicate or out-of-range SensorType in DEFINITIONS");
+
+inline constexpr TypeIndex TYPE_INDEX = buildTypeIndex();
+
 /**
  * @brief Lookup helper to get the SensorDefinition for a given SensorType.
  * @return Pointer to definition, or nullptr if not found.
  */
-inline const SensorDefinition* getDefinition(SensorType type) {
-    for (const auto& def : DEFINITIONS) {
-        if (def.type == type) {
-            return &def;
-        }
+constexpr const SensorDefinition* getDefinition(SensorType type) {
+    uint8_t id = static_cast<uint8_t>(type);
+    if (id > MAX_TYPE_ID || TYPE_INDEX.row[id] == NO_ENTRY) {
+        return nullptr;
     }
-    return nullptr;
+    return &DEFINITIONS[TYPE_INDEX.row[id]];
 }
 
 } // namespace SensorDefinitions
@@ -1,13 +1,22 @@
 // Battery conect information -
 // https://docs.particle.io/reference/device-os/firmware/boron/#batterystate-
-const char *batteryContext[7] = {"Unknown",    "Not Charging", "Charging",
-                                 "Charged",    "Discharging",  "Fault",
-                                 "Diconnected"};
+// The webhook template matches these spellings, "Diconnected" included
+static const char *const batteryContext[7] = {"Unknown",    "Not Charging", "Charging",
+                                              "Charged",    "Discharging",  "Fault",
+                                              "Diconnected"};
 
 // Particle Functions
 #include "SensorManager.h"
+#include "Config.h"
+#include "ConfigSnapshot.h"
+#include "EdgeCounter.h"
 #include "MyPersistentData.h"  // Access sysStatus/sensorConfig
+#include "Payload.h"
+#include "PlatformTraits.h"
+#include "PowerDomains.h"
 #include "SensorFactory.h"
+#include "StackMonitor.h"
+#include "UpdateWindow.h"
 #include "device_pinout.h"     // TMP36_SENSE_PIN for enclosure temperature
 
 // Device-specific includes and definitions
@@ -18,6 +27,19 @@ const char *batteryContext[7] = {"Unknown",    "Not Charging", "Charging",
 
 SensorManager *SensorManager::_instance;
 
+static_assert(currentStatusData::MAX_SENSOR_SLOTS == SensorManager::MAX_SENSORS,
+              "currentStatusData needs a slot for every SensorManager sensor");
+
+#if SENSOR_THREAD_ENABLED
+#include <mutex>
+
+// The sensor thread runs service() under _lock; app-thread calls that touch
+// the driver, the filter or the wake marker take it too
+#define SENSOR_GUARD() std::lock_guard<RecursiveMutex> sensorGuard(_lock)
+#else
+#define SENSOR_GUARD()
+#endif
+
 // [static]
 SensorManager &SensorManager::instance() {
   if (!_instance) {
@@ -25,12 +47,15 @@ SensorManager &SensorManager::instance() {
   }
   return *_instance;
 }
-SensorManager::SensorManager() : _sensor(nullptr), _lastPollTime(0) {}
+SensorManager::SensorManager() : _sensor(nullptr), _lastPollTime(0), _auxCount(0), _nextAuxDueMs(0) {}
 
 SensorManager::~SensorManager() {}
 
 void SensorManager::setup() {
     Log.info("Initializing SensorManager");
+    if constexpr (Platform::This::POWER_EVENTS) {
+        System.on(battery_state | power_source, powerEventHandler);
+    }
     
     if (!_sensor) {
         Log.error("No sensor assigned! Call setSensor() first.");
@@ -45,6 +70,7 @@ void SensorManager::setup() {
 }
 
 void SensorManager::setSensor(ISensor* sensor) {
+    SENSOR_GUARD();
     if (sensor) {
         _sensor = sensor;
         Log.info("Sensor set: %s", sensor->getSensorType());
@@ -55,6 +81,7 @@ void SensorManager::setSensor(ISensor* sensor) {
 
   void SensorManager::initializeFromConfig() {
     Log.info("Initializing sensor from configuration");
+    SENSOR_GUARD();
 
     SensorType sensorType = static_cast<SensorType>(sysStatus.get_sensorType());
     ISensor* sensor = SensorFactory::createSensor(sensorType);
@@ -66,87 +93,653 @@ void SensorManager::setSensor(ISensor* sensor) {
     }
 
     setSensor(sensor);
+    _filter.loadConfig();
+    _filter.reset();
+
+    // A second event sensor, counted in its own slot, then a polled one
+    // read every AUX_POLLED_SENSOR_PERIOD_SEC (Config.h; -1 = none)
+    addConfiguredAux(AUX_COUNTING_SENSOR_TYPE, 0, true);
+    addConfiguredAux(AUX_POLLED_SENSOR_TYPE, AUX_POLLED_SENSOR_PERIOD_SEC * 1000UL, false);
+
+#if FUSION_RANGE_CM > 0
+    // Powered down until a primary event asks for a burst
+    if (sensorType != SensorType::DISTANCE && !_confirm) {
+      _confirm = SensorFactory::createSensor(SensorType::DISTANCE);
+      if (!_confirm || !_confirm->initializeHardware()) {
+        Log.error("Fusion: no range finder; events are counted unconfirmed");
+        _confirm = nullptr;
+      } else {
+        Log.info("Fusion: events confirmed by a target within %d cm", FUSION_RANGE_CM);
+      }
+    }
+#endif
 
     if (!_sensor->initializeHardware()) {
       Log.error("Sensor hardware initialization failed for type %d", (int)sensorType);
     } else {
+      _warmUntilMs = warmupEnd(_sensor);
       Log.info("Sensor hardware initialized; type=%d, usesInterrupt=%s", (int)sensorType,
                _sensor->usesInterrupt() ? "true" : "false");
     }
+#if SENSOR_THREAD_ENABLED
+    startThread();
+#endif
+  }
+
+#if SENSOR_THREAD_ENABLED
+void SensorManager::startThread() {
+  if (_thread) {
+    return;
+  }
+  os_thread_create(&_thread, "sensor", SENSOR_THREAD_PRIORITY, threadMain, this, SENSOR_THREAD_STACK);
+  Log.info("Sensor thread started (priority %d, every %u ms)", (int)SENSOR_THREAD_PRIORITY,
+           (unsigned)SENSOR_THREAD_PERIOD_MS);
+}
+
+void SensorManager::threadMain(void *param) {
+  StackMonitor::paint(StackMonitor::SENSOR, SENSOR_THREAD_STACK);
+  SensorManager *self = static_cast<SensorManager *>(param);
+  system_tick_t lastWake = millis();
+  while (true) {
+    {
+      std::lock_guard<RecursiveMutex> guard(self->_lock);
+      size_t events = self->service();
+      for (size_t i = 0; i < events; i++) {
+        if (!self->_handoff.push(self->_batch[i])) {
+          // The app has fallen far behind (an OTA, a long cloud call); keep the count
+          size_t slot = self->_batch[i].source() < MAX_SENSORS ? self->_batch[i].source() : 0;
+          self->_carry[slot] = self->_batch[i];
+          self->_carryCount[slot]++;
+        }
+      }
+    }
+    os_thread_delay_until(&lastWake, SENSOR_THREAD_PERIOD_MS);
   }
+}
+
+size_t SensorManager::loop() {
+  // The thread has already drained and filtered; hand its events over
+  size_t events = 0;
+  while (events < MAX_BATCH && _handoff.pop(_appBatch[events])) {
+    events++;
+  }
+  // Events the queue had no room for follow once it is empty
+  if (events < MAX_BATCH && _carryApplied != _handoff.overflows() && _handoff.empty()) {
+    std::lock_guard<RecursiveMutex> guard(_lock);
+    for (size_t slot = 0; slot < MAX_SENSORS && events < MAX_BATCH; slot++) {
+      while (_carryCount[slot] > 0 && events < MAX_BATCH) {
+        _appBatch[events++] = _carry[slot];
+        _carryCount[slot]--;
+        _carryApplied++;
+      }
+    }
+  }
+  return events;
+}
+#else
+size_t SensorManager::loop() {
+  return service();
+}
+#endif
+
+size_t SensorManager::service() {
+    // SCHEDULED mode reads every sensor at once through sampleSlot()
+    if (ConfigSnapshot::read().countingMode == SCHEDULED) {
+        return 0;
+    }
+
+    unsigned long currentTime = millis();
+
+    size_t events = servicePrimary(currentTime);
+    for (size_t i = 0; i < events; i++) {
+        _batch[i].setSource(0);
+    }
+    if (_auxCount > 0) {
+        events += pollAuxSensors(currentTime, _batch + events, MAX_BATCH - events);
+    }
+    UpdateWindow::noteCaptured(_batch, events);
+    return events;
+}
+
+size_t SensorManager::servicePrimary(unsigned long currentTime) {
+    // A wake edge that the filter rejected never reaches the counters;
+    // don't let it turn the next unrelated count into a bogus latency.
+    if (_wakeMarkPending && (currentTime - _wakeMarkMs) > 5000UL) {
+        _wakeMarkPending = false;
+        Log.info("SensorManager: PIR wake produced no accepted event");
+    }
 
-bool SensorManager::loop() {
     if (!_sensor || !_sensor->isReady()) {
-        return false;
+        return 0;
     }
+    checkSensorHealth();
     
-    unsigned long currentTime = millis();
-    uint16_t pollingRate = sensorConfig.get_pollingRate() * 1000; // Convert to ms
+    // From the snapshot: no storage mutex from the sensor thread every pass
+    uint32_t pollingRate = ConfigSnapshot::read().pollingRateSec * 1000UL; // Convert to ms
     
   // Interrupt-driven sensors should be serviced on every pass through
   // the main loop regardless of pollingRate.
   if (_sensor->usesInterrupt() || pollingRate == 0) {
-    bool event = _sensor->loop();
-    if (event && sysStatus.get_verboseMode()) {
-      Log.info("SensorManager: event reported by interrupt-driven sensor");
+    size_t raw = _sensor->drain(_batch, MAX_BATCH);
+    if (discardWhileWarming(_warmUntilMs, _sensor, raw) || raw == 0) {
+      return 0;
+    }
+    size_t events = confirmEvents(_filter.apply(_batch, raw));
+#if COUNT_PATH_LOGGING
+    if (ConfigSnapshot::read().verboseMode) {
+      Log.info("SensorManager: %u event(s) reported by interrupt-driven sensor (%u filtered)",
+               (unsigned)events, (unsigned)(raw - events));
     }
-    return event;
+#endif
+    return events;
   }
     
     // Polling mode - check sensor at specified intervals
     if (currentTime - _lastPollTime >= pollingRate) {
         _lastPollTime = currentTime;
-        return _sensor->loop();
+        size_t raw = _sensor->drain(_batch, MAX_BATCH);
+        if (discardWhileWarming(_warmUntilMs, _sensor, raw) || raw == 0) {
+            return 0;
+        }
+        return confirmEvents(_filter.apply(_batch, raw));
     }
     
+    return 0;
+}
+
+size_t SensorManager::confirmEvents(size_t events) {
+  if (!_confirm || events == 0) {
+    return events;
+  }
+  // One burst for the batch: its events are from the same pass, and a
+  // person or vehicle stays in view far longer than the burst takes
+  if (!_confirm->isReady() || !_confirm->loop()) {
+    _fusion.failed += events;
+    return events;
+  }
+  const SensorData& range = _confirm->getData();
+  if (range.flag1 && range.primary <= FUSION_RANGE_CM) {
+    _fusion.confirmed += events;
+    return events;
+  }
+  _fusion.rejected += events;
+  if (ConfigSnapshot::read().verboseMode) {
+    Log.info("Fusion: %u event(s) rejected, nearest target %u cm (%lu rejected so far)",
+             (unsigned)events, range.flag1 ? (unsigned)range.primary : 0U, (unsigned long)_fusion.rejected);
+  }
+  return 0;
+}
+
+void SensorManager::prepareForNap() {
+  SENSOR_GUARD();
+  _tmp112Due = true;    // Fresh reading after the nap
+  if (_sensor) {
+    _sensor->armWakeCapture();
+  }
+}
+
+void SensorManager::ingestWakeEvent(uint32_t wakeMs) {
+  SENSOR_GUARD();
+  _wakeMarkMs = wakeMs;
+  _wakeMarkPending = true;
+
+  if (_sensor && _sensor->injectWakeEvent()) {
+    _wakeLatency.injected++;
+    Log.info("SensorManager: wake edge not seen by ISR; injected into event queue");
+  }
+}
+
+bool SensorManager::beginSleepEdgeCount() {
+#if EDGE_COUNT_IN_SLEEP || SENSOR_DRIVER_RAIN_BUCKET
+  SENSOR_GUARD();
+  if (!_sensor || !EdgeCounter::supported() || !_sensor->releaseInterruptPin()) {
+    return false;
+  }
+  if (!EdgeCounter::arm(intPin)) {
+    _sensor->reclaimInterruptPin();
+    return false;
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+uint32_t SensorManager::endSleepEdgeCount() {
+  SENSOR_GUARD();
+  if (!EdgeCounter::armed()) {
+    return 0;
+  }
+  uint32_t edges = EdgeCounter::disarm();
+  if (_sensor) {
+    _sensor->reclaimInterruptPin();
+  }
+  return edges;
+}
+
+uint32_t SensorManager::filterSleepEdges(uint32_t edges, uint32_t spanMs) {
+  SENSOR_GUARD();
+  return _filter.capEdgeCount(edges, spanMs);
+}
+
+bool SensorManager::sensorCountsEdgesInSleep() const {
+  return _sensor && _sensor->countsEdgesInSleep();
+}
+
+bool SensorManager::hasWakeSource() const {
+  for (size_t slot = 0; slot <= _auxCount; slot++) {
+    ISensor* sensor = slot == 0 ? _sensor : _aux[slot - 1].sensor;
+    uint32_t warmUntilMs = slot == 0 ? _warmUntilMs : _aux[slot - 1].warmUntilMs;
+    if (sensor && sensor->isHealthy() && !warmingUp(warmUntilMs) &&
+        sensor->wakeSource().kind != WakeSource::NONE) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool SensorManager::addWakeSources(SystemSleepConfiguration& config, bool edgeCounting) const {
+  bool added = false;
+  for (size_t slot = 0; slot <= _auxCount; slot++) {
+    ISensor* sensor = slot == 0 ? _sensor : _aux[slot - 1].sensor;
+    uint32_t warmUntilMs = slot == 0 ? _warmUntilMs : _aux[slot - 1].warmUntilMs;
+    if (!sensor || !sensor->isHealthy() || warmingUp(warmUntilMs)) {
+      continue;             // Not while the line storms or the sensor settles
+    }
+    WakeSource source = sensor->wakeSource();
+    if (source.kind == WakeSource::GPIO && !(edgeCounting && slot == 0)) {
+      config.gpio(source.pin, source.edge);
+      added = true;
+    }
+    WakeSource second = sensor->secondWakeSource();
+    if (second.kind == WakeSource::GPIO && !(edgeCounting && slot == 0)) {
+      config.gpio(second.pin, second.edge);
+      added = true;
+    }
+#if HAL_PLATFORM_NRF52840
+    if (source.kind == WakeSource::ANALOG) {
+      config.analog(source.pin, source.thresholdMv, source.crossing);
+      added = true;
+    }
+#endif
+  }
+  return added;
+}
+
+bool SensorManager::isSensorWakePin(pin_t pin) const {
+  if (pin == PIN_INVALID) {
+    return false;
+  }
+  for (size_t slot = 0; slot <= _auxCount; slot++) {
+    ISensor* sensor = slot == 0 ? _sensor : _aux[slot - 1].sensor;
+    if (sensor && sensor->wakeSource().kind != WakeSource::NONE && sensor->wakeSource().pin == pin) {
+      return true;
+    }
+    if (sensor && sensor->secondWakeSource().kind != WakeSource::NONE && sensor->secondWakeSource().pin == pin) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void SensorManager::noteSleepEdges(uint32_t edges, time_t start, uint32_t seconds) {
+  SENSOR_GUARD();
+  if (_sensor) {
+    _sensor->noteSleepEdges(edges, start, seconds);
+  }
+}
+
+bool SensorManager::injectEdge() {
+  SENSOR_GUARD();
+  return _sensor && _sensor->isReady() && _sensor->injectEdge();
+}
+
+uint16_t SensorManager::takePeople() {
+  SENSOR_GUARD();
+  if (!_sensor) {
+    return 0;
+  }
+  uint16_t people = _sensor->takePeople();
+  return warmingUp(_warmUntilMs) ? 0 : people;
+}
+
+void SensorManager::noteEventsApplied() {
+  SENSOR_GUARD();
+  if (!_wakeMarkPending) {
+    return;
+  }
+  _wakeMarkPending = false;
+
+  uint32_t latency = millis() - _wakeMarkMs;
+  _wakeLatency.lastMs = latency;
+  if (latency > _wakeLatency.maxMs) {
+    _wakeLatency.maxMs = latency;
+  }
+  _wakeLatency.samples++;
+#if COUNT_PATH_LOGGING
+  Log.info("Wake-to-count latency: %lu ms (max %lu ms over %lu wakes)",
+           (unsigned long)latency, (unsigned long)_wakeLatency.maxMs,
+           (unsigned long)_wakeLatency.samples);
+#endif
+}
+
+bool SensorManager::addAuxSensor(ISensor* sensor, uint32_t periodMs, bool counts) {
+  SENSOR_GUARD();
+  if (!sensor) {
+    Log.error("Attempted to add null aux sensor");
+    return false;
+  }
+  if (_auxCount >= MAX_AUX_SENSORS) {
+    Log.error("Aux sensor table full; cannot add %s", sensor->getSensorType());
+    return false;
+  }
+  if (!sensor->initializeHardware()) {
+    Log.error("Aux sensor %s hardware initialization failed", sensor->getSensorType());
+    return false;
+  }
+
+  AuxSlot &slot = _aux[_auxCount++];
+  slot.sensor = sensor;
+  slot.periodMs = periodMs;
+  slot.nextDueMs = millis();   // First poll on the next loop pass
+  slot.counts = counts;
+  slot.warmUntilMs = warmupEnd(sensor);
+  slot.fresh = false;
+  if (counts) {
+    slot.filter.loadConfig();
+    slot.filter.reset();
+  }
+  updateNextAuxDue();
+
+  Log.info("Aux sensor added: %s (period %lu ms%s)", sensor->getSensorType(), (unsigned long)periodMs,
+           counts ? ", counting" : "");
+  return true;
+}
+
+void SensorManager::addConfiguredAux(int type, uint32_t periodMs, bool counts) {
+  if (type < 0) {
+    return;
+  }
+  ISensor* sensor = SensorFactory::createSensor(static_cast<SensorType>(type));
+  bool registered = (sensor == _sensor);
+  for (size_t i = 0; i < _auxCount; i++) {
+    registered = registered || (_aux[i].sensor == sensor);
+  }
+  if (!sensor) {
+    Log.error("SensorFactory failed for aux type %d", type);
+  } else if (!registered) {
+    addAuxSensor(sensor, periodMs, counts);
+  }
+}
+
+size_t SensorManager::takeAuxReadings(uint16_t* values, bool* valid) {
+  SENSOR_GUARD();
+  size_t taken = 0;
+  for (size_t i = 0; i < _auxCount; i++) {
+    AuxSlot &slot = _aux[i];
+    valid[1 + i] = slot.fresh;
+    if (slot.fresh) {
+      values[1 + i] = slot.reading;
+      slot.fresh = false;
+      taken++;
+    }
+  }
+  return taken;
+}
+
+// Returned by reference when no sensor is available.
+static const SensorData emptySensorData;
+
+const SensorData& SensorManager::getAuxSensorData(size_t index) const {
+  if (index < _auxCount && _aux[index].sensor) {
+    return _aux[index].sensor->getData();
+  }
+  return emptySensorData;
+}
+
+size_t SensorManager::pollAuxSensors(uint32_t nowMs, SensorEvent* out, size_t max) {
+  // Signed difference handles millis() wrap.
+  if ((int32_t)(nowMs - _nextAuxDueMs) < 0) {
+    return 0;
+  }
+
+  size_t events = 0;
+  for (size_t i = 0; i < _auxCount; i++) {
+    AuxSlot &slot = _aux[i];
+    if ((int32_t)(nowMs - slot.nextDueMs) < 0) {
+      continue;
+    }
+    if (slot.counts) {
+      if (events == max) {
+        continue;   // Batch full; its events wait in the driver for the next pass
+      }
+      if (slot.sensor->isReady()) {
+        size_t raw = slot.sensor->drain(out + events, max - events);
+        bool discard = discardWhileWarming(slot.warmUntilMs, slot.sensor, raw);
+        size_t accepted = (raw && !discard) ? slot.filter.apply(out + events, raw) : 0;
+        for (size_t j = 0; j < accepted; j++) {
+          out[events + j].setSource((uint8_t)(1 + i));
+        }
+        events += accepted;
+      }
+    } else if (slot.sensor->isReady() && slot.sensor->loop()) {
+      slot.reading = slot.sensor->getData().primary;
+      slot.fresh = true;
+    }
+    // Schedule from the current time so a long stall doesn't trigger a
+    // catch-up burst of polls.
+    slot.nextDueMs = nowMs + slot.periodMs;
+  }
+  updateNextAuxDue();
+  return events;
+}
+
+void SensorManager::updateNextAuxDue() {
+  if (_auxCount == 0) {
+    return;
+  }
+  uint32_t now = millis();
+  uint32_t earliest = _aux[0].nextDueMs;
+  for (size_t i = 1; i < _auxCount; i++) {
+    if ((int32_t)(_aux[i].nextDueMs - now) < (int32_t)(earliest - now)) {
+      earliest = _aux[i].nextDueMs;
+    }
+  }
+  _nextAuxDueMs = earliest;
+}
+
+uint32_t SensorManager::msUntilWarm() const {
+  uint32_t now = millis();
+  uint32_t wait = 0;
+  for (size_t slot = 0; slot <= _auxCount; slot++) {
+    uint32_t warmUntilMs = slot == 0 ? _warmUntilMs : _aux[slot - 1].warmUntilMs;
+    if (warmingUp(warmUntilMs) && warmUntilMs - now > wait) {
+      wait = warmUntilMs - now;
+    }
+  }
+  return wait;
+}
+
+uint32_t SensorManager::warmupEnd(const ISensor* sensor) {
+  uint32_t warmupMs = sensor->warmupMs();
+  if (warmupMs == 0) {
+    return 0;
+  }
+  Log.info("Sensor %s warming up for %lu ms; its events are discarded", sensor->getSensorType(),
+           (unsigned long)warmupMs);
+  return (millis() + warmupMs) | 1;    // 0 means settled
+}
+
+bool SensorManager::warmingUp(uint32_t untilMs) {
+  return untilMs != 0 && (int32_t)(millis() - untilMs) < 0;
+}
+
+bool SensorManager::discardWhileWarming(uint32_t& untilMs, const ISensor* sensor, size_t raw) {
+  if (untilMs == 0) {
     return false;
+  }
+  if (warmingUp(untilMs)) {
+    _warmupDiscarded += raw;
+    return true;
+  }
+  Log.info("Sensor %s settled; %lu event(s) discarded during warm-up", sensor->getSensorType(),
+           (unsigned long)_warmupDiscarded);
+  untilMs = 0;
+  _warmupDiscarded = 0;
+  return false;
+}
+
+uint32_t SensorManager::msUntilNextPoll() const {
+  uint32_t now = millis();
+  uint32_t wait = UINT32_MAX;
+
+  if (ConfigSnapshot::read().countingMode == SCHEDULED) {
+    return wait;   // ScheduledSampler's boundaries, not ours
+  }
+
+  if (_auxCount > 0) {
+    int32_t remaining = (int32_t)(_nextAuxDueMs - now);
+    wait = remaining > 0 ? (uint32_t)remaining : 0;
+  }
+
+  if (_sensor && _sensor->isReady() && !_sensor->usesInterrupt()) {
+    uint32_t pollingRate = ConfigSnapshot::read().pollingRateSec * 1000UL;
+    uint32_t elapsed = now - _lastPollTime;
+    uint32_t primaryWait = (elapsed >= pollingRate) ? 0 : pollingRate - elapsed;
+    if (primaryWait < wait) {
+      wait = primaryWait;
+    }
+  }
+  return wait;
 }
 
-SensorData SensorManager::getSensorData() const {
+const SensorData& SensorManager::getSensorData() const {
     if (_sensor) {
         return _sensor->getData();
     }
-    return SensorData();
+    return emptySensorData;
 }
 
 bool SensorManager::isSensorReady() const {
     return _sensor && _sensor->isReady();
 }
 
+bool SensorManager::isSensorHealthy() const {
+    return !_sensor || _sensor->isHealthy();
+}
+
+SensorManager::SensorHealth SensorManager::sensorHealth(size_t slot) const {
+    ISensor* sensor = nullptr;
+    if (slot == 0) {
+        sensor = _sensor;
+    } else if (slot - 1 < _auxCount) {
+        sensor = _aux[slot - 1].sensor;
+    }
+    if (!sensor) {
+        return HEALTH_ABSENT;
+    }
+    if (!sensor->isHealthy()) {
+        return HEALTH_FAULT;
+    }
+    return sensor->isReady() ? HEALTH_OK : HEALTH_NOT_READY;
+}
+
+bool SensorManager::sampleSlot(size_t slot, uint16_t& value) {
+    SENSOR_GUARD();
+    ISensor* sensor = nullptr;
+    if (slot == 0) {
+        sensor = _sensor;
+    } else if (slot - 1 < _auxCount) {
+        sensor = _aux[slot - 1].sensor;
+    }
+    if (!sensor || !sensor->isReady() || !sensor->loop()) {
+        return false;
+    }
+    value = sensor->getData().primary;
+    return true;
+}
+
+bool SensorManager::isSensorBusy() const {
+    return _sensor && _sensor->isBusy();
+}
+
+void SensorManager::checkSensorHealth() {
+    bool healthy = _sensor->isHealthy();
+    if (healthy == _sensorHealthy) {
+        return;
+    }
+    _sensorHealthy = healthy;
+    if (!healthy) {
+        current.raiseAlert(24); // Alert code 24: sensor fault (interrupt storm)
+    } else if (current.isAlertActive(24)) {
+        Log.info("Sensor healthy again; clearing alert 24");
+        current.clearAlert(24);
+    }
+}
+
 void SensorManager::onEnterSleep() {
+  SENSOR_GUARD();
+  for (size_t i = 0; i < _auxCount; i++) {
+    _aux[i].sensor->onSleep();
+  }
+  if (_confirm) {
+    _confirm->onSleep();
+  }
+
   if (_sensor) {
     Log.info("SensorManager onEnterSleep: notifying sensor %s", _sensor->getSensorType());
     _sensor->onSleep();
     return;
   }
 
-  // If a concrete sensor hasn't been initialized (common when booting while
-  // outside open hours), still force the carrier sensor power rails off.
-  Log.info("SensorManager onEnterSleep: no sensor instance; forcing sensor power rails OFF");
-  pinMode(disableModule, OUTPUT);
-  pinMode(ledPower, OUTPUT);
-  digitalWrite(disableModule, HIGH); // active-low enable
-  digitalWrite(ledPower, HIGH);      // active-low LED power
+  // No concrete sensor yet (common when booting while outside open hours):
+  // nothing holds the sensor domains, so PowerDomains keeps them off.
+  Log.info("SensorManager onEnterSleep: no sensor instance; sensor power domains %s",
+           PowerDomains::isOn(PowerDomains::SENSOR) ? "still held" : "off");
 }
 
 void SensorManager::onExitSleep() {
+  SENSOR_GUARD();
   if (_sensor) {
     Log.info("SensorManager onExitSleep: waking sensor %s", _sensor->getSensorType());
+    bool wasReady = _sensor->isReady();   // Still powered after a daytime nap
     if (!_sensor->onWake()) {
       Log.error("Sensor %s failed to wake correctly", _sensor->getSensorType());
     }
+    if (!wasReady && _sensor->isReady()) {
+      _warmUntilMs = warmupEnd(_sensor);
+    }
     Log.info("SensorManager onExitSleep: sensorReady=%s", _sensor->isReady() ? "true" : "false");
   } else {
     Log.info("SensorManager onExitSleep: no sensor instance (sensorReady=false)");
   }
+
+  if (_confirm) {
+    _confirm->onWake();
+  }
+
+  uint32_t now = millis();
+  for (size_t i = 0; i < _auxCount; i++) {
+    bool wasReady = _aux[i].sensor->isReady();
+    if (!_aux[i].sensor->onWake()) {
+      Log.error("Aux sensor %s failed to wake correctly", _aux[i].sensor->getSensorType());
+    }
+    if (!wasReady && _aux[i].sensor->isReady()) {
+      _aux[i].warmUntilMs = warmupEnd(_aux[i].sensor);
+    }
+    // Poll each aux sensor once soon after wake rather than waiting out
+    // a period that mostly elapsed while asleep.
+    _aux[i].nextDueMs = now;
+  }
+  updateNextAuxDue();
 }
 
-float SensorManager::tmp36TemperatureC(int adcValue) {
+int16_t SensorManager::tmp36TempCenti(int adcValue) {
   // Analog inputs have values from 0-4095, or
   // 12-bit precision. 0 = 0V, 4095 = 3.3V, 0.0008 volts (0.8 mV) per unit
-  // The temperature sensor docs use millivolts (mV), so use 3300 as the factor
-  // instead of 3.3.
-  float mV = ((float)adcValue) * 3300 / 4095;
+  // The temperature sensor docs use millivolts (mV); in hundredths of a
+  // degree that is 10 per mV, so scale by 33000 rather than 3300.
+  int32_t centiMv = ((int32_t)adcValue * 33000 + 2047) / 4095;
 
   // According to the TMP36 docs:
   // Offset voltage 500 mV, scaling 10 mV/deg C, output voltage at 25C = 750 mV
@@ -159,10 +752,10 @@ float SensorManager::tmp36TemperatureC(int adcValue) {
   // Vcc | Analog Out | Ground
   // You must put a 0.1 uF capacitor between the analog output and ground or
   // you'll get crazy inaccurate values!
-  return (mV - 500) / 10;
+  return (int16_t)(centiMv - 5000);
 }
 
-bool SensorManager::readTmp112TemperatureC(float &tempC) {
+bool SensorManager::readTmp112TempCenti(int16_t &tempCenti) {
   // TMP112A default 7-bit I2C address is 0x48.
   // Allow override at compile time for unusual board strapping.
 #if defined(MUON_TMP112_I2C_ADDR)
@@ -205,12 +798,26 @@ bool SensorManager::readTmp112TemperatureC(float &tempC) {
     raw = (int16_t)(raw | 0xF000);
   }
 
-  tempC = ((float)raw) * 0.0625f;
+  // 6.25 hundredths per LSB, rounded half away from zero
+  tempCenti = (int16_t)((raw * 25 + (raw < 0 ? -2 : 2)) / 4);
   return true;
 }
 
 namespace {
 
+#if defined(MUON_TMP112_I2C_ADDR)
+const uint8_t tmp112Addr = (uint8_t)MUON_TMP112_I2C_ADDR;
+#else
+const uint8_t tmp112Addr = 0x48;
+#endif
+
+// TMP112A configuration register (0x01), first byte: OS starts a one-shot
+// conversion, SD keeps the part shut down (about 0.5 uA) between them.
+// Second byte 0xA0 is the power-on default (4 Hz rate, normal mode).
+const uint8_t TMP112_CONFIG_SD = 0x61;
+const uint8_t TMP112_CONFIG_OS_SD = 0xE1;
+const uint32_t TMP112_CONVERSION_MS = 35;   // 26 ms typical, 35 ms max
+
 bool probeTmp112Present(uint8_t addr) {
   // Probe device presence without changing its configuration.
   Wire.lock();
@@ -220,239 +827,131 @@ bool probeTmp112Present(uint8_t addr) {
   return status == 0;
 }
 
+bool writeTmp112Config(uint8_t addr, uint8_t config) {
+  Wire.lock();
+  Wire.beginTransmission(addr);
+  Wire.write((uint8_t)0x01);
+  Wire.write(config);
+  Wire.write((uint8_t)0xA0);
+  int status = Wire.endTransmission();
+  Wire.unlock();
+  return status == 0;
+}
+
 } // namespace
 
-bool SensorManager::batteryState() {
+bool SensorManager::temperatureTask() {
+  SensorManager &self = instance();
+  if (!self._tmp112Probed) {
+    self._tmp112Probed = true;
+#if defined(MUON_HAS_TMP112)
+    Wire.begin();
+    self._tmp112Present = true;
+#elif !defined(DISABLE_TMP112_AUTODETECT)
+    // Safe to call multiple times; ensures I2C is initialized even if nothing
+    // else has yet started Wire.
+    Wire.begin();
+    self._tmp112Present = probeTmp112Present(tmp112Addr);
+    if (sysStatus.get_verboseMode()) {
+      Log.info("TMP112A probe at 0x%02X: %s", tmp112Addr, self._tmp112Present ? "present" : "not found");
+    }
+#endif
+    if (self._tmp112Present) {
+      writeTmp112Config(tmp112Addr, TMP112_CONFIG_SD);
+    }
+  }
+  if (!self._tmp112Present) {
+    return true;
+  }
 
-#if HAL_PLATFORM_CELLULAR || PLATFORM_ID == PLATFORM_ARGON
-  // Boron (cellular) and Argon (Wi-Fi) Gen 3 devices:
-  // Use built-in System battery APIs backed by the fuel gauge
-  // (and a BQ24195 PMIC on Boron only).
-  uint8_t battState = System.batteryState();
-  float soc = System.batteryCharge();
-  int powerSource = System.powerSource();
-  
-  // Log battery diagnostics to help identify charging state issues
-  Log.info("Battery: state=%s (%d), SoC=%.2f%%, powerSource=%d", 
-           batteryContext[battState], battState, (double)soc, powerSource);
-  
-  current.set_batteryState(battState);
-  current.set_stateOfCharge(soc);
-
-#if HAL_PLATFORM_CELLULAR && (PLATFORM_ID != PLATFORM_MSOM)
-  // =========================================================================
-  // PMIC Health Monitoring & Smart Remediation (BQ24195 PMIC)
-  // =========================================================================
-  // Supported platforms: Boron (Gen 3 cellular with BQ24195 PMIC)
-  // Excluded platforms: M-SoM/Muon (uses Particle Power Module with MAX17043, not BQ24195)
-  // 
-  // Detects charging faults (1Hz amber LED = fault register set) and attempts
-  // automatic recovery with escalating remediation levels to prevent thrashing.
-  //
-  // Alert Codes (auto-reported via webhook):
-  //   20 = PMIC Thermal Shutdown (critical - charging stopped due to temp)
-  //   21 = PMIC Charge Timeout (critical - safety timer expired, stuck charging)
-  //   23 = PMIC Battery Fault (major - general charging issue)
-  //
-  // Log-Only Diagnostics (NOT alerted - transient/normal conditions):
-  //   Input Fault: VBUS out of range (solar undervoltage common, backend detects sustained issues)
-  //
-  // Remediation Strategy:
-  //   Level 0: Monitor only (log diagnostics, raise alert)
-  //   Level 1: Soft reset (cycle charging off/on after 2+ consecutive faults)
-  //   Level 2: Power cycle with watchdog (after 3+ consecutive faults)
-  //   Cooldown: 1 hour minimum between remediation attempts
-  //   Auto-Clear: Resets all counters when charging returns to healthy state
-  //
-  // This prevents the common "loss of charge until power cycle" issue by
-  // detecting PMIC faults early and automatically attempting recovery before
-  // requiring manual intervention.
-  // =========================================================================
-  
-  // PMIC health monitoring (BQ24195 PMIC - Boron only)
-  // Tracks charging faults and attempts smart remediation with escalation
-  static unsigned long lastRemediationAttempt = 0;
-  static uint8_t remediationLevel = 0; // 0=none, 1=soft reset, 2=power cycle
-  static uint8_t consecutiveFaults = 0;
-  const unsigned long REMEDIATION_COOLDOWN = 3600000; // 1 hour between attempts
-  
-  // Check if charging is intentionally disabled due to temperature BEFORE attempting remediation
-  bool safeToCharge = isItSafeToCharge();
-  
-  PMIC pmic(true); // true = lock I2C during operations
-  
-  // Read REG09 (Fault Register)
-  byte faultReg = pmic.readFaultRegister();
-  
-  // Check for charging faults (bits 3-5: CHRG_FAULT)
-  if (faultReg & 0x38) {
-    uint8_t chargeFault = (faultReg >> 3) & 0x07;
-    consecutiveFaults++;
-    
-    switch(chargeFault) {
-      case 0x01: // Input fault (VBUS overvoltage or undervoltage)
-        // This triggers when VIN < powerSourceMinVoltage (5.08V) or > max
-        // Most common cause: obscured/faulty solar panel insufficient voltage
-        // LOG ONLY - transient voltage dips are normal (clouds, trees, dawn/dusk)
-        // Backend detects sustained panel failures via multi-day SoC decline
-        Log.info("PMIC: Input fault - VBUS out of range (likely solar variation)");
-        break;
-      case 0x02: // Thermal shutdown
-        Log.error("PMIC: Thermal shutdown - charging stopped due to temperature");
-        current.raiseAlert(20); // Alert code 20: PMIC Thermal (critical)
-        break;
-      case 0x03: // Charge safety timer expired
-        Log.error("PMIC: Charge safety timer expired - charging timeout (common stuck charging indicator)");
-        current.raiseAlert(21); // Alert code 21: PMIC Charge Timeout (critical)
-        break;
-      default:
-        Log.warn("PMIC: Charge fault detected (code=0x%02x)", chargeFault);
-        current.raiseAlert(23); // Alert code 23: PMIC Battery Fault
-        break;
+  uint32_t nowMs = millis();
+  if (self._tmp112Converting) {
+    if (nowMs - self._tmp112StartMs < TMP112_CONVERSION_MS) {
+      return true;
     }
-    
-    // Smart remediation with escalation and thrash prevention
-    // CRITICAL SAFETY CHECK: Never attempt remediation if charging is disabled due to temperature
-    if (!safeToCharge) {
-      Log.info("PMIC: Fault detected but charging disabled due to temperature (%.1fC) - skipping remediation", 
-               (double)current.get_internalTempC());
-      // Don't escalate fault counters when temperature is the issue
-      // Temperature will recover naturally without intervention
+    // Back in shutdown on its own once the one-shot is done
+    self._tmp112Converting = false;
+    int16_t tempCenti;
+    if (self.readTmp112TempCenti(tempCenti) && tempCenti > -5000 && tempCenti < 12000) {
+      self._tmp112TempCenti = tempCenti;
+      self._tmp112Valid = true;
     } else {
-      unsigned long now = millis();
-      if (now - lastRemediationAttempt > REMEDIATION_COOLDOWN) {
-        // Escalate remediation level based on consecutive faults
-        if (consecutiveFaults >= 3 && remediationLevel < 2) {
-          remediationLevel = 2; // Escalate to power cycle reset
-        } else if (consecutiveFaults >= 2 && remediationLevel < 1) {
-          remediationLevel = 1; // Escalate to disable/enable charging
-        }
-        
-        // Apply remediation based on level
-        switch(remediationLevel) {
-          case 1:
-            Log.warn("PMIC: Attempting soft remediation - cycle charging (level 1)");
-            pmic.disableCharging();
-            delay(500);
-            pmic.enableCharging();
-            Log.info("PMIC: Charging re-enabled after soft reset");
-            break;
-            
-          case 2:
-            Log.error("PMIC: Attempting aggressive remediation - power cycle reset (level 2)");
-            pmic.disableCharging();
-            delay(1000);
-            // Set watchdog to force reset in 10 seconds if charging doesn't recover
-            pmic.setWatchdog(0b01); // 40 seconds
-            pmic.enableCharging();
-            Log.info("PMIC: Charging re-enabled with watchdog supervision");
-            remediationLevel = 0; // Reset level after power cycle attempt
-            break;
-            
-          default:
-            Log.info("PMIC: Fault detected but remediation level 0 - monitoring only");
-            break;
-        }
-        
-        lastRemediationAttempt = now;
-      } else {
-        unsigned long remainingCooldown = (REMEDIATION_COOLDOWN - (now - lastRemediationAttempt)) / 60000;
-        Log.info("PMIC: Fault detected but in cooldown period (%lu min remaining)", remainingCooldown);
-      }
-    }
-  } else {
-    // No faults detected - clear counters if charging is healthy
-    if (consecutiveFaults > 0) {
-      Log.info("PMIC: Charging healthy - clearing fault counters");
-      consecutiveFaults = 0;
-      remediationLevel = 0;
-      
-      // Clear PMIC-related alerts if they were active
-      int8_t currentAlert = current.get_alertCode();
-      if (currentAlert >= 20 && currentAlert <= 23) {
-        Log.info("PMIC: Clearing battery/charging alert %d - charging resumed", currentAlert);
-        current.set_alertCode(0);
-        current.set_lastAlertTime(0);
-      }
+      Log.warn("TMP112A read failed/invalid");
     }
+    self._tmp112ReadMs = nowMs;
+    return true;
   }
-  
-  // Read REG08 (System Status Register) for additional diagnostics
-  byte systemStatus = pmic.readSystemStatusRegister();
-  uint8_t chargeStatus = (systemStatus >> 4) & 0x03;
-  bool vbusGood = (systemStatus & 0x80) != 0;
-  uint8_t thermalStatus = systemStatus & 0x03;
-  
-  const char* chargeStatusStr[] = {"Not Charging", "Pre-charge", "Fast Charging", "Charge Done"};
-  const char* thermalStr[] = {"Normal", "Warm", "Hot", "Cold"};
-  
-  Log.info("PMIC Status: charge=%s, VBUS=%s, thermal=%s, faultReg=0x%02x",
-           chargeStatusStr[chargeStatus],
-           vbusGood ? "Good" : "Fault",
-           thermalStr[thermalStatus],
-           faultReg);
-  
-  // Detect stuck charging state (charging for >6 hours at same SoC)
-  static uint8_t lastChargeStatus = 0xFF;
-  static float lastSoC = -1.0f;
-  static unsigned long chargeStateStartTime = 0;
-  
-  if (chargeStatus == 2) { // Fast Charging
-    if (lastChargeStatus == 2) {
-      // Still in fast charging
-      if (abs(soc - lastSoC) < 1.0f) { // SoC not increasing
-        if (chargeStateStartTime == 0) {
-          chargeStateStartTime = millis();
-        } else if (millis() - chargeStateStartTime > 6UL * 3600000UL) { // 6 hours
-          Log.error("PMIC: Stuck in Fast Charging for 6+ hours with no SoC increase (%.1f%%) - possible fault", (double)soc);
-          current.raiseAlert(21); // Charge timeout alert
-        }
-      } else {
-        chargeStateStartTime = 0; // SoC increasing, reset timer
-      }
+  if (self._tmp112Due || nowMs - self._tmp112ReadMs >= TMP112_INTERVAL_SEC * 1000UL || !self._tmp112ReadMs) {
+    self._tmp112Due = false;
+    if (writeTmp112Config(tmp112Addr, TMP112_CONFIG_OS_SD)) {
+      self._tmp112Converting = true;
+      self._tmp112StartMs = nowMs;
     } else {
-      chargeStateStartTime = millis(); // Just entered fast charging
+      self._tmp112ReadMs = nowMs;   // Try again next interval
     }
+  }
+  return true;
+}
+
+const char *SensorManager::batteryStateName(uint8_t state) {
+  return (state < sizeof(batteryContext) / sizeof(batteryContext[0])) ? batteryContext[state] : batteryContext[0];
+}
+
+// [static] battery_state / power_source system event: refresh the snapshot on next use
+void SensorManager::powerEventHandler(system_event_t event, int param) {
+  instance()._powerChanged = true;
+}
+
+bool SensorManager::refreshPowerSnapshot() {
+  uint32_t nowMs = millis();
+  if (_power.valid && !_powerChanged && nowMs - _power.takenMs < POWER_SNAPSHOT_TTL_SEC * 1000UL) {
+    return false;
+  }
+  _powerChanged = false;
+  _power.valid = true;
+  _power.takenMs = nowMs;
+  _chargeDecisionApplied = false;   // PMIC registers may have been reset since
+
+  Platform::BatteryReading reading;
+  if (!Platform::This::readBattery(reading)) {
+    return true;   // No battery readings on this platform; fields unchanged
+  }
+  _power.batteryState = reading.batteryState;
+  _power.socTenths = reading.socTenths;
+  _power.powerSource = reading.powerSource;
+
+  // Log battery diagnostics to help identify charging state issues
+  if constexpr (Platform::This::SOC_FROM_VOLTAGE) {
+    Log.info("Battery: voltage=%sV, state=%s (%d), SoC=%s%% (estimated from voltage)",
+             Payload::Scaled(reading.millivolts, 3).c_str(), batteryStateName(reading.batteryState),
+             reading.batteryState, Payload::Scaled(reading.socTenths, 1).c_str());
   } else {
-    chargeStateStartTime = 0; // Not charging or charge done
-  }
-  
-  lastChargeStatus = chargeStatus;
-  lastSoC = soc;
-#endif // HAL_PLATFORM_CELLULAR && (PLATFORM_ID != PLATFORM_MSOM)
-
-#elif PLATFORM_ID == 32 || PLATFORM_ID == 34
-  // Photon 2 and P2:
-  // Measure battery voltage (VBAT_MEAS on Photon 2, or same pin on P2
-  // carrier) using A6 as described in the Photon 2 battery voltage docs.
-
-  int raw = analogRead(A6);
-  float voltage = raw / 819.2f; // Map ADC count (0-4095) to 0-5V
-
-  // Approximate state-of-charge from voltage for a LiPo battery.
-  // Treat 3.0V as 0% and 4.2V as 100%.
-  float soc = (voltage - 3.0f) * (100.0f / (4.2f - 3.0f));
-  if (soc < 0.0f) {
-    soc = 0.0f;
-  } else if (soc > 100.0f) {
-    soc = 100.0f;
-  }
-  current.set_stateOfCharge(soc);
-
-  // Photon 2/P2 cannot reliably determine charging state without a PMIC.
-  // Always report "Unknown" since voltage alone can't distinguish between
-  // charging and discharging at the same voltage level.
-  uint8_t battState = 0; // Unknown
-  
-  // Log battery diagnostics (Photon 2/P2 voltage-based estimation)
-  Log.info("Battery: voltage=%.2fV, state=%s (%d), SoC=%.2f%% (estimated from voltage)", 
-           (double)voltage, batteryContext[battState], battState, (double)soc);
-  
-  current.set_batteryState(battState);
+    Log.info("Battery: state=%s (%d), SoC=%s%%, powerSource=%d",
+             batteryStateName(reading.batteryState), reading.batteryState,
+             Payload::Scaled(reading.socTenths, 1).c_str(), reading.powerSource);
+  }
 
-#else
-  // Other Wi-Fi / SoM platforms: leave battery fields unchanged for now.
-#endif
+  current.set_batteryState(reading.batteryState);
+  current.set_socTenths(reading.socTenths);
+
+  if constexpr (Platform::This::CHARGER_FAULTS) {
+    // Check charging is not intentionally disabled for temperature before any remediation
+    Platform::ChargerStatus charger;
+    Platform::This::checkCharger(reading.socTenths, isItSafeToCharge(), charger);
+    _power.faultReg = charger.faultReg;
+    _power.systemStatus = charger.systemStatus;
+  }
+  return true;
+}
+
+bool SensorManager::batteryState() {
+  if constexpr (Platform::This::CHARGE_CONTROL) {
+    if (!refreshPowerSnapshot()) {
+      current.set_batteryState(_power.batteryState);   // isItSafeToCharge() may have set "Not Charging"
+    }
+  } else {
+    refreshPowerSnapshot();
+  }
 
   // -------------------------------------------------------------------------
   // Temperature source selection
@@ -464,144 +963,119 @@ bool SensorManager::batteryState() {
   // Compile-time controls:
   //  - Define MUON_HAS_TMP112 to force enable the TMP112A path.
   //  - Define DISABLE_TMP112_AUTODETECT to skip probing for TMP112A.
+  //
+  // The probe and the TMP112A conversions run in temperatureTask(); this
+  // only takes its latest reading, so there is no I2C here.
 
-#if defined(MUON_TMP112_I2C_ADDR)
-  const uint8_t tmp112Addr = (uint8_t)MUON_TMP112_I2C_ADDR;
-#else
-  const uint8_t tmp112Addr = 0x48;
-#endif
-
-  static bool tmp112ProbeDone = false;
-  static bool tmp112Present = false;
-
-#if !defined(DISABLE_TMP112_AUTODETECT)
-  if (!tmp112ProbeDone) {
-    // Safe to call multiple times; ensures I2C is initialized even if nothing
-    // else has yet started Wire.
-    Wire.begin();
-    tmp112Present = probeTmp112Present(tmp112Addr);
-    tmp112ProbeDone = true;
-    if (sysStatus.get_verboseMode()) {
-      Log.info("TMP112A probe at 0x%02X: %s", tmp112Addr, tmp112Present ? "present" : "not found");
+  bool tmp112Present = _tmp112Present;
+  if (tmp112Present) {
+    int16_t tempCenti = _tmp112TempCenti;
+    if (!_tmp112Valid) {
+      int16_t prev = current.get_internalTempCenti();
+      tempCenti = (prev > -5000 && prev < 12000) ? prev : 2500;
     }
+    current.set_internalTempCenti(tempCenti);
   }
-#endif
 
-#if defined(MUON_HAS_TMP112)
-  tmp112Present = true;
-  tmp112ProbeDone = true;
-#endif
+  if constexpr (!Platform::This::TMP36) {
+    // Photon 2 and P2 development platforms:
+    // There is no TMP36 wired to an ADC-capable pin on the Photon 2 dev
+    // carrier, so we cannot take a real analog temperature reading here.
+    // Instead, use whatever value has been stored in internalTempCenti (for
+    // example, set manually for testing), falling back to 25C if unset.
 
-  if (tmp112Present) {
-    float tempC;
-    if (!readTmp112TemperatureC(tempC) || !(tempC > -50.0f && tempC < 120.0f)) {
-      float prev = current.get_internalTempC();
-      tempC = (prev > -50.0f && prev < 120.0f) ? prev : 25.0f;
-      Log.warn("TMP112A read failed/invalid - falling back to %4.2f C", (double)tempC);
+    int16_t tempCenti = current.get_internalTempCenti();
+    if (!(tempCenti > -5000 && tempCenti < 12000)) {
+      tempCenti = 2500;
     }
-    current.set_internalTempC(tempC);
-  }
-
-#if (PLATFORM_ID == 32 || PLATFORM_ID == 34) && !defined(MUON_HAS_TMP36)
-  // Photon 2 and P2 development platforms:
-  // There is no TMP36 wired to an ADC-capable pin on the Photon 2 dev
-  // carrier, so we cannot take a real analog temperature reading here.
-  // Instead, use whatever value has been stored in internalTempC (for
-  // example, set manually for testing), falling back to 25C if unset.
 
-  float tempC = current.get_internalTempC();
-  if (!(tempC > -50.0f && tempC < 120.0f)) {
-    tempC = 25.0f;
-  }
+    if (sysStatus.get_verboseMode()) {
+      Log.info("P2/Photon2 stub: using internalTempCenti=%s C (no TMP36 ADC)", Payload::Scaled(tempCenti, 2).c_str());
+    }
 
-  if (sysStatus.get_verboseMode()) {
-    Log.info("P2/Photon2 stub: using internalTempC=%4.2f C (no TMP36 ADC)", (double)tempC);
-  }
+    current.set_internalTempCenti(tempCenti);
+  } else {
+    // Measure enclosure temperature using the TMP36 on the carrier board
+    // (connected to TMP36_SENSE_PIN, typically A4).
+    // Non-blocking sampling: spread 8 samples across multiple batteryState()
+    // calls to avoid blocking the main loop. Each call takes one sample (~5µs ADC
+    // read) until all samples are collected, then computes the average.
+    if (tmp112Present) {
+      // TMP112A already provided a temperature this cycle; skip TMP36 sampling.
+      // This avoids unnecessary ADC activity on boards where both might exist.
+      isItSafeToCharge();
+      return current.get_socTenths() > 200;
+    }
+    pinMode(TMP36_SENSE_PIN, INPUT);
 
-  current.set_internalTempC(tempC);
+    const int TMP36_SAMPLES = 8;
+    static int sampleIndex = 0;     // Tracks how many samples taken this cycle
+    static int tmpRawSum = 0;       // Running sum of ADC readings
 
-#else
-  // Measure enclosure temperature using the TMP36 on the carrier board
-  // (connected to TMP36_SENSE_PIN, typically A4).
-  // Non-blocking sampling: spread 8 samples across multiple batteryState()
-  // calls to avoid blocking the main loop. Each call takes one sample (~5µs ADC
-  // read) until all samples are collected, then computes the average.
-  if (tmp112Present) {
-    // TMP112A already provided a temperature this cycle; skip TMP36 sampling.
-    // This avoids unnecessary ADC activity on boards where both might exist.
-    isItSafeToCharge();
-    return current.get_stateOfCharge() > 20.0f;
-  }
-  pinMode(TMP36_SENSE_PIN, INPUT);
-
-  const int TMP36_SAMPLES = 8;
-  static int sampleIndex = 0;     // Tracks how many samples taken this cycle
-  static int tmpRawSum = 0;       // Running sum of ADC readings
-
-  if (sampleIndex < TMP36_SAMPLES) {
-    // Take one ADC sample per call, accumulate into sum
-    int v = analogRead(TMP36_SENSE_PIN);
-    tmpRawSum += v;
-    sampleIndex++;
+    if (sampleIndex < TMP36_SAMPLES) {
+      // Take one ADC sample per call, accumulate into sum
+      int v = analogRead(TMP36_SENSE_PIN);
+      tmpRawSum += v;
+      sampleIndex++;
     
-    // Not done yet; use previous temperature value and return early.
-    // Caller can call batteryState() again on next loop to continue sampling.
-    return current.get_stateOfCharge() > 20.0f;
-  }
-
-  // All samples collected; compute average and reset for next cycle
-  int tmpRaw = tmpRawSum / TMP36_SAMPLES;
-  sampleIndex = 0;
-  tmpRawSum = 0;
-
-  // Consider extremely low readings as "sensor not present". With a TMP36,
-  // even very cold temperatures should still be around 100mV (roughly 120
-  // ADC counts on a 3.3V/12-bit ADC), so an average below ~50 counts is
-  // effectively 0V at the pin.
-  bool sensorOk = (tmpRaw > 50 && tmpRaw < 4000);
-  float tempC = tmp36TemperatureC(tmpRaw);
+      // Not done yet; use previous temperature value and return early.
+      // Caller can call batteryState() again on next loop to continue sampling.
+      return current.get_socTenths() > 200;
+    }
 
-  // If the TMP36 reading is clearly out of a plausible enclosure range
-  // (for example, -50C from a raw 0 reading), or the sensor appears to be
-  // disconnected, fall back to a prior stored value or a conservative
-  // default so that charging guard rails and telemetry still operate with
-  // a realistic value.
-  if (!sensorOk || tempC < -20.0f || tempC > 80.0f) {
-    float prev = current.get_internalTempC();
-    float fallback = 25.0f; // conservative room-temperature default
+    // All samples collected; compute average and reset for next cycle
+    int tmpRaw = tmpRawSum / TMP36_SAMPLES;
+    sampleIndex = 0;
+    tmpRawSum = 0;
+
+    // Consider extremely low readings as "sensor not present". With a TMP36,
+    // even very cold temperatures should still be around 100mV (roughly 120
+    // ADC counts on a 3.3V/12-bit ADC), so an average below ~50 counts is
+    // effectively 0V at the pin.
+    bool sensorOk = (tmpRaw > 50 && tmpRaw < 4000);
+    int16_t tempCenti = tmp36TempCenti(tmpRaw);
+
+    // If the TMP36 reading is clearly out of a plausible enclosure range
+    // (for example, -50C from a raw 0 reading), or the sensor appears to be
+    // disconnected, fall back to a prior stored value or a conservative
+    // default so that charging guard rails and telemetry still operate with
+    // a realistic value.
+    if (!sensorOk || tempCenti < -2000 || tempCenti > 8000) {
+      int16_t prev = current.get_internalTempCenti();
+      int16_t fallback = 2500; // conservative room-temperature default
+
+      if (prev > -2000 && prev < 8000) {
+        fallback = prev;
+      }
 
-    if (prev > -20.0f && prev < 80.0f) {
-      fallback = prev;
+      Log.warn("TMP36 reading invalid or out of range (tmp36=%s C, raw=%d, sensorOk=%s) - falling back to %s C",
+               Payload::Scaled(tempCenti, 2).c_str(), tmpRaw, sensorOk ? "true" : "false",
+               Payload::Scaled(fallback, 2).c_str());
+      tempCenti = fallback;
     }
 
-    Log.warn("TMP36 reading invalid or out of range (tmp36=%4.2f C, raw=%d, sensorOk=%s) - falling back to %4.2f C",
-             (double)tempC, tmpRaw, sensorOk ? "true" : "false", (double)fallback);
-    tempC = fallback;
-  }
-
-  current.set_internalTempC(tempC);
+    current.set_internalTempCenti(tempCenti);
 
-  // Optional debug: log enclosure temperature when verbose logging is enabled
-  if (sysStatus.get_verboseMode()) {
-    Log.info("Enclosure temperature (effective): %4.2f C (raw=%d)", (double)tempC, tmpRaw);
+    // Optional debug: log enclosure temperature when verbose logging is enabled
+    if (sysStatus.get_verboseMode()) {
+      Log.info("Enclosure temperature (effective): %s C (raw=%d)", Payload::Scaled(tempCenti, 2).c_str(), tmpRaw);
+    }
   }
 
-#endif // PLATFORM_ID == 32 || PLATFORM_ID == 34
-
   // Apply temperature-based charging guard rails (see reference implementation).
   // On cellular platforms this will enable/disable PMIC charging based on
-  // current.get_internalTempC(); on others it is a no-op.
+  // current.get_internalTempCenti(); on others it is a no-op.
   isItSafeToCharge();
 
   // Convenience: indicate whether battery is in a healthy range.
-  return current.get_stateOfCharge() > 20.0f;
+  return current.get_socTenths() > 200;
 }
 
 bool SensorManager::isItSafeToCharge() // Returns a true or false if the battery
                                        // is in a safe charging range based on
                                        // enclosure temperature
 {
-  float temp = current.get_internalTempC();
+  int16_t tempCenti = current.get_internalTempCenti();
   // Apply simple hysteresis around the recommended LiPo charge range
   // to avoid rapid toggling near the temperature boundaries. When
   // charging is currently allowed, we disable if temp < 0C or > 45C.
@@ -611,73 +1085,52 @@ bool SensorManager::isItSafeToCharge() // Returns a true or false if the battery
 
   bool safe;
   if (lastSafe) {
-    safe = !(temp < 0.0f || temp > 45.0f);
+    safe = !(tempCenti < 0 || tempCenti > 4500);
   } else {
-    safe = !(temp < 2.0f || temp > 43.0f);
+    safe = !(tempCenti < 200 || tempCenti > 4300);
   }
   lastSafe = safe;
 
-#if HAL_PLATFORM_CELLULAR
-  // On Boron (cellular Gen 3), a BQ24195 PMIC is available so we
-  // actually enable/disable charging based on the enclosure
-  // temperature.
-  PMIC pmic(true);
-
-  if (!safe) {
-    pmic.disableCharging();
-    current.set_batteryState(1); // Reflect that we are "Not Charging"
+  if constexpr (Platform::This::CHARGE_CONTROL) {
+    // On cellular Gen 3 (Boron, M-SoM) we actually enable/disable
+    // charging based on the enclosure temperature. The register is
+    // written when the decision changes, and again after each snapshot
+    // refresh in case the PMIC was reset.
+    if (!safe) {
+      current.set_batteryState(1); // Reflect that we are "Not Charging"
+    }
+    if (!_chargeDecisionApplied || safe != _chargeAllowedApplied) {
+      Platform::This::setCharging(safe);
 
-    Log.warn("Charging disabled due to enclosure temperature: %4.2f C", (double)temp);
+      if (!safe) {
+        Log.warn("Charging disabled due to enclosure temperature: %s C", Payload::Scaled(tempCenti, 2).c_str());
+      } else if (sysStatus.get_verboseMode()) {
+        Log.info("Charging enabled; enclosure temperature: %s C", Payload::Scaled(tempCenti, 2).c_str());
+      }
+      _chargeDecisionApplied = true;
+      _chargeAllowedApplied = safe;
+    }
   } else {
-    pmic.enableCharging();
-
-    if (sysStatus.get_verboseMode()) {
-      Log.info("Charging enabled; enclosure temperature: %4.2f C", (double)temp);
+    // On platforms without a PMIC API (such as Argon, Photon 2 / P2), we
+    // do not control charging, but we still evaluate and log whether it
+    // would be considered safe based on the same temperature range.
+    if (!safe) {
+      Log.warn("Charging would be disabled due to enclosure temperature: %s C (no PMIC on this platform)",
+               Payload::Scaled(tempCenti, 2).c_str());
+    } else if (sysStatus.get_verboseMode()) {
+      Log.info("Charging would be enabled; enclosure temperature: %s C (no PMIC on this platform)",
+               Payload::Scaled(tempCenti, 2).c_str());
     }
   }
-#else
-  // On platforms without a PMIC API (such as Argon, Photon 2 / P2), we
-  // do not control charging, but we still evaluate and log whether it
-  // would be considered safe based on the same temperature range.
-  if (!safe) {
-    Log.warn("Charging would be disabled due to enclosure temperature: %4.2f C (no PMIC on this platform)", (double)temp);
-  } else if (sysStatus.get_verboseMode()) {
-    Log.info("Charging would be enabled; enclosure temperature: %4.2f C (no PMIC on this platform)", (double)temp);
-  }
-#endif
 
   return safe;
 }
 
 void SensorManager::getSignalStrength() {
-  char signalStr[64];  // Declare outside platform-specific blocks
-  
-#if HAL_PLATFORM_CELLULAR
-  const char *radioTech[10] = {"Unknown",    "None",       "WiFi", "GSM",
-                               "UMTS",       "CDMA",       "LTE",  "IEEE802154",
-                               "LTE_CAT_M1", "LTE_CAT_NB1"};
-  // New Signal Strength capability -
-  // https://community.particle.io/t/boron-lte-and-cellular-rssi-funny-values/45299/8
-  CellularSignal sig = Cellular.RSSI();
-
-  auto rat = sig.getAccessTechnology();
-
-  // float strengthVal = sig.getStrengthValue();
-  float strengthPercentage = sig.getStrength();
-
-  // float qualityVal = sig.getQualityValue();
-  float qualityPercentage = sig.getQuality();
-
-  snprintf(signalStr, sizeof(signalStr), "%s S:%2.0f%%, Q:%2.0f%% ",
-           radioTech[rat], strengthPercentage, qualityPercentage);
-  Log.info(signalStr);
-#elif HAL_PLATFORM_WIFI
-  WiFiSignal sig = WiFi.RSSI();
-  float strengthPercentage = sig.getStrength();
-  float qualityPercentage = sig.getQuality();
-  
-  snprintf(signalStr, sizeof(signalStr), "WiFi S:%2.0f%%, Q:%2.0f%% ",
-           strengthPercentage, qualityPercentage);
-  Log.info(signalStr);
-#endif
+  char signalStr[64];
+  float strength = -1.0f;
+  if (Platform::This::signalText(signalStr, sizeof(signalStr), strength)) {
+    Log.info(signalStr);
+    _signalStrength = (int8_t)constrain((int)(strength + 0.5f), 0, 100);
+  }
 }
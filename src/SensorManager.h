@@ -3,7 +3,8 @@
  * @author Chip McClelland (chip@seeinisghts.com)
  * @brief Singleton wrapper around ISensor implementations.
  *
- * @details SensorManager owns a single ISensor instance and handles
+ * @details SensorManager owns a primary (event) ISensor plus up to
+ *          MAX_AUX_SENSORS auxiliary sensors, and handles
  *          initialization, polling, and utility helpers like battery
  *          status, temperature conversion, and signal strength reporting.
  *          It provides a uniform interface to the rest of the firmware,
@@ -14,7 +15,10 @@
 #define SENSORMANAGER_H
 
 #include "Particle.h"
+#include "Config.h"
 #include "ISensor.h"
+#include "EventFilter.h"
+#include "EventRing.h"
 
 extern char internalTempStr[16];
 extern char signalStr[64];
@@ -25,8 +29,9 @@ extern char signalStr[64];
  * Usage:
  * @code
  *   measure.setup();
- *   if (measure.loop()) {
- *       auto data = measure.getSensorData();
+ *   size_t n = measure.loop();
+ *   for (size_t i = 0; i < n; i++) {
+ *       const SensorEvent &ev = measure.batch()[i];
  *   }
  * @endcode
  */
@@ -44,12 +49,47 @@ public:
      */
     void setup();
 
+    /** @brief Maximum number of events consumed per loop() pass. */
+    static constexpr size_t MAX_BATCH = 16;
+
     /**
      * @brief Poll the active sensor; call from the main loop.
      *
-     * @return true if new sensor data is available.
+     * Drains up to MAX_BATCH pending events from the sensor into an
+     * internal batch that stays valid until the next loop() call. With
+     * SENSOR_THREAD_ENABLED the sensor thread has already drained and
+     * filtered them; this only takes them from the hand-off queue.
+     *
+     * @return Number of new events in batch() (0 if none).
+     */
+    size_t loop();
+
+    /**
+     * @brief Events drained by the most recent loop() call.
+     *
+     * Already passed through the event filter (debounce, refractory,
+     * rate cap, minimum pulse width).
+     */
+#if SENSOR_THREAD_ENABLED
+    const SensorEvent* batch() const { return _appBatch; }
+
+    /**
+     * @brief Filtered events that found the hand-off queue full because the
+     *        app thread fell SENSOR_THREAD_QUEUE behind
+     *
+     * @details They are not lost: each sensor slot keeps a count and its
+     *          newest such event, and loop() hands them over once the queue
+     *          has emptied, stamped with that event's capture time.
+     */
+    uint32_t handoffOverflows() const { return _handoff.overflows(); }
+#else
+    const SensorEvent* batch() const { return _batch; }
+#endif
+
+    /**
+     * @brief Active event filter (read-only, for diagnostics).
      */
-    bool loop();
+    const EventFilter& filter() const { return _filter; }
 
     /**
      * @brief Set the concrete ISensor implementation to use.
@@ -58,16 +98,125 @@ public:
      */
     void setSensor(ISensor* sensor);
 
+    /** @brief Maximum number of auxiliary (polled) sensors. */
+    static constexpr size_t MAX_AUX_SENSORS = 4;
+
+    /** @brief Sensor slots: 0 is the primary sensor, 1 + index an aux sensor. */
+    static constexpr size_t MAX_SENSORS = 1 + MAX_AUX_SENSORS;
+
+    /**
+     * @brief Register an auxiliary sensor polled on its own schedule.
+     *
+     * Auxiliary sensors (distance, environmental, etc.) normally never
+     * feed the event batch; loop() just calls their loop() every
+     * @p periodMs and their latest reading is available from
+     * getAuxSensorData(), and once from takeAuxReadings().
+     * initializeFromConfig() registers one from AUX_POLLED_SENSOR_TYPE.
+     *
+     * A counting aux sensor is drained like the primary one instead,
+     * through its own EventFilter, and its events join the batch tagged
+     * with its slot (SensorEvent::source()), so the mode handlers count
+     * them with the primary's and keep a per-sensor tally as well.
+     *
+     * @param sensor   Concrete ISensor (not owned); setup() is called here
+     * @param periodMs Poll period in milliseconds (0 = every loop pass)
+     * @param counts   true to count its events (see above)
+     * @return false if the table is full or the sensor failed setup
+     */
+    bool addAuxSensor(ISensor* sensor, uint32_t periodMs, bool counts = false);
+
+    /**
+     * @brief Number of registered auxiliary sensors.
+     */
+    size_t auxSensorCount() const { return _auxCount; }
+
+    /**
+     * @brief Sensor slots in use: the primary plus the aux sensors.
+     */
+    size_t sensorCount() const { return 1 + _auxCount; }
+
+    /** @brief Health of one sensor slot, as kept per slot in currentStatusData. */
+    enum SensorHealth : uint8_t {
+        HEALTH_ABSENT = 0,      ///< Nothing in the slot
+        HEALTH_OK = 1,
+        HEALTH_NOT_READY = 2,   ///< Not initialized, or failed to wake
+        HEALTH_FAULT = 3,       ///< ISensor::isHealthy() is false
+    };
+
+    /**
+     * @brief Health of sensor slot @p slot (0 = primary)
+     */
+    SensorHealth sensorHealth(size_t slot) const;
+
+    /**
+     * @brief Take one reading from sensor slot @p slot now (0 = primary)
+     *
+     * For SCHEDULED mode, where ScheduledSampler owns the timing and
+     * service() leaves the sensors alone: runs the sensor's loop() once,
+     * which for a power-gated sensor is one burst, and returns its
+     * primary value.
+     *
+     * @return false if the slot is empty or not ready, or the reading was rejected
+     */
+    bool sampleSlot(size_t slot, uint16_t& value);
+
+    /**
+     * @brief Take the readings polled aux sensors have made since the last call
+     *
+     * Outside SCHEDULED mode, where sampleSlot() is not used: fills
+     * @p values and @p valid by sensor slot (1 + aux index) for every aux
+     * sensor, valid only where a new reading is waiting. Slot 0 is left alone.
+     *
+     * @param values, valid At least MAX_SENSORS entries each
+     * @return Number of readings taken
+     */
+    size_t takeAuxReadings(uint16_t* values, bool* valid);
+
+    /**
+     * @brief Latest data from auxiliary sensor @p index.
+     */
+    const SensorData& getAuxSensorData(size_t index) const;
+
+    /**
+     * @brief Milliseconds until the next scheduled poll of any polled
+     *        sensor (UINT32_MAX if nothing is scheduled).
+     *
+     * Interrupt-driven primary sensors are not included; they are
+     * serviced every pass.
+     */
+    uint32_t msUntilNextPoll() const;
+
+    /**
+     * @brief Milliseconds until the last sensor in its warm-up
+     *        (ISensor::warmupMs()) is settled; 0 if none is warming up.
+     *
+     * A nap should end then, so the sensor's wake source is armed for
+     * the rest of the period.
+     */
+    uint32_t msUntilWarm() const;
+
     /**
      * @brief Get the latest sensor data from the active sensor.
      */
-    SensorData getSensorData() const;
+    const SensorData& getSensorData() const;
 
     /**
      * @brief Check whether the active sensor is initialized and ready.
      */
     bool isSensorReady() const;
 
+    /**
+     * @brief false while the active sensor reports a fault (e.g. a PIR
+     *        interrupt storm); its pin should not be a wake source then.
+     */
+    bool isSensorHealthy() const;
+
+    /**
+     * @brief true while the active sensor is mid-event and needs the
+     *        device awake (ISensor::isBusy()).
+     */
+    bool isSensorBusy() const;
+
     /**
      * @brief Create and initialize the active sensor based on configuration.
      *
@@ -76,6 +225,124 @@ public:
      */
     void initializeFromConfig();
 
+    /**
+     * @brief Prepare the primary sensor to capture the edge that may wake
+     *        the device from an ULTRA_LOW_POWER nap.
+     */
+    void prepareForNap();
+
+    /**
+     * @brief Route a sensor-pin wake into the normal event path.
+     *
+     * Injects the wake edge into the sensor's queue if its ISR missed it,
+     * and starts the wake-to-count latency measurement.
+     *
+     * @param wakeMs millis() when System.sleep() returned
+     */
+    void ingestWakeEvent(uint32_t wakeMs);
+
+    /**
+     * @brief Count the primary sensor's edges in hardware for the coming nap
+     *
+     * @details Only with EDGE_COUNT_IN_SLEEP or a sensor that
+     *          countsEdgesInSleep(), on a platform EdgeCounter supports,
+     *          and only if the sensor lends its interrupt pin. The pin is
+     *          then not a wake source for the nap.
+     *
+     * @return true if armed; pair with endSleepEdgeCount() after waking
+     */
+    bool beginSleepEdgeCount();
+
+    /**
+     * @brief Stop the hardware count and give the pin back to the sensor
+     *
+     * @return Rising edges seen during the nap
+     */
+    uint32_t endSleepEdgeCount();
+
+    /**
+     * @brief Bound a nap's edge count by the event filter
+     *        (EventFilter::capEdgeCount())
+     *
+     * @return Edges to count
+     */
+    uint32_t filterSleepEdges(uint32_t edges, uint32_t spanMs);
+
+    /**
+     * @brief Whether the primary sensor wants every nap edge-counted
+     *        (ISensor::countsEdgesInSleep()).
+     */
+    bool sensorCountsEdgesInSleep() const;
+
+    /**
+     * @brief Whether any healthy sensor declares a wake source
+     *        (ISensor::wakeSource()); if none does, only the timer and
+     *        the button end a nap.
+     */
+    bool hasWakeSource() const;
+
+    /**
+     * @brief Add the wake sources the sensors declare to a nap's @p config
+     *
+     * @details Unhealthy sensors are left out, as is the primary sensor's
+     *          pin while it is lent to EdgeCounter (@p edgeCounting).
+     *          Analog sources are only added on nRF52, which has LPCOMP.
+     *
+     * @return true if any sensor can wake the nap
+     */
+    bool addWakeSources(SystemSleepConfiguration& config, bool edgeCounting) const;
+
+    /**
+     * @brief Whether @p pin is one a sensor declared as its wake source
+     *        (System.sleep() result's wakeupPin()).
+     */
+    bool isSensorWakePin(pin_t pin) const;
+
+    /**
+     * @brief Hand a nap's accepted edge count to the primary sensor
+     *        (ISensor::noteSleepEdges()).
+     */
+    void noteSleepEdges(uint32_t edges, time_t start, uint32_t seconds);
+
+    /**
+     * @brief Push one edge into the primary sensor's queue (TraceReplay).
+     *
+     * @return false if there is no ready sensor with an edge queue
+     */
+    bool injectEdge();
+
+    /**
+     * @brief People the primary sensor estimated since the last call
+     *        (ISensor::takePeople()); 0 while it is warming up.
+     */
+    uint16_t takePeople();
+
+    /**
+     * @brief Mode handlers call this after applying a batch to the counters.
+     *
+     * Completes a pending wake-to-count latency measurement.
+     */
+    void noteEventsApplied();
+
+    /** @brief Wake-to-count latency statistics (ms). */
+    struct WakeLatencyStats {
+        uint32_t lastMs;
+        uint32_t maxMs;
+        uint32_t samples;
+        uint32_t injected;   ///< Wakes where the ISR missed the edge
+    };
+
+    const WakeLatencyStats& wakeLatency() const { return _wakeLatency; }
+
+    /** @brief Range finder confirmation of primary events (FUSION_RANGE_CM). */
+    struct FusionStats {
+        uint32_t confirmed;     ///< Events kept: a target within range
+        uint32_t rejected;      ///< Events dropped: nothing within range
+        uint32_t failed;        ///< Events kept because the burst failed
+    };
+
+    const FusionStats& fusionStats() const { return _fusion; }
+
     /**
      * @brief Notify the sensor that the device is entering deep sleep.
      */
@@ -91,29 +358,69 @@ public:
      */
     ///@{
     /**
-     * @brief Convert TMP36 ADC reading to degrees Celsius.
+     * @brief Convert TMP36 ADC reading to hundredths of a degree Celsius.
      *
      * @param adcValue Raw ADC value from the TMP36 input.
-     * @return Temperature in degrees Celsius.
+     * @return Temperature in hundredths of a degree Celsius.
      */
-    float tmp36TemperatureC(int adcValue);
+    int16_t tmp36TempCenti(int adcValue);
 
     /**
-     * @brief Read TMP112A temperature (I2C) in degrees Celsius.
+     * @brief Read TMP112A temperature (I2C) in hundredths of a degree Celsius.
      *
      * Intended for platforms/carriers (like Muon) that include an onboard
      * TMP112A temperature sensor.
      *
-     * @param[out] tempC Filled with temperature in degrees Celsius on success.
+     * @param[out] tempCenti Filled with the temperature on success.
      * @return true on success, false on I2C error or missing device.
      */
-    bool readTmp112TemperatureC(float &tempC);
+    bool readTmp112TempCenti(int16_t &tempCenti);
+
+    /**
+     * @brief TaskScheduler task: probe for a TMP112A, then take one-shot
+     *        conversions into the cache batteryState() reads
+     *
+     * @details The sensor stays in shutdown except during a conversion. One
+     *          pass starts a conversion (a config write), a pass at least
+     *          35 ms later reads the result; one is started every
+     *          TMP112_INTERVAL_SEC and after each nap.
+     *
+     * @return true (TaskScheduler task)
+     */
+    static bool temperatureTask();
+
+    /** @brief Battery and power readings from the last snapshot refresh. */
+    struct PowerSnapshot {
+        bool valid;             ///< false until the first refresh
+        uint32_t takenMs;       ///< millis() at the refresh
+        uint8_t batteryState;   ///< System.batteryState() (0 where unknown)
+        uint16_t socTenths;     ///< Tenths of a percent, from the fuel gauge or the voltage
+        int powerSource;        ///< System.powerSource() (Gen 3 only)
+        uint8_t faultReg;       ///< PMIC REG09 (Boron only)
+        uint8_t systemStatus;   ///< PMIC REG08 (Boron only)
+    };
 
     /**
      * @brief Determine whether the battery is present and not critically low.
+     *
+     * @details Updates current batteryState, socTenths and the enclosure
+     *          temperature. The fuel gauge and PMIC are only read when the
+     *          snapshot is older than POWER_SNAPSHOT_TTL_SEC or a battery_state
+     *          / power_source system event arrived since; otherwise the cached
+     *          readings stand.
      */
     bool batteryState();
 
+    /** @brief The cached battery and power readings; see batteryState(). */
+    const PowerSnapshot &powerSnapshot() const { return _power; }
+
+    /**
+     * @brief Ubidots context string for a System.batteryState() value
+     *
+     * @return "Unknown" for values outside 0-6
+     */
+    static const char *batteryStateName(uint8_t state);
+
     /**
      * @brief Determine whether it is safe to charge the battery.
      */
@@ -124,6 +431,11 @@ public:
      */
     void getSignalStrength();
 
+    /**
+     * @brief Signal strength in percent at the last getSignalStrength(), -1 if none yet
+     */
+    int signalStrength() const { return _signalStrength; }
+
     ///@}
     
 protected:
@@ -140,6 +452,175 @@ protected:
 
     /** @brief Timestamp of the last sensor poll (millis). */
     unsigned long _lastPollTime;
+
+    /** @brief Events drained by the last loop() call (by the sensor thread, if enabled). */
+    SensorEvent _batch[MAX_BATCH];
+
+    /**
+     * @brief Drain and filter the primary sensor and poll aux sensors
+     *
+     * @details loop() itself without the sensor thread; the thread's body with it.
+     *
+     * @return Number of accepted events in _batch
+     */
+    size_t service();
+
+    /**
+     * @brief Drain and filter the primary sensor into _batch
+     *
+     * @return Number of accepted events
+     */
+    size_t servicePrimary(unsigned long currentTime);
+
+#if SENSOR_THREAD_ENABLED
+    /** @brief Filtered events, sensor thread -> app thread. */
+    EventRing<SensorEvent, SENSOR_THREAD_QUEUE> _handoff;
+
+    /** @brief Events taken from _handoff by the last loop() call. */
+    SensorEvent _appBatch[MAX_BATCH];
+
+    /** @brief Held by the sensor thread for each service() pass. */
+    RecursiveMutex _lock;
+
+    /** @brief Per slot, overflowed events not yet handed over and the newest of them (under _lock). */
+    uint32_t _carryCount[MAX_SENSORS] = {};
+    SensorEvent _carry[MAX_SENSORS];
+
+    /** @brief handoffOverflows() already handed over by loop() (app thread only). */
+    uint32_t _carryApplied = 0;
+
+    os_thread_t _thread = nullptr;
+
+    /** @brief Start the sensor thread once the sensor is initialized. */
+    void startThread();
+
+    static void threadMain(void *param);
+#endif
+
+    /** @brief Filter applied to every drained batch of primary-sensor events. */
+    EventFilter _filter;
+
+    /** @brief Range finder confirming primary events (FUSION_RANGE_CM), or nullptr. */
+    ISensor* _confirm = nullptr;
+    FusionStats _fusion = {0, 0, 0};
+
+    /**
+     * @brief Keep @p events accepted primary events in _batch only if a
+     *        range finder burst sees a target within FUSION_RANGE_CM
+     *
+     * @return Events kept: @p events or 0
+     */
+    size_t confirmEvents(size_t events);
+
+    /** @brief Wake-to-count measurement in progress. */
+    bool _wakeMarkPending = false;
+    uint32_t _wakeMarkMs = 0;
+    WakeLatencyStats _wakeLatency = {0, 0, 0, 0};
+
+    /** @brief TMP112A presence and its latest one-shot reading (temperatureTask()). */
+    bool _tmp112Probed = false;
+    bool _tmp112Present = false;
+    bool _tmp112Converting = false;
+    bool _tmp112Due = false;
+    bool _tmp112Valid = false;
+    int16_t _tmp112TempCenti = 0;
+    uint32_t _tmp112StartMs = 0;
+    uint32_t _tmp112ReadMs = 0;
+
+    /** @brief Cached fuel gauge and PMIC readings. */
+    PowerSnapshot _power = {false, 0, 0, 0, 0, 0, 0};
+
+    /** @brief Set by a battery_state or power_source system event. */
+    volatile bool _powerChanged = false;
+
+    /** @brief Charging enable last written to the PMIC, and whether it still holds. */
+    bool _chargeDecisionApplied = false;
+    bool _chargeAllowedApplied = true;
+
+    /**
+     * @brief Re-read the fuel gauge and PMIC (with fault remediation) into
+     *        _power and current, if the snapshot is stale or invalidated
+     *
+     * @return true if it was refreshed
+     */
+    bool refreshPowerSnapshot();
+
+    static void powerEventHandler(system_event_t event, int param);
+
+    /** @brief Primary sensor health at the last loop() pass. */
+    bool _sensorHealthy = true;
+
+    /**
+     * @brief Raise alert 24 when the primary sensor turns unhealthy, and
+     *        clear it when the sensor recovers.
+     */
+    void checkSensorHealth();
+
+    /** @brief One auxiliary sensor and its poll schedule. */
+    struct AuxSlot {
+        ISensor* sensor;
+        uint32_t periodMs;
+        uint32_t nextDueMs;
+        bool counts;            ///< Drained into the event batch (addAuxSensor())
+        uint32_t warmUntilMs;   ///< millis() when its warm-up ends (0 = settled)
+        EventFilter filter;     ///< Counting sensors only
+        uint16_t reading;       ///< Polled sensors: last accepted primary value
+        bool fresh;             ///< reading not yet taken by takeAuxReadings()
+    };
+
+    /**
+     * @brief Register a Config.h aux sensor of SensorType @p type
+     *        (-1 = none) unless it is already registered.
+     */
+    void addConfiguredAux(int type, uint32_t periodMs, bool counts);
+
+    /**
+     * @brief Poll any auxiliary sensors that are due.
+     *
+     * Returns immediately (one compare) until the earliest deadline
+     * in the table is reached. Counting sensors are drained into
+     * @p out rather than polled.
+     *
+     * @return Number of accepted events written to @p out
+     */
+    size_t pollAuxSensors(uint32_t nowMs, SensorEvent* out, size_t max);
+
+    /** @brief Recompute _nextAuxDueMs after a slot's deadline changes. */
+    void updateNextAuxDue();
+
+    AuxSlot _aux[MAX_AUX_SENSORS];
+
+    /** @brief millis() when the primary sensor's warm-up ends (0 = settled). */
+    uint32_t _warmUntilMs = 0;
+
+    /**
+     * @brief Start @p sensor's warm-up: the end time for its
+     *        warmUntilMs, or 0 if it declares none.
+     */
+    static uint32_t warmupEnd(const ISensor* sensor);
+
+    /** @brief Whether a warm-up ending at @p untilMs is still running. */
+    static bool warmingUp(uint32_t untilMs);
+
+    /**
+     * @brief Whether @p raw events just drained from @p sensor are to be
+     *        discarded because its warm-up (@p untilMs) is running.
+     *
+     * Call on every drain, empty or not: clears @p untilMs and logs the
+     * discarded total once the warm-up has ended, before millis() can
+     * wrap back into it.
+     */
+    bool discardWhileWarming(uint32_t& untilMs, const ISensor* sensor, size_t raw);
+
+    /** @brief Events discarded since the last warm-up ended. */
+    uint32_t _warmupDiscarded = 0;
+    size_t _auxCount;
+
+    /** @brief Earliest nextDueMs across _aux (valid when _auxCount > 0). */
+    uint32_t _nextAuxDueMs;
+
+    /** @brief Strength in percent at the last getSignalStrength() (-1 = not read). */
+    int8_t _signalStrength = -1;
 };
 
 #endif /* SENSORMANAGER_H */
\ No newline at end of file
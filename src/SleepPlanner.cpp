@@ -0,0 +1,176 @@
+#include "SleepPlanner.h"
+#include "BootProfile.h"
+#include "Config.h"
+#include "Payload.h"
+#include "PowerPolicy.h"
+#include <math.h>
+
+namespace SleepPlanner {
+
+// Each nap's weight in the wake rate decays by this much per later nap
+static const float NAP_DECAY = 0.9f;
+
+static float decayedWakes = 0.0f;
+static float decayedSleepSec = 0.0f;
+
+// Average awake ms from a PIR wake to the next nap, decayed like the wake rate
+static float decayedAwakeMs = 0.0f;
+static float decayedAwakeWakes = 0.0f;
+static uint32_t sensorWakeMs = 0;     // millis() at the last PIR wake, 0 once measured
+
+// Event rate: events decayed with time constant the policy's stayAwakeWindowSec
+static float decayedEvents = 0.0f;
+static uint32_t eventRateSec = 0;     // Clock of the last update (see rateClockSec())
+static bool awakeMode = false;
+
+static uint32_t sleepMicroamps(Mode mode) {
+    switch (mode) {
+        case MODE_STOP:
+            return ENERGY_UA_STOP;
+        case MODE_HIBERNATE:
+            return ENERGY_UA_HIBERNATE;
+        default:
+            return ENERGY_UA_ULP;
+    }
+}
+
+// Awake time to get back to work after a wake in this mode
+static uint32_t wakeMs(Mode mode) {
+    switch (mode) {
+        case MODE_STOP:
+            return SLEEP_WAKE_MS_STOP;
+        case MODE_HIBERNATE: {
+            // A HIBERNATE wake is a boot; this boot's setup() time is the best estimate
+            uint32_t bootMs = BootProfile::instance().readyMs();
+            return bootMs > SLEEP_WAKE_MS_HIBERNATE ? bootMs : SLEEP_WAKE_MS_HIBERNATE;
+        }
+        default:
+            return SLEEP_WAKE_MS_ULP;
+    }
+}
+
+Mode choose(uint32_t gapSec, bool sensorArmed, bool hibernateAllowed) {
+    // Sensor wakes cannot end a HIBERNATE; only the timer and button can
+    hibernateAllowed = hibernateAllowed && !sensorArmed;
+
+#if SLEEP_PLANNER_ENABLED
+    float wakes = 1.0f + (sensorArmed ? wakeRatePerHour() * (float)gapSec / 3600.0f : 0.0f);
+
+    // Microamp-seconds for the nap in each mode
+    float cost[NUM_MODES];
+    for (uint8_t ii = 0; ii < NUM_MODES; ii++) {
+        Mode mode = (Mode)ii;
+        cost[ii] = (float)sleepMicroamps(mode) * (float)gapSec +
+                   wakes * (float)wakeMs(mode) / 1000.0f * (float)ENERGY_UA_AWAKE;
+    }
+
+    Mode best = cost[MODE_STOP] < cost[MODE_ULP] ? MODE_STOP : MODE_ULP;
+    if (hibernateAllowed && cost[MODE_HIBERNATE] < cost[best]) {
+        best = MODE_HIBERNATE;
+    }
+
+    // Costs are uA-seconds; logged as uAh to one decimal
+    auto tenths = [](float value) { return (int32_t)lroundf(value * 10.0f); };
+    Log.info("SleepPlanner: gap=%lus wakes=%s (%s/h) uAh STOP=%s ULP=%s HIBERNATE=%s -> %s",
+             (unsigned long)gapSec, Payload::Scaled(tenths(wakes), 1).c_str(),
+             Payload::Scaled(tenths(wakeRatePerHour()), 1).c_str(),
+             Payload::Scaled(tenths(cost[MODE_STOP] / 3600.0f), 1).c_str(),
+             Payload::Scaled(tenths(cost[MODE_ULP] / 3600.0f), 1).c_str(),
+             hibernateAllowed ? Payload::Scaled(tenths(cost[MODE_HIBERNATE] / 3600.0f), 1).c_str() : "n/a",
+             modeName(best));
+    return best;
+#else
+    // Fixed policy: HIBERNATE whenever allowed, otherwise ULTRA_LOW_POWER
+    return hibernateAllowed ? MODE_HIBERNATE : MODE_ULP;
+#endif
+}
+
+void recordNap(uint32_t sleptSec, bool sensorWake) {
+    decayedWakes = decayedWakes * NAP_DECAY + (sensorWake ? 1.0f : 0.0f);
+    decayedSleepSec = decayedSleepSec * NAP_DECAY + (float)sleptSec;
+    sensorWakeMs = sensorWake ? (millis() | 1) : 0;
+}
+
+void noteSleepStart() {
+    if (sensorWakeMs != 0) {
+        decayedAwakeMs = decayedAwakeMs * NAP_DECAY + (float)(millis() - sensorWakeMs);
+        decayedAwakeWakes = decayedAwakeWakes * NAP_DECAY + 1.0f;
+        sensorWakeMs = 0;
+    }
+}
+
+// Seconds for the event rate: RTC time when valid, since millis() may not
+// advance during sleep on every platform
+static uint32_t rateClockSec() {
+    return Time.isValid() ? (uint32_t)Time.now() : millis() / 1000;
+}
+
+// Decay the event count up to now
+static void decayEvents() {
+    uint32_t now = rateClockSec();
+    if (eventRateSec != 0 && now > eventRateSec) {
+        decayedEvents *= expf(-(float)(now - eventRateSec) / (float)PowerPolicy::active().stayAwakeWindowSec);
+    }
+    eventRateSec = now;     // Also restarts the decay if the clock jumped back (time set)
+}
+
+void noteEvents(size_t events) {
+    decayEvents();
+    decayedEvents += (float)events;
+}
+
+float eventRatePerHour() {
+    decayEvents();
+    return decayedEvents * 3600.0f / (float)PowerPolicy::active().stayAwakeWindowSec;
+}
+
+float crossoverPerHour() {
+    if (STAY_AWAKE_CROSSOVER_PER_HOUR > 0) {
+        return (float)STAY_AWAKE_CROSSOVER_PER_HOUR;
+    }
+    // Napping costs the ULP current plus, per event, the wake and the time
+    // spent up afterwards; staying up costs the awake current throughout
+    float wakeCostMs = (float)SLEEP_WAKE_MS_ULP;
+    if (decayedAwakeWakes > 0.0f) {
+        wakeCostMs += decayedAwakeMs / decayedAwakeWakes;
+    }
+    return 3600.0f * 1000.0f * (float)(ENERGY_UA_AWAKE - ENERGY_UA_ULP) / (wakeCostMs * (float)ENERGY_UA_AWAKE);
+}
+
+bool stayAwake() {
+#if STAY_AWAKE_ENABLED
+    float rate = eventRatePerHour();
+    float crossover = crossoverPerHour();
+    int hysteresisPct = PowerPolicy::active().stayAwakeHysteresisPct;
+    bool next = awakeMode ? rate >= crossover * (100 - hysteresisPct) / 100.0f
+                          : rate >= crossover * (100 + hysteresisPct) / 100.0f;
+    if (next != awakeMode) {
+        Log.info("SleepPlanner: %ld events/h vs crossover %ld/h - %s", lroundf(rate), lroundf(crossover),
+                 next ? "staying awake" : "napping again");
+        awakeMode = next;
+    }
+    return awakeMode;
+#else
+    return false;
+#endif
+}
+
+float wakeRatePerHour() {
+    if (decayedSleepSec < 1.0f) {
+        return 0.0f;
+    }
+    return decayedWakes * 3600.0f / decayedSleepSec;
+}
+
+const char *modeName(Mode mode) {
+    switch (mode) {
+        case MODE_STOP:
+            return "STOP";
+        case MODE_HIBERNATE:
+            return "HIBERNATE";
+        default:
+            return "ULTRA_LOW_POWER";
+    }
+}
+
+} // namespace SleepPlanner
@@ -0,0 +1,93 @@
+/**
+ * @file SleepPlanner.h
+ * @brief Picks the sleep mode for each nap by estimated energy.
+ *
+ * @details For a nap of gapSec, each candidate mode costs its sleep current
+ *          for the whole gap plus, for every wake it will take, the time
+ *          spent awake getting back to work: a few hundred ms for STOP,
+ *          more for ULTRA_LOW_POWER, and a full boot (BootProfile::readyMs()
+ *          of this boot) plus re-initialization for HIBERNATE. The expected
+ *          number of wakes is the final timer wake plus, while the sensor is
+ *          armed, the recent PIR wake rate times the gap. The cheapest
+ *          allowed mode wins, and the reason is logged.
+ *
+ *          Between naps it also decides whether to nap at all: while the
+ *          recent event rate is above the rate at which staying awake is the
+ *          cheaper choice, stayAwake() holds the device in IDLE (see
+ *          STAY_AWAKE_ENABLED).
+ *
+ *          HIBERNATE is only a candidate when the sensor does not need to
+ *          wake the device (it only wakes on BUTTON_PIN) and it has not been
+ *          disabled for the session. Currents are the ENERGY_UA_* values in
+ *          Config.h; see SLEEP_PLANNER_ENABLED.
+ */
+
+#ifndef __SLEEPPLANNER_H
+#define __SLEEPPLANNER_H
+
+#include "Particle.h"
+
+namespace SleepPlanner {
+
+/** @brief Sleep modes the planner chooses between */
+enum Mode : uint8_t {
+    MODE_STOP = 0,
+    MODE_ULP = 1,
+    MODE_HIBERNATE = 2,
+    NUM_MODES = 3
+};
+
+/**
+ * @brief Choose the mode for the next nap
+ *
+ * @param gapSec Seconds until the next scheduled wake
+ * @param sensorArmed true if sensor interrupts must be able to wake the device
+ * @param hibernateAllowed false to rule out HIBERNATE (disabled for the session, open occupancy session...)
+ */
+Mode choose(uint32_t gapSec, bool sensorArmed, bool hibernateAllowed);
+
+/**
+ * @brief Record how a nap ended, to track the PIR wake rate
+ *
+ * @param sleptSec Time asleep
+ * @param sensorWake true if the sensor woke the device
+ */
+void recordNap(uint32_t sleptSec, bool sensorWake);
+
+/** @brief Recent sensor wakes per hour of sleep. */
+float wakeRatePerHour();
+
+/**
+ * @brief Mark the start of a nap, to measure how long a PIR wake kept the device up
+ */
+void noteSleepStart();
+
+/**
+ * @brief Record counted or occupancy events, asleep or awake, for the event rate
+ */
+void noteEvents(size_t events);
+
+/** @brief Recent events per hour, decayed over STAY_AWAKE_WINDOW_SEC. */
+float eventRatePerHour();
+
+/**
+ * @brief Event rate above which staying awake costs less than napping
+ *
+ * STAY_AWAKE_CROSSOVER_PER_HOUR when set, otherwise from the ENERGY_UA_*
+ * currents and the cost of one ULTRA_LOW_POWER wake.
+ */
+float crossoverPerHour();
+
+/**
+ * @brief Whether to stay awake rather than nap, with hysteresis around the crossover
+ *
+ * Always false when STAY_AWAKE_ENABLED is 0. Logs when the answer changes.
+ */
+bool stayAwake();
+
+/** @brief "STOP", "ULTRA_LOW_POWER" or "HIBERNATE". */
+const char *modeName(Mode mode);
+
+} // namespace SleepPlanner
+
+#endif /* __SLEEPPLANNER_H */
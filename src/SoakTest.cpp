@@ -0,0 +1,123 @@
+#include "SoakTest.h"
+#include "Config.h"
+
+#if SOAK_TEST_ENABLED
+
+#include "HeapMonitor.h"
+#include "MyPersistentData.h"
+#include "Payload.h"
+#include "PersistentStore.h"
+#include "PublishQueuePosixRK.h"
+#include "SensorManager.h"
+#include "TaskScheduler.h"
+#include <algorithm>
+
+extern bool publishDiagnosticSafe(const char* eventName, const char* data, PublishFlags flags);
+
+namespace SoakTest {
+
+static retained uint32_t cycles = 0;        // Survives HIBERNATE, so a soak counts across wakes
+static retained uint32_t failedConnects = 0;
+static uint32_t connectAttempts = 0;
+static bool failThisConnect = false;
+static unsigned long lastEventMs = 0;
+
+// Totals at the last report, for the window averages
+static uint32_t lastOverBudget = 0;
+static uint32_t lastIoCount = 0;
+static uint64_t lastIoTotalUs = 0;
+static uint32_t lastSaves = 0;
+static uint64_t lastSaveTotalUs = 0;
+
+// Every save to flash: the consolidated file, or the three objects' own
+static void saveTotals(uint32_t &saves, uint64_t &totalUs, uint32_t &maxUs) {
+    const StorageHelperRK::PersistentDataBase::SaveStats *stats[] = {
+        &sysStatus.getSaveStats(), &sensorConfig.getSaveStats(), &current.getSaveStats(),
+#if PERSISTENT_SINGLE_FILE
+        &PersistentStore::instance().getSaveStats(),
+#endif
+    };
+    saves = 0;
+    totalUs = 0;
+    maxUs = 0;
+    for (const auto *s : stats) {
+        saves += s->saves;
+        totalUs += s->totalUs;
+        maxUs = std::max(maxUs, s->maxUs);
+    }
+}
+
+static void report() {
+    const TaskScheduler::PassStats &pass = TaskScheduler::instance().passStats();
+    PublishQueueMetrics queue = PublishQueuePosix::instance().getMetrics();
+    uint32_t saves, saveMaxUs;
+    uint64_t saveTotalUs;
+    saveTotals(saves, saveTotalUs, saveMaxUs);
+
+    uint32_t ioCount = queue.writeFilesUs.count - lastIoCount;
+    uint32_t windowSaves = saves - lastSaves;
+    uint32_t heapMin = HeapMonitor::lowWaterFree();
+    uint32_t blockMin = HeapMonitor::lowWaterBlock();
+
+    char data[320];
+    Payload::Writer(data, sizeof(data))
+        .beginObject()
+        .add("cycles", (unsigned long)cycles)
+        .add("up", (unsigned long)System.uptime())
+        .add("heapMin", (unsigned long)(heapMin == UINT32_MAX ? 0 : heapMin))
+        .add("blockMin", (unsigned long)(blockMin == UINT32_MAX ? 0 : blockMin))
+        .add("fragMax", (unsigned)HeapMonitor::worstFragPct())
+        .add("loopMaxUs", (unsigned long)pass.maxUs)
+        .add("overBudget", (unsigned long)(pass.overBudget - lastOverBudget))
+        .add("ioAvgUs", (unsigned long)(ioCount ? (queue.writeFilesUs.total - lastIoTotalUs) / ioCount : 0))
+        .add("ioMaxUs", (unsigned long)queue.writeFilesUs.max)
+        .add("stoUs", (unsigned long)queue.storageWorstUs)
+        .add("saveAvgUs", (unsigned long)(windowSaves ? (saveTotalUs - lastSaveTotalUs) / windowSaves : 0))
+        .add("saveMaxUs", (unsigned long)saveMaxUs)
+        .add("saves", (unsigned long)windowSaves)
+        .add("depth", (unsigned)PublishQueuePosix::instance().getNumEvents())
+        .add("fails", (unsigned long)failedConnects)
+        .endObject();
+    Log.info("Soak: %s", data);
+    publishDiagnosticSafe("soak", data, PRIVATE);
+
+    lastOverBudget = pass.overBudget;
+    lastIoCount = queue.writeFilesUs.count;
+    lastIoTotalUs = queue.writeFilesUs.total;
+    lastSaves = saves;
+    lastSaveTotalUs = saveTotalUs;
+}
+
+bool loop() {
+    if (SOAK_EVENT_PERIOD_MS > 0 && millis() - lastEventMs >= SOAK_EVENT_PERIOD_MS) {
+        lastEventMs = millis();
+        SensorManager::instance().injectEdge();
+    }
+    return true;
+}
+
+void noteCycle() {
+    cycles++;
+    if (cycles % SOAK_REPORT_CYCLES == 0) {
+        report();
+    }
+}
+
+void noteConnectAttempt() {
+    connectAttempts++;
+    failThisConnect = SOAK_CONNECT_FAIL_EVERY > 0 && connectAttempts % SOAK_CONNECT_FAIL_EVERY == 0;
+}
+
+bool forceConnectFailure() {
+    if (!failThisConnect) {
+        return false;
+    }
+    failThisConnect = false;
+    failedConnects++;
+    Log.info("Soak: failing connect attempt %lu", (unsigned long)connectAttempts);
+    return true;
+}
+
+} // namespace SoakTest
+
+#endif /* SOAK_TEST_ENABLED */
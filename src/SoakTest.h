@@ -0,0 +1,71 @@
+/**
+ * @file SoakTest.h
+ * @brief Bench soak profile: accelerated report and sleep cycles with
+ *        synthetic events and forced connect failures, and a drift
+ *        report every SOAK_REPORT_CYCLES cycles.
+ *
+ * @details Heap fragmentation, queue growth and flash wear show up after
+ *          weeks in the field. With SOAK_TEST_ENABLED the firmware runs
+ *          its normal state machine, only faster and under load:
+ *
+ *          - Reports every SOAK_REPORT_INTERVAL_SEC, whatever the
+ *            configured interval (PowerGovernor::reportingIntervalSec()).
+ *            In LOW_POWER mode each report is a connect and a nap, so the
+ *            sleep path runs at the same rate.
+ *          - An edge injected into the sensor queue
+ *            (SensorManager::injectEdge()) every SOAK_EVENT_PERIOD_MS
+ *            while awake.
+ *          - Every SOAK_CONNECT_FAIL_EVERY-th connect is failed as if it
+ *            had run out of budget (forceConnectFailure()), so alert 31,
+ *            the backoff and the queue hold and spill paths run too.
+ *
+ *          A cycle is one REPORTING_STATE pass (noteCycle()). Every
+ *          SOAK_REPORT_CYCLES cycles a "soak" event and a log line give:
+ *
+ *              {"cycles":1200,"up":86400,"heapMin":41230,"blockMin":30112,
+ *               "fragMax":18,"loopMaxUs":48210,"overBudget":3,
+ *               "ioAvgUs":2310,"ioMaxUs":15230,"stoUs":18410,
+ *               "saveAvgUs":3120,"saveMaxUs":9810,"saves":212,
+ *               "depth":2,"fails":240}
+ *
+ *          heapMin, blockMin, fragMax, loopMaxUs, ioMaxUs, stoUs and
+ *          saveMaxUs are since boot; ioAvgUs, saveAvgUs, saves and
+ *          overBudget cover the window since the last report, so a
+ *          rising average is drift. The cycle count is retained and
+ *          survives HIBERNATE. Counts are real; bench units only.
+ *
+ *          Application thread only.
+ */
+
+#ifndef __SOAKTEST_H
+#define __SOAKTEST_H
+
+#include "Particle.h"
+
+namespace SoakTest {
+
+/**
+ * @brief TaskScheduler task: inject the synthetic events that are due
+ *
+ * @return true (TaskScheduler task)
+ */
+bool loop();
+
+/**
+ * @brief A report cycle started; from REPORTING_STATE
+ */
+void noteCycle();
+
+/**
+ * @brief A connect attempt is starting; from enterConnectingState()
+ */
+void noteConnectAttempt();
+
+/**
+ * @brief true if the attempt in progress is to fail; from CONNECTING_STATE
+ */
+bool forceConnectFailure();
+
+} // namespace SoakTest
+
+#endif /* __SOAKTEST_H */
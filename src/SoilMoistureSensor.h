@@ -0,0 +1,52 @@
+// src/SoilMoistureSensor.h
+#ifndef SOILMOISTURESENSOR_H
+#define SOILMOISTURESENSOR_H
+
+#include "AnalogBurstSensor.h"
+#include "device_pinout.h"
+
+/**
+ * @brief Capacitive soil moisture probe on analogSensePin.
+ *
+ * The probe is powered through disableModule (active LOW) only during a
+ * burst. Output voltage falls as moisture rises; the reduced ADC count
+ * is mapped linearly between the dry and wet calibration points.
+ *
+ * Output (SensorData):
+ * - primary:   volumetric moisture estimate in 0.1 % (0..1000)
+ * - secondary: reduced raw ADC count
+ */
+class SoilMoistureSensor : public AnalogBurstSensor {
+public:
+    /**
+     * @brief Get singleton instance
+     */
+    static SoilMoistureSensor& instance() {
+        static SoilMoistureSensor _instance;
+        return _instance;
+    }
+
+    const char* getSensorType() const override { return "SoilMoisture"; }
+
+protected:
+    bool convert(uint16_t raw, SensorData& data) override {
+        // Typical 3.3 V capacitive probe: ~2900 counts in air, ~1300 in water.
+        static const uint16_t RAW_DRY = 2900;
+        static const uint16_t RAW_WET = 1300;
+
+        if (raw < 50 || raw > 4050) {
+            return false;  // Rail reading: probe missing or shorted
+        }
+        uint16_t clamped = raw > RAW_DRY ? RAW_DRY : (raw < RAW_WET ? RAW_WET : raw);
+        data.primary = (uint16_t)(((uint32_t)(RAW_DRY - clamped) * 1000UL) / (RAW_DRY - RAW_WET));
+        data.secondary = raw;
+        return true;
+    }
+
+private:
+    SoilMoistureSensor()
+        : AnalogBurstSensor(Config{analogSensePin, true, 20, 16, 4},
+                            SensorType::SOIL_MOISTURE) {}
+};
+
+#endif /* SOILMOISTURESENSOR_H */
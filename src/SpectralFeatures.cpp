@@ -0,0 +1,148 @@
+#include "SpectralFeatures.h"
+#include <math.h>
+#include <string.h>
+
+namespace SpectralFeatures {
+
+static const size_t HALF = FFT_SIZE / 2;
+
+// W_N^k = cos - i sin of 2*pi*k/FFT_SIZE, k < FFT_SIZE/2
+static float cosTable[HALF];
+static float sinTable[HALF];
+static bool tablesReady = false;
+
+static void buildTables() {
+    for (size_t k = 0; k < HALF; k++) {
+        float angle = 2.0f * (float)M_PI * (float)k / (float)FFT_SIZE;
+        cosTable[k] = cosf(angle);
+        sinTable[k] = sinf(angle);
+    }
+    tablesReady = true;
+}
+
+// Radix-2 complex FFT of HALF points, interleaved re/im, in place
+static void complexFft(float *z) {
+    // Bit-reversed order
+    for (size_t ii = 1, jj = 0; ii < HALF; ii++) {
+        size_t bit = HALF >> 1;
+        for (; jj & bit; bit >>= 1) {
+            jj ^= bit;
+        }
+        jj |= bit;
+        if (ii < jj) {
+            float re = z[2 * ii];
+            float im = z[2 * ii + 1];
+            z[2 * ii] = z[2 * jj];
+            z[2 * ii + 1] = z[2 * jj + 1];
+            z[2 * jj] = re;
+            z[2 * jj + 1] = im;
+        }
+    }
+
+    for (size_t len = 2; len <= HALF; len <<= 1) {
+        size_t half = len / 2;
+        size_t stride = FFT_SIZE / len;     // W_HALF^(j * HALF/len) = W_N^(j * N/len)
+        for (size_t start = 0; start < HALF; start += len) {
+            for (size_t jj = 0; jj < half; jj++) {
+                float wr = cosTable[jj * stride];
+                float wi = -sinTable[jj * stride];
+                float *a = &z[2 * (start + jj)];
+                float *b = &z[2 * (start + jj + half)];
+                float vr = b[0] * wr - b[1] * wi;
+                float vi = b[0] * wi + b[1] * wr;
+                b[0] = a[0] - vr;
+                b[1] = a[1] - vi;
+                a[0] += vr;
+                a[1] += vi;
+            }
+        }
+    }
+}
+
+void realFft(float *data) {
+    if (!tablesReady) {
+        buildTables();
+    }
+    // Even samples as real parts, odd as imaginary: one half-size complex FFT
+    complexFft(data);
+
+    float z0r = data[0];
+    float z0i = data[1];
+    data[0] = z0r + z0i;    // DC
+    data[1] = z0r - z0i;    // Nyquist
+
+    // X[k] = E + W*O and X[HALF-k] = conj(E - W*O), with
+    // E = (Z[k] + conj(Z[HALF-k])) / 2 and O = -i (Z[k] - conj(Z[HALF-k])) / 2
+    for (size_t k = 1; k <= HALF / 2; k++) {
+        float *zk = &data[2 * k];
+        float *zm = &data[2 * (HALF - k)];
+        float er = 0.5f * (zk[0] + zm[0]);
+        float ei = 0.5f * (zk[1] - zm[1]);
+        float orr = 0.5f * (zk[1] + zm[1]);
+        float oi = -0.5f * (zk[0] - zm[0]);
+        float c = cosTable[k];
+        float s = sinTable[k];
+        float tr = c * orr + s * oi;        // W*O with W = c - i s
+        float ti = c * oi - s * orr;
+        zk[0] = er + tr;
+        zk[1] = ei + ti;
+        if (zm != zk) {
+            zm[0] = er - tr;
+            zm[1] = -(ei - ti);
+        }
+    }
+}
+
+void extract(const float *const axes[3], size_t samples, float sampleHz, Features &out) {
+    memset(&out, 0, sizeof(out));
+    if (samples == 0) {
+        return;
+    }
+    if (samples > FFT_SIZE) {
+        samples = FFT_SIZE;
+    }
+
+    // Summed power per bin, 0..HALF
+    float power[HALF + 1] = {};
+    float buffer[FFT_SIZE];
+    float sumSquares = 0.0f;
+
+    for (int axis = 0; axis < 3; axis++) {
+        float mean = 0.0f;
+        for (size_t ii = 0; ii < samples; ii++) {
+            mean += axes[axis][ii];
+        }
+        mean /= (float)samples;
+        for (size_t ii = 0; ii < FFT_SIZE; ii++) {
+            buffer[ii] = ii < samples ? axes[axis][ii] - mean : 0.0f;
+            sumSquares += buffer[ii] * buffer[ii];
+        }
+
+        realFft(buffer);
+        power[0] += buffer[0] * buffer[0];
+        power[HALF] += buffer[1] * buffer[1];
+        for (size_t k = 1; k < HALF; k++) {
+            power[k] += buffer[2 * k] * buffer[2 * k] + buffer[2 * k + 1] * buffer[2 * k + 1];
+        }
+    }
+
+    out.rmsMg = sqrtf(sumSquares / (float)samples);
+
+    // Mean square per bin (Parseval), one-sided: bins below Nyquist count twice
+    float norm = 1.0f / ((float)FFT_SIZE * (float)samples);
+    size_t peakBin = 1;
+    size_t binsPerBand = HALF / BANDS;
+    for (size_t k = 1; k <= HALF; k++) {
+        float meanSquare = power[k] * norm * (k < HALF ? 2.0f : 1.0f);
+        out.bandRmsMg[(k - 1) / binsPerBand] += meanSquare;
+        if (power[k] > power[peakBin]) {
+            peakBin = k;
+        }
+    }
+    for (size_t band = 0; band < BANDS; band++) {
+        out.bandRmsMg[band] = sqrtf(out.bandRmsMg[band]);
+    }
+    out.peakHz = (float)peakBin * sampleHz / (float)FFT_SIZE;
+}
+
+} // namespace SpectralFeatures
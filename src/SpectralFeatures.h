@@ -0,0 +1,62 @@
+/**
+ * @file SpectralFeatures.h
+ * @brief Reduce a burst of 3-axis acceleration to a few spectral features.
+ *
+ * @details Each axis gets a fixed-size real FFT (FFT_SIZE points, single
+ *          precision on the Cortex-M FPU; shorter bursts are zero-padded).
+ *          The power spectra of the three axes are summed and reduced to:
+ *          - RMS of the burst, in the input unit (mg)
+ *          - peak frequency: the strongest bin above DC
+ *          - BANDS equal-width band RMS values between DC and Nyquist
+ *
+ *          The band RMS values add up, in power, to the RMS of the burst
+ *          without its mean (Parseval), so they can be compared directly.
+ *
+ *          realFft() leaves its output in the CMSIS-DSP arm_rfft_fast_f32()
+ *          layout: [X0, X(N/2), re X1, im X1, ...]. Device OS does not ship
+ *          CMSIS-DSP to applications, so it is implemented here as an N/2
+ *          point complex radix-2 FFT plus the real split; a build that
+ *          links CMSIS-DSP can swap it in without touching the callers.
+ */
+
+#ifndef __SPECTRALFEATURES_H
+#define __SPECTRALFEATURES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace SpectralFeatures {
+
+/** @brief Points per FFT; a power of two. */
+constexpr size_t FFT_SIZE = 32;
+
+/** @brief Equal-width bands between DC and Nyquist. */
+constexpr size_t BANDS = 4;
+
+static_assert((FFT_SIZE & (FFT_SIZE - 1)) == 0 && FFT_SIZE >= 8, "FFT_SIZE must be a power of two");
+static_assert((FFT_SIZE / 2) % BANDS == 0, "BANDS must divide the FFT_SIZE / 2 bins above DC");
+
+struct Features {
+    float rmsMg;                /**< RMS of the burst, mean removed */
+    float peakHz;               /**< Frequency of the strongest bin above DC */
+    float bandRmsMg[BANDS];     /**< RMS per band, lowest band first */
+};
+
+/**
+ * @brief In-place real FFT of FFT_SIZE samples, CMSIS-DSP output layout
+ */
+void realFft(float *data);
+
+/**
+ * @brief Features of one burst
+ *
+ * @param axes Three arrays (X, Y, Z) of @p samples values each
+ * @param samples Samples per axis, at most FFT_SIZE
+ * @param sampleHz Sample rate
+ * @param out Filled in; all zero when @p samples is 0
+ */
+void extract(const float *const axes[3], size_t samples, float sampleHz, Features &out);
+
+} // namespace SpectralFeatures
+
+#endif /* __SPECTRALFEATURES_H */
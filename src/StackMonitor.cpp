@@ -0,0 +1,65 @@
+#include "StackMonitor.h"
+#include "Config.h"
+
+namespace StackMonitor {
+
+static const uint32_t PATTERN = 0xA5A5A5A5;
+
+// Left unpainted just below the caller, for paint()'s own frame
+static const size_t GUARD = 128;
+
+struct Paint {
+    const uint32_t *bottom;     // Lowest painted word
+    size_t words;               // Painted words
+    size_t stackBytes;          // Size the thread was created with
+};
+
+static const char *const NAMES[THREAD_COUNT] = {"app", "sensor", "archive", "publish"};
+static Paint paints[THREAD_COUNT];
+
+__attribute__((noinline)) void paint(Thread thread, size_t stackBytes) {
+#if STACK_MONITOR_ENABLED
+    if (thread >= THREAD_COUNT || stackBytes <= STACK_PAINT_RESERVE + GUARD) {
+        return;
+    }
+    uint8_t marker;
+    uintptr_t top = ((uintptr_t)&marker - GUARD) & ~(uintptr_t)3;
+    uintptr_t bottom = ((uintptr_t)&marker - (stackBytes - STACK_PAINT_RESERVE) + 3) & ~(uintptr_t)3;
+    volatile uint32_t *word = (volatile uint32_t *)bottom;
+    while ((uintptr_t)word < top) {
+        *word++ = PATTERN;
+    }
+    paints[thread].bottom = (const uint32_t *)bottom;
+    paints[thread].words = (top - bottom) / sizeof(uint32_t);
+    paints[thread].stackBytes = stackBytes;
+#endif
+}
+
+int headroom(Thread thread) {
+    if (thread >= THREAD_COUNT || paints[thread].words == 0) {
+        return -1;
+    }
+    const volatile uint32_t *word = paints[thread].bottom;
+    size_t untouched = 0;
+    while (untouched < paints[thread].words && word[untouched] == PATTERN) {
+        untouched++;
+    }
+    return (int)(untouched * sizeof(uint32_t));
+}
+
+void writeStatus(JSONWriter &writer) {
+    writer.name("stacks").beginObject();
+    for (size_t ii = 0; ii < THREAD_COUNT; ii++) {
+        int free = headroom((Thread)ii);
+        if (free < 0) {
+            continue;
+        }
+        writer.name(NAMES[ii]).beginObject();
+        writer.name("size").value((int)paints[ii].stackBytes);
+        writer.name("free").value(free);
+        writer.endObject();
+    }
+    writer.endObject();
+}
+
+} // namespace StackMonitor
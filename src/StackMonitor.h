@@ -0,0 +1,61 @@
+/**
+ * @file StackMonitor.h
+ * @brief Stack high-water marks for the application and worker threads.
+ *
+ * @details Each instrumented thread calls paint() first thing, which fills
+ *          its stack below the caller with a known pattern, down to
+ *          STACK_PAINT_RESERVE bytes short of the stack size (what the
+ *          thread start-up may already have used above the call is not
+ *          known, so that much is never painted). headroom() scans up from
+ *          the bottom of the paint for the first word a call has
+ *          overwritten: everything below it has never been used, and the
+ *          stack could shrink by that much.
+ *
+ *          Instrumented: the application thread (from setup(), against
+ *          APP_THREAD_STACK), the sensor and event archive threads, and the
+ *          BackgroundPublishRK publish thread through its thread start
+ *          hook. The Device OS system thread and the application watchdog
+ *          thread run no application code before their work, so they
+ *          cannot be painted.
+ *
+ *          A headroom of 0 means the whole paint was used and the thread
+ *          came within STACK_PAINT_RESERVE of its limit, or past it.
+ */
+
+#ifndef __STACKMONITOR_H
+#define __STACKMONITOR_H
+
+#include "Particle.h"
+
+namespace StackMonitor {
+
+/** @brief The threads that can be painted. */
+enum Thread : uint8_t {
+    APP = 0,
+    SENSOR,
+    ARCHIVE,
+    PUBLISH,
+    THREAD_COUNT
+};
+
+/**
+ * @brief Paint the calling thread's stack; call first thing in the thread
+ *
+ * @param thread which thread this is
+ * @param stackBytes the stack size it was created with
+ */
+void paint(Thread thread, size_t stackBytes);
+
+/**
+ * @brief Bytes at the bottom of @p thread's stack never used since paint(), or -1 if not painted
+ */
+int headroom(Thread thread);
+
+/**
+ * @brief Write {"app":{"size":n,"free":n},...} for the painted threads to an open JSON object as "stacks"
+ */
+void writeStatus(JSONWriter &writer);
+
+} // namespace StackMonitor
+
+#endif /* __STACKMONITOR_H */
@@ -2,7 +2,7 @@
 
 #include "StateMachine.h"
 
-// Top-level state handlers used by the main loop switch
+// Top-level state handlers, dispatched from the StateTable rows
 void handleIdleState();
 void handleSleepingState();
 void handleReportingState();
@@ -10,7 +10,22 @@ void handleConnectingState();
 void handleFirmwareUpdateState();
 void handleErrorState();
 
+// Enter hooks, run once on entry after the transition is logged
+void enterSleepingState(State from);
+void enterConnectingState(State from);
+void enterFirmwareUpdateState(State from);
+void enterErrorState(State from);
+
+// Exit hooks, run once on the way out before the transition is logged
+void exitFirmwareUpdateState(State to);
+
+// Adds the post-connect TaskScheduler task; call from setup() after the housekeeping tasks
+void setupConnectingState();
+
 // Mode-specific handlers for COUNTING and OCCUPANCY
 void handleCountingMode();
 void handleOccupancyMode();
 void updateOccupancyState();
+
+// Milliseconds until the open occupancy session times out (0 if none)
+uint32_t occupancyMsRemaining();
@@ -14,10 +14,67 @@ enum State {
   FIRMWARE_UPDATE_STATE
 };
 
+// Why the state changed; traced with every transition. Append only, the
+// trace dump names them by value.
+enum TransitionReason : uint8_t {
+  REASON_UNSPECIFIED,
+  REASON_BOOT,                // setup() default
+  REASON_NO_TIME,             // Time not valid, connecting to sync it
+  REASON_OTA_RESET,           // First boot after a firmware update
+  REASON_SENSOR_FAILED,       // Sensor did not initialize, connecting to report it
+  REASON_MAINTAIN_CONNECTION, // CONNECTED mode keeps the cloud session up
+  REASON_OUT_OF_MEMORY,
+  REASON_USER_SWITCH,
+  REASON_SCHEDULED_REPORT,
+  REASON_STORE_ONLY,          // Report queued, power tier does not connect
+  REASON_REPORT_DONE,
+  REASON_PARK_OPEN,
+  REASON_PARK_CLOSED,
+  REASON_DISCONNECT_TIMEOUT,  // Cloud/modem did not go off within budget
+  REASON_SENSOR_BUSY,         // Sleep deferred for an event or the LED
+  REASON_TRAFFIC,             // Too busy for napping to pay
+  REASON_SERVICE_REQUEST,     // Button wake
+  REASON_OCCUPANCY_TIMEOUT,
+  REASON_SENSOR_WAKE,         // Sensor wake with nothing else due
+  REASON_WAKE,                // Wake with nothing else due
+  REASON_CONNECT_BUDGET,      // Stayed connected past the budget
+  REASON_QUEUE_DRAINED,       // Low-power idle with nothing left to send
+  REASON_WEAK_SIGNAL,         // Signal gate deferred the connect
+  REASON_CONNECTED,
+  REASON_CONNECT_TIMEOUT,
+  REASON_UPDATE_PENDING,
+  REASON_UPDATE_DONE,
+  REASON_UPDATE_CANCELLED,    // Button pressed in FIRMWARE_UPDATE_STATE
+  REASON_UPDATE_TIMEOUT,
+  REASON_ERROR_CLEARED,
+  REASON_SCHEDULED_SAMPLE,    // SCHEDULED-mode sample wake, back to sleep
+  REASON_CONNECT_BACKOFF,     // Report queued, connects backing off after failures
+  REASON_SURPLUS_DRAIN,       // Extra connect to send the backlog while charging
+  REASON_COLD_DEFER,          // Report queued, enclosure too cold to transmit
+  REASON_FLAP_DAMPED,         // Cloud dropped CONNECT_FLAP_LIMIT times, off until the next report
+  REASON_BROWNOUT_HOLD,       // Battery failing, radio held off (BrownoutGuard)
+  REASON_COUNT
+};
+
 // Global state variables (defined in Generalized-Core-Counter.cpp)
 extern State state;
 extern State oldState;
-extern char stateNames[7][16];
+extern TransitionReason stateReason;
+extern const char *const stateNames[7];
+
+// Move the machine to @p next; StateTable logs and traces it with @p reason
+inline void setState(State next, TransitionReason reason) {
+  state = next;
+  stateReason = reason;
+}
+
+// Name of a TransitionReason for logs and trace dumps; "UNKNOWN" if out of range
+const char *transitionReasonName(int reason);
+
+// Name of a state for logs and JSON; "Unknown" if out of range
+inline const char *stateName(int s) {
+  return (s >= 0 && s < (int)(sizeof(stateNames) / sizeof(stateNames[0]))) ? stateNames[s] : "Unknown";
+}
 
 // Sleep configuration and RTC/watchdog (defined in Generalized-Core-Counter.cpp)
 extern SystemSleepConfiguration config;
@@ -53,3 +110,6 @@ extern Timer countSignalTimer;
 // Application-level helpers implemented in Generalized-Core-Counter.cpp
 void dailyCleanup();
 void publishData();
+
+// Webhook response (HTTP status, -1 for none), on the application thread via AppMessages
+void handleHookResponse(int status);
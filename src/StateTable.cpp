@@ -0,0 +1,137 @@
+#include "StateTable.h"
+#include "StateHandlers.h"
+#include "PhaseMarker.h"
+
+namespace StateTable {
+
+struct Row {
+    void (*enter)(State from);  // After the transition is logged; may be nullptr
+    void (*run)();              // Each pass while in the state; nullptr for INITIALIZATION_STATE
+    void (*exit)(State to);     // Before the transition is logged; may be nullptr
+};
+
+// Indexed by State
+static const Row table[NUM_STATES] = {
+    /* INITIALIZATION_STATE  */ {nullptr, nullptr, nullptr},
+    /* ERROR_STATE           */ {enterErrorState, handleErrorState, nullptr},
+    /* IDLE_STATE            */ {nullptr, handleIdleState, nullptr},
+    /* SLEEPING_STATE        */ {enterSleepingState, handleSleepingState, nullptr},
+    /* CONNECTING_STATE      */ {enterConnectingState, handleConnectingState, nullptr},
+    /* REPORTING_STATE       */ {nullptr, handleReportingState, nullptr},
+    /* FIRMWARE_UPDATE_STATE */ {enterFirmwareUpdateState, handleFirmwareUpdateState, exitFirmwareUpdateState},
+};
+
+static_assert(FIRMWARE_UPDATE_STATE == NUM_STATES - 1, "StateTable rows must cover every State");
+
+struct Block {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    Stats stats;
+};
+
+// Checked with magic only, like the trace ring: a torn count costs one bad number
+static constexpr uint32_t BLOCK_MAGIC = 0x57a7e5a1;
+static constexpr uint16_t BLOCK_VERSION = 1;
+
+static retained Block block;
+
+static State current = INITIALIZATION_STATE;   // State whose enter hook has run
+static uint32_t enteredMs = 0;
+
+void setup() {
+    if (block.magic != BLOCK_MAGIC || block.version != BLOCK_VERSION) {
+        memset(&block, 0, sizeof(block));
+        block.magic = BLOCK_MAGIC;
+        block.version = BLOCK_VERSION;
+    }
+    enteredMs = millis();
+}
+
+static bool valid(State s) {
+    return (size_t)s < NUM_STATES;
+}
+
+static void transition(State from, State to) {
+    uint32_t nowMs = millis();
+    Stats &s = block.stats;
+    s.timeMs[from] += nowMs - enteredMs;
+    enteredMs = nowMs;
+    if (s.entries[to] != UINT16_MAX) {
+        s.entries[to]++;
+    }
+    if (s.edges[from][to] != UINT16_MAX) {
+        s.edges[from][to]++;
+    }
+
+    if (table[from].exit) {
+        table[from].exit(to);
+    }
+    current = to;
+    PhaseMarker::noteState(to);
+    publishStateTransition();
+    if (table[to].enter) {
+        table[to].enter(from);
+    }
+}
+
+void dispatch() {
+    // A hook may move the machine again; the next pass picks that up
+    if (state != current && valid(state)) {
+        transition(current, state);
+    }
+    if (valid(current) && table[current].run) {
+        table[current].run();
+    }
+}
+
+Stats stats() {
+    Stats s = block.stats;
+    s.timeMs[current] += millis() - enteredMs;
+    return s;
+}
+
+size_t formatReport(char *buffer, size_t bufferSize) {
+    Stats s = stats();
+
+    JSONBufferWriter writer(buffer, bufferSize - 1);
+    writer.beginObject();
+    writer.name("ms").beginObject();
+    for (size_t ii = 0; ii < NUM_STATES; ii++) {
+        if (s.timeMs[ii]) {
+            writer.name(stateName(ii)).value((unsigned long)s.timeMs[ii]);
+        }
+    }
+    writer.endObject();
+    writer.name("n").beginObject();
+    for (size_t ii = 0; ii < NUM_STATES; ii++) {
+        if (s.entries[ii]) {
+            writer.name(stateName(ii)).value((int)s.entries[ii]);
+        }
+    }
+    writer.endObject();
+    writer.name("edges").beginObject();
+    for (size_t from = 0; from < NUM_STATES; from++) {
+        for (size_t to = 0; to < NUM_STATES; to++) {
+            if (s.edges[from][to]) {
+                char edge[40];
+                snprintf(edge, sizeof(edge), "%s>%s", stateName(from), stateName(to));
+                writer.name(edge).value((int)s.edges[from][to]);
+            }
+        }
+    }
+    writer.endObject();
+    writer.endObject();
+
+    if (writer.dataSize() >= bufferSize - 1) {
+        buffer[0] = 0;
+        return 0;
+    }
+    buffer[writer.dataSize()] = 0;
+
+    memset(&block.stats, 0, sizeof(block.stats));
+    enteredMs = millis();
+    return writer.dataSize();
+}
+
+} // namespace StateTable
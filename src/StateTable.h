@@ -0,0 +1,67 @@
+/**
+ * @file StateTable.h
+ * @brief Table-driven dispatch of the main State machine, with per-state counts.
+ *
+ * @details Each State has a row with optional enter and exit hooks and the
+ *          handler loop() runs while in it. Handlers still move the machine
+ *          by assigning the global state; dispatch() sees the change on the
+ *          next pass, runs the old state's exit hook, logs the transition
+ *          and runs the new state's enter hook before its handler, so no
+ *          handler checks state != oldState itself.
+ *
+ *          Every transition is counted in a small retained block: entries
+ *          and millis() spent in each state, and a count per from -> to
+ *          edge. Ping-pong between two states shows up as a large edge
+ *          count, wasted awake time as a large share in a state. The block
+ *          is published as a "states" event with the daily cleanup and then
+ *          cleared; it survives resets and naps, not HIBERNATE.
+ */
+
+#ifndef __STATETABLE_H
+#define __STATETABLE_H
+
+#include "Particle.h"
+#include "StateMachine.h"
+
+namespace StateTable {
+
+/** @brief Number of State values */
+static constexpr size_t NUM_STATES = 7;
+
+/** @brief Counts since the last daily report */
+struct Stats {
+    uint32_t timeMs[NUM_STATES];                ///< millis() spent in each state
+    uint16_t entries[NUM_STATES];               ///< Times each state was entered
+    uint16_t edges[NUM_STATES][NUM_STATES];     ///< Transitions, [from][to]
+};
+
+/**
+ * @brief Validate the retained stats; call early in setup()
+ */
+void setup();
+
+/**
+ * @brief Run the enter/exit hooks for a state change, then the current state's handler
+ *
+ * @details Call once per loop() pass in place of a switch on state.
+ */
+void dispatch();
+
+/**
+ * @brief Counts since the last report, with the time in the current state so far
+ */
+Stats stats();
+
+/**
+ * @brief Format the counts for the daily "states" event and clear them
+ *
+ * {"ms":{"<state>":n,...},"n":{"<state>":n,...},"edges":{"<from>><to>":n,...}}
+ * with only the states and edges seen.
+ *
+ * @return Length written, or 0 if it did not fit (the counts are kept)
+ */
+size_t formatReport(char *buffer, size_t bufferSize);
+
+} // namespace StateTable
+
+#endif /* __STATETABLE_H */
@@ -0,0 +1,124 @@
+#include "TaskScheduler.h"
+
+TaskScheduler *TaskScheduler::_instance;
+
+// [static]
+TaskScheduler &TaskScheduler::instance() {
+    if (!_instance) {
+        _instance = new TaskScheduler();
+    }
+    return *_instance;
+}
+
+TaskScheduler::TaskScheduler() {
+}
+
+TaskScheduler::~TaskScheduler() {
+}
+
+// [static]
+size_t TaskScheduler::histBucket(uint32_t us) {
+    uint32_t limitUs = 1000;
+    size_t bucket = 0;
+    while (bucket < NUM_HIST_BUCKETS - 1 && us >= limitUs) {
+        limitUs *= 4;
+        bucket++;
+    }
+    return bucket;
+}
+
+int TaskScheduler::add(const char *name, TaskFn fn, uint32_t periodMs, uint32_t budgetUs, uint32_t deadlineMs) {
+    return addTask(name, fn, periodMs, budgetUs, deadlineMs, false);
+}
+
+int TaskScheduler::addSignaled(const char *name, TaskFn fn, uint32_t budgetUs, uint32_t deadlineMs) {
+    return addTask(name, fn, 0, budgetUs, deadlineMs, true);
+}
+
+int TaskScheduler::addTask(const char *name, TaskFn fn, uint32_t periodMs, uint32_t budgetUs, uint32_t deadlineMs, bool signaled) {
+    if (_count >= MAX_TASKS || !fn) {
+        Log.error("TaskScheduler: cannot add %s", name);
+        return -1;
+    }
+    Task &task = _tasks[_count];
+    task.name = name;
+    task.fn = fn;
+    task.periodMs = periodMs;
+    task.budgetUs = budgetUs;
+    task.deadlineMs = deadlineMs;
+    task.signaled = signaled;
+    task.pending = false;
+    task.dueSinceMs = 0;
+    task.lastRunMs = millis() - periodMs;   // Due on the first pass
+    return (int)_count++;
+}
+
+void TaskScheduler::signal(int id) {
+    if (id >= 0 && (size_t)id < _count) {
+        _tasks[id].pending = true;
+    }
+}
+
+void TaskScheduler::beginPass(uint8_t tag) {
+    _passStartUs = micros();
+    _passTag = tag < MAX_PASS_TAGS ? tag : MAX_PASS_TAGS - 1;
+}
+
+void TaskScheduler::loop() {
+    for (size_t ii = 0; ii < _count; ii++) {
+        Task &task = _tasks[ii];
+        uint32_t nowMs = millis();
+
+        bool due = task.signaled ? task.pending : (nowMs - task.lastRunMs) >= task.periodMs;
+        if (!due) {
+            continue;
+        }
+        if (task.dueSinceMs == 0) {
+            task.dueSinceMs = nowMs ? nowMs : 1;
+        }
+
+        // Defer if it would not fit, unless it has waited out its deadline
+        uint32_t usedUs = micros() - _passStartUs;
+        bool fits = usedUs + task.budgetUs <= _loopBudgetUs;
+        bool overdue = (nowMs - task.dueSinceMs) >= task.deadlineMs;
+        if (!fits && !overdue) {
+            task.stats.deferrals++;
+            continue;
+        }
+
+        task.lastRunMs = nowMs;
+        if (task.signaled) {
+            task.pending = false;
+        }
+        uint32_t startUs = micros();
+        bool done = task.fn();
+        uint32_t elapsedUs = micros() - startUs;
+        if (task.signaled && !done) {
+            task.pending = true;
+        }
+        task.dueSinceMs = 0;
+
+        task.stats.runs++;
+        task.stats.totalUs += elapsedUs;
+        if (elapsedUs > task.stats.maxUs) {
+            task.stats.maxUs = elapsedUs;
+        }
+        task.stats.hist[histBucket(elapsedUs)]++;
+        if (elapsedUs > task.budgetUs) {
+            task.stats.overruns++;
+        }
+    }
+
+    uint32_t passUs = micros() - _passStartUs;
+    PassStats *counts[] = {&_pass, &_tagPass[_passTag]};
+    for (PassStats *pass : counts) {
+        pass->passes++;
+        if (passUs > pass->maxUs) {
+            pass->maxUs = passUs;
+        }
+        if (passUs > _loopBudgetUs) {
+            pass->overBudget++;
+        }
+        pass->hist[histBucket(passUs)]++;
+    }
+}
@@ -0,0 +1,187 @@
+/**
+ * @file TaskScheduler.h
+ * @brief Cooperative scheduler for the housekeeping work done from loop().
+ *
+ * @details Each task is a plain function with a period, a time budget and a
+ *          deadline. loop() runs the tasks that are due, in the order they
+ *          were added, until the pass has used LOOP_BUDGET_MS (100 ms by
+ *          default, counted from beginPass()). A task that would not fit is
+ *          deferred to a later pass, unless it has already been deferred for
+ *          its deadline, in which case it runs anyway so nothing starves.
+ *          Nothing is preempted: the budget holds as long as each task stays
+ *          within its own budget, and the overrun counts show which do not.
+ *
+ *          Signaled tasks replace "pending" flags: they only run after
+ *          signal(), which is safe from system-thread callbacks, and stay
+ *          signaled until their function returns true.
+ *
+ *          Every task run and every pass is also counted in a histogram
+ *          with power-of-four buckets, and passes are kept per tag (the
+ *          application's State), so the longest stalls can be compared
+ *          with the application watchdog timeout.
+ */
+
+#ifndef __TASKSCHEDULER_H
+#define __TASKSCHEDULER_H
+
+#include "Particle.h"
+
+/**
+ * This class is a singleton; you do not create one as a global, on the stack, or with new.
+ *
+ * Add tasks from setup():
+ * TaskScheduler::instance().add("queue", queueTask, 0, 10000, 500);
+ *
+ * In loop(), call beginPass() first and loop() after the state handler:
+ * TaskScheduler::instance().beginPass(state);
+ * ...
+ * TaskScheduler::instance().loop();
+ */
+class TaskScheduler {
+public:
+    /**
+     * @brief Maximum number of tasks; add() fails beyond this.
+     *
+     * The application checks its own count against it at compile time
+     * (Generalized-Core-Counter.cpp), with every optional task enabled.
+     */
+    static constexpr size_t MAX_TASKS = 24;
+
+    /** @brief Pass tags kept apart in passStats(tag); larger tags share the last slot. */
+    static constexpr size_t MAX_PASS_TAGS = 8;
+
+    /**
+     * @brief Run time histogram buckets, by powers of four:
+     *        <1, <4, <16, <64, <256, <1024, <4096, >=4096 ms
+     */
+    static constexpr size_t NUM_HIST_BUCKETS = 8;
+
+    /** @brief Histogram bucket for a run of @p us microseconds. */
+    static size_t histBucket(uint32_t us);
+
+    /**
+     * @brief Task function
+     *
+     * @return true when the work is done. Only signaled tasks use this: they
+     *         stay signaled, and run again on a later pass, until it is true.
+     */
+    typedef bool (*TaskFn)();
+
+    /** @brief Per-task run time statistics since boot. */
+    struct TaskStats {
+        uint32_t runs;          ///< Times the function was called
+        uint32_t maxUs;         ///< Longest single run
+        uint64_t totalUs;       ///< Sum of all runs
+        uint32_t overruns;      ///< Runs longer than the task's budget
+        uint32_t deferrals;     ///< Passes where the task was due but did not fit
+        uint32_t hist[NUM_HIST_BUCKETS];    ///< Runs by duration (histBucket())
+        uint32_t avgUs() const { return runs ? (uint32_t)(totalUs / runs) : 0; }
+    };
+
+    /** @brief Whole-pass statistics since boot. */
+    struct PassStats {
+        uint32_t passes;        ///< Calls to loop()
+        uint32_t overBudget;    ///< Passes that ended past the loop budget
+        uint32_t maxUs;         ///< Longest pass, beginPass() to end of loop()
+        uint32_t hist[NUM_HIST_BUCKETS];    ///< Passes by duration (histBucket())
+    };
+
+    /**
+     * @brief Gets the singleton instance of this class, allocating it if necessary
+     */
+    static TaskScheduler &instance();
+
+    /**
+     * @brief Set the time allowed for one pass of the application loop (default 100 ms)
+     */
+    TaskScheduler &withLoopBudgetMs(uint32_t ms) { _loopBudgetUs = ms * 1000; return *this; }
+
+    /**
+     * @brief Add a periodic task
+     *
+     * @param name Short name for statistics; must be a string literal (the pointer is kept)
+     * @param fn Function to run
+     * @param periodMs Minimum time between runs (0 = every pass)
+     * @param budgetUs Expected worst-case run time; used to decide whether it fits in the pass
+     * @param deadlineMs How long the task may be deferred for the loop budget (0 = never deferred)
+     * @return Task id, or -1 if the table is full
+     */
+    int add(const char *name, TaskFn fn, uint32_t periodMs, uint32_t budgetUs, uint32_t deadlineMs);
+
+    /**
+     * @brief Add a task that only runs after signal()
+     *
+     * @return Task id, or -1 if the table is full
+     */
+    int addSignaled(const char *name, TaskFn fn, uint32_t budgetUs, uint32_t deadlineMs);
+
+    /**
+     * @brief Request a run of a signaled task; safe from any thread
+     */
+    void signal(int id);
+
+    /**
+     * @brief Mark the start of an application loop pass; call first thing in loop()
+     *
+     * @param tag What the pass is doing (the application passes its State), for passStats(tag)
+     */
+    void beginPass(uint8_t tag = 0);
+
+    /**
+     * @brief Restart the pass clock after System.sleep() returns, so time asleep is not counted
+     */
+    void resumePass() { _passStartUs = micros(); }
+
+    /**
+     * @brief Run the tasks that are due and fit in what is left of the pass
+     */
+    void loop();
+
+    /** @brief Number of tasks added. */
+    size_t taskCount() const { return _count; }
+
+    /** @brief Name of task @p id. */
+    const char *taskName(size_t id) const { return _tasks[id].name; }
+
+    /** @brief Statistics for task @p id. */
+    const TaskStats &taskStats(size_t id) const { return _tasks[id].stats; }
+
+    /** @brief Whole-pass statistics. */
+    const PassStats &passStats() const { return _pass; }
+
+    /** @brief Statistics for the passes begun with @p tag. */
+    const PassStats &passStats(size_t tag) const { return _tagPass[tag < MAX_PASS_TAGS ? tag : MAX_PASS_TAGS - 1]; }
+
+protected:
+    TaskScheduler();
+    virtual ~TaskScheduler();
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    struct Task {
+        const char *name;
+        TaskFn fn;
+        uint32_t periodMs;
+        uint32_t budgetUs;
+        uint32_t deadlineMs;
+        bool signaled;              ///< Runs only when pending is set
+        volatile bool pending;      ///< Set by signal()
+        uint32_t dueSinceMs;        ///< millis() when the task first became due and was not run
+        uint32_t lastRunMs;         ///< millis() at the start of the last run
+        TaskStats stats;
+    };
+
+    int addTask(const char *name, TaskFn fn, uint32_t periodMs, uint32_t budgetUs, uint32_t deadlineMs, bool signaled);
+
+    Task _tasks[MAX_TASKS] = {};
+    size_t _count = 0;
+    uint32_t _loopBudgetUs = 100000;
+    uint32_t _passStartUs = 0;
+    uint8_t _passTag = 0;
+    PassStats _pass = {};
+    PassStats _tagPass[MAX_PASS_TAGS] = {};
+
+    static TaskScheduler *_instance;
+};
+
+#endif /* __TASKSCHEDULER_H */
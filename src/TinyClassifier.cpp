@@ -0,0 +1,252 @@
+#include "TinyClassifier.h"
+#include "AssetStore.h"
+#include "Config.h"
+#include "ISensor.h"
+#include "Particle.h"
+#include <math.h>
+
+#ifdef CLASSIFIER_MODELS_HEADER
+#include CLASSIFIER_MODELS_HEADER
+#endif
+
+namespace TinyClassifier {
+
+// Activations ping-pong between the two halves; nothing is allocated per run
+static int8_t arena[2][CLASSIFIER_MAX_WIDTH];
+
+static Stats counts;
+
+// Models setup() passed, by slot: accel, vibration, OpenMV
+static const Model *usable[3] = {nullptr, nullptr, nullptr};
+
+static int slotFor(SensorType type) {
+    switch (type) {
+    case SensorType::ACCEL_PRESENCE:     return 0;
+    case SensorType::VIBRATION_ADVANCED: return 1;
+    case SensorType::OPENMV_OCCUPANCY:   return 2;
+    default:                             return -1;
+    }
+}
+
+static bool fits(const Model &model) {
+    if (model.inputs == 0 || model.inputs > MAX_FEATURES || model.inputs > CLASSIFIER_MAX_WIDTH ||
+        model.layerCount == 0 || !model.inputScale || !model.layers) {
+        return false;
+    }
+    uint16_t width = model.inputs;
+    for (uint8_t ii = 0; ii < model.layerCount; ii++) {
+        const Layer &layer = model.layers[ii];
+        if (layer.inputs != width || layer.outputs == 0 || layer.outputs > CLASSIFIER_MAX_WIDTH ||
+            !layer.weights || !layer.bias || layer.shift < 0 || layer.shift > 31) {
+            return false;
+        }
+        width = layer.outputs;
+    }
+    return width == NUM_LABELS;
+}
+
+static void check(int slot, const Model *model) {
+    if (!model) {
+        return;
+    }
+    if (!fits(*model)) {
+        Log.error("TinyClassifier: model %s does not fit the %d-wide arena; not used",
+                  model->name ? model->name : "?", CLASSIFIER_MAX_WIDTH);
+        return;
+    }
+    usable[slot] = model;
+    Log.info("TinyClassifier: model %s, %u inputs, %u layers",
+             model->name ? model->name : "?", (unsigned)model->inputs, (unsigned)model->layerCount);
+}
+
+// An AssetStore CLASSIFIER_MODEL blob: BlobModel, inputScale[inputs], then
+// per layer a BlobLayer, bias[outputs], weights[outputs * inputs] padded
+// to 4 bytes. The Model and Layers point into the blob.
+struct BlobModel {
+    uint8_t slot;               // As slotFor()
+    uint8_t layerCount;
+    uint16_t inputs;
+};
+struct BlobLayer {
+    uint16_t inputs;
+    uint16_t outputs;
+    int32_t multiplier;
+    int8_t shift;
+    uint8_t relu;
+    uint16_t reserved;
+};
+
+static uint32_t blob[CLASSIFIER_ASSET_BYTES / 4];      // Word-aligned for the float and int32 tables
+static Layer blobLayers[CLASSIFIER_MAX_LAYERS];
+static Model blobModel;
+static char blobName[16];
+
+// Point blobModel into the loaded blob; the slot it is for, or -1
+static int parseBlob(size_t length) {
+    const uint8_t *base = (const uint8_t *)blob;
+    size_t offset = sizeof(BlobModel);
+    if (length < offset) {
+        return -1;
+    }
+    const BlobModel *hdr = (const BlobModel *)base;
+    if (hdr->slot > 2 || hdr->layerCount == 0 || hdr->layerCount > CLASSIFIER_MAX_LAYERS) {
+        return -1;
+    }
+    blobModel.inputs = hdr->inputs;
+    blobModel.inputScale = (const float *)(base + offset);
+    offset += (size_t)hdr->inputs * sizeof(float);
+    for (uint8_t ll = 0; ll < hdr->layerCount; ll++) {
+        if (offset + sizeof(BlobLayer) > length) {
+            return -1;
+        }
+        const BlobLayer *bl = (const BlobLayer *)(base + offset);
+        offset += sizeof(BlobLayer);
+        Layer &layer = blobLayers[ll];
+        layer.inputs = bl->inputs;
+        layer.outputs = bl->outputs;
+        layer.multiplier = bl->multiplier;
+        layer.shift = bl->shift;
+        layer.relu = bl->relu != 0;
+        layer.bias = (const int32_t *)(base + offset);
+        offset += (size_t)bl->outputs * sizeof(int32_t);
+        layer.weights = (const int8_t *)(base + offset);
+        offset += ((size_t)bl->outputs * bl->inputs + 3) & ~(size_t)3;
+    }
+    if (offset > length) {
+        return -1;
+    }
+    blobModel.layerCount = hdr->layerCount;
+    blobModel.layers = blobLayers;
+    blobModel.name = blobName;
+    return hdr->slot;
+}
+
+void setup() {
+#ifdef CLASSIFIER_MODEL_ACCEL
+    check(0, &CLASSIFIER_MODEL_ACCEL);
+#endif
+#ifdef CLASSIFIER_MODEL_VIBRATION
+    check(1, &CLASSIFIER_MODEL_VIBRATION);
+#endif
+#ifdef CLASSIFIER_MODEL_OPENMV
+    check(2, &CLASSIFIER_MODEL_OPENMV);
+#endif
+
+    // A delivered model takes the place of the compiled-in one for its slot
+    uint16_t version = 0;
+    size_t length = AssetStore::load(AssetStore::CLASSIFIER_MODEL, blob, sizeof(blob), version);
+    if (length > 0) {
+        snprintf(blobName, sizeof(blobName), "asset v%u", (unsigned)version);
+        int slot = parseBlob(length);
+        if (slot < 0) {
+            Log.error("TinyClassifier: model %s is malformed; not used", blobName);
+        } else {
+            check(slot, &blobModel);
+        }
+    }
+}
+
+const Model *modelFor(SensorType type) {
+    int slot = slotFor(type);
+    return slot < 0 ? nullptr : usable[slot];
+}
+
+static int8_t saturate(int32_t value) {
+    return (int8_t)(value < -128 ? -128 : value > 127 ? 127 : value);
+}
+
+// acc * multiplier / 2^31, then a rounding right shift (gemmlowp / TFLM style)
+static int32_t requantize(int32_t acc, int32_t multiplier, int shift) {
+    int64_t product = (int64_t)acc * multiplier;
+    int32_t high = (int32_t)((product + ((int64_t)1 << 30)) >> 31);
+    if (shift == 0) {
+        return high;
+    }
+    int32_t mask = (int32_t)((1u << shift) - 1);
+    int32_t remainder = high & mask;
+    int32_t threshold = (mask >> 1) + (high < 0 ? 1 : 0);
+    return (high >> shift) + (remainder > threshold ? 1 : 0);
+}
+
+Label run(const Model &model, const float *features, int8_t &score) {
+    score = 0;
+    if (!features || !fits(model)) {
+        return NOISE;
+    }
+    uint32_t startUs = micros();
+
+    for (uint16_t ii = 0; ii < model.inputs; ii++) {
+        float scaled = roundf(features[ii] * model.inputScale[ii]);
+        arena[0][ii] = (int8_t)(scaled < -128.0f ? -128 : scaled > 127.0f ? 127 : (int)scaled);
+    }
+    int from = 0;
+    for (uint8_t ll = 0; ll < model.layerCount; ll++) {
+        const Layer &layer = model.layers[ll];
+        const int8_t *in = arena[from];
+        int8_t *out = arena[from ^ 1];
+        for (uint16_t oo = 0; oo < layer.outputs; oo++) {
+            const int8_t *row = &layer.weights[(size_t)oo * layer.inputs];
+            int32_t acc = layer.bias[oo];
+            for (uint16_t ii = 0; ii < layer.inputs; ii++) {
+                acc += (int32_t)row[ii] * in[ii];
+            }
+            int8_t value = saturate(requantize(acc, layer.multiplier, layer.shift));
+            out[oo] = (layer.relu && value < 0) ? 0 : value;
+        }
+        from ^= 1;
+    }
+
+    Label best = PERSON;
+    for (uint8_t ii = 1; ii < NUM_LABELS; ii++) {
+        if (arena[from][ii] > arena[from][best]) {
+            best = (Label)ii;
+        }
+    }
+    score = arena[from][best];
+
+    uint32_t elapsedUs = micros() - startUs;
+    counts.runs++;
+    counts.labels[best]++;
+    counts.lastUs = elapsedUs;
+    if (elapsedUs > counts.maxUs) {
+        counts.maxUs = elapsedUs;
+    }
+    counts.totalUs += elapsedUs;
+    return best;
+}
+
+bool screen(SensorType type, const float *features, size_t count, uint8_t &classBits) {
+    classBits = 0;
+    const Model *model = modelFor(type);
+    if (!model || count < model->inputs) {
+        return true;
+    }
+    int8_t score;
+    Label label = run(*model, features, score);
+    if (label == NOISE) {
+        return false;
+    }
+    classBits = (uint8_t)((label + 1) << SensorEvent::CLASS_SHIFT);
+    return true;
+}
+
+const char *labelName(Label label) {
+    switch (label) {
+    case PERSON:  return "person";
+    case VEHICLE: return "vehicle";
+    case ANIMAL:  return "animal";
+    case NOISE:   return "noise";
+    default:      return "?";
+    }
+}
+
+const Stats &stats() {
+    return counts;
+}
+
+float chargeUah() {
+    // uA x us = 1e-6 uAs; 3600 s per hour
+    return (float)counts.totalUs * (float)ENERGY_UA_AWAKE / 3.6e9f;
+}
+
+} // namespace TinyClassifier
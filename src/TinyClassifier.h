@@ -0,0 +1,134 @@
+/**
+ * @file TinyClassifier.h
+ * @brief Quantized int8 classifier for candidate sensor events.
+ *
+ * @details A small fully connected network (int8 weights and activations,
+ *          int32 bias and accumulators, per-layer fixed-point requantization
+ *          as in TFLite Micro and CMSIS-NN arm_fully_connected_s8) labels an
+ *          event person, vehicle, animal or noise from a handful of features
+ *          the driver already has. Device OS does not ship TFLite Micro or
+ *          CMSIS-NN to applications, so the kernel is implemented here; the
+ *          Layer tables use the same quantization, so a model exported for
+ *          either converts with no retraining.
+ *
+ *          Weights are const tables, so they stay in flash. Activations go
+ *          in a static arena of two CLASSIFIER_MAX_WIDTH buffers, reserved
+ *          at link time; setup() checks every compiled-in model fits it, and
+ *          a model that does not is never run.
+ *
+ *          Drivers call screen() only for a burst or frame their threshold
+ *          test already accepted, so the network runs once per candidate
+ *          event, not per sample. Noise is rejected; any other label is
+ *          kept in the event flags (SensorEvent::CLASS_MASK). Without a
+ *          model for the sensor type, screen() keeps the event unlabelled.
+ *
+ *          Models come from the header named by CLASSIFIER_MODELS_HEADER,
+ *          which defines a Model and CLASSIFIER_MODEL_ACCEL,
+ *          CLASSIFIER_MODEL_VIBRATION or CLASSIFIER_MODEL_OPENMV as its name
+ *          for each sensor it has one for. An AssetStore CLASSIFIER_MODEL
+ *          blob (make_asset.py) replaces the compiled-in model of its
+ *          sensor; it is loaded into a static CLASSIFIER_ASSET_BYTES buffer
+ *          at boot and checked against the arena like the others.
+ *
+ *          Application thread only.
+ */
+
+#ifndef __TINYCLASSIFIER_H
+#define __TINYCLASSIFIER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "SensorType.h"
+
+namespace TinyClassifier {
+
+/** @brief Output classes, in the order of the last layer's outputs. */
+enum Label : uint8_t {
+    PERSON = 0,
+    VEHICLE,
+    ANIMAL,
+    NOISE,
+    NUM_LABELS
+};
+
+/** @brief Features a driver hands to screen(). */
+constexpr size_t MAX_FEATURES = 8;
+
+/**
+ * @brief One fully connected layer: out = requantize(bias + weights * in).
+ */
+struct Layer {
+    uint16_t inputs;
+    uint16_t outputs;
+    const int8_t *weights;      ///< outputs x inputs, row-major, symmetric (zero point 0)
+    const int32_t *bias;        ///< outputs, in the accumulator scale
+    int32_t multiplier;         ///< Q31 requantization multiplier, 2^30..2^31-1
+    int8_t shift;               ///< Right shift after the multiplier, 0..31
+    bool relu;                  ///< Clamp the output at 0
+};
+
+/**
+ * @brief A network: input quantization, then layers in order.
+ *
+ * Input i is quantized as round(feature[i] * inputScale[i]), saturated to
+ * int8. The last layer has NUM_LABELS outputs.
+ */
+struct Model {
+    const char *name;
+    uint16_t inputs;
+    const float *inputScale;    ///< inputs entries
+    uint8_t layerCount;
+    const Layer *layers;
+};
+
+/** @brief Counts since boot. */
+struct Stats {
+    uint32_t runs;                      ///< Inferences
+    uint32_t labels[NUM_LABELS];        ///< Inferences per output label
+    uint32_t lastUs;                    ///< Latency of the last inference
+    uint32_t maxUs;                     ///< Slowest inference
+    uint64_t totalUs;                   ///< All inferences together
+};
+
+/**
+ * @brief Check each compiled-in model against the arena; call once at boot
+ */
+void setup();
+
+/**
+ * @brief The model for a sensor type, or nullptr if none is compiled in or
+ *        it failed setup()'s check
+ */
+const Model *modelFor(SensorType type);
+
+/**
+ * @brief Run @p model on @p features (model->inputs of them)
+ *
+ * @param score Set to the winning output (int8 logit)
+ * @return The winning label; NOISE if the model is unusable
+ */
+Label run(const Model &model, const float *features, int8_t &score);
+
+/**
+ * @brief Label a candidate event of @p type
+ *
+ * @param classBits Set to the label for SensorEvent::flags (0 unlabelled)
+ * @return false if the model calls it noise and it should be dropped
+ */
+bool screen(SensorType type, const float *features, size_t count, uint8_t &classBits);
+
+/**
+ * @brief Display name of a label
+ */
+const char *labelName(Label label);
+
+const Stats &stats();
+
+/**
+ * @brief Charge the inferences so far cost, in uAh, at ENERGY_UA_AWAKE
+ */
+float chargeUah();
+
+} // namespace TinyClassifier
+
+#endif /* __TINYCLASSIFIER_H */
@@ -0,0 +1,206 @@
+#include "TraceLog.h"
+#include "Config.h"
+#include "MyPersistentData.h"
+#include "StateMachine.h"
+
+extern bool publishDiagnosticSafe(const char* eventName, const char* data, PublishFlags flags);
+
+namespace TraceLog {
+
+struct Entry {
+    uint32_t time;      // Time.now(), or seconds since boot while time is not valid
+    uint16_t event;
+    uint16_t boot;      // Ring boot number, to tell pre-reset entries apart
+    int32_t args[3];
+};
+
+struct Ring {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t boot;
+    uint16_t head;      // Next entry to write
+    uint16_t count;
+    Entry entries[TRACE_LOG_ENTRIES];
+};
+
+// Checked with magic and bounds only: a hash would have to be updated on
+// every record(), and a torn entry costs one bad line in a dump
+static constexpr uint32_t RING_MAGIC = 0x7ace1061;
+static constexpr uint16_t RING_VERSION = 1;
+
+static retained Ring ring;
+
+// Before 2001, the time is seconds since boot
+static constexpr uint32_t MIN_UNIX_TIME = 978307200;
+
+struct Format {
+    uint16_t event;
+    const char *text;
+};
+
+static const Format formats[] = {
+    {BOOT, "boot reset %ld data %ld alert %ld"},
+    {STATE, "state %ld -> %ld, free %ld"},
+    {ALERT, "alert %ld (was %ld)"},
+    {OUT_OF_MEMORY, "out of memory, %ld bytes"},
+    {SLEEP, "sleep mode %ld for %ld s"},
+    {WAKE, "wake reason %ld pin %ld after %ld s"},
+    {CONNECTED, "connected radio %ld ms, net %ld ms, cloud %ld ms"},
+    {ERROR_ACTION, "error resolution %ld alert %ld resets %ld"},
+    {APP_WATCHDOG, "app watchdog in state %ld"},
+    {SENSOR_STORM, "sensor storm %ld"},
+    {TEARDOWN, "teardown cloud %ld ms, net %ld ms, modem %ld ms"},
+};
+
+static uint16_t pendingBoot = 0;    // Boot whose entries loop() publishes; 0 = none
+
+static size_t indexOf(size_t nth) {
+    return (ring.head + TRACE_LOG_ENTRIES - ring.count + nth) % TRACE_LOG_ENTRIES;
+}
+
+// One entry as "<time> <text>"
+static size_t format(const Entry &entry, char *buf, size_t bufSize) {
+    const char *text = nullptr;
+    for (const Format &fmt : formats) {
+        if (fmt.event == entry.event) {
+            text = fmt.text;
+            break;
+        }
+    }
+    int len;
+    if (entry.time >= MIN_UNIX_TIME) {
+        len = snprintf(buf, bufSize, "%s ", Time.format((time_t)entry.time, "%m-%dT%H:%M:%S").c_str());
+    } else {
+        len = snprintf(buf, bufSize, "+%lus ", (unsigned long)entry.time);
+    }
+    if (len < 0 || (size_t)len >= bufSize) {
+        return 0;
+    }
+    int more;
+    if (entry.event == TRANSITION) {
+        // State and reason names rather than numbers
+        more = snprintf(buf + len, bufSize - len, "state %s -> %s (%s)", stateName(entry.args[0]),
+                        stateName(entry.args[1]), transitionReasonName(entry.args[2]));
+    } else if (text) {
+        more = snprintf(buf + len, bufSize - len, text, (long)entry.args[0], (long)entry.args[1], (long)entry.args[2]);
+    } else {
+        more = snprintf(buf + len, bufSize - len, "event %u: %ld %ld %ld", entry.event,
+                        (long)entry.args[0], (long)entry.args[1], (long)entry.args[2]);
+    }
+    return (more < 0) ? 0 : strnlen(buf, bufSize);
+}
+
+// The newest entries (only those from boot @p boot, or all if 0) that fit
+// in one event, oldest first, separated by ';'
+static bool publish(uint16_t boot) {
+    char data[1024];
+    char line[96];
+    size_t end = ring.count;
+    while (boot != 0 && end > 0 && ring.entries[indexOf(end - 1)].boot != boot) {
+        end--;      // Later boots
+    }
+    size_t first = end;
+    size_t total = 0;
+    while (first > 0) {
+        const Entry &entry = ring.entries[indexOf(first - 1)];
+        if (boot != 0 && entry.boot != boot) {
+            break;
+        }
+        size_t len = format(entry, line, sizeof(line)) + 1;
+        if (total + len >= sizeof(data)) {
+            break;
+        }
+        total += len;
+        first--;
+    }
+    size_t used = 0;
+    data[0] = 0;
+    for (size_t nth = first; nth < end && used < sizeof(data); nth++) {
+        const Entry &entry = ring.entries[indexOf(nth)];
+        if (used > 0) {
+            data[used++] = ';';
+        }
+        used += format(entry, data + used, sizeof(data) - used);
+    }
+    return used > 0 && publishDiagnosticSafe("trace", data, PRIVATE);
+}
+
+static int traceFunction(String command) {
+    if (command == "log") {
+        dump();
+    } else if (command == "pub") {
+        if (!publish(0)) {
+            return -1;
+        }
+    } else if (command == "clear") {
+        ATOMIC_BLOCK() {
+            ring.head = 0;
+            ring.count = 0;
+        }
+    } else if (command.length() > 0) {
+        return -1;
+    }
+    return (int)ring.count;
+}
+
+void setup() {
+    if (ring.magic != RING_MAGIC || ring.version != RING_VERSION ||
+        ring.head >= TRACE_LOG_ENTRIES || ring.count > TRACE_LOG_ENTRIES) {
+        memset(&ring, 0, sizeof(ring));
+        ring.magic = RING_MAGIC;
+        ring.version = RING_VERSION;
+    }
+    uint16_t lastBoot = ring.boot;
+    ring.boot = (ring.boot == 0xffff) ? 1 : ring.boot + 1;     // 0 is "any boot" to publish()
+
+    int8_t alert = current.get_alertCode();
+    if (ring.count > 0 && lastBoot != 0 && (alert == 14 || alert == 15 || alert == 16)) {
+        pendingBoot = lastBoot;
+        Log.info("Trace: %u entries before a reset with alert %d; publishing after connect",
+                 (unsigned)ring.count, alert);
+    }
+    record(BOOT, (int32_t)System.resetReason(), (int32_t)System.resetReasonData(), alert);
+
+    Particle.function("trace", traceFunction);
+}
+
+bool loop() {
+    if (pendingBoot != 0 && Particle.connected()) {
+        publish(pendingBoot);
+        pendingBoot = 0;
+    }
+    return true;
+}
+
+void record(Event event, int32_t a, int32_t b, int32_t c) {
+    uint32_t time = Time.isValid() ? (uint32_t)Time.now() : millis() / 1000;
+    ATOMIC_BLOCK() {
+        Entry &entry = ring.entries[ring.head];
+        entry.time = time;
+        entry.event = event;
+        entry.boot = ring.boot;
+        entry.args[0] = a;
+        entry.args[1] = b;
+        entry.args[2] = c;
+        ring.head = (ring.head + 1) % TRACE_LOG_ENTRIES;
+        if (ring.count < TRACE_LOG_ENTRIES) {
+            ring.count++;
+        }
+    }
+}
+
+void dump() {
+    char line[96];
+    size_t total = ring.count;
+    for (size_t nth = 0; nth < total; nth++) {
+        Entry entry = ring.entries[indexOf(nth)];
+        format(entry, line, sizeof(line));
+        Log.info("trace %u %s", entry.boot, line);
+    }
+}
+
+size_t count() {
+    return ring.count;
+}
+
+} // namespace TraceLog
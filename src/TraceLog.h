@@ -0,0 +1,74 @@
+/**
+ * @file TraceLog.h
+ * @brief Binary trace ring in retained RAM for post-mortem analysis.
+ *
+ * @details Each entry is an event id, the time and up to three integer
+ *          arguments, 20 bytes; recording one is a few stores with no
+ *          formatting. The text for each id lives in a const table and is
+ *          only applied when the ring is dumped: to the log (USB serial and
+ *          any other log handler) or as a "trace" event, both through the
+ *          "trace" cloud function.
+ *
+ *          The ring is retained, so it survives soft resets, the watchdogs
+ *          and ULTRA_LOW_POWER naps (not power loss or HIBERNATE). When the
+ *          last reset followed alert 14, 15 or 16 the entries leading up to
+ *          it are published once after the next connect. Trace events are
+ *          appended to the table and never renumbered, so a dump matches
+ *          the firmware that wrote it.
+ */
+
+#ifndef __TRACELOG_H
+#define __TRACELOG_H
+
+#include "Particle.h"
+
+namespace TraceLog {
+
+/** @brief Trace event ids; append only. */
+enum Event : uint16_t {
+    BOOT = 1,       ///< resetReason, resetReasonData, alertCode
+    STATE,          ///< from, to, free memory (firmware before TRANSITION)
+    ALERT,          ///< new alertCode, previous alertCode
+    OUT_OF_MEMORY,  ///< requested size
+    SLEEP,          ///< SleepPlanner mode, seconds
+    WAKE,           ///< wakeupReason, wake pin, seconds slept
+    CONNECTED,      ///< radio ms, network ms, cloud ms
+    ERROR_ACTION,   ///< resolution, alertCode, resetCount
+    APP_WATCHDOG,   ///< state
+    SENSOR_STORM,   ///< storms so far
+    TEARDOWN,       ///< cloud off ms, network off ms, modem off ms (-1 = not off in budget)
+    TRANSITION,     ///< from, to, TransitionReason
+};
+
+/**
+ * @brief Validate the retained ring, record BOOT and register "trace"
+ *
+ * @details Call after current.setup() so the boot entry has the alert code.
+ */
+void setup();
+
+/**
+ * @brief Publish the pre-reset entries once connected, if a reset alert asked for it
+ *
+ * @return true (TaskScheduler task)
+ */
+bool loop();
+
+/**
+ * @brief Append one entry; safe from any thread, not from an ISR
+ */
+void record(Event event, int32_t a = 0, int32_t b = 0, int32_t c = 0);
+
+/**
+ * @brief Log every entry, oldest first, as "trace <boot> <time> <text>"
+ */
+void dump();
+
+/**
+ * @brief Number of entries in the ring
+ */
+size_t count();
+
+} // namespace TraceLog
+
+#endif /* __TRACELOG_H */
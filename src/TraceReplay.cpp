@@ -0,0 +1,166 @@
+#include "TraceReplay.h"
+#include "Config.h"
+#include "MyPersistentData.h"
+#include "SensorManager.h"
+
+#if TRACE_REPLAY_ENABLED
+
+extern bool publishDiagnosticSafe(const char* eventName, const char* data, PublishFlags flags);
+
+namespace TraceReplay {
+
+struct Record {
+    uint32_t gapMs;
+    bool wake;
+};
+
+static Record records[MAX_RECORDS];
+static size_t recordCount = 0;
+static size_t nextRecord = 0;
+static bool running = false;
+static uint32_t lastRecordMs = 0;
+static uint32_t startMs = 0;
+
+// Pipeline state when the replay started
+static uint32_t rejectedAtStart = 0;
+static uint32_t dailyAtStart = 0;
+static uint16_t sessionsAtStart = 0;
+static uint32_t occupiedAtStart = 0;
+
+static uint32_t edgesIn = 0;
+static uint32_t wakesIn = 0;
+static uint32_t appliedEvents = 0;
+static uint32_t appliedUs = 0;
+static uint32_t maxPassUs = 0;
+
+// Parse "<gapMs><kind>,..." onto the end of the trace; false on a bad record
+static bool parse(const char *text) {
+    while (*text) {
+        char *end;
+        unsigned long gap = strtoul(text, &end, 10);
+        if (end == text || (*end != 'e' && *end != 'w') || recordCount >= MAX_RECORDS) {
+            return false;
+        }
+        records[recordCount].gapMs = (uint32_t)gap;
+        records[recordCount].wake = (*end == 'w');
+        recordCount++;
+        text = end + 1;
+        if (*text == ',') {
+            text++;
+        }
+    }
+    return true;
+}
+
+static void report() {
+    uint32_t rejected = SensorManager::instance().filter().rejectedCount() - rejectedAtStart;
+    uint32_t in = edgesIn + wakesIn;
+    uint32_t usAvg = appliedEvents ? appliedUs / appliedEvents : 0;
+
+    char data[256];
+    if (sysStatus.get_countingMode() == OCCUPANCY) {
+        snprintf(data, sizeof(data),
+                 "{\"in\":%lu,\"wakes\":%lu,\"rejected\":%lu,\"sessions\":%u,\"occSec\":%lu,\"usAvg\":%lu,\"usMax\":%lu,\"durMs\":%lu}",
+                 (unsigned long)in, (unsigned long)wakesIn, (unsigned long)rejected,
+                 (unsigned)(uint16_t)(current.get_sessionCount() - sessionsAtStart),
+                 (unsigned long)(current.get_totalOccupiedSeconds() - occupiedAtStart),
+                 (unsigned long)usAvg, (unsigned long)maxPassUs, (unsigned long)(millis() - startMs));
+    } else {
+        // Every edge the filter accepted should be counted exactly once
+        int32_t expected = (int32_t)(in - rejected);
+        int32_t out = (int32_t)(current.get_dailyCount() - dailyAtStart);
+        snprintf(data, sizeof(data),
+                 "{\"in\":%lu,\"wakes\":%lu,\"rejected\":%lu,\"out\":%ld,\"lost\":%ld,\"doubled\":%ld,\"usAvg\":%lu,\"usMax\":%lu,\"durMs\":%lu}",
+                 (unsigned long)in, (unsigned long)wakesIn, (unsigned long)rejected, (long)out,
+                 (long)(expected > out ? expected - out : 0), (long)(out > expected ? out - expected : 0),
+                 (unsigned long)usAvg, (unsigned long)maxPassUs, (unsigned long)(millis() - startMs));
+    }
+    Log.info("Replay done: %s", data);
+    publishDiagnosticSafe("replay", data, PRIVATE);
+}
+
+static void start() {
+    nextRecord = 0;
+    edgesIn = wakesIn = 0;
+    appliedEvents = appliedUs = maxPassUs = 0;
+    rejectedAtStart = SensorManager::instance().filter().rejectedCount();
+    dailyAtStart = current.get_dailyCount();
+    sessionsAtStart = current.get_sessionCount();
+    occupiedAtStart = current.get_totalOccupiedSeconds();
+    startMs = lastRecordMs = millis();
+    running = true;
+    Log.info("Replay: %u records", (unsigned)recordCount);
+}
+
+static int replayFunction(String command) {
+    if (command == "stop") {
+        if (running) {
+            running = false;
+            report();
+        }
+        return 0;
+    }
+    bool append = command.startsWith("+");
+    if (!append) {
+        if (running) {
+            return -1;      // One replay at a time
+        }
+        recordCount = 0;
+    }
+    size_t before = recordCount;
+    if (!parse(command.c_str() + (append ? 1 : 0))) {
+        recordCount = before;
+        return -1;
+    }
+    if (!running) {
+        start();
+    }
+    return (int)recordCount;
+}
+
+void setup() {
+    Particle.function("replay", replayFunction);
+}
+
+void loop() {
+    if (!running) {
+        return;
+    }
+    uint32_t nowMs = millis();
+    while (nextRecord < recordCount && nowMs - lastRecordMs >= records[nextRecord].gapMs) {
+        lastRecordMs += records[nextRecord].gapMs;
+        if (records[nextRecord].wake) {
+            // As after a nap the sensor pin ended
+            uint32_t injected = SensorManager::instance().wakeLatency().injected;
+            SensorManager::instance().prepareForNap();
+            SensorManager::instance().ingestWakeEvent(nowMs);
+            if (SensorManager::instance().wakeLatency().injected != injected) {
+                wakesIn++;
+            }
+        } else if (SensorManager::instance().injectEdge()) {
+            edgesIn++;
+        }
+        nextRecord++;
+    }
+    // Let the last edges drain and, in occupancy mode, the session close
+    uint32_t settleMs = (sysStatus.get_countingMode() == OCCUPANCY) ? sysStatus.get_occupancyDebounceMs() + 2000UL : 2000UL;
+    if (nextRecord >= recordCount && nowMs - lastRecordMs >= settleMs) {
+        running = false;
+        report();
+    }
+}
+
+void noteApplied(size_t events, uint32_t elapsedUs) {
+    if (!running) {
+        return;
+    }
+    appliedEvents += events;
+    appliedUs += elapsedUs;
+    if (elapsedUs > maxPassUs) {
+        maxPassUs = elapsedUs;
+    }
+}
+
+} // namespace TraceReplay
+
+#endif /* TRACE_REPLAY_ENABLED */
@@ -0,0 +1,54 @@
+/**
+ * @file TraceReplay.h
+ * @brief Bench replay of recorded sensor traces through the live counting
+ *        and occupancy pipelines.
+ *
+ * @details A trace is a comma-separated list of records "<gapMs><kind>":
+ *          the milliseconds since the previous record, then 'e' for a
+ *          sensor edge or 'w' for an edge that woke the device from a nap.
+ *          For example "0e,250e,40e,6000w". The "replay" cloud function
+ *          loads a trace and starts it; an argument starting with '+' adds
+ *          to the loaded trace instead (field logs longer than one function
+ *          call), and "stop" ends a replay early.
+ *
+ *          Edges go into the sensor's own queue (ISensor::injectEdge()), so
+ *          they take the same drain, filter and mode-handler path as real
+ *          ones; wakes go through SensorManager::prepareForNap() and
+ *          ingestWakeEvent() as after a real nap. When the trace ends a
+ *          "replay" event reports events in, filter rejections, counts out,
+ *          lost and doubled events (counting mode), sessions and occupied
+ *          seconds (occupancy mode), and the mode handler's time per event.
+ *
+ *          Injected counts are real counts; use a bench unit. Keep it awake
+ *          (CONNECTED mode, open hours) so edges are not delayed by naps.
+ *          Bench builds only: TRACE_REPLAY_ENABLED.
+ */
+
+#ifndef __TRACEREPLAY_H
+#define __TRACEREPLAY_H
+
+#include "Particle.h"
+
+namespace TraceReplay {
+
+/** @brief Records one trace can hold. */
+static constexpr size_t MAX_RECORDS = 512;
+
+/**
+ * @brief Register the "replay" cloud function
+ */
+void setup();
+
+/**
+ * @brief Inject the records that are due; call from loop() before the mode handler
+ */
+void loop();
+
+/**
+ * @brief A mode handler applied @p events drained events in @p elapsedUs
+ */
+void noteApplied(size_t events, uint32_t elapsedUs);
+
+} // namespace TraceReplay
+
+#endif /* __TRACEREPLAY_H */
@@ -0,0 +1,172 @@
+#include "TrafficBaseline.h"
+#include "Config.h"
+#include "LocalOffset.h"
+#include "LocalTimeRK.h"
+#include "MyPersistentData.h"
+#include "Payload.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace TrafficBaseline {
+
+static const char *baselinePath = "/usr/baseline.dat";
+static const uint32_t MAGIC = 0x424c4e31;   // "BLN1"
+
+// Means and deviations are kept in sixteenths of a count
+static const int32_t FIXED = 16;
+
+struct Header {
+    uint32_t magic;
+    uint16_t quietBusyHours;    // Current run of zero-count busy hours
+    uint16_t reserved;
+};
+
+struct Slot {
+    uint16_t mean16;
+    uint16_t dev16;
+    uint8_t samples;            // Saturates at 255
+    uint8_t check;
+};
+static_assert(sizeof(Slot) == 6, "TrafficBaseline::Slot must stay 6 bytes");
+
+static uint8_t checksum(const Slot &slot) {
+    const uint8_t *p = (const uint8_t *)&slot;
+    uint8_t sum = 0xa5;
+    for (size_t ii = 0; ii < offsetof(Slot, check); ii++) {
+        sum += p[ii];
+    }
+    return (uint8_t)~sum;
+}
+
+static size_t slotFor(time_t hourTime) {
+    int hourOfWeek;
+    LocalOffset::Fields local;
+    if (LocalOffset::split(hourTime, local)) {
+        hourOfWeek = local.dayOfWeek * 24 + local.hour;
+    } else {
+        LocalTimeConvert conv;
+        conv.withConfig(LocalTime::instance().getConfig()).withTime(hourTime).convert();
+        hourOfWeek = conv.getLocalTimeYMD().getDayOfWeek() * 24 + conv.getLocalTimeHMS().hour;
+    }
+    return (hourOfWeek >= 0 && hourOfWeek < (int)SLOTS) ? (size_t)hourOfWeek : 0;
+}
+
+// Opens the file, creating an empty one (header only) if missing or foreign
+static int openFile(Header &header) {
+    int fd = open(baselinePath, O_RDWR | O_CREAT, 0666);
+    if (fd < 0) {
+        Log.warn("Baseline: open failed (%d)", errno);
+        return fd;
+    }
+    if (read(fd, &header, sizeof(header)) != (int)sizeof(header) || header.magic != MAGIC) {
+        header = {MAGIC, 0, 0};
+        ftruncate(fd, 0);
+        lseek(fd, 0, SEEK_SET);
+        write(fd, &header, sizeof(header));
+    }
+    return fd;
+}
+
+static void clearIfActive(int8_t code) {
+    if (current.isAlertActive(code)) {
+        Log.info("Baseline: counts normal again; clearing alert %d", code);
+        current.clearAlert(code);
+    }
+}
+
+Verdict observe(time_t hourTime, uint16_t count) {
+    Verdict verdict = UNLEARNED;
+#if TRAFFIC_BASELINE_ENABLED
+    Header header;
+    int fd = openFile(header);
+    if (fd < 0) {
+        return verdict;
+    }
+
+    size_t index = slotFor(hourTime);
+    off_t offset = (off_t)(sizeof(Header) + index * sizeof(Slot));
+    Slot slot = {};
+    if (lseek(fd, offset, SEEK_SET) != offset || read(fd, &slot, sizeof(slot)) != (int)sizeof(slot) ||
+        slot.check != checksum(slot)) {
+        slot = {};
+    }
+
+    int32_t mean16 = slot.mean16;
+    int32_t dev16 = slot.dev16;
+    int32_t x16 = (int32_t)count * FIXED;
+    bool learned = slot.samples >= BASELINE_MIN_WEEKS;
+    bool learn = true;
+    uint16_t quietRun = header.quietBusyHours;
+
+    if (learned) {
+        if (x16 > mean16 + dev16) {
+            verdict = ABOVE;
+        } else if (x16 < mean16 - dev16 && mean16 >= BASELINE_BUSY_MEAN * FIXED) {
+            verdict = BELOW;
+        } else {
+            verdict = USUAL;
+        }
+    }
+
+    if (learned && count == 0 && mean16 >= BASELINE_BUSY_MEAN * FIXED) {
+        quietRun = (quietRun < 0xffff) ? quietRun + 1 : quietRun;
+        // Stop learning once it looks dead; after a week of it, learn the silence
+        learn = quietRun < BASELINE_QUIET_HOURS || quietRun >= SLOTS;
+        if (quietRun == BASELINE_QUIET_HOURS) {
+            Log.error("Baseline: %u busy hours in a row with no counts - raising alert 25", (unsigned)quietRun);
+            current.raiseAlert(25);
+        }
+    } else if (count > 0) {
+        quietRun = 0;
+        clearIfActive(25);
+    }
+
+    int32_t spike16 = mean16 + BASELINE_SPIKE_DEVS * dev16;
+    if (spike16 < mean16 + BASELINE_SPIKE_FLOOR * FIXED) {
+        spike16 = mean16 + BASELINE_SPIKE_FLOOR * FIXED;
+    }
+    if (learned && x16 > spike16) {
+        Log.error("Baseline: %u counts where %s +/- %s are usual - raising alert 26", (unsigned)count,
+                  Payload::Scaled(mean16 * 10 / FIXED, 1).c_str(), Payload::Scaled(dev16 * 10 / FIXED, 1).c_str());
+        current.raiseAlert(26);
+        x16 = spike16;      // Learn the spike only as far as the threshold
+    } else {
+        clearIfActive(26);
+    }
+
+    if (learn) {
+        if (slot.samples == 0) {
+            mean16 = x16;       // First week: start from the observation
+            dev16 = x16 / 2;
+        } else {
+            int32_t diff = x16 - mean16;
+            mean16 += diff / 4;
+            dev16 += ((diff < 0 ? -diff : diff) - dev16) / 4;
+        }
+        slot.mean16 = (uint16_t)constrain(mean16, 0, 0xffff);
+        slot.dev16 = (uint16_t)constrain(dev16, 0, 0xffff);
+        slot.samples = (slot.samples < 255) ? slot.samples + 1 : 255;
+        slot.check = checksum(slot);
+        if (lseek(fd, offset, SEEK_SET) != offset || write(fd, &slot, sizeof(slot)) != (int)sizeof(slot)) {
+            Log.warn("Baseline: write failed at slot %u", (unsigned)index);
+        }
+    }
+
+    if (quietRun != header.quietBusyHours) {
+        header.quietBusyHours = quietRun;
+        lseek(fd, 0, SEEK_SET);
+        write(fd, &header, sizeof(header));
+    }
+    close(fd);
+
+    if (sysStatus.get_verboseMode()) {
+        Log.info("Baseline: slot %u count %u, mean %s dev %s after %u weeks", (unsigned)index, (unsigned)count,
+                 Payload::Scaled(slot.mean16 * 10 / FIXED, 1).c_str(), Payload::Scaled(slot.dev16 * 10 / FIXED, 1).c_str(),
+                 (unsigned)slot.samples);
+    }
+#endif
+    return verdict;
+}
+
+} // namespace TrafficBaseline
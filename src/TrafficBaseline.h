@@ -0,0 +1,60 @@
+/**
+ * @file TrafficBaseline.h
+ * @brief Learned counts per local hour of the week, and alerts when a
+ *        sensor goes quiet or counts the impossible.
+ *
+ * @details Each full hourly count updates that hour-of-week's slot in
+ *          /usr/baseline.dat: an exponentially weighted mean and mean
+ *          absolute deviation (weight 1/4, so about the last month of
+ *          weeks). Once a slot has BASELINE_MIN_WEEKS samples it is used to
+ *          judge the hour:
+ *
+ *          - zero counts in a slot whose mean is at least BASELINE_BUSY_MEAN
+ *            extends a run of quiet busy hours; BASELINE_QUIET_HOURS of them
+ *            in a row (closed hours and quiet slots don't break the run)
+ *            raise alert 25, a dead or blocked sensor;
+ *          - a count above mean + BASELINE_SPIKE_DEVS deviations and
+ *            BASELINE_SPIKE_FLOOR over the mean raises alert 26.
+ *
+ *          Each alert is cleared by the next ordinary hour, with
+ *          current.clearAlert(), so an alert raised elsewhere in the
+ *          meantime stays in alertCode. Anomalous hours
+ *          are not learned at face value: a quiet run stops updating the
+ *          slots (until it has lasted a week), and a spike is clamped to the
+ *          threshold, so a dead sensor doesn't become the new normal. One
+ *          slot is read and written per hour.
+ *
+ *          observe() also says where the hour fell against its slot, more
+ *          than one deviation either side, for AutoTune.
+ */
+
+#ifndef __TRAFFICBASELINE_H
+#define __TRAFFICBASELINE_H
+
+#include "Particle.h"
+
+namespace TrafficBaseline {
+
+/** @brief Hours in the week; one slot each. */
+static constexpr size_t SLOTS = 168;
+
+/** @brief An hour's count against its slot, before the hour is learned. */
+enum Verdict : uint8_t {
+    UNLEARNED,      ///< Fewer than BASELINE_MIN_WEEKS samples, or baselines off
+    USUAL,          ///< Within one deviation of the mean
+    ABOVE,          ///< More than one deviation over the mean
+    BELOW           ///< More than one deviation under a mean of at least BASELINE_BUSY_MEAN
+};
+
+/**
+ * @brief Learn and judge one full hour of counts
+ *
+ * @param hourTime Any time within the hour (UTC); its local hour of the week picks the slot
+ * @param count    Events counted in that hour
+ * @return Where the count fell against the slot
+ */
+Verdict observe(time_t hourTime, uint16_t count);
+
+} // namespace TrafficBaseline
+
+#endif /* __TRAFFICBASELINE_H */
@@ -0,0 +1,126 @@
+#include "UpdateWindow.h"
+#include "Config.h"
+#include "ISensor.h"
+#include "SensorManager.h"
+#include <atomic>
+
+namespace UpdateWindow {
+
+#if UPDATE_WINDOW_STATS_ENABLED
+
+struct Block {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t open;               // A window was open; still set after a reset ended it
+    uint8_t endedByReset;       // The latest window was ended by a reset
+    uint32_t windows;
+    uint32_t events;
+    uint32_t lastEvents;
+    uint32_t lastSec;
+};
+
+// Checked with magic only, like StateTable's block: a torn count costs one bad number
+static constexpr uint32_t BLOCK_MAGIC = 0x07a3e1d0;
+static constexpr uint16_t BLOCK_VERSION = 1;
+
+static retained Block block;
+
+static std::atomic<uint8_t> holders(0);     // Source bits holding the window open
+static std::atomic<uint32_t> openMs(0);     // millis() the latest window opened
+static std::atomic<uint32_t> closeMs(0);    // millis() it closed (0 = open)
+static std::atomic<bool> windowSeen(false); // openMs is set
+
+static void firmwareUpdateHandler(system_event_t event, int param) {
+    if (param == firmware_update_begin) {
+        begin(DEVICE_OS);
+    } else if (param == firmware_update_complete || param == firmware_update_failed) {
+        end(DEVICE_OS);     // A completed update resets next; FIRMWARE_UPDATE_STATE may still hold it
+    }
+}
+
+#endif /* UPDATE_WINDOW_STATS_ENABLED */
+
+void setup() {
+#if UPDATE_WINDOW_STATS_ENABLED
+    if (block.magic != BLOCK_MAGIC || block.version != BLOCK_VERSION) {
+        memset(&block, 0, sizeof(block));
+        block.magic = BLOCK_MAGIC;
+        block.version = BLOCK_VERSION;
+    } else if (block.open) {
+        block.open = 0;
+        block.endedByReset = 1;
+        Log.info("UpdateWindow: reset ended the last update window (reason %d); %lu events captured in it",
+                 (int)System.resetReason(), (unsigned long)block.lastEvents);
+    }
+    System.on(firmware_update, firmwareUpdateHandler);
+#endif
+}
+
+void begin(Source source) {
+#if UPDATE_WINDOW_STATS_ENABLED
+    if (holders.fetch_or(source) != 0) {
+        return;
+    }
+    closeMs.store(0);
+    openMs.store(millis());
+    windowSeen.store(true);
+    block.windows++;
+    block.lastEvents = 0;
+    block.lastSec = 0;
+    block.endedByReset = 0;
+    block.open = 1;
+    Log.info("UpdateWindow: opened (%s)", source == STATE ? "update state" : "Device OS update");
+#endif
+}
+
+void end(Source source) {
+#if UPDATE_WINDOW_STATS_ENABLED
+    if (holders.fetch_and((uint8_t)~source) != source) {
+        return;     // Not holding it, or another source still is
+    }
+    uint32_t nowMs = millis();
+    closeMs.store(nowMs ? nowMs : 1);
+    block.lastSec = (nowMs - openMs.load()) / 1000;
+    block.open = 0;
+    Log.info("UpdateWindow: closed after %lu s; %lu events captured in it",
+             (unsigned long)block.lastSec, (unsigned long)block.lastEvents);
+#endif
+}
+
+void noteCaptured(const SensorEvent *events, size_t count) {
+#if UPDATE_WINDOW_STATS_ENABLED
+    if (!windowSeen.load(std::memory_order_relaxed) || count == 0) {
+        return;
+    }
+    uint32_t start = openMs.load();
+    uint32_t stop = closeMs.load();
+    uint32_t inWindow = 0;
+    for (size_t ii = 0; ii < count; ii++) {
+        uint32_t tickMs = events[ii].tickMs;
+        if ((int32_t)(tickMs - start) >= 0 && (stop == 0 || (int32_t)(stop - tickMs) >= 0)) {
+            inWindow++;
+        }
+    }
+    block.events += inWindow;
+    block.lastEvents += inWindow;
+#endif
+}
+
+void writeStatus(JSONWriter &writer) {
+#if UPDATE_WINDOW_STATS_ENABLED
+    writer.name("ota").beginObject();
+    writer.name("n").value((unsigned long)block.windows);
+    writer.name("ev").value((unsigned long)block.events);
+    writer.name("lastEv").value((unsigned long)block.lastEvents);
+    writer.name("lastSec").value((unsigned long)block.lastSec);
+    writer.name("reset").value(block.endedByReset != 0);
+#if SENSOR_THREAD_ENABLED
+    writer.name("late").value((unsigned long)SensorManager::instance().handoffOverflows());
+#else
+    writer.name("late").value(0UL);
+#endif
+    writer.endObject();
+#endif
+}
+
+} // namespace UpdateWindow
@@ -0,0 +1,76 @@
+/**
+ * @file UpdateWindow.h
+ * @brief Counts the sensor events captured while a firmware update is in
+ *        progress, so counting completeness across an OTA can be checked.
+ *
+ * @details A window is open from entering FIRMWARE_UPDATE_STATE, or from
+ *          Device OS's firmware_update begin event, until both have ended.
+ *          The state machine and the system thread open and close it; an
+ *          update that completes ends it with a reset instead.
+ *
+ *          SensorManager passes each accepted batch to noteCaptured() where
+ *          it is drained: the sensor thread with SENSOR_THREAD_ENABLED, the
+ *          application thread otherwise. An event is in the window by its
+ *          capture time, so one drained after the window closed still
+ *          counts. The totals are kept in retained RAM and reach the device
+ *          status ("ota") after the update's reset:
+ *
+ *              "ota":{"n":3,"ev":41,"lastEv":12,"lastSec":95,"reset":true,"late":0}
+ *
+ *          n windows and ev events since power was applied; lastEv and lastSec for the latest window (lastSec 0
+ *          while it is open or when a reset ended it, reset then true).
+ *          late is SensorManager::handoffOverflows(): events the
+ *          application thread fell too far behind to take in order, which
+ *          were still counted with a later event's capture time.
+ *
+ *          Those counts should match the difference in the hourly counts
+ *          over the same period; anything short of it was lost upstream of
+ *          SensorManager (a driver ring overflow, logged by the driver).
+ */
+
+#ifndef __UPDATEWINDOW_H
+#define __UPDATEWINDOW_H
+
+#include "Particle.h"
+
+struct SensorEvent;
+
+namespace UpdateWindow {
+
+/** @brief What holds a window open; either keeps it open. */
+enum Source : uint8_t {
+    STATE = 0x01,       ///< FIRMWARE_UPDATE_STATE
+    DEVICE_OS = 0x02,   ///< firmware_update begin until complete or failed
+};
+
+/**
+ * @brief Validate the retained counts and register for firmware_update;
+ *        call early in setup(), before the sensors start
+ */
+void setup();
+
+/**
+ * @brief @p source now holds the window open (any thread)
+ */
+void begin(Source source);
+
+/**
+ * @brief @p source no longer holds the window open (any thread)
+ */
+void end(Source source);
+
+/**
+ * @brief Count the events of an accepted batch captured in a window
+ *
+ * @details From whichever thread drains the sensors; one thread only.
+ */
+void noteCaptured(const SensorEvent *events, size_t count);
+
+/**
+ * @brief Write the counts to an open JSON object as "ota"
+ */
+void writeStatus(JSONWriter &writer);
+
+} // namespace UpdateWindow
+
+#endif /* __UPDATEWINDOW_H */
@@ -0,0 +1,91 @@
+#include "UsbLogSink.h"
+#include "Config.h"
+#include <algorithm>
+
+static const size_t RING_BYTES = USB_LOG_BUFFER_BYTES;
+
+UsbLogSink *UsbLogSink::_instance;
+
+// [static]
+UsbLogSink &UsbLogSink::instance() {
+    if (!_instance) {
+        _instance = new UsbLogSink();
+    }
+    return *_instance;
+}
+
+UsbLogSink::UsbLogSink() {
+    os_mutex_recursive_create(&mutex);
+    ring = new uint8_t[RING_BYTES];
+}
+
+size_t UsbLogSink::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t UsbLogSink::write(const uint8_t *buffer, size_t size) {
+    if (!ring) {
+        return size;
+    }
+    os_mutex_recursive_lock(mutex);
+    for (size_t ii = 0; ii < size; ii++) {
+        if (count == RING_BYTES) {
+            // Full: the oldest byte goes
+            head = (head + 1) % RING_BYTES;
+            count--;
+            dropped++;
+            totalDropped++;
+        }
+        ring[(head + count) % RING_BYTES] = buffer[ii];
+        count++;
+    }
+    drain();
+    os_mutex_recursive_unlock(mutex);
+    return size;
+}
+
+void UsbLogSink::drain() {
+    if (count == 0 || !Serial.isConnected()) {
+        return;
+    }
+    if (dropped) {
+        char marker[40];
+        int len = snprintf(marker, sizeof(marker), "[%lu log bytes dropped]\r\n", (unsigned long)dropped);
+        if (Serial.availableForWrite() < len) {
+            return;
+        }
+        Serial.write((const uint8_t *)marker, len);
+        dropped = 0;
+    }
+    while (count > 0) {
+        int room = Serial.availableForWrite();
+        if (room <= 0) {
+            break;
+        }
+        // Up to the end of the ring, then wrap on the next round
+        size_t chunk = std::min(count, RING_BYTES - head);
+        chunk = std::min(chunk, (size_t)room);
+        Serial.write(&ring[head], chunk);
+        head = (head + chunk) % RING_BYTES;
+        count -= chunk;
+    }
+}
+
+// [static]
+bool UsbLogSink::poll() {
+    UsbLogSink &sink = instance();
+    os_mutex_recursive_lock(sink.mutex);
+    sink.drain();
+    os_mutex_recursive_unlock(sink.mutex);
+    return true;
+}
+
+UsbLogHandler::UsbLogHandler(LogLevel level, LogCategoryFilters filters) :
+        StreamLogHandler(UsbLogSink::instance(), level, filters) {
+    Serial.begin();
+    LogManager::instance()->addHandler(this);
+}
+
+UsbLogHandler::~UsbLogHandler() {
+    LogManager::instance()->removeHandler(this);
+}
@@ -0,0 +1,76 @@
+/**
+ * @file UsbLogSink.h
+ * @brief Log output to USB serial that never waits for a host.
+ *
+ * @details Formatted log text goes into a RAM ring of USB_LOG_BUFFER_BYTES
+ *          and is moved to USB serial only as far as Serial.isConnected()
+ *          and availableForWrite() allow. Logs from boot and from each wake
+ *          wait in the ring until a terminal attaches, so nothing in setup()
+ *          or the wake path has to wait for one. When the ring is full the
+ *          oldest text is dropped and a "[n log bytes dropped]" line marks
+ *          the gap.
+ *
+ *          UsbLogHandler is SerialLogHandler with this as its stream. The
+ *          log manager serializes handler calls; poll() runs as a
+ *          TaskScheduler task, so the ring has its own mutex.
+ */
+
+#ifndef __USBLOGSINK_H
+#define __USBLOGSINK_H
+
+#include "Particle.h"
+
+/**
+ * This class is a singleton; you do not create one as a global, on the stack, or with new.
+ */
+class UsbLogSink : public Print {
+public:
+    /**
+     * @brief Gets the singleton instance of this class, allocating it if necessary
+     */
+    static UsbLogSink &instance();
+
+    virtual size_t write(uint8_t c);
+    virtual size_t write(const uint8_t *buffer, size_t size);
+
+    /**
+     * @brief TaskScheduler task: send what the ring holds if a host is attached
+     *
+     * @return true (TaskScheduler task)
+     */
+    static bool poll();
+
+    /** @brief Bytes dropped from a full ring since boot. */
+    uint32_t droppedBytes() const { return totalDropped; }
+
+protected:
+    UsbLogSink();
+    virtual ~UsbLogSink() {};
+    UsbLogSink(const UsbLogSink&) = delete;
+    UsbLogSink& operator=(const UsbLogSink&) = delete;
+
+    /**
+     * @brief Move as much of the ring to USB serial as fits now; call with the mutex held
+     */
+    void drain();
+
+    os_mutex_recursive_t mutex;
+    uint8_t *ring;
+    size_t head = 0;            ///< Next byte to send
+    size_t count = 0;           ///< Bytes waiting
+    uint32_t dropped = 0;       ///< Dropped since the last marker was sent
+    uint32_t totalDropped = 0;
+
+    static UsbLogSink *_instance;
+};
+
+/**
+ * @brief SerialLogHandler, writing through UsbLogSink instead of blocking on USB
+ */
+class UsbLogHandler : public StreamLogHandler {
+public:
+    explicit UsbLogHandler(LogLevel level = LOG_LEVEL_INFO, LogCategoryFilters filters = {});
+    virtual ~UsbLogHandler();
+};
+
+#endif /* __USBLOGSINK_H */
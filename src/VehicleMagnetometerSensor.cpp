@@ -0,0 +1,363 @@
+// src/VehicleMagnetometerSensor.cpp
+#include "VehicleMagnetometerSensor.h"
+#include <math.h>
+
+// LIS2MDL registers and values used here
+namespace {
+const uint8_t REG_OFFSET_X_L = 0x45;
+const uint8_t REG_WHO_AM_I = 0x4F;
+const uint8_t REG_CFG_A = 0x60;
+const uint8_t REG_CFG_B = 0x61;
+const uint8_t REG_CFG_C = 0x62;
+const uint8_t REG_INT_CTRL = 0x63;
+const uint8_t REG_INT_SOURCE = 0x64;
+const uint8_t REG_INT_THS_L = 0x65;
+const uint8_t REG_INT_THS_H = 0x66;
+const uint8_t REG_STATUS = 0x67;
+const uint8_t REG_OUTX_L = 0x68;
+
+const uint8_t WHO_AM_I_LIS2MDL = 0x40;
+const uint8_t CFG_A_COMP_TEMP = 0x80;
+const uint8_t CFG_A_LOW_POWER = 0x10;
+const uint8_t CFG_A_SINGLE = 0x01;
+const uint8_t CFG_A_IDLE = 0x03;
+const uint8_t CFG_B_INT_ON_DATAOFF = 0x08;  // Threshold applies after the offset (baseline)
+const uint8_t CFG_C_INT_ON_PIN = 0x40;
+const uint8_t CFG_C_BDU = 0x10;
+const uint8_t INT_CTRL_XYZ_LATCHED_HIGH = 0xE7;
+const uint8_t INT_SOURCE_INT = 0x01;
+const uint8_t STATUS_ZYXDA = 0x08;
+
+const float MG_PER_DIGIT = 1.5f;
+
+// Single-shot conversion time, with margin
+const uint32_t CONVERSION_MS = 15;
+
+uint8_t odrBits(int hz) {
+    return (uint8_t)((hz >= 100 ? 3 : hz >= 50 ? 2 : hz >= 20 ? 1 : 0) << 2);
+}
+
+uint16_t clampU16(float value) {
+    return value <= 0.0f ? 0 : value >= 65535.0f ? 65535 : (uint16_t)(value + 0.5f);
+}
+
+int16_t toDigits(float mg) {
+    float digits = mg / MG_PER_DIGIT;
+    return (int16_t)(digits > 32767.0f ? 32767 : digits < -32768.0f ? -32768 : digits);
+}
+} // namespace
+
+static_assert(MAG_EXIT_MG < MAG_ENTER_MG, "MAG_EXIT_MG must be below MAG_ENTER_MG for hysteresis");
+static_assert(MAG_BOOST_MG <= MAG_ENTER_MG, "Boost before or at detection");
+
+bool VehicleMagnetometerSensor::setup() {
+    pinMode(intPin, INPUT_PULLDOWN);
+    if (!Wire.isEnabled()) {
+        Wire.begin();
+    }
+    reset();
+
+    uint8_t whoAmI = 0;
+    if (!readRegisters(REG_WHO_AM_I, &whoAmI, 1) || whoAmI != WHO_AM_I_LIS2MDL) {
+        Log.error("LIS2MDL not found at 0x%02x (WHO_AM_I 0x%02x)", MAG_I2C_ADDR, whoAmI);
+        _lastErrorCode = ERROR_NOT_FOUND;
+        _isReady = false;
+        return false;
+    }
+    if (!writeRegister(REG_CFG_C, CFG_C_BDU) || !writeRegister(REG_INT_CTRL, 0x00) ||
+        !writeRegister(REG_CFG_B, 0x00) || !writeRegister(REG_CFG_A, CFG_A_COMP_TEMP | CFG_A_IDLE)) {
+        Log.error("LIS2MDL configuration failed");
+        _isReady = false;
+        return false;
+    }
+    _lastErrorCode = 0;
+    _boosted = false;
+    _conversionPending = false;
+    _wakeArmed = false;
+    _nextSampleMs = millis();
+    _isReady = true;
+    Log.info("Magnetometer vehicle detector ready (quiet every %lu ms, boost %d Hz, enter %d / exit %d mG)",
+             (unsigned long)MAG_QUIET_PERIOD_MS, MAG_BOOST_ODR_HZ, MAG_ENTER_MG, MAG_EXIT_MG);
+    return true;
+}
+
+bool VehicleMagnetometerSensor::loop() {
+    if (!_isReady) {
+        return false;
+    }
+    if (_eventReady) {
+        return true;    // Not drained yet
+    }
+    uint32_t now = millis();
+    if ((int32_t)(now - _nextSampleMs) < 0) {
+        return false;
+    }
+
+    if (!_boosted && !_conversionPending) {
+        // Quiet: start one conversion and come back for it
+        if (writeRegister(REG_CFG_A, CFG_A_COMP_TEMP | CFG_A_LOW_POWER | CFG_A_SINGLE)) {
+            _conversionPending = true;
+            _nextSampleMs = now + CONVERSION_MS;
+        } else {
+            _nextSampleMs = now + MAG_QUIET_PERIOD_MS;
+        }
+        return false;
+    }
+
+    float field[3];
+    bool haveSample = readField(field);
+    _conversionPending = false;
+    _nextSampleMs = now + (_boosted ? 1000UL / MAG_BOOST_ODR_HZ : MAG_QUIET_PERIOD_MS);
+    return haveSample && process(field, now);
+}
+
+size_t VehicleMagnetometerSensor::drain(SensorEvent* out, size_t max) {
+    if (!out || max == 0 || !loop()) {
+        return 0;
+    }
+    out[0] = _event;
+    _eventReady = false;
+    return 1;
+}
+
+bool VehicleMagnetometerSensor::readField(float field[3]) {
+    if (_boosted) {
+        uint8_t status = 0;
+        if (!readRegisters(REG_STATUS, &status, 1) || !(status & STATUS_ZYXDA)) {
+            return false;
+        }
+    }
+    uint8_t raw[6];
+    if (!readRegisters(REG_OUTX_L, raw, sizeof(raw))) {
+        return false;
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        field[axis] = (float)(int16_t)(raw[2 * axis] | (raw[2 * axis + 1] << 8)) * MG_PER_DIGIT;
+    }
+    _lastErrorCode = 0;
+    return true;
+}
+
+bool VehicleMagnetometerSensor::process(const float field[3], uint32_t now) {
+    if (!_haveBaseline) {
+        for (int axis = 0; axis < 3; axis++) {
+            _baseline[axis] = field[axis];
+        }
+        _haveBaseline = true;
+        _lastSampleMs = now;
+        return false;
+    }
+
+    float sumSquares = 0.0f;
+    for (int axis = 0; axis < 3; axis++) {
+        float delta = field[axis] - _baseline[axis];
+        sumSquares += delta * delta;
+    }
+    float deviationMg = sqrtf(sumSquares);
+
+    // Baseline follows drift, but not a vehicle
+    if (!_detecting) {
+        float alpha = (float)(now - _lastSampleMs) / (1000.0f * MAG_BASELINE_TAU_SEC);
+        if (alpha > 1.0f) {
+            alpha = 1.0f;
+        }
+        for (int axis = 0; axis < 3; axis++) {
+            _baseline[axis] += alpha * (field[axis] - _baseline[axis]);
+        }
+    }
+    _lastSampleMs = now;
+
+    if (deviationMg >= MAG_BOOST_MG) {
+        _lastActiveMs = now;
+        if (!_boosted) {
+            setBoost(true, now);
+        }
+    } else if (_boosted && !_detecting && now - _lastActiveMs >= MAG_BOOST_HOLD_MS) {
+        setBoost(false, now);
+    }
+
+    if (!_detecting) {
+        if (deviationMg >= MAG_ENTER_MG) {
+            _detecting = true;
+            _detectStartMs = now;
+            _peakDeviationMg = deviationMg;
+            _detectSamples = 1;
+            _belowExit = 0;
+        }
+        return false;
+    }
+
+    if (_detectSamples < UINT16_MAX) {
+        _detectSamples++;
+    }
+    if (deviationMg > _peakDeviationMg) {
+        _peakDeviationMg = deviationMg;
+    }
+
+    if (now - _detectStartMs >= MAG_MAX_DWELL_SEC * 1000UL) {
+        // Parked: report it and take the field as it is now
+        closeDetection(now, true);
+        for (int axis = 0; axis < 3; axis++) {
+            _baseline[axis] = field[axis];
+        }
+        return true;
+    }
+    if (deviationMg < MAG_EXIT_MG) {
+        if (++_belowExit >= MAG_EXIT_SAMPLES) {
+            closeDetection(now, false);
+            return true;
+        }
+    } else {
+        _belowExit = 0;
+    }
+    return false;
+}
+
+void VehicleMagnetometerSensor::closeDetection(uint32_t now, bool parked) {
+    uint32_t dwellMs = now - _detectStartMs;
+    float baselineMg = sqrtf(_baseline[0] * _baseline[0] + _baseline[1] * _baseline[1] +
+                             _baseline[2] * _baseline[2]);
+    _detecting = false;
+
+    _data.timestamp = Time.now();
+    _data.hasNewData = true;
+    _data.primary = clampU16(_peakDeviationMg);
+    _data.secondary = clampU16((float)dwellMs / 1000.0f);
+    _data.aux1 = clampU16(baselineMg);
+    _data.aux2 = _detectSamples;
+    _data.flag1 = true;
+    _data.flag2 = parked;
+
+    _event = SensorEvent();
+    _event.tickMs = _detectStartMs;
+    _event.type = SensorType::VEHICLE_MAGNETOMETER;
+    _event.flags = 0x01 | (parked ? 0x02 : 0);
+    _event.primary = _data.primary;
+    _event.secondary = _data.secondary;
+    _event.pulseMs = (uint16_t)(dwellMs > 0xFFFF ? 0xFFFF : dwellMs);
+    _eventReady = true;
+}
+
+void VehicleMagnetometerSensor::setBoost(bool boost, uint32_t now) {
+    uint8_t cfgA = boost ? (uint8_t)(CFG_A_COMP_TEMP | odrBits(MAG_BOOST_ODR_HZ))    // Continuous, high resolution
+                         : (uint8_t)(CFG_A_COMP_TEMP | CFG_A_IDLE);
+    if (!writeRegister(REG_CFG_A, cfgA)) {
+        return;
+    }
+    _boosted = boost;
+    _conversionPending = false;
+    _nextSampleMs = now + (boost ? 1000UL / MAG_BOOST_ODR_HZ : MAG_QUIET_PERIOD_MS);
+}
+
+void VehicleMagnetometerSensor::armWakeCapture() {
+    if (!_isReady || !_haveBaseline) {
+        return;
+    }
+    // Offsets are subtracted before the threshold compare, so the
+    // interrupt fires on the deviation from the baseline
+    uint8_t offsets[6];
+    for (int axis = 0; axis < 3; axis++) {
+        int16_t digits = toDigits(_baseline[axis]);
+        offsets[2 * axis] = (uint8_t)digits;
+        offsets[2 * axis + 1] = (uint8_t)((uint16_t)digits >> 8);
+    }
+    uint16_t threshold = (uint16_t)toDigits((float)MAG_WAKE_MG);
+    uint8_t scratch;
+    bool ok = true;
+    for (int ii = 0; ii < 6 && ok; ii++) {
+        ok = writeRegister(REG_OFFSET_X_L + ii, offsets[ii]);
+    }
+    ok = ok && writeRegister(REG_INT_THS_L, (uint8_t)threshold) &&
+         writeRegister(REG_INT_THS_H, (uint8_t)(threshold >> 8)) &&
+         writeRegister(REG_CFG_B, CFG_B_INT_ON_DATAOFF) &&
+         writeRegister(REG_CFG_C, CFG_C_BDU | CFG_C_INT_ON_PIN) &&
+         readRegisters(REG_INT_SOURCE, &scratch, 1) &&
+         writeRegister(REG_INT_CTRL, INT_CTRL_XYZ_LATCHED_HIGH) &&
+         writeRegister(REG_CFG_A, CFG_A_COMP_TEMP | CFG_A_LOW_POWER);    // Continuous 10 Hz
+    _wakeArmed = ok;
+    if (!ok) {
+        Log.error("LIS2MDL: wake threshold not armed; vehicles are missed until the next wake");
+    }
+}
+
+bool VehicleMagnetometerSensor::disarmWake() {
+    if (!_wakeArmed) {
+        return false;
+    }
+    uint8_t source = 0;
+    readRegisters(REG_INT_SOURCE, &source, 1);
+    writeRegister(REG_INT_CTRL, 0x00);
+    writeRegister(REG_CFG_C, CFG_C_BDU);
+    writeRegister(REG_CFG_B, 0x00);
+    _wakeArmed = false;
+    return (source & INT_SOURCE_INT) != 0;
+}
+
+bool VehicleMagnetometerSensor::onWake() {
+    if (!_isReady) {
+        return setup();
+    }
+    uint32_t now = millis();
+    bool fired = disarmWake();
+    // Start boosted if a field change woke us; the first samples decide
+    _lastSampleMs = now;
+    setBoost(fired, now);
+    if (fired) {
+        _lastActiveMs = now;
+    }
+    return true;
+}
+
+void VehicleMagnetometerSensor::onSleep() {
+    if (!_isReady) {
+        return;
+    }
+    disarmWake();
+    writeRegister(REG_CFG_A, CFG_A_COMP_TEMP | CFG_A_IDLE);
+    _boosted = false;
+    _detecting = false;
+    _isReady = false;
+    Log.info("Magnetometer idle for sleep");
+}
+
+void VehicleMagnetometerSensor::reset() {
+    _data = SensorData();
+    _data.type = SensorType::VEHICLE_MAGNETOMETER;
+    _detecting = false;
+    _eventReady = false;
+}
+
+bool VehicleMagnetometerSensor::readRegisters(uint8_t reg, uint8_t* buffer, size_t length) {
+    Wire.lock();
+    Wire.beginTransmission(MAG_I2C_ADDR);
+    Wire.write(reg);
+    if (Wire.endTransmission(false) != 0) {
+        Wire.unlock();
+        _lastErrorCode = ERROR_I2C;
+        return false;
+    }
+    size_t received = Wire.requestFrom((int)MAG_I2C_ADDR, (int)length);
+    if (received < length || (size_t)Wire.available() < length) {
+        Wire.unlock();
+        _lastErrorCode = ERROR_I2C;
+        return false;
+    }
+    for (size_t ii = 0; ii < length; ii++) {
+        buffer[ii] = (uint8_t)Wire.read();
+    }
+    Wire.unlock();
+    return true;
+}
+
+bool VehicleMagnetometerSensor::writeRegister(uint8_t reg, uint8_t value) {
+    Wire.lock();
+    Wire.beginTransmission(MAG_I2C_ADDR);
+    Wire.write(reg);
+    Wire.write(value);
+    bool ok = (Wire.endTransmission() == 0);
+    Wire.unlock();
+    if (!ok) {
+        _lastErrorCode = ERROR_I2C;
+    }
+    return ok;
+}
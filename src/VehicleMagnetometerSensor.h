@@ -0,0 +1,140 @@
+// src/VehicleMagnetometerSensor.h
+#ifndef VEHICLEMAGNETOMETERSENSOR_H
+#define VEHICLEMAGNETOMETERSENSOR_H
+
+#include "ISensor.h"
+#include "Config.h"
+#include "Particle.h"
+#include "device_pinout.h"
+
+/**
+ * @brief Vehicle detector on an LIS2MDL magnetometer, with a drifting
+ *        baseline and an adaptive sample rate.
+ *
+ * A vehicle's steel bends the earth's field by tens to hundreds of mG
+ * near the sensor. Temperature and the seasons move the field too, more
+ * slowly, so detection works on the deviation from a baseline rather
+ * than on fixed levels:
+ *
+ * - Baseline: per-axis EWMA with time constant MAG_BASELINE_TAU_SEC,
+ *   frozen while a detection is open.
+ * - Detection: opens when |field - baseline| reaches MAG_ENTER_MG and
+ *   closes after MAG_EXIT_SAMPLES samples below MAG_EXIT_MG. One vehicle
+ *   is reported when it closes. A detection still open after
+ *   MAG_MAX_DWELL_SEC is a parked vehicle: it is reported and becomes the
+ *   new baseline.
+ * - Sample rate: one single-shot conversion every MAG_QUIET_PERIOD_MS
+ *   while quiet; continuous at MAG_BOOST_ODR_HZ from the first sample
+ *   past MAG_BOOST_MG until MAG_BOOST_HOLD_MS after the last one.
+ *
+ * For a nap, armWakeCapture() loads the baseline into the part's
+ * hard-iron offset registers and enables its threshold interrupt
+ * (MAG_WAKE_MG on any axis, INT pin wired to intPin), running at 10 Hz
+ * in low-power mode. A vehicle then wakes the device and sampling starts
+ * boosted. Between conversions the part is idle.
+ *
+ * Output per vehicle (SensorData / SensorEvent):
+ * - primary:   peak deviation in mG
+ * - secondary: dwell in seconds (SensorEvent::pulseMs has it in ms)
+ * - aux1:      baseline magnitude in mG
+ * - aux2:      samples taken during the detection
+ * - flag1:     vehicle (always set on a returned event)
+ * - flag2:     closed by MAG_MAX_DWELL_SEC (parked)
+ */
+class VehicleMagnetometerSensor : public ISensor {
+public:
+    /**
+     * @brief Get singleton instance
+     */
+    static VehicleMagnetometerSensor& instance() {
+        static VehicleMagnetometerSensor _instance;
+        return _instance;
+    }
+
+    bool setup() override;
+    bool loop() override;
+    size_t drain(SensorEvent* out, size_t max) override;
+
+    const SensorData& getData() const override { return _data; }
+    const char* getSensorType() const override { return "VehicleMagnetometer"; }
+    bool isReady() const override { return _isReady; }
+    void reset() override;
+
+    // Serviced on every pass; it paces its own sampling
+    bool usesInterrupt() const override { return true; }
+    WakeSource wakeSource() const override { return WakeSource::gpio(intPin, RISING); }
+    void onSleep() override;
+    bool onWake() override;
+    void armWakeCapture() override;
+
+    bool isHealthy() const override { return _lastErrorCode == 0; }
+    int lastErrorCode() const override { return _lastErrorCode; }
+
+    // Boosted: a vehicle is passing or just passed; the nap waits for it
+    bool isBusy() const override { return _isReady && _boosted; }
+
+    /** @brief Error code: no LIS2MDL answered at MAG_I2C_ADDR. */
+    static constexpr int ERROR_NOT_FOUND = 1;
+    /** @brief Error code: an I2C transfer failed. */
+    static constexpr int ERROR_I2C = 2;
+
+private:
+    VehicleMagnetometerSensor() {}
+    ~VehicleMagnetometerSensor() {}
+    VehicleMagnetometerSensor(const VehicleMagnetometerSensor&) = delete;
+    VehicleMagnetometerSensor& operator=(const VehicleMagnetometerSensor&) = delete;
+
+    bool readRegisters(uint8_t reg, uint8_t* buffer, size_t length);
+    bool writeRegister(uint8_t reg, uint8_t value);
+
+    /**
+     * @brief Switch between quiet single-shot and boosted continuous sampling.
+     */
+    void setBoost(bool boost, uint32_t now);
+
+    /**
+     * @brief Undo armWakeCapture(); returns true if the threshold had fired.
+     */
+    bool disarmWake();
+
+    /**
+     * @brief Read one conversion in mG per axis.
+     */
+    bool readField(float field[3]);
+
+    /**
+     * @brief Baseline, hysteresis and boost for one sample.
+     * @return true if a vehicle was completed, now in _data
+     */
+    bool process(const float field[3], uint32_t now);
+
+    /**
+     * @brief Report the open detection and close it.
+     */
+    void closeDetection(uint32_t now, bool parked);
+
+    bool _isReady = false;
+    int _lastErrorCode = 0;
+    SensorData _data;
+
+    float _baseline[3] = {0.0f, 0.0f, 0.0f};
+    bool _haveBaseline = false;
+    uint32_t _lastSampleMs = 0;
+
+    bool _boosted = false;
+    bool _conversionPending = false;    // Single shot triggered, not yet read
+    uint32_t _nextSampleMs = 0;
+    uint32_t _lastActiveMs = 0;         // Last sample past MAG_BOOST_MG
+    bool _wakeArmed = false;
+
+    bool _detecting = false;
+    uint32_t _detectStartMs = 0;
+    float _peakDeviationMg = 0.0f;
+    uint16_t _detectSamples = 0;
+    uint8_t _belowExit = 0;
+
+    bool _eventReady = false;
+    SensorEvent _event;
+};
+
+#endif /* VEHICLEMAGNETOMETERSENSOR_H */
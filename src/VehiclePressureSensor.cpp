@@ -0,0 +1,212 @@
+// src/VehiclePressureSensor.cpp
+#include "VehiclePressureSensor.h"
+#include "Config.h"
+#include "PowerDomains.h"
+
+EventRing<uint32_t, 32> VehiclePressureSensor::_hitRing;
+
+// Static ISR handler: timestamp only, all pairing happens in loop().
+void VehiclePressureSensor::tubeISR() {
+    _hitRing.push((uint32_t)micros());
+}
+
+void VehiclePressureSensor::powerUp() {
+    PowerDomains::acquire(PowerDomains::SENSOR, this);
+#if INDICATOR_LEDS
+    PowerDomains::acquire(PowerDomains::SENSOR_LED, this);
+#endif
+}
+
+bool VehiclePressureSensor::setup() {
+    pinMode(intPin, INPUT_PULLDOWN);   // Tube switch output with pull-down
+    powerUp();
+
+    loadConfig();
+    reset();
+
+    attachInterrupt(intPin, tubeISR, RISING);
+    _isReady = true;
+    Log.info("Vehicle pressure sensor ready (pair window %lu ms, wheelbase %u cm)",
+             (unsigned long)(_pairWindowUs / 1000), _wheelbaseCm);
+    return true;
+}
+
+void VehiclePressureSensor::loadConfig() {
+    _configSeq = ConfigSnapshot::sequence();
+    ConfigSnapshot::Values config = ConfigSnapshot::read();
+    uint16_t window = config.threshold1;
+    uint16_t wheelbase = config.threshold2;
+
+    // Out-of-range values fall back to typical passenger-car figures.
+    if (window < 1 || window > 100) {
+        window = 60;
+    }
+    if (wheelbase < 10 || wheelbase > 100) {
+        wheelbase = 27;
+    }
+    _pairWindowUs = (uint32_t)window * 10000UL;
+    _wheelbaseCm = wheelbase * 10;
+}
+
+void VehiclePressureSensor::reset() {
+    _data = SensorData();
+    _data.type = SensorType::VEHICLE_PRESSURE;
+    _hitRing.clear();
+    _inVehicle = false;
+    _axleCount = 0;
+    _readyCount = 0;
+}
+
+void VehiclePressureSensor::processHits(uint32_t nowUs) {
+    time_t nowSec = Time.now();
+    uint32_t hitUs;
+
+    if (ConfigSnapshot::sequence() != _configSeq) {
+        loadConfig();       // Tuned from the cloud; the vehicle being assembled carries on
+    }
+    while (_hitRing.pop(hitUs)) {
+        if (_inVehicle && (uint32_t)(hitUs - _lastHitUs) > _pairWindowUs) {
+            // Gap too long: previous vehicle is complete.
+            closeVehicle(hitUs, nowSec - (time_t)((uint32_t)(nowUs - hitUs) / 1000000UL));
+        }
+        if (!_inVehicle) {
+            _inVehicle = true;
+            _axleCount = 0;
+            _firstHitUs = hitUs;
+        }
+        if (_axleCount == 1) {
+            _secondHitUs = hitUs;
+        }
+        if (_axleCount < UINT16_MAX) {
+            _axleCount++;
+        }
+        _lastHitUs = hitUs;
+    }
+
+    if (_inVehicle && (uint32_t)(nowUs - _lastHitUs) > _pairWindowUs) {
+        closeVehicle(nowUs, nowSec);
+    }
+
+    uint32_t overflows = _hitRing.overflows();
+    if (overflows != _lastOverflowCount) {
+        Log.warn("Tube hit ring overflow: %lu hits dropped",
+                 (unsigned long)(overflows - _lastOverflowCount));
+        _lastOverflowCount = overflows;
+    }
+}
+
+void VehiclePressureSensor::closeVehicle(uint32_t nowUs, time_t nowSec) {
+    Vehicle v;
+    v.axles = _axleCount;
+    v.firstGapMs = 0;
+    v.speedDkmh = 0;
+
+    // Back-date to the first axle so the count lands in the right hour.
+    uint32_t ageUs = (uint32_t)(micros() - _firstHitUs);
+    v.timestamp = nowSec - (time_t)((uint32_t)(nowUs - _firstHitUs) / 1000000UL);
+    v.tickMs = millis() - ageUs / 1000UL;
+
+    if (_axleCount >= 2) {
+        uint32_t gapUs = _secondHitUs - _firstHitUs;
+        uint32_t gapMs = gapUs / 1000UL;
+        v.firstGapMs = (uint16_t)(gapMs > UINT16_MAX ? UINT16_MAX : gapMs);
+        if (gapUs > 0) {
+            // speed[0.1 km/h] = wheelbase[cm] * 0.036 / gap[s] * 10
+            //                 = wheelbase[cm] * 360000 / gap[us]
+            uint32_t speed = ((uint32_t)_wheelbaseCm * 360000UL) / gapUs;
+            v.speedDkmh = (uint16_t)(speed > UINT16_MAX ? UINT16_MAX : speed);
+        }
+    }
+
+    _inVehicle = false;
+    _axleCount = 0;
+
+    if (_readyCount < sizeof(_ready) / sizeof(_ready[0])) {
+        _ready[_readyCount++] = v;
+    } else {
+        Log.warn("Vehicle output buffer full; vehicle dropped");
+    }
+}
+
+void VehiclePressureSensor::publishVehicle(const Vehicle& v) {
+    _data.timestamp = v.timestamp;
+    _data.hasNewData = true;
+    _data.primary = v.axles;
+    _data.secondary = v.firstGapMs;
+    _data.aux1 = v.speedDkmh;
+    _data.aux2 = 0;                 // Direction unknown with a single tube
+    _data.flag1 = v.axles >= 3;
+    _data.flag2 = v.axles == 1;
+
+    if (ConfigSnapshot::read().verboseMode) {
+        Log.info("Vehicle: %u axles, gap %u ms, ~%u.%u km/h", v.axles, v.firstGapMs,
+                 v.speedDkmh / 10, v.speedDkmh % 10);
+    }
+}
+
+bool VehiclePressureSensor::loop() {
+    if (!_isReady) {
+        return false;
+    }
+
+    processHits(micros());
+    if (_readyCount == 0) {
+        return false;
+    }
+
+    publishVehicle(_ready[0]);
+    for (uint8_t i = 1; i < _readyCount; i++) {
+        _ready[i - 1] = _ready[i];
+    }
+    _readyCount--;
+    return true;
+}
+
+size_t VehiclePressureSensor::drain(SensorEvent* out, size_t max) {
+    if (!_isReady || !out || max == 0) {
+        return 0;
+    }
+
+    processHits(micros());
+
+    size_t n = 0;
+    while (n < max && n < _readyCount) {
+        const Vehicle& v = _ready[n];
+        publishVehicle(v);
+        out[n] = SensorEvent();
+        out[n].tickMs = v.tickMs;
+        out[n].type = SensorType::VEHICLE_PRESSURE;
+        out[n].flags = (v.axles >= 3 ? 0x01 : 0) | (v.axles == 1 ? 0x02 : 0);
+        out[n].primary = v.axles;
+        out[n].secondary = v.firstGapMs;
+        n++;
+    }
+    for (uint8_t i = n; i < _readyCount; i++) {
+        _ready[i - n] = _ready[i];
+    }
+    _readyCount -= n;
+    return n;
+}
+
+void VehiclePressureSensor::onSleep() {
+    if (!_isReady) {
+        return;
+    }
+    detachInterrupt(intPin);
+    PowerDomains::release(PowerDomains::SENSOR, this);
+    PowerDomains::release(PowerDomains::SENSOR_LED, this);
+    _isReady = false;
+    Log.info("Vehicle pressure sensor powered down for sleep");
+}
+
+bool VehiclePressureSensor::onWake() {
+    // Keep any hits already in the ring; they may be the wake cause.
+    pinMode(intPin, INPUT_PULLDOWN);
+    powerUp();
+
+    attachInterrupt(intPin, tubeISR, RISING);
+    loadConfig();
+    _isReady = true;
+    Log.info("Vehicle pressure sensor powered up after wake");
+    return true;
+}
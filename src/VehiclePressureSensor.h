@@ -0,0 +1,126 @@
+// src/VehiclePressureSensor.h
+#ifndef VEHICLEPRESSURESENSOR_H
+#define VEHICLEPRESSURESENSOR_H
+
+#include "ISensor.h"
+#include "EventRing.h"
+#include "Particle.h"
+#include "device_pinout.h"
+#include "ConfigSnapshot.h"    // threshold1/2 (pairing parameters)
+
+/**
+ * @brief Road-tube (pneumatic pressure switch) vehicle sensor.
+ *
+ * Every tube hit is timestamped in the ISR and pushed into a lock-free
+ * ring. loop()/drain() group hits into vehicles by time: a hit within
+ * the pairing window of the previous hit is another axle of the same
+ * vehicle; once the window passes with no further hit the vehicle is
+ * closed and reported. A missed or extra pulse therefore only affects
+ * that one vehicle instead of inverting front/rear pairing for the
+ * rest of the day.
+ *
+ * Configuration (sensorConfig, both limited to 1..100; a change is picked
+ * up from ConfigSnapshot before the next hits are paired):
+ * - threshold1: axle-pairing window in units of 10 ms (60 = 600 ms)
+ * - threshold2: nominal wheelbase in decimetres used for the speed
+ *               estimate (27 = 2.7 m)
+ *
+ * Output per vehicle (SensorData / SensorEvent):
+ * - primary:   axle count
+ * - secondary: first-to-second axle interval in ms (0 for single hits)
+ * - aux1:      estimated speed in 0.1 km/h (0 if not computable); SensorData
+ *              only, as SensorEvent has no field for it (gap and wheelbase
+ *              give it back)
+ * - aux2:      direction (0 = unknown; a single tube cannot tell)
+ * - flag1:     multi-axle vehicle (3 or more axles); SensorEvent flags 0x01
+ * - flag2:     unpaired single hit (likely a missed pulse); flags 0x02
+ */
+class VehiclePressureSensor : public ISensor {
+public:
+    /**
+     * @brief Get singleton instance
+     */
+    static VehiclePressureSensor& instance() {
+        static VehiclePressureSensor _instance;
+        return _instance;
+    }
+
+    bool setup() override;
+    bool loop() override;
+    size_t drain(SensorEvent* out, size_t max) override;
+
+    const SensorData& getData() const override { return _data; }
+    const char* getSensorType() const override { return "VehiclePressure"; }
+    bool isReady() const override { return _isReady; }
+    void reset() override;
+
+    bool usesInterrupt() const override { return true; }
+    WakeSource wakeSource() const override { return WakeSource::gpio(intPin, RISING); }
+    void onSleep() override;
+    bool onWake() override;
+
+    /**
+     * @brief Re-read pairing window and wheelbase from ConfigSnapshot.
+     */
+    void loadConfig();
+
+private:
+    VehiclePressureSensor() {}
+    ~VehiclePressureSensor() {}
+    VehiclePressureSensor(const VehiclePressureSensor&) = delete;
+    VehiclePressureSensor& operator=(const VehiclePressureSensor&) = delete;
+
+    /** @brief Hold the sensor supply, and the board LED with INDICATOR_LEDS. */
+    void powerUp();
+
+    /** @brief A fully paired vehicle waiting to be returned. */
+    struct Vehicle {
+        time_t   timestamp;
+        uint32_t tickMs;
+        uint16_t axles;
+        uint16_t firstGapMs;
+        uint16_t speedDkmh;
+    };
+
+    /**
+     * @brief Pull hits from the ring and close any vehicle whose window expired.
+     */
+    void processHits(uint32_t nowUs);
+
+    /**
+     * @brief Finish the vehicle in progress and queue it for output.
+     */
+    void closeVehicle(uint32_t nowUs, time_t nowSec);
+
+    /**
+     * @brief Copy a closed vehicle into _data.
+     */
+    void publishVehicle(const Vehicle& v);
+
+    bool _isReady = false;
+    SensorData _data;
+
+    // Pairing parameters (cached from ConfigSnapshot at _configSeq)
+    uint32_t _pairWindowUs = 600000UL;
+    uint16_t _wheelbaseCm = 270;
+    uint32_t _configSeq = 0;
+
+    // Vehicle currently being assembled
+    bool _inVehicle = false;
+    uint16_t _axleCount = 0;
+    uint32_t _firstHitUs = 0;
+    uint32_t _lastHitUs = 0;
+    uint32_t _secondHitUs = 0;
+
+    // Closed vehicles not yet returned by loop()/drain()
+    Vehicle _ready[4];
+    uint8_t _readyCount = 0;
+
+    uint32_t _lastOverflowCount = 0;
+
+    static EventRing<uint32_t, 32> _hitRing;  // Tube hit timestamps, ISR -> loop()
+
+    static void tubeISR();
+};
+
+#endif /* VEHICLEPRESSURESENSOR_H */
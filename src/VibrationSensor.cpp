@@ -0,0 +1,126 @@
+// src/VibrationSensor.cpp
+#include "VibrationSensor.h"
+#include "TinyClassifier.h"
+#include <math.h>
+
+// LIS2MDL registers and values used here
+namespace {
+const uint8_t REG_MAG_WHO_AM_I = 0x4F;
+const uint8_t REG_MAG_CFG_A = 0x60;
+const uint8_t REG_MAG_CFG_C = 0x62;
+const uint8_t REG_MAG_OUTX_L = 0x68;
+
+const uint8_t WHO_AM_I_LIS2MDL = 0x40;
+const uint8_t CFG_A_CONTINUOUS_LP = 0x90;   // Temperature compensation, low power, 10 Hz
+const uint8_t CFG_A_IDLE = 0x03;
+const uint8_t CFG_C_BDU = 0x10;
+
+const float MAG_MG_PER_DIGIT = 1.5f;
+
+// Baseline weight per burst; bursts with a vehicle do not move it
+const float FIELD_BASELINE_ALPHA = 0.125f;
+
+uint16_t clampU16(float value) {
+    return value <= 0.0f ? 0 : value >= 65535.0f ? 65535 : (uint16_t)(value + 0.5f);
+}
+} // namespace
+
+static_assert(Lis3dhSensor::FIFO_DEPTH == SpectralFeatures::FFT_SIZE, "One FFT per FIFO burst");
+static_assert(SpectralFeatures::BANDS == 4, "aux1 packs four 4-bit band levels");
+static_assert(VIBRATION_ODR_HZ == 10 || VIBRATION_ODR_HZ == 25 || VIBRATION_ODR_HZ == 50 || VIBRATION_ODR_HZ == 100,
+              "VIBRATION_ODR_HZ must be 10, 25, 50 or 100");
+static_assert(VIBRATION_WAKE_THRESHOLD_MG / 16 >= 1 && VIBRATION_WAKE_THRESHOLD_MG / 16 <= 127,
+              "VIBRATION_WAKE_THRESHOLD_MG must be 16..2032 mg");
+
+bool VibrationSensor::setup() {
+    if (!Lis3dhSensor::setup()) {
+        return false;
+    }
+
+    uint8_t whoAmI = 0;
+    _magFound = i2cRead(VIBRATION_MAG_I2C_ADDR, REG_MAG_WHO_AM_I, &whoAmI, 1) && whoAmI == WHO_AM_I_LIS2MDL &&
+                i2cWrite(VIBRATION_MAG_I2C_ADDR, REG_MAG_CFG_C, CFG_C_BDU) &&
+                i2cWrite(VIBRATION_MAG_I2C_ADDR, REG_MAG_CFG_A, CFG_A_CONTINUOUS_LP);
+    _lastErrorCode = 0;     // The magnetometer is optional
+    _fieldBaselineMg = 0.0f;
+    if (_magFound) {
+        delay(100);         // First 10 Hz conversion
+        readFieldMg(_fieldBaselineMg);
+    }
+    Log.info("Vibration features: %u-point FFT at %d Hz, magnetometer %s",
+             (unsigned)SpectralFeatures::FFT_SIZE, VIBRATION_ODR_HZ, _magFound ? "found" : "not fitted");
+    return true;
+}
+
+void VibrationSensor::onSleep() {
+    if (_magFound && isReady()) {
+        i2cWrite(VIBRATION_MAG_I2C_ADDR, REG_MAG_CFG_A, CFG_A_IDLE);
+    }
+    Lis3dhSensor::onSleep();
+}
+
+bool VibrationSensor::readFieldMg(float& fieldMg) {
+    uint8_t raw[6];
+    if (!_magFound || !i2cRead(VIBRATION_MAG_I2C_ADDR, REG_MAG_OUTX_L, raw, sizeof(raw))) {
+        return false;
+    }
+    float sumSquares = 0.0f;
+    for (int axis = 0; axis < 3; axis++) {
+        float value = (float)(int16_t)(raw[2 * axis] | (raw[2 * axis + 1] << 8)) * MAG_MG_PER_DIGIT;
+        sumSquares += value * value;
+    }
+    fieldMg = sqrtf(sumSquares);
+    return true;
+}
+
+bool VibrationSensor::classify(const uint8_t* burst, size_t samples) {
+    static float axisMg[3][SpectralFeatures::FFT_SIZE];
+    for (size_t ii = 0; ii < samples; ii++) {
+        for (int axis = 0; axis < 3; axis++) {
+            axisMg[axis][ii] = (float)sampleMg(&burst[ii * SAMPLE_SIZE], axis);
+        }
+    }
+    const float* axes[3] = {axisMg[0], axisMg[1], axisMg[2]};
+    SpectralFeatures::extract(axes, samples, (float)odrHz(), _features);
+
+    float deviationMg = 0.0f;
+    float fieldMg;
+    bool haveField = readFieldMg(fieldMg);
+    if (haveField) {
+        deviationMg = fabsf(fieldMg - _fieldBaselineMg);
+        if (deviationMg < VIBRATION_MAG_DELTA_MG) {
+            _fieldBaselineMg += FIELD_BASELINE_ALPHA * (fieldMg - _fieldBaselineMg);
+        }
+    }
+
+    if (_features.rmsMg < VIBRATION_EVENT_RMS_MG || _features.peakHz < VIBRATION_EVENT_MIN_HZ ||
+        _features.peakHz > VIBRATION_EVENT_MAX_HZ) {
+        return false;
+    }
+    _data.classBits = 0;
+#if CLASSIFIER_ENABLED
+    const float features[] = {_features.rmsMg, _features.peakHz,
+                              _features.bandRmsMg[0], _features.bandRmsMg[1],
+                              _features.bandRmsMg[2], _features.bandRmsMg[3], deviationMg};
+    if (!TinyClassifier::screen(SensorType::VIBRATION_ADVANCED, features, 7, _data.classBits)) {
+        return false;
+    }
+#endif
+
+    uint16_t bandLevels = 0;
+    for (size_t band = 0; band < SpectralFeatures::BANDS; band++) {
+        uint32_t level = 0;
+        for (uint32_t value = clampU16(_features.bandRmsMg[band]) + 1; value > 1 && level < 15; value >>= 1) {
+            level++;
+        }
+        bandLevels |= (uint16_t)(level << (4 * band));
+    }
+
+    _data.primary = clampU16(_features.rmsMg);
+    _data.secondary = clampU16(_features.peakHz * 10.0f);
+    _data.aux1 = bandLevels;
+    _data.aux2 = clampU16(deviationMg);
+    _data.flag1 = true;
+    _data.flag2 = haveField && deviationMg >= VIBRATION_MAG_DELTA_MG;
+    return true;
+}
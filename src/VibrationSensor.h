@@ -0,0 +1,78 @@
+// src/VibrationSensor.h
+#ifndef VIBRATIONSENSOR_H
+#define VIBRATIONSENSOR_H
+
+#include "Lis3dhSensor.h"
+#include "SpectralFeatures.h"
+
+/**
+ * @brief Vibration events from an LIS3DH plus an optional LIS2MDL
+ *        magnetometer, classified by spectrum on the device.
+ *
+ * Raw samples are too much to send over cellular, so each FIFO burst
+ * (see Lis3dhSensor) is reduced on the device by SpectralFeatures: RMS,
+ * peak frequency and SpectralFeatures::BANDS band RMS values. A burst is
+ * an event when its RMS reaches VIBRATION_EVENT_RMS_MG with the peak
+ * between VIBRATION_EVENT_MIN_HZ and VIBRATION_EVENT_MAX_HZ, so wind and
+ * single knocks, which peak outside the band, are turned down. Events go
+ * through drain() to the counters like any other sensor.
+ *
+ * If an LIS2MDL answers at VIBRATION_MAG_I2C_ADDR, it runs continuously
+ * in low-power mode and one field reading is taken per burst. Its
+ * deviation from a slow baseline marks a vehicle (steel) rather than a
+ * person or animal.
+ *
+ * With CLASSIFIER_ENABLED, a burst that passes the thresholds is labelled
+ * by TinyClassifier from RMS, peak frequency, the band RMS values and the
+ * magnetic deviation; noise is turned down as well.
+ *
+ * Output per event (SensorData; SensorEvent carries primary, secondary
+ * and the flags):
+ * - primary:   RMS in mg
+ * - secondary: peak frequency in 0.1 Hz
+ * - aux1:      band levels, 4 bits per band, lowest band in the low
+ *              nibble; each is floor(log2(band RMS mg + 1))
+ * - aux2:      magnetic deviation from the baseline in mG (0 without a magnetometer)
+ * - flag1:     vibration event (always set on a returned event)
+ * - flag2:     magnetic deviation at least VIBRATION_MAG_DELTA_MG
+ * - classBits: classifier label (CLASSIFIER_ENABLED with a model)
+ */
+class VibrationSensor : public Lis3dhSensor {
+public:
+    /**
+     * @brief Get singleton instance
+     */
+    static VibrationSensor& instance() {
+        static VibrationSensor _instance;
+        return _instance;
+    }
+
+    bool setup() override;
+    void onSleep() override;
+
+    const char* getSensorType() const override { return "VibrationAdvanced"; }
+
+    /** @brief Features of the last burst, event or not. */
+    const SpectralFeatures::Features& features() const { return _features; }
+
+protected:
+    bool classify(const uint8_t* burst, size_t samples) override;
+
+private:
+    VibrationSensor()
+        : Lis3dhSensor(SensorType::VIBRATION_ADVANCED, VIBRATION_ODR_HZ, VIBRATION_WAKE_THRESHOLD_MG,
+                       VIBRATION_WAKE_DURATION) {}
+    ~VibrationSensor() {}
+
+    /**
+     * @brief Field magnitude in mG from the magnetometer.
+     * @return false without a magnetometer or on an I2C error
+     */
+    bool readFieldMg(float& fieldMg);
+
+    SpectralFeatures::Features _features = {};
+    bool _magFound = false;
+    float _fieldBaselineMg = 0.0f;
+};
+
+#endif /* VIBRATIONSENSOR_H */
@@ -0,0 +1,79 @@
+#include "WakeAccuracy.h"
+#include "Config.h"
+#include "MyPersistentData.h"
+
+namespace WakeAccuracy {
+
+// An error bigger than this is a clock step (sync, drift correction), not the wake
+static const int32_t MAX_MEASURED_SEC = 60;
+
+static time_t handledTarget = 0;    // Target an early wake reported for
+static int32_t lastErrorSec = 0;    // Time.now() - target at the last measured wake
+
+time_t nextTarget(time_t target, int boundarySec) {
+    if (handledTarget != 0 && target <= handledTarget && boundarySec > 0) {
+        Log.info("WakeAccuracy: boundary at %lu already reported after an early wake; next one",
+                 (unsigned long)target);
+        target += boundarySec;
+    }
+    return target;
+}
+
+uint32_t durationMs(time_t target) {
+#if WAKE_ACCURACY_ENABLED
+    int32_t correctionMs = sysStatus.get_wakeCorrectionMs();
+#else
+    int32_t correctionMs = WAKE_CORRECTION_INITIAL_MS;
+#endif
+    int64_t ms = (int64_t)(target - Time.now()) * 1000 + correctionMs;
+    return ms < 1000 ? 1000 : (uint32_t)ms;
+}
+
+void noteTimerWake(time_t target) {
+#if WAKE_ACCURACY_ENABLED
+    if (!Time.isValid() || target == 0) {
+        return;
+    }
+    int32_t errorSec = (int32_t)(Time.now() - target);
+    if (errorSec > MAX_MEASURED_SEC || errorSec < -MAX_MEASURED_SEC) {
+        Log.info("WakeAccuracy: wake %ld s from target; clock stepped, not measured", (long)errorSec);
+        return;
+    }
+    lastErrorSec = errorSec;
+    if (sysStatus.get_timerWakes() < UINT16_MAX) {
+        sysStatus.set_timerWakes(sysStatus.get_timerWakes() + 1);
+    }
+
+    int32_t correctionMs = sysStatus.get_wakeCorrectionMs();
+    int32_t updated = correctionMs;
+    if (errorSec < 0) {
+        // Early: the report still goes, but the next nap must not wake for this boundary again
+        handledTarget = target;
+        if (sysStatus.get_earlyWakes() < UINT16_MAX) {
+            sysStatus.set_earlyWakes(sysStatus.get_earlyWakes() + 1);
+        }
+        updated += -errorSec * 1000 + 1000;
+    } else if (errorSec >= 2) {
+        updated -= WAKE_CORRECTION_TRIM_MS;
+    }
+    updated = updated < 0 ? 0 : updated > WAKE_CORRECTION_MAX_MS ? WAKE_CORRECTION_MAX_MS : updated;
+    if (updated != correctionMs) {
+        sysStatus.set_wakeCorrectionMs((int16_t)updated);
+    }
+    Log.info("WakeAccuracy: timer wake %+ld s from target; correction %ld ms%s", (long)errorSec,
+             (long)updated, errorSec < 0 ? " (early)" : "");
+#endif
+}
+
+void writeStatus(JSONWriter &writer) {
+#if WAKE_ACCURACY_ENABLED
+    writer.name("wake").beginObject();
+    writer.name("n").value((unsigned long)sysStatus.get_timerWakes());
+    writer.name("early").value((unsigned long)sysStatus.get_earlyWakes());
+    writer.name("corrMs").value((int)sysStatus.get_wakeCorrectionMs());
+    writer.name("lastSec").value((int)lastErrorSec);
+    writer.endObject();
+#endif
+}
+
+} // namespace WakeAccuracy
@@ -0,0 +1,67 @@
+/**
+ * @file WakeAccuracy.h
+ * @brief Measures boundary timer wakes against the time they were meant
+ *        for and learns a per-device margin, so naps do not end early.
+ *
+ * @details A nap to the next reporting boundary is planned as an absolute
+ *          time (boundary plus the device's jitter). durationMs() turns it
+ *          into the timer duration at the last moment before System.sleep(),
+ *          so the disconnect and sensor shutdown in between are not added
+ *          to the nap, and adds the learned correction.
+ *
+ *          After each timer wake from such a nap, noteTimerWake() compares
+ *          Time with the target. Wake latency, the sleep timer's granularity
+ *          and clock error all show up here. A wake before the target raises
+ *          the correction by the shortfall plus a second; one 2 s or more
+ *          late lowers it by WAKE_CORRECTION_TRIM_MS. The correction and the
+ *          wake counts are kept in sysStatus.
+ *
+ *          An early wake still reports (the report is stamped with the
+ *          boundary), and nextTarget() then moves the following nap past
+ *          the boundary that wake handled, instead of sleeping a second or
+ *          two and waking for it again.
+ *
+ *          The target is not an AB1805 alarm: the naps keep the Device OS
+ *          timer, which needs no wake pin, and only the duration is derived
+ *          from the absolute time. A HIBERNATE nap uses the correction but
+ *          its wake is a boot and is not measured.
+ *
+ *          Application thread only.
+ */
+
+#ifndef __WAKEACCURACY_H
+#define __WAKEACCURACY_H
+
+#include "Particle.h"
+
+namespace WakeAccuracy {
+
+/**
+ * @brief The next boundary target, skipping one an early wake already reported
+ *
+ * @param target Next boundary plus jitter, from Time.now()
+ * @param boundarySec Reporting boundary length
+ */
+time_t nextTarget(time_t target, int boundarySec);
+
+/**
+ * @brief Timer duration to wake just after @p target, from Time.now(), with
+ *        the learned correction; at least 1 s
+ */
+uint32_t durationMs(time_t target);
+
+/**
+ * @brief A timer wake from a nap planned for @p target; measure it and
+ *        update the correction
+ */
+void noteTimerWake(time_t target);
+
+/**
+ * @brief Write {"n":n,"early":n,"corrMs":n,"lastSec":n} to an open JSON
+ *        object as "wake"
+ */
+void writeStatus(JSONWriter &writer);
+
+} // namespace WakeAccuracy
+
+#endif /* __WAKEACCURACY_H */
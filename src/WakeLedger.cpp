@@ -0,0 +1,207 @@
+#include "WakeLedger.h"
+#include "Config.h"
+#include "MyPersistentData.h"
+#include "SensorManager.h"
+
+namespace WakeLedger {
+
+struct Record {
+    uint32_t wakeTime;          // UTC, 0 if the clock was not valid
+    uint32_t asleepSec;         // Before this wake; 0 for BOOT
+    uint32_t awakeMs;
+    uint16_t counts;            // Events accepted plus edges counted asleep, saturating
+    uint8_t reason;
+    uint8_t work;
+};
+static_assert(sizeof(Record) == 16, "WakeLedger::Record must stay 16 bytes");
+
+struct Summary {
+    uint16_t wakes[NUM_REASONS];
+    uint16_t idle[NUM_REASONS];
+    uint32_t awakeMs[NUM_REASONS];
+    uint32_t asleepSec[NUM_REASONS];
+};
+
+struct Block {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t head;              // Next slot to write
+    uint16_t count;
+    uint16_t reserved;
+    Record ring[WAKE_LEDGER_ENTRIES];
+    Summary day;
+};
+
+// Checked with magic only, like the state counts: a torn record costs one bad line
+static constexpr uint32_t BLOCK_MAGIC = 0x3a4e1ed9;
+static constexpr uint16_t BLOCK_VERSION = 1;
+
+static retained Block block;
+
+static const char *const reasonNames[NUM_REASONS] = {"boot", "timer", "sensor", "button"};
+static const char reasonLetters[NUM_REASONS] = {'b', 't', 's', 'u'};
+
+// The open record
+static bool recording = false;
+static Record wake;
+static uint32_t wakeMs = 0;
+static uint32_t acceptedAtWake = 0;
+
+// "<wakeTime>,<reason letter>,<asleepSec>,<awakeMs>,<counts>,<work>"
+static int format(const Record &r, char *buf, size_t size) {
+    return snprintf(buf, size, "%lu,%c,%lu,%lu,%u,%u", (unsigned long)r.wakeTime,
+                    reasonLetters[r.reason < NUM_REASONS ? r.reason : 0], (unsigned long)r.asleepSec,
+                    (unsigned long)r.awakeMs, (unsigned)r.counts, (unsigned)r.work);
+}
+
+static const Record &nthOldest(size_t nth) {
+    return block.ring[(block.head + WAKE_LEDGER_ENTRIES - block.count + nth) % WAKE_LEDGER_ENTRIES];
+}
+
+static void begin(Reason reason, uint32_t asleepSec, uint32_t edges) {
+    wake = {};
+    wake.wakeTime = Time.isValid() ? (uint32_t)Time.now() : 0;
+    wake.asleepSec = asleepSec;
+    wake.counts = (uint16_t)(edges > 0xffff ? 0xffff : edges);
+    wake.reason = reason;
+    wakeMs = millis();
+    acceptedAtWake = SensorManager::instance().filter().acceptedCount();
+    recording = true;
+}
+
+void setup() {
+#if WAKE_LEDGER_ENABLED
+    if (block.magic != BLOCK_MAGIC || block.version != BLOCK_VERSION || block.head >= WAKE_LEDGER_ENTRIES ||
+        block.count > WAKE_LEDGER_ENTRIES) {
+        memset(&block, 0, sizeof(block));
+        block.magic = BLOCK_MAGIC;
+        block.version = BLOCK_VERSION;
+    }
+    begin(BOOT, 0, 0);
+#endif
+}
+
+void noteWake(Reason reason, uint32_t asleepSec, uint32_t edges) {
+#if WAKE_LEDGER_ENABLED
+    if ((size_t)reason >= NUM_REASONS) {
+        return;
+    }
+    begin(reason, asleepSec, edges);
+#endif
+}
+
+void noteSleep() {
+#if WAKE_LEDGER_ENABLED
+    if (!recording) {
+        return;
+    }
+    recording = false;
+    wake.awakeMs = millis() - wakeMs;
+    uint32_t counts = wake.counts + (SensorManager::instance().filter().acceptedCount() - acceptedAtWake);
+    wake.counts = (uint16_t)(counts > 0xffff ? 0xffff : counts);
+    if (wake.wakeTime == 0 && Time.isValid()) {
+        wake.wakeTime = (uint32_t)Time.now() - wake.awakeMs / 1000;     // The clock became valid while awake
+    }
+    if (wake.counts > 0) {
+        wake.work |= COUNTED;
+    }
+    if (wake.wakeTime != 0 && (uint32_t)sysStatus.get_lastReport() >= wake.wakeTime) {
+        wake.work |= REPORTED;
+    }
+    if (wake.wakeTime != 0 && (uint32_t)sysStatus.get_lastConnection() >= wake.wakeTime) {
+        wake.work |= CONNECTED;
+    }
+
+    block.ring[block.head] = wake;
+    block.head = (block.head + 1) % WAKE_LEDGER_ENTRIES;
+    if (block.count < WAKE_LEDGER_ENTRIES) {
+        block.count++;
+    }
+    Summary &day = block.day;
+    if (day.wakes[wake.reason] < UINT16_MAX) {
+        day.wakes[wake.reason]++;
+        day.idle[wake.reason] += wake.work == 0 ? 1 : 0;
+        day.awakeMs[wake.reason] += wake.awakeMs;
+        day.asleepSec[wake.reason] += wake.asleepSec;
+    }
+    if (sysStatus.get_verboseMode()) {
+        Log.info("WakeLedger: %s wake after %lu s asleep, %lu ms awake, %u counts, work 0x%02x",
+                 reasonNames[wake.reason], (unsigned long)wake.asleepSec, (unsigned long)wake.awakeMs,
+                 (unsigned)wake.counts, (unsigned)wake.work);
+    }
+#endif
+}
+
+size_t formatReport(char *buffer, size_t bufferSize) {
+#if WAKE_LEDGER_ENABLED
+    const Summary &day = block.day;
+
+    // Newest records first until the recent text is full, then written oldest first
+    char recent[256];
+    size_t first = block.count;
+    size_t total = 0;
+    char line[48];
+    while (first > 0) {
+        size_t len = (size_t)format(nthOldest(first - 1), line, sizeof(line));
+        if (total + len + 1 >= sizeof(recent)) {
+            break;
+        }
+        total += len + 1;
+        first--;
+    }
+    size_t used = 0;
+    recent[0] = 0;
+    for (size_t nth = first; nth < block.count && used < sizeof(recent); nth++) {
+        if (used > 0) {
+            recent[used++] = ';';
+        }
+        used += format(nthOldest(nth), recent + used, sizeof(recent) - used);
+    }
+
+    JSONBufferWriter writer(buffer, bufferSize - 1);
+    writer.beginObject();
+    writer.name("n").beginObject();
+    for (size_t ii = 0; ii < NUM_REASONS; ii++) {
+        if (day.wakes[ii]) {
+            writer.name(reasonNames[ii]).value((int)day.wakes[ii]);
+        }
+    }
+    writer.endObject();
+    writer.name("awakeMs").beginObject();
+    for (size_t ii = 0; ii < NUM_REASONS; ii++) {
+        if (day.wakes[ii]) {
+            writer.name(reasonNames[ii]).value((unsigned long)(day.awakeMs[ii] / day.wakes[ii]));
+        }
+    }
+    writer.endObject();
+    writer.name("asleepSec").beginObject();
+    for (size_t ii = 0; ii < NUM_REASONS; ii++) {
+        if (day.wakes[ii]) {
+            writer.name(reasonNames[ii]).value((unsigned long)day.asleepSec[ii]);
+        }
+    }
+    writer.endObject();
+    writer.name("idle").beginObject();
+    for (size_t ii = 0; ii < NUM_REASONS; ii++) {
+        if (day.idle[ii]) {
+            writer.name(reasonNames[ii]).value((int)day.idle[ii]);
+        }
+    }
+    writer.endObject();
+    writer.name("recent").value(recent);
+    writer.endObject();
+
+    if (writer.dataSize() >= bufferSize - 1) {
+        buffer[0] = 0;
+        return 0;
+    }
+    buffer[writer.dataSize()] = 0;
+
+    memset(&block.day, 0, sizeof(block.day));
+    return writer.dataSize();
+#else
+    return 0;
+#endif
+}
+
+} // namespace WakeLedger
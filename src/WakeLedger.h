@@ -0,0 +1,90 @@
+/**
+ * @file WakeLedger.h
+ * @brief One record per wake: why the device woke, how long it had slept,
+ *        how long it stayed up and what it did, with a daily summary.
+ *
+ * @details handleSleepingState() opens a record with noteWake() when a nap
+ *          ends (reason, seconds asleep, edges counted in hardware during
+ *          it), and closes it with noteSleep() just before the next nap;
+ *          setup() opens one for the boot itself, which is also how a
+ *          HIBERNATE or AB1805 power-down wake shows up. Closing adds what
+ *          the wake did, from state that is already kept rather than hooks
+ *          in each handler:
+ *
+ *          - COUNTED: the event filter accepted an event, or the nap's
+ *            hardware edge count was non-zero;
+ *          - REPORTED: sysStatus lastReport moved into the wake;
+ *          - CONNECTED: sysStatus lastConnection moved into the wake.
+ *
+ *          The last WAKE_LEDGER_ENTRIES records are kept in a retained ring
+ *          with a per-reason summary: wakes, total awake ms, total asleep
+ *          seconds and wakes that did no work. With the daily cleanup,
+ *          formatReport() gives the "wakes" event and clears the summary:
+ *
+ *              {"n":{"timer":24,"sensor":131},"awakeMs":{"timer":9120,
+ *               "sensor":640},"asleepSec":{...},"idle":{"sensor":96},
+ *               "recent":"1734567890,s,212,580,3,1;..."}
+ *
+ *          awakeMs is the mean per wake for each reason. "recent" is as
+ *          many of the newest records as fit, oldest first, each as wake
+ *          time, reason letter (b, t, s, u for boot, timer, sensor, button),
+ *          seconds asleep, ms awake, counts (events accepted plus edges
+ *          counted asleep) and the work flags.
+ *
+ *          The block survives resets and naps, and HIBERNATE only on
+ *          platforms whose retained memory does. Application thread only.
+ */
+
+#ifndef __WAKELEDGER_H
+#define __WAKELEDGER_H
+
+#include "Particle.h"
+
+namespace WakeLedger {
+
+/** @brief Why an awake period began */
+enum Reason : uint8_t {
+    BOOT,           ///< Power-up, reset, HIBERNATE or AB1805 power-down
+    TIMER,          ///< Nap timer (boundary, occupancy, sample or poll)
+    SENSOR,         ///< Sensor wake pin
+    BUTTON,         ///< Service button
+    NUM_REASONS
+};
+
+/** @brief Work done during a wake; 0 is an idle wake */
+enum Work : uint8_t {
+    COUNTED = 0x01,
+    REPORTED = 0x02,
+    CONNECTED = 0x04
+};
+
+/**
+ * @brief Validate the retained block and open the boot's record; call early in setup()
+ */
+void setup();
+
+/**
+ * @brief A nap has ended; open its record
+ *
+ * @param reason What woke the device
+ * @param asleepSec Time asleep
+ * @param edges Sensor edges counted in hardware during the nap
+ */
+void noteWake(Reason reason, uint32_t asleepSec, uint32_t edges);
+
+/**
+ * @brief A nap is about to start; close the open record into the ring and summary
+ */
+void noteSleep();
+
+/**
+ * @brief Format the day's summary and recent records for the daily "wakes"
+ *        event, and clear the summary
+ *
+ * @return Length written, or 0 if it did not fit (the summary is kept)
+ */
+size_t formatReport(char *buffer, size_t bufferSize);
+
+} // namespace WakeLedger
+
+#endif /* __WAKELEDGER_H */
@@ -57,6 +57,38 @@ const pin_t disableModule = MOSI;
 const pin_t ledPower      = MISO;
 #endif
 
+// Analog sensor output (soil moisture / distance) on the carrier A0 header pin.
+const pin_t analogSensePin = A0;
+
+// Second channel of a dual PIR / beam sensor, on the carrier A2 header pin.
+const pin_t intPinB = A2;
+
+// Supply of a range finder used to confirm PIR events, on the A3 header pin.
+const pin_t rangePower = A3;
+
+// LoRa gateway radio. SCK/MOSI/MISO are the SPI pins above; chip select is
+// the header's SPI SS pin (S3 on P2, A5 on Boron).
+#if PLATFORM_ID == PLATFORM_P2
+const pin_t loraCsPin     = S3;
+#else
+const pin_t loraCsPin     = A5;
+#endif
+const pin_t loraResetPin  = D2;
+const pin_t loraDio0Pin   = D3;
+
+// Event archive SD card, on the same SPI pins; its own chip select on A1.
+const pin_t archiveCsPin  = A1;
+
+// Phase markers for a power analyzer: free unless the board is a LoRa gateway.
+#if PLATFORM_ID == PLATFORM_P2
+const pin_t phaseMarkerPins[3] = {D2, D3, S3};
+#else
+const pin_t phaseMarkerPins[3] = {D2, D3, A5};
+#endif
+
+// Bench loopback pulses, jumpered to intPin; A2 is intPinB on a DUAL_PIR board.
+const pin_t loopbackOutPin = A2;
+
 bool initializePinModes() {
     Log.info("Initalizing the pinModes");
     // Define as inputs or outputs
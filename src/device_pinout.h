@@ -15,17 +15,17 @@
  * 3.3V  -
  * !MODE -
  * GND   -
- * D19 - A0 -
- * D18 - A1 -
- * D17 - A2 -
- * D16 - A3 -
+ * D19 - A0 -               analogSensePin (analog sensor output: soil moisture / distance)
+ * D18 - A1 -               archiveCsPin (event archive SD card chip select)
+ * D17 - A2 -               intPinB (second channel of a DUAL_PIR sensor)
+ * D16 - A3 -               rangePower (supply of a fusion range finder, FUSION_RANGE_CM)
  * D15 - A4 -               TMP32 temp sensor on carrier
- * D14 - A5 / SPI SS -
- * D13 - S2 - SCK  - SPI Clock -  intPin (PIR interrupt)
- * D12 - S0 - MOSI - SPI MOSI -   disableModule (enable line to sensor)
- * D11 - S1 - MISO - SPI MISO -   ledPower (indicator LED power)
- * D10 - UART RX -
- * D9  - UART TX -
+ * D14 - A5 / SPI SS -      loraCsPin (LoRa gateway radio chip select) / phase marker bit 2
+ * D13 - S2 - SCK  - SPI Clock -  intPin (PIR interrupt) / LoRa radio SCK on a gateway
+ * D12 - S0 - MOSI - SPI MOSI -   disableModule (enable line to sensor) / LoRa radio MOSI
+ * D11 - S1 - MISO - SPI MISO -   ledPower (indicator LED power) / LoRa radio MISO
+ * D10 - UART RX -          Serial1 from the OpenMV camera (OPENMV_OCCUPANCY)
+ * D9  - UART TX -          Serial1 to the OpenMV camera
  *
  * Right Side (12 pins)
  * Li+
@@ -36,8 +36,8 @@
  * D6  -                  deep-sleep enable (to EN)
  * D5  -                  watchdog DONE pin
  * D4  -                  userSwitch (front-panel button)
- * D3  -
- * D2  -
+ * D3  -                  loraDio0Pin (LoRa radio DIO0, RxDone) / phase marker bit 1
+ * D2  -                  loraResetPin (LoRa radio reset) / phase marker bit 0
  * D1  - SCL - I2C Clock - FRAM / RTC / I2C bus
  * D0  - SDA - I2C Data  - FRAM / RTC / I2C bus
  */
@@ -94,6 +94,33 @@ extern const pin_t WAKEUP_PIN;        // AB1805 FOUT/nIRQ wake pin (WKP = D10 on
 extern const pin_t intPin;            // PIR interrupt pin (SPI clock line)
 extern const pin_t disableModule;     // Sensor enable line
 extern const pin_t ledPower;          // Sensor LED power
+extern const pin_t analogSensePin;    // Analog output of burst-sampled sensors (soil moisture, distance)
+extern const pin_t intPinB;           // Second PIR / beam channel of a DUAL_PIR sensor (intPin is the first)
+extern const pin_t rangePower;        // Supply enable of a range finder confirming PIR events (active HIGH)
+
+// ---------------------------------------------------------------------------
+// LoRa gateway (SensorType::LORA_GATEWAY): SX127x radio on the primary SPI
+// bus, which the PIR pins above share; a gateway board has no PIR.
+// ---------------------------------------------------------------------------
+extern const pin_t loraCsPin;         // Radio chip select (SPI SS)
+extern const pin_t loraResetPin;      // Radio reset (active LOW)
+extern const pin_t loraDio0Pin;       // Radio DIO0, rises on RxDone
+
+// ---------------------------------------------------------------------------
+// Event archive SD card (EVENT_ARCHIVE_ENABLED), also on the primary SPI bus
+// ---------------------------------------------------------------------------
+extern const pin_t archiveCsPin;      // SD card chip select
+
+// ---------------------------------------------------------------------------
+// Power-analyzer phase markers (PHASE_MARKERS), on the LoRa gateway pins
+// ---------------------------------------------------------------------------
+extern const pin_t phaseMarkerPins[3]; // Bit 0, 1, 2 of PhaseMarker::Phase
+
+// ---------------------------------------------------------------------------
+// Bench loopback pulse output (LOOPBACK_TEST_ENABLED), jumpered to intPin;
+// shares the A2 header pin with intPinB, so not on a DUAL_PIR board
+// ---------------------------------------------------------------------------
+extern const pin_t loopbackOutPin;    // Generated pulse train
 
 bool initializePinModes();
 bool initializePowerCfg();
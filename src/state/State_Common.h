@@ -13,11 +13,17 @@
 
 // Implemented in State_Idle.cpp
 void ensureSensorEnabled(const char* context);
+bool shouldFinishQueueDrain();
+bool stayAwakeForTraffic();
 
 // Implemented in State_Connect.cpp
 bool isRadioPoweredOn();
 void requestRadioPowerOff();
 void requestFullDisconnectAndRadioOff();
+void requestFastDisconnectAndRadioOff();
+void startRadioPrewarm();
+void cancelRadioPrewarm();
+bool postConnectPending();
 
 // Defined in Generalized-Core-Counter.cpp
 extern bool publishDiagnosticSafe(const char* eventName, const char* data, PublishFlags flags);
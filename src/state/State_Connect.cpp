@@ -1,12 +1,28 @@
 #include "state/State_Common.h"
 #include "Config.h"
+#include "BootProfile.h"
+#include "BrownoutGuard.h"
 #include "Cloud.h"
+#include "ConnectCache.h"
+#include "ConnectHistory.h"
+#include "FaultInject.h"
+#include "DataUsage.h"
 #include "DeviceInfoLedger.h"
 #include "MyPersistentData.h"
+#include "OtaScheduler.h"
+#include "Payload.h"
+#include "PhaseMarker.h"
+#include "PowerGovernor.h"
+#include "PowerPolicy.h"
 #include "PublishQueuePosixRK.h"
+#include "ReportSlot.h"
 #include "SensorManager.h"
+#include "SoakTest.h"
+#include "TaskScheduler.h"
+#include "UpdateWindow.h"
 #include "device_pinout.h"
 #include "SensorDefinitions.h"
+#include <math.h>
 
 // NOTE:
 // This file was split from StateHandlers.cpp as a mechanical refactor.
@@ -39,10 +55,77 @@ void requestRadioPowerOff() {
 }
 
 void requestFullDisconnectAndRadioOff() {
+  PhaseMarker::set(PhaseMarker::DISCONNECTING);
   Particle.disconnect();
   requestRadioPowerOff();
 }
 
+// millis() when REPORTING_STATE powered the radio ahead of the connect (0 = not)
+static unsigned long prewarmStartMs = 0;
+
+void startRadioPrewarm() {
+#if REPORT_RADIO_PREWARM
+  if (Particle.connected() || prewarmStartMs != 0 || !PowerPolicy::active().radioPrewarm) {
+    return;
+  }
+  Log.info("Powering the radio and registering while the report is prepared");
+  BrownoutGuard::beforeRadio();
+  ConnectCache::begin();
+#if Wiring_Cellular
+  Cellular.on();
+  Cellular.connect();
+#elif Wiring_WiFi
+  WiFi.on();
+  WiFi.connect();
+#endif
+  prewarmStartMs = millis() | 1;
+#endif
+}
+
+void cancelRadioPrewarm() {
+  if (prewarmStartMs == 0) {
+    return;
+  }
+  prewarmStartMs = 0;
+  Log.info("Not connecting after all - radio off again");
+  requestRadioPowerOff();
+}
+
+void requestFastDisconnectAndRadioOff() {
+  // Nothing is left to send: skip waiting on the cloud close and cut the radio
+  PhaseMarker::set(PhaseMarker::DISCONNECTING);
+  Particle.disconnect(CloudDisconnectOptions().graceful(false));
+  requestRadioPowerOff();
+}
+
+#if Wiring_Cellular && SIGNAL_GATE_ENABLED
+// Probe signal before a report connect only in LOW_POWER mode (CONNECTED
+// must stay online), with valid time, and until the deferral window ends.
+static bool shouldProbeSignal(bool enteredFromReporting) {
+  if (!enteredFromReporting || PowerGovernor::operatingMode() != LOW_POWER || !Time.isValid()) {
+    return false;
+  }
+  time_t deferSince = sysStatus.get_signalDeferSince();
+  if (deferSince != 0 && (Time.now() - deferSince) >= (time_t)SIGNAL_DEFER_MAX_HOURS * 3600) {
+    Log.info("Signal gate: deferring since %s - connecting regardless",
+             Time.format(deferSince, TIME_FORMAT_DEFAULT).c_str());
+    return false;
+  }
+  return true;
+}
+
+// Leave the report queued, turn the radio off and go back to sleep
+static void deferForSignal() {
+  if (sysStatus.get_signalDeferSince() == 0) {
+    sysStatus.set_signalDeferSince(Time.now());
+  }
+  Log.info("Signal gate: report deferred to a later wake (%u queued)",
+           (unsigned)PublishQueuePosix::instance().getNumEvents());
+  requestRadioPowerOff();
+  setState(SLEEPING_STATE, REASON_WEAK_SIGNAL);
+}
+#endif
+
 /**
  * @brief CONNECTING_STATE: establish cloud connection using a phased,
  *        non-blocking state machine.
@@ -53,43 +136,171 @@ void requestFullDisconnectAndRadioOff() {
  *            - CONN_PHASE_START: log signal strength and request
  *              Particle.connect().
  *            - CONN_PHASE_WAIT_CLOUD: poll Particle.connected() up to
- *              connectAttemptBudgetSec (from sysStatus / Ledger),
+ *              ConnectHistory::budgetSec() (learned from past connects,
+ *              or connectAttemptBudgetSec from sysStatus / Ledger),
  *              raising alert 31 on timeout.
- *            - CONN_PHASE_LOAD_CONFIG: load configuration from cloud
- *              ledgers and raise alert 41 on failure.
- *            - CONN_PHASE_PUBLISH_LEDGER: optionally publish
- *              device-data to the ledger (skipped when entered from
- *              REPORTING_STATE to avoid clobbering hourlyCount), log
- *              queue depth, and transition to FIRMWARE_UPDATE_STATE
- *              when updates are pending or back to IDLE_STATE.
+ *            - On connect: record the connection, start the
+ *              "connected" task (postConnectTask()) for the rest of the
+ *              post-connect work, and transition to FIRMWARE_UPDATE_STATE
+ *              when an update is pending and OtaScheduler allows it, or
+ *              back to IDLE_STATE, on the same pass. The publish queue
+ *              drains from then on while that task runs.
  *          Connection duration is tracked in sysStatus so budgets and
- *          field behaviour can be analysed from device-status data.
+ *          field behaviour can be analysed from device-status data, and
+ *          ConnectCache splits it into radio, network and cloud phases.
  */
-void handleConnectingState() {
-  static unsigned long connectionStartTimeStamp; // When this connect attempt started
-  static bool lastEnteredFromReporting = false;  // Whether we came from REPORTING_STATE
-  static bool connectRequested = false;
-  static bool postConnectDone = false;
-
-  if (state != oldState) {
-    publishStateTransition();
-    lastEnteredFromReporting = (oldState == REPORTING_STATE);
-    sysStatus.set_lastConnectionDuration(0);
+static unsigned long connectionStartTimeStamp; // When this connect attempt started
+static bool lastEnteredFromReporting = false;  // Whether we came from REPORTING_STATE
+static bool connectRequested = false;
+static bool postConnectDone = false;
+static bool probeActive = false;               // Registering network-only to check signal first
+
+// Post-connect work, one step per run of the "connected" task
+enum PostConnectStep : uint8_t {
+  POST_SIGNAL,        // Signal strength for the report and device-status
+  POST_BATTERY,       // Battery state and enclosure temperature
+  POST_CONFIG,        // Merge and apply the settings ledgers (alert 41)
+  POST_LEDGER,        // device-data ledger mark, boot profile
+  POST_DONE
+};
+static int postConnectTaskId = -1;
+static uint8_t postConnectStep = POST_DONE;
+static bool postConnectFromReporting = false;  // lastEnteredFromReporting when it started
+
+/**
+ * @brief "connected" task: the work after a cloud connect that does not
+ *        have to hold up the publish queue
+ *
+ * @details Signaled by handleConnectingState() once connected. Each run
+ *          does one step and the task stays signaled until the last, so
+ *          the queue task, which runs first in every pass, sends while
+ *          the signal is read, the battery measured and the settings
+ *          ledgers applied. IDLE_STATE does not sleep until it is done
+ *          (postConnectPending()).
+ */
+static bool postConnectTask() {
+  switch (postConnectStep) {
+    case POST_SIGNAL:
+      measure.getSignalStrength();
+      break;
+
+    case POST_BATTERY:
+      measure.batteryState();
+      Log.info("Enclosure temperature at connect: %s C", Payload::Scaled(current.get_internalTempCenti(), 2).c_str());
+      break;
+
+    case POST_CONFIG: {
+      if (PowerGovernor::storeOnly()) {
+        Log.info("Store-only power tier - settings ledgers not read");
+        break;
+      }
+      bool configOk = Cloud::instance().loadConfigurationFromCloud();
+      if (!configOk) {
+        Log.warn("Configuration apply failed (will raise alert 41)");
+        current.raiseAlert(41);
+      } else if (current.isAlertActive(41)) {
+        Log.info("Configuration apply succeeded - clearing stale alert 41");
+        current.clearAlert(41);
+      }
+      break;
+    }
+
+    case POST_LEDGER:
+      // Written with device-status in one pass before sleep (flushLedgers()),
+      // and not on every connect: a report marks it anyway
+      if (!postConnectFromReporting && sysStatus.get_dataDelivery() != DELIVER_WEBHOOK) {
+        time_t lastWrite = sysStatus.get_lastConnectDataLedger();
+        time_t now = Time.now();
+        if (!Time.isValid() || lastWrite == 0 || now < lastWrite ||
+            (now - lastWrite) >= DATA_LEDGER_CONNECT_MIN * 60L) {
+          Cloud::instance().markLedgerDirty(Cloud::LEDGER_DATA);
+          sysStatus.set_lastConnectDataLedger(Time.isValid() ? now : 0);
+        }
+      }
+
+      // Setup timing for this boot, once per boot
+      BootProfile::instance().publish();
+      break;
+
+    default:
+      return true;
+  }
+  postConnectStep++;
+  return postConnectStep >= POST_DONE;
+}
+
+void setupConnectingState() {
+  postConnectTaskId = TaskScheduler::instance().addSignaled("connected", postConnectTask, 50000, 1000);
+}
+
+bool postConnectPending() {
+  return postConnectStep < POST_DONE;
+}
+
+void enterConnectingState(State from) {
+  lastEnteredFromReporting = (from == REPORTING_STATE);
+  sysStatus.set_lastConnectionDuration(0);
+  if (lastEnteredFromReporting) {
+    ReportSlot::noteConnectStart();
+  }
+  if (lastEnteredFromReporting && prewarmStartMs != 0) {
+    connectionStartTimeStamp = prewarmStartMs;   // ConnectCache began with the power-up
+  } else {
+    if (!Particle.connected()) {
+      BrownoutGuard::beforeRadio();   // Save counters ahead of the modem's current draw
+#if SOAK_TEST_ENABLED
+      SoakTest::noteConnectAttempt();
+#endif
+    }
     connectionStartTimeStamp = millis();
-    connectRequested = false;
-    postConnectDone = false;
+    ConnectCache::begin();
+  }
+  prewarmStartMs = 0;
+  connectRequested = false;
+  postConnectDone = false;
+  probeActive = false;
+#if Wiring_Cellular && SIGNAL_GATE_ENABLED
+  if (!Particle.connected() && shouldProbeSignal(lastEnteredFromReporting)) {
+    Log.info("Signal gate: registering on the network before connecting");
+    Cellular.on();
+    Cellular.connect();
+    probeActive = true;
   }
+#endif
+}
+
+void handleConnectingState() {
 
   unsigned long elapsedMs = millis() - connectionStartTimeStamp;
   sysStatus.set_lastConnectionDuration(int(elapsedMs / 1000));
+  ConnectCache::poll();
+
+  // Budget learned from this site's connect history (CONNECT_BUDGET_ADAPTIVE),
+  // else the ledger-configured budget or the compiled maxConnectAttemptMs.
+  unsigned long budgetMs = ConnectHistory::budgetSec() * 1000UL;
 
-  // Use a ledger-configured budget when available; otherwise fall back
-  // to the compiled default maxConnectAttemptMs constant.
-  unsigned long budgetMs = maxConnectAttemptMs;
-  uint16_t budgetSec = sysStatus.get_connectAttemptBudgetSec();
-  if (budgetSec >= 30 && budgetSec <= 900) {
-    budgetMs = (unsigned long)budgetSec * 1000UL;
+#if Wiring_Cellular && SIGNAL_GATE_ENABLED
+  if (probeActive) {
+    if (!Cellular.ready()) {
+      if (elapsedMs < (unsigned long)SIGNAL_PROBE_TIMEOUT_SEC * 1000UL) {
+        return; // Still registering
+      }
+      Log.info("Signal gate: not registered after %lu ms", (unsigned long)elapsedMs);
+      probeActive = false;
+      deferForSignal();
+      return;
+    }
+    probeActive = false;
+    CellularSignal probe = Cellular.RSSI();
+    if (probe.getStrength() < SIGNAL_GATE_MIN_STRENGTH || probe.getQuality() < SIGNAL_GATE_MIN_QUALITY) {
+      Log.info("Signal gate: S=%2d%% Q=%2d%% below %d%%/%d%%",
+               (int)lroundf(probe.getStrength()), (int)lroundf(probe.getQuality()),
+               SIGNAL_GATE_MIN_STRENGTH, SIGNAL_GATE_MIN_QUALITY);
+      deferForSignal();
+      return;
+    }
   }
+#endif
 
   if (!connectRequested) {
     // Log signal strength at start of connection attempt for field
@@ -100,8 +311,8 @@ void handleConnectingState() {
     CellularSignal sig = Cellular.RSSI();
     float strengthPct = sig.getStrength();
     float qualityPct = sig.getQuality();
-    Log.info("Starting connection attempt - Signal: S=%2.0f%% Q=%2.0f%%",
-             (double)strengthPct, (double)qualityPct);
+    Log.info("Starting connection attempt - Signal: S=%2d%% Q=%2d%%",
+             (int)lroundf(strengthPct), (int)lroundf(qualityPct));
 #endif
     Log.info("Requesting Particle cloud connection");
     Particle.connect();
@@ -110,35 +321,29 @@ void handleConnectingState() {
 
   if (Particle.connected()) {
     if (!postConnectDone) {
+      PhaseMarker::set(PhaseMarker::CONNECTED);
       connectedStartMs = millis();
       sysStatus.set_lastConnection(Time.now());
-      if (current.get_alertCode() == 31) {
+      ConnectHistory::recordSuccess(elapsedMs / 1000);
+      PowerPolicy::noteConnect(elapsedMs / 1000);
+      DataUsage::note(DataUsage::SESSION, DATA_USAGE_SESSION_BYTES, 0);
+      ConnectCache::connected();
+      sysStatus.set_signalDeferSince(0);
+      sysStatus.set_coldDeferSince(0);
+      if (current.isAlertActive(31)) {
         Log.info("Connection successful - clearing alert 31");
-        current.set_alertCode(0);
+        current.clearAlert(31);
       }
-      measure.getSignalStrength();
-      measure.batteryState();
-      Log.info("Enclosure temperature at connect: %4.2f C", (double)current.get_internalTempC());
       if (sysStatus.get_verboseMode()) {
         char data[64];
         snprintf(data, sizeof(data), "Connected in %i secs", sysStatus.get_lastConnectionDuration());
         publishDiagnosticSafe("Cellular", data, PRIVATE);
       }
 
-      bool configOk = Cloud::instance().loadConfigurationFromCloud();
-      if (!configOk) {
-        Log.warn("Configuration apply failed (will raise alert 41)");
-        current.raiseAlert(41);
-      } else if (current.get_alertCode() == 41) {
-        Log.info("Configuration apply succeeded - clearing stale alert 41");
-        current.set_alertCode(0);
-      }
-
-      if (!lastEnteredFromReporting) {
-        if (!Cloud::instance().publishDataToLedger()) {
-          current.raiseAlert(42); // data ledger publish failure
-        }
-      }
+      // The rest runs beside the queue drain, starting this pass
+      postConnectStep = POST_SIGNAL;
+      postConnectFromReporting = lastEnteredFromReporting;
+      TaskScheduler::instance().signal(postConnectTaskId);
 
       size_t pending = PublishQueuePosix::instance().getNumEvents();
       Log.info("Publish queue depth after connect: %u event(s)", (unsigned)pending);
@@ -151,46 +356,65 @@ void handleConnectingState() {
       postConnectDone = true;
     }
 
-    if (System.updatesPending()) {
+    if (OtaScheduler::updateNow()) {
       Log.info("Updates pending after connect - transitioning to FIRMWARE_UPDATE_STATE");
-      state = FIRMWARE_UPDATE_STATE;
+      setState(FIRMWARE_UPDATE_STATE, REASON_UPDATE_PENDING);
     } else {
-      state = IDLE_STATE;
+      setState(IDLE_STATE, REASON_CONNECTED);
     }
     return;
   }
 
+#if SOAK_TEST_ENABLED
+  if (SoakTest::forceConnectFailure()) {
+    budgetMs = 0;
+  }
+#endif
+#if FAULT_INJECT_ENABLED
+  if (FaultInject::connectTimeout()) {
+    budgetMs = 0;
+  }
+#endif
   if (elapsedMs > budgetMs) {
     Log.warn("Connection attempt exceeded budget (%lu ms > %lu ms) - raising alert 31",
              (unsigned long)elapsedMs, (unsigned long)budgetMs);
     current.raiseAlert(31);
+    ConnectHistory::recordFailure();
+    PowerPolicy::noteConnectFailure();
     requestFullDisconnectAndRadioOff();
-    state = SLEEPING_STATE;
+    setState(SLEEPING_STATE, REASON_CONNECT_TIMEOUT);
   }
 }
 
-// FIRMWARE_UPDATE_STATE: Stay connected for firmware/config updates
-void handleFirmwareUpdateState() {
-  // Track how long we've been in update mode so we can mirror the
-  // Particle Wake-Publish-Sleep example behaviour: bound the time
-  // spent waiting for an update before going back to sleep.
-  static unsigned long firmwareUpdateStartMs = 0;
+// Track how long we've been in update mode so we can mirror the
+// Particle Wake-Publish-Sleep example behaviour: bound the time
+// spent waiting for an update before going back to sleep.
+static unsigned long firmwareUpdateStartMs = 0;
+static bool configLoadedInUpdateMode = false;
 
-  if (state != oldState) {
-    publishStateTransition();
-    Log.info("Entering FIRMWARE_UPDATE_STATE - keeping device connected for updates");
+void enterFirmwareUpdateState(State from) {
+  Log.info("Entering FIRMWARE_UPDATE_STATE - keeping device connected for updates");
 
-    firmwareUpdateStartMs = millis();
+  firmwareUpdateStartMs = millis();
+  configLoadedInUpdateMode = false;
+  UpdateWindow::begin(UpdateWindow::STATE);
 
-    // Ensure cloud connection is requested
-    if (!Particle.connected()) {
-      Particle.connect();
-    }
+  // Ensure cloud connection is requested
+  if (!Particle.connected()) {
+    Particle.connect();
   }
+}
+
+// However the state is left, updates go back to the OtaScheduler window
+void exitFirmwareUpdateState(State to) {
+  OtaScheduler::endUpdate();
+  UpdateWindow::end(UpdateWindow::STATE);
+}
 
+// FIRMWARE_UPDATE_STATE: Stay connected for firmware/config updates
+void handleFirmwareUpdateState() {
   // Once connected, ensure configuration is loaded at least once
   if (Particle.connected()) {
-    static bool configLoadedInUpdateMode = false;
     if (!configLoadedInUpdateMode) {
       Log.info("Connected in FIRMWARE_UPDATE_STATE - loading configuration from cloud");
       Cloud::instance().loadConfigurationFromCloud();
@@ -200,8 +424,7 @@ void handleFirmwareUpdateState() {
     // If no updates are pending anymore and no OTA in progress, exit update mode
     if (!System.updatesPending()) {
       Log.info("No updates pending - leaving FIRMWARE_UPDATE_STATE to IDLE_STATE");
-      configLoadedInUpdateMode = false;
-      state = IDLE_STATE;
+      setState(IDLE_STATE, REASON_UPDATE_DONE);
       return;
     }
   }
@@ -209,7 +432,7 @@ void handleFirmwareUpdateState() {
   // Optional escape hatch: user button can also exit update mode
   if (!digitalRead(BUTTON_PIN)) { // Active-low user button
     Log.info("User button pressed - exiting FIRMWARE_UPDATE_STATE to IDLE_STATE");
-    state = IDLE_STATE;
+    setState(IDLE_STATE, REASON_UPDATE_CANCELLED);
     return;
   }
 
@@ -220,6 +443,6 @@ void handleFirmwareUpdateState() {
   if (firmwareUpdateStartMs != 0 && (millis() - firmwareUpdateStartMs) > firmwareUpdateMaxMs) {
     Log.info("Firmware update timed out after %lu ms in FIRMWARE_UPDATE_STATE - transitioning to SLEEPING_STATE",
              (unsigned long)(millis() - firmwareUpdateStartMs));
-    state = SLEEPING_STATE;
+    setState(SLEEPING_STATE, REASON_UPDATE_TIMEOUT);
   }
 }
@@ -2,9 +2,12 @@
 #include "Config.h"
 #include "Cloud.h"
 #include "LocalTimeRK.h"
+#include "MonoClock.h"
 #include "MyPersistentData.h"
+#include "PowerGovernor.h"
 #include "PublishQueuePosixRK.h"
 #include "SensorManager.h"
+#include "TraceLog.h"
 #include "device_pinout.h"
 #include "SensorDefinitions.h"
 #include "AB1805_RK.h"
@@ -13,7 +16,28 @@
 // This file was split from StateHandlers.cpp as a mechanical refactor.
 // No behavioral changes were made.
 
-// Decide what corrective action to take for the current alert.
+// Subsystem a warm recovery restarts for an alert
+enum WarmTarget {
+  WARM_NONE,      // Nothing short of a reset helps (out of memory, sleep failures)
+  WARM_RADIO,     // Modem off and on, and a new cloud session; the publish queue resumes on it
+  WARM_SENSOR,    // Power the sensor down and initialize it from config again
+};
+
+static WarmTarget warmTarget(int8_t alert) {
+  switch (alert) {
+  case 15: // modem or disconnect failure
+  case 31: // failed to connect to cloud
+  case 40: // repeated webhook failures
+  case 44: // prolonged offline
+    return WARM_RADIO;
+  case 24: // sensor fault
+    return WARM_SENSOR;
+  default:
+    return WARM_NONE;
+  }
+}
+
+// Decide which reset, if any, the current alert calls for.
 //
 // Uses the current alert code and resetCount to choose between:
 //  - 0: No action (return to IDLE and try again later)
@@ -25,7 +49,7 @@
 //  - Modem/disconnect failure (15) and connect timeout (31):
 //    a couple of soft resets, then a hard power-cycle, then stop.
 //  - Sleep failures (16): soft reset, then hard power-cycle, then stop.
-static int resolveErrorAction() {
+static int resolveResetAction() {
   int8_t alert   = current.get_alertCode();
   uint8_t resets = sysStatus.get_resetCount();
 
@@ -96,43 +120,148 @@ static int resolveErrorAction() {
   }
 }
 
-// ERROR_STATE: Error supervisor: decide recovery action
-void handleErrorState() {
-  static unsigned long resetTimer = 0;
-  static int resolution = 0;
-
-  if (state != oldState) {
-    publishStateTransition();
-
-    // Safety: regardless of recovery choice, do not leave radio/modem powered
-    // while we sit in ERROR_STATE waiting for reset.
-    requestFullDisconnectAndRadioOff();
-
-    // In LOW_POWER or DISCONNECTED modes, avoid reset loops for connectivity/sleep alerts.
-    if (sysStatus.get_operatingMode() != CONNECTED) {
-      int8_t alert = current.get_alertCode();
-      if (alert == 15 || alert == 16 || alert == 31) {
-        Log.warn("Low-power mode: clearing alert %d to avoid reset loop", alert);
-        current.set_alertCode(0);
-        current.set_lastAlertTime(0);
-        resolution = 0;
-      } else {
-        resolution = resolveErrorAction();
-      }
+static unsigned long resetTimer = 0;
+static int resolution = 0;
+static uint8_t warmAttempts = 0;      // Warm recoveries this boot since one last worked
+
+// Decide what corrective action to take for the current alert:
+//  - 1: Warm recovery: restart only the subsystem behind the alert
+//  - otherwise resolveResetAction()
+//
+// Where the reset ladder would reset and the alert has a subsystem to
+// restart, up to WARM_RECOVERY_ATTEMPTS warm recoveries come first: no
+// cold boot, no re-init of persistence, the queue, LocalTime or the
+// sensor, and no RAM events lost. A sensor fault only ever gets warm
+// recoveries.
+static int resolveErrorAction() {
+  int8_t alert = current.get_alertCode();
+  int action = resolveResetAction();
+  WarmTarget target = warmTarget(alert);
+
+  if (target != WARM_NONE && warmAttempts < WARM_RECOVERY_ATTEMPTS &&
+      (action >= 2 || target == WARM_SENSOR)) {
+    return 1;
+  }
+  return action;
+}
+
+// Judge the last recovery now that ERROR_STATE is entered again: the same
+// alert within RECOVERY_EFFECTIVE_SEC means it did not work. One that is
+// never followed by the same alert counts as having worked.
+static void judgeLastRecovery(int8_t alert) {
+  uint8_t level = sysStatus.get_lastRecoveryLevel();
+  if (level == 0) {
+    return;
+  }
+  time_t started = sysStatus.get_lastRecoveryTime();
+  bool repeated = alert == (int8_t)sysStatus.get_lastRecoveryAlert() &&
+                  (started == 0 || !Time.isValid() || Time.now() - started < RECOVERY_EFFECTIVE_SEC);
+  auto batch = sysStatus.updateBatch();
+  if (repeated) {
+    sysStatus.set_recoveryRepeats(level - 1, sysStatus.get_recoveryRepeats(level - 1) + 1);
+    Log.warn("Recovery level %u did not clear alert %d", level, alert);
+  } else {
+    warmAttempts = 0;
+  }
+  sysStatus.set_lastRecoveryLevel(0);
+}
+
+// Start recovery @p level (1-3) and record it; sysStatus is saved well
+// before a reset at the end of the resetWait dwell
+static void beginRecovery(int level) {
+  resolution = level;
+  resetTimer = millis();
+  if (level < 1 || level > 3) {
+    return;
+  }
+  if (level == 1) {
+    warmAttempts++;
+  }
+  auto batch = sysStatus.updateBatch();
+  sysStatus.set_recoveryAttempts(level - 1, sysStatus.get_recoveryAttempts(level - 1) + 1);
+  sysStatus.set_lastRecoveryLevel((uint8_t)level);
+  sysStatus.set_lastRecoveryAlert((uint8_t)current.get_alertCode());
+  sysStatus.set_lastRecoveryTime(Time.isValid() ? Time.now() : 0);
+}
+
+// The warm recovery worked: the alert is cleared here, as a reset would
+// have started afresh
+static void finishWarmRecovery() {
+  Log.info("Warm recovery cleared alert %d after %lu ms", current.get_alertCode(),
+           (unsigned long)(millis() - resetTimer));
+  current.clearAlert(current.get_alertCode());
+  setState(IDLE_STATE, REASON_ERROR_CLEARED);
+}
+
+// ERROR_STATE entry: power the radio down and choose the recovery action
+void enterErrorState(State from) {
+  // Safety: regardless of recovery choice, do not leave radio/modem powered
+  // while we sit in ERROR_STATE waiting for reset. This is also the first
+  // half of a warm radio recovery.
+  requestFullDisconnectAndRadioOff();
+
+  judgeLastRecovery(current.get_alertCode());
+
+  // In LOW_POWER or DISCONNECTED modes, avoid reset loops for connectivity/sleep alerts.
+  int action;
+  if (PowerGovernor::operatingMode() != CONNECTED) {
+    int8_t alert = current.get_alertCode();
+    if (alert == 15 || alert == 16 || alert == 31) {
+      Log.warn("Low-power mode: clearing alert %d to avoid reset loop", alert);
+      current.clearAlert(alert);
+      action = 0;
     } else {
-      resolution = resolveErrorAction();
+      action = resolveErrorAction();
     }
-    Log.info("Entering ERROR_STATE with alert=%d, resetCount=%u, resolution=%d",
-             current.get_alertCode(), sysStatus.get_resetCount(), resolution);
-    resetTimer = millis();
+  } else {
+    action = resolveErrorAction();
   }
+  TraceLog::record(TraceLog::ERROR_ACTION, action, current.get_alertCode(), sysStatus.get_resetCount());
+  Log.info("Entering ERROR_STATE with alert=%d, resetCount=%u, resolution=%d",
+           current.get_alertCode(), sysStatus.get_resetCount(), action);
+  beginRecovery(action);
+}
 
+// ERROR_STATE: Error supervisor: carry out the recovery action
+void handleErrorState() {
   switch (resolution) {
   case 0:
     // No automatic recovery; return to IDLE so the normal state machine
     // can continue and we rely on future hourly reports to surface the
     // issue.
-    state = IDLE_STATE;
+    setState(IDLE_STATE, REASON_ERROR_CLEARED);
+    break;
+
+  case 1:
+    // Warm recovery: restart only the faulty subsystem
+    if (warmTarget(current.get_alertCode()) == WARM_SENSOR) {
+      Log.info("Warm recovery: re-initializing the sensor (alert=%d)", current.get_alertCode());
+      SensorManager::instance().onEnterSleep();
+      SensorManager::instance().initializeFromConfig();
+      if (SensorManager::instance().isSensorReady()) {
+        finishWarmRecovery();     // SensorManager clears alert 24 itself once the sensor is healthy
+      } else {
+        Log.warn("Warm recovery: sensor did not come back");
+        sysStatus.set_recoveryRepeats(0, sysStatus.get_recoveryRepeats(0) + 1);
+        setState(IDLE_STATE, REASON_ERROR_CLEARED);
+      }
+      break;
+    }
+
+    // Radio: entry asked for the cloud session and modem to go down. Once
+    // they have, IDLE/CONNECTING bring up a fresh modem and session when
+    // the operating mode calls for one. A modem that will not even power
+    // off takes the reset ladder after all.
+    if (!Particle.connected() && !isRadioPoweredOn()) {
+      finishWarmRecovery();
+    } else if (millis() - resetTimer > resetWait) {
+      int action = resolveResetAction();
+      Log.warn("Warm recovery: radio still on after %lu ms - escalating to resolution=%d",
+               (unsigned long)resetWait, action);
+      TraceLog::record(TraceLog::ERROR_ACTION, action, current.get_alertCode(), sysStatus.get_resetCount());
+      sysStatus.set_recoveryRepeats(0, sysStatus.get_recoveryRepeats(0) + 1);
+      beginRecovery(action);
+    }
     break;
 
   case 2:
@@ -140,6 +269,8 @@ void handleErrorState() {
     // flush.
     if (millis() - resetTimer > resetWait) {
       Log.info("Executing soft reset from ERROR_STATE");
+      MonoClock::checkpoint();
+      sysStatus.flush(true);
       System.reset();
     }
     break;
@@ -156,7 +287,7 @@ void handleErrorState() {
 
   default:
     // Should not happen, but don't get stuck here.
-    state = IDLE_STATE;
+    setState(IDLE_STATE, REASON_UNSPECIFIED);
     break;
   }
 }
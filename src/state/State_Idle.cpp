@@ -1,10 +1,21 @@
 #include "state/State_Common.h"
 #include "Config.h"
+#include "BleReadout.h"
+#include "BrownoutGuard.h"
 #include "Cloud.h"
+#include "ConfigSnapshot.h"
+#include "ConnectHistory.h"
 #include "LocalTimeRK.h"
+#include "MicroBench.h"
 #include "MyPersistentData.h"
+#include "OtaScheduler.h"
+#include "Payload.h"
+#include "PowerGovernor.h"
+#include "ReportTracker.h"
+#include "ScheduledSampler.h"
 #include "PublishQueuePosixRK.h"
 #include "SensorManager.h"
+#include "SleepPlanner.h"
 #include "device_pinout.h"
 #include "SensorDefinitions.h"
 
@@ -25,12 +36,39 @@ void ensureSensorEnabled(const char* context) {
   Log.info("%s - sensorReady=%s", context, SensorManager::instance().isSensorReady() ? "true" : "false");
 }
 
-// IDLE_STATE: Awake, monitoring sensor and deciding what to do next
-void handleIdleState() {
-  if (state != oldState) {
-    publishStateTransition();
+// Whether to stay connected until the publish queue has drained. False when
+// the drain estimate will not fit in what is left of connectAttemptBudgetSec
+// and the battery is below QUEUE_DRAIN_PARTIAL_SOC: the rest is sent on the
+// next wake. Always true in CONNECTED mode or until the queue has measured
+// a few events on this connection.
+bool shouldFinishQueueDrain() {
+  if (!Particle.connected() || connectedStartMs == 0 || PowerGovernor::operatingMode() == CONNECTED) {
+    return true;
   }
 
+  PublishQueuePosix &queue = PublishQueuePosix::instance();
+  if (queue.getDrainSamples() < 3) {
+    return true;
+  }
+
+  unsigned long budgetMs = (unsigned long)ConfigSnapshot::read().connectAttemptBudgetSec * 1000UL;
+  unsigned long connectedMs = millis() - connectedStartMs;
+  unsigned long remainingMs = (connectedMs < budgetMs) ? (budgetMs - connectedMs) : 0;
+  if (queue.getEstimatedDrainMs() <= remainingMs) {
+    return true;
+  }
+  return current.get_socTenths() >= QUEUE_DRAIN_PARTIAL_SOC * 10;
+}
+
+// Whether a LOW_POWER or DISCONNECTED device should skip its nap because
+// events are arriving faster than napping between them pays for
+// (SleepPlanner::stayAwake()). Only while the sensor is armed.
+bool stayAwakeForTraffic() {
+  return isWithinOpenHours() && ConfigSnapshot::read().countingMode != SCHEDULED && SleepPlanner::stayAwake();
+}
+
+// IDLE_STATE: Awake, monitoring sensor and deciding what to do next
+void handleIdleState() {
   // If configuration changes (for example, device-settings ledger updates)
   // move the park from CLOSED->OPEN while the device is already awake,
   // ensure the sensor stack is enabled. Previously this only happened on
@@ -51,36 +89,53 @@ void handleIdleState() {
   // In CONNECTED operating mode, the device stays awake during park open hours.
   // When the park is closed, it should disconnect, power down the sensor, and
   // deep-sleep until the next opening time.
-  if (Time.isValid() && sysStatus.get_operatingMode() == CONNECTED) {
-    if (!isWithinOpenHours()) {
+  if (Time.isValid() && PowerGovernor::operatingMode() == CONNECTED) {
+    if (!isWithinOpenHours() && !BleReadout::active()) {
       Log.info("CONNECTED mode: park CLOSED - transitioning to SLEEPING_STATE for overnight sleep");
-      state = SLEEPING_STATE;
+      setState(SLEEPING_STATE, REASON_PARK_CLOSED);
       return;
     }
     // Park is open: remain awake in CONNECTED mode.
 
   }
 
-  // ********** Scheduled Mode Sampling **********
-  // SCHEDULED mode uses time-based sampling (non-interrupt).
-  // Interrupt-driven modes (COUNTING/OCCUPANCY) are handled centrally in main loop().
-  if (sysStatus.get_countingMode() == SCHEDULED) {
-    if (Time.isValid()) {
-      static time_t lastScheduledSample = 0;
-      uint16_t intervalSec = sysStatus.get_reportingInterval();
-      if (intervalSec == 0) {
-        intervalSec = 3600; // Fallback to 1 hour
-      }
+  // ********** Flap Damping **********
+  // The cloud keeps dropping: stop Device OS reconnecting and make no
+  // connect of our own until the next scheduled report (CONNECT_FLAP_LIMIT)
+  if (ConnectHistory::takeFlapDamping()) {
+    Log.warn("Cloud dropped %d times since the last report - radio off until the next report", CONNECT_FLAP_LIMIT);
+    requestFullDisconnectAndRadioOff();
+    if (PowerGovernor::operatingMode() != CONNECTED) {
+      setState(SLEEPING_STATE, REASON_FLAP_DAMPED);
+      return;
+    }
+  }
 
-      time_t now = Time.now();
-      if (lastScheduledSample == 0 || (now - lastScheduledSample) >= intervalSec) {
-        measure.batteryState();
-        Log.info("Scheduled trigger sample - battery SoC: %4.2f%%", (double)current.get_stateOfCharge());
-        lastScheduledSample = now;
-      }
+  // ********** Brownout Hold **********
+  // The battery is failing: counters are saved, and the radio stays off so
+  // a transmit burst cannot reset the device (BROWNOUT_GUARD_ENABLED)
+  if (BrownoutGuard::takeRadioOff()) {
+    Log.warn("Battery failing - radio off, reports stay queued");
+    requestFullDisconnectAndRadioOff();
+    if (PowerGovernor::operatingMode() != CONNECTED) {
+      setState(SLEEPING_STATE, REASON_BROWNOUT_HOLD);
+      return;
     }
   }
 
+  // ********** Scheduled Mode Sampling **********
+  // SCHEDULED mode reads every sensor once per pollingRate boundary.
+  // Interrupt-driven modes (COUNTING/OCCUPANCY) are handled centrally in main loop().
+  // Asleep, the sleep path wakes at each boundary and samples itself.
+  ScheduledSampler::sampleIfDue();
+  // In those modes a polled aux sensor's readings are taken here instead
+  ScheduledSampler::recordPolled();
+
+#if FIELD_BENCH_ENABLED
+  // A field benchmark pass asked for with the `bench` function
+  MicroBench::runIfRequested();
+#endif
+
   // ********** First-connection queue drain visibility **********
   // After the first successful cloud connection, log once when the
   // publish queue has fully drained so we can confirm that any
@@ -98,7 +153,7 @@ void handleIdleState() {
   // Use the configured reportingIntervalSec to determine when to
   // generate a periodic report, regardless of trigger mode.
   if (Time.isValid() && isWithinOpenHours()) {
-    uint16_t intervalSec = sysStatus.get_reportingInterval();
+    uint16_t intervalSec = PowerGovernor::reportingIntervalSec();
     if (intervalSec == 0) {
       intervalSec = 3600; // Fallback to 1 hour
     }
@@ -112,18 +167,26 @@ void handleIdleState() {
       } else {
         Log.info("IDLE: Scheduled report interval reached - transitioning to REPORTING_STATE");
       }
-      state = REPORTING_STATE;
+      setState(REPORTING_STATE, REASON_SCHEDULED_REPORT);
       return;
     }
   }
 
   // ********** Power Management **********
   // In LOW_POWER (1) or DISCONNECTED (2) modes, manage connection lifecycle.
-  if (sysStatus.get_operatingMode() != CONNECTED) {
+  if (PowerGovernor::operatingMode() != CONNECTED) {
+    // Charging at a high SoC with a backlog queued: send it now
+    if (PowerGovernor::surplusDrainDue()) {
+      Log.info("IDLE: %u queued events and surplus power - transitioning to CONNECTING_STATE",
+               (unsigned)PublishQueuePosix::instance().getNumEvents());
+      setState(CONNECTING_STATE, REASON_SURPLUS_DRAIN);
+      return;
+    }
+
     // In LOW_POWER or DISCONNECTED modes, enforce maximum connected time.
     // Use connectAttemptBudgetSec as the max connected duration.
     if (Particle.connected() && connectedStartMs != 0) {
-      uint16_t budgetSec = sysStatus.get_connectAttemptBudgetSec();
+      uint16_t budgetSec = ConfigSnapshot::read().connectAttemptBudgetSec;
       if (budgetSec >= 30 && budgetSec <= 900) {
         unsigned long connectedMs = millis() - connectedStartMs;
         unsigned long budgetMs = (unsigned long)budgetSec * 1000UL;
@@ -131,18 +194,19 @@ void handleIdleState() {
           Log.info("Connection timeout (%lu ms > %lu ms) - returning to sleep",
                    (unsigned long)connectedMs, (unsigned long)budgetMs);
           connectedStartMs = 0;
-          state = SLEEPING_STATE;
+          setState(SLEEPING_STATE, REASON_CONNECT_BUDGET);
           return;
         }
       }
     }
 
     // In CONNECTED mode during open hours, never auto-sleep.
-    if (Time.isValid() && sysStatus.get_operatingMode() == CONNECTED && isWithinOpenHours()) {
+    if (Time.isValid() && PowerGovernor::operatingMode() == CONNECTED && isWithinOpenHours()) {
       return;
     }
 
-    bool updatesPending = System.updatesPending();
+    // An update OtaScheduler is deferring does not keep the device awake
+    bool updatesPending = System.updatesPending() && OtaScheduler::updateAllowed();
 
     // In low-power mode, once all work for this connection cycle is
     // complete (no updates pending), we can safely enter SLEEPING_STATE
@@ -151,8 +215,13 @@ void handleIdleState() {
     // offline, it's expected to have a non-zero queue and we still want
     // to sleep, flushing the queue on the next connection.
     bool canSleepGate = true;
+    bool drainDeferred = false;
     if (Particle.connected()) {
       canSleepGate = PublishQueuePosix::instance().getCanSleep();
+      if (!canSleepGate && !updatesPending && !shouldFinishQueueDrain()) {
+        canSleepGate = true;
+        drainDeferred = true;
+      }
     }
 
     if (!updatesPending && canSleepGate) {
@@ -160,8 +229,30 @@ void handleIdleState() {
       // active from a recent count, defer transitioning into the
       // SLEEPING_STATE. This avoids rapid Idle<->Sleeping ping-pong
       // and the associated extra logging while still honouring the
-      // low-power policy once the indication has finished.
-      if (sensorDetect || countSignalTimer.isActive()) {
+      // low-power policy once the indication has finished. Likewise
+      // while the sensor is in the middle of an event, or a technician
+      // has the BLE readout open.
+      if (sensorDetect || countSignalTimer.isActive() || SensorManager::instance().isSensorBusy() ||
+          BleReadout::active()) {
+        return;
+      }
+
+      // Nor with the post-connect work (configuration apply) unfinished
+      if (postConnectPending()) {
+        return;
+      }
+
+      // In a busy spell stay here with the interrupt attached. Once
+      // offline this holds until the rate drops; a connected device
+      // still goes through SLEEPING_STATE to disconnect, which sends it
+      // straight back.
+      if (!Particle.connected() && stayAwakeForTraffic()) {
+        return;
+      }
+
+      // Give the webhook responses for this session's reports a moment;
+      // ReportTracker resends whatever is still unconfirmed after that
+      if (!drainDeferred && ReportTracker::awaitingResponse()) {
         return;
       }
 
@@ -169,10 +260,14 @@ void handleIdleState() {
       if (!Particle.connected() && pending > 0) {
         Log.info("Low-power idle: offline with %u queued event(s) - sleeping and will flush on next connect",
                  (unsigned)pending);
+      } else if (drainDeferred) {
+        Log.info("Low-power idle: %u queued event(s) need ~%lus, past the connect budget at SoC %s%% - sleeping, rest goes next wake",
+                 (unsigned)pending, (unsigned long)(PublishQueuePosix::instance().getEstimatedDrainMs() / 1000),
+                 Payload::Scaled(current.get_socTenths(), 1).c_str());
       } else {
         Log.info("Low-power idle: queue drained and no updates pending - entering SLEEPING_STATE");
       }
-      state = SLEEPING_STATE;
+      setState(SLEEPING_STATE, REASON_QUEUE_DRAINED);
       return; // Go back to sleep when there's no work this hour
     }
   }
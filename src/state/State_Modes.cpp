@@ -1,12 +1,22 @@
 #include "state/State_Common.h"
 #include "Config.h"
 #include "Cloud.h"
+#include "ConfigSnapshot.h"
 #include "LocalTimeRK.h"
+#include "LoopbackTest.h"
+#include "MonoClock.h"
 #include "MyPersistentData.h"
+#include "OccupancyStats.h"
+#include "PowerDomains.h"
 #include "PublishQueuePosixRK.h"
 #include "SensorManager.h"
+#include "SleepPlanner.h"
+#include "TraceReplay.h"
 #include "device_pinout.h"
 #include "SensorDefinitions.h"
+#include "EventArchive.h"
+#include "LiveCount.h"
+#include "OccupancyNotify.h"
 
 // NOTE:
 // This file was split from StateHandlers.cpp as a mechanical refactor.
@@ -14,37 +24,119 @@
 
 // *************** Mode-Specific Handler Functions ***************
 
+// PowerDomains owner tag for BLUE_LED while a space is occupied
+static const uint8_t occupancyIndicator = 0;
+
 /**
  * @brief Handle sensor events in COUNTING mode
  *
  * @details In counting mode, each sensor detection increments counters.
  *          Counts are tracked hourly and daily.
  *          Used for: traffic counting, people counting, event tracking
+ *
+ *          All events drained in one pass are applied as a single counter
+ *          update, so a burst costs one persistent write rather than one
+ *          per event.
  */
 void handleCountingMode() {
+#if TRACE_REPLAY_ENABLED
+  uint32_t passStartUs = micros();
+#endif
   // Check if sensor has new data
-  if (SensorManager::instance().loop()) {
-    // Increment counters
-    current.set_hourlyCount(current.get_hourlyCount() + 1);
-    current.set_dailyCount(current.get_dailyCount() + 1);
-    current.set_lastCountTime(Time.now());
+  size_t events = SensorManager::instance().loop();
+  if (events > 0) {
+    // Increment counters once for the whole batch
+    current.noteSensorEvents(SensorManager::instance().batch(), events);
+    current.addCounts(events, SensorManager::instance().batch()[events - 1].unixTime());
+    EventArchive::append(SensorManager::instance().batch(), events);
+    LiveCount::noteCounts(events);
+    SensorManager::instance().noteEventsApplied();
+    SleepPlanner::noteEvents(events);
 
-    // Log the new count once per event
-    Log.info("Count detected - Hourly: %d, Daily: %d",
-             current.get_hourlyCount(), current.get_dailyCount());
+#if COUNT_PATH_LOGGING
+    // Log the new count once per batch
+    Log.info("Count detected (+%u) - Hourly: %lu, Daily: %lu", (unsigned)events,
+             (unsigned long)current.get_hourlyCount(), (unsigned long)current.get_dailyCount());
+#endif
+#if TRACE_REPLAY_ENABLED
+    TraceReplay::noteApplied(events, micros() - passStartUs);
+#endif
+#if LOOPBACK_TEST_ENABLED
+    LoopbackTest::noteApplied(SensorManager::instance().batch(), events);
+#endif
 
     // Flash the on-module BLUE LED for ~1 second as a
     // visual count indicator using a software timer so we
     // don't block the main loop.
-    digitalWrite(BLUE_LED, HIGH);
+#if INDICATOR_LEDS || INDICATOR_BLINK_ON_COUNT
+    PowerDomains::acquire(PowerDomains::STATUS_LED, &countSignalTimer);
     if (countSignalTimer.isActive()) {
       countSignalTimer.reset();
     } else {
       countSignalTimer.start();
     }
+#endif
 
     // Stay in IDLE_STATE; hourly reporting will publish aggregated counts.
   }
+
+  // Groups close a gap after their last pulse, usually on a pass with no events
+  uint16_t people = SensorManager::instance().takePeople();
+  if (people > 0) {
+    current.addPeople(people);
+  }
+}
+
+// ********** Occupancy deadline **********
+// Each presence event re-arms a one-shot timer for occupancyDebounceMs.
+// The timer callback only sets a flag; the session is closed from the
+// application thread in updateOccupancyState(). The RAM deadline is the
+// backstop for ULTRA_LOW_POWER naps, where software timers don't run but
+// millis() keeps counting, and lets the sleep handler cap a nap so the
+// session closes on time.
+static void occupancyTimeoutISR();
+static Timer occupancyTimer(1000, occupancyTimeoutISR, true);
+static volatile bool occupancyTimeoutFired = false;
+static bool occupancyArmed = false;      // RAM mirror: a session is open and a deadline is set
+static uint32_t occupancyDeadlineMs = 0;
+static uint8_t occupancySlots = 0;       // Sensor slots with events in the open session (bit n = slot n)
+
+static void occupancyTimeoutISR() { occupancyTimeoutFired = true; }
+
+/**
+ * @brief MonoClock milliseconds since the last occupancy event (0 if none is recorded).
+ */
+static uint64_t msSinceOccupancyEvent() {
+  uint64_t lastEvent = current.get_lastOccupancyEvent();
+  uint64_t now = MonoClock::nowMs();
+  return (lastEvent != 0 && now > lastEvent) ? now - lastEvent : 0;
+}
+
+/**
+ * @brief (Re)start the occupancy timeout, @p elapsedMs of it already spent.
+ */
+static void armOccupancyDeadline(uint64_t elapsedMs = 0) {
+  uint32_t debounceMs = ConfigSnapshot::read().occupancyDebounceMs;
+  debounceMs = (elapsedMs < debounceMs) ? debounceMs - (uint32_t)elapsedMs : 0;
+  occupancyDeadlineMs = millis() + debounceMs;
+  occupancyTimeoutFired = false;
+  occupancyArmed = true;
+
+  if (debounceMs == 0) {
+    occupancyTimeoutFired = true;   // Close on the next pass, as before
+    occupancyTimer.stop();
+  } else {
+    // changePeriod() also (re)starts the one-shot timer.
+    occupancyTimer.changePeriod(debounceMs);
+  }
+}
+
+uint32_t occupancyMsRemaining() {
+  if (!occupancyArmed) {
+    return 0;
+  }
+  int32_t remaining = (int32_t)(occupancyDeadlineMs - millis());
+  return remaining > 0 ? (uint32_t)remaining : 0;
 }
 
 /**
@@ -56,25 +148,50 @@ void handleCountingMode() {
  *          Used for: room occupancy, parking space detection, resource availability
  */
 void handleOccupancyMode() {
-  // Check if sensor has new data
-  if (SensorManager::instance().loop()) {
+#if TRACE_REPLAY_ENABLED
+  uint32_t passStartUs = micros();
+#endif
+  // Check if sensor has new data; any number of events in this pass is
+  // a single presence update.
+  size_t events = SensorManager::instance().loop();
+  if (events > 0) {
+    current.noteSensorEvents(SensorManager::instance().batch(), events);
+    for (size_t ii = 0; ii < events; ii++) {
+      occupancySlots |= (uint8_t)(1 << SensorManager::instance().batch()[ii].source());
+    }
+
     // Sensor detected presence
     if (!current.get_occupied()) {
-      // Transition from unoccupied to occupied
+      // Transition from unoccupied to occupied at the first event's time
+      auto update = current.updateBatch();
       current.set_occupied(true);
-      current.set_occupancyStartTime(Time.now());
+      current.set_occupancyStartTime(SensorManager::instance().batch()[0].unixTime());
+      update.commit();
+      OccupancyNotify::noteChange(true, current.get_occupancyStartTime());
 
       Log.info("Space now OCCUPIED at %s", Time.timeStr().c_str());
-      digitalWrite(BLUE_LED, HIGH); // Visual indicator
+#if INDICATOR_LEDS
+      PowerDomains::acquire(PowerDomains::STATUS_LED, &occupancyIndicator); // Visual indicator
+#endif
     }
 
-    // Update last event time (resets debounce timer)
-    current.set_lastOccupancyEvent(millis());
+    EventArchive::append(SensorManager::instance().batch(), events);
 
-    if (sysStatus.get_verboseMode()) {
+    // Update last event time and re-arm the debounce deadline
+    current.set_lastOccupancyEvent(MonoClock::nowMs());
+    armOccupancyDeadline();
+    SensorManager::instance().noteEventsApplied();
+    SleepPlanner::noteEvents(events);
+
+#if COUNT_PATH_LOGGING
+    if (ConfigSnapshot::read().verboseMode) {
       uint32_t occupiedDuration = Time.now() - current.get_occupancyStartTime();
       Log.info("Occupancy event - Duration: %lu seconds", occupiedDuration);
     }
+#endif
+#if TRACE_REPLAY_ENABLED
+    TraceReplay::noteApplied(events, micros() - passStartUs);
+#endif
   }
 
   // Check if we need to update occupancy state (timeout check)
@@ -87,31 +204,68 @@ void handleOccupancyMode() {
  * @details If space is occupied and debounce timeout has expired without
  *          new sensor events, mark space as unoccupied.
  *          Accumulates total occupied time for daily reporting.
+ *
+ *          Between events this is a RAM flag/deadline check only; the
+ *          persistent store is touched once when the session closes.
  */
 void updateOccupancyState() {
-  if (!current.get_occupied()) {
+  static bool bootChecked = false;
+  if (!bootChecked) {
+    bootChecked = true;
+    // A session persisted as open across a reset has no live deadline;
+    // give it what was left of the debounce at its last event, counting
+    // the time the device was off.
+    if (current.get_occupied()) {
+      armOccupancyDeadline(msSinceOccupancyEvent());
+    }
+  }
+
+  if (!occupancyArmed) {
     return; // Nothing to do if not occupied
   }
 
-  uint32_t debounceMs = sysStatus.get_occupancyDebounceMs();
-  uint32_t timeSinceLastEvent = millis() - current.get_lastOccupancyEvent();
+  bool expired = occupancyTimeoutFired || (int32_t)(millis() - occupancyDeadlineMs) >= 0;
+  if (!expired) {
+    return;
+  }
 
-  // Check if debounce timeout has expired
-  if (timeSinceLastEvent > debounceMs) {
-    // Calculate this occupancy session duration
-    uint32_t sessionDuration = Time.now() - current.get_occupancyStartTime();
+  occupancyArmed = false;
+  occupancyTimeoutFired = false;
+  occupancyTimer.stop();
 
-    // Add to total occupied seconds for the day
-    uint32_t totalOccupied = current.get_totalOccupiedSeconds() + sessionDuration;
-    current.set_totalOccupiedSeconds(totalOccupied);
+  if (!current.get_occupied()) {
+    return;
+  }
 
-    // Mark as unoccupied
+  // Calculate this occupancy session duration. The session ended one
+  // debounce after its last event; past that (a reset or a long sleep
+  // held the close back) is not occupied time.
+  time_t sessionEnd = Time.now();
+  uint64_t debounceMs = ConfigSnapshot::read().occupancyDebounceMs;
+  uint64_t sinceEventMs = msSinceOccupancyEvent();
+  if (sinceEventMs > debounceMs) {
+    sessionEnd -= (time_t)((sinceEventMs - debounceMs) / 1000);
+    if (sessionEnd < current.get_occupancyStartTime()) {
+      sessionEnd = current.get_occupancyStartTime();
+    }
+  }
+  uint32_t sessionDuration = sessionEnd - current.get_occupancyStartTime();
+
+  // Add to total occupied seconds for the day and mark as unoccupied
+  uint32_t totalOccupied = current.get_totalOccupiedSeconds() + sessionDuration;
+  {
+    auto update = current.updateBatch();
+    OccupancyStats::recordSession(current.get_occupancyStartTime(), sessionEnd);
+    current.set_totalOccupiedSeconds(totalOccupied);
     current.set_occupied(false);
     current.set_occupancyStartTime(0);
+    current.addSensorOccupiedSeconds(occupancySlots, sessionDuration);
+  }
+  occupancySlots = 0;
+  OccupancyNotify::noteChange(false, sessionEnd);
 
-    Log.info("Space now UNOCCUPIED - Session duration: %lu seconds, Total today: %lu seconds",
-             sessionDuration, totalOccupied);
+  Log.info("Space now UNOCCUPIED - Session duration: %lu seconds, Total today: %lu seconds",
+           sessionDuration, totalOccupied);
 
-    digitalWrite(BLUE_LED, LOW); // Turn off visual indicator
-  }
+  PowerDomains::release(PowerDomains::STATUS_LED, &occupancyIndicator); // Turn off visual indicator
 }
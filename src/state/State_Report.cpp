@@ -1,12 +1,20 @@
 #include "state/State_Common.h"
 #include "Config.h"
+#include "AutoTune.h"
+#include "BrownoutGuard.h"
 #include "Cloud.h"
-#include "LocalTimeRK.h"
+#include "ConnectHistory.h"
 #include "MyPersistentData.h"
+#include "OpenHours.h"
+#include "Payload.h"
+#include "PowerGovernor.h"
 #include "PublishQueuePosixRK.h"
 #include "SensorManager.h"
+#include "SoakTest.h"
+#include "TrafficBaseline.h"
 #include "device_pinout.h"
 #include "SensorDefinitions.h"
+#include "Particle_Functions.h"
 
 // NOTE:
 // This file was split from StateHandlers.cpp as a mechanical refactor.
@@ -14,34 +22,57 @@
 
 // REPORTING_STATE: Build and send periodic report
 void handleReportingState() {
-  if (state != oldState) {
-    publishStateTransition();
+  time_t now = Time.now();
+
+  // A report may connect even after the cloud flapped; the count starts again
+  ConnectHistory::noteScheduledReport();
+#if SOAK_TEST_ENABLED
+  SoakTest::noteCycle();
+#endif
+
+  // Likely to connect: let the modem power up and register while the
+  // report is measured and built (REPORT_RADIO_PREWARM)
+  if (!Particle.connected() && PowerGovernor::reportShouldConnect() &&
+      ConnectHistory::backoffRemainingSec() == 0 && !PowerGovernor::coldDeferral() &&
+      !BrownoutGuard::radioHeld()) {
+    startRadioPrewarm();
+  }
+
+  // Judge the hour against the learned baseline before dailyCleanup() can
+  // zero it, and let AutoTune weigh it; only a report about an hour after
+  // the last covers one hour
+  if (Time.isValid() && sysStatus.get_countingMode() == COUNTING) {
+    time_t sinceLast = now - sysStatus.get_lastReport();
+    if (sinceLast >= 45 * 60L && sinceLast <= 75 * 60L) {
+      TrafficBaseline::Verdict verdict =
+          TrafficBaseline::observe(now - (Time.minute() * 60L + Time.second() + 1L), current.get_hourlyCount());
+      AutoTune::noteHour(verdict);
+    }
   }
 
-  time_t now = Time.now();
   // If this is the first report after a calendar *local* day boundary,
   // run the daily cleanup once to reset daily counters and housekeeping.
+  // The next local midnight is kept in sysStatus, so this is one compare;
+  // it is only converted again once a day or after a timezone change.
   if (Time.isValid()) {
     time_t lastReport = sysStatus.get_lastReport();
+    time_t nextMidnight = sysStatus.get_nextLocalMidnight();
     if (lastReport != 0) {
-      LocalTimeConvert convNow;
-      convNow.withConfig(LocalTime::instance().getConfig()).withTime(now).convert();
-      LocalTimeConvert convLast;
-      convLast.withConfig(LocalTime::instance().getConfig()).withTime(lastReport).convert();
-
-      LocalTimeYMD ymdNow = convNow.getLocalTimeYMD();
-      LocalTimeYMD ymdLast = convLast.getLocalTimeYMD();
-
-      if (ymdNow.getYear() != ymdLast.getYear() ||
-          ymdNow.getMonth() != ymdLast.getMonth() ||
-          ymdNow.getDay() != ymdLast.getDay()) {
-        Log.info("New local day detected (last=%04d-%02d-%02d, current=%04d-%02d-%02d) - running dailyCleanup",
-                 ymdLast.getYear(), ymdLast.getMonth(), ymdLast.getDay(),
-                 ymdNow.getYear(), ymdNow.getMonth(), ymdNow.getDay());
+      if (nextMidnight == 0) {
+        nextMidnight = OpenHours::nextMidnightAfter(lastReport);
+      }
+      if (now >= nextMidnight) {
+        Log.info("New local day detected (midnight %s passed since last report) - running dailyCleanup",
+                 Time.format(nextMidnight, TIME_FORMAT_DEFAULT).c_str());
         dailyCleanup();
         sysStatus.set_lastDailyCleanup(now);
       }
     }
+    if (nextMidnight == 0 || now >= nextMidnight) {
+      sysStatus.set_nextLocalMidnight(OpenHours::nextMidnightAfter(now));
+    } else if (nextMidnight != sysStatus.get_nextLocalMidnight()) {
+      sysStatus.set_nextLocalMidnight(nextMidnight);
+    }
   }
 
   sysStatus.set_lastReport(now);
@@ -49,18 +80,39 @@ void handleReportingState() {
   // Read battery state BEFORE connectivity decision so SoC-tiered
   // logic below uses fresh data, not stale values from a previous
   // cycle or from during an active radio session.
-  measure.loop();         // Take sensor measurements for reporting
+  // Sensor events are drained by the mode handlers on every loop()
+  // pass; polling the sensor here would consume a batch uncounted.
   measure.batteryState(); // Update battery SoC/state and enclosure temperature
+  PowerGovernor::update(); // Back off reporting if the battery is running down
 
-  Log.info("Enclosure temperature at report: %4.2f C", (double)current.get_internalTempC());
+  Log.info("Enclosure temperature at report: %s C", Payload::Scaled(current.get_internalTempCenti(), 2).c_str());
   publishData(); // Queue hourly report; actual send depends on connectivity policy
 
+#if QUEUE_METRICS_EVENT_HOURS > 0
+  // Periodic publish queue summary (same JSON as the queueMetrics variable)
+  static time_t lastMetricsEvent = 0;
+  if (Time.isValid() && (lastMetricsEvent == 0 || (now - lastMetricsEvent) >= QUEUE_METRICS_EVENT_HOURS * 3600L)) {
+    char metricsJson[512];
+    if (Particle_Functions::formatQueueMetrics(metricsJson, sizeof(metricsJson))) {
+      publishDiagnosticSafe("queueMetrics", metricsJson, PRIVATE);
+    }
+    lastMetricsEvent = now;
+  }
+#endif
+
   // After each hourly report, reset the hourly counter so
   // the next report contains only the counts for that hour.
   if (sysStatus.get_countingMode() == COUNTING) {
-    Log.info("Resetting hourlyCount after report (was %d)", current.get_hourlyCount());
+    Log.info("Resetting hourlyCount after report (was %lu)", (unsigned long)current.get_hourlyCount());
     current.set_hourlyCount(0);
+    current.set_hourlyPeople(0);
+#if COUNT_BINS_ENABLED
+    current.clearCountBins();
+#endif
+    current.startBuckets(now, sysStatus.get_bucketSec(), PowerGovernor::reportingIntervalSec());
   }
+  current.clearSensorHourlyCounts();
+  current.clearSampleStats();
 
   // Webhook supervision: if we have not seen a successful webhook
   // response in more than 6 hours, raise alert 40 so the error
@@ -86,11 +138,31 @@ void handleReportingState() {
   // ********** Connectivity Decision **********
   // In low-power mode, connect on every scheduled report to drain queue.
   // User can control report frequency via reportingIntervalSec.
-  if (!Particle.connected()) {
+  if (!Particle.connected() && !PowerGovernor::reportShouldConnect()) {
+    Log.info("REPORTING: store-only power tier - report queued, not connecting");
+    cancelRadioPrewarm();
+    setState(IDLE_STATE, REASON_STORE_ONLY);
+  } else if (!Particle.connected() && ConnectHistory::backoffRemainingSec() > 0) {
+    Log.info("REPORTING: connect backoff after %u failures - report queued, next attempt in %lu s",
+             sysStatus.get_connectFailStreak(), (unsigned long)ConnectHistory::backoffRemainingSec());
+    cancelRadioPrewarm();
+    setState(IDLE_STATE, REASON_CONNECT_BACKOFF);
+  } else if (!Particle.connected() && PowerGovernor::coldDeferral()) {
+    PowerGovernor::noteColdDeferral();
+    Log.info("REPORTING: enclosure at %s C, below %d C - report queued, not connecting",
+             Payload::Scaled(current.get_internalTempCenti(), 2).c_str(), COLD_DEFER_BELOW_C);
+    cancelRadioPrewarm();
+    setState(IDLE_STATE, REASON_COLD_DEFER);
+  } else if (!Particle.connected() && BrownoutGuard::radioHeld()) {
+    Log.info("REPORTING: battery at %s%% and failing - report queued, not connecting",
+             Payload::Scaled(current.get_socTenths(), 1).c_str());
+    cancelRadioPrewarm();
+    setState(IDLE_STATE, REASON_BROWNOUT_HOLD);
+  } else if (!Particle.connected()) {
     Log.info("REPORTING: Not connected - reason=SCHEDULED_REPORT transitioning to CONNECTING_STATE");
-    state = CONNECTING_STATE;
+    setState(CONNECTING_STATE, REASON_SCHEDULED_REPORT);
   } else {
-    state = IDLE_STATE;
+    setState(IDLE_STATE, REASON_REPORT_DONE);
   }
 
   // If a webhook supervision alert (40) has been raised, we leave the
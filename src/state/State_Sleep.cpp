@@ -1,56 +1,147 @@
 #include "state/State_Common.h"
 #include "Config.h"
+#include "BleReadout.h"
+#include "BrownoutGuard.h"
 #include "Cloud.h"
+#include "ConnectCache.h"
+#include "ConnectHistory.h"
+#include "EnergyLedger.h"
+#include "EventArchive.h"
 #include "LocalTimeRK.h"
+#include "MonoClock.h"
 #include "MyPersistentData.h"
+#include "PhaseMarker.h"
+#include "PowerDomains.h"
+#include "PowerGovernor.h"
+#include "PowerPolicy.h"
 #include "PublishQueuePosixRK.h"
+#include "ReportSlot.h"
+#include "ScheduledSampler.h"
 #include "SensorManager.h"
+#include "SleepPlanner.h"
+#include "TaskScheduler.h"
+#include "TraceLog.h"
+#include "WakeAccuracy.h"
+#include "WakeLedger.h"
 #include "device_pinout.h"
 #include "SensorDefinitions.h"
 #include "AB1805_RK.h"
+#include <math.h>
 
 // NOTE:
 // This file was split from StateHandlers.cpp as a mechanical refactor.
 // No behavioral changes were made.
 
+// Set if an AB1805 night power-down returns, so later nights use Device OS sleep
+static bool powerDownFailedForSession = false;
+
+// Non-blocking disconnect in progress; cleared on entry
+static bool disconnectRequested = false;
+static unsigned long disconnectRequestStartMs = 0;
+
+// Per-device wake offset after the reporting boundary (the policy's jitter
+// window, WAKE_JITTER_WINDOW_SEC for the control), so the fleet does not
+// connect in the same second. Hashed from the device ID, so it is stable
+// across wakes and resets.
+static int wakeJitterSec() {
+  static uint32_t hash = 0;
+  static bool hashed = false;
+  static int jitterSec = -1;
+  static uint32_t jitterWindow = 0;
+  if (!hashed) {
+    String id = System.deviceID();
+    hash = StorageHelperRK::murmur3_32((const uint8_t *)id.c_str(), id.length(),
+                                       StorageHelperRK::PersistentDataBase::HASH_SEED);
+    hashed = true;
+  }
+  uint32_t window = PowerPolicy::active().wakeJitterWindowSec;
+  if (window > (uint32_t)wakeBoundary / 2) {
+    window = (uint32_t)wakeBoundary / 2;   // Keep the wake inside the hour it reports
+  }
+  if (jitterSec < 0 || window != jitterWindow) {
+    jitterWindow = window;
+    jitterSec = window ? (int)(hash % window) : 0;
+    Log.info("Wake jitter: %d s after each boundary (window %lu s)", jitterSec, (unsigned long)window);
+  }
+  return jitterSec;
+}
+
+// Cut power to the device until wakeTime using the AB1805 alarm and sleep
+// mode. Unlike AB1805::deepPowerDown(), whose countdown is limited to 255 s,
+// the alarm can be set hours out, so one power-down spans the whole closed
+// period. The RTC keeps time and restores it on the next boot. Returns only
+// on failure, with the alarm cleared and the watchdog resumed.
+static void deepPowerDownUntil(time_t wakeTime) {
+  bool ok = ab1805.interruptAtTime(wakeTime);   // Also disables the watchdog
+  // Same sequence as AB1805::deepPowerDown() after its countdown: clocks
+  // running, low-resistance power switch, I/O gated off, nIRQ2 as the
+  // sleep output, then enter sleep with nRST held low.
+  ok = ok &&
+       ab1805.maskRegister(AB1805::REG_CTRL_1, (uint8_t)~(AB1805::REG_CTRL_1_STOP | AB1805::REG_CTRL_1_RSP),
+                           AB1805::REG_CTRL_1_PWR2) &&
+       ab1805.setRegisterBit(AB1805::REG_OSC_CTRL, AB1805::REG_OSC_CTRL_PWGT) &&
+       ab1805.maskRegister(AB1805::REG_CTRL_2, (uint8_t)~AB1805::REG_CTRL_2_OUT2S_MASK,
+                           AB1805::REG_CTRL_2_OUT2S_SLEEP) &&
+       ab1805.writeRegister(AB1805::REG_SLEEP_CTRL, AB1805::REG_SLEEP_CTRL_SLP | AB1805::REG_SLEEP_CTRL_SLRES);
+  if (ok) {
+    delay(5000);   // Power is removed within a few ms of entering sleep
+  }
+  Log.error("AB1805 power-down did not take effect");
+  ab1805.clearRepeatingInterrupt();
+  ab1805.resumeWDT();
+}
+
+// SLEEPING_STATE entry: sync ledgers, log the park-hours view, reset the disconnect
+void enterSleepingState(State from) {
+  // One ledger sync per connection: write everything marked dirty since
+  // the last flush before the queue drain and disconnect below.
+  Cloud::instance().flushLedgers();
+  // One-time diagnostic on entry so logs clearly show the device's view of park hours.
+  if (Time.isValid()) {
+    LocalTimeConvert conv;
+    conv.withConfig(LocalTime::instance().getConfig()).withCurrentTime().convert();
+    uint8_t hour = (uint8_t)(conv.getLocalTimeHMS().toSeconds() / 3600);
+    Log.info("SLEEP entry: parkHours %02u-%02u localHour=%02u => %s",
+             sysStatus.get_openTime(), sysStatus.get_closeTime(), hour,
+             isWithinOpenHours() ? "OPEN" : "CLOSED");
+  } else {
+    Log.info("SLEEP entry: Time invalid => treating as OPEN (per policy)");
+  }
+  Log.info("SLEEP entry: sensorReady=%s", SensorManager::instance().isSensorReady() ? "true" : "false");
+  disconnectRequested = false;
+  disconnectRequestStartMs = 0;
+}
+
 /**
  * @brief SLEEPING_STATE: deep sleep between reporting intervals.
  * ...
  */
 void handleSleepingState() {
-  bool enteredState = (state != oldState);
   bool ignoreDisconnectFailure = false;
 
-  if (enteredState) {
-    publishStateTransition();
-    // One-time diagnostic on entry so logs clearly show the device's view of park hours.
-    if (Time.isValid()) {
-      LocalTimeConvert conv;
-      conv.withConfig(LocalTime::instance().getConfig()).withCurrentTime().convert();
-      uint8_t hour = (uint8_t)(conv.getLocalTimeHMS().toSeconds() / 3600);
-      Log.info("SLEEP entry: parkHours %02u-%02u localHour=%02u => %s",
-               sysStatus.get_openTime(), sysStatus.get_closeTime(), hour,
-               isWithinOpenHours() ? "OPEN" : "CLOSED");
-    } else {
-      Log.info("SLEEP entry: Time invalid => treating as OPEN (per policy)");
-    }
-    Log.info("SLEEP entry: sensorReady=%s", SensorManager::instance().isSensorReady() ? "true" : "false");
-  }
-
   // If a ledger update (or time progression) moves the park into OPEN hours
   // while we are in SLEEPING_STATE, abort sleeping immediately in CONNECTED
   // mode so we stay awake/connected and resume counting.
-  if (Time.isValid() && sysStatus.get_operatingMode() == CONNECTED && isWithinOpenHours()) {
+  if (Time.isValid() && PowerGovernor::operatingMode() == CONNECTED && isWithinOpenHours()) {
     ensureSensorEnabled("SLEEP abort: CONNECTED+OPEN");
-    state = IDLE_STATE;
+    setState(IDLE_STATE, REASON_PARK_OPEN);
+    return;
+  }
+
+  // Archived events still in RAM would be lost in a HIBERNATE; let the
+  // writer put them on the card first (idle() is true without a card).
+  if (!EventArchive::idle()) {
+    EventArchive::flush();
     return;
   }
 
   // If we are connected and the publish queue is not yet in a sleep-safe
   // state (events queued or a publish in progress), defer sleeping so we
-  // can finish delivering data. When offline, allow sleep immediately;
-  // queued events will be flushed on the next connection.
-  if (Particle.connected() && !PublishQueuePosix::instance().getCanSleep()) {
+  // can finish delivering data, unless the drain will not finish within
+  // the connect budget on a low battery (shouldFinishQueueDrain()). When
+  // offline, allow sleep immediately; queued events will be flushed on the
+  // next connection.
+  if (Particle.connected() && !PublishQueuePosix::instance().getCanSleep() && shouldFinishQueueDrain()) {
     static size_t lastPendingLogged = (size_t)-1;
     static unsigned long lastDeferralLogMs = 0;
 
@@ -72,14 +163,6 @@ void handleSleepingState() {
   // Particle.disconnect() has been requested. Here, we keep application
   // logic minimal: request cloud disconnect and radio-off once, then wait
   // (bounded) until both cloud and modem are actually off before sleeping.
-  static bool disconnectRequested = false;
-  static unsigned long disconnectRequestStartMs = 0;
-
-  if (enteredState) {
-    disconnectRequested = false;
-    disconnectRequestStartMs = 0;
-  }
-
   bool needDisconnect = Particle.connected() || isRadioPoweredOn();
   if (needDisconnect) {
     // Use ledger-configured budgets when available, with conservative defaults.
@@ -96,17 +179,28 @@ void handleSleepingState() {
     unsigned long budgetMs = (unsigned long)((modemBudgetSec > cloudBudgetSec) ? modemBudgetSec : cloudBudgetSec) * 1000UL;
 
     if (!disconnectRequested) {
-      Log.info("SLEEP: requesting cloud disconnect + modem off");
-      requestFullDisconnectAndRadioOff();
+      // With the queue drained there is nothing for a graceful close to wait on
+      bool fast = SLEEP_FAST_TEARDOWN && PowerPolicy::active().fastTeardown && PublishQueuePosix::instance().getCanSleep() &&
+                  PublishQueuePosix::instance().getNumEvents() == 0;
+      if (fast) {
+        Log.info("SLEEP: queue drained - fast cloud disconnect + modem off");
+        requestFastDisconnectAndRadioOff();
+      } else {
+        Log.info("SLEEP: requesting cloud disconnect + modem off");
+        requestFullDisconnectAndRadioOff();
+      }
+      ConnectCache::beginTeardown(fast);
       disconnectRequested = true;
       disconnectRequestStartMs = millis();
       return;
     }
 
+    ConnectCache::pollTeardown();
     bool stillOn = Particle.connected() || isRadioPoweredOn();
     if (stillOn) {
       if (disconnectRequestStartMs != 0 && (millis() - disconnectRequestStartMs) > budgetMs) {
-        if (sysStatus.get_operatingMode() != CONNECTED) {
+        ConnectCache::endTeardown();
+        if (PowerGovernor::operatingMode() != CONNECTED) {
           Log.warn("SLEEP: disconnect/modem-off exceeded budget (%lu ms) - continuing to sleep",
                    (unsigned long)(millis() - disconnectRequestStartMs));
           ignoreDisconnectFailure = true;
@@ -116,7 +210,7 @@ void handleSleepingState() {
           Log.warn("SLEEP: disconnect/modem-off exceeded budget (%lu ms) - raising alert 15",
                    (unsigned long)(millis() - disconnectRequestStartMs));
           current.raiseAlert(15);
-          state = ERROR_STATE;
+          setState(ERROR_STATE, REASON_DISCONNECT_TIMEOUT);
           disconnectRequested = false;
           disconnectRequestStartMs = 0;
           return;
@@ -144,6 +238,30 @@ void handleSleepingState() {
       nightSleepSec = 3600; // Fallback
     }
 
+#if NIGHT_DEEP_POWER_DOWN
+    // Power down through the AB1805 until opening time: no clamp, so no
+    // extra overnight wake. Needs a set RTC to keep time while unpowered,
+    // and no open occupancy session (its timeout would be missed).
+    if (!powerDownFailedForSession && nightSleepSec >= NIGHT_DEEP_POWER_DOWN_MIN_SEC &&
+        Time.isValid() && ab1805.isRTCSet() && occupancyMsRemaining() == 0 &&
+        !sensorDetect && !countSignalTimer.isActive()) {
+      time_t wakeTime = Time.now() + nightSleepSec;
+      Log.info("Powering down via AB1805 for %d seconds until %s", nightSleepSec,
+               Time.format(wakeTime, TIME_FORMAT_DEFAULT).c_str());
+      PowerDomains::releaseAll(PowerDomains::STATUS_LED);
+      EnergyLedger::beginSleep(true);   // Credited by EnergyLedger::setup() on the next boot
+      MonoClock::beginSleep(true);
+      current.checkpoint();
+      PublishQueuePosix::instance().writeQueueToFiles();   // The retained queue does not survive either
+      deepPowerDownUntil(wakeTime);
+
+      EnergyLedger::endSleep();
+      MonoClock::endSleep();
+      Log.error("AB1805 power-down failed - using Device OS sleep for this session");
+      powerDownFailedForSession = true;
+    }
+#endif
+
     // Device OS maximum sleep duration is 546 minutes (~9.1 hours).
     // Clamp our requested night sleep to this limit so the
     // underlying platform will reliably honour it.
@@ -152,82 +270,184 @@ void handleSleepingState() {
       Log.info("Clamping night sleep duration to max supported %d seconds (requested=%d)", MAX_SLEEP_SEC, nightSleepSec);
       nightSleepSec = MAX_SLEEP_SEC;
     }
-
-    // First attempt a true HIBERNATE so platforms that support it
-    // still get a cold boot at next opening time.
-    if (!hibernateDisabledForSession) {
-      Log.info("Outside opening hours - entering NIGHT HIBERNATE sleep for %d seconds", nightSleepSec);
-
-      ab1805.stopWDT();
-      // Reset sleep configuration so prior ULTRA_LOW_POWER GPIOs do not
-      // accidentally carry into HIBERNATE configuration.
-      config = SystemSleepConfiguration();
-      config.mode(SystemSleepMode::HIBERNATE)
-        .gpio(BUTTON_PIN, FALLING)
-        .duration((uint32_t)nightSleepSec * 1000UL);
-
-      // HIBERNATE should reset the device on wake, so execution should
-      // not resume here under normal conditions.
-      System.sleep(config);
-
-      // If we reach this point, HIBERNATE did not reset as expected on
-      // this hardware/OS combination. Log once, raise an alert, and
-      // permanently disable HIBERNATE for the remainder of this boot so
-      // we can fall back to ULTRA_LOW_POWER instead of thrashing.
-      ab1805.resumeWDT();
-      Log.error("HIBERNATE sleep returned unexpectedly - disabling HIBERNATE for this session");
-      current.raiseAlert(16); // Alert: unexpected return from HIBERNATE
-      hibernateDisabledForSession = true;
-      // Fall through to ULTRA_LOW_POWER fallback below.
-    }
   }
 
-  // ********** ULTRA_LOW_POWER sleep (daytime or night fallback) **********
-  // During opening hours we use the reportingIntervalSec as before.
-  // Outside opening hours, if HIBERNATE is disabled or unsupported,
-  // fall back to ULTRA_LOW_POWER with a long sleep equal to the
-  // time until next open to avoid rapid wake/sleep thrashing.
-  uint16_t intervalSec = sysStatus.get_reportingInterval();
+  // ********** Nap duration **********
+  // During opening hours we wake at the next reporting boundary.
+  // Outside opening hours we sleep until the next open to avoid rapid
+  // wake/sleep thrashing. SleepPlanner then picks the mode below.
+  uint16_t intervalSec = PowerGovernor::reportingIntervalSec();
   if (intervalSec == 0) {
     intervalSec = 1 * 3600; // Preserve 1 hour default if unset
   }
 
   int wakeInSeconds;
+  time_t boundaryTarget = 0;    // Absolute wake time of a boundary nap (WakeAccuracy)
   if (!isWithinOpenHours() && nightSleepSec > 0) {
     wakeInSeconds = nightSleepSec;
-    Log.info("Outside opening hours - using ULTRA_LOW_POWER fallback sleep for %d seconds", wakeInSeconds);
+    Log.info("Outside opening hours - sleeping %d seconds until next open", wakeInSeconds);
   } else {
-    // Within opening hours, align wake to the reporting boundary.
-    // Add 1 second margin to ensure we wake slightly after the boundary.
+    // Within opening hours, align wake to the reporting boundary plus
+    // this device's jitter. The timer is programmed from that absolute
+    // time just before sleeping, with a learned margin (WakeAccuracy) so
+    // we wake slightly after it. publishData() still stamps the report
+    // with the boundary.
     if (Time.isValid() && wakeBoundary > 0) {
       int boundary = wakeBoundary;
+      int jitter = ReportSlot::wakeOffsetSec(wakeJitterSec());   // The site slot, if one is set
       time_t now = Time.now();
-      int offset = (int)(now % boundary);
+      int offset = (int)((now - jitter) % boundary);
       int aligned = boundary - offset;
       if (aligned < 1) {
         aligned = 1;
       } else if (aligned > boundary) {
         aligned = boundary;
       }
-      wakeInSeconds = aligned + 1;
-      Log.info("Sleep alignment: now=%lu boundary=%d offset=%d aligned=%d (+1 for margin)",
-               (unsigned long)now, boundary, offset, aligned);
+      boundaryTarget = WakeAccuracy::nextTarget(now + aligned, boundary);
+      wakeInSeconds = (int)(boundaryTarget - now) + 1;
+      Log.info("Sleep alignment: now=%lu boundary=%d jitter=%d offset=%d target=%lu (+%d ms margin)",
+               (unsigned long)now, boundary, jitter, offset, (unsigned long)boundaryTarget,
+               (int)sysStatus.get_wakeCorrectionMs());
     } else {
       wakeInSeconds = (int)intervalSec;
     }
   }
 
+  // Don't sleep past an open occupancy session's timeout, or the session
+  // would be closed late and over-report occupied time.
+  bool occupancyCappedSleep = false;
+  uint32_t occupancyRemainingMs = occupancyMsRemaining();
+  if (occupancyRemainingMs > 0) {
+    int occupancySec = (int)((occupancyRemainingMs + 999UL) / 1000UL);
+    if (occupancySec < wakeInSeconds) {
+      Log.info("Sleep capped at %d s for occupancy timeout (was %d s)", occupancySec, wakeInSeconds);
+      wakeInSeconds = occupancySec;
+      occupancyCappedSleep = true;
+    }
+  }
+
+  // SCHEDULED mode naps from one pollingRate boundary to the next; the
+  // wake samples and sleeps again without going through IDLE.
+  bool sampleCappedSleep = false;
+  if (sysStatus.get_countingMode() == SCHEDULED && isWithinOpenHours() && Time.isValid()) {
+    ScheduledSampler::sampleIfDue();   // Normally IDLE already has
+    int sampleSec = (int)ScheduledSampler::secondsUntilDue() + 1;
+    if (sampleSec < wakeInSeconds) {
+      Log.info("Sleep capped at %d s for the next scheduled sample (was %d s)", sampleSec, wakeInSeconds);
+      wakeInSeconds = sampleSec;
+      sampleCappedSleep = true;
+    }
+  }
+
+  // A polled sensor has no wake source of its own; the timer is its wake
+  // (SCHEDULED returns UINT32_MAX and is capped above)
+  uint32_t pollMs = SensorManager::instance().msUntilNextPoll();
+  if (isWithinOpenHours() && pollMs != UINT32_MAX) {
+    int pollSec = (int)(pollMs / 1000UL) + 1;
+    if (pollSec < wakeInSeconds) {
+      Log.info("Sleep capped at %d s for the next sensor poll (was %d s)", pollSec, wakeInSeconds);
+      wakeInSeconds = pollSec;
+    }
+  }
+
+  // A sensor still warming up is not a wake source; wake when it has settled
+  uint32_t warmMs = SensorManager::instance().msUntilWarm();
+  if (warmMs > 0) {
+    int warmSec = (int)(warmMs / 1000UL) + 1;
+    if (warmSec < wakeInSeconds) {
+      Log.info("Sleep capped at %d s for sensor warm-up (was %d s)", warmSec, wakeInSeconds);
+      wakeInSeconds = warmSec;
+    }
+  }
+
+  // A backlog goes out early while charging at a high SoC, not at the
+  // next report when the power may be coming from the reserve
+  bool surplusCappedSleep = false;
+  uint32_t surplusSec = PowerGovernor::surplusDrainWaitSec();
+  if (surplusSec > 0 && (int)surplusSec + 1 < wakeInSeconds) {
+    Log.info("Sleep capped at %lu s for a backlog drain on surplus power (was %d s)",
+             (unsigned long)surplusSec + 1, wakeInSeconds);
+    wakeInSeconds = (int)surplusSec + 1;
+    surplusCappedSleep = true;
+  }
+
+  // A capped nap wakes for something else; only boundary wakes are measured
+  if (boundaryTarget != 0 && wakeInSeconds < (int)(boundaryTarget - Time.now()) + 1) {
+    boundaryTarget = 0;
+  }
+
   // If a sensor event is pending or the BLUE LED timer is still
   // active from a recent count, defer entering deep sleep so we
   // don't cut off in-progress events or visible indications.
-  if (sensorDetect || countSignalTimer.isActive()) {
+  if (sensorDetect || countSignalTimer.isActive() || SensorManager::instance().isSensorBusy()) {
     Log.info("Deferring sleep - sensor event or LED timer active");
-    state = IDLE_STATE;
+    setState(IDLE_STATE, REASON_SENSOR_BUSY);
+    return;
+  }
+
+  // Events are arriving faster than napping between them pays for: stay
+  // awake (offline, interrupt attached) until the rate drops.
+  if (stayAwakeForTraffic()) {
+    Log.info("Skipping nap - %ld events/h is above the stay-awake crossover",
+             lroundf(SleepPlanner::eventRatePerHour()));
+    setState(IDLE_STATE, REASON_TRAFFIC);
     return;
   }
 
-  if (digitalRead(BLUE_LED) == HIGH) {
-    digitalWrite(BLUE_LED, LOW);
+  PowerDomains::releaseAll(PowerDomains::STATUS_LED);   // No indication outlasts a nap
+
+  // ********** Sleep mode **********
+  // Interrupt-driven counting needs the sensor to wake the device, which
+  // rules out HIBERNATE (BUTTON_PIN only); so does an open occupancy session.
+  // Polled sensors declare no wake source and leave the nap to the timer.
+  bool sensorArmed = isWithinOpenHours() && sysStatus.get_countingMode() != SCHEDULED &&
+                     SensorManager::instance().hasWakeSource();
+  bool hibernateAllowed = !hibernateDisabledForSession && !occupancyCappedSleep && !sampleCappedSleep &&
+                          occupancyRemainingMs == 0 &&
+                          (SLEEP_PLANNER_ENABLED || !isWithinOpenHours());   // Fixed policy: night only
+  SleepPlanner::Mode sleepMode = SleepPlanner::choose((uint32_t)wakeInSeconds, sensorArmed, hibernateAllowed);
+
+  if (sleepMode == SleepPlanner::MODE_HIBERNATE) {
+    Log.info("Entering HIBERNATE sleep for %d seconds", wakeInSeconds);
+    if (isWithinOpenHours()) {
+      SensorManager::instance().onEnterSleep();   // Not powered down for daytime naps above
+    }
+
+    ab1805.stopWDT();
+    // Reset sleep configuration so prior ULTRA_LOW_POWER GPIOs do not
+    // accidentally carry into HIBERNATE configuration.
+    config = SystemSleepConfiguration();
+    config.mode(SystemSleepMode::HIBERNATE)
+      .gpio(BUTTON_PIN, FALLING)
+      .duration(boundaryTarget ? WakeAccuracy::durationMs(boundaryTarget) : (uint32_t)wakeInSeconds * 1000UL);
+
+    // Retained counters and the retained publish queue do not survive HIBERNATE
+    EnergyLedger::beginSleep(true);
+    MonoClock::beginSleep(true);
+    current.checkpoint();
+    PublishQueuePosix::instance().writeQueueToFiles();
+
+    // HIBERNATE should reset the device on wake, so execution should
+    // not resume here under normal conditions.
+    WakeLedger::noteSleep();
+    TraceLog::record(TraceLog::SLEEP, sleepMode, wakeInSeconds);
+    PhaseMarker::set(PhaseMarker::SLEEPING);
+    System.sleep(config);
+    PhaseMarker::noteWake();
+
+    // If we reach this point, HIBERNATE did not reset as expected on
+    // this hardware/OS combination. Log once, raise an alert, and
+    // permanently disable HIBERNATE for the remainder of this boot so
+    // we can fall back to ULTRA_LOW_POWER instead of thrashing.
+    EnergyLedger::endSleep();
+    MonoClock::endSleep();
+    TaskScheduler::instance().resumePass();
+    ab1805.resumeWDT();
+    Log.error("HIBERNATE sleep returned unexpectedly - disabling HIBERNATE for this session");
+    current.raiseAlert(16); // Alert: unexpected return from HIBERNATE
+    hibernateDisabledForSession = true;
+    sleepMode = SleepPlanner::MODE_ULP;
+    // Fall through to ULTRA_LOW_POWER fallback below.
   }
 
   // Reset sleep configuration on each sleep so GPIO selections do not
@@ -239,41 +459,100 @@ void handleSleepingState() {
   // NO AB1805 alarms - AB1805 is only used for watchdog + RTC time sync.
   // This approach works reliably on Photon2!
   
-  Log.info("Entering ULTRA_LOW_POWER sleep for %d seconds (wakes at boundary or on GPIO)", wakeInSeconds);
+  const char *sleepModeName = SleepPlanner::modeName(sleepMode);
+  Log.info("Entering %s sleep for %d seconds (wakes at boundary or on GPIO)", sleepModeName, wakeInSeconds);
   
   ab1805.stopWDT();
+  SensorManager::instance().prepareForNap();
   
-  config.mode(SystemSleepMode::ULTRA_LOW_POWER)
+  config.mode(sleepMode == SleepPlanner::MODE_STOP ? SystemSleepMode::STOP : SystemSleepMode::ULTRA_LOW_POWER)
     .gpio(BUTTON_PIN, CHANGE)    // Service button wake
-    .gpio(intPin, RISING)        // PIR sensor wake (original behavior: rising edge)
-    .duration(wakeInSeconds * 1000L);  // Timer-based wake at reporting boundary
+    .duration(boundaryTarget ? WakeAccuracy::durationMs(boundaryTarget)   // Reporting boundary, from the absolute time
+                             : (uint32_t)wakeInSeconds * 1000UL);
+  // In a busy hour, or always for a bursty sensor such as a rain gauge,
+  // count edges in hardware instead of waking on each one
+  bool busyHour = EDGE_COUNT_IN_SLEEP && sysStatus.get_countingMode() == COUNTING &&
+                  current.get_hourlyCount() >= EDGE_COUNT_BUSY_PER_HOUR;
+  bool edgeCounting = sensorArmed && (busyHour || SensorManager::instance().sensorCountsEdgesInSleep()) &&
+                      SensorManager::instance().beginSleepEdgeCount();
+  if (sysStatus.get_countingMode() != SCHEDULED) {   // Nothing to wake for between samples
+    SensorManager::instance().addWakeSources(config, edgeCounting);
+  }
   
+  EnergyLedger::beginSleep(false);
+  MonoClock::beginSleep(false);
+  SleepPlanner::noteSleepStart();
+  const uint32_t sleepStartMs = millis();
+  const time_t sleepStartTime = Time.now();
+  WakeLedger::noteSleep();
+  TraceLog::record(TraceLog::SLEEP, sleepMode, wakeInSeconds);
+  PhaseMarker::set(PhaseMarker::SLEEPING);
   SystemSleepResult result = System.sleep(config);
+  const uint32_t wakeReturnMs = millis();
+  PhaseMarker::noteWake();
+  EnergyLedger::endSleep();
+  MonoClock::endSleep();
+  TaskScheduler::instance().resumePass();   // Time asleep is not loop time
 
-#ifdef DEBUG_SERIAL
-  delay(100);
-  waitFor(Serial.isConnected, 5000);
-  delay(100);
-#endif // DEBUG_SERIAL
-  
   ab1805.resumeWDT();
   
   // Determine wake source
   // When both GPIO and timer wake are configured, the wake source detection can be
   // ambiguous. The explicit approach: if neither GPIO pin woke us, it's the timer.
   pin_t wakePin = result.wakeupPin();
-  bool pirWake = (wakePin == intPin);
+  bool pirWake = SensorManager::instance().isSensorWakePin(wakePin);
   bool buttonWake = (wakePin == BUTTON_PIN);
   bool timerWake = !pirWake && !buttonWake;  // If no GPIO woke us, it's the timer
   
   // Wake diagnostics - include raw wakeupReason() for debugging
   SystemSleepWakeupReason reason = result.wakeupReason();
-  Log.info("Woke from ULTRA_LOW_POWER: wakeupReason=%d pin=%d (pir=%d button=%d timer=%d)",
-           (int)reason, (int)wakePin, pirWake, buttonWake, timerWake);
+  Log.info("Woke from %s: wakeupReason=%d pin=%d (pir=%d button=%d timer=%d)",
+           sleepModeName, (int)reason, (int)wakePin, pirWake, buttonWake, timerWake);
+
+  // millis() may not advance during sleep on every platform; prefer the RTC
+  uint32_t sleptSec = (wakeReturnMs - sleepStartMs) / 1000;
+  if (Time.isValid() && sleepStartTime > 0 && Time.now() >= sleepStartTime) {
+    sleptSec = (uint32_t)(Time.now() - sleepStartTime);
+  }
+  SleepPlanner::recordNap(sleptSec, pirWake);
+  if (timerWake && boundaryTarget != 0) {
+    WakeAccuracy::noteTimerWake(boundaryTarget);
+  }
+
+  uint32_t sleepEdges = 0;
+  if (edgeCounting) {
+    uint32_t edges = SensorManager::instance().endSleepEdgeCount();
+    if (edges > (uint32_t)SENSOR_STORM_EDGES_PER_SEC * (sleptSec + 1)) {
+      Log.error("Sleep edge count: %lu edges in %lu s is a storm, not motion; discarded",
+                (unsigned long)edges, (unsigned long)sleptSec);
+    } else if (edges > 0) {
+      // No timestamps to filter, so the filter's refractory time and rate cap bound the count instead
+      uint32_t rawEdges = edges;
+      edges = SensorManager::instance().filterSleepEdges(edges, (sleptSec + 1) * 1000UL);
+      if (edges < rawEdges) {
+        Log.info("Sleep edge count: %lu edges capped at %lu by the event filter", (unsigned long)rawEdges,
+                 (unsigned long)edges);
+      }
+      // Counted before any handler runs, so a boundary wake reports them in the hour they happened
+      if (sysStatus.get_countingMode() == COUNTING) {
+        current.addCounts((uint16_t)(edges > 0xffff ? 0xffff : edges), sleepStartTime + (time_t)(sleptSec / 2));
+      }
+      SensorManager::instance().noteSleepEdges(edges, sleepStartTime, sleptSec);
+      SleepPlanner::noteEvents(edges);
+      sleepEdges = edges;
+      Log.info("Sleep edge count: %lu edges during %lu s nap", (unsigned long)edges, (unsigned long)sleptSec);
+    }
+  }
+  TraceLog::record(TraceLog::WAKE, (int32_t)reason, (int32_t)wakePin, (int32_t)sleptSec);
+  WakeLedger::noteWake(pirWake ? WakeLedger::SENSOR : buttonWake ? WakeLedger::BUTTON : WakeLedger::TIMER,
+                       sleptSec, sleepEdges);
   
+#if INDICATOR_LEDS
   if (pirWake) {
-    digitalWrite(BLUE_LED, HIGH);  // Immediate visual feedback for motion
+    // Immediate visual feedback for motion; the count's blink timer ends it
+    PowerDomains::acquire(PowerDomains::STATUS_LED, &countSignalTimer);
   }
+#endif
 
   // Diagnostic: confirm open/closed decision at wake.
   if (Time.isValid()) {
@@ -288,11 +567,17 @@ void handleSleepingState() {
   }
 
   if (buttonWake) {
-    // User button wake: go directly to CONNECTING_STATE.
+    // User button wake: open the BLE readout and wait in IDLE, or, without
+    // one, go directly to CONNECTING_STATE.
     SensorManager::instance().onExitSleep();
-    Log.info("WAKE: Button pressed - reason=SERVICE_REQUEST transitioning to CONNECTING_STATE");
     userSwitchDetected = false;
-    state = CONNECTING_STATE;
+    if (BleReadout::takeButton()) {
+      Log.info("WAKE: Button pressed - reason=SERVICE_REQUEST BLE readout open, transitioning to IDLE_STATE");
+      setState(IDLE_STATE, REASON_SERVICE_REQUEST);
+    } else {
+      Log.info("WAKE: Button pressed - reason=SERVICE_REQUEST transitioning to CONNECTING_STATE");
+      setState(CONNECTING_STATE, REASON_SERVICE_REQUEST);
+    }
     return;
   } else {
     // In this state the device was awoken for hourly reporting or PIR
@@ -311,66 +596,73 @@ void handleSleepingState() {
       Log.info("Wake: sensorReady=%s", SensorManager::instance().isSensorReady() ? "true" : "false");
 
       // In CONNECTED operating mode, the device should reconnect at the
-      // start of open hours so it can resume normal connected behavior.
-      if (sysStatus.get_operatingMode() == CONNECTED && !Particle.connected()) {
+      // start of open hours so it can resume normal connected behavior,
+      // unless connects are backing off after failures.
+      if (PowerGovernor::operatingMode() == CONNECTED && !Particle.connected() &&
+          ConnectHistory::backoffRemainingSec() == 0 && !ConnectHistory::flapDamped() &&
+          !BrownoutGuard::radioHeld()) {
         Log.info("WAKE: CONNECTED mode + OPEN hours - reason=MAINTAIN_CONNECTION transitioning to CONNECTING_STATE");
-        state = CONNECTING_STATE;
+        setState(CONNECTING_STATE, REASON_MAINTAIN_CONNECTION);
         return;
       }
     } else {
       Log.info("Woke outside opening hours; keeping sensors powered down");
     }
 
-    // If this wake was caused by the PIR interrupt, synthesize a single
-    // detection event so that the motion that woke the device is counted
-    // even if the ISR flag did not survive ULTRA_LOW_POWER sleep.
+    // If this wake was caused by the PIR interrupt, make sure the edge
+    // that woke us is in the sensor's event queue (it is injected only if
+    // the ISR missed it). The counting/occupancy handler at the end of
+    // this loop() pass then counts it through the same filter, LED and
+    // persistence path as any awake event, and records the
+    // wake-to-count latency.
     if (pirWake) {
-      if (sysStatus.get_countingMode() == COUNTING) {
-        current.set_hourlyCount(current.get_hourlyCount() + 1);
-        current.set_dailyCount(current.get_dailyCount() + 1);
-        current.set_lastCountTime(Time.now());
-        Log.info("Count detected from PIR wake - Hourly: %d, Daily: %d",
-                 current.get_hourlyCount(), current.get_dailyCount());
-        if (Serial && Serial.isConnected()) {
-          Serial.printf("Count detected from PIR wake - Hourly: %d, Daily: %d\r\n",
-                        current.get_hourlyCount(), current.get_dailyCount());
-        }
-      } else if (sysStatus.get_countingMode() == OCCUPANCY) {
-        if (!current.get_occupied()) {
-          current.set_occupied(true);
-          current.set_occupancyStartTime(Time.now());
-          Log.info("Space now OCCUPIED from PIR wake at %s", Time.timeStr().c_str());
-          if (Serial && Serial.isConnected()) {
-            Serial.printf("Space now OCCUPIED from PIR wake at %s\r\n", Time.timeStr().c_str());
-          }
-        }
-        current.set_lastOccupancyEvent(millis());
+      SensorManager::instance().ingestWakeEvent(wakeReturnMs);
+    }
+
+    // A timer wake is at or just after a sample boundary in SCHEDULED
+    // mode; take it before anything else, including the report it may
+    // belong in. A sample-only wake goes straight back to sleep.
+    if (timerWake) {
+      ScheduledSampler::sampleIfDue();
+      if (sampleCappedSleep) {
+        Log.info("WAKE: Timer wake - reason=SCHEDULED_SAMPLE transitioning to SLEEPING_STATE");
+        setState(SLEEPING_STATE, REASON_SCHEDULED_SAMPLE);
+        return;
       }
     }
 
-    // If this wake was from PIR, keep the BLUE LED on using the
-    // same software timer used for normal count events so the
-    // visible behaviour is consistent.
-    if (pirWake) {
-      digitalWrite(BLUE_LED, HIGH);
-      if (countSignalTimer.isActive()) {
-        countSignalTimer.reset();
+    // A timer wake from an occupancy-capped nap is not a report boundary;
+    // the occupancy handler closes the session on this pass and IDLE
+    // decides the next sleep.
+    if (timerWake && occupancyCappedSleep) {
+      Log.info("WAKE: Timer wake - reason=OCCUPANCY_TIMEOUT transitioning to IDLE_STATE");
+      setState(IDLE_STATE, REASON_OCCUPANCY_TIMEOUT);
+      return;
+    }
+
+    // A timer wake from a surplus-capped nap is not a report boundary
+    // either; connect if it is still worth it, else IDLE sleeps again
+    if (timerWake && surplusCappedSleep) {
+      if (PowerGovernor::surplusDrainDue()) {
+        Log.info("WAKE: Timer wake - reason=SURPLUS_DRAIN transitioning to CONNECTING_STATE");
+        setState(CONNECTING_STATE, REASON_SURPLUS_DRAIN);
       } else {
-        countSignalTimer.start();
+        setState(IDLE_STATE, REASON_WAKE);
       }
+      return;
     }
 
     // Timer wake = scheduled report. No checks, no gates.
     // We trust that the system timer woke us at the correct boundary.
     if (timerWake) {
       Log.info("WAKE: Timer wake - reason=SCHEDULED_REPORT transitioning to REPORTING_STATE");
-      state = REPORTING_STATE;
+      setState(REPORTING_STATE, REASON_SCHEDULED_REPORT);
       return;
     }
 
     // For PIR wakes, check if reporting is also due (opportunistic reporting)
     if (pirWake && Time.isValid() && isWithinOpenHours()) {
-      uint16_t intervalSec = sysStatus.get_reportingInterval();
+      uint16_t intervalSec = PowerGovernor::reportingIntervalSec();
       if (intervalSec == 0) intervalSec = 3600;
 
       time_t now = Time.now();
@@ -378,20 +670,25 @@ void handleSleepingState() {
       if (lastReport > 0 && (now - lastReport) >= intervalSec) {
         int overdue = (int)(now - lastReport - intervalSec);
         Log.info("WAKE: PIR + report overdue (%d sec) - transitioning to REPORTING_STATE", overdue);
-        state = REPORTING_STATE;
+        setState(REPORTING_STATE, REASON_SCHEDULED_REPORT);
         return;
       }
     }
 
     // If PIR woke us in LOW_POWER or DISCONNECTED mode and no report is needed,
-    // return immediately to sleep. This check comes AFTER opportunistic reporting
-    // so overdue reports are not missed.
-    if (pirWake && sysStatus.get_operatingMode() != CONNECTED) {
-      state = SLEEPING_STATE;
+    // return immediately to sleep, unless this wake starts a busy spell.
+    // This check comes AFTER opportunistic reporting so overdue reports are
+    // not missed.
+    if (pirWake && PowerGovernor::operatingMode() != CONNECTED) {
+      if (stayAwakeForTraffic()) {
+        setState(IDLE_STATE, REASON_TRAFFIC);
+      } else {
+        setState(SLEEPING_STATE, REASON_SENSOR_WAKE);
+      }
       return;
     }
 
     Log.info("WAKE: No immediate action needed - transitioning to IDLE_STATE");
-    state = IDLE_STATE;
+    setState(IDLE_STATE, REASON_WAKE);
   }
 }